@@ -15,6 +15,10 @@
 #endif
 
 #include <unistd.h>
+#include <fcntl.h>
+#ifdef GF_LINUX_HOST_OS
+#include <sys/eventfd.h>
+#endif
 
 #include "glfs-internal.h"
 #include "glfs-mem-types.h"
@@ -25,6 +29,7 @@
 #include <limits.h>
 #include "glusterfs3.h"
 #include <glusterfs/iatt.h>
+#include <glusterfs/syscall.h>
 
 #ifdef NAME_MAX
 #define GF_NAME_MAX NAME_MAX
@@ -37,6 +42,12 @@ struct upcall_syncop_args {
     struct gf_upcall upcall_data;
 };
 
+/* All the invalidations of a batch are delivered by a single synctask */
+struct upcall_syncop_batch_args {
+    uint32_t count;
+    struct upcall_syncop_args *args[];
+};
+
 #define READDIRBUF_SIZE (sizeof(struct dirent) + GF_NAME_MAX + 1)
 
 typedef void (*glfs_io_cbk34)(glfs_fd_t *fd, ssize_t ret, void *data);
@@ -1006,13 +1017,53 @@ invalid_fs:
     return -1;
 }
 
+static void
+glfs_release_iobuf(void *ptr)
+{
+    struct glfs_iobuf *to_free = ptr;
+
+    GF_FREE(to_free->iov);
+    if (to_free->iobref)
+        iobref_unref(to_free->iobref);
+}
+
+/* Give the buffers of a read to the application, or copy them into the
+ * buffers it supplied if 'iobuf' is NULL. Returns the number of bytes
+ * available to the application. */
+static ssize_t
+glfs_preadv_deliver(const struct iovec *iovec, int iovcnt,
+                    struct glfs_iobuf **iobuf, struct iovec **iov, int cnt,
+                    struct iobref **iobref)
+{
+    struct glfs_iobuf *gio = NULL;
+
+    if (!iobuf)
+        return iov_copy(iovec, iovcnt, *iov, cnt);
+
+    gio = GLFS_CALLOC(1, sizeof(*gio), glfs_release_iobuf, glfs_mt_iobuf_t);
+    if (!gio) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    gio->iov = *iov;
+    gio->count = cnt;
+    gio->iobref = *iobref;
+    *iov = NULL;
+    *iobref = NULL;
+
+    *iobuf = gio;
+
+    return iov_length(gio->iov, gio->count);
+}
+
 static ssize_t
 glfs_preadv_common(struct glfs_fd *glfd, const struct iovec *iovec, int iovcnt,
-                   off_t offset, int flags, struct glfs_stat *poststat)
+                   size_t size, off_t offset, int flags,
+                   struct glfs_stat *poststat, struct glfs_iobuf **iobuf)
 {
     xlator_t *subvol = NULL;
     ssize_t ret = -1;
-    ssize_t size = -1;
     struct iovec *iov = NULL;
     int cnt = 0;
     struct iobref *iobref = NULL;
@@ -1041,8 +1092,6 @@ glfs_preadv_common(struct glfs_fd *glfd, const struct iovec *iovec, int iovcnt,
         goto out;
     }
 
-    size = iov_length(iovec, iovcnt);
-
     ret = get_fop_attr_thrd_key(&fop_attr);
     if (ret)
         gf_msg_debug("gfapi", 0, "Getting leaseid from thread failed");
@@ -1057,11 +1106,11 @@ glfs_preadv_common(struct glfs_fd *glfd, const struct iovec *iovec, int iovcnt,
     if (ret <= 0)
         goto out;
 
-    size = iov_copy(iovec, iovcnt, iov, cnt); /* FIXME!!! */
-
-    glfd->offset = (offset + size);
+    ret = glfs_preadv_deliver(iovec, iovcnt, iobuf, &iov, cnt, &iobref);
+    if (ret < 0)
+        goto out;
 
-    ret = size;
+    glfd->offset = (offset + ret);
 out:
     if (iov)
         GF_FREE(iov);
@@ -1088,7 +1137,33 @@ ssize_t
 pub_glfs_preadv(struct glfs_fd *glfd, const struct iovec *iovec, int iovcnt,
                 off_t offset, int flags)
 {
-    return glfs_preadv_common(glfd, iovec, iovcnt, offset, flags, NULL);
+    return glfs_preadv_common(glfd, iovec, iovcnt, iov_length(iovec, iovcnt),
+                              offset, flags, NULL, NULL);
+}
+
+GFAPI_SYMVER_PUBLIC_DEFAULT(glfs_preadv_iobuf, 8.0)
+ssize_t
+pub_glfs_preadv_iobuf(struct glfs_fd *glfd, size_t size, off_t offset,
+                      int flags, struct glfs_iobuf **iobuf,
+                      const struct iovec **iov, int *iovcnt,
+                      struct glfs_stat *poststat)
+{
+    struct glfs_iobuf *gio = NULL;
+    ssize_t ret = -1;
+
+    if (!iobuf || !iov || !iovcnt) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    ret = glfs_preadv_common(glfd, NULL, 0, size, offset, flags, poststat,
+                             &gio);
+
+    *iobuf = gio;
+    *iov = gio ? gio->iov : NULL;
+    *iovcnt = gio ? gio->count : 0;
+
+    return ret;
 }
 
 GFAPI_SYMVER_PUBLIC_DEFAULT(glfs_read, 3.4.0)
@@ -1144,7 +1219,8 @@ pub_glfs_pread(struct glfs_fd *glfd, void *buf, size_t count, off_t offset,
     iov.iov_base = buf;
     iov.iov_len = count;
 
-    ret = glfs_preadv_common(glfd, &iov, 1, offset, flags, poststat);
+    ret = glfs_preadv_common(glfd, &iov, 1, count, offset, flags, poststat,
+                             NULL);
 
     return ret;
 }
@@ -1218,7 +1294,7 @@ glfs_io_async_cbk(int op_ret, int op_errno, call_frame_t *frame, void *cookie,
         op_ret = iov_copy(gio->iov, gio->count, iovec, count);
         glfd->offset = gio->offset + op_ret;
     } else if (gio->op == GF_FOP_WRITE) {
-        glfd->offset = gio->offset + gio->iov->iov_len;
+        glfd->offset = gio->offset + iov_length(gio->iov, gio->count);
     }
 
 out:
@@ -1507,10 +1583,101 @@ pub_glfs_readv_async(struct glfs_fd *glfd, const struct iovec *iov, int count,
     return ret;
 }
 
+/* Tracks the memory of a write from registered buffers. One reference is
+ * held by the caller and one by each iobuf wrapping its vectors. The
+ * application is notified when the last one is released. */
+struct glfs_wbuf {
+    gf_atomic_t ref;
+    glfs_buffer_cbk fn;
+    void *data;
+};
+
+static struct glfs_wbuf *
+glfs_wbuf_new(glfs_buffer_cbk fn, void *data)
+{
+    struct glfs_wbuf *wbuf = NULL;
+
+    wbuf = GF_CALLOC(1, sizeof(*wbuf), glfs_mt_wbuf_t);
+    if (!wbuf)
+        return NULL;
+
+    GF_ATOMIC_INIT(wbuf->ref, 1);
+    wbuf->fn = fn;
+    wbuf->data = data;
+
+    return wbuf;
+}
+
+static void
+glfs_wbuf_put(void *data)
+{
+    struct glfs_wbuf *wbuf = data;
+
+    if (GF_ATOMIC_DEC(wbuf->ref) == 0) {
+        wbuf->fn(wbuf->data);
+        GF_FREE(wbuf);
+    }
+}
+
+/* Builds an iobref referencing the application's memory instead of a copy
+ * of it. All vectors must belong to regions registered for @fs. */
+static int
+glfs_wbuf_iobref(struct glfs *fs, struct iobuf_pool *iobuf_pool,
+                 const struct iovec *iovec, int iovcnt, struct glfs_wbuf *wbuf,
+                 struct iobref **iobref)
+{
+    struct iobuf *iobuf = NULL;
+    int ret = -1;
+    int i = 0;
+
+    if (!glfs_buffer_contains(fs, iovec, iovcnt)) {
+        errno = EINVAL;
+        gf_smsg(THIS->name, GF_LOG_ERROR, errno, API_MSG_INVALID_ARG,
+                "buffer not registered", NULL);
+        goto out;
+    }
+
+    *iobref = iobref_new();
+    if (!*iobref) {
+        errno = ENOMEM;
+        goto out;
+    }
+
+    for (i = 0; i < iovcnt; i++) {
+        if (iovec[i].iov_len == 0)
+            continue;
+
+        GF_ATOMIC_INC(wbuf->ref);
+        iobuf = iobuf_wrap(iobuf_pool, iovec[i].iov_base, iovec[i].iov_len,
+                           glfs_wbuf_put, wbuf);
+        if (!iobuf) {
+            GF_ATOMIC_DEC(wbuf->ref);
+            errno = ENOMEM;
+            goto err;
+        }
+
+        ret = iobref_add(*iobref, iobuf);
+        iobuf_unref(iobuf);
+        if (ret) {
+            errno = ENOMEM;
+            goto err;
+        }
+    }
+
+    return 0;
+
+err:
+    iobref_unref(*iobref);
+    *iobref = NULL;
+    ret = -1;
+out:
+    return ret;
+}
+
 static ssize_t
 glfs_pwritev_common(struct glfs_fd *glfd, const struct iovec *iovec, int iovcnt,
                     off_t offset, int flags, struct glfs_stat *prestat,
-                    struct glfs_stat *poststat)
+                    struct glfs_stat *poststat, struct glfs_wbuf *wbuf)
 {
     xlator_t *subvol = NULL;
     int ret = -1;
@@ -1519,6 +1686,8 @@ glfs_pwritev_common(struct glfs_fd *glfd, const struct iovec *iovec, int iovcnt,
     struct iovec iov = {
         0,
     };
+    const struct iovec *vector = &iov;
+    int count = 1;
     fd_t *fd = NULL;
     struct iatt preiatt =
                     {
@@ -1556,8 +1725,15 @@ glfs_pwritev_common(struct glfs_fd *glfd, const struct iovec *iovec, int iovcnt,
         goto out;
     }
 
-    ret = iobuf_copy(subvol->ctx->iobuf_pool, iovec, iovcnt, &iobref, &iobuf,
-                     &iov);
+    if (wbuf) {
+        ret = glfs_wbuf_iobref(glfd->fs, subvol->ctx->iobuf_pool, iovec,
+                               iovcnt, wbuf, &iobref);
+        vector = iovec;
+        count = iovcnt;
+    } else {
+        ret = iobuf_copy(subvol->ctx->iobuf_pool, iovec, iovcnt, &iobref,
+                         &iobuf, &iov);
+    }
     if (ret)
         goto out;
 
@@ -1565,8 +1741,8 @@ glfs_pwritev_common(struct glfs_fd *glfd, const struct iovec *iovec, int iovcnt,
     if (ret)
         gf_msg_debug("gfapi", 0, "Getting leaseid from thread failed");
 
-    ret = syncop_writev(subvol, fd, &iov, 1, offset, iobref, flags, &preiatt,
-                        &postiatt, fop_attr, NULL);
+    ret = syncop_writev(subvol, fd, vector, count, offset, iobref, flags,
+                        &preiatt, &postiatt, fop_attr, NULL);
     DECODE_SYNCOP_ERR(ret);
 
     if (ret >= 0) {
@@ -1579,7 +1755,7 @@ glfs_pwritev_common(struct glfs_fd *glfd, const struct iovec *iovec, int iovcnt,
     if (ret <= 0)
         goto out;
 
-    glfd->offset = (offset + iov.iov_len);
+    glfd->offset = (offset + iov_length(vector, count));
 out:
     if (iobuf)
         iobuf_unref(iobuf);
@@ -1759,7 +1935,8 @@ ssize_t
 pub_glfs_pwritev(struct glfs_fd *glfd, const struct iovec *iovec, int iovcnt,
                  off_t offset, int flags)
 {
-    return glfs_pwritev_common(glfd, iovec, iovcnt, offset, flags, NULL, NULL);
+    return glfs_pwritev_common(glfd, iovec, iovcnt, offset, flags, NULL, NULL,
+                               NULL);
 }
 
 GFAPI_SYMVER_PUBLIC_DEFAULT(glfs_write, 3.4.0)
@@ -1833,7 +2010,8 @@ pub_glfs_pwrite(struct glfs_fd *glfd, const void *buf, size_t count,
     iov.iov_base = (void *)buf;
     iov.iov_len = count;
 
-    ret = glfs_pwritev_common(glfd, &iov, 1, offset, flags, prestat, poststat);
+    ret = glfs_pwritev_common(glfd, &iov, 1, offset, flags, prestat, poststat,
+                              NULL);
 
     return ret;
 }
@@ -1855,7 +2033,8 @@ glfs_pwritev_async_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
 static int
 glfs_pwritev_async_common(struct glfs_fd *glfd, const struct iovec *iovec,
                           int count, off_t offset, int flags,
-                          gf_boolean_t oldcb, glfs_io_cbk fn, void *data)
+                          gf_boolean_t oldcb, glfs_io_cbk fn, void *data,
+                          struct glfs_wbuf *wbuf)
 {
     struct glfs_io *gio = NULL;
     int ret = -1;
@@ -1899,15 +2078,25 @@ glfs_pwritev_async_common(struct glfs_fd *glfd, const struct iovec *iovec,
     gio->oldcb = oldcb;
     gio->fn = fn;
     gio->data = data;
-    gio->count = 1;
-    gio->iov = GF_CALLOC(gio->count, sizeof(*(gio->iov)), gf_common_mt_iovec);
+    if (wbuf) {
+        gio->count = count;
+        gio->iov = iov_dup(iovec, count);
+    } else {
+        gio->count = 1;
+        gio->iov = GF_CALLOC(gio->count, sizeof(*(gio->iov)),
+                             gf_common_mt_iovec);
+    }
     if (!gio->iov) {
         errno = ENOMEM;
         goto out;
     }
 
-    ret = iobuf_copy(subvol->ctx->iobuf_pool, iovec, count, &iobref, &iobuf,
-                     gio->iov);
+    if (wbuf)
+        ret = glfs_wbuf_iobref(glfd->fs, subvol->ctx->iobuf_pool, iovec, count,
+                               wbuf, &iobref);
+    else
+        ret = iobuf_copy(subvol->ctx->iobuf_pool, iovec, count, &iobref,
+                         &iobuf, gio->iov);
     if (ret)
         goto out;
 
@@ -1963,7 +2152,7 @@ pub_glfs_pwritev_async34(struct glfs_fd *glfd, const struct iovec *iovec,
                          void *data)
 {
     return glfs_pwritev_async_common(glfd, iovec, count, offset, flags,
-                                     _gf_true, (void *)fn, data);
+                                     _gf_true, (void *)fn, data, NULL);
 }
 
 GFAPI_SYMVER_PUBLIC_DEFAULT(glfs_pwritev_async, 6.0)
@@ -1973,7 +2162,96 @@ pub_glfs_pwritev_async(struct glfs_fd *glfd, const struct iovec *iovec,
                        void *data)
 {
     return glfs_pwritev_async_common(glfd, iovec, count, offset, flags,
-                                     _gf_false, fn, data);
+                                     _gf_false, fn, data, NULL);
+}
+
+GFAPI_SYMVER_PUBLIC_DEFAULT(glfs_pwritev_registered, 8.0)
+ssize_t
+pub_glfs_pwritev_registered(struct glfs_fd *glfd, const struct iovec *iovec,
+                            int iovcnt, off_t offset, int flags,
+                            struct glfs_stat *prestat,
+                            struct glfs_stat *poststat,
+                            glfs_buffer_cbk release, void *release_data)
+{
+    struct glfs_wbuf *wbuf = NULL;
+    ssize_t ret = -1;
+    int op_errno = 0;
+
+    DECLARE_OLD_THIS;
+    __GLFS_ENTRY_VALIDATE_FD(glfd, invalid_fs);
+
+    GF_VALIDATE_OR_GOTO_WITH_ERROR(THIS->name, release, out, errno, EINVAL);
+
+    wbuf = glfs_wbuf_new(release, release_data);
+    if (!wbuf) {
+        errno = ENOMEM;
+        goto out;
+    }
+
+    ret = glfs_pwritev_common(glfd, iovec, iovcnt, offset, flags, prestat,
+                              poststat, wbuf);
+
+    /* The callback may be invoked from here. Don't let it change the result
+     * seen by the application. */
+    op_errno = errno;
+    glfs_wbuf_put(wbuf);
+    errno = op_errno;
+
+out:
+    __GLFS_EXIT_FS;
+
+invalid_fs:
+    /* The buffers are released exactly once, even on early failures. */
+    if (!wbuf && release) {
+        op_errno = errno;
+        release(release_data);
+        errno = op_errno;
+    }
+
+    return ret;
+}
+
+GFAPI_SYMVER_PUBLIC_DEFAULT(glfs_pwritev_registered_async, 8.0)
+int
+pub_glfs_pwritev_registered_async(struct glfs_fd *glfd,
+                                  const struct iovec *iovec, int count,
+                                  off_t offset, int flags, glfs_io_cbk fn,
+                                  void *data, glfs_buffer_cbk release,
+                                  void *release_data)
+{
+    struct glfs_wbuf *wbuf = NULL;
+    int ret = -1;
+    int op_errno = 0;
+
+    DECLARE_OLD_THIS;
+    __GLFS_ENTRY_VALIDATE_FD(glfd, invalid_fs);
+
+    GF_VALIDATE_OR_GOTO_WITH_ERROR(THIS->name, release, out, errno, EINVAL);
+
+    wbuf = glfs_wbuf_new(release, release_data);
+    if (!wbuf) {
+        errno = ENOMEM;
+        goto out;
+    }
+
+    ret = glfs_pwritev_async_common(glfd, iovec, count, offset, flags,
+                                    _gf_false, fn, data, wbuf);
+
+    op_errno = errno;
+    glfs_wbuf_put(wbuf);
+    errno = op_errno;
+
+out:
+    __GLFS_EXIT_FS;
+
+invalid_fs:
+    if (!wbuf && release) {
+        op_errno = errno;
+        release(release_data);
+        errno = op_errno;
+    }
+
+    return ret;
 }
 
 GFAPI_SYMVER_PUBLIC(glfs_write_async34, glfs_write_async, 3.4.0)
@@ -1995,7 +2273,7 @@ pub_glfs_write_async34(struct glfs_fd *glfd, const void *buf, size_t count,
     iov.iov_len = count;
 
     ret = glfs_pwritev_async_common(glfd, &iov, 1, glfd->offset, flags,
-                                    _gf_true, (void *)fn, data);
+                                    _gf_true, (void *)fn, data, NULL);
 
     return ret;
 }
@@ -2019,7 +2297,7 @@ pub_glfs_write_async(struct glfs_fd *glfd, const void *buf, size_t count,
     iov.iov_len = count;
 
     ret = glfs_pwritev_async_common(glfd, &iov, 1, glfd->offset, flags,
-                                    _gf_false, fn, data);
+                                    _gf_false, fn, data, NULL);
 
     return ret;
 }
@@ -2038,7 +2316,7 @@ pub_glfs_pwrite_async34(struct glfs_fd *glfd, const void *buf, int count,
     iov.iov_len = count;
 
     ret = glfs_pwritev_async_common(glfd, &iov, 1, offset, flags, _gf_true,
-                                    (void *)fn, data);
+                                    (void *)fn, data, NULL);
 
     return ret;
 }
@@ -2057,7 +2335,7 @@ pub_glfs_pwrite_async(struct glfs_fd *glfd, const void *buf, int count,
     iov.iov_len = count;
 
     ret = glfs_pwritev_async_common(glfd, &iov, 1, offset, flags, _gf_false, fn,
-                                    data);
+                                    data, NULL);
 
     return ret;
 }
@@ -2075,7 +2353,7 @@ pub_glfs_writev_async34(struct glfs_fd *glfd, const struct iovec *iov,
     }
 
     ret = glfs_pwritev_async_common(glfd, iov, count, glfd->offset, flags,
-                                    _gf_true, (void *)fn, data);
+                                    _gf_true, (void *)fn, data, NULL);
     return ret;
 }
 
@@ -2092,7 +2370,7 @@ pub_glfs_writev_async(struct glfs_fd *glfd, const struct iovec *iov, int count,
     }
 
     ret = glfs_pwritev_async_common(glfd, iov, count, glfd->offset, flags,
-                                    _gf_false, fn, data);
+                                    _gf_false, fn, data, NULL);
     return ret;
 }
 
@@ -5468,15 +5746,12 @@ invalid_fs:
     return dupfd;
 }
 
-static void
-glfs_enqueue_upcall_data(struct glfs *fs, struct gf_upcall *upcall_data)
+static upcall_entry *
+glfs_upcall_entry_new(struct gf_upcall *upcall_data)
 {
     int ret = -1;
     upcall_entry *u_list = NULL;
 
-    if (!fs || !upcall_data)
-        goto out;
-
     u_list = GF_CALLOC(1, sizeof(*u_list), glfs_mt_upcall_entry_t);
 
     if (!u_list) {
@@ -5507,19 +5782,51 @@ glfs_enqueue_upcall_data(struct glfs *fs, struct gf_upcall *upcall_data)
         goto out;
     }
 
-    pthread_mutex_lock(&fs->upcall_list_mutex);
-    {
-        list_add_tail(&u_list->upcall_list, &fs->upcall_list);
-    }
-    pthread_mutex_unlock(&fs->upcall_list_mutex);
-
-    ret = 0;
+    return u_list;
 
 out:
-    if (ret && u_list) {
+    if (u_list) {
         GF_FREE(u_list->upcall_data.data);
         GF_FREE(u_list);
     }
+
+    return NULL;
+}
+
+static void
+glfs_enqueue_upcall_data(struct glfs *fs, struct gf_upcall *upcall_data)
+{
+    struct gf_upcall_cache_invalidation_batch *batch = NULL;
+    upcall_entry *u_list = NULL;
+    struct list_head entries;
+    uint32_t i = 0;
+
+    if (!fs || !upcall_data)
+        return;
+
+    INIT_LIST_HEAD(&entries);
+
+    if (upcall_data->event_type == GF_UPCALL_CACHE_INVALIDATION_BATCH) {
+        batch = upcall_data->data;
+        for (i = 0; i < batch->count; i++) {
+            u_list = glfs_upcall_entry_new(&batch->entries[i]);
+            if (u_list)
+                list_add_tail(&u_list->upcall_list, &entries);
+        }
+    } else {
+        u_list = glfs_upcall_entry_new(upcall_data);
+        if (u_list)
+            list_add_tail(&u_list->upcall_list, &entries);
+    }
+
+    if (list_empty(&entries))
+        return;
+
+    pthread_mutex_lock(&fs->upcall_list_mutex);
+    {
+        list_append(&entries, &fs->upcall_list);
+    }
+    pthread_mutex_unlock(&fs->upcall_list_mutex);
 }
 
 static void
@@ -5724,6 +6031,25 @@ glfs_upcall_syncop_cbk(int ret, call_frame_t *frame, void *opaque)
     return 0;
 }
 
+static void
+upcall_syncop_batch_args_free(struct upcall_syncop_batch_args *batch_args)
+{
+    uint32_t i = 0;
+
+    for (i = 0; i < batch_args->count; i++)
+        (void)upcall_syncop_args_free(batch_args->args[i]);
+
+    GF_FREE(batch_args);
+}
+
+static int
+glfs_upcall_batch_syncop_cbk(int ret, call_frame_t *frame, void *opaque)
+{
+    upcall_syncop_batch_args_free(opaque);
+
+    return 0;
+}
+
 static int
 glfs_cbk_upcall_syncop(void *opaque)
 {
@@ -5787,6 +6113,18 @@ out:
     return ret;
 }
 
+static int
+glfs_cbk_upcall_batch_syncop(void *opaque)
+{
+    struct upcall_syncop_batch_args *batch_args = opaque;
+    uint32_t i = 0;
+
+    for (i = 0; i < batch_args->count; i++)
+        (void)glfs_cbk_upcall_syncop(batch_args->args[i]);
+
+    return 0;
+}
+
 static struct gf_upcall_cache_invalidation *
 gf_copy_cache_invalidation(struct gf_upcall_cache_invalidation *src)
 {
@@ -5938,6 +6276,55 @@ out:
     return;
 }
 
+static void
+glfs_cbk_upcall_batch_data(struct glfs *fs, struct gf_upcall *upcall_data)
+{
+    struct gf_upcall_cache_invalidation_batch *batch = NULL;
+    struct upcall_syncop_batch_args *batch_args = NULL;
+    struct upcall_syncop_args *args = NULL;
+    uint32_t i = 0;
+    int ret = -1;
+
+    if (!(fs->upcall_events & GF_UPCALL_CACHE_INVALIDATION)) {
+        /* ignore events which application hasn't registered*/
+        goto out;
+    }
+
+    batch = upcall_data->data;
+    batch_args = GF_CALLOC(1,
+                           sizeof(*batch_args) +
+                               batch->count * sizeof(batch_args->args[0]),
+                           glfs_mt_upcall_entry_t);
+    if (!batch_args) {
+        gf_smsg(THIS->name, GF_LOG_ERROR, ENOMEM, API_MSG_ALLOC_FAILED,
+                "syncop args", NULL);
+        goto out;
+    }
+
+    for (i = 0; i < batch->count; i++) {
+        args = upcall_syncop_args_init(fs, &batch->entries[i]);
+        if (args)
+            batch_args->args[batch_args->count++] = args;
+    }
+
+    if (!batch_args->count) {
+        GF_FREE(batch_args);
+        goto out;
+    }
+
+    ret = synctask_new(THIS->ctx->env, glfs_cbk_upcall_batch_syncop,
+                       glfs_upcall_batch_syncop_cbk, NULL, batch_args);
+    if (ret) {
+        gf_smsg(THIS->name, GF_LOG_ERROR, errno, API_MSG_UPCALL_SYNCOP_FAILED,
+                "event_type=%d", upcall_data->event_type, "gfid=%s",
+                (char *)(upcall_data->gfid), NULL);
+        upcall_syncop_batch_args_free(batch_args);
+    }
+
+out:
+    return;
+}
+
 /*
  * This routine is called in case of any notification received
  * from the server. All the upcall events are queued up in a list
@@ -6004,7 +6391,10 @@ priv_glfs_process_upcall_event(struct glfs *fs, void *data)
      * */
 
     if (fs->up_cbk) { /* upcall cbk registered */
-        (void)glfs_cbk_upcall_data(fs, upcall_data);
+        if (upcall_data->event_type == GF_UPCALL_CACHE_INVALIDATION_BATCH)
+            (void)glfs_cbk_upcall_batch_data(fs, upcall_data);
+        else
+            (void)glfs_cbk_upcall_data(fs, upcall_data);
     } else {
         (void)glfs_enqueue_upcall_data(fs, upcall_data);
     }
@@ -6121,10 +6511,11 @@ invalid_fs:
     return ret;
 }
 
-ssize_t
-glfs_anonymous_preadv(struct glfs *fs, struct glfs_object *object,
-                      const struct iovec *iovec, int iovcnt, off_t offset,
-                      int flags)
+static ssize_t
+glfs_anonymous_preadv_common(struct glfs *fs, struct glfs_object *object,
+                             const struct iovec *iovec, int iovcnt,
+                             size_t size, off_t offset, int flags,
+                             struct glfs_iobuf **iobuf)
 {
     xlator_t *subvol = NULL;
     struct iovec *iov = NULL;
@@ -6133,7 +6524,6 @@ glfs_anonymous_preadv(struct glfs *fs, struct glfs_object *object,
     fd_t *fd = NULL;
     int cnt = 0;
     ssize_t ret = -1;
-    ssize_t size = -1;
 
     DECLARE_OLD_THIS;
     __GLFS_ENTRY_VALIDATE_FS(fs, invalid_fs);
@@ -6161,8 +6551,6 @@ glfs_anonymous_preadv(struct glfs *fs, struct glfs_object *object,
         goto out;
     }
 
-    size = iov_length(iovec, iovcnt);
-
     /* TODO : set leaseid */
     ret = syncop_readv(subvol, fd, size, offset, flags, &iov, &cnt, &iobref,
                        NULL, NULL, NULL);
@@ -6170,9 +6558,7 @@ glfs_anonymous_preadv(struct glfs *fs, struct glfs_object *object,
     if (ret <= 0)
         goto out;
 
-    size = iov_copy(iovec, iovcnt, iov, cnt);
-
-    ret = size;
+    ret = glfs_preadv_deliver(iovec, iovcnt, iobuf, &iov, cnt, &iobref);
 out:
     if (iov)
         GF_FREE(iov);
@@ -6192,6 +6578,25 @@ invalid_fs:
     return ret;
 }
 
+ssize_t
+glfs_anonymous_preadv(struct glfs *fs, struct glfs_object *object,
+                      const struct iovec *iovec, int iovcnt, off_t offset,
+                      int flags)
+{
+    return glfs_anonymous_preadv_common(fs, object, iovec, iovcnt,
+                                        iov_length(iovec, iovcnt), offset,
+                                        flags, NULL);
+}
+
+ssize_t
+glfs_anonymous_preadv_iobuf(struct glfs *fs, struct glfs_object *object,
+                            size_t size, off_t offset, int flags,
+                            struct glfs_iobuf **iobuf)
+{
+    return glfs_anonymous_preadv_common(fs, object, NULL, 0, size, offset,
+                                        flags, iobuf);
+}
+
 static void
 glfs_release_xreaddirp_stat(void *ptr)
 {
@@ -6452,3 +6857,705 @@ out:
 invalid_fs:
     return ret;
 }
+
+/* Requests queued with glfs_queue_*() until glfs_queue_submit() is called,
+ * and kept until their completion is reaped by the application. */
+struct glfs_queue_op {
+    struct list_head list;
+    struct glfs_queue *queue;
+    glusterfs_fop_t fop;
+    struct glfs_fd *glfd;
+    char *path;
+    char *name;
+    struct iovec *iov;
+    int count;
+    off_t offset;
+    int flags;
+    mode_t mode;
+    void *value;
+    size_t size;
+    struct stat *stat;
+    struct glfs_completion completion;
+};
+
+struct glfs_queue {
+    struct glfs *fs;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int notify[2]; /* readable while there are completions to reap */
+    int entries;
+    int used;                 /* queued, in flight or not yet reaped */
+    int queued;               /* not yet submitted */
+    int done;                 /* completed but not yet reaped */
+    struct list_head pending; /* queued requests */
+    struct list_head reap;    /* completed requests */
+};
+
+static int
+glfs_queue_notify_init(struct glfs_queue *queue)
+{
+#ifdef GF_LINUX_HOST_OS
+    queue->notify[0] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    queue->notify[1] = queue->notify[0];
+
+    return (queue->notify[0] < 0) ? -1 : 0;
+#else
+    if (pipe(queue->notify) < 0)
+        return -1;
+
+    if ((fcntl(queue->notify[0], F_SETFL, O_NONBLOCK) < 0) ||
+        (fcntl(queue->notify[1], F_SETFL, O_NONBLOCK) < 0)) {
+        sys_close(queue->notify[0]);
+        sys_close(queue->notify[1]);
+        return -1;
+    }
+
+    return 0;
+#endif
+}
+
+static void
+glfs_queue_notify_fini(struct glfs_queue *queue)
+{
+    if (queue->notify[1] != queue->notify[0])
+        sys_close(queue->notify[1]);
+    sys_close(queue->notify[0]);
+}
+
+/* Both an eventfd and a pipe accept a 64 bits counter. The notification is
+ * only raised when the first completion arrives and cleared when the last
+ * one is reaped, so a pipe never fills up. */
+static void
+glfs_queue_notify_set(struct glfs_queue *queue)
+{
+    uint64_t value = 1;
+
+    if (sys_write(queue->notify[1], &value, sizeof(value)) < 0)
+        gf_msg_debug("gfapi", errno, "Unable to notify completion");
+}
+
+static void
+glfs_queue_notify_clear(struct glfs_queue *queue)
+{
+    uint64_t value = 0;
+
+    if (sys_read(queue->notify[0], &value, sizeof(value)) < 0)
+        gf_msg_debug("gfapi", errno, "Unable to clear notification");
+}
+
+static void
+glfs_queue_op_free(struct glfs_queue_op *op)
+{
+    if (op->glfd)
+        GF_REF_PUT(op->glfd);
+    GF_FREE(op->path);
+    GF_FREE(op->name);
+    GF_FREE(op->iov);
+    GF_FREE(op);
+}
+
+static struct glfs_queue_op *
+glfs_queue_op_new(struct glfs_queue *queue, glusterfs_fop_t fop,
+                  struct glfs_fd *glfd, const char *path, void *data)
+{
+    struct glfs_queue_op *op = NULL;
+
+    if (path == NULL) {
+        if (glfd == NULL) {
+            errno = EBADF;
+            return NULL;
+        }
+    } else if (*path == '\0') {
+        errno = ENOENT;
+        return NULL;
+    }
+
+    op = GF_CALLOC(1, sizeof(*op), glfs_mt_queue_op_t);
+    if (op == NULL) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    INIT_LIST_HEAD(&op->list);
+    op->queue = queue;
+    op->fop = fop;
+    op->glfd = glfd;
+    op->completion.data = data;
+
+    if (path != NULL) {
+        op->path = gf_strdup(path);
+        if (op->path == NULL) {
+            GF_FREE(op);
+            errno = ENOMEM;
+            return NULL;
+        }
+    }
+
+    /* The application may close the fd before reaping the completion. */
+    if (glfd != NULL)
+        GF_REF_GET(glfd);
+
+    return op;
+}
+
+static int
+glfs_queue_op_add(struct glfs_queue *queue, struct glfs_queue_op *op)
+{
+    int ret = -1;
+
+    pthread_mutex_lock(&queue->mutex);
+    {
+        if (queue->used < queue->entries) {
+            list_add_tail(&op->list, &queue->pending);
+            queue->used++;
+            queue->queued++;
+            ret = 0;
+        }
+    }
+    pthread_mutex_unlock(&queue->mutex);
+
+    if (ret < 0) {
+        glfs_queue_op_free(op);
+        errno = EAGAIN;
+    }
+
+    return ret;
+}
+
+static void
+glfs_queue_complete(struct glfs_queue_op *op, ssize_t ret, int op_errno)
+{
+    struct glfs_queue *queue = op->queue;
+
+    op->completion.ret = ret;
+    op->completion.op_errno = (ret < 0) ? op_errno : 0;
+
+    pthread_mutex_lock(&queue->mutex);
+    {
+        if (queue->done++ == 0)
+            glfs_queue_notify_set(queue);
+        list_add_tail(&op->list, &queue->reap);
+        pthread_cond_broadcast(&queue->cond);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+}
+
+static void
+glfs_queue_io_cbk(glfs_fd_t *glfd, ssize_t ret, struct glfs_stat *prestat,
+                  struct glfs_stat *poststat, void *data)
+{
+    glfs_queue_complete(data, ret, errno);
+}
+
+/* There are no asynchronous versions of the path based operations. They are
+ * run as synctasks instead, which doesn't block the submitter either. */
+static int
+glfs_queue_task(void *opaque)
+{
+    struct glfs_queue_op *op = opaque;
+    struct glfs *fs = op->queue->fs;
+    struct glfs_fd *glfd = NULL;
+    ssize_t ret = -1;
+
+    switch (op->fop) {
+        case GF_FOP_STAT:
+            ret = pub_glfs_stat(fs, op->path, op->stat);
+            break;
+        case GF_FOP_FSTAT:
+            ret = pub_glfs_fstat(op->glfd, op->stat);
+            break;
+        case GF_FOP_OPEN:
+            glfd = pub_glfs_open(fs, op->path, op->flags);
+            ret = (glfd == NULL) ? -1 : 0;
+            break;
+        case GF_FOP_CREATE:
+            glfd = pub_glfs_creat(fs, op->path, op->flags, op->mode);
+            ret = (glfd == NULL) ? -1 : 0;
+            break;
+        case GF_FOP_UNLINK:
+            ret = pub_glfs_unlink(fs, op->path);
+            break;
+        case GF_FOP_GETXATTR:
+            ret = pub_glfs_getxattr(fs, op->path, op->name, op->value,
+                                    op->size);
+            break;
+        default:
+            errno = EINVAL;
+            break;
+    }
+
+    op->completion.fd = glfd;
+    op->completion.ret = ret;
+    op->completion.op_errno = errno;
+
+    return 0;
+}
+
+static int
+glfs_queue_task_cbk(int ret, call_frame_t *frame, void *opaque)
+{
+    struct glfs_queue_op *op = opaque;
+
+    glfs_queue_complete(op, op->completion.ret, op->completion.op_errno);
+
+    return 0;
+}
+
+static void
+glfs_queue_start(struct glfs_queue_op *op)
+{
+    int ret = -1;
+
+    switch (op->fop) {
+        case GF_FOP_READ:
+            ret = pub_glfs_preadv_async(op->glfd, op->iov, op->count,
+                                        op->offset, op->flags,
+                                        glfs_queue_io_cbk, op);
+            break;
+        case GF_FOP_WRITE:
+            ret = pub_glfs_pwritev_async(op->glfd, op->iov, op->count,
+                                         op->offset, op->flags,
+                                         glfs_queue_io_cbk, op);
+            break;
+        case GF_FOP_FSYNC:
+            ret = pub_glfs_fsync_async(op->glfd, glfs_queue_io_cbk, op);
+            break;
+        default:
+            ret = synctask_new(op->queue->fs->ctx->env, glfs_queue_task,
+                               glfs_queue_task_cbk, NULL, op);
+            if (ret)
+                errno = ENOMEM;
+            break;
+    }
+
+    if (ret < 0)
+        glfs_queue_complete(op, -1, errno);
+}
+
+GFAPI_SYMVER_PUBLIC_DEFAULT(glfs_queue_new, 8.0)
+struct glfs_queue *
+pub_glfs_queue_new(struct glfs *fs, int entries)
+{
+    struct glfs_queue *queue = NULL;
+
+    DECLARE_OLD_THIS;
+    __GLFS_ENTRY_VALIDATE_FS(fs, invalid_fs);
+
+    if (entries <= 0) {
+        errno = EINVAL;
+        goto out;
+    }
+
+    queue = GF_CALLOC(1, sizeof(*queue), glfs_mt_queue_t);
+    if (!queue) {
+        errno = ENOMEM;
+        goto out;
+    }
+
+    if (glfs_queue_notify_init(queue) < 0) {
+        GF_FREE(queue);
+        queue = NULL;
+        goto out;
+    }
+
+    pthread_mutex_init(&queue->mutex, NULL);
+    pthread_cond_init(&queue->cond, NULL);
+    INIT_LIST_HEAD(&queue->pending);
+    INIT_LIST_HEAD(&queue->reap);
+    queue->fs = fs;
+    queue->entries = entries;
+
+out:
+    __GLFS_EXIT_FS;
+
+invalid_fs:
+    return queue;
+}
+
+GFAPI_SYMVER_PUBLIC_DEFAULT(glfs_queue_destroy, 8.0)
+int
+pub_glfs_queue_destroy(struct glfs_queue *queue)
+{
+    struct glfs_queue_op *op = NULL;
+    struct glfs_queue_op *tmp = NULL;
+    int ret = -1;
+
+    DECLARE_OLD_THIS;
+    __GLFS_ENTRY_VALIDATE_FS((queue ? queue->fs : NULL), invalid_fs);
+
+    /* Requests still running would complete into freed memory. */
+    pthread_mutex_lock(&queue->mutex);
+    ret = (queue->used > queue->queued) ? -1 : 0;
+    pthread_mutex_unlock(&queue->mutex);
+
+    if (ret < 0) {
+        errno = EBUSY;
+        goto out;
+    }
+
+    list_for_each_entry_safe(op, tmp, &queue->pending, list)
+    {
+        list_del_init(&op->list);
+        glfs_queue_op_free(op);
+    }
+
+    glfs_queue_notify_fini(queue);
+    pthread_cond_destroy(&queue->cond);
+    pthread_mutex_destroy(&queue->mutex);
+    GF_FREE(queue);
+
+out:
+    __GLFS_EXIT_FS;
+
+invalid_fs:
+    return ret;
+}
+
+GFAPI_SYMVER_PUBLIC_DEFAULT(glfs_queue_fd, 8.0)
+int
+pub_glfs_queue_fd(struct glfs_queue *queue)
+{
+    if (!queue) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    return queue->notify[0];
+}
+
+GFAPI_SYMVER_PUBLIC_DEFAULT(glfs_queue_preadv, 8.0)
+int
+pub_glfs_queue_preadv(struct glfs_queue *queue, struct glfs_fd *glfd,
+                      const struct iovec *iov, int iovcnt, off_t offset,
+                      int flags, void *data)
+{
+    struct glfs_queue_op *op = NULL;
+    int ret = -1;
+
+    DECLARE_OLD_THIS;
+    __GLFS_ENTRY_VALIDATE_FS((queue ? queue->fs : NULL), invalid_fs);
+
+    op = glfs_queue_op_new(queue, GF_FOP_READ, glfd, NULL, data);
+    if (!op)
+        goto out;
+
+    op->iov = iov_dup(iov, iovcnt);
+    if (!op->iov) {
+        glfs_queue_op_free(op);
+        errno = ENOMEM;
+        goto out;
+    }
+    op->count = iovcnt;
+    op->offset = offset;
+    op->flags = flags;
+
+    ret = glfs_queue_op_add(queue, op);
+
+out:
+    __GLFS_EXIT_FS;
+
+invalid_fs:
+    return ret;
+}
+
+GFAPI_SYMVER_PUBLIC_DEFAULT(glfs_queue_pwritev, 8.0)
+int
+pub_glfs_queue_pwritev(struct glfs_queue *queue, struct glfs_fd *glfd,
+                       const struct iovec *iov, int iovcnt, off_t offset,
+                       int flags, void *data)
+{
+    struct glfs_queue_op *op = NULL;
+    int ret = -1;
+
+    DECLARE_OLD_THIS;
+    __GLFS_ENTRY_VALIDATE_FS((queue ? queue->fs : NULL), invalid_fs);
+
+    op = glfs_queue_op_new(queue, GF_FOP_WRITE, glfd, NULL, data);
+    if (!op)
+        goto out;
+
+    op->iov = iov_dup(iov, iovcnt);
+    if (!op->iov) {
+        glfs_queue_op_free(op);
+        errno = ENOMEM;
+        goto out;
+    }
+    op->count = iovcnt;
+    op->offset = offset;
+    op->flags = flags;
+
+    ret = glfs_queue_op_add(queue, op);
+
+out:
+    __GLFS_EXIT_FS;
+
+invalid_fs:
+    return ret;
+}
+
+GFAPI_SYMVER_PUBLIC_DEFAULT(glfs_queue_fsync, 8.0)
+int
+pub_glfs_queue_fsync(struct glfs_queue *queue, struct glfs_fd *glfd,
+                     void *data)
+{
+    struct glfs_queue_op *op = NULL;
+    int ret = -1;
+
+    DECLARE_OLD_THIS;
+    __GLFS_ENTRY_VALIDATE_FS((queue ? queue->fs : NULL), invalid_fs);
+
+    op = glfs_queue_op_new(queue, GF_FOP_FSYNC, glfd, NULL, data);
+    if (op)
+        ret = glfs_queue_op_add(queue, op);
+
+    __GLFS_EXIT_FS;
+
+invalid_fs:
+    return ret;
+}
+
+GFAPI_SYMVER_PUBLIC_DEFAULT(glfs_queue_fstat, 8.0)
+int
+pub_glfs_queue_fstat(struct glfs_queue *queue, struct glfs_fd *glfd,
+                     struct stat *stat, void *data)
+{
+    struct glfs_queue_op *op = NULL;
+    int ret = -1;
+
+    DECLARE_OLD_THIS;
+    __GLFS_ENTRY_VALIDATE_FS((queue ? queue->fs : NULL), invalid_fs);
+
+    op = glfs_queue_op_new(queue, GF_FOP_FSTAT, glfd, NULL, data);
+    if (op) {
+        op->stat = stat;
+        ret = glfs_queue_op_add(queue, op);
+    }
+
+    __GLFS_EXIT_FS;
+
+invalid_fs:
+    return ret;
+}
+
+GFAPI_SYMVER_PUBLIC_DEFAULT(glfs_queue_stat, 8.0)
+int
+pub_glfs_queue_stat(struct glfs_queue *queue, const char *path,
+                    struct stat *stat, void *data)
+{
+    struct glfs_queue_op *op = NULL;
+    int ret = -1;
+
+    DECLARE_OLD_THIS;
+    __GLFS_ENTRY_VALIDATE_FS((queue ? queue->fs : NULL), invalid_fs);
+
+    GF_VALIDATE_OR_GOTO_WITH_ERROR(THIS->name, path, out, errno, EINVAL);
+
+    op = glfs_queue_op_new(queue, GF_FOP_STAT, NULL, path, data);
+    if (op) {
+        op->stat = stat;
+        ret = glfs_queue_op_add(queue, op);
+    }
+
+out:
+    __GLFS_EXIT_FS;
+
+invalid_fs:
+    return ret;
+}
+
+GFAPI_SYMVER_PUBLIC_DEFAULT(glfs_queue_open, 8.0)
+int
+pub_glfs_queue_open(struct glfs_queue *queue, const char *path, int flags,
+                    void *data)
+{
+    struct glfs_queue_op *op = NULL;
+    int ret = -1;
+
+    DECLARE_OLD_THIS;
+    __GLFS_ENTRY_VALIDATE_FS((queue ? queue->fs : NULL), invalid_fs);
+
+    GF_VALIDATE_OR_GOTO_WITH_ERROR(THIS->name, path, out, errno, EINVAL);
+
+    op = glfs_queue_op_new(queue, GF_FOP_OPEN, NULL, path, data);
+    if (op) {
+        op->flags = flags;
+        ret = glfs_queue_op_add(queue, op);
+    }
+
+out:
+    __GLFS_EXIT_FS;
+
+invalid_fs:
+    return ret;
+}
+
+GFAPI_SYMVER_PUBLIC_DEFAULT(glfs_queue_creat, 8.0)
+int
+pub_glfs_queue_creat(struct glfs_queue *queue, const char *path, int flags,
+                     mode_t mode, void *data)
+{
+    struct glfs_queue_op *op = NULL;
+    int ret = -1;
+
+    DECLARE_OLD_THIS;
+    __GLFS_ENTRY_VALIDATE_FS((queue ? queue->fs : NULL), invalid_fs);
+
+    GF_VALIDATE_OR_GOTO_WITH_ERROR(THIS->name, path, out, errno, EINVAL);
+
+    op = glfs_queue_op_new(queue, GF_FOP_CREATE, NULL, path, data);
+    if (op) {
+        op->flags = flags;
+        op->mode = mode;
+        ret = glfs_queue_op_add(queue, op);
+    }
+
+out:
+    __GLFS_EXIT_FS;
+
+invalid_fs:
+    return ret;
+}
+
+GFAPI_SYMVER_PUBLIC_DEFAULT(glfs_queue_unlink, 8.0)
+int
+pub_glfs_queue_unlink(struct glfs_queue *queue, const char *path, void *data)
+{
+    struct glfs_queue_op *op = NULL;
+    int ret = -1;
+
+    DECLARE_OLD_THIS;
+    __GLFS_ENTRY_VALIDATE_FS((queue ? queue->fs : NULL), invalid_fs);
+
+    GF_VALIDATE_OR_GOTO_WITH_ERROR(THIS->name, path, out, errno, EINVAL);
+
+    op = glfs_queue_op_new(queue, GF_FOP_UNLINK, NULL, path, data);
+    if (op)
+        ret = glfs_queue_op_add(queue, op);
+
+out:
+    __GLFS_EXIT_FS;
+
+invalid_fs:
+    return ret;
+}
+
+GFAPI_SYMVER_PUBLIC_DEFAULT(glfs_queue_getxattr, 8.0)
+int
+pub_glfs_queue_getxattr(struct glfs_queue *queue, const char *path,
+                        const char *name, void *value, size_t size, void *data)
+{
+    struct glfs_queue_op *op = NULL;
+    int ret = -1;
+
+    DECLARE_OLD_THIS;
+    __GLFS_ENTRY_VALIDATE_FS((queue ? queue->fs : NULL), invalid_fs);
+
+    GF_VALIDATE_OR_GOTO_WITH_ERROR(THIS->name, path, out, errno, EINVAL);
+    GF_VALIDATE_OR_GOTO_WITH_ERROR(THIS->name, name, out, errno, EINVAL);
+
+    op = glfs_queue_op_new(queue, GF_FOP_GETXATTR, NULL, path, data);
+    if (!op)
+        goto out;
+
+    op->name = gf_strdup(name);
+    if (!op->name) {
+        glfs_queue_op_free(op);
+        errno = ENOMEM;
+        goto out;
+    }
+    op->value = value;
+    op->size = size;
+
+    ret = glfs_queue_op_add(queue, op);
+
+out:
+    __GLFS_EXIT_FS;
+
+invalid_fs:
+    return ret;
+}
+
+GFAPI_SYMVER_PUBLIC_DEFAULT(glfs_queue_submit, 8.0)
+int
+pub_glfs_queue_submit(struct glfs_queue *queue)
+{
+    struct glfs_queue_op *op = NULL;
+    struct glfs_queue_op *tmp = NULL;
+    struct list_head list;
+    int ret = -1;
+
+    DECLARE_OLD_THIS;
+    __GLFS_ENTRY_VALIDATE_FS((queue ? queue->fs : NULL), invalid_fs);
+
+    INIT_LIST_HEAD(&list);
+
+    pthread_mutex_lock(&queue->mutex);
+    {
+        list_splice_init(&queue->pending, &list);
+        ret = queue->queued;
+        queue->queued = 0;
+    }
+    pthread_mutex_unlock(&queue->mutex);
+
+    /* Requests may complete (and be reaped by another thread) as soon as
+     * they are started, so they can't be touched afterwards. */
+    list_for_each_entry_safe(op, tmp, &list, list)
+    {
+        list_del_init(&op->list);
+        glfs_queue_start(op);
+    }
+
+    __GLFS_EXIT_FS;
+
+invalid_fs:
+    return ret;
+}
+
+GFAPI_SYMVER_PUBLIC_DEFAULT(glfs_queue_reap, 8.0)
+int
+pub_glfs_queue_reap(struct glfs_queue *queue,
+                    struct glfs_completion *completions, int count, int wait)
+{
+    struct glfs_queue_op *op = NULL;
+    int ret = -1;
+
+    DECLARE_OLD_THIS;
+    __GLFS_ENTRY_VALIDATE_FS((queue ? queue->fs : NULL), invalid_fs);
+
+    if (!completions || (count <= 0) || (wait < 0) || (wait > count)) {
+        errno = EINVAL;
+        goto out;
+    }
+
+    pthread_mutex_lock(&queue->mutex);
+    {
+        if (wait > queue->used - queue->queued) {
+            /* It would wait forever. */
+            errno = EINVAL;
+            goto unlock;
+        }
+
+        while (queue->done < wait)
+            pthread_cond_wait(&queue->cond, &queue->mutex);
+
+        for (ret = 0; (ret < count) && !list_empty(&queue->reap); ret++) {
+            op = list_first_entry(&queue->reap, struct glfs_queue_op, list);
+            list_del_init(&op->list);
+            completions[ret] = op->completion;
+            glfs_queue_op_free(op);
+        }
+
+        queue->used -= ret;
+        queue->done -= ret;
+        if ((ret > 0) && (queue->done == 0))
+            glfs_queue_notify_clear(queue);
+    }
+unlock:
+    pthread_mutex_unlock(&queue->mutex);
+
+out:
+    __GLFS_EXIT_FS;
+
+invalid_fs:
+    return ret;
+}
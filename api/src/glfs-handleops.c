@@ -2526,6 +2526,33 @@ pub_glfs_h_anonymous_read(struct glfs *fs, struct glfs_object *object,
     return ret;
 }
 
+/* The API to perform read using anonymous fd without copying the data */
+GFAPI_SYMVER_PUBLIC_DEFAULT(glfs_h_anonymous_read_iobuf, 8.0)
+ssize_t
+pub_glfs_h_anonymous_read_iobuf(struct glfs *fs, struct glfs_object *object,
+                                size_t count, off_t offset,
+                                struct glfs_iobuf **iobuf,
+                                const struct iovec **iov, int *iovcnt)
+{
+    struct glfs_iobuf *gio = NULL;
+    ssize_t ret = 0;
+
+    /* validate in args */
+    if ((fs == NULL) || (object == NULL) || (iobuf == NULL) || (iov == NULL) ||
+        (iovcnt == NULL)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    ret = glfs_anonymous_preadv_iobuf(fs, object, count, offset, 0, &gio);
+
+    *iobuf = gio;
+    *iov = gio ? gio->iov : NULL;
+    *iovcnt = gio ? gio->count : 0;
+
+    return ret;
+}
+
 /* The API to perform write using anonymous fd */
 GFAPI_SYMVER_PUBLIC_DEFAULT(glfs_h_anonymous_write, 3.7.0)
 ssize_t
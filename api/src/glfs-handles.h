@@ -307,6 +307,14 @@ glfs_h_anonymous_read(glfs_t *fs, glfs_object_t *object, const void *buf,
                       size_t count, off_t offset) __THROW
     GFAPI_PUBLIC(glfs_h_anonymous_read, 3.7.0);
 
+/* Same as glfs_h_anonymous_read(), but the buffers are returned without
+ * copying them. See glfs_preadv_iobuf() for details. */
+ssize_t
+glfs_h_anonymous_read_iobuf(glfs_t *fs, glfs_object_t *object, size_t count,
+                            off_t offset, glfs_iobuf_t **iobuf,
+                            const struct iovec **iov, int *iovcnt) __THROW
+    GFAPI_PUBLIC(glfs_h_anonymous_read_iobuf, 8.0);
+
 /*
  * Caution: The object returned by this object gets freed as part
  * of 'glfs_free(xstat)'. Make sure to have a copy using 'glfs_object_copy()'
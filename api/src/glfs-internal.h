@@ -224,6 +224,17 @@ struct glfs {
     void *up_data;          /* Opaque data provided by application
                              * during upcall registration */
     struct list_head waitq; /* waiting synctasks */
+
+    struct list_head buffers; /* regions registered with
+                               * glfs_buffer_register(), protected
+                               * by @mutex */
+};
+
+/* Memory region that can be written without copying it */
+struct glfs_buffer {
+    struct list_head list;
+    void *base;
+    size_t size;
 };
 
 /* This enum is used to maintain the state of glfd. In case of async fops
@@ -294,6 +305,12 @@ struct glfs_xreaddirp_stat {
     uint32_t flags_handled;     /* final set of flags successfulyy handled */
 };
 
+struct glfs_iobuf {
+    struct iobref *iobref; /* keeps the buffers alive until glfs_free() */
+    struct iovec *iov;     /* data returned by the read */
+    int count;
+};
+
 #define DEFAULT_EVENT_POOL_SIZE 16384
 #define GF_MEMPOOL_COUNT_OF_DICT_T 4096
 #define GF_MEMPOOL_COUNT_OF_DATA_T (GF_MEMPOOL_COUNT_OF_DICT_T * 4)
@@ -433,6 +450,9 @@ void
 glfs_process_upcall_event(struct glfs *fs, void *data)
     GFAPI_PRIVATE(glfs_process_upcall_event, 3.7.0);
 
+gf_boolean_t
+glfs_buffer_contains(struct glfs *fs, const struct iovec *iov, int count);
+
 #define __GLFS_ENTRY_VALIDATE_FS(fs, label)                                    \
     do {                                                                       \
         if (!fs) {                                                             \
@@ -650,6 +670,10 @@ glfs_anonymous_preadv(struct glfs *fs, struct glfs_object *object,
                       const struct iovec *iovec, int iovcnt, off_t offset,
                       int flags);
 ssize_t
+glfs_anonymous_preadv_iobuf(struct glfs *fs, struct glfs_object *object,
+                            size_t size, off_t offset, int flags,
+                            struct glfs_iobuf **iobuf);
+ssize_t
 glfs_anonymous_pwritev(struct glfs *fs, struct glfs_object *object,
                        const struct iovec *iovec, int iovcnt, off_t offset,
                        int flags);
@@ -30,6 +30,11 @@ enum glfs_mem_types_ {
     glfs_mt_upcall_inode_t,
     glfs_mt_realpath_t,
     glfs_mt_xreaddirp_stat_t,
+    glfs_mt_iobuf_t,
+    glfs_mt_buffer_t,
+    glfs_mt_wbuf_t,
+    glfs_mt_queue_t,
+    glfs_mt_queue_op_t,
     glfs_mt_end
 };
 #endif
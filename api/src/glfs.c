@@ -141,11 +141,10 @@ glusterfs_ctx_defaults_init(glusterfs_ctx_t *ctx)
     if (!ctx->logbuf_pool)
         goto err;
 
-    INIT_LIST_HEAD(&pool->all_frames);
     INIT_LIST_HEAD(&ctx->cmd_args.xlator_options);
     INIT_LIST_HEAD(&ctx->cmd_args.volfile_servers);
 
-    LOCK_INIT(&pool->lock);
+    call_pool_init(pool);
     ctx->pool = pool;
 
     ret = 0;
@@ -741,6 +740,7 @@ glfs_new_fs(const char *volname)
     INIT_LIST_HEAD(&fs->openfds);
     INIT_LIST_HEAD(&fs->upcall_list);
     INIT_LIST_HEAD(&fs->waitq);
+    INIT_LIST_HEAD(&fs->buffers);
 
     PTHREAD_MUTEX_INIT(&fs->mutex, NULL, fs->pthread_flags, GLFS_INIT_MUTEX,
                        err);
@@ -943,10 +943,18 @@ priv_glfs_free_from_ctx(struct glfs *fs)
 {
     upcall_entry *u_list = NULL;
     upcall_entry *tmp = NULL;
+    struct glfs_buffer *buffer = NULL;
+    struct glfs_buffer *tmp_buffer = NULL;
 
     if (!fs)
         return;
 
+    list_for_each_entry_safe(buffer, tmp_buffer, &fs->buffers, list)
+    {
+        list_del_init(&buffer->list);
+        GF_FREE(buffer);
+    }
+
     /* cleanup upcall structures */
     list_for_each_entry_safe(u_list, tmp, &fs->upcall_list, upcall_list)
     {
@@ -1192,7 +1200,7 @@ glusterfs_ctx_destroy(glusterfs_ctx_t *ctx)
             mem_pool_destroy(pool->frame_mem_pool);
         if (pool->stack_mem_pool)
             mem_pool_destroy(pool->stack_mem_pool);
-        LOCK_DESTROY(&pool->lock);
+        call_pool_fini(pool);
         GF_FREE(pool);
     }
 
@@ -1272,12 +1280,12 @@ pub_glfs_fini(struct glfs *fs)
         pthread_mutex_lock(&fs->mutex);
         {
             /* Do we need to increase countdown? */
-            if ((!call_pool->cnt) && (!fs->pin_refcnt)) {
+            if ((!call_pool_count(call_pool)) && (!fs->pin_refcnt)) {
                 gf_msg_trace("glfs", 0,
                              "call_pool_cnt - %" PRId64
                              ","
                              "pin_refcnt - %d",
-                             call_pool->cnt, fs->pin_refcnt);
+                             call_pool_count(call_pool), fs->pin_refcnt);
 
                 ctx->cleanup_started = 1;
                 pthread_mutex_unlock(&fs->mutex);
@@ -1292,7 +1300,7 @@ pub_glfs_fini(struct glfs *fs)
 
     /*We deem glfs_fini as successful if there are no pending frames in the call
      *pool*/
-    ret = (call_pool->cnt == 0) ? 0 : -1;
+    ret = (call_pool_count(call_pool) == 0) ? 0 : -1;
 
     pthread_mutex_lock(&fs->mutex);
     {
@@ -1804,3 +1812,126 @@ err:
 invalid_fs:
     return -1;
 }
+
+GFAPI_SYMVER_PUBLIC_DEFAULT(glfs_buffer_register, 8.0)
+int
+pub_glfs_buffer_register(struct glfs *fs, void *base, size_t size)
+{
+    struct glfs_buffer *buffer = NULL;
+    struct glfs_buffer *trav = NULL;
+    int ret = -1;
+
+    DECLARE_OLD_THIS;
+    __GLFS_ENTRY_VALIDATE_FS(fs, invalid_fs);
+
+    if (!base || (size == 0)) {
+        errno = EINVAL;
+        goto out;
+    }
+
+    buffer = GF_CALLOC(1, sizeof(*buffer), glfs_mt_buffer_t);
+    if (!buffer) {
+        errno = ENOMEM;
+        goto out;
+    }
+
+    INIT_LIST_HEAD(&buffer->list);
+    buffer->base = base;
+    buffer->size = size;
+
+    pthread_mutex_lock(&fs->mutex);
+    {
+        list_for_each_entry(trav, &fs->buffers, list)
+        {
+            if ((base < trav->base + trav->size) &&
+                (trav->base < base + size)) {
+                errno = EEXIST;
+                goto unlock;
+            }
+        }
+
+        list_add_tail(&buffer->list, &fs->buffers);
+        buffer = NULL;
+        ret = 0;
+    }
+unlock:
+    pthread_mutex_unlock(&fs->mutex);
+
+    GF_FREE(buffer);
+
+out:
+    __GLFS_EXIT_FS;
+
+invalid_fs:
+    return ret;
+}
+
+GFAPI_SYMVER_PUBLIC_DEFAULT(glfs_buffer_unregister, 8.0)
+int
+pub_glfs_buffer_unregister(struct glfs *fs, void *base)
+{
+    struct glfs_buffer *buffer = NULL;
+    struct glfs_buffer *trav = NULL;
+    int ret = -1;
+
+    DECLARE_OLD_THIS;
+    __GLFS_ENTRY_VALIDATE_FS(fs, invalid_fs);
+
+    pthread_mutex_lock(&fs->mutex);
+    {
+        list_for_each_entry(trav, &fs->buffers, list)
+        {
+            if (trav->base == base) {
+                list_del_init(&trav->list);
+                buffer = trav;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&fs->mutex);
+
+    if (!buffer) {
+        errno = ENOENT;
+        goto out;
+    }
+
+    GF_FREE(buffer);
+    ret = 0;
+
+out:
+    __GLFS_EXIT_FS;
+
+invalid_fs:
+    return ret;
+}
+
+/* Checks that all the vectors lie inside registered regions. */
+gf_boolean_t
+glfs_buffer_contains(struct glfs *fs, const struct iovec *iov, int count)
+{
+    struct glfs_buffer *trav = NULL;
+    gf_boolean_t found = _gf_true;
+    int i = 0;
+
+    pthread_mutex_lock(&fs->mutex);
+    {
+        for (i = 0; found && (i < count); i++) {
+            if (iov[i].iov_len == 0)
+                continue;
+
+            found = _gf_false;
+            list_for_each_entry(trav, &fs->buffers, list)
+            {
+                if ((iov[i].iov_base >= trav->base) &&
+                    (iov[i].iov_base + iov[i].iov_len <=
+                     trav->base + trav->size)) {
+                    found = _gf_true;
+                    break;
+                }
+            }
+        }
+    }
+    pthread_mutex_unlock(&fs->mutex);
+
+    return found;
+}
@@ -1481,5 +1481,297 @@ int
 glfs_set_statedump_path(struct glfs *fs, const char *path) __THROW
     GFAPI_PUBLIC(glfs_set_statedump_path, 7.0);
 
+/*
+ * Buffers returned by glfs_preadv_iobuf() and glfs_h_anonymous_read_iobuf()
+ */
+struct glfs_iobuf;
+typedef struct glfs_iobuf glfs_iobuf_t;
+
+/*
+  SYNOPSIS
+
+  glfs_preadv_iobuf: Read from a file without copying the data.
+
+  DESCRIPTION
+
+  This function reads up to @size bytes at @offset like glfs_preadv(), but
+  instead of copying the data into buffers supplied by the application, it
+  returns the buffers where the data was received from the network. The
+  application must release them with glfs_free() once it's done with the
+  data. Until then the memory remains valid and must not be modified.
+
+  PARAMETERS
+
+  @glfd: The fd of the file to read from.
+
+  @size: Maximum number of bytes to read.
+
+  @offset: Offset of the file where the read starts.
+
+  @flags: Same as in glfs_preadv().
+
+  @iobuf: On success, it contains the object holding the buffers. It will be
+          NULL if no data has been read.
+
+  @iov: On success, it points to the array of buffers containing the data.
+
+  @iovcnt: On success, it contains the number of entries in @iov.
+
+  @poststat: If not NULL, it's filled with the attributes of the file after
+             the read.
+
+  RETURN VALUES
+
+  >=0 : Number of bytes read.
+  -1  : Failure. @errno will be set with the type of failure.
+
+ */
+
+ssize_t
+glfs_preadv_iobuf(glfs_fd_t *glfd, size_t size, off_t offset, int flags,
+                  glfs_iobuf_t **iobuf, const struct iovec **iov, int *iovcnt,
+                  struct glfs_stat *poststat) __THROW
+    GFAPI_PUBLIC(glfs_preadv_iobuf, 8.0);
+
+/*
+  SYNOPSIS
+
+  glfs_buffer_register: Register a memory region for copy-free writes.
+
+  glfs_buffer_unregister: Unregister a region registered with
+                          glfs_buffer_register().
+
+  DESCRIPTION
+
+  Data passed to glfs_pwritev() and friends is copied before being sent,
+  because the application is free to reuse its buffers as soon as the call
+  returns. Writes issued with glfs_pwritev_registered() or
+  glfs_pwritev_registered_async() use the application's memory directly
+  instead, but only if it lies inside a region registered with this function.
+
+  A region can't overlap another registered region. It must not be
+  unregistered nor freed while writes using it are still pending, i.e. before
+  all their release callbacks have been invoked.
+
+  PARAMETERS
+
+  @fs: The 'virtual mount' object.
+
+  @base: Start address of the region.
+
+  @size: Size of the region in bytes.
+
+  RETURN VALUES
+
+  0  : Success.
+  -1 : Failure. @errno will be set with the type of failure.
+
+ */
+
+int
+glfs_buffer_register(glfs_t *fs, void *base, size_t size) __THROW
+    GFAPI_PUBLIC(glfs_buffer_register, 8.0);
+
+int
+glfs_buffer_unregister(glfs_t *fs, void *base) __THROW
+    GFAPI_PUBLIC(glfs_buffer_unregister, 8.0);
+
+/*
+ * Called once the memory of a write from registered buffers can be modified
+ * or reused again.
+ */
+typedef void (*glfs_buffer_cbk)(void *data);
+
+/*
+  SYNOPSIS
+
+  glfs_pwritev_registered: Write to a file without copying the data.
+
+  glfs_pwritev_registered_async: Asynchronous version of the above.
+
+  DESCRIPTION
+
+  These functions work like glfs_pwritev() and glfs_pwritev_async(), but the
+  data is sent directly from the application's buffers, which must belong to
+  regions registered with glfs_buffer_register().
+
+  Some translators may keep a reference to the data after the write has
+  completed (write-behind, for example), so the buffers can't be reused when
+  the call returns or the completion callback is called. Instead, @release is
+  invoked once no one is using them anymore. It's always called exactly once,
+  even if the write fails, and it can be called from any thread, including
+  the caller's one before returning.
+
+  PARAMETERS
+
+  @glfd, @iov, @iovcnt/@count, @offset, @flags, @prestat, @poststat, @fn and
+  @data: Same as in glfs_pwritev() and glfs_pwritev_async().
+
+  @release: Function called when the buffers can be reused.
+
+  @release_data: Opaque pointer passed to @release.
+
+  RETURN VALUES
+
+  Same as glfs_pwritev() and glfs_pwritev_async(). If any of the buffers is
+  not inside a registered region, -1 is returned with @errno set to EINVAL.
+
+ */
+
+ssize_t
+glfs_pwritev_registered(glfs_fd_t *fd, const struct iovec *iov, int iovcnt,
+                        off_t offset, int flags, struct glfs_stat *prestat,
+                        struct glfs_stat *poststat, glfs_buffer_cbk release,
+                        void *release_data) __THROW
+    GFAPI_PUBLIC(glfs_pwritev_registered, 8.0);
+
+int
+glfs_pwritev_registered_async(glfs_fd_t *fd, const struct iovec *iov,
+                              int count, off_t offset, int flags,
+                              glfs_io_cbk fn, void *data,
+                              glfs_buffer_cbk release, void *release_data)
+    __THROW GFAPI_PUBLIC(glfs_pwritev_registered_async, 8.0);
+
+/*
+ * Submission and completion queues
+ */
+struct glfs_queue;
+typedef struct glfs_queue glfs_queue_t;
+
+struct glfs_completion {
+    void *data;     /* opaque pointer given when the request was queued */
+    ssize_t ret;    /* same as the return value of the synchronous call */
+    int op_errno;   /* errno of the request when @ret is -1 */
+    glfs_fd_t *fd;  /* new fd, for glfs_queue_open() and glfs_queue_creat() */
+};
+
+/*
+  SYNOPSIS
+
+  glfs_queue_new: Create a queue to batch requests.
+
+  glfs_queue_destroy: Destroy a queue created with glfs_queue_new().
+
+  DESCRIPTION
+
+  A queue lets the application prepare many requests with the glfs_queue_*()
+  functions below, start all of them at once with glfs_queue_submit(), and
+  later collect their results with glfs_queue_reap(). No application callback
+  is invoked from gfapi threads.
+
+  Each function queuing a request takes the same arguments as its synchronous
+  counterpart (glfs_preadv(), glfs_stat(), glfs_open(), ...), plus an opaque
+  @data pointer that is returned in the completion. Buffers (read vectors,
+  stat structures, xattr values) must remain valid until the request is
+  reaped. Paths, names and the iovec arrays themselves are copied.
+
+  A queue holds at most @entries requests, counting the ones queued, running
+  or completed but not yet reaped. When it's full, queuing fails with EAGAIN.
+
+  glfs_queue_destroy() discards requests not yet submitted, but fails with
+  EBUSY while there are submitted requests not reaped.
+
+  PARAMETERS
+
+  @fs: The 'virtual mount' object.
+
+  @entries: Maximum number of requests held by the queue.
+
+  RETURN VALUES
+
+  glfs_queue_new() returns NULL on failure, glfs_queue_destroy() returns -1.
+  @errno will be set with the type of failure.
+
+ */
+
+glfs_queue_t *
+glfs_queue_new(glfs_t *fs, int entries) __THROW
+    GFAPI_PUBLIC(glfs_queue_new, 8.0);
+
+int
+glfs_queue_destroy(glfs_queue_t *queue) __THROW
+    GFAPI_PUBLIC(glfs_queue_destroy, 8.0);
+
+int
+glfs_queue_preadv(glfs_queue_t *queue, glfs_fd_t *fd, const struct iovec *iov,
+                  int iovcnt, off_t offset, int flags, void *data) __THROW
+    GFAPI_PUBLIC(glfs_queue_preadv, 8.0);
+
+int
+glfs_queue_pwritev(glfs_queue_t *queue, glfs_fd_t *fd, const struct iovec *iov,
+                   int iovcnt, off_t offset, int flags, void *data) __THROW
+    GFAPI_PUBLIC(glfs_queue_pwritev, 8.0);
+
+int
+glfs_queue_fsync(glfs_queue_t *queue, glfs_fd_t *fd, void *data) __THROW
+    GFAPI_PUBLIC(glfs_queue_fsync, 8.0);
+
+int
+glfs_queue_fstat(glfs_queue_t *queue, glfs_fd_t *fd, struct stat *buf,
+                 void *data) __THROW GFAPI_PUBLIC(glfs_queue_fstat, 8.0);
+
+int
+glfs_queue_stat(glfs_queue_t *queue, const char *path, struct stat *buf,
+                void *data) __THROW GFAPI_PUBLIC(glfs_queue_stat, 8.0);
+
+int
+glfs_queue_open(glfs_queue_t *queue, const char *path, int flags,
+                void *data) __THROW GFAPI_PUBLIC(glfs_queue_open, 8.0);
+
+int
+glfs_queue_creat(glfs_queue_t *queue, const char *path, int flags, mode_t mode,
+                 void *data) __THROW GFAPI_PUBLIC(glfs_queue_creat, 8.0);
+
+int
+glfs_queue_unlink(glfs_queue_t *queue, const char *path, void *data) __THROW
+    GFAPI_PUBLIC(glfs_queue_unlink, 8.0);
+
+int
+glfs_queue_getxattr(glfs_queue_t *queue, const char *path, const char *name,
+                    void *value, size_t size, void *data) __THROW
+    GFAPI_PUBLIC(glfs_queue_getxattr, 8.0);
+
+/*
+  SYNOPSIS
+
+  glfs_queue_submit: Start all the requests queued so far.
+
+  glfs_queue_reap: Collect the results of completed requests.
+
+  glfs_queue_fd: Get a descriptor to wait for completions.
+
+  DESCRIPTION
+
+  glfs_queue_submit() starts every queued request and returns how many were
+  started. Requests that fail to start are completed with an error.
+
+  glfs_queue_reap() copies up to @count completions into @completions, in
+  the order they finished. If @wait is not 0, it blocks until at least @wait
+  requests have completed. Asking to wait for more requests than those
+  submitted and not yet reaped fails with EINVAL.
+
+  glfs_queue_fd() returns a file descriptor that becomes readable when there
+  are completions to reap, and stays readable until all of them have been
+  reaped. It can be used with poll() or epoll, but must not be read nor
+  closed by the application.
+
+  RETURN VALUES
+
+  >=0 : Number of requests submitted or reaped, or the file descriptor.
+  -1  : Failure. @errno will be set with the type of failure.
+
+ */
+
+int
+glfs_queue_submit(glfs_queue_t *queue) __THROW
+    GFAPI_PUBLIC(glfs_queue_submit, 8.0);
+
+int
+glfs_queue_reap(glfs_queue_t *queue, struct glfs_completion *completions,
+                int count, int wait) __THROW GFAPI_PUBLIC(glfs_queue_reap, 8.0);
+
+int
+glfs_queue_fd(glfs_queue_t *queue) __THROW GFAPI_PUBLIC(glfs_queue_fd, 8.0);
+
 __END_DECLS
 #endif /* !_GLFS_H */
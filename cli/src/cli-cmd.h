@@ -68,6 +68,7 @@ typedef struct cli_profile_info_ {
     double avg_latency;
     char *fop_name;
     double percentage_avg_latency;
+    uint64_t pct_latency[GF_LATENCY_PERCENTILES];
 } cli_profile_info_t;
 
 typedef struct cli_cmd_volume_get_ctx_ cli_cmd_volume_get_ctx_t;
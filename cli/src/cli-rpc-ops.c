@@ -5327,6 +5327,7 @@ cmd_profile_volume_brick_out(dict_t *dict, int count, int interval)
 {
     char key[256] = {0};
     int i = 0;
+    int j = 0;
     uint64_t sec = 0;
     uint64_t r_count = 0;
     uint64_t w_count = 0;
@@ -5396,6 +5397,15 @@ cmd_profile_volume_brick_out(dict_t *dict, int count, int interval)
         if (ret) {
             gf_log("cli", GF_LOG_DEBUG, "failed to get %s from dict", key);
         }
+
+        for (j = 0; j < GF_LATENCY_PERCENTILES; j++) {
+            snprintf(key, sizeof(key), "%d-%d-%d-%slatency", count, interval, i,
+                     gf_latency_percentile_names[j]);
+            ret = dict_get_uint64(dict, key, &profile_info[i].pct_latency[j]);
+            if (ret) {
+                gf_log("cli", GF_LOG_DEBUG, "failed to get %s from dict", key);
+            }
+        }
         profile_info[i].fop_name = (char *)gf_fop_list[i];
 
         total_percentage_latency += (profile_info[i].fop_hits *
@@ -5499,6 +5509,26 @@ cmd_profile_volume_brick_out(dict_t *dict, int count, int interval)
         }
     }
 
+    is_header_printed = 0;
+    for (i = 0; i < GF_FOP_MAXVALUE; i++) {
+        /* Bricks which don't keep histograms send no percentiles. */
+        if (profile_info[i].pct_latency[0] == 0)
+            continue;
+        if (is_header_printed == 0) {
+            cli_out(" ");
+            cli_out("%13s %13s %13s %13s %11s", "P50-latency", "P90-latency",
+                    "P99-latency", "P99.9-latency", "Fop");
+            cli_out("%13s %13s %13s %13s %11s", "-----------", "-----------",
+                    "-----------", "-------------", "----");
+            is_header_printed = 1;
+        }
+        cli_out("%10" PRIu64 " ns %10" PRIu64 " ns %10" PRIu64 " ns %10" PRIu64
+                " ns %11s",
+                profile_info[i].pct_latency[0], profile_info[i].pct_latency[1],
+                profile_info[i].pct_latency[2], profile_info[i].pct_latency[3],
+                profile_info[i].fop_name);
+    }
+
     for (i = 0; i < GF_UPCALL_FLAGS_MAXVALUE; i++) {
         if (upcall_info[i].fop_hits == 0)
             continue;
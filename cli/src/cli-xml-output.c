@@ -1927,11 +1927,13 @@ cli_xml_output_vol_profile_stats(xmlTextWriterPtr writer, dict_t *dict,
     double avg_latency = 0.0;
     double max_latency = 0.0;
     double min_latency = 0.0;
+    uint64_t pct_latency = 0;
     uint64_t duration = 0;
     uint64_t total_read = 0;
     uint64_t total_write = 0;
     char key[1024] = {0};
     int i = 0;
+    int j = 0;
 
     /* <cumulativeStats> || <intervalStats> */
     if (interval == -1)
@@ -2032,6 +2034,18 @@ cli_xml_output_vol_profile_stats(xmlTextWriterPtr writer, dict_t *dict,
                                               "%f", max_latency);
         XML_RET_CHECK_AND_GOTO(ret, out);
 
+        for (j = 0; j < GF_LATENCY_PERCENTILES; j++) {
+            snprintf(key, sizeof(key), "%d-%d-%d-%slatency", brick_index,
+                     interval, i, gf_latency_percentile_names[j]);
+            if (dict_get_uint64(dict, key, &pct_latency))
+                continue;
+            snprintf(key, sizeof(key), "%sLatency",
+                     gf_latency_percentile_names[j]);
+            ret = xmlTextWriterWriteFormatElement(writer, (xmlChar *)key,
+                                                  "%" PRIu64, pct_latency);
+            XML_RET_CHECK_AND_GOTO(ret, out);
+        }
+
         /* </fop> */
         ret = xmlTextWriterEndElement(writer);
         XML_RET_CHECK_AND_GOTO(ret, out);
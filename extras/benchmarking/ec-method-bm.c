@@ -0,0 +1,345 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/* ec-method-bm: encoding and decoding throughput of cluster/disperse for each
+ * code generator the cpu supports, with both the usual and the systematic
+ * layout. For each configuration given on the command line as
+ * data+redundancy, the fragments encoded by every generator have to be the
+ * same as the ones of the C code, and the data has to be decoded back from
+ * every set of fragments enough to rebuild it. With -t, the same is done with
+ * that many threads helping to encode and decode.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <glusterfs/glusterfs.h>
+#include <glusterfs/globals.h>
+#include <glusterfs/mem-pool.h>
+#include <glusterfs/xlator.h>
+
+#include "ec-types.h"
+#include "ec-method.h"
+
+/* Data encoded and decoded at once by each generator */
+#define BENCH_BUFFER (4 * 1024 * 1024)
+
+/* Stripes encoded to check every set of fragments */
+#define CHECK_STRIPES 2
+
+static const char *generators[] = {"none", "x64", "sse", "avx", "avx512"};
+
+static const char *default_configs[] = {"2+1", "4+2", "8+3", "8+4", "16+4"};
+
+static uint32_t threads;
+
+/* Data encoded and decoded by each generator to measure its throughput */
+static uint64_t total = 256 * 1024 * 1024;
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void *
+buffer_alloc(uint64_t size)
+{
+    void *ptr;
+
+    if (posix_memalign(&ptr, EC_METHOD_WORD_SIZE, size) != 0) {
+        fprintf(stderr, "Unable to allocate %lu bytes\n", size);
+        exit(1);
+    }
+
+    return ptr;
+}
+
+static void
+buffer_fill(uint8_t *buffer, uint64_t size)
+{
+    uint64_t i;
+
+    for (i = 0; i < size; i++) {
+        buffer[i] = random();
+    }
+}
+
+static void
+fragments_encode(ec_matrix_list_t *list, uint64_t size, void *data,
+                 uint8_t *fragments)
+{
+    void *blocks[list->rows];
+    uint32_t i;
+
+    for (i = 0; i < list->rows; i++) {
+        blocks[i] = fragments + i * (size / list->columns);
+    }
+    ec_method_encode(list, size, data, blocks);
+}
+
+static int
+fragments_decode(ec_matrix_list_t *list, uint64_t size, uintptr_t mask,
+                 uint8_t *fragments, void *data)
+{
+    uint32_t rows[list->columns];
+    void *blocks[list->columns];
+    uint32_t i, count;
+
+    count = 0;
+    for (i = 0; i < list->rows; i++) {
+        if ((mask & (1ULL << i)) != 0) {
+            rows[count] = i + 1;
+            blocks[count++] = fragments + i * (size / list->columns);
+        }
+    }
+
+    return ec_method_decode(list, size / list->columns, mask, rows, blocks,
+                            data);
+}
+
+/* Returns the next mask with the same number of bits set. */
+static uintptr_t
+mask_next(uintptr_t mask)
+{
+    uintptr_t low = mask & -mask;
+    uintptr_t high = mask + low;
+
+    return high | (((mask ^ high) >> 2) / low);
+}
+
+/* Encodes a small buffer and decodes it back from every set of fragments
+ * enough to rebuild it. The fragments are compared with the reference unless
+ * it's going to be set from them. */
+static int
+check_masks(ec_matrix_list_t *list, const char *name, uint8_t *reference,
+            gf_boolean_t set, uint32_t *count)
+{
+    uint64_t size = CHECK_STRIPES * list->stripe;
+    uint8_t *data, *fragments, *decoded;
+    uintptr_t mask, last;
+    int ret = 0;
+
+    data = buffer_alloc(size);
+    fragments = buffer_alloc(size / list->columns * list->rows);
+    decoded = buffer_alloc(size);
+
+    srandom(list->columns + list->rows);
+    buffer_fill(data, size);
+    fragments_encode(list, size, data, fragments);
+    if (set) {
+        memcpy(reference, fragments, size / list->columns * list->rows);
+    } else if (memcmp(fragments, reference,
+                      size / list->columns * list->rows) != 0) {
+        fprintf(stderr, "%s: fragments differ from the ones of the C code\n",
+                name);
+        ret = -1;
+        goto out;
+    }
+
+    *count = 0;
+    mask = (1ULL << list->columns) - 1;
+    last = mask << (list->rows - list->columns);
+    while (1) {
+        memset(decoded, 0, size);
+        if ((fragments_decode(list, size, mask, fragments, decoded) != 0) ||
+            (memcmp(decoded, data, size) != 0)) {
+            fprintf(stderr, "%s: wrong data decoded from fragments %lx\n", name,
+                    mask);
+            ret = -1;
+            goto out;
+        }
+        (*count)++;
+        if (mask == last) {
+            break;
+        }
+        mask = mask_next(mask);
+    }
+
+out:
+    free(data);
+    free(fragments);
+    free(decoded);
+
+    return ret;
+}
+
+static int
+check_config(uint32_t columns, uint32_t redundancy, gf_boolean_t systematic)
+{
+    ec_matrix_list_t list;
+    uint32_t rows = columns + redundancy;
+    uint64_t size, fragments_size, loops, i;
+    uint8_t *data, *fragments, *decoded, *reference, *check_reference;
+    uint32_t g, count;
+    uintptr_t mask;
+    double encode, decode;
+    char name[64];
+    int ret = 0;
+
+    size = BENCH_BUFFER / (EC_METHOD_CHUNK_SIZE * columns) *
+           (EC_METHOD_CHUNK_SIZE * columns);
+    fragments_size = size / columns * rows;
+    loops = (total + size - 1) / size;
+
+    data = buffer_alloc(size);
+    decoded = buffer_alloc(size);
+    fragments = buffer_alloc(fragments_size);
+    reference = buffer_alloc(fragments_size);
+    check_reference = buffer_alloc(CHECK_STRIPES * EC_METHOD_CHUNK_SIZE *
+                                   rows);
+
+    srandom(columns * 1000 + redundancy);
+    buffer_fill(data, size);
+
+    /* The fragments read the most from the redundancy bricks */
+    mask = ((1ULL << columns) - 1) << redundancy;
+
+    for (g = 0; g < sizeof(generators) / sizeof(generators[0]); g++) {
+        snprintf(name, sizeof(name), "%u+%u %s %s", columns, redundancy,
+                 systematic ? "systematic" : "normal", generators[g]);
+
+        memset(&list, 0, sizeof(list));
+        if (ec_method_init(THIS, &list, columns, rows, rows * 2, generators[g],
+                           systematic) != 0) {
+            fprintf(stderr, "%s: unable to initialize\n", name);
+            ret = -1;
+            goto out;
+        }
+        if ((g > 0) && ((list.code->gen == NULL) ||
+                        (strcmp(list.code->gen->name, generators[g]) != 0))) {
+            printf("%-24s not supported\n", name);
+            ec_method_fini(&list);
+            continue;
+        }
+        ec_method_parallel(THIS, &list, threads, 0);
+
+        encode = now();
+        for (i = 0; i < loops; i++) {
+            fragments_encode(&list, size, data, fragments);
+        }
+        encode = now() - encode;
+
+        if (g == 0) {
+            memcpy(reference, fragments, fragments_size);
+        } else if (memcmp(fragments, reference, fragments_size) != 0) {
+            fprintf(stderr, "%s: fragments differ from the ones of the C code\n",
+                    name);
+            ret = -1;
+        }
+
+        decode = now();
+        for (i = 0; (ret == 0) && (i < loops); i++) {
+            if (fragments_decode(&list, size, mask, fragments, decoded) != 0) {
+                fprintf(stderr, "%s: unable to decode\n", name);
+                ret = -1;
+            }
+        }
+        decode = now() - decode;
+
+        if ((ret == 0) && (memcmp(decoded, data, size) != 0)) {
+            fprintf(stderr, "%s: wrong data decoded\n", name);
+            ret = -1;
+        }
+
+        if (ret == 0) {
+            ret = check_masks(&list, name, check_reference, g == 0, &count);
+        }
+
+        ec_method_fini(&list);
+
+        if (ret != 0) {
+            goto out;
+        }
+
+        printf("%-24s encode %6.2f GB/s  decode %6.2f GB/s  %u sets of "
+               "fragments\n",
+               name, size * loops / encode / 1e9, size * loops / decode / 1e9,
+               count);
+    }
+
+out:
+    free(data);
+    free(decoded);
+    free(fragments);
+    free(reference);
+    free(check_reference);
+
+    return ret;
+}
+
+int
+main(int argc, char *argv[])
+{
+    glusterfs_ctx_t *ctx;
+    const char **configs = default_configs;
+    uint32_t count = sizeof(default_configs) / sizeof(default_configs[0]);
+    uint32_t i, columns, redundancy;
+    int opt, ret = 0;
+
+    while ((opt = getopt(argc, argv, "s:t:")) != -1) {
+        switch (opt) {
+            case 's':
+                total = strtoull(optarg, NULL, 10) * 1024 * 1024;
+                break;
+            case 't':
+                threads = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr,
+                        "usage: %s [-s size in MB] [-t threads] "
+                        "[data+redundancy]...\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+    if (total == 0) {
+        fprintf(stderr, "Invalid size\n");
+        return 1;
+    }
+    if (optind < argc) {
+        configs = (const char **)argv + optind;
+        count = argc - optind;
+    }
+
+    ctx = glusterfs_ctx_new();
+    if ((ctx == NULL) || (glusterfs_globals_init(ctx) != 0)) {
+        fprintf(stderr, "Unable to initialize the context\n");
+        return 1;
+    }
+    THIS->ctx = ctx;
+    mem_pools_init();
+
+    for (i = 0; i < count; i++) {
+        if ((sscanf(configs[i], "%u+%u", &columns, &redundancy) != 2) ||
+            (columns < 1) || (redundancy < 1) ||
+            (columns > EC_METHOD_MAX_FRAGMENTS) ||
+            (columns + redundancy > 32)) {
+            fprintf(stderr, "Invalid configuration '%s'\n", configs[i]);
+            return 1;
+        }
+
+        if ((check_config(columns, redundancy, _gf_false) != 0) ||
+            (check_config(columns, redundancy, _gf_true) != 0)) {
+            ret = 1;
+        }
+    }
+
+    mem_pools_fini();
+
+    return ret;
+}
@@ -0,0 +1,269 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/* inode-bm: looks up, references and releases the inodes of a directory
+ * from several threads, like fops coming from many clients do, and reports
+ * how many lookups can be handled per second. Some of them also forget and
+ * unlink the inode, so that inodes are retired and linked again while other
+ * threads are still using them. At the end all the inodes are forgotten and
+ * the lists of the table are checked.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <glusterfs/glusterfs.h>
+#include <glusterfs/globals.h>
+#include <glusterfs/mem-pool.h>
+#include <glusterfs/inode.h>
+#include <glusterfs/xlator.h>
+#include <glusterfs/timespec.h>
+
+static glusterfs_ctx_t *ctx;
+static inode_table_t *table;
+static long count = 1000000;
+static int files = 10000;
+static int threads = 64;
+static int lru_limit = 4096;
+static uuid_t *gfids;
+static pthread_barrier_t barrier;
+
+struct worker {
+    pthread_t thread;
+    unsigned int seed;
+    long count;
+    double time;
+};
+
+static double
+elapsed(struct timespec *start)
+{
+    struct timespec now;
+
+    timespec_now(&now);
+
+    return (TS(now) - TS((*start))) / 1e9;
+}
+
+static inode_t *
+bm_link(int idx)
+{
+    struct iatt iatt = {
+        0,
+    };
+    inode_t *inode;
+    inode_t *linked;
+    char name[32];
+
+    snprintf(name, sizeof(name), "file-%d", idx);
+    gf_uuid_copy(iatt.ia_gfid, gfids[idx]);
+    iatt.ia_type = IA_IFREG;
+
+    inode = inode_new(table);
+    if (inode == NULL) {
+        fprintf(stderr, "inode_new() failed\n");
+        exit(1);
+    }
+    linked = inode_link(inode, table->root, name, &iatt);
+    if (linked == NULL) {
+        fprintf(stderr, "inode_link() failed\n");
+        exit(1);
+    }
+    inode_lookup(linked);
+    inode_unref(inode);
+
+    return linked;
+}
+
+static void *
+bm_worker(void *data)
+{
+    struct worker *worker = data;
+    struct timespec start;
+    inode_t *inode;
+    char name[32];
+    long i;
+    int idx;
+
+    pthread_barrier_wait(&barrier);
+
+    timespec_now(&start);
+    for (i = 0; i < worker->count; i++) {
+        idx = rand_r(&worker->seed) % files;
+        if (i & 1) {
+            inode = inode_find(table, gfids[idx]);
+        } else {
+            snprintf(name, sizeof(name), "file-%d", idx);
+            inode = inode_grep(table, table->root, name);
+        }
+        if (inode == NULL) {
+            inode = bm_link(idx);
+        } else if (gf_uuid_compare(inode->gfid, gfids[idx]) != 0) {
+            fprintf(stderr, "wrong inode found for file-%d\n", idx);
+            exit(1);
+        }
+
+        /* References taken and released while the inode is in use */
+        inode_unref(inode_ref(inode));
+
+        if (rand_r(&worker->seed) % 64 == 0) {
+            snprintf(name, sizeof(name), "file-%d", idx);
+            inode_unlink(inode, table->root, name);
+            inode_forget(inode, 0);
+        }
+
+        inode_unref(inode);
+    }
+    worker->time = elapsed(&start);
+
+    return NULL;
+}
+
+/* Checks that the counters of the shards match their lists, and that only
+ * the root inode is left. */
+static int
+bm_check(void)
+{
+    struct _inode_shard *shard;
+    inode_t *inode;
+    uint32_t active = 0;
+    uint32_t lru = 0;
+    uint32_t size;
+    uint32_t i;
+    int ret = 0;
+
+    for (i = 0; i < table->shard_count; i++) {
+        shard = &table->shards[i];
+
+        size = 0;
+        list_for_each_entry(inode, &shard->active, list) size++;
+        if (size != shard->active_size) {
+            fprintf(stderr, "shard %u: %u active inodes, counted %u\n", i,
+                    size, shard->active_size);
+            ret = -1;
+        }
+        active += size;
+
+        size = 0;
+        list_for_each_entry(inode, &shard->lru, list) size++;
+        if (size != shard->lru_size) {
+            fprintf(stderr, "shard %u: %u lru inodes, counted %u\n", i, size,
+                    shard->lru_size);
+            ret = -1;
+        }
+        lru += size;
+    }
+
+    if ((active != 1) || (lru != 0) || (table->lru_size != 0) ||
+        (table->purge_size != 0)) {
+        fprintf(stderr,
+                "%u active, %u lru (%u in the table) and %u purged inodes "
+                "left\n",
+                active, lru, table->lru_size, table->purge_size);
+        ret = -1;
+    }
+
+    return ret;
+}
+
+int
+main(int argc, char *argv[])
+{
+    static glusterfs_graph_t graph;
+    static xlator_t xl;
+    struct worker *workers;
+    inode_t *inode;
+    char name[32];
+    double time = 0;
+    int opt, i;
+
+    while ((opt = getopt(argc, argv, "c:f:l:t:")) != -1) {
+        switch (opt) {
+            case 'c':
+                count = atol(optarg);
+                break;
+            case 'f':
+                files = atoi(optarg);
+                break;
+            case 'l':
+                lru_limit = atoi(optarg);
+                break;
+            case 't':
+                threads = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr,
+                        "usage: %s [-c lookups] [-f files] [-l lru limit] "
+                        "[-t threads]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+    if ((count <= 0) || (files <= 0) || (lru_limit < 0) || (threads <= 0)) {
+        fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+
+    ctx = glusterfs_ctx_new();
+    if ((ctx == NULL) || (glusterfs_globals_init(ctx) != 0)) {
+        fprintf(stderr, "failed to initialize the context\n");
+        return 1;
+    }
+    THIS->ctx = ctx;
+    mem_pools_init();
+
+    graph.xl_count = 1;
+    xl.name = "inode-bm";
+    xl.ctx = ctx;
+    xl.graph = &graph;
+
+    table = inode_table_new(lru_limit, &xl, 0, 0);
+    gfids = calloc(files, sizeof(uuid_t));
+    workers = calloc(threads, sizeof(*workers));
+    if ((table == NULL) || (gfids == NULL) || (workers == NULL)) {
+        fprintf(stderr, "failed to create the inode table\n");
+        return 1;
+    }
+
+    for (i = 0; i < files; i++) {
+        gf_uuid_generate(gfids[i]);
+        inode_unref(bm_link(i));
+    }
+
+    pthread_barrier_init(&barrier, NULL, threads);
+
+    for (i = 0; i < threads; i++) {
+        workers[i].seed = i;
+        workers[i].count = count / threads + (i < count % threads);
+        pthread_create(&workers[i].thread, NULL, bm_worker, &workers[i]);
+    }
+    for (i = 0; i < threads; i++) {
+        pthread_join(workers[i].thread, NULL);
+        if (workers[i].time > time)
+            time = workers[i].time;
+    }
+
+    printf("%ld lookups of %d files from %d threads in %.3f s (%.0f/s)\n",
+           count, files, threads, time, count / time);
+
+    for (i = 0; i < files; i++) {
+        inode = inode_find(table, gfids[i]);
+        if (inode != NULL) {
+            snprintf(name, sizeof(name), "file-%d", i);
+            inode_unlink(inode, table->root, name);
+            inode_forget(inode, 0);
+            inode_unref(inode);
+        }
+    }
+
+    return (bm_check() == 0) ? 0 : 1;
+}
@@ -0,0 +1,311 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/* io-threads-bm: requests per second going through io-threads. For each
+ * number of threads given on the command line, that many threads, each one
+ * being a different client, send stat and write fops as fast as they can
+ * through io-threads to a sink answering them right away. It fails if any
+ * request is lost or answered twice.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+#include <glusterfs/glusterfs.h>
+#include <glusterfs/globals.h>
+#include <glusterfs/mem-pool.h>
+#include <glusterfs/iobuf.h>
+#include <glusterfs/stack.h>
+#include <glusterfs/call-stub.h>
+#include <glusterfs/xlator.h>
+#include <glusterfs/inode.h>
+#include <glusterfs/fd.h>
+#include <glusterfs/client_t.h>
+
+#include "xlator-harness.h"
+
+#define INFLIGHT 256
+
+static const char volfile[] =
+    "volume sink\n"
+    "    type debug/sink\n"
+    "    option volume-id sink\n"
+    "end-volume\n"
+    "volume iot\n"
+    "    type performance/io-threads\n"
+    "    option thread-count 16\n"
+    "    subvolumes sink\n"
+    "end-volume\n";
+
+static glusterfs_ctx_t *ctx;
+static long requests = 200000;
+static struct xlator_fops sink_fops;
+static xlator_t *iot;
+static inode_t *inode;
+static fd_t *fd;
+static struct iobref *iobref;
+static char data[512];
+
+typedef struct {
+    pthread_t thread;
+    client_t *client;
+    long requests;
+    long replies;
+    sem_t inflight;
+} producer_t;
+
+static int32_t
+sink_stat(call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xdata)
+{
+    struct iatt buf = {
+        0,
+    };
+
+    STACK_UNWIND_STRICT(stat, frame, 0, 0, &buf, NULL);
+
+    return 0;
+}
+
+static int32_t
+sink_writev(call_frame_t *frame, xlator_t *this, fd_t *fd,
+            struct iovec *vector, int32_t count, off_t offset, uint32_t flags,
+            struct iobref *iobref, dict_t *xdata)
+{
+    struct iatt buf = {
+        0,
+    };
+
+    STACK_UNWIND_STRICT(writev, frame, iov_length(vector, count), 0, &buf,
+                        &buf, NULL);
+
+    return 0;
+}
+
+static void
+reply(call_frame_t *frame)
+{
+    producer_t *producer = frame->local;
+
+    frame->local = NULL;
+    __atomic_add_fetch(&producer->replies, 1, __ATOMIC_RELAXED);
+    STACK_DESTROY(frame->root);
+    sem_post(&producer->inflight);
+}
+
+static int32_t
+stat_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+         int32_t op_errno, struct iatt *buf, dict_t *xdata)
+{
+    if (op_ret != 0) {
+        fprintf(stderr, "stat failed: %s\n", strerror(op_errno));
+        exit(1);
+    }
+    reply(frame);
+
+    return 0;
+}
+
+static int32_t
+writev_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+           int32_t op_errno, struct iatt *prebuf, struct iatt *postbuf,
+           dict_t *xdata)
+{
+    if (op_ret != sizeof(data)) {
+        fprintf(stderr, "write failed: %s\n", strerror(op_errno));
+        exit(1);
+    }
+    reply(frame);
+
+    return 0;
+}
+
+static void *
+produce(void *arg)
+{
+    producer_t *producer = arg;
+    struct iovec iov = {
+        .iov_base = data,
+        .iov_len = sizeof(data),
+    };
+    loc_t loc = {
+        .inode = inode,
+    };
+    call_frame_t *frame;
+    long i;
+
+    gf_uuid_copy(loc.gfid, inode->gfid);
+
+    /* Stat and write fops go to different priorities. */
+    for (i = 0; i < producer->requests; i++) {
+        sem_wait(&producer->inflight);
+        frame = create_frame(THIS, ctx->pool);
+        if (frame == NULL) {
+            fprintf(stderr, "create_frame() failed\n");
+            exit(1);
+        }
+        frame->root->client = producer->client;
+        frame->local = producer;
+        if (i & 1)
+            STACK_WIND(frame, writev_cbk, iot, iot->fops->writev, fd, &iov, 1,
+                       0, 0, iobref, NULL);
+        else
+            STACK_WIND(frame, stat_cbk, iot, iot->fops->stat, &loc, NULL);
+    }
+
+    for (i = 0; i < INFLIGHT; i++)
+        sem_wait(&producer->inflight);
+
+    return NULL;
+}
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int
+run(long threads)
+{
+    client_auth_data_t cred = {
+        0,
+    };
+    producer_t *producers;
+    char name[32];
+    double start;
+    double secs;
+    long i;
+    int ret = 0;
+
+    producers = calloc(threads, sizeof(*producers));
+    if (producers == NULL)
+        return -1;
+
+    for (i = 0; i < threads; i++) {
+        snprintf(name, sizeof(name), "producer-%ld", i);
+        producers[i].client = gf_client_get(iot, &cred, name, NULL);
+        if (producers[i].client == NULL)
+            return -1;
+        producers[i].requests = requests / threads;
+        sem_init(&producers[i].inflight, 0, INFLIGHT);
+    }
+
+    start = now();
+    for (i = 0; i < threads; i++) {
+        if (pthread_create(&producers[i].thread, NULL, produce,
+                           &producers[i]) != 0)
+            return -1;
+    }
+    for (i = 0; i < threads; i++)
+        pthread_join(producers[i].thread, NULL);
+    secs = now() - start;
+
+    for (i = 0; i < threads; i++) {
+        if (producers[i].replies != producers[i].requests) {
+            fprintf(stderr, "producer %ld: %ld replies for %ld requests\n", i,
+                    producers[i].replies, producers[i].requests);
+            ret = -1;
+        }
+        sem_destroy(&producers[i].inflight);
+        gf_client_put(producers[i].client, NULL);
+    }
+
+    printf("%ld threads: %.0f requests/s\n", threads,
+           (requests / threads) * threads / secs);
+
+    free(producers);
+
+    return ret;
+}
+
+static void
+graph_prepare(xlator_t *top)
+{
+    xlator_t *sink = FIRST_CHILD(top);
+
+    sink_fops = *sink->fops;
+    sink_fops.stat = sink_stat;
+    sink_fops.writev = sink_writev;
+    sink->fops = &sink_fops;
+}
+
+static int
+usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-r requests] <threads>...\n", name);
+
+    return 1;
+}
+
+int
+main(int argc, char *argv[])
+{
+    inode_table_t *table;
+    long threads;
+    int opt, arg;
+
+    while ((opt = getopt(argc, argv, "r:")) != -1) {
+        switch (opt) {
+            case 'r':
+                requests = atol(optarg);
+                break;
+            default:
+                return usage(argv[0]);
+        }
+    }
+    if ((optind >= argc) || (requests <= 0))
+        return usage(argv[0]);
+
+    ctx = harness_ctx_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "failed to initialize the context\n");
+        return 1;
+    }
+    iot = harness_graph_new(ctx, volfile, "iot", graph_prepare);
+    if (iot == NULL) {
+        fprintf(stderr, "failed to initialize the graph\n");
+        return 1;
+    }
+
+    table = inode_table_new(0, iot, 0, 0);
+    if (table == NULL)
+        return 1;
+    inode = inode_new(table);
+    if (inode == NULL)
+        return 1;
+    gf_uuid_generate(inode->gfid);
+    inode->ia_type = IA_IFREG;
+    fd = fd_create(inode, getpid());
+    iobref = iobref_new();
+    if ((fd == NULL) || (iobref == NULL))
+        return 1;
+
+    for (arg = optind; arg < argc; arg++) {
+        threads = atol(argv[arg]);
+        if (threads <= 0) {
+            fprintf(stderr, "invalid number of threads: %s\n", argv[arg]);
+            return 1;
+        }
+
+        if (run(threads) != 0)
+            return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,285 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/* locks-bm: lock storm on a single file, driving features/locks directly.
+ * For each number of locks given on the command line, and both for inodelks
+ * and for fcntl locks, it measures:
+ *
+ *  - the CPU time of a lock and unlock pair while that many byte-range locks
+ *    from other owners are granted;
+ *  - the CPU time of the unlock which grants that many blocked locks at
+ *    once.
+ *
+ * Every lock has to be answered, and granted when it doesn't conflict.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+
+#include <glusterfs/glusterfs.h>
+#include <glusterfs/globals.h>
+#include <glusterfs/mem-pool.h>
+#include <glusterfs/iobuf.h>
+#include <glusterfs/stack.h>
+#include <glusterfs/call-stub.h>
+#include <glusterfs/xlator.h>
+#include <glusterfs/inode.h>
+#include <glusterfs/fd.h>
+#include <glusterfs/client_t.h>
+#include <glusterfs/lkowner.h>
+
+#include "xlator-harness.h"
+
+#define RANGE_SIZE 4096
+#define MEASURED 1000
+#define DOMAIN "locks-bm"
+
+static const char volfile[] =
+    "volume sink\n"
+    "    type debug/sink\n"
+    "    option volume-id sink\n"
+    "end-volume\n"
+    "volume locks\n"
+    "    type features/locks\n"
+    "    subvolumes sink\n"
+    "end-volume\n";
+
+static glusterfs_ctx_t *ctx;
+static client_t *client;
+static xlator_t *locks;
+static inode_t *inode;
+static fd_t *fd;
+
+static long replies;
+static long failed;
+
+static int32_t
+inodelk_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+            int32_t op_errno, dict_t *xdata)
+{
+    if (op_ret != 0)
+        failed++;
+    replies++;
+    STACK_DESTROY(frame->root);
+
+    return 0;
+}
+
+static int32_t
+lk_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+       int32_t op_errno, struct gf_flock *flock, dict_t *xdata)
+{
+    if (op_ret != 0)
+        failed++;
+    replies++;
+    STACK_DESTROY(frame->root);
+
+    return 0;
+}
+
+static call_frame_t *
+owner_frame(uint64_t owner)
+{
+    call_frame_t *frame;
+
+    frame = create_frame(THIS, ctx->pool);
+    if (frame == NULL) {
+        fprintf(stderr, "create_frame() failed\n");
+        exit(1);
+    }
+    frame->root->client = client;
+    frame->root->pid = 1;
+    set_lk_owner_from_uint64(&frame->root->lk_owner, owner);
+
+    return frame;
+}
+
+/* Locks [start, start + len) for @owner, len 0 meaning up to the end. */
+static void
+inodelk(uint64_t owner, int32_t cmd, short type, off_t start, off_t len)
+{
+    struct gf_flock flock = {
+        .l_type = type,
+        .l_whence = SEEK_SET,
+        .l_start = start,
+        .l_len = len,
+    };
+    loc_t loc = {
+        .inode = inode,
+    };
+    call_frame_t *frame;
+
+    gf_uuid_copy(loc.gfid, inode->gfid);
+    frame = owner_frame(owner);
+
+    STACK_WIND(frame, inodelk_cbk, locks, locks->fops->inodelk, DOMAIN, &loc,
+               cmd, &flock, NULL);
+}
+
+static void
+lk(uint64_t owner, int32_t cmd, short type, off_t start, off_t len)
+{
+    struct gf_flock flock = {
+        .l_type = type,
+        .l_whence = SEEK_SET,
+        .l_start = start,
+        .l_len = len,
+    };
+    call_frame_t *frame;
+
+    frame = owner_frame(owner);
+
+    STACK_WIND(frame, lk_cbk, locks, locks->fops->lk, fd, cmd, &flock, NULL);
+}
+
+typedef void (*lock_fn_t)(uint64_t owner, int32_t cmd, short type,
+                          off_t start, off_t len);
+
+static double
+cpu_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void
+expect(long count)
+{
+    if ((replies != count) || (failed != 0)) {
+        fprintf(stderr, "%ld replies, %ld failures, expected %ld replies\n",
+                replies, failed, count);
+        exit(1);
+    }
+    replies = 0;
+}
+
+/* Each owner has its own range, with a hole after it so that none of the
+ * fcntl locks can be merged. Owner 0 is the one of the storms. */
+static off_t
+owner_start(uint64_t owner)
+{
+    return (off_t)owner * 2 * RANGE_SIZE;
+}
+
+static void
+run(const char *name, lock_fn_t lock, long count)
+{
+    double start;
+    double usecs;
+    uint64_t owner;
+
+    /* Lock and unlock next to lots of granted locks. */
+    for (owner = 1; owner <= count; owner++)
+        lock(owner, F_SETLK, F_WRLCK, owner_start(owner), RANGE_SIZE);
+    expect(count);
+
+    start = cpu_now();
+    for (owner = count + 1; owner <= count + MEASURED; owner++) {
+        lock(owner, F_SETLK, F_WRLCK, owner_start(owner), RANGE_SIZE);
+        lock(owner, F_SETLK, F_UNLCK, owner_start(owner), RANGE_SIZE);
+    }
+    usecs = cpu_now() - start;
+    expect(2 * MEASURED);
+
+    printf("%s: %ld granted, %.3f us per lock and unlock\n", name, count,
+           usecs / MEASURED);
+
+    for (owner = 1; owner <= count; owner++)
+        lock(owner, F_SETLK, F_UNLCK, owner_start(owner), RANGE_SIZE);
+    expect(count);
+
+    /* Grant lots of blocked locks at once. */
+    lock(0, F_SETLK, F_WRLCK, 0, 0);
+    for (owner = 1; owner <= count; owner++)
+        lock(owner, F_SETLKW, F_WRLCK, owner_start(owner), RANGE_SIZE);
+    expect(1);
+
+    start = cpu_now();
+    lock(0, F_SETLK, F_UNLCK, 0, 0);
+    usecs = cpu_now() - start;
+    expect(count + 1);
+
+    printf("%s: %ld blocked, %.3f ms to grant them\n", name, count,
+           usecs / 1000);
+
+    for (owner = 1; owner <= count; owner++)
+        lock(owner, F_SETLK, F_UNLCK, owner_start(owner), RANGE_SIZE);
+    expect(count);
+}
+
+/* features/locks refuses to be loaded over anything but a storage
+ * translator, and no fop reaches the sink anyway. */
+static void
+graph_prepare(xlator_t *top)
+{
+    xlator_t *sink = FIRST_CHILD(top);
+
+    GF_FREE(sink->type);
+    sink->type = gf_strdup("storage/sink");
+}
+
+int
+main(int argc, char *argv[])
+{
+    client_auth_data_t cred = {
+        0,
+    };
+    inode_table_t *table;
+    long count;
+    int arg;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <locks>...\n", argv[0]);
+        return 1;
+    }
+
+    ctx = harness_ctx_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "failed to initialize the context\n");
+        return 1;
+    }
+    locks = harness_graph_new(ctx, volfile, "locks", graph_prepare);
+    if (locks == NULL) {
+        fprintf(stderr, "failed to initialize the graph\n");
+        return 1;
+    }
+
+    client = gf_client_get(locks, &cred, "locks-bm", NULL);
+    table = inode_table_new(0, locks, 0, 0);
+    if ((client == NULL) || (table == NULL))
+        return 1;
+    inode = inode_new(table);
+    if (inode == NULL)
+        return 1;
+    gf_uuid_generate(inode->gfid);
+    inode->ia_type = IA_IFREG;
+    fd = fd_create(inode, getpid());
+    if (fd == NULL)
+        return 1;
+
+    for (arg = 1; arg < argc; arg++) {
+        count = atol(argv[arg]);
+        if (count <= 0) {
+            fprintf(stderr, "invalid number of locks: %s\n", argv[arg]);
+            return 1;
+        }
+
+        run("inodelk", inodelk, count);
+        run("fcntl", lk, count);
+    }
+
+    return 0;
+}
@@ -0,0 +1,323 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/* rpc-clnt-bm: keeps lots of calls outstanding on a single rpc-clnt
+ * connection to a server running in the same process over a unix socket.
+ * The server holds the requests until the whole window has arrived and then
+ * replies to them newest first, so that the client has to match each reply
+ * while the rest of the window is still outstanding.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <glusterfs/glusterfs.h>
+#include <glusterfs/globals.h>
+#include <glusterfs/mem-pool.h>
+#include <glusterfs/iobuf.h>
+#include <glusterfs/gf-event.h>
+#include <glusterfs/stack.h>
+#include <glusterfs/call-stub.h>
+#include <glusterfs/timespec.h>
+#include <glusterfs/rpc/rpc-clnt.h>
+#include <glusterfs/rpc/rpcsvc.h>
+
+#define BM_PROGRAM 1298437
+#define BM_VERSION 1
+#define BM_PROC_NULL 0
+#define BM_PROC_CALL 1
+
+static glusterfs_ctx_t *ctx;
+static long count = 100000;
+static long window = 10000;
+static char *sockfile;
+
+static rpcsvc_request_t **held;
+static long nheld;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+static int connected;
+static long replies;
+static long failed;
+
+static double
+elapsed(struct timespec *start)
+{
+    struct timespec now;
+
+    timespec_now(&now);
+
+    return (TS(now) - TS((*start))) / 1e9;
+}
+
+/* Server side. */
+
+static int
+bm_server_call(rpcsvc_request_t *req)
+{
+    long i;
+
+    held[nheld++] = req;
+    if (nheld < window)
+        return 0;
+
+    /* Reply newest first. */
+    for (i = nheld - 1; i >= 0; i--) {
+        rpcsvc_submit_generic(held[i], NULL, 0, NULL, 0, NULL);
+    }
+    nheld = 0;
+
+    return 0;
+}
+
+static rpcsvc_actor_t bm_server_actors[] = {
+    [BM_PROC_NULL] = {"NULL", NULL, NULL, BM_PROC_NULL, DRC_NA, 0},
+    [BM_PROC_CALL] = {"CALL", bm_server_call, NULL, BM_PROC_CALL, DRC_NA, 0},
+};
+
+static struct rpcsvc_program bm_server_prog = {
+    .progname = "rpc-clnt-bm",
+    .prognum = BM_PROGRAM,
+    .progver = BM_VERSION,
+    .actors = bm_server_actors,
+    .numactors = 2,
+    .synctask = _gf_false,
+};
+
+static int
+bm_server_notify(rpcsvc_t *rpc, void *xl, rpcsvc_event_t event, void *data)
+{
+    return 0;
+}
+
+static int
+bm_server_init(void)
+{
+    dict_t *options;
+    rpcsvc_t *svc;
+
+    options = dict_new();
+    if ((options == NULL) ||
+        (rpcsvc_transport_unix_options_build(options, sockfile) != 0))
+        return -1;
+
+    svc = rpcsvc_init(THIS, ctx, options, 8);
+    if (svc == NULL)
+        return -1;
+    if (rpcsvc_register_notify(svc, bm_server_notify, THIS) != 0)
+        return -1;
+    if (rpcsvc_create_listeners(svc, options, "rpc-clnt-bm") != 1)
+        return -1;
+
+    return rpcsvc_program_register(svc, &bm_server_prog, _gf_false);
+}
+
+/* Client side. */
+
+static char *bm_client_procnames[] = {"NULL", "CALL"};
+
+static rpc_clnt_procedure_t bm_client_procs[] = {
+    {"NULL", NULL},
+    {"CALL", NULL},
+};
+
+static rpc_clnt_prog_t bm_client_prog = {
+    .progname = "rpc-clnt-bm",
+    .prognum = BM_PROGRAM,
+    .progver = BM_VERSION,
+    .proctable = bm_client_procs,
+    .procnames = bm_client_procnames,
+    .numproc = 2,
+};
+
+static int
+bm_client_notify(struct rpc_clnt *rpc, void *mydata, rpc_clnt_event_t event,
+                 void *data)
+{
+    if (event == RPC_CLNT_CONNECT) {
+        pthread_mutex_lock(&lock);
+        connected = 1;
+        pthread_cond_broadcast(&cond);
+        pthread_mutex_unlock(&lock);
+    }
+
+    return 0;
+}
+
+static int
+bm_client_cbk(struct rpc_req *req, struct iovec *iov, int count, void *myframe)
+{
+    call_frame_t *frame = myframe;
+
+    STACK_DESTROY(frame->root);
+
+    pthread_mutex_lock(&lock);
+    if (req->rpc_status == -1)
+        failed++;
+    if (++replies % window == 0)
+        pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&lock);
+
+    return 0;
+}
+
+static struct rpc_clnt *
+bm_client_init(void)
+{
+    struct rpc_clnt *rpc;
+    dict_t *options;
+
+    options = dict_new();
+    if ((options == NULL) ||
+        (rpc_transport_unix_options_build(options, sockfile, 0) != 0))
+        return NULL;
+
+    rpc = rpc_clnt_new(options, THIS, "rpc-clnt-bm", 16);
+    if (rpc == NULL)
+        return NULL;
+    if ((rpc_clnt_register_notify(rpc, bm_client_notify, NULL) != 0) ||
+        (rpc_clnt_start(rpc) != 0))
+        return NULL;
+
+    return rpc;
+}
+
+static void *
+bm_poller(void *data)
+{
+    gf_event_dispatch(ctx->event_pool);
+
+    return NULL;
+}
+
+static int
+bm_ctx_init(void)
+{
+    ctx = glusterfs_ctx_new();
+    if ((ctx == NULL) || (glusterfs_globals_init(ctx) != 0))
+        return -1;
+    THIS->ctx = ctx;
+    if (xlator_mem_acct_init(THIS, gf_common_mt_end + 1) != 0)
+        return -1;
+    mem_pools_init();
+
+    ctx->process_uuid = generate_glusterfs_ctx_id();
+    ctx->page_size = 128 * GF_UNIT_KB;
+    ctx->iobuf_pool = iobuf_pool_new();
+    ctx->event_pool = gf_event_pool_new(16384, 1);
+    ctx->pool = calloc(1, sizeof(call_pool_t));
+    if ((ctx->process_uuid == NULL) || (ctx->iobuf_pool == NULL) ||
+        (ctx->event_pool == NULL) || (ctx->pool == NULL))
+        return -1;
+    call_pool_init(ctx->pool);
+    ctx->pool->frame_mem_pool = mem_pool_new(call_frame_t, 4096);
+    ctx->pool->stack_mem_pool = mem_pool_new(call_stack_t, 1024);
+    ctx->stub_mem_pool = mem_pool_new(call_stub_t, 1024);
+    ctx->dict_pool = mem_pool_new(dict_t, 1024);
+    ctx->dict_pair_pool = mem_pool_new(data_pair_t, 1024);
+    ctx->dict_data_pool = mem_pool_new(data_t, 1024);
+    ctx->logbuf_pool = mem_pool_new(log_buf_t, 256);
+    if ((ctx->pool->frame_mem_pool == NULL) ||
+        (ctx->pool->stack_mem_pool == NULL) || (ctx->stub_mem_pool == NULL) ||
+        (ctx->dict_pool == NULL) || (ctx->dict_pair_pool == NULL) ||
+        (ctx->dict_data_pool == NULL) || (ctx->logbuf_pool == NULL))
+        return -1;
+
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    struct rpc_clnt *rpc;
+    call_frame_t *frame;
+    struct timespec start;
+    pthread_t poller;
+    char path[] = "/tmp/rpc-clnt-bm.XXXXXX";
+    double time;
+    long i;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:w:")) != -1) {
+        switch (opt) {
+            case 'c':
+                count = atol(optarg);
+                break;
+            case 'w':
+                window = atol(optarg);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-c calls] [-w window]\n", argv[0]);
+                return 1;
+        }
+    }
+    if ((window <= 0) || (count < window)) {
+        fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+    count -= count % window;
+
+    held = calloc(window, sizeof(*held));
+    if ((held == NULL) || (mkdtemp(path) == NULL))
+        return 1;
+    if (asprintf(&sockfile, "%s/socket", path) < 0)
+        return 1;
+
+    if (bm_ctx_init() != 0) {
+        fprintf(stderr, "failed to initialize the context\n");
+        return 1;
+    }
+    if (bm_server_init() != 0) {
+        fprintf(stderr, "failed to start the server\n");
+        return 1;
+    }
+    rpc = bm_client_init();
+    if (rpc == NULL) {
+        fprintf(stderr, "failed to start the client\n");
+        return 1;
+    }
+    pthread_create(&poller, NULL, bm_poller, NULL);
+
+    pthread_mutex_lock(&lock);
+    while (!connected)
+        pthread_cond_wait(&cond, &lock);
+    pthread_mutex_unlock(&lock);
+
+    timespec_now(&start);
+    for (i = 1; i <= count; i++) {
+        frame = create_frame(THIS, ctx->pool);
+        if ((frame == NULL) ||
+            (rpc_clnt_submit(rpc, &bm_client_prog, BM_PROC_CALL, bm_client_cbk,
+                             NULL, 0, NULL, 0, NULL, frame, NULL, 0, NULL, 0,
+                             NULL) != 0)) {
+            fprintf(stderr, "rpc_clnt_submit() failed\n");
+            return 1;
+        }
+        if (i % window == 0) {
+            /* Wait for the whole window to be answered. */
+            pthread_mutex_lock(&lock);
+            while (replies < i)
+                pthread_cond_wait(&cond, &lock);
+            pthread_mutex_unlock(&lock);
+        }
+    }
+    time = elapsed(&start);
+
+    printf("%ld calls, %ld outstanding, in %.3f s (%.0f calls/s)\n", count,
+           window, time, count / time);
+
+    unlink(sockfile);
+    rmdir(path);
+
+    return (failed == 0) ? 0 : 1;
+}
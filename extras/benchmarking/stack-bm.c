@@ -0,0 +1,160 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/* stack-bm: creates and destroys call stacks from several threads, like
+ * every fop does, and reports how many of them can be handled per second.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <glusterfs/glusterfs.h>
+#include <glusterfs/globals.h>
+#include <glusterfs/mem-pool.h>
+#include <glusterfs/stack.h>
+#include <glusterfs/timespec.h>
+
+static glusterfs_ctx_t *ctx;
+static long count = 1000000;
+static int threads = 64;
+static int depth = 4;
+static pthread_barrier_t barrier;
+
+struct worker {
+    pthread_t thread;
+    long count;
+    double time;
+};
+
+static double
+elapsed(struct timespec *start)
+{
+    struct timespec now;
+
+    timespec_now(&now);
+
+    return (TS(now) - TS((*start))) / 1e9;
+}
+
+static void *
+bm_worker(void *data)
+{
+    struct worker *worker = data;
+    struct timespec start;
+    call_frame_t *frame;
+    call_frame_t *child;
+    long i;
+    int j;
+
+    pthread_barrier_wait(&barrier);
+
+    timespec_now(&start);
+    for (i = 0; i < worker->count; i++) {
+        frame = create_frame(THIS, ctx->pool);
+        if (frame == NULL) {
+            fprintf(stderr, "create_frame() failed\n");
+            exit(1);
+        }
+        /* Add some frames like a STACK_WIND through the graph would do. */
+        for (j = 1; j < depth; j++) {
+            child = mem_get0(ctx->pool->frame_mem_pool);
+            if (child == NULL) {
+                fprintf(stderr, "mem_get0() failed\n");
+                exit(1);
+            }
+            child->root = frame->root;
+            child->parent = frame;
+            child->this = THIS;
+            LOCK_INIT(&child->lock);
+            LOCK(&frame->root->stack_lock);
+            {
+                list_add(&child->frames, &frame->root->myframes);
+            }
+            UNLOCK(&frame->root->stack_lock);
+        }
+        STACK_DESTROY(frame->root);
+    }
+    worker->time = elapsed(&start);
+
+    return NULL;
+}
+
+int
+main(int argc, char *argv[])
+{
+    struct worker *workers;
+    double time = 0;
+    int opt, i;
+
+    while ((opt = getopt(argc, argv, "c:d:t:")) != -1) {
+        switch (opt) {
+            case 'c':
+                count = atol(optarg);
+                break;
+            case 'd':
+                depth = atoi(optarg);
+                break;
+            case 't':
+                threads = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr,
+                        "usage: %s [-c stacks] [-d frames] [-t threads]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+    if ((count <= 0) || (depth <= 0) || (threads <= 0)) {
+        fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+
+    ctx = glusterfs_ctx_new();
+    if ((ctx == NULL) || (glusterfs_globals_init(ctx) != 0)) {
+        fprintf(stderr, "failed to initialize the context\n");
+        return 1;
+    }
+    THIS->ctx = ctx;
+    mem_pools_init();
+
+    ctx->pool = calloc(1, sizeof(call_pool_t));
+    if (ctx->pool == NULL)
+        return 1;
+    call_pool_init(ctx->pool);
+    ctx->pool->frame_mem_pool = mem_pool_new(call_frame_t, 4096);
+    ctx->pool->stack_mem_pool = mem_pool_new(call_stack_t, 1024);
+    if ((ctx->pool->frame_mem_pool == NULL) ||
+        (ctx->pool->stack_mem_pool == NULL)) {
+        fprintf(stderr, "failed to create the memory pools\n");
+        return 1;
+    }
+
+    workers = calloc(threads, sizeof(*workers));
+    if (workers == NULL)
+        return 1;
+    pthread_barrier_init(&barrier, NULL, threads);
+
+    for (i = 0; i < threads; i++) {
+        workers[i].count = count / threads + (i < count % threads);
+        pthread_create(&workers[i].thread, NULL, bm_worker, &workers[i]);
+    }
+    for (i = 0; i < threads; i++) {
+        pthread_join(workers[i].thread, NULL);
+        if (workers[i].time > time)
+            time = workers[i].time;
+    }
+
+    printf("%ld stacks of %d frames from %d threads in %.3f s (%.0f/s)\n",
+           count, depth, threads, time, count / time);
+
+    return (call_pool_count(ctx->pool) == 0) ? 0 : 1;
+}
@@ -0,0 +1,207 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/* timer-bm: arms and cancels lots of gf_timer timers from several threads
+ * and then checks that short timers fire, and how late they do it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <glusterfs/glusterfs.h>
+#include <glusterfs/globals.h>
+#include <glusterfs/mem-pool.h>
+#include <glusterfs/timer.h>
+#include <glusterfs/timespec.h>
+
+static glusterfs_ctx_t *ctx;
+static long count = 1000000;
+static int threads = 4;
+static pthread_barrier_t barrier;
+
+static uint64_t fired;
+static uint64_t late_total;
+static uint64_t late_max;
+
+struct worker {
+    pthread_t thread;
+    gf_timer_t **timers;
+    long count;
+    double arm;
+    double cancel;
+};
+
+static double
+elapsed(struct timespec *start)
+{
+    struct timespec now;
+
+    timespec_now(&now);
+
+    return (TS(now) - TS((*start))) / 1e9;
+}
+
+static void
+bm_noop(void *data)
+{
+}
+
+static void
+bm_fire(void *data)
+{
+    struct timespec *at = data;
+    struct timespec now;
+    uint64_t late;
+
+    timespec_now(&now);
+    late = (TS(now) > TS((*at))) ? TS(now) - TS((*at)) : 0;
+
+    /* Callbacks are serialized in the timer thread. */
+    late_total += late;
+    if (late > late_max)
+        late_max = late;
+    free(at);
+    __atomic_add_fetch(&fired, 1, __ATOMIC_RELEASE);
+}
+
+static void *
+bm_worker(void *data)
+{
+    struct worker *worker = data;
+    struct timespec delta = {60, 0};
+    struct timespec start;
+    long i;
+
+    pthread_barrier_wait(&barrier);
+
+    timespec_now(&start);
+    for (i = 0; i < worker->count; i++) {
+        /* Spread the timers over several levels of the wheels. */
+        delta.tv_nsec = (i % 1000) * 1000000;
+        delta.tv_sec = 1 + i % 3600;
+        worker->timers[i] = gf_timer_call_after(ctx, delta, bm_noop, NULL);
+        if (worker->timers[i] == NULL) {
+            fprintf(stderr, "gf_timer_call_after() failed\n");
+            exit(1);
+        }
+    }
+    worker->arm = elapsed(&start);
+
+    pthread_barrier_wait(&barrier);
+
+    timespec_now(&start);
+    for (i = 0; i < worker->count; i++) {
+        if (gf_timer_call_cancel(ctx, worker->timers[i]) != 0) {
+            fprintf(stderr, "gf_timer_call_cancel() failed\n");
+            exit(1);
+        }
+    }
+    worker->cancel = elapsed(&start);
+
+    return NULL;
+}
+
+static int
+bm_fire_check(long total)
+{
+    struct timespec delta = {0, 0};
+    struct timespec *at;
+    long i, ms;
+
+    for (i = 0; i < total; i++) {
+        ms = random() % 2000;
+        delta.tv_sec = ms / 1000;
+        delta.tv_nsec = (ms % 1000) * 1000000;
+
+        at = malloc(sizeof(*at));
+        if (at == NULL)
+            return -1;
+        timespec_now(at);
+        timespec_adjust_delta(at, delta);
+
+        if (gf_timer_call_after(ctx, delta, bm_fire, at) == NULL)
+            return -1;
+    }
+
+    for (i = 0; i < 100; i++) {
+        if (__atomic_load_n(&fired, __ATOMIC_ACQUIRE) == total)
+            break;
+        usleep(100000);
+    }
+
+    printf("fire: %lu/%ld timers fired, mean delay %.3f ms, max %.3f ms\n",
+           fired, total, fired ? late_total / (fired * 1e6) : 0.0,
+           late_max / 1e6);
+
+    return (fired == total) ? 0 : -1;
+}
+
+int
+main(int argc, char *argv[])
+{
+    struct worker *workers;
+    double arm = 0, cancel = 0;
+    int opt, i;
+
+    while ((opt = getopt(argc, argv, "c:t:")) != -1) {
+        switch (opt) {
+            case 'c':
+                count = atol(optarg);
+                break;
+            case 't':
+                threads = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-c timers] [-t threads]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+    if ((count <= 0) || (threads <= 0)) {
+        fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+
+    ctx = glusterfs_ctx_new();
+    if ((ctx == NULL) || (glusterfs_globals_init(ctx) != 0)) {
+        fprintf(stderr, "failed to initialize the context\n");
+        return 1;
+    }
+    THIS->ctx = ctx;
+    mem_pools_init();
+
+    workers = calloc(threads, sizeof(*workers));
+    if (workers == NULL)
+        return 1;
+    pthread_barrier_init(&barrier, NULL, threads);
+
+    for (i = 0; i < threads; i++) {
+        workers[i].count = count / threads + (i < count % threads);
+        workers[i].timers = calloc(workers[i].count, sizeof(gf_timer_t *));
+        if (workers[i].timers == NULL)
+            return 1;
+        pthread_create(&workers[i].thread, NULL, bm_worker, &workers[i]);
+    }
+    for (i = 0; i < threads; i++) {
+        pthread_join(workers[i].thread, NULL);
+        if (workers[i].arm > arm)
+            arm = workers[i].arm;
+        if (workers[i].cancel > cancel)
+            cancel = workers[i].cancel;
+    }
+
+    printf("arm: %ld timers in %.3f s (%.0f/s)\n", count, arm, count / arm);
+    printf("cancel: %ld timers in %.3f s (%.0f/s)\n", count, cancel,
+           count / cancel);
+
+    return (bm_fire_check(count / 100 + 1) == 0) ? 0 : 1;
+}
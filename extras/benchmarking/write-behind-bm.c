@@ -0,0 +1,233 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/* write-behind-bm: measures the CPU time write-behind spends on a write while
+ * lots of other writes to the same file are queued. The graph is write-behind
+ * on top of a sink whose writev holds the requests instead of answering them,
+ * so every write which has been acknowledged stays in the liability and
+ * in-flight queues until the end. All the writes have to be acknowledged.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <glusterfs/glusterfs.h>
+#include <glusterfs/globals.h>
+#include <glusterfs/mem-pool.h>
+#include <glusterfs/iobuf.h>
+#include <glusterfs/stack.h>
+#include <glusterfs/call-stub.h>
+#include <glusterfs/xlator.h>
+#include <glusterfs/inode.h>
+#include <glusterfs/fd.h>
+
+#include "xlator-harness.h"
+
+#define WRITE_SIZE 4096
+#define MEASURED 1000
+
+static const char volfile[] =
+    "volume hold\n"
+    "    type debug/sink\n"
+    "    option volume-id hold\n"
+    "end-volume\n"
+    "volume wb\n"
+    "    type performance/write-behind\n"
+    "    option cache-size 1GB\n"
+    "    subvolumes hold\n"
+    "end-volume\n";
+
+static glusterfs_ctx_t *ctx;
+static struct xlator_fops hold_fops;
+static char data[WRITE_SIZE];
+
+static call_frame_t **held;
+static size_t *held_size;
+static long nheld;
+static long maxheld;
+static long acked;
+
+static int32_t
+hold_writev(call_frame_t *frame, xlator_t *this, fd_t *fd,
+            struct iovec *vector, int32_t count, off_t offset, uint32_t flags,
+            struct iobref *iobref, dict_t *xdata)
+{
+    if (nheld == maxheld) {
+        maxheld = maxheld ? maxheld * 2 : 1024;
+        held = realloc(held, maxheld * sizeof(*held));
+        held_size = realloc(held_size, maxheld * sizeof(*held_size));
+        if ((held == NULL) || (held_size == NULL)) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+
+    held[nheld] = frame;
+    held_size[nheld] = iov_length(vector, count);
+    nheld++;
+
+    return 0;
+}
+
+static int32_t
+write_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+          int32_t op_errno, struct iatt *prebuf, struct iatt *postbuf,
+          dict_t *xdata)
+{
+    if (op_ret != WRITE_SIZE) {
+        fprintf(stderr, "write failed: %d (%s)\n", op_ret, strerror(op_errno));
+        exit(1);
+    }
+    acked++;
+    STACK_DESTROY(frame->root);
+
+    return 0;
+}
+
+static void
+write_at(xlator_t *wb, fd_t *fd, struct iobref *iobref, off_t offset)
+{
+    struct iovec iov = {
+        .iov_base = data,
+        .iov_len = WRITE_SIZE,
+    };
+    call_frame_t *frame;
+
+    frame = create_frame(THIS, ctx->pool);
+    if (frame == NULL) {
+        fprintf(stderr, "create_frame() failed\n");
+        exit(1);
+    }
+
+    STACK_WIND(frame, write_cbk, wb, wb->fops->writev, fd, &iov, 1, offset, 0,
+               iobref, NULL);
+}
+
+/* Answer the held writes, newest first. Write-behind may send more of them
+ * down while doing so. */
+static void
+release_all(void)
+{
+    struct iatt buf = {
+        0,
+    };
+    call_frame_t *frame;
+    size_t size;
+
+    while (nheld > 0) {
+        nheld--;
+        frame = held[nheld];
+        size = held_size[nheld];
+        STACK_UNWIND_STRICT(writev, frame, size, 0, &buf, &buf, NULL);
+    }
+}
+
+static double
+cpu_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void
+graph_prepare(xlator_t *wb)
+{
+    xlator_t *hold = FIRST_CHILD(wb);
+
+    hold_fops = *hold->fops;
+    hold_fops.writev = hold_writev;
+    hold->fops = &hold_fops;
+}
+
+int
+main(int argc, char *argv[])
+{
+    xlator_t *wb;
+    inode_table_t *table;
+    inode_t *inode;
+    fd_t *fd;
+    struct iobref *iobref;
+    off_t offset;
+    long queued;
+    long i;
+    double start;
+    double usecs;
+    int ret = 0;
+    int arg;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <queued writes>...\n", argv[0]);
+        return 1;
+    }
+
+    ctx = harness_ctx_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "failed to initialize the context\n");
+        return 1;
+    }
+    wb = harness_graph_new(ctx, volfile, "wb", graph_prepare);
+    if (wb == NULL) {
+        fprintf(stderr, "failed to initialize the graph\n");
+        return 1;
+    }
+
+    table = inode_table_new(0, wb, 0, 0);
+    if (table == NULL)
+        return 1;
+    inode = inode_new(table);
+    if (inode == NULL)
+        return 1;
+    gf_uuid_generate(inode->gfid);
+    inode->ia_type = IA_IFREG;
+    fd = fd_create(inode, getpid());
+    iobref = iobref_new();
+    if ((fd == NULL) || (iobref == NULL))
+        return 1;
+
+    memset(data, 'w', sizeof(data));
+
+    for (arg = 1; arg < argc; arg++) {
+        queued = atol(argv[arg]);
+        if (queued <= 0) {
+            fprintf(stderr, "invalid number of writes: %s\n", argv[arg]);
+            return 1;
+        }
+
+        /* Leave a hole after each write so that none of them can be
+         * aggregated with another one. */
+        offset = 0;
+        acked = 0;
+        for (i = 0; i < queued; i++, offset += 2 * WRITE_SIZE)
+            write_at(wb, fd, iobref, offset);
+
+        start = cpu_now();
+        for (i = 0; i < MEASURED; i++, offset += 2 * WRITE_SIZE)
+            write_at(wb, fd, iobref, offset);
+        usecs = cpu_now() - start;
+
+        if (acked != queued + MEASURED) {
+            fprintf(stderr, "only %ld writes out of %ld acknowledged\n", acked,
+                    queued + MEASURED);
+            ret = 1;
+        }
+
+        printf("%ld queued writes: %.3f us/write\n", queued,
+               usecs / MEASURED);
+
+        release_all();
+    }
+
+    return ret;
+}
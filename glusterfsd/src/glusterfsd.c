@@ -262,6 +262,12 @@ static struct argp_option gf_options[] = {
      OPTION_ARG_OPTIONAL, "set fuse reader thread count"},
     {"kernel-writeback-cache", ARGP_KERNEL_WRITEBACK_CACHE_KEY, "BOOL",
      OPTION_ARG_OPTIONAL, "enable fuse in-kernel writeback cache"},
+    {"max-write", ARGP_FUSE_MAX_WRITE_KEY, "SIZE", OPTION_ARG_OPTIONAL,
+     "set the largest read/write request exchanged with fuse kernel module"
+     " [default: 131072]"},
+    {"clone-fd", ARGP_FUSE_CLONE_FD_KEY, "BOOL", OPTION_ARG_OPTIONAL,
+     "give each fuse reader thread its own /dev/fuse channel"
+     " [default: \"yes\"]"},
     {"attr-times-granularity", ARGP_ATTR_TIMES_GRANULARITY_KEY, "NS",
      OPTION_ARG_OPTIONAL,
      "declare supported granularity of file attribute"
@@ -520,6 +526,24 @@ set_fuse_mount_options(glusterfs_ctx_t *ctx, dict_t *options)
                          cmd_args->kernel_writeback_cache);
             break;
     }
+    if (cmd_args->fuse_max_write) {
+        DICT_SET_VAL(dict_set_uint32, options, "max-write",
+                     cmd_args->fuse_max_write, glusterfsd_msg_3);
+    }
+    switch (cmd_args->fuse_clone_fd) {
+        case GF_OPTION_ENABLE:
+            DICT_SET_VAL(dict_set_static_ptr, options, "clone-fd", "on",
+                         glusterfsd_msg_3);
+            break;
+        case GF_OPTION_DISABLE:
+            DICT_SET_VAL(dict_set_static_ptr, options, "clone-fd", "off",
+                         glusterfsd_msg_3);
+            break;
+        default:
+            gf_msg_debug("glusterfsd", 0, "clone-fd mode %d",
+                         cmd_args->fuse_clone_fd);
+            break;
+    }
     if (cmd_args->attr_times_granularity) {
         DICT_SET_VAL(dict_set_uint32, options, "attr-times-granularity",
                      cmd_args->attr_times_granularity, glusterfsd_msg_3);
@@ -776,6 +800,7 @@ parse_opts(int key, char *arg, struct argp_state *state)
 {
     cmd_args_t *cmd_args = NULL;
     uint32_t n = 0;
+    uint64_t size = 0;
 #ifdef GF_LINUX_HOST_OS
     int32_t k = 0;
     struct oom_api_info *api = NULL;
@@ -1323,6 +1348,34 @@ parse_opts(int key, char *arg, struct argp_state *state)
             argp_failure(state, -1, 0,
                          "unknown kernel writeback cache setting \"%s\"", arg);
             break;
+        case ARGP_FUSE_MAX_WRITE_KEY:
+            if (gf_string2bytesize_uint64(arg, &size)) {
+                argp_failure(state, -1, 0, "unknown max write option %s",
+                             arg);
+            } else if ((size < 4096) || (size > 1048576)) {
+                argp_failure(state, -1, 0,
+                             "Invalid max write value %s. "
+                             "Valid range: [\"4096, 1048576\"]",
+                             arg);
+            } else {
+                cmd_args->fuse_max_write = size;
+            }
+
+            break;
+
+        case ARGP_FUSE_CLONE_FD_KEY:
+            if (!arg)
+                arg = "yes";
+
+            if (gf_string2boolean(arg, &b) == 0) {
+                cmd_args->fuse_clone_fd = b;
+
+                break;
+            }
+
+            argp_failure(state, -1, 0, "unknown clone-fd setting \"%s\"",
+                         arg);
+            break;
         case ARGP_ATTR_TIMES_GRANULARITY_KEY:
             if (gf_string2uint32(arg, &cmd_args->attr_times_granularity)) {
                 argp_failure(state, -1, 0,
@@ -1636,8 +1689,7 @@ glusterfs_ctx_defaults_init(glusterfs_ctx_t *ctx)
         goto out;
     }
 
-    INIT_LIST_HEAD(&ctx->pool->all_frames);
-    LOCK_INIT(&ctx->pool->lock);
+    call_pool_init(ctx->pool);
 
     /* frame_mem_pool size 112 * 4k */
     ctx->pool->frame_mem_pool = mem_pool_new(call_frame_t, 4096);
@@ -1705,6 +1757,7 @@ glusterfs_ctx_defaults_init(glusterfs_ctx_t *ctx)
     cmd_args->fuse_entry_timeout = -1;
     cmd_args->fopen_keep_cache = GF_OPTION_DEFERRED;
     cmd_args->kernel_writeback_cache = GF_OPTION_DEFERRED;
+    cmd_args->fuse_clone_fd = GF_OPTION_DEFERRED;
     cmd_args->fuse_flush_handle_interrupt = GF_OPTION_DEFERRED;
 
     if (ctx->mem_acct_enable)
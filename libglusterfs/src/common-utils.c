@@ -909,6 +909,7 @@ gf_print_trace(int32_t signum, glusterfs_ctx_t *ctx)
         0,
     };
     call_stack_t *stack = NULL;
+    int i;
 
     /* Now every gf_log call will just write to a buffer and when the
      * buffer becomes full, its written to the log-file. Suppose the process
@@ -924,16 +925,20 @@ gf_print_trace(int32_t signum, glusterfs_ctx_t *ctx)
     /* Pending frames, (if any), list them in order */
     gf_msg_plain_nomem(GF_LOG_ALERT, "pending frames:");
     {
-        /* FIXME: traversing stacks outside pool->lock */
-        list_for_each_entry(stack, &ctx->pool->all_frames, all_frames)
-        {
-            if (stack->type == GF_OP_TYPE_FOP)
-                sprintf(msg, "frame : type(%d) op(%s)", stack->type,
-                        gf_fop_list[stack->op]);
-            else
-                sprintf(msg, "frame : type(%d) op(%d)", stack->type, stack->op);
-
-            gf_msg_plain_nomem(GF_LOG_ALERT, msg);
+        /* FIXME: traversing stacks outside the locks of the lists */
+        for (i = 0; i < GF_CALL_POOL_SHARDS; i++) {
+            list_for_each_entry(stack, &ctx->pool->shards[i].all_frames,
+                                all_frames)
+            {
+                if (stack->type == GF_OP_TYPE_FOP)
+                    sprintf(msg, "frame : type(%d) op(%s)", stack->type,
+                            gf_fop_list[stack->op]);
+                else
+                    sprintf(msg, "frame : type(%d) op(%d)", stack->type,
+                            stack->op);
+
+                gf_msg_plain_nomem(GF_LOG_ALERT, msg);
+            }
         }
     }
 
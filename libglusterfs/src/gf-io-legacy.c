@@ -8,11 +8,14 @@
   cases as published by the Free Software Foundation.
 */
 
+#include <sys/stat.h>
+
 #include <glusterfs/gf-io-legacy.h>
 
 #include <glusterfs/globals.h>
 #include <glusterfs/gf-event.h>
 #include <glusterfs/timer.h>
+#include <glusterfs/syscall.h>
 
 static uint64_t gf_io_legacy_seq;
 
@@ -79,6 +82,208 @@ gf_io_legacy_callback(uint64_t seq, uint64_t id, gf_io_op_t *op, uint32_t count)
     return 0;
 }
 
+/* The legacy engine has no way to run I/O in the background, so requests
+ * are executed synchronously from the caller's thread. Errors are not logged
+ * here. It's the responsibility of the caller to report them.
+ *
+ * Like with io_uring, the result of a request is passed to the callback as
+ * an int32_t. Reads and writes are limited to GF_IO_LEGACY_RW_MAX bytes so
+ * that the number of bytes transferred always fits. Bigger requests are
+ * completed partially, as the kernel already does for sizes close to 2GB. */
+
+#define GF_IO_LEGACY_RW_MAX (INT32_MAX & ~4095)
+
+/* Returns the number of entries of 'iov' to use so that the total size is
+ * not bigger than GF_IO_LEGACY_RW_MAX. If the first entry is already too big,
+ * a trimmed copy of it is returned in 'first'. */
+static uint32_t
+gf_io_legacy_rw_limit(const struct iovec **iov, uint32_t count,
+                      struct iovec *first)
+{
+    size_t size;
+    uint32_t i;
+
+    size = 0;
+    for (i = 0; i < count; i++) {
+        if ((*iov)[i].iov_len > GF_IO_LEGACY_RW_MAX - size) {
+            break;
+        }
+        size += (*iov)[i].iov_len;
+    }
+
+    if ((i == 0) && (count > 0)) {
+        first->iov_base = (*iov)[0].iov_base;
+        first->iov_len = GF_IO_LEGACY_RW_MAX;
+        *iov = first;
+        i = 1;
+    }
+
+    return i;
+}
+
+static uint64_t
+gf_io_legacy_readv(uint64_t seq, uint64_t id, gf_io_op_t *op, uint32_t count)
+{
+    const struct iovec *iov;
+    struct iovec first;
+    ssize_t res;
+
+    iov = op->rw.iov;
+    count = gf_io_legacy_rw_limit(&iov, op->rw.count, &first);
+
+    res = gf_io_convert_from_errno(
+        sys_preadv(op->rw.fd, iov, count, op->rw.offset));
+    gf_io_legacy_cbk(id, res);
+
+    return 0;
+}
+
+static uint64_t
+gf_io_legacy_writev(uint64_t seq, uint64_t id, gf_io_op_t *op, uint32_t count)
+{
+    const struct iovec *iov;
+    struct iovec first;
+    ssize_t res;
+
+    iov = op->rw.iov;
+    count = gf_io_legacy_rw_limit(&iov, op->rw.count, &first);
+
+    res = gf_io_convert_from_errno(
+        sys_pwritev(op->rw.fd, iov, count, op->rw.offset));
+    gf_io_legacy_cbk(id, res);
+
+    return 0;
+}
+
+static uint64_t
+gf_io_legacy_fsync(uint64_t seq, uint64_t id, gf_io_op_t *op, uint32_t count)
+{
+    int32_t res;
+
+    if ((op->fsync.flags & GF_IO_FSYNC_DATASYNC) != 0) {
+        res = gf_io_convert_from_errno0(sys_fdatasync(op->fsync.fd));
+    } else {
+        res = gf_io_convert_from_errno0(sys_fsync(op->fsync.fd));
+    }
+    gf_io_legacy_cbk(id, res);
+
+    return 0;
+}
+
+static uint64_t
+gf_io_legacy_read_fixed(uint64_t seq, uint64_t id, gf_io_op_t *op,
+                        uint32_t count)
+{
+    ssize_t res;
+
+    res = gf_io_convert_from_errno(
+        sys_pread(op->fixed.fd, op->fixed.buf,
+                  min(op->fixed.size, GF_IO_LEGACY_RW_MAX), op->fixed.offset));
+    gf_io_legacy_cbk(id, res);
+
+    return 0;
+}
+
+static uint64_t
+gf_io_legacy_write_fixed(uint64_t seq, uint64_t id, gf_io_op_t *op,
+                         uint32_t count)
+{
+    ssize_t res;
+
+    res = gf_io_convert_from_errno(sys_pwrite(
+        op->fixed.fd, op->fixed.buf, min(op->fixed.size, GF_IO_LEGACY_RW_MAX),
+        op->fixed.offset));
+    gf_io_legacy_cbk(id, res);
+
+    return 0;
+}
+
+static uint64_t
+gf_io_legacy_statx(uint64_t seq, uint64_t id, gf_io_op_t *op, uint32_t count)
+{
+    int32_t res;
+
+#ifdef STATX_BASIC_STATS
+    res = gf_io_convert_from_errno0(statx(op->statx.dfd, op->statx.path,
+                                          op->statx.flags, op->statx.mask,
+                                          op->statx.buf));
+#else
+    res = -ENOSYS;
+#endif
+    gf_io_legacy_cbk(id, res);
+
+    return 0;
+}
+
+static uint64_t
+gf_io_legacy_openat(uint64_t seq, uint64_t id, gf_io_op_t *op, uint32_t count)
+{
+    int32_t res;
+
+    res = gf_io_convert_from_errno(sys_openat(
+        op->openat.dfd, op->openat.path, op->openat.flags, op->openat.mode));
+    gf_io_legacy_cbk(id, res);
+
+    return 0;
+}
+
+static uint64_t
+gf_io_legacy_getxattr(uint64_t seq, uint64_t id, gf_io_op_t *op,
+                      uint32_t count)
+{
+    ssize_t res;
+
+    if (op->xattr.fd >= 0) {
+        res = sys_fgetxattr(op->xattr.fd, op->xattr.name, op->xattr.value,
+                            op->xattr.size);
+    } else {
+        res = sys_lgetxattr(op->xattr.path, op->xattr.name, op->xattr.value,
+                            op->xattr.size);
+    }
+    gf_io_legacy_cbk(id, gf_io_convert_from_errno(res));
+
+    return 0;
+}
+
+static uint64_t
+gf_io_legacy_setxattr(uint64_t seq, uint64_t id, gf_io_op_t *op,
+                      uint32_t count)
+{
+    int32_t res;
+
+    if (op->xattr.fd >= 0) {
+        res = sys_fsetxattr(op->xattr.fd, op->xattr.name, op->xattr.value,
+                            op->xattr.size, op->xattr.flags);
+    } else {
+        res = sys_lsetxattr(op->xattr.path, op->xattr.name, op->xattr.value,
+                            op->xattr.size, op->xattr.flags);
+    }
+    gf_io_legacy_cbk(id, gf_io_convert_from_errno0(res));
+
+    return 0;
+}
+
+static uint64_t
+gf_io_legacy_fallocate(uint64_t seq, uint64_t id, gf_io_op_t *op,
+                       uint32_t count)
+{
+    int32_t res;
+
+    res = gf_io_convert_from_errno0(
+        sys_fallocate(op->fallocate.fd, op->fallocate.mode,
+                      op->fallocate.offset, op->fallocate.len));
+    gf_io_legacy_cbk(id, res);
+
+    return 0;
+}
+
+/* Registered buffers only make sense when the kernel does the I/O. */
+static int32_t
+gf_io_legacy_register_buffers(const struct iovec *iov, uint32_t count)
+{
+    return -ENOTSUP;
+}
+
 const gf_io_engine_t gf_io_engine_legacy = {
     .name = "legacy",
     .mode = GF_IO_MODE_LEGACY,
@@ -95,5 +300,18 @@ const gf_io_engine_t gf_io_engine_legacy = {
     .flush = gf_io_legacy_flush,
 
     .cancel = gf_io_legacy_cancel,
-    .callback = gf_io_legacy_callback
+    .callback = gf_io_legacy_callback,
+    .readv = gf_io_legacy_readv,
+    .writev = gf_io_legacy_writev,
+    .fsync = gf_io_legacy_fsync,
+    .read_fixed = gf_io_legacy_read_fixed,
+    .write_fixed = gf_io_legacy_write_fixed,
+    .statx = gf_io_legacy_statx,
+    .openat = gf_io_legacy_openat,
+    .getxattr = gf_io_legacy_getxattr,
+    .setxattr = gf_io_legacy_setxattr,
+    .fallocate = gf_io_legacy_fallocate,
+    .supported = NULL,
+
+    .register_buffers = gf_io_legacy_register_buffers
 };
@@ -105,6 +105,9 @@ typedef struct _gf_io_uring {
     gf_io_uring_cq_t cq;
     struct io_uring_params params;
     uint32_t fd;
+
+    /* Opcodes supported by the kernel, as reported by the probe. */
+    bool ops[256];
 } gf_io_uring_t;
 
 /* Global io_uring state. */
@@ -451,8 +454,14 @@ gf_io_uring_setup(void)
     }
     gf_io_uring_dump_ops(probe);
 
-    /* TODO: we may check if the system supports the required subset of
-     *       operations. */
+    /* Operations not present in older kernels are only used if supported.
+     * Otherwise the callers fall back to the synchronous system calls. */
+    memset(gf_io_uring.ops, 0, sizeof(gf_io_uring.ops));
+    for (i = 0; i < probe->ops_len; i++) {
+        if ((probe->ops[i].flags & IO_URING_OP_SUPPORTED) != 0) {
+            gf_io_uring.ops[probe->ops[i].op] = true;
+        }
+    }
 
     gf_io_uring.fd = fd;
 
@@ -800,11 +809,10 @@ gf_io_uring_get(uint32_t seq)
 }
 
 static uint64_t
-gf_io_uring_common(uint64_t seq, uint64_t id, struct io_uring_sqe *sqe,
+gf_io_uring_submit(uint64_t seq, uint64_t id, struct io_uring_sqe *sqe,
                    uint32_t count)
 {
     sqe->user_data = id;
-    sqe->__pad2[0] = sqe->__pad2[1] = 0;
 
     if ((id & GF_IO_ID_FLAG_CHAIN) == 0) {
         gf_io_uring_sq_commit(seq & gf_io_uring.sq.mask, count);
@@ -813,6 +821,15 @@ gf_io_uring_common(uint64_t seq, uint64_t id, struct io_uring_sqe *sqe,
     return id;
 }
 
+static uint64_t
+gf_io_uring_common(uint64_t seq, uint64_t id, struct io_uring_sqe *sqe,
+                   uint32_t count)
+{
+    sqe->__pad2[0] = sqe->__pad2[1] = 0;
+
+    return gf_io_uring_submit(seq, id, sqe, count);
+}
+
 static uint64_t
 gf_io_uring_cancel(uint64_t seq, uint64_t id, gf_io_op_t *op, uint32_t count)
 {
@@ -857,6 +874,267 @@ gf_io_uring_callback(uint64_t seq, uint64_t id, gf_io_op_t *op, uint32_t count)
     return gf_io_uring_common(seq, id, sqe, count);
 }
 
+static uint64_t
+gf_io_uring_rw(uint64_t seq, uint64_t id, gf_io_op_t *op, uint32_t count,
+               uint8_t opcode)
+{
+    struct io_uring_sqe *sqe;
+
+    sqe = gf_io_uring_get(seq + count - 1);
+
+    sqe->opcode = opcode;
+    sqe->flags = 0;
+    sqe->ioprio = 0;
+    sqe->fd = op->rw.fd;
+    sqe->off = op->rw.offset;
+    sqe->addr = (uintptr_t)op->rw.iov;
+    sqe->len = op->rw.count;
+    sqe->rw_flags = 0;
+
+    return gf_io_uring_common(seq, id, sqe, count);
+}
+
+static uint64_t
+gf_io_uring_readv(uint64_t seq, uint64_t id, gf_io_op_t *op, uint32_t count)
+{
+    return gf_io_uring_rw(seq, id, op, count, IORING_OP_READV);
+}
+
+static uint64_t
+gf_io_uring_writev(uint64_t seq, uint64_t id, gf_io_op_t *op, uint32_t count)
+{
+    return gf_io_uring_rw(seq, id, op, count, IORING_OP_WRITEV);
+}
+
+static uint64_t
+gf_io_uring_fsync(uint64_t seq, uint64_t id, gf_io_op_t *op, uint32_t count)
+{
+    struct io_uring_sqe *sqe;
+
+    sqe = gf_io_uring_get(seq + count - 1);
+
+    sqe->opcode = IORING_OP_FSYNC;
+    sqe->flags = 0;
+    sqe->ioprio = 0;
+    sqe->fd = op->fsync.fd;
+    sqe->off = 0;
+    sqe->addr = 0;
+    sqe->len = 0;
+    sqe->fsync_flags = 0;
+    if ((op->fsync.flags & GF_IO_FSYNC_DATASYNC) != 0) {
+        sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+    }
+
+    return gf_io_uring_common(seq, id, sqe, count);
+}
+
+static uint64_t
+gf_io_uring_fixed(uint64_t seq, uint64_t id, gf_io_op_t *op, uint32_t count,
+                  uint8_t opcode)
+{
+    struct io_uring_sqe *sqe;
+
+    sqe = gf_io_uring_get(seq + count - 1);
+
+    sqe->opcode = opcode;
+    sqe->flags = 0;
+    sqe->ioprio = 0;
+    sqe->fd = op->fixed.fd;
+    sqe->off = op->fixed.offset;
+    sqe->addr = (uintptr_t)op->fixed.buf;
+    sqe->len = op->fixed.size;
+    sqe->rw_flags = 0;
+
+    /* 'buf_index' shares storage with the padding that gf_io_uring_common()
+     * clears, so it's cleared here before setting the index. */
+    sqe->__pad2[0] = sqe->__pad2[1] = 0;
+    sqe->buf_index = op->fixed.index;
+
+    return gf_io_uring_submit(seq, id, sqe, count);
+}
+
+static uint64_t
+gf_io_uring_read_fixed(uint64_t seq, uint64_t id, gf_io_op_t *op,
+                       uint32_t count)
+{
+    return gf_io_uring_fixed(seq, id, op, count, IORING_OP_READ_FIXED);
+}
+
+static uint64_t
+gf_io_uring_write_fixed(uint64_t seq, uint64_t id, gf_io_op_t *op,
+                        uint32_t count)
+{
+    return gf_io_uring_fixed(seq, id, op, count, IORING_OP_WRITE_FIXED);
+}
+
+static uint64_t
+gf_io_uring_statx(uint64_t seq, uint64_t id, gf_io_op_t *op, uint32_t count)
+{
+    struct io_uring_sqe *sqe;
+
+    sqe = gf_io_uring_get(seq + count - 1);
+
+    sqe->opcode = IORING_OP_STATX;
+    sqe->flags = 0;
+    sqe->ioprio = 0;
+    sqe->fd = op->statx.dfd;
+    sqe->off = (uintptr_t)op->statx.buf;
+    sqe->addr = (uintptr_t)op->statx.path;
+    sqe->len = op->statx.mask;
+    sqe->statx_flags = op->statx.flags;
+
+    return gf_io_uring_common(seq, id, sqe, count);
+}
+
+static uint64_t
+gf_io_uring_openat(uint64_t seq, uint64_t id, gf_io_op_t *op, uint32_t count)
+{
+    struct io_uring_sqe *sqe;
+
+    sqe = gf_io_uring_get(seq + count - 1);
+
+    sqe->opcode = IORING_OP_OPENAT;
+    sqe->flags = 0;
+    sqe->ioprio = 0;
+    sqe->fd = op->openat.dfd;
+    sqe->off = 0;
+    sqe->addr = (uintptr_t)op->openat.path;
+    sqe->len = op->openat.mode;
+    sqe->open_flags = op->openat.flags;
+
+    return gf_io_uring_common(seq, id, sqe, count);
+}
+
+#if HAVE_DECL_IORING_OP_GETXATTR
+
+/* If 'fd' is negative, the path based variant of the opcode is used. */
+static uint64_t
+gf_io_uring_xattr(uint64_t seq, uint64_t id, gf_io_op_t *op, uint32_t count,
+                  uint8_t opcode_fd, uint8_t opcode_path)
+{
+    struct io_uring_sqe *sqe;
+
+    sqe = gf_io_uring_get(seq + count - 1);
+
+    sqe->flags = 0;
+    sqe->ioprio = 0;
+    if (op->xattr.fd >= 0) {
+        sqe->opcode = opcode_fd;
+        sqe->fd = op->xattr.fd;
+        sqe->addr3 = 0;
+    } else {
+        sqe->opcode = opcode_path;
+        sqe->fd = -1;
+        sqe->addr3 = (uintptr_t)op->xattr.path;
+    }
+    sqe->addr2 = (uintptr_t)op->xattr.value;
+    sqe->addr = (uintptr_t)op->xattr.name;
+    sqe->len = op->xattr.size;
+    sqe->xattr_flags = op->xattr.flags;
+
+    return gf_io_uring_common(seq, id, sqe, count);
+}
+
+static uint64_t
+gf_io_uring_getxattr(uint64_t seq, uint64_t id, gf_io_op_t *op,
+                     uint32_t count)
+{
+    return gf_io_uring_xattr(seq, id, op, count, IORING_OP_FGETXATTR,
+                             IORING_OP_GETXATTR);
+}
+
+static uint64_t
+gf_io_uring_setxattr(uint64_t seq, uint64_t id, gf_io_op_t *op,
+                     uint32_t count)
+{
+    return gf_io_uring_xattr(seq, id, op, count, IORING_OP_FSETXATTR,
+                             IORING_OP_SETXATTR);
+}
+
+#else /* ! HAVE_DECL_IORING_OP_GETXATTR */
+
+/* The kernel headers used to build don't define the xattr opcodes, so
+ * gf_io_uring_supported() never reports these functions as available. */
+
+static uint64_t
+gf_io_uring_getxattr(uint64_t seq, uint64_t id, gf_io_op_t *op,
+                     uint32_t count)
+{
+    GF_ABORT();
+}
+
+static uint64_t
+gf_io_uring_setxattr(uint64_t seq, uint64_t id, gf_io_op_t *op,
+                     uint32_t count)
+{
+    GF_ABORT();
+}
+
+#endif /* HAVE_DECL_IORING_OP_GETXATTR */
+
+static uint64_t
+gf_io_uring_fallocate(uint64_t seq, uint64_t id, gf_io_op_t *op,
+                      uint32_t count)
+{
+    struct io_uring_sqe *sqe;
+
+    sqe = gf_io_uring_get(seq + count - 1);
+
+    sqe->opcode = IORING_OP_FALLOCATE;
+    sqe->flags = 0;
+    sqe->ioprio = 0;
+    sqe->fd = op->fallocate.fd;
+    sqe->off = op->fallocate.offset;
+    sqe->addr = op->fallocate.len;
+    sqe->len = op->fallocate.mode;
+    sqe->rw_flags = 0;
+
+    return gf_io_uring_common(seq, id, sqe, count);
+}
+
+/* Check if the opcodes needed by an operation are supported by the kernel.
+ * Operations available since the first kernels with io_uring are not
+ * checked. */
+static bool
+gf_io_uring_supported(gf_io_engine_op_t op)
+{
+    if (op == gf_io_uring_statx) {
+        return gf_io_uring.ops[IORING_OP_STATX];
+    }
+    if (op == gf_io_uring_openat) {
+        return gf_io_uring.ops[IORING_OP_OPENAT];
+    }
+    if (op == gf_io_uring_fallocate) {
+        return gf_io_uring.ops[IORING_OP_FALLOCATE];
+    }
+#if HAVE_DECL_IORING_OP_GETXATTR
+    if (op == gf_io_uring_getxattr) {
+        return gf_io_uring.ops[IORING_OP_FGETXATTR] &&
+               gf_io_uring.ops[IORING_OP_GETXATTR];
+    }
+    if (op == gf_io_uring_setxattr) {
+        return gf_io_uring.ops[IORING_OP_FSETXATTR] &&
+               gf_io_uring.ops[IORING_OP_SETXATTR];
+    }
+#else
+    if ((op == gf_io_uring_getxattr) || (op == gf_io_uring_setxattr)) {
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+/* Register buffers for READ_FIXED and WRITE_FIXED requests. The kernel pins
+ * the pages once here instead of doing it for each request. The registration
+ * is released when the io_uring instance is closed. */
+static int32_t
+gf_io_uring_register_buffers(const struct iovec *iov, uint32_t count)
+{
+    return gf_io_call_errno0(io_uring_register, gf_io_uring.fd,
+                             IORING_REGISTER_BUFFERS, (void *)iov, count);
+}
+
 const gf_io_engine_t gf_io_engine_io_uring = {
     .name = "io_uring",
     .mode = GF_IO_MODE_IO_URING,
@@ -873,5 +1151,18 @@ const gf_io_engine_t gf_io_engine_io_uring = {
     .flush = gf_io_uring_flush,
 
     .cancel = gf_io_uring_cancel,
-    .callback = gf_io_uring_callback
+    .callback = gf_io_uring_callback,
+    .readv = gf_io_uring_readv,
+    .writev = gf_io_uring_writev,
+    .fsync = gf_io_uring_fsync,
+    .read_fixed = gf_io_uring_read_fixed,
+    .write_fixed = gf_io_uring_write_fixed,
+    .statx = gf_io_uring_statx,
+    .openat = gf_io_uring_openat,
+    .getxattr = gf_io_uring_getxattr,
+    .setxattr = gf_io_uring_setxattr,
+    .fallocate = gf_io_uring_fallocate,
+    .supported = gf_io_uring_supported,
+
+    .register_buffers = gf_io_uring_register_buffers
 };
@@ -134,6 +134,7 @@ typedef struct _call_stub {
     glusterfs_fop_t fop;
     uint32_t poison;
     uint32_t wind;
+    struct timespec queued; /* set by whoever queues the stub, if needed */
     default_args_t args;
     default_args_cbk_t args_cbk;
 } call_stub_t;
@@ -61,10 +61,11 @@
         __gf_io_convert_res;                                                   \
     })
 
-/* From an errno code to 'res' (for example open()). */
+/* From an errno code to 'res' (for example open()). The result keeps the
+ * type of '_ret', so that a ssize_t is not truncated. */
 #define gf_io_convert_from_errno(_ret)                                         \
     ({                                                                         \
-        int32_t __gf_io_convert_res = (_ret);                                  \
+        __typeof__(_ret) __gf_io_convert_res = (_ret);                         \
         if (caa_unlikely(__gf_io_convert_res < 0)) {                           \
             if (caa_unlikely((__gf_io_convert_res != -1) || (errno <= 0))) {   \
                 __gf_io_convert_res = -EUCLEAN;                                \
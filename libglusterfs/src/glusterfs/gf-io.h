@@ -16,6 +16,7 @@
 #include <inttypes.h>
 #include <pthread.h>
 #include <errno.h>
+#include <sys/uio.h>
 
 #include <urcu/uatomic.h>
 
@@ -77,6 +78,9 @@
 
 /* Forward declaration of some structures. */
 
+/* Defined in <sys/stat.h>. */
+struct statx;
+
 /* Data related to an operation. */
 struct _gf_io_op;
 typedef struct _gf_io_op gf_io_op_t;
@@ -189,9 +193,120 @@ struct _gf_io_op {
             /* Id of the request to cancel. */
             uint64_t id;
         } cancel;
+
+        struct {
+            /* Array of buffers to read into or write from. */
+            const struct iovec *iov;
+
+            /* Offset of the file where the operation starts. */
+            uint64_t offset;
+
+            /* File descriptor. */
+            int32_t fd;
+
+            /* Number of entries in 'iov'. */
+            uint32_t count;
+        } rw;
+
+        struct {
+            /* Buffer to read into or write from. It must be contained in
+             * one of the buffers registered with gf_io_register_buffers(). */
+            void *buf;
+
+            /* Offset of the file where the operation starts. */
+            uint64_t offset;
+
+            /* File descriptor. */
+            int32_t fd;
+
+            /* Size of the buffer. */
+            uint32_t size;
+
+            /* Index of the registered buffer that contains 'buf'. */
+            uint32_t index;
+        } fixed;
+
+        struct {
+            /* File descriptor. */
+            int32_t fd;
+
+            /* GF_IO_FSYNC_* flags. */
+            uint32_t flags;
+        } fsync;
+
+        struct {
+            /* Path of the file, relative to 'dfd'. It can be empty if
+             * AT_EMPTY_PATH is used, to get the attributes of 'dfd'. */
+            const char *path;
+
+            /* Buffer where the attributes are returned. */
+            struct statx *buf;
+
+            /* Directory file descriptor (or AT_FDCWD). */
+            int32_t dfd;
+
+            /* AT_* flags. */
+            uint32_t flags;
+
+            /* STATX_* mask of the requested attributes. */
+            uint32_t mask;
+        } statx;
+
+        struct {
+            /* Path of the file, relative to 'dfd'. */
+            const char *path;
+
+            /* Directory file descriptor (or AT_FDCWD). */
+            int32_t dfd;
+
+            /* O_* flags. */
+            int32_t flags;
+
+            /* Mode used if the file is created. */
+            uint32_t mode;
+        } openat;
+
+        struct {
+            /* Path of the file. Only used when 'fd' is negative. Symbolic
+             * links are followed by io_uring but not by the legacy engine,
+             * so it must not point to a symbolic link. */
+            const char *path;
+
+            /* Name of the extended attribute. */
+            const char *name;
+
+            /* Buffer to read the value into or to write it from. */
+            void *value;
+
+            /* File descriptor, or -1 to use 'path'. */
+            int32_t fd;
+
+            /* Size of 'value'. */
+            uint32_t size;
+
+            /* XATTR_CREATE or XATTR_REPLACE ('setxattr' only). */
+            int32_t flags;
+        } xattr;
+
+        struct {
+            /* Offset of the file where the range starts. */
+            uint64_t offset;
+
+            /* Length of the range. */
+            uint64_t len;
+
+            /* File descriptor. */
+            int32_t fd;
+
+            /* FALLOC_FL_* flags. */
+            int32_t mode;
+        } fallocate;
     };
 };
 
+/* Only flush data, not metadata, in an 'fsync' request. */
+#define GF_IO_FSYNC_DATASYNC 1
+
 /* Structure to keep a list of requests that will be sent together in a
  * single shot. */
 typedef struct _gf_io_batch {
@@ -278,6 +393,44 @@ typedef struct _gf_io_engine {
     /* Function to call a callback in the background. */
     gf_io_engine_op_t callback;
 
+    /* Function to read data from a file into a set of buffers. */
+    gf_io_engine_op_t readv;
+
+    /* Function to write data from a set of buffers into a file. */
+    gf_io_engine_op_t writev;
+
+    /* Function to flush cached data of a file to disk. */
+    gf_io_engine_op_t fsync;
+
+    /* Function to read data from a file into a registered buffer. */
+    gf_io_engine_op_t read_fixed;
+
+    /* Function to write data from a registered buffer into a file. */
+    gf_io_engine_op_t write_fixed;
+
+    /* Function to get the attributes of a file. */
+    gf_io_engine_op_t statx;
+
+    /* Function to open a file. */
+    gf_io_engine_op_t openat;
+
+    /* Function to get the value of an extended attribute. */
+    gf_io_engine_op_t getxattr;
+
+    /* Function to set the value of an extended attribute. */
+    gf_io_engine_op_t setxattr;
+
+    /* Function to allocate or deallocate space of a file. */
+    gf_io_engine_op_t fallocate;
+
+    /* Function to check if the engine can process an operation. It can be
+     * NULL if all operations are always supported. */
+    bool (*supported)(gf_io_engine_op_t op);
+
+    /* Function to register a set of buffers that will be used by fixed
+     * read and write requests. It can only be called once. */
+    int32_t (*register_buffers)(const struct iovec *iov, uint32_t count);
+
     /* Mode of operation of the engine. */
     gf_io_mode_t mode;
 } gf_io_engine_t;
@@ -593,4 +746,355 @@ gf_io_async_prepare(gf_io_request_t *req, gf_io_async_t async, void *data,
     gf_io_async_common(&req->op, async, cbk, data);
 }
 
+/* Operations 'readv' and 'writev' */
+
+static inline void
+gf_io_rw_common(gf_io_op_t *op, int32_t fd, const struct iovec *iov,
+                uint32_t count, uint64_t offset)
+{
+    op->rw.iov = iov;
+    op->rw.offset = offset;
+    op->rw.fd = fd;
+    op->rw.count = count;
+}
+
+static inline uint64_t
+gf_io_readv(gf_io_callback_t cbk, int32_t fd, const struct iovec *iov,
+            uint32_t count, uint64_t offset, void *data)
+{
+    gf_io_op_t *op;
+    uint64_t seq, id;
+
+    seq = gf_io_reserve(1);
+    id = gf_io_get(seq);
+    op = gf_io_single_common(id, cbk, data);
+    gf_io_rw_common(op, fd, iov, count, offset);
+
+    return gf_io.engine.readv(seq, id, op, 1);
+}
+
+static inline void
+gf_io_readv_prepare(gf_io_request_t *req, gf_io_callback_t cbk, int32_t fd,
+                    const struct iovec *iov, uint32_t count, uint64_t offset,
+                    void *data)
+{
+    gf_io_prepare_common(req, gf_io.engine.readv, cbk, data);
+    gf_io_rw_common(&req->op, fd, iov, count, offset);
+}
+
+static inline uint64_t
+gf_io_writev(gf_io_callback_t cbk, int32_t fd, const struct iovec *iov,
+             uint32_t count, uint64_t offset, void *data)
+{
+    gf_io_op_t *op;
+    uint64_t seq, id;
+
+    seq = gf_io_reserve(1);
+    id = gf_io_get(seq);
+    op = gf_io_single_common(id, cbk, data);
+    gf_io_rw_common(op, fd, iov, count, offset);
+
+    return gf_io.engine.writev(seq, id, op, 1);
+}
+
+static inline void
+gf_io_writev_prepare(gf_io_request_t *req, gf_io_callback_t cbk, int32_t fd,
+                     const struct iovec *iov, uint32_t count, uint64_t offset,
+                     void *data)
+{
+    gf_io_prepare_common(req, gf_io.engine.writev, cbk, data);
+    gf_io_rw_common(&req->op, fd, iov, count, offset);
+}
+
+/* Operation 'fsync' */
+
+static inline void
+gf_io_fsync_common(gf_io_op_t *op, int32_t fd, uint32_t flags)
+{
+    op->fsync.fd = fd;
+    op->fsync.flags = flags;
+}
+
+static inline uint64_t
+gf_io_fsync(gf_io_callback_t cbk, int32_t fd, uint32_t flags, void *data)
+{
+    gf_io_op_t *op;
+    uint64_t seq, id;
+
+    seq = gf_io_reserve(1);
+    id = gf_io_get(seq);
+    op = gf_io_single_common(id, cbk, data);
+    gf_io_fsync_common(op, fd, flags);
+
+    return gf_io.engine.fsync(seq, id, op, 1);
+}
+
+static inline void
+gf_io_fsync_prepare(gf_io_request_t *req, gf_io_callback_t cbk, int32_t fd,
+                    uint32_t flags, void *data)
+{
+    gf_io_prepare_common(req, gf_io.engine.fsync, cbk, data);
+    gf_io_fsync_common(&req->op, fd, flags);
+}
+
+/* Operations 'read_fixed' and 'write_fixed' */
+
+/* Register a set of buffers to be used by fixed read and write requests.
+ * The memory is pinned by the kernel, so it's not necessary to map it on
+ * each request. The buffers must not be released while the I/O framework
+ * is running. */
+static inline int32_t
+gf_io_register_buffers(const struct iovec *iov, uint32_t count)
+{
+    if (gf_io.engine.register_buffers == NULL) {
+        return -ENOTSUP;
+    }
+
+    return gf_io.engine.register_buffers(iov, count);
+}
+
+static inline void
+gf_io_fixed_common(gf_io_op_t *op, int32_t fd, void *buf, uint32_t size,
+                   uint64_t offset, uint32_t index)
+{
+    op->fixed.buf = buf;
+    op->fixed.offset = offset;
+    op->fixed.fd = fd;
+    op->fixed.size = size;
+    op->fixed.index = index;
+}
+
+static inline uint64_t
+gf_io_read_fixed(gf_io_callback_t cbk, int32_t fd, void *buf, uint32_t size,
+                 uint64_t offset, uint32_t index, void *data)
+{
+    gf_io_op_t *op;
+    uint64_t seq, id;
+
+    seq = gf_io_reserve(1);
+    id = gf_io_get(seq);
+    op = gf_io_single_common(id, cbk, data);
+    gf_io_fixed_common(op, fd, buf, size, offset, index);
+
+    return gf_io.engine.read_fixed(seq, id, op, 1);
+}
+
+static inline void
+gf_io_read_fixed_prepare(gf_io_request_t *req, gf_io_callback_t cbk,
+                         int32_t fd, void *buf, uint32_t size,
+                         uint64_t offset, uint32_t index, void *data)
+{
+    gf_io_prepare_common(req, gf_io.engine.read_fixed, cbk, data);
+    gf_io_fixed_common(&req->op, fd, buf, size, offset, index);
+}
+
+static inline uint64_t
+gf_io_write_fixed(gf_io_callback_t cbk, int32_t fd, void *buf, uint32_t size,
+                  uint64_t offset, uint32_t index, void *data)
+{
+    gf_io_op_t *op;
+    uint64_t seq, id;
+
+    seq = gf_io_reserve(1);
+    id = gf_io_get(seq);
+    op = gf_io_single_common(id, cbk, data);
+    gf_io_fixed_common(op, fd, buf, size, offset, index);
+
+    return gf_io.engine.write_fixed(seq, id, op, 1);
+}
+
+static inline void
+gf_io_write_fixed_prepare(gf_io_request_t *req, gf_io_callback_t cbk,
+                          int32_t fd, void *buf, uint32_t size,
+                          uint64_t offset, uint32_t index, void *data)
+{
+    gf_io_prepare_common(req, gf_io.engine.write_fixed, cbk, data);
+    gf_io_fixed_common(&req->op, fd, buf, size, offset, index);
+}
+
+/* Check if an operation of the active engine can be used. Operations that
+ * depend on features not present in the running kernel are reported as not
+ * supported, and the caller must use the synchronous system call instead. */
+static inline bool
+gf_io_supported(gf_io_engine_op_t op)
+{
+    if (op == NULL) {
+        return false;
+    }
+
+    return (gf_io.engine.supported == NULL) || gf_io.engine.supported(op);
+}
+
+/* Operation 'statx' */
+
+static inline void
+gf_io_statx_common(gf_io_op_t *op, int32_t dfd, const char *path,
+                   uint32_t flags, uint32_t mask, struct statx *buf)
+{
+    op->statx.path = path;
+    op->statx.buf = buf;
+    op->statx.dfd = dfd;
+    op->statx.flags = flags;
+    op->statx.mask = mask;
+}
+
+static inline uint64_t
+gf_io_statx(gf_io_callback_t cbk, int32_t dfd, const char *path,
+            uint32_t flags, uint32_t mask, struct statx *buf, void *data)
+{
+    gf_io_op_t *op;
+    uint64_t seq, id;
+
+    seq = gf_io_reserve(1);
+    id = gf_io_get(seq);
+    op = gf_io_single_common(id, cbk, data);
+    gf_io_statx_common(op, dfd, path, flags, mask, buf);
+
+    return gf_io.engine.statx(seq, id, op, 1);
+}
+
+static inline void
+gf_io_statx_prepare(gf_io_request_t *req, gf_io_callback_t cbk, int32_t dfd,
+                    const char *path, uint32_t flags, uint32_t mask,
+                    struct statx *buf, void *data)
+{
+    gf_io_prepare_common(req, gf_io.engine.statx, cbk, data);
+    gf_io_statx_common(&req->op, dfd, path, flags, mask, buf);
+}
+
+/* Operation 'openat' */
+
+static inline void
+gf_io_openat_common(gf_io_op_t *op, int32_t dfd, const char *path,
+                    int32_t flags, uint32_t mode)
+{
+    op->openat.path = path;
+    op->openat.dfd = dfd;
+    op->openat.flags = flags;
+    op->openat.mode = mode;
+}
+
+static inline uint64_t
+gf_io_openat(gf_io_callback_t cbk, int32_t dfd, const char *path,
+             int32_t flags, uint32_t mode, void *data)
+{
+    gf_io_op_t *op;
+    uint64_t seq, id;
+
+    seq = gf_io_reserve(1);
+    id = gf_io_get(seq);
+    op = gf_io_single_common(id, cbk, data);
+    gf_io_openat_common(op, dfd, path, flags, mode);
+
+    return gf_io.engine.openat(seq, id, op, 1);
+}
+
+static inline void
+gf_io_openat_prepare(gf_io_request_t *req, gf_io_callback_t cbk, int32_t dfd,
+                     const char *path, int32_t flags, uint32_t mode,
+                     void *data)
+{
+    gf_io_prepare_common(req, gf_io.engine.openat, cbk, data);
+    gf_io_openat_common(&req->op, dfd, path, flags, mode);
+}
+
+/* Operations 'getxattr' and 'setxattr' */
+
+static inline void
+gf_io_xattr_common(gf_io_op_t *op, int32_t fd, const char *path,
+                   const char *name, void *value, uint32_t size, int32_t flags)
+{
+    op->xattr.path = path;
+    op->xattr.name = name;
+    op->xattr.value = value;
+    op->xattr.fd = fd;
+    op->xattr.size = size;
+    op->xattr.flags = flags;
+}
+
+static inline uint64_t
+gf_io_getxattr(gf_io_callback_t cbk, int32_t fd, const char *path,
+               const char *name, void *value, uint32_t size, void *data)
+{
+    gf_io_op_t *op;
+    uint64_t seq, id;
+
+    seq = gf_io_reserve(1);
+    id = gf_io_get(seq);
+    op = gf_io_single_common(id, cbk, data);
+    gf_io_xattr_common(op, fd, path, name, value, size, 0);
+
+    return gf_io.engine.getxattr(seq, id, op, 1);
+}
+
+static inline void
+gf_io_getxattr_prepare(gf_io_request_t *req, gf_io_callback_t cbk, int32_t fd,
+                       const char *path, const char *name, void *value,
+                       uint32_t size, void *data)
+{
+    gf_io_prepare_common(req, gf_io.engine.getxattr, cbk, data);
+    gf_io_xattr_common(&req->op, fd, path, name, value, size, 0);
+}
+
+static inline uint64_t
+gf_io_setxattr(gf_io_callback_t cbk, int32_t fd, const char *path,
+               const char *name, const void *value, uint32_t size,
+               int32_t flags, void *data)
+{
+    gf_io_op_t *op;
+    uint64_t seq, id;
+
+    seq = gf_io_reserve(1);
+    id = gf_io_get(seq);
+    op = gf_io_single_common(id, cbk, data);
+    gf_io_xattr_common(op, fd, path, name, (void *)value, size, flags);
+
+    return gf_io.engine.setxattr(seq, id, op, 1);
+}
+
+static inline void
+gf_io_setxattr_prepare(gf_io_request_t *req, gf_io_callback_t cbk, int32_t fd,
+                       const char *path, const char *name, const void *value,
+                       uint32_t size, int32_t flags, void *data)
+{
+    gf_io_prepare_common(req, gf_io.engine.setxattr, cbk, data);
+    gf_io_xattr_common(&req->op, fd, path, name, (void *)value, size, flags);
+}
+
+/* Operation 'fallocate' */
+
+static inline void
+gf_io_fallocate_common(gf_io_op_t *op, int32_t fd, int32_t mode,
+                       uint64_t offset, uint64_t len)
+{
+    op->fallocate.offset = offset;
+    op->fallocate.len = len;
+    op->fallocate.fd = fd;
+    op->fallocate.mode = mode;
+}
+
+static inline uint64_t
+gf_io_fallocate(gf_io_callback_t cbk, int32_t fd, int32_t mode,
+                uint64_t offset, uint64_t len, void *data)
+{
+    gf_io_op_t *op;
+    uint64_t seq, id;
+
+    seq = gf_io_reserve(1);
+    id = gf_io_get(seq);
+    op = gf_io_single_common(id, cbk, data);
+    gf_io_fallocate_common(op, fd, mode, offset, len);
+
+    return gf_io.engine.fallocate(seq, id, op, 1);
+}
+
+static inline void
+gf_io_fallocate_prepare(gf_io_request_t *req, gf_io_callback_t cbk, int32_t fd,
+                        int32_t mode, uint64_t offset, uint64_t len,
+                        void *data)
+{
+    gf_io_prepare_common(req, gf_io.engine.fallocate, cbk, data);
+    gf_io_fallocate_common(&req->op, fd, mode, offset, len);
+}
+
 #endif /* __GF_IO_H__ */
@@ -45,7 +45,7 @@
     1 /* MIN is the fresh start op-version, mostly                             \
          should not change */
 #define GD_OP_VERSION_MAX                                                      \
-    GD_OP_VERSION_10_0 /* MAX VERSION is the maximum                           \
+    GD_OP_VERSION_11_0 /* MAX VERSION is the maximum                           \
                          count in VME table, should                            \
                          keep changing with                                    \
                          introduction of newer                                 \
@@ -126,6 +126,8 @@
 
 #define GD_OP_VERSION_10_0 100000 /* Op-version for GlusterFS 10.0 */
 
+#define GD_OP_VERSION_11_0 110000 /* Op-version for GlusterFS 11.0 */
+
 #define GD_OP_VER_PERSISTENT_AFR_XATTRS GD_OP_VERSION_3_6_0
 
 #include "glusterfs/xlator.h"
@@ -240,6 +240,9 @@ enum gf_internal_fop_indicator {
 #define GF_XATTROP_INDEX_COUNT "glusterfs.xattrop_index_count"
 #define GF_XATTROP_DIRTY_GFID "glusterfs.xattrop_dirty_gfid"
 #define GF_XATTROP_DIRTY_COUNT "glusterfs.xattrop_dirty_count"
+#define GF_INDEX_BY_PRIORITY "glusterfs.index-by-priority"
+#define GF_INDEX_PARTITION "glusterfs.index-partition"
+#define GF_INDEX_PARTITIONS "glusterfs.index-partitions"
 #define GF_XATTROP_ENTRY_IN_KEY "glusterfs.xattrop-entry-create"
 #define GF_XATTROP_ENTRY_OUT_KEY "glusterfs.xattrop-entry-delete"
 #define GF_INDEX_IA_TYPE_GET_REQ "glusterfs.index-ia-type-get-req"
@@ -326,6 +329,12 @@ enum gf_internal_fop_indicator {
 #define GF_PRESTAT "virt-gf-prestat"
 #define GF_POSTSTAT "virt-gf-poststat"
 
+/* rchecksum of a range as the checksum of the checksums of its leaves, the
+ * length of the range being in the request instead of the one of the fop */
+#define GF_RCHECKSUM_TREE "glusterfs.rchecksum-tree"
+#define GF_RCHECKSUM_TREE_LEAF_SIZE (1024 * 1024)
+#define GF_RCHECKSUM_TREE_MAX_LEAVES (64 * 1024)
+
 /*CTR and Marker requires inode dentry link count from posix*/
 #define GF_RESPONSE_LINK_COUNT_XDATA "gf_response_link_count"
 #define GF_REQUEST_LINK_COUNT_XDATA "gf_request_link_count"
@@ -595,6 +604,10 @@ struct _cmd_args {
     uint32_t fuse_dev_eperm_ratelimit_ns;
 
     char *io_engine;
+
+    /* FUSE large requests and per-thread channels */
+    uint32_t fuse_max_write;
+    int fuse_clone_fd;
 };
 typedef struct _cmd_args cmd_args_t;
 
@@ -13,11 +13,14 @@
 
 #include <stdint.h>
 #include <sys/types.h>
+#include <urcu/arch.h> // CAA_CACHE_LINE_SIZE
 
 #define LOOKUP_NEEDED 1
 #define LOOKUP_NOT_NEEDED 2
 
 #define DEFAULT_INODE_MEMPOOL_ENTRIES 32 * 1024
+/* Maximum number of lock shards of an inode table */
+#define INODE_TABLE_SHARDS 64
 #define INODE_PATH_FMT "<gfid:%s>"
 struct _inode_table;
 typedef struct _inode_table inode_table_t;
@@ -33,8 +36,33 @@ typedef struct _dentry dentry_t;
 #include "glusterfs/compat-uuid.h"
 #include "glusterfs/fd.h"
 
-struct _inode_table {
+/* Lock of a group of hash buckets. It's enough to look up the inode and
+ * dentry hashes, but changing them also requires the table lock. The stripes
+ * and the shards are allocated with GF_CALLOC(), without any alignment, so
+ * each one ends with a whole cache line of padding to keep the next one off
+ * its cache lines. */
+struct _inode_stripe {
+    pthread_mutex_t lock;
+    char _pad[CAA_CACHE_LINE_SIZE]; /* manual padding */
+};
+
+/* Every inode belongs to one shard for its whole life. The shard lock
+ * protects the lists below and the transitions of inode->ref from and to 0.
+ * Other changes of inode->ref are done atomically without any lock. */
+struct _inode_shard {
     pthread_mutex_t lock;
+    struct list_head active;     /* inodes currently active (in an fop) */
+    struct list_head lru;        /* inodes recently used, lru.next oldest */
+    struct list_head invalidate; /* inodes in invalidation queue */
+    uint32_t active_size;        /* count of inodes in active list */
+    uint32_t lru_size;           /* count of inodes in lru list */
+    uint32_t invalidate_size;    /* count of inodes in invalidate list */
+
+    char _pad[CAA_CACHE_LINE_SIZE]; /* manual padding */
+};
+
+struct _inode_table {
+    pthread_mutex_t lock;   /* protects dentries, hashes and purge list */
     size_t dentry_hashsize; /* Number of buckets for dentry hash*/
     size_t inode_hashsize;  /* Size of inode hash table */
     char *name;             /* name of the inode table, just for gf_log() */
@@ -43,13 +71,14 @@ struct _inode_table {
     uint32_t lru_limit;     /* maximum LRU cache size */
     struct list_head *inode_hash; /* buckets for inode hash table */
     struct list_head *name_hash;  /* buckets for dentry hash table */
-    struct list_head active; /* list of inodes currently active (in an fop) */
-    uint32_t active_size;    /* count of inodes in active list */
-    struct list_head lru;    /* list of inodes recently used.
-                                lru.next most recent */
-    uint32_t lru_size;       /* count of inodes in lru list  */
-    struct list_head purge;  /* list of inodes to be purged soon */
-    uint32_t purge_size;     /* count of inodes in purge list */
+    struct _inode_stripe *stripes; /* locks of the hash buckets */
+    struct _inode_shard *shards;   /* active, lru and invalidate lists */
+    uint32_t shard_count;          /* number of stripes and shards */
+    uint32_t shard_next;           /* shard of the next new inode */
+    uint32_t prune_next;           /* next shard to take lru inodes from */
+    uint32_t lru_size;             /* count of inodes in all lru lists */
+    struct list_head purge; /* list of inodes to be purged soon */
+    uint32_t purge_size;    /* count of inodes in purge list */
 
     struct mem_pool *inode_pool;  /* memory pool for inodes */
     struct mem_pool *dentry_pool; /* memory pool for dentrys */
@@ -60,8 +89,6 @@ struct _inode_table {
        specially in case of fuse-bridge */
     int32_t (*invalidator_fn)(xlator_t *, inode_t *);
     xlator_t *invalidator_xl;
-    struct list_head invalidate; /* inodes which are in invalidation queue */
-    uint32_t invalidate_size;    /* count of inodes in invalidation list */
 
     /* flag to indicate whether the cleanup of the inode
        table started or not */
@@ -99,6 +126,7 @@ struct _inode_ctx {
 
 struct _inode {
     inode_table_t *table; /* the table this inode belongs to */
+    struct _inode_shard *shard; /* the shard this inode belongs to */
     uuid_t gfid;
     gf_lock_t lock;
     gf_atomic_t nlookup;
@@ -109,7 +137,7 @@ struct _inode {
     struct list_head fd_list;     /* list of open files on this inode */
     struct list_head dentry_list; /* list of directory entries for this inode */
     struct list_head hash;        /* hash table pointers */
-    struct list_head list;        /* active/lru/purge */
+    struct list_head list;        /* active/lru/invalidate/purge */
 
     struct _inode_ctx *_ctx; /* replacement for dict_t *(inode->ctx) */
     bool in_invalidate_list; /* Set if inode is in table invalidate list */
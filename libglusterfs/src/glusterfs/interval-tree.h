@@ -0,0 +1,90 @@
+/*
+  Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+  This file is part of GlusterFS.
+
+  This file is licensed to you under your choice of the GNU Lesser
+  General Public License, version 3 or any later version (LGPLv3 or
+  later), or the GNU General Public License, version 2 (GPLv2), in all
+  cases as published by the Free Software Foundation.
+*/
+
+#ifndef __INTERVAL_TREE_H__
+#define __INTERVAL_TREE_H__
+
+#include <stddef.h>
+#include <inttypes.h>
+
+/* Red-black tree of closed intervals [start, last], sorted by start, where
+ * each node also keeps the highest @last of its subtree. Finding the nodes
+ * overlapping a range takes O(log n + k) for k results.
+ *
+ * Nodes are embedded in the objects being indexed, so the tree doesn't
+ * allocate anything, and it doesn't lock either: callers serialize the
+ * accesses to a tree. */
+
+typedef struct _gf_interval_node {
+    struct _gf_interval_node *parent;
+    struct _gf_interval_node *left;
+    struct _gf_interval_node *right;
+    uint64_t start;
+    uint64_t last;
+    uint64_t subtree_last;
+    int red;
+} gf_interval_node_t;
+
+typedef struct _gf_interval_tree {
+    gf_interval_node_t *root;
+    uint64_t count;
+} gf_interval_tree_t;
+
+#define gf_interval_tree_entry(ptr, type, member)                              \
+    ((type *)((char *)(ptr) - offsetof(type, member)))
+
+static inline void
+gf_interval_tree_init(gf_interval_tree_t *tree)
+{
+    tree->root = NULL;
+    tree->count = 0;
+}
+
+static inline int
+gf_interval_tree_empty(gf_interval_tree_t *tree)
+{
+    return tree->root == NULL;
+}
+
+/* Nodes not in a tree are their own parent, so that they can be removed or
+ * checked without keeping track of it somewhere else. */
+static inline void
+gf_interval_node_init(gf_interval_node_t *node)
+{
+    node->parent = node;
+}
+
+static inline int
+gf_interval_node_linked(gf_interval_node_t *node)
+{
+    return node->parent != node;
+}
+
+void
+gf_interval_tree_insert(gf_interval_tree_t *tree, gf_interval_node_t *node,
+                        uint64_t start, uint64_t last);
+
+void
+gf_interval_tree_remove(gf_interval_tree_t *tree, gf_interval_node_t *node);
+
+/* Returns the node with the lowest start overlapping [start, last], or NULL.
+ * The following ones are returned by gf_interval_tree_next(). */
+gf_interval_node_t *
+gf_interval_tree_first(gf_interval_tree_t *tree, uint64_t start,
+                       uint64_t last);
+
+gf_interval_node_t *
+gf_interval_tree_next(gf_interval_node_t *node, uint64_t start, uint64_t last);
+
+#define gf_interval_tree_for_each(pos, tree, start, last)                      \
+    for (pos = gf_interval_tree_first(tree, start, last); pos;                 \
+         pos = gf_interval_tree_next(pos, start, last))
+
+#endif /* __INTERVAL_TREE_H__ */
@@ -99,6 +99,13 @@ struct iobuf_arena {
     int active_cnt;
     int passive_cnt;
     int max_active; /* max active buffers at a given time */
+    int fixed;      /* index of the buffer registered for fixed I/O
+                       through gf_io, -1 if not registered */
+
+    /* set only on arenas created by iobuf_wrap(), which don't own their
+       memory and are released through this callback */
+    void (*release)(void *data);
+    void *release_data;
 };
 
 struct iobuf_pool {
@@ -121,6 +128,7 @@ struct iobuf_pool {
     uint64_t request_misses; /* mostly the requests for higher
                                value of iobufs */
     int arena_cnt;
+    int fixed_cnt; /* arenas registered for fixed I/O */
 };
 
 struct iobuf_pool *
@@ -177,6 +185,19 @@ struct iobuf *
 iobuf_get_page_aligned(struct iobuf_pool *iobuf_pool, size_t page_size,
                        size_t align_size);
 
+int
+iobuf_pool_register(struct iobuf_pool *iobuf_pool);
+
+int
+iobuf_fixed_index(struct iobuf *iobuf, void *ptr, size_t size);
+
+int
+iobref_fixed_index(struct iobref *iobref, void *ptr, size_t size);
+
+struct iobuf *
+iobuf_wrap(struct iobuf_pool *iobuf_pool, void *ptr, size_t size,
+           void (*release)(void *data), void *data);
+
 int
 iobuf_copy(struct iobuf_pool *iobuf_pool, const struct iovec *iovec_src,
            int iovcnt, struct iobref **iobref, struct iobuf **iobuf,
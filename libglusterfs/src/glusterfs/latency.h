@@ -14,20 +14,61 @@
 #include <inttypes.h>
 #include <time.h>
 
+/* Log-linear histogram of latencies. Latencies are counted in units of
+ * 2^GF_LATENCY_HIST_SHIFT nanoseconds (about a microsecond). Each power of
+ * two is split in 2^GF_LATENCY_HIST_SUB_BITS buckets, so the error of any
+ * reported value is below 1/2^(GF_LATENCY_HIST_SUB_BITS + 1) (6.25%). The
+ * last bucket collects everything above about a minute. */
+#define GF_LATENCY_HIST_SHIFT 10
+#define GF_LATENCY_HIST_SUB_BITS 3
+#define GF_LATENCY_HIST_MAX_BITS 26
+#define GF_LATENCY_HIST_BUCKETS                                                \
+    ((GF_LATENCY_HIST_MAX_BITS - GF_LATENCY_HIST_SUB_BITS + 1)                 \
+     << GF_LATENCY_HIST_SUB_BITS)
+
+/* Each thread updates always the same copy of the buckets, so that threads
+ * don't fight for the same cache lines. Copies are merged when read. */
+#define GF_LATENCY_HIST_SHARDS 4
+
+/* Percentiles reported by gf_latency_hist_percentiles(). */
+#define GF_LATENCY_PERCENTILES 4
+
+typedef struct _gf_latency_hist {
+    struct {
+        uint64_t buckets[GF_LATENCY_HIST_BUCKETS];
+    } shards[GF_LATENCY_HIST_SHARDS];
+} gf_latency_hist_t;
+
 typedef struct _gf_latency {
-    uint64_t min;   /* min time for the call (nanoseconds) */
-    uint64_t max;   /* max time for the call (nanoseconds) */
-    uint64_t total; /* total time (nanoseconds) */
+    uint64_t min;            /* min time for the call (nanoseconds) */
+    uint64_t max;            /* max time for the call (nanoseconds) */
+    uint64_t total;          /* total time (nanoseconds) */
     uint64_t count;
+    gf_latency_hist_t *hist; /* allocated on first update */
 } gf_latency_t;
 
+extern const char *gf_latency_percentile_names[GF_LATENCY_PERCENTILES];
+
 gf_latency_t *
 gf_latency_new(size_t n);
 
+void
+gf_latency_free(gf_latency_t *lat, size_t n);
+
 void
 gf_latency_reset(gf_latency_t *lat);
 
 void
 gf_latency_update(gf_latency_t *lat, struct timespec *begin,
                   struct timespec *end);
+
+void
+gf_latency_hist_update(gf_latency_hist_t **hist, uint64_t elapsed);
+
+void
+gf_latency_hist_reset(gf_latency_hist_t *hist);
+
+uint64_t
+gf_latency_hist_percentiles(gf_latency_hist_t *hist,
+                            uint64_t values[GF_LATENCY_PERCENTILES]);
 #endif /* __LATENCY_H__ */
@@ -24,6 +24,7 @@ struct call_pool;
 typedef struct call_pool call_pool_t;
 
 #include <sys/time.h>
+#include <urcu/arch.h> // CAA_CACHE_LINE_SIZE
 
 #include "glusterfs/xlator.h"
 #include "glusterfs/dict.h"
@@ -48,17 +49,26 @@ typedef int32_t (*ret_fn_t)(call_frame_t *frame, call_frame_t *prev_frame,
 void
 gf_frame_latency_update(call_frame_t *frame);
 
-struct call_pool {
-    union {
-        struct list_head all_frames;
-        struct {
-            call_stack_t *next_call;
-            call_stack_t *prev_call;
-        } all_stacks;
-    };
+/* Stacks in flight are kept in several lists. Each thread always adds the
+ * stacks it creates to the same list, so that creating and destroying stacks
+ * from different threads doesn't serialize on a single lock. The lists are
+ * only walked by statedump and other debugging helpers.
+ *
+ * The pool is allocated with GF_CALLOC(), which doesn't align it to a cache
+ * line, so each list is padded with a whole one instead: two of them never
+ * share a cache line, wherever the pool starts. */
+#define GF_CALL_POOL_SHARDS 64
+
+struct call_pool_shard {
+    gf_lock_t lock;
+    struct list_head all_frames;
     int64_t cnt;
+    char _pad[CAA_CACHE_LINE_SIZE]; /* manual padding */
+};
+
+struct call_pool {
+    struct call_pool_shard shards[GF_CALL_POOL_SHARDS];
     gf_atomic_t total_count;
-    gf_lock_t lock;
     struct mem_pool *frame_mem_pool;
     struct mem_pool *stack_mem_pool;
 };
@@ -101,6 +111,7 @@ struct _call_stack {
         };
     };
     call_pool_t *pool;
+    struct call_pool_shard *shard; /* list of the pool holding the stack */
     gf_lock_t stack_lock;
     client_t *client;
     uint64_t unique;
@@ -152,6 +163,12 @@ struct _call_stack {
 
 struct xlator_fops;
 
+void
+call_pool_link(call_pool_t *pool, call_stack_t *stack);
+
+void
+call_pool_unlink(call_stack_t *stack);
+
 static inline void
 FRAME_DESTROY(call_frame_t *frame)
 {
@@ -179,12 +196,7 @@ STACK_DESTROY(call_stack_t *stack)
     call_frame_t *frame = NULL;
     call_frame_t *tmp = NULL;
 
-    LOCK(&stack->pool->lock);
-    {
-        list_del_init(&stack->all_frames);
-        stack->pool->cnt--;
-    }
-    UNLOCK(&stack->pool->lock);
+    call_pool_unlink(stack);
 
     LOCK_DESTROY(&stack->stack_lock);
 
@@ -208,18 +220,19 @@ STACK_RESET(call_stack_t *stack)
 
     INIT_LIST_HEAD(&toreset);
 
-    /* We acquire call_pool->lock only to remove the frames from this stack
-     * to preserve atomicity. This synchronizes across concurrent requests
-     * like statedump, STACK_DESTROY etc. */
+    /* We acquire the lock of the call_pool list holding the stack only to
+     * remove the frames from this stack to preserve atomicity. This
+     * synchronizes across concurrent requests like statedump, STACK_DESTROY
+     * etc. */
 
-    LOCK(&stack->pool->lock);
+    LOCK(&stack->shard->lock);
     {
         last = list_last_entry(&stack->myframes, call_frame_t, frames);
         list_del_init(&last->frames);
         list_splice_init(&stack->myframes, &toreset);
         list_add(&last->frames, &stack->myframes);
     }
-    UNLOCK(&stack->pool->lock);
+    UNLOCK(&stack->shard->lock);
 
     list_for_each_entry_safe(frame, tmp, &toreset, frames)
     {
@@ -524,12 +537,7 @@ copy_frame(call_frame_t *frame)
     LOCK_INIT(&newframe->lock);
     LOCK_INIT(&newstack->stack_lock);
 
-    LOCK(&oldstack->pool->lock);
-    {
-        list_add(&newstack->all_frames, &oldstack->all_frames);
-        newstack->pool->cnt++;
-    }
-    UNLOCK(&oldstack->pool->lock);
+    call_pool_link(newstack->pool, newstack);
     GF_ATOMIC_INC(newstack->pool->total_count);
 
     return newframe;
@@ -538,6 +546,12 @@ copy_frame(call_frame_t *frame)
 void
 call_stack_set_groups(call_stack_t *stack, int ngrps, gid_t **groupbuf_p);
 void
+call_pool_init(call_pool_t *pool);
+void
+call_pool_fini(call_pool_t *pool);
+int64_t
+call_pool_count(call_pool_t *pool);
+void
 gf_proc_dump_pending_frames(call_pool_t *call_pool);
 void
 gf_proc_dump_pending_frames_to_dict(call_pool_t *call_pool, dict_t *dict);
@@ -23,6 +23,24 @@ syncop_mt_dir_scan(call_frame_t *frame, xlator_t *subvol, loc_t *loc, int pid,
                    void *data, syncop_dir_scan_fn_t fn, dict_t *xdata,
                    uint32_t max_jobs, uint32_t max_qlen);
 
+/* Counters of a syncop_mt_dir_scan_readers(), the times being in ns and summed
+ * over the readers, or over the jobs processing the entries. */
+typedef struct syncop_dir_scan_stats {
+    uint64_t read_count;
+    uint64_t read_time;
+    uint64_t processed_count;
+    uint64_t process_time;
+} syncop_dir_scan_stats_t;
+
+/* Same as syncop_mt_dir_scan(), with @readers threads reading the directory at
+ * the same time, each one with its own fd and @xdata[i]. The xdata are meant
+ * to make each reader get a different part of the directory. */
+int
+syncop_mt_dir_scan_readers(call_frame_t *frame, xlator_t *subvol, loc_t *loc,
+                           int pid, void *data, syncop_dir_scan_fn_t fn,
+                           dict_t **xdata, uint32_t readers, uint32_t max_jobs,
+                           uint32_t max_qlen, syncop_dir_scan_stats_t *stats);
+
 int
 syncop_dir_scan(xlator_t *subvol, loc_t *loc, int pid, void *data,
                 int (*fn)(xlator_t *subvol, gf_dirent_t *entry, loc_t *parent,
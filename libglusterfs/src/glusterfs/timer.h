@@ -15,9 +15,28 @@
 #include "glusterfs/xlator.h"
 #include <sys/time.h>
 #include <pthread.h>
+#include <urcu/arch.h> // CAA_CACHE_LINE_SIZE
 
 typedef void (*gf_timer_cbk_t)(void *);
 
+/* Timers are kept in hierarchical timing wheels with a resolution of one
+ * millisecond. The first level has 2^GF_TIMER_WHEEL_BITS0 slots, one per
+ * tick, and each of the upper levels has 2^GF_TIMER_WHEEL_BITSN slots, each
+ * one covering a whole turn of the level below. Timers in an upper level are
+ * cascaded down when the lower level wraps, so arming and cancelling a timer
+ * are O(1) operations. */
+#define GF_TIMER_WHEEL_BITS0 8
+#define GF_TIMER_WHEEL_BITSN 6
+#define GF_TIMER_WHEEL_SIZE0 (1 << GF_TIMER_WHEEL_BITS0)
+#define GF_TIMER_WHEEL_SIZEN (1 << GF_TIMER_WHEEL_BITSN)
+#define GF_TIMER_WHEEL_LEVELS 4 /* upper levels */
+
+/* Number of independent wheels. Each thread arms its timers always in the
+ * same wheel, which spreads the contention on the wheel locks. */
+#define GF_TIMER_WHEELS 16
+
+struct _gf_timer_wheel;
+
 struct _gf_timer {
     union {
         struct list_head list;
@@ -30,11 +49,28 @@ struct _gf_timer {
     gf_timer_cbk_t callbk;
     void *data;
     xlator_t *xl;
+    struct _gf_timer_wheel *wheel;
+    uint64_t expires; /* tick at which the timer fires */
     gf_boolean_t fired;
 };
 
+/* The registry comes from GF_CALLOC(), which doesn't align it to a cache
+ * line, so the lock of a wheel is kept off the slots of the previous one by a
+ * whole cache line of padding. */
+struct _gf_timer_wheel {
+    pthread_mutex_t lock;
+    uint64_t clk;   /* next tick to process */
+    uint32_t count; /* number of armed timers */
+    struct list_head slots0[GF_TIMER_WHEEL_SIZE0];
+    struct list_head slotsn[GF_TIMER_WHEEL_LEVELS][GF_TIMER_WHEEL_SIZEN];
+    char _pad[CAA_CACHE_LINE_SIZE]; /* manual padding */
+};
+
 struct _gf_timer_registry {
-    struct list_head active;
+    struct _gf_timer_wheel wheels[GF_TIMER_WHEELS];
+    struct mem_pool *pool; /* gf_timer_t objects */
+    struct timespec base;  /* time of tick 0 */
+    uint64_t wakeup;       /* tick the timer thread is sleeping until */
     pthread_mutex_t lock;
     pthread_cond_t cond;
     pthread_t th;
@@ -16,6 +16,7 @@
 #include <stdint.h>
 #include "glusterfs/list.h"
 #include <assert.h>
+#include <urcu/uatomic.h>
 #include "glusterfs/libglusterfs-messages.h"
 
 /* TODO:
@@ -116,9 +117,8 @@ Based on this, the code could be similar to this:
 */
 // clang-format on
 
-#define INODE_DUMP_LIST(head, key_buf, key_prefix, list_type)                  \
+#define INODE_DUMP_LIST(head, key_buf, key_prefix, list_type, i)               \
     {                                                                          \
-        int i = 1;                                                             \
         inode_t *inode = NULL;                                                 \
         list_for_each_entry(inode, head, list)                                 \
         {                                                                      \
@@ -161,15 +161,29 @@ hash_gfid(uuid_t uuid, int mod)
     return ((uuid[15] + (uuid[14] << 8)) % mod);
 }
 
+static struct _inode_stripe *
+inode_table_stripe(inode_table_t *table, const int hash)
+{
+    return &table->stripes[hash % table->shard_count];
+}
+
+/* The hash chains can be looked up with either the table lock or the lock of
+ * their stripe held. Changing them requires both. */
+
 static void
 __dentry_hash(dentry_t *dentry, const int hash)
 {
     inode_table_t *table = NULL;
+    struct _inode_stripe *stripe = NULL;
 
     table = dentry->inode->table;
+    stripe = inode_table_stripe(table, hash);
 
-    list_del_init(&dentry->hash);
-    list_add(&dentry->hash, &table->name_hash[hash]);
+    pthread_mutex_lock(&stripe->lock);
+    {
+        list_add(&dentry->hash, &table->name_hash[hash]);
+    }
+    pthread_mutex_unlock(&stripe->lock);
 }
 
 static int
@@ -181,7 +195,22 @@ __is_dentry_hashed(dentry_t *dentry)
 static void
 __dentry_unhash(dentry_t *dentry)
 {
-    list_del_init(&dentry->hash);
+    inode_table_t *table = NULL;
+    struct _inode_stripe *stripe = NULL;
+
+    if (!__is_dentry_hashed(dentry))
+        return;
+
+    table = dentry->inode->table;
+    stripe = inode_table_stripe(
+        table,
+        hash_dentry(dentry->parent, dentry->name, table->dentry_hashsize));
+
+    pthread_mutex_lock(&stripe->lock);
+    {
+        list_del_init(&dentry->hash);
+    }
+    pthread_mutex_unlock(&stripe->lock);
 }
 
 static void
@@ -282,25 +311,42 @@ __is_dentry_cyclic(dentry_t *dentry)
     return ret;
 }
 
-static void
-__inode_unhash(inode_t *inode)
-{
-    list_del_init(&inode->hash);
-}
-
 static int
 __is_inode_hashed(inode_t *inode)
 {
     return !list_empty(&inode->hash);
 }
 
+static void
+__inode_unhash(inode_t *inode)
+{
+    inode_table_t *table = inode->table;
+    struct _inode_stripe *stripe = NULL;
+
+    if (!__is_inode_hashed(inode))
+        return;
+
+    stripe = inode_table_stripe(table,
+                                hash_gfid(inode->gfid, table->inode_hashsize));
+
+    pthread_mutex_lock(&stripe->lock);
+    {
+        list_del_init(&inode->hash);
+    }
+    pthread_mutex_unlock(&stripe->lock);
+}
+
 static void
 __inode_hash(inode_t *inode, const int hash)
 {
     inode_table_t *table = inode->table;
+    struct _inode_stripe *stripe = inode_table_stripe(table, hash);
 
-    list_del_init(&inode->hash);
-    list_add(&inode->hash, &table->inode_hash[hash]);
+    pthread_mutex_lock(&stripe->lock);
+    {
+        list_add(&inode->hash, &table->inode_hash[hash]);
+    }
+    pthread_mutex_unlock(&stripe->lock);
 }
 
 static dentry_t *
@@ -403,39 +449,47 @@ inode_ctx_merge(fd_t *fd, inode_t *inode, inode_t *linked_inode)
     }
 }
 
+/* The functions below, up to inode_ref(), must be called with the lock of
+ * the shard of the inode held, unless stated otherwise. */
+
 static void
 __inode_activate(inode_t *inode)
 {
-    list_move(&inode->list, &inode->table->active);
-    inode->table->active_size++;
+    list_move(&inode->list, &inode->shard->active);
+    inode->shard->active_size++;
 }
 
 static void
 __inode_passivate(inode_t *inode)
 {
-    dentry_t *dentry = NULL;
-    dentry_t *t = NULL;
-
     GF_ASSERT(!inode->in_lru_list);
-    list_move_tail(&inode->list, &inode->table->lru);
-    inode->table->lru_size++;
+    list_move_tail(&inode->list, &inode->shard->lru);
+    inode->shard->lru_size++;
+    uatomic_inc(&inode->table->lru_size);
     inode->in_lru_list = _gf_true;
 
-    list_for_each_entry_safe(dentry, t, &inode->dentry_list, inode_list)
-    {
-        if (!__is_dentry_hashed(dentry))
-            dentry_destroy(__dentry_unset(dentry));
-    }
+    /* Dentries that are not hashed used to be released here, but that needs
+     * the table lock. There can't be any: __dentry_unset() is the only place
+     * where a dentry is unhashed, and it also takes the dentry out of the
+     * inode. __inode_link() adds a dentry to an inode before hashing it, but
+     * both happen before it releases the table lock. */
 }
 
+/* The table lock must also be held. The inode needs to be completed with
+ * __inode_detach() once the shard lock is released. */
 static void
 __inode_retire(inode_t *inode)
 {
-    dentry_t *dentry = NULL;
-    dentry_t *t = NULL;
-
     list_move_tail(&inode->list, &inode->table->purge);
     inode->table->purge_size++;
+}
+
+/* Called with the table lock held, but not the shard lock. */
+static void
+__inode_detach(inode_t *inode)
+{
+    dentry_t *dentry = NULL;
+    dentry_t *t = NULL;
 
     __inode_unhash(inode);
 
@@ -445,35 +499,85 @@ __inode_retire(inode_t *inode)
     }
 }
 
+/* The slot is claimed atomically, as references are accounted without the
+ * inode lock. */
 static int
 __inode_get_xl_index(inode_t *inode, xlator_t *xlator)
 {
-    int set_idx = -1;
+    xlator_t *key = NULL;
 
-    if ((inode->_ctx[xlator->xl_id].xl_key != NULL) &&
-        (inode->_ctx[xlator->xl_id].xl_key != xlator))
-        goto out;
-
-    set_idx = xlator->xl_id;
-    inode->_ctx[set_idx].xl_key = xlator;
+    key = uatomic_cmpxchg(&inode->_ctx[xlator->xl_id].xl_key, NULL, xlator);
+    if ((key != NULL) && (key != xlator))
+        return -1;
 
-out:
-    return set_idx;
+    return xlator->xl_id;
 }
 
-static inode_t *
-__inode_unref(inode_t *inode, bool clear)
+/* Doesn't need any lock. */
+static void
+inode_ref_account(inode_t *inode, int delta)
 {
     int index = 0;
-    xlator_t *this = NULL;
-    uint64_t nlookup = 0;
 
-    /*
-     * Root inode should always be in active list of inode table. So unrefs
-     * on root inode are no-ops.
-     */
-    if (__is_root_gfid(inode->gfid))
-        return inode;
+    index = __inode_get_xl_index(inode, THIS);
+    if (index >= 0)
+        uatomic_add(&inode->_ctx[index].ref, delta);
+}
+
+/* Takes a reference without any lock if the inode is already active. */
+static gf_boolean_t
+inode_ref_fast(inode_t *inode)
+{
+    uint32_t ref = 0;
+    uint32_t old = 0;
+
+    ref = uatomic_read(&inode->ref);
+    while (ref > 0) {
+        old = uatomic_cmpxchg(&inode->ref, ref, ref + 1);
+        if (old == ref) {
+            inode_ref_account(inode, 1);
+            return _gf_true;
+        }
+        ref = old;
+    }
+
+    return _gf_false;
+}
+
+/* Drops a reference without any lock if it's not the last one. */
+static gf_boolean_t
+inode_unref_fast(inode_t *inode)
+{
+    uint32_t ref = 0;
+    uint32_t old = 0;
+
+    ref = uatomic_read(&inode->ref);
+    while (ref > 1) {
+        old = uatomic_cmpxchg(&inode->ref, ref, ref - 1);
+        if (old == ref) {
+            inode_ref_account(inode, -1);
+            return _gf_true;
+        }
+        ref = old;
+    }
+
+    return _gf_false;
+}
+
+enum inode_unref_result {
+    INODE_UNREF_DONE,    /* The inode is still in one of the shard lists */
+    INODE_UNREF_RETIRED, /* The inode needs to be detached */
+    INODE_UNREF_RETRY,   /* The inode needs to be retired */
+};
+
+/* Drops a reference. If it was the last one and the inode has no lookups,
+ * it's retired when 'retire' is set, which requires the table lock. Without
+ * it, the reference is kept and the caller has to try again with the table
+ * lock held. */
+static enum inode_unref_result
+__inode_unref_locked(inode_t *inode, bool clear, bool retire)
+{
+    uint64_t nlookup = 0;
 
     /*
      * No need to acquire inode table's lock
@@ -508,48 +612,85 @@ __inode_unref(inode_t *inode, bool clear)
          * So return the inode if the inode table cleanup
          * has already started and inode refcount is 0.
          */
-        return inode;
-
-    this = THIS;
+        return INODE_UNREF_DONE;
 
     if (clear && inode->in_invalidate_list) {
         inode->in_invalidate_list = false;
-        inode->table->invalidate_size--;
+        inode->shard->invalidate_size--;
         __inode_activate(inode);
     }
     GF_ASSERT(inode->ref);
 
-    --inode->ref;
+    /* Other references may come and go in the meantime. */
+    if (inode_unref_fast(inode))
+        return INODE_UNREF_DONE;
+    if (uatomic_cmpxchg(&inode->ref, 1, 0) != 1)
+        return __inode_unref_locked(inode, false, retire);
 
-    index = __inode_get_xl_index(inode, this);
-    if (index >= 0) {
-        inode->_ctx[index].xl_key = this;
-        inode->_ctx[index].ref--;
-    }
+    if (!inode->in_invalidate_list) {
+        /* A forget could have dropped the last lookup after the caller
+         * checked it, but not after the reference has been dropped, since
+         * it needs its own one. */
+        nlookup = GF_ATOMIC_GET(inode->nlookup);
+        if (!nlookup && !retire) {
+            /* Nobody can take a reference while it's 0 and the shard lock
+             * is held, so it can just be restored. */
+            uatomic_set(&inode->ref, 1);
+            return INODE_UNREF_RETRY;
+        }
 
-    if (!inode->ref && !inode->in_invalidate_list) {
-        inode->table->active_size--;
+        inode_ref_account(inode, -1);
+        inode->shard->active_size--;
 
-        nlookup = GF_ATOMIC_GET(inode->nlookup);
-        if (nlookup)
+        if (nlookup) {
             __inode_passivate(inode);
-        else
+        } else {
             __inode_retire(inode);
+            return INODE_UNREF_RETIRED;
+        }
+    } else {
+        inode_ref_account(inode, -1);
+    }
+
+    return INODE_UNREF_DONE;
+}
+
+/* Called with the table lock held, but not the shard lock. */
+static inode_t *
+__inode_unref(inode_t *inode, bool clear)
+{
+    struct _inode_shard *shard = inode->shard;
+    enum inode_unref_result res = INODE_UNREF_DONE;
+
+    /*
+     * Root inode should always be in active list of inode table. So unrefs
+     * on root inode are no-ops.
+     */
+    if (__is_root_gfid(inode->gfid))
+        return inode;
+
+    pthread_mutex_lock(&shard->lock);
+    {
+        res = __inode_unref_locked(inode, clear, true);
     }
+    pthread_mutex_unlock(&shard->lock);
+
+    if (res == INODE_UNREF_RETIRED)
+        __inode_detach(inode);
 
     return inode;
 }
 
+/* Returns NULL if the inode has already been retired. */
 static inode_t *
 __inode_ref(inode_t *inode, bool is_invalidate)
 {
-    int index = 0;
-    xlator_t *this = NULL;
+    struct _inode_shard *shard = NULL;
 
     if (!inode)
         return NULL;
 
-    this = THIS;
+    shard = inode->shard;
 
     /*
      * Root inode should always be in active list of inode table. So unrefs
@@ -565,29 +706,51 @@ __inode_ref(inode_t *inode, bool is_invalidate)
     if (!inode->ref) {
         if (inode->in_invalidate_list) {
             inode->in_invalidate_list = false;
-            inode->table->invalidate_size--;
-        } else {
-            GF_ASSERT(inode->table->lru_size > 0);
-            GF_ASSERT(inode->in_lru_list);
-            inode->table->lru_size--;
+            shard->invalidate_size--;
+        } else if (inode->in_lru_list) {
+            GF_ASSERT(shard->lru_size > 0);
+            shard->lru_size--;
+            uatomic_dec(&inode->table->lru_size);
             inode->in_lru_list = _gf_false;
+        } else {
+            /* On its way to the purge list. */
+            return NULL;
         }
         if (is_invalidate) {
             inode->in_invalidate_list = true;
-            inode->table->invalidate_size++;
-            list_move_tail(&inode->list, &inode->table->invalidate);
+            shard->invalidate_size++;
+            list_move_tail(&inode->list, &shard->invalidate);
         } else {
             __inode_activate(inode);
         }
     }
 
-    inode->ref++;
+    uatomic_inc(&inode->ref);
+    inode_ref_account(inode, 1);
 
-    index = __inode_get_xl_index(inode, this);
-    if (index >= 0) {
-        inode->_ctx[index].xl_key = this;
-        inode->_ctx[index].ref++;
+    return inode;
+}
+
+/* Doesn't need any lock, but the caller must guarantee that the inode is not
+ * purged meanwhile, either holding a reference, a lookup, the table lock or
+ * the lock of a hash chain where the inode has been found. Returns NULL if
+ * the inode has already been retired. */
+static inode_t *
+inode_ref_common(inode_t *inode)
+{
+    struct _inode_shard *shard = inode->shard;
+
+    if ((inode == inode->table->root) && uatomic_read(&inode->ref))
+        return inode;
+
+    if (inode_ref_fast(inode))
+        return inode;
+
+    pthread_mutex_lock(&shard->lock);
+    {
+        inode = __inode_ref(inode, false);
     }
+    pthread_mutex_unlock(&shard->lock);
 
     return inode;
 }
@@ -596,23 +759,66 @@ inode_t *
 inode_unref(inode_t *inode)
 {
     inode_table_t *table = NULL;
+    struct _inode_shard *shard = NULL;
+    enum inode_unref_result res = INODE_UNREF_RETRY;
 
     if (!inode)
         return NULL;
 
     table = inode->table;
+    shard = inode->shard;
 
-    pthread_mutex_lock(&table->lock);
-    {
-        inode = __inode_unref(inode, false);
+    if (inode == table->root)
+        return inode;
+
+    if (inode_unref_fast(inode))
+        return inode;
+
+    /* The last reference only needs the table lock to retire the inode. */
+    if (GF_ATOMIC_GET(inode->nlookup)) {
+        pthread_mutex_lock(&shard->lock);
+        {
+            res = __inode_unref_locked(inode, false, false);
+        }
+        pthread_mutex_unlock(&shard->lock);
+    }
+
+    if (res == INODE_UNREF_RETRY) {
+        pthread_mutex_lock(&table->lock);
+        {
+            inode = __inode_unref(inode, false);
+        }
+        pthread_mutex_unlock(&table->lock);
     }
-    pthread_mutex_unlock(&table->lock);
 
     inode_table_prune(table);
 
     return inode;
 }
 
+/* Called with the table lock held, on an inode which has been retired but not
+ * purged yet. It has already been detached, so only a caller that didn't own
+ * any reference or lookup keeping it alive can get there. It's brought back
+ * as an unlinked inode, like a new one, instead of failing the reference. */
+static void
+__inode_revive(inode_t *inode)
+{
+    struct _inode_shard *shard = inode->shard;
+
+    gf_msg_callingfn(THIS->name, GF_LOG_DEBUG, 0, LG_MSG_REF_COUNT,
+                     "reference taken on a retired inode (gfid: %s)",
+                     uuid_utoa(inode->gfid));
+
+    pthread_mutex_lock(&shard->lock);
+    {
+        inode->table->purge_size--;
+        __inode_activate(inode);
+        uatomic_inc(&inode->ref);
+        inode_ref_account(inode, 1);
+    }
+    pthread_mutex_unlock(&shard->lock);
+}
+
 inode_t *
 inode_ref(inode_t *inode)
 {
@@ -623,9 +829,20 @@ inode_ref(inode_t *inode)
 
     table = inode->table;
 
+    if ((inode == table->root) && uatomic_read(&inode->ref))
+        return inode;
+
+    if (inode_ref_fast(inode))
+        return inode;
+
+    /* Taking the first reference is serialized with the retirement of the
+     * inode, like any other change of the lists of the table. Inodes are
+     * retired and detached under the same table lock, so an inode that can
+     * still be reached from a dentry or a hash chain is never retired. */
     pthread_mutex_lock(&table->lock);
     {
-        inode = __inode_ref(inode, false);
+        if (!inode_ref_common(inode))
+            __inode_revive(inode);
     }
     pthread_mutex_unlock(&table->lock);
 
@@ -669,6 +886,8 @@ inode_create(inode_table_t *table)
     }
 
     newi->table = table;
+    newi->shard = &table->shards[uatomic_add_return(&table->shard_next, 1) %
+                                 table->shard_count];
 
     LOCK_INIT(&newi->lock);
 
@@ -705,15 +924,13 @@ inode_new(inode_table_t *table)
 
     inode = inode_create(table);
     if (inode) {
-        pthread_mutex_lock(&table->lock);
+        pthread_mutex_lock(&inode->shard->lock);
         {
-            list_add(&inode->list, &table->lru);
-            table->lru_size++;
-            GF_ASSERT(!inode->in_lru_list);
-            inode->in_lru_list = _gf_true;
-            __inode_ref(inode, false);
+            __inode_activate(inode);
+            inode->ref = 1;
+            inode_ref_account(inode, 1);
         }
-        pthread_mutex_unlock(&table->lock);
+        pthread_mutex_unlock(&inode->shard->lock);
     }
 
     return inode;
@@ -727,28 +944,38 @@ inode_new(inode_table_t *table)
  *
  * This function may cause the purging of the inode,
  * hence to be used only in destructor functions and not otherwise.
+ * Called with the table lock held, but not the shard lock.
  */
 static inode_t *
 __inode_ref_reduce_by_n(inode_t *inode, uint64_t nref)
 {
+    struct _inode_shard *shard = inode->shard;
     uint64_t nlookup = 0;
+    gf_boolean_t retired = _gf_false;
 
-    GF_ASSERT(inode->ref >= nref);
-
-    inode->ref -= nref;
+    pthread_mutex_lock(&shard->lock);
+    {
+        GF_ASSERT(inode->ref >= nref);
 
-    if (!nref)
-        inode->ref = 0;
+        if (!nref)
+            nref = inode->ref;
 
-    if (!inode->ref) {
-        inode->table->active_size--;
+        if (nref && (uatomic_sub_return(&inode->ref, nref) == 0)) {
+            shard->active_size--;
 
-        nlookup = GF_ATOMIC_GET(inode->nlookup);
-        if (nlookup)
-            __inode_passivate(inode);
-        else
-            __inode_retire(inode);
+            nlookup = GF_ATOMIC_GET(inode->nlookup);
+            if (nlookup) {
+                __inode_passivate(inode);
+            } else {
+                __inode_retire(inode);
+                retired = _gf_true;
+            }
+        }
     }
+    pthread_mutex_unlock(&shard->lock);
+
+    if (retired)
+        __inode_detach(inode);
 
     return inode;
 }
@@ -803,17 +1030,15 @@ inode_grep(inode_table_t *table, inode_t *parent, const char *name)
     }
 
     int hash = hash_dentry(parent, name, table->dentry_hashsize);
+    struct _inode_stripe *stripe = inode_table_stripe(table, hash);
 
-    pthread_mutex_lock(&table->lock);
+    pthread_mutex_lock(&stripe->lock);
     {
         dentry = __dentry_grep(table, parent, name, hash);
-        if (dentry) {
-            inode = dentry->inode;
-            if (inode)
-                __inode_ref(inode, false);
-        }
+        if (dentry && dentry->inode)
+            inode = inode_ref_common(dentry->inode);
     }
-    pthread_mutex_unlock(&table->lock);
+    pthread_mutex_unlock(&stripe->lock);
 
     return inode;
 }
@@ -879,8 +1104,9 @@ inode_grep_for_gfid(inode_table_t *table, inode_t *parent, const char *name,
     }
 
     int hash = hash_dentry(parent, name, table->dentry_hashsize);
+    struct _inode_stripe *stripe = inode_table_stripe(table, hash);
 
-    pthread_mutex_lock(&table->lock);
+    pthread_mutex_lock(&stripe->lock);
     {
         dentry = __dentry_grep(table, parent, name, hash);
         if (dentry) {
@@ -892,7 +1118,7 @@ inode_grep_for_gfid(inode_table_t *table, inode_t *parent, const char *name,
             }
         }
     }
-    pthread_mutex_unlock(&table->lock);
+    pthread_mutex_unlock(&stripe->lock);
 
     return ret;
 }
@@ -943,14 +1169,15 @@ inode_find(inode_table_t *table, uuid_t gfid)
     }
 
     int hash = hash_gfid(gfid, table->inode_hashsize);
+    struct _inode_stripe *stripe = inode_table_stripe(table, hash);
 
-    pthread_mutex_lock(&table->lock);
+    pthread_mutex_lock(&stripe->lock);
     {
         inode = __inode_find(table, gfid, hash);
         if (inode)
-            __inode_ref(inode, false);
+            inode = inode_ref_common(inode);
     }
-    pthread_mutex_unlock(&table->lock);
+    pthread_mutex_unlock(&stripe->lock);
 
     return inode;
 }
@@ -1050,7 +1277,7 @@ __inode_link(inode_t *inode, inode_t *parent, const char *name,
             }
 
             /* dentry linking needs to happen inside lock */
-            dentry->parent = __inode_ref(parent, false);
+            dentry->parent = inode_ref_common(parent);
             list_add(&dentry->inode_list, &link_inode->dentry_list);
 
             if (old_inode && __is_dentry_cyclic(dentry)) {
@@ -1096,7 +1323,7 @@ inode_link(inode_t *inode, inode_t *parent, const char *name, struct iatt *iatt)
     {
         linked_inode = __inode_link(inode, parent, name, iatt, hash);
         if (linked_inode)
-            __inode_ref(linked_inode, false);
+            inode_ref_common(linked_inode);
     }
     pthread_mutex_unlock(&table->lock);
 
@@ -1379,7 +1606,7 @@ inode_parent(inode_t *inode, uuid_t pargfid, const char *name)
             parent = dentry->parent;
 
         if (parent)
-            __inode_ref(parent, false);
+            parent = inode_ref_common(parent);
     }
     pthread_mutex_unlock(&table->lock);
 
@@ -1560,12 +1787,21 @@ inode_table_prune(inode_table_t *table)
     inode_t *del = NULL;
     inode_t *tmp = NULL;
     inode_t *entry = NULL;
+    struct _inode_shard *shard = NULL;
     uint64_t nlookup = 0;
     int64_t lru_size = 0;
+    uint32_t idle = 0;
 
     if (!table)
         return -1;
 
+    /* Most of the calls have nothing to do. Don't take the table lock for
+     * them. */
+    lru_size = uatomic_read(&table->lru_size);
+    if ((!table->lru_limit || (lru_size <= table->lru_limit)) &&
+        !uatomic_read(&table->purge_size))
+        return 0;
+
     INIT_LIST_HEAD(&purge);
 
     pthread_mutex_lock(&table->lock);
@@ -1573,41 +1809,52 @@ inode_table_prune(inode_table_t *table)
         if (!table->lru_limit)
             goto purge_list;
 
-        lru_size = table->lru_size;
-        while (lru_size > (table->lru_limit)) {
-            if (list_empty(&table->lru)) {
-                GF_ASSERT(0);
-                gf_msg_callingfn(THIS->name, GF_LOG_WARNING, 0,
-                                 LG_MSG_INVALID_INODE_LIST,
-                                 "Empty inode lru list found"
-                                 " but with (%d) lru_size",
-                                 table->lru_size);
-                break;
-            }
-
-            lru_size--;
-            entry = list_entry(table->lru.next, inode_t, list);
-            GF_ASSERT(entry->in_lru_list);
-            /* The logic of invalidation is required only if invalidator_fn
-               is present */
-            if (table->invalidator_fn) {
-                /* check for valid inode with 'nlookup' */
-                nlookup = GF_ATOMIC_GET(entry->nlookup);
-                if (nlookup) {
-                    if (entry->invalidate_sent) {
-                        list_move_tail(&entry->list, &table->lru);
-                        continue;
+        /* The oldest inodes are taken from each shard in turn, which keeps
+         * the lru lists of all the shards about the same length. */
+        lru_size = uatomic_read(&table->lru_size);
+        while ((lru_size > (table->lru_limit)) &&
+               (idle < table->shard_count)) {
+            shard = &table->shards[table->prune_next++ % table->shard_count];
+
+            pthread_mutex_lock(&shard->lock);
+            {
+                entry = NULL;
+                if (list_empty(&shard->lru)) {
+                    idle++;
+                } else {
+                    idle = 0;
+                    lru_size--;
+                    entry = list_first_entry(&shard->lru, inode_t, list);
+                    GF_ASSERT(entry->in_lru_list);
+                    /* The logic of invalidation is required only if
+                       invalidator_fn is present */
+                    nlookup = 0;
+                    if (table->invalidator_fn) {
+                        /* check for valid inode with 'nlookup' */
+                        nlookup = GF_ATOMIC_GET(entry->nlookup);
+                    }
+                    if (!nlookup) {
+                        shard->lru_size--;
+                        uatomic_dec(&table->lru_size);
+                        entry->in_lru_list = _gf_false;
+                        __inode_retire(entry);
+                    } else {
+                        if (entry->invalidate_sent)
+                            list_move_tail(&entry->list, &shard->lru);
+                        else
+                            tmp = __inode_ref(entry, true);
+                        entry = NULL;
                     }
-                    __inode_ref(entry, true);
-                    tmp = entry;
-                    break;
                 }
             }
+            pthread_mutex_unlock(&shard->lock);
 
-            table->lru_size--;
-            entry->in_lru_list = _gf_false;
-            __inode_retire(entry);
-            ret++;
+            if (entry) {
+                __inode_detach(entry);
+                ret++;
+            }
+            if (tmp)
+                break;
         }
 
     purge_list:
@@ -1659,7 +1906,8 @@ __inode_table_init_root(inode_table_t *table)
 
     root = inode_create(table);
 
-    list_add(&root->list, &table->lru);
+    list_add(&root->list, &root->shard->lru);
+    root->shard->lru_size++;
     table->lru_size++;
     root->in_lru_list = _gf_true;
 
@@ -1744,10 +1992,27 @@ inode_table_with_invalidator(uint32_t lru_limit, xlator_t *xl,
         INIT_LIST_HEAD(&new->name_hash[i]);
     }
 
-    INIT_LIST_HEAD(&new->active);
-    INIT_LIST_HEAD(&new->lru);
+    new->shard_count = min(INODE_TABLE_SHARDS, new->inode_hashsize);
+
+    new->stripes = GF_CALLOC(new->shard_count, sizeof(struct _inode_stripe),
+                             gf_common_mt_inode_shard_t);
+    if (!new->stripes)
+        goto out;
+
+    new->shards = GF_CALLOC(new->shard_count, sizeof(struct _inode_shard),
+                            gf_common_mt_inode_shard_t);
+    if (!new->shards)
+        goto out;
+
+    for (i = 0; i < new->shard_count; i++) {
+        pthread_mutex_init(&new->stripes[i].lock, NULL);
+        pthread_mutex_init(&new->shards[i].lock, NULL);
+        INIT_LIST_HEAD(&new->shards[i].active);
+        INIT_LIST_HEAD(&new->shards[i].lru);
+        INIT_LIST_HEAD(&new->shards[i].invalidate);
+    }
+
     INIT_LIST_HEAD(&new->purge);
-    INIT_LIST_HEAD(&new->invalidate);
 
     ret = gf_asprintf(&new->name, "%s/inode", xl->name);
     if (-1 == ret) {
@@ -1767,6 +2032,8 @@ out:
         if (new) {
             GF_FREE(new->inode_hash);
             GF_FREE(new->name_hash);
+            GF_FREE(new->stripes);
+            GF_FREE(new->shards);
             if (new->dentry_pool)
                 mem_pool_destroy(new->dentry_pool);
             if (new->inode_pool)
@@ -1788,17 +2055,45 @@ inode_table_new(uint32_t lru_limit, xlator_t *xl, uint32_t dentry_hashsize,
                                         dentry_hashsize, inode_hashsize);
 }
 
+/* Sums the sizes of the lists of all the shards. */
+static void
+inode_table_shard_sizes(inode_table_t *table, uint32_t *active_size,
+                        uint32_t *lru_size, uint32_t *invalidate_size)
+{
+    struct _inode_shard *shard = NULL;
+    uint32_t i = 0;
+
+    *active_size = *lru_size = *invalidate_size = 0;
+
+    for (i = 0; i < table->shard_count; i++) {
+        shard = &table->shards[i];
+
+        pthread_mutex_lock(&shard->lock);
+        {
+            *active_size += shard->active_size;
+            *lru_size += shard->lru_size;
+            *invalidate_size += shard->invalidate_size;
+        }
+        pthread_mutex_unlock(&shard->lock);
+    }
+}
+
 int
 inode_table_ctx_free(inode_table_t *table)
 {
     int ret = 0;
     inode_t *del = NULL;
     inode_t *tmp = NULL;
+    struct _inode_shard *shard = NULL;
     int purge_count = 0;
     int lru_count = 0;
     int active_count = 0;
     xlator_t *this = NULL;
     int itable_size = 0;
+    uint32_t active_size = 0;
+    uint32_t lru_size = 0;
+    uint32_t invalidate_size = 0;
+    uint32_t i = 0;
 
     if (!table)
         return -1;
@@ -1815,40 +2110,49 @@ inode_table_ctx_free(inode_table_t *table)
             }
         }
 
-        list_for_each_entry_safe(del, tmp, &table->lru, list)
-        {
-            if (del->_ctx) {
-                __inode_ctx_free(del);
-                lru_count++;
-            }
-        }
+        for (i = 0; i < table->shard_count; i++) {
+            shard = &table->shards[i];
 
-        /* should the contexts of active inodes be freed?
-         * Since before this function being called fds would have
-         * been migrated and would have held the ref on the new
-         * inode from the new inode table, the older inode would not
-         * be used.
-         */
-        list_for_each_entry_safe(del, tmp, &table->active, list)
-        {
-            if (del->_ctx) {
-                __inode_ctx_free(del);
-                active_count++;
+            pthread_mutex_lock(&shard->lock);
+            {
+                list_for_each_entry_safe(del, tmp, &shard->lru, list)
+                {
+                    if (del->_ctx) {
+                        __inode_ctx_free(del);
+                        lru_count++;
+                    }
+                }
+
+                /* should the contexts of active inodes be freed?
+                 * Since before this function being called fds would have
+                 * been migrated and would have held the ref on the new
+                 * inode from the new inode table, the older inode would not
+                 * be used.
+                 */
+                list_for_each_entry_safe(del, tmp, &shard->active, list)
+                {
+                    if (del->_ctx) {
+                        __inode_ctx_free(del);
+                        active_count++;
+                    }
+                }
             }
+            pthread_mutex_unlock(&shard->lock);
         }
     }
     pthread_mutex_unlock(&table->lock);
 
+    inode_table_shard_sizes(table, &active_size, &lru_size, &invalidate_size);
+
     ret = purge_count + lru_count + active_count;
-    itable_size = table->active_size + table->lru_size + table->purge_size;
+    itable_size = active_size + lru_size + table->purge_size;
     gf_msg_callingfn(this->name, GF_LOG_INFO, 0, LG_MSG_INODE_CONTEXT_FREED,
                      "total %d (itable size: "
                      "%d) inode contexts have been freed (active: %d, ("
                      "active size: %d), lru: %d, (lru size: %d),  purge: "
                      "%d, (purge size: %d))",
-                     ret, itable_size, active_count, table->active_size,
-                     lru_count, table->lru_size, purge_count,
-                     table->purge_size);
+                     ret, itable_size, active_count, active_size, lru_count,
+                     lru_size, purge_count, table->purge_size);
     return ret;
 }
 
@@ -1877,10 +2181,51 @@ out:
     return;
 }
 
+/* Takes the next inode of a shard to release from inode_table_destroy(). The
+ * ones in the lru and invalidate lists are retired and still need to be
+ * detached. */
+static inode_t *
+inode_shard_destroy_next(struct _inode_shard *shard, gf_boolean_t *retired)
+{
+    inode_t *trav = NULL;
+
+    *retired = _gf_true;
+
+    pthread_mutex_lock(&shard->lock);
+    {
+        if (!list_empty(&shard->lru)) {
+            trav = list_first_entry(&shard->lru, inode_t, list);
+            inode_forget_atomic(trav, 0);
+            GF_ASSERT(shard->lru_size > 0);
+            GF_ASSERT(trav->in_lru_list);
+            __inode_retire(trav);
+            shard->lru_size--;
+            uatomic_dec(&trav->table->lru_size);
+            trav->in_lru_list = _gf_false;
+        } else if (!list_empty(&shard->invalidate)) {
+            /* Same logic for invalidate list */
+            trav = list_first_entry(&shard->invalidate, inode_t, list);
+            inode_forget_atomic(trav, 0);
+            __inode_retire(trav);
+            shard->invalidate_size--;
+        } else if (!list_empty(&shard->active)) {
+            trav = list_first_entry(&shard->active, inode_t, list);
+            *retired = _gf_false;
+        }
+    }
+    pthread_mutex_unlock(&shard->lock);
+
+    return trav;
+}
+
 void
 inode_table_destroy(inode_table_t *inode_table)
 {
     inode_t *trav = NULL;
+    struct _inode_shard *shard = NULL;
+    gf_boolean_t retired = _gf_false;
+    uint32_t count = 0;
+    uint32_t i = 0;
 
     if (inode_table == NULL)
         return;
@@ -1910,49 +2255,41 @@ inode_table_destroy(inode_table_t *inode_table)
     pthread_mutex_lock(&inode_table->lock);
     {
         inode_table->cleanup_started = _gf_true;
-        /* Process lru list first as we need to unset their dentry
+        /* Process lru lists first as we need to unset their dentry
          * entries (the ones which may not be unset during
          * '__inode_passivate' as they were hashed) which in turn
          * shall unref their parent
          *
          * These parent inodes when unref'ed may well again fall
-         * into lru list and if we are at the end of traversing
-         * the list, we may miss to delete/retire that entry. Hence
-         * traverse the lru list till it gets empty.
+         * into some lru list and if we are at the end of traversing
+         * the shards, we may miss to delete/retire that entry. Hence
+         * traverse all the shards till they get empty.
          */
-        while (!list_empty(&inode_table->lru)) {
-            trav = list_first_entry(&inode_table->lru, inode_t, list);
-            inode_forget_atomic(trav, 0);
-            GF_ASSERT(inode_table->lru_size > 0);
-            GF_ASSERT(trav->in_lru_list);
-            __inode_retire(trav);
-            inode_table->lru_size--;
-            trav->in_lru_list = _gf_false;
-        }
-
-        /* Same logic for invalidate list */
-        while (!list_empty(&inode_table->invalidate)) {
-            trav = list_first_entry(&inode_table->invalidate, inode_t, list);
-            inode_forget_atomic(trav, 0);
-            __inode_retire(trav);
-            inode_table->invalidate_size--;
-        }
-
-        while (!list_empty(&inode_table->active)) {
-            trav = list_first_entry(&inode_table->active, inode_t, list);
-            /* forget and unref the inode to retire and add it to
-             * purge list. By this time there should not be any
-             * inodes present in the active list except for root
-             * inode. Its a ref_leak otherwise. */
-            if (trav && (trav != inode_table->root))
-                gf_msg_callingfn(THIS->name, GF_LOG_WARNING, 0,
-                                 LG_MSG_REF_COUNT,
-                                 "Active inode(%p) with refcount"
-                                 "(%d) found during cleanup",
-                                 trav, trav->ref);
-            inode_forget_atomic(trav, 0);
-            __inode_ref_reduce_by_n(trav, 0);
-        }
+        do {
+            count = 0;
+            for (i = 0; i < inode_table->shard_count; i++) {
+                shard = &inode_table->shards[i];
+                while ((trav = inode_shard_destroy_next(shard, &retired))) {
+                    count++;
+                    if (retired) {
+                        __inode_detach(trav);
+                        continue;
+                    }
+                    /* forget and unref the inode to retire and add it to
+                     * purge list. By this time there should not be any
+                     * inodes present in the active list except for root
+                     * inode. Its a ref_leak otherwise. */
+                    if (trav != inode_table->root)
+                        gf_msg_callingfn(THIS->name, GF_LOG_WARNING, 0,
+                                         LG_MSG_REF_COUNT,
+                                         "Active inode(%p) with refcount"
+                                         "(%d) found during cleanup",
+                                         trav, trav->ref);
+                    inode_forget_atomic(trav, 0);
+                    __inode_ref_reduce_by_n(trav, 0);
+                }
+            }
+        } while (count);
     }
     pthread_mutex_unlock(&inode_table->lock);
 
@@ -1967,6 +2304,13 @@ inode_table_destroy(inode_table_t *inode_table)
     if (inode_table->fd_mem_pool)
         mem_pool_destroy(inode_table->fd_mem_pool);
 
+    for (i = 0; i < inode_table->shard_count; i++) {
+        pthread_mutex_destroy(&inode_table->stripes[i].lock);
+        pthread_mutex_destroy(&inode_table->shards[i].lock);
+    }
+    GF_FREE(inode_table->stripes);
+    GF_FREE(inode_table->shards);
+
     pthread_mutex_destroy(&inode_table->lock);
 
     GF_FREE(inode_table->name);
@@ -2497,6 +2841,15 @@ void
 inode_table_dump(inode_table_t *itable, char *prefix)
 {
     char key[GF_DUMP_MAX_BUF_LEN];
+    struct _inode_shard *shard = NULL;
+    uint32_t active_size = 0;
+    uint32_t lru_size = 0;
+    uint32_t invalidate_size = 0;
+    int active = 1;
+    int lru = 1;
+    int purge = 1;
+    int invalidate = 1;
+    uint32_t i = 0;
     int ret = 0;
 
     if (!itable)
@@ -2515,21 +2868,44 @@ inode_table_dump(inode_table_t *itable, char *prefix)
     gf_proc_dump_build_key(key, prefix, "name");
     gf_proc_dump_write(key, "%s", itable->name);
 
+    gf_proc_dump_build_key(key, prefix, "shard_count");
+    gf_proc_dump_write(key, "%u", itable->shard_count);
+
+    inode_table_shard_sizes(itable, &active_size, &lru_size,
+                            &invalidate_size);
+
     gf_proc_dump_build_key(key, prefix, "lru_limit");
     gf_proc_dump_write(key, "%d", itable->lru_limit);
     gf_proc_dump_build_key(key, prefix, "active_size");
-    gf_proc_dump_write(key, "%d", itable->active_size);
+    gf_proc_dump_write(key, "%d", active_size);
     gf_proc_dump_build_key(key, prefix, "lru_size");
-    gf_proc_dump_write(key, "%d", itable->lru_size);
+    gf_proc_dump_write(key, "%d", lru_size);
     gf_proc_dump_build_key(key, prefix, "purge_size");
     gf_proc_dump_write(key, "%d", itable->purge_size);
     gf_proc_dump_build_key(key, prefix, "invalidate_size");
-    gf_proc_dump_write(key, "%d", itable->invalidate_size);
+    gf_proc_dump_write(key, "%d", invalidate_size);
 
-    INODE_DUMP_LIST(&itable->active, key, prefix, "active");
-    INODE_DUMP_LIST(&itable->lru, key, prefix, "lru");
-    INODE_DUMP_LIST(&itable->purge, key, prefix, "purge");
-    INODE_DUMP_LIST(&itable->invalidate, key, prefix, "invalidate");
+    for (i = 0; i < itable->shard_count; i++) {
+        shard = &itable->shards[i];
+
+        pthread_mutex_lock(&shard->lock);
+        {
+            INODE_DUMP_LIST(&shard->active, key, prefix, "active", active);
+            INODE_DUMP_LIST(&shard->lru, key, prefix, "lru", lru);
+        }
+        pthread_mutex_unlock(&shard->lock);
+    }
+    INODE_DUMP_LIST(&itable->purge, key, prefix, "purge", purge);
+    for (i = 0; i < itable->shard_count; i++) {
+        shard = &itable->shards[i];
+
+        pthread_mutex_lock(&shard->lock);
+        {
+            INODE_DUMP_LIST(&shard->invalidate, key, prefix, "invalidate",
+                            invalidate);
+        }
+        pthread_mutex_unlock(&shard->lock);
+    }
 
     pthread_mutex_unlock(&itable->lock);
 }
@@ -2579,27 +2955,37 @@ inode_table_dump_to_dict(inode_table_t *itable, char *prefix, dict_t *dict)
     char key[GF_DUMP_MAX_BUF_LEN] = {
         0,
     };
+    uint32_t active_size = 0;
+    uint32_t lru_size = 0;
+    uint32_t invalidate_size = 0;
     int ret = 0;
 #ifdef DEBUG
+    struct _inode_shard *shard = NULL;
     inode_t *inode = NULL;
+    int active = 0;
+    int lru = 0;
     int count = 0;
+    uint32_t i = 0;
 #endif
     ret = pthread_mutex_trylock(&itable->lock);
     if (ret)
         return;
 
+    inode_table_shard_sizes(itable, &active_size, &lru_size,
+                            &invalidate_size);
+
     snprintf(key, sizeof(key), "%s.itable.lru_limit", prefix);
     ret = dict_set_uint32(dict, key, itable->lru_limit);
     if (ret)
         goto out;
 
     snprintf(key, sizeof(key), "%s.itable.active_size", prefix);
-    ret = dict_set_uint32(dict, key, itable->active_size);
+    ret = dict_set_uint32(dict, key, active_size);
     if (ret)
         goto out;
 
     snprintf(key, sizeof(key), "%s.itable.lru_size", prefix);
-    ret = dict_set_uint32(dict, key, itable->lru_size);
+    ret = dict_set_uint32(dict, key, lru_size);
     if (ret)
         goto out;
 
@@ -2615,19 +3001,26 @@ inode_table_dump_to_dict(inode_table_t *itable, char *prefix, dict_t *dict)
        If one wants to debug, let them take statedump and debug, this
        wouldn't be available in CLI during production setup.
     */
-    list_for_each_entry(inode, &itable->active, list)
-    {
-        snprintf(key, sizeof(key), "%s.itable.active%d", prefix, count++);
-        inode_dump_to_dict(inode, key, dict);
-    }
-    count = 0;
+    for (i = 0; i < itable->shard_count; i++) {
+        shard = &itable->shards[i];
 
-    list_for_each_entry(inode, &itable->lru, list)
-    {
-        snprintf(key, sizeof(key), "%s.itable.lru%d", prefix, count++);
-        inode_dump_to_dict(inode, key, dict);
+        pthread_mutex_lock(&shard->lock);
+        {
+            list_for_each_entry(inode, &shard->active, list)
+            {
+                snprintf(key, sizeof(key), "%s.itable.active%d", prefix,
+                         active++);
+                inode_dump_to_dict(inode, key, dict);
+            }
+
+            list_for_each_entry(inode, &shard->lru, list)
+            {
+                snprintf(key, sizeof(key), "%s.itable.lru%d", prefix, lru++);
+                inode_dump_to_dict(inode, key, dict);
+            }
+        }
+        pthread_mutex_unlock(&shard->lock);
     }
-    count = 0;
 
     list_for_each_entry(inode, &itable->purge, list)
     {
@@ -0,0 +1,345 @@
+/*
+  Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+  This file is part of GlusterFS.
+
+  This file is licensed to you under your choice of the GNU Lesser
+  General Public License, version 3 or any later version (LGPLv3 or
+  later), or the GNU General Public License, version 2 (GPLv2), in all
+  cases as published by the Free Software Foundation.
+*/
+
+#include "glusterfs/interval-tree.h"
+
+static inline int
+is_red(gf_interval_node_t *node)
+{
+    return (node != NULL) && node->red;
+}
+
+static inline uint64_t
+subtree_last(gf_interval_node_t *node)
+{
+    uint64_t last = node->last;
+
+    if (node->left && (node->left->subtree_last > last))
+        last = node->left->subtree_last;
+    if (node->right && (node->right->subtree_last > last))
+        last = node->right->subtree_last;
+
+    return last;
+}
+
+static void
+replace_child(gf_interval_tree_t *tree, gf_interval_node_t *parent,
+              gf_interval_node_t *old, gf_interval_node_t *new)
+{
+    if (parent == NULL)
+        tree->root = new;
+    else if (parent->left == old)
+        parent->left = new;
+    else
+        parent->right = new;
+}
+
+/* Rotations keep the set of nodes below the top of the rotated subtree, so
+ * only the two nodes which change place need their @subtree_last updated. */
+static void
+rotate_left(gf_interval_tree_t *tree, gf_interval_node_t *node)
+{
+    gf_interval_node_t *right = node->right;
+
+    node->right = right->left;
+    if (right->left)
+        right->left->parent = node;
+
+    right->parent = node->parent;
+    replace_child(tree, node->parent, node, right);
+
+    right->left = node;
+    node->parent = right;
+
+    right->subtree_last = node->subtree_last;
+    node->subtree_last = subtree_last(node);
+}
+
+static void
+rotate_right(gf_interval_tree_t *tree, gf_interval_node_t *node)
+{
+    gf_interval_node_t *left = node->left;
+
+    node->left = left->right;
+    if (left->right)
+        left->right->parent = node;
+
+    left->parent = node->parent;
+    replace_child(tree, node->parent, node, left);
+
+    left->right = node;
+    node->parent = left;
+
+    left->subtree_last = node->subtree_last;
+    node->subtree_last = subtree_last(node);
+}
+
+static void
+propagate(gf_interval_node_t *node)
+{
+    for (; node; node = node->parent)
+        node->subtree_last = subtree_last(node);
+}
+
+void
+gf_interval_tree_insert(gf_interval_tree_t *tree, gf_interval_node_t *node,
+                        uint64_t start, uint64_t last)
+{
+    gf_interval_node_t **link = &tree->root;
+    gf_interval_node_t *parent = NULL;
+    gf_interval_node_t *uncle = NULL;
+    gf_interval_node_t *grand = NULL;
+
+    node->start = start;
+    node->last = last;
+    node->subtree_last = last;
+    node->left = NULL;
+    node->right = NULL;
+    node->red = 1;
+
+    while (*link) {
+        parent = *link;
+        if (parent->subtree_last < last)
+            parent->subtree_last = last;
+        if (start < parent->start)
+            link = &parent->left;
+        else
+            link = &parent->right;
+    }
+
+    node->parent = parent;
+    *link = node;
+    tree->count++;
+
+    while (is_red(node->parent)) {
+        parent = node->parent;
+        grand = parent->parent;
+
+        if (parent == grand->left) {
+            uncle = grand->right;
+            if (is_red(uncle)) {
+                parent->red = 0;
+                uncle->red = 0;
+                grand->red = 1;
+                node = grand;
+                continue;
+            }
+            if (node == parent->right) {
+                rotate_left(tree, parent);
+                node = parent;
+                parent = node->parent;
+            }
+            parent->red = 0;
+            grand->red = 1;
+            rotate_right(tree, grand);
+        } else {
+            uncle = grand->left;
+            if (is_red(uncle)) {
+                parent->red = 0;
+                uncle->red = 0;
+                grand->red = 1;
+                node = grand;
+                continue;
+            }
+            if (node == parent->left) {
+                rotate_right(tree, parent);
+                node = parent;
+                parent = node->parent;
+            }
+            parent->red = 0;
+            grand->red = 1;
+            rotate_left(tree, grand);
+        }
+    }
+
+    tree->root->red = 0;
+}
+
+static void
+remove_fixup(gf_interval_tree_t *tree, gf_interval_node_t *node,
+             gf_interval_node_t *parent)
+{
+    gf_interval_node_t *sibling = NULL;
+
+    while ((node != tree->root) && !is_red(node)) {
+        if (node == parent->left) {
+            sibling = parent->right;
+            if (is_red(sibling)) {
+                sibling->red = 0;
+                parent->red = 1;
+                rotate_left(tree, parent);
+                sibling = parent->right;
+            }
+            if (!is_red(sibling->left) && !is_red(sibling->right)) {
+                sibling->red = 1;
+                node = parent;
+                parent = node->parent;
+                continue;
+            }
+            if (!is_red(sibling->right)) {
+                sibling->left->red = 0;
+                sibling->red = 1;
+                rotate_right(tree, sibling);
+                sibling = parent->right;
+            }
+            sibling->red = parent->red;
+            parent->red = 0;
+            sibling->right->red = 0;
+            rotate_left(tree, parent);
+        } else {
+            sibling = parent->left;
+            if (is_red(sibling)) {
+                sibling->red = 0;
+                parent->red = 1;
+                rotate_right(tree, parent);
+                sibling = parent->left;
+            }
+            if (!is_red(sibling->left) && !is_red(sibling->right)) {
+                sibling->red = 1;
+                node = parent;
+                parent = node->parent;
+                continue;
+            }
+            if (!is_red(sibling->left)) {
+                sibling->right->red = 0;
+                sibling->red = 1;
+                rotate_left(tree, sibling);
+                sibling = parent->left;
+            }
+            sibling->red = parent->red;
+            parent->red = 0;
+            sibling->left->red = 0;
+            rotate_right(tree, parent);
+        }
+        node = tree->root;
+    }
+
+    if (node)
+        node->red = 0;
+}
+
+void
+gf_interval_tree_remove(gf_interval_tree_t *tree, gf_interval_node_t *node)
+{
+    gf_interval_node_t *next = NULL;
+    gf_interval_node_t *child = NULL;
+    gf_interval_node_t *parent = NULL;
+    int red = node->red;
+
+    if (node->left == NULL) {
+        child = node->right;
+        parent = node->parent;
+        replace_child(tree, parent, node, child);
+        if (child)
+            child->parent = parent;
+    } else if (node->right == NULL) {
+        child = node->left;
+        parent = node->parent;
+        replace_child(tree, parent, node, child);
+        child->parent = parent;
+    } else {
+        /* Put the successor, which has no left child, in place of the
+         * node. */
+        next = node->right;
+        while (next->left)
+            next = next->left;
+
+        red = next->red;
+        child = next->right;
+
+        if (next->parent == node) {
+            parent = next;
+        } else {
+            parent = next->parent;
+            parent->left = child;
+            if (child)
+                child->parent = parent;
+            next->right = node->right;
+            next->right->parent = next;
+        }
+
+        replace_child(tree, node->parent, node, next);
+        next->parent = node->parent;
+        next->left = node->left;
+        next->left->parent = next;
+        next->red = node->red;
+    }
+
+    /* Everything above the place where a node went away may have lost its
+     * @subtree_last, @next included. */
+    propagate(parent);
+
+    if (!red)
+        remove_fixup(tree, child, parent);
+
+    tree->count--;
+    gf_interval_node_init(node);
+}
+
+static gf_interval_node_t *
+subtree_first(gf_interval_node_t *node, uint64_t start, uint64_t last)
+{
+    while (1) {
+        if (node->left && (node->left->subtree_last >= start)) {
+            /* Anything overlapping on the left comes first. */
+            node = node->left;
+            continue;
+        }
+
+        if (node->start > last)
+            return NULL;
+
+        if (node->last >= start)
+            return node;
+
+        if (node->right && (node->right->subtree_last >= start)) {
+            node = node->right;
+            continue;
+        }
+
+        return NULL;
+    }
+}
+
+gf_interval_node_t *
+gf_interval_tree_first(gf_interval_tree_t *tree, uint64_t start,
+                       uint64_t last)
+{
+    if ((tree->root == NULL) || (tree->root->subtree_last < start))
+        return NULL;
+
+    return subtree_first(tree->root, start, last);
+}
+
+gf_interval_node_t *
+gf_interval_tree_next(gf_interval_node_t *node, uint64_t start, uint64_t last)
+{
+    gf_interval_node_t *prev = NULL;
+
+    while (1) {
+        if (node->right && (node->right->subtree_last >= start))
+            return subtree_first(node->right, start, last);
+
+        /* Go up until coming from a left child: that's the next node in
+         * order. */
+        do {
+            prev = node;
+            node = node->parent;
+            if (node == NULL)
+                return NULL;
+        } while (prev == node->right);
+
+        if (node->start > last)
+            return NULL;
+
+        if (node->last >= start)
+            return node;
+    }
+}
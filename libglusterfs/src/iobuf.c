@@ -10,6 +10,7 @@
 
 #include "glusterfs/iobuf.h"
 #include "glusterfs/statedump.h"
+#include "glusterfs/gf-io.h"
 #include <stdio.h>
 #include "glusterfs/libglusterfs-messages.h"
 
@@ -153,6 +154,7 @@ __iobuf_arena_alloc(struct iobuf_pool *iobuf_pool, size_t page_size,
     INIT_LIST_HEAD(&iobuf_arena->passive_list);
     INIT_LIST_HEAD(&iobuf_arena->active_list);
     iobuf_arena->iobuf_pool = iobuf_pool;
+    iobuf_arena->fixed = -1;
 
     rounded_size = gf_iobuf_get_pagesize(page_size, &index);
 
@@ -300,6 +302,7 @@ iobuf_create_stdalloc_arena(struct iobuf_pool *iobuf_pool)
     INIT_LIST_HEAD(&iobuf_arena->active_list);
 
     iobuf_arena->iobuf_pool = iobuf_pool;
+    iobuf_arena->fixed = -1;
 
     iobuf_arena->page_size = 0x7fffffff;
 
@@ -364,6 +367,10 @@ __iobuf_arena_prune(struct iobuf_pool *iobuf_pool,
     if (list_empty(&iobuf_pool->arenas[index]))
         goto out;
 
+    /* memory registered for fixed I/O must stay mapped */
+    if (iobuf_arena->fixed >= 0)
+        goto out;
+
     /* All cases matched, destroy */
     list_del_init(&iobuf_arena->list);
     list_del_init(&iobuf_arena->all_list);
@@ -557,6 +564,178 @@ post_unlock:
     return iobuf;
 }
 
+/* Register one arena of each page size with the I/O framework so that
+ * requests using its iobufs can be sent as fixed reads and writes. Arenas
+ * created later to satisfy a peak of allocations are not registered, and
+ * iobufs taken from them will use regular requests. */
+int
+iobuf_pool_register(struct iobuf_pool *iobuf_pool)
+{
+    struct iovec iov[IOBUF_ARENA_MAX_INDEX];
+    struct iobuf_arena *arenas[IOBUF_ARENA_MAX_INDEX];
+    struct iobuf_arena *trav = NULL;
+    int count = 0;
+    int i = 0;
+    int ret = 0;
+
+    GF_VALIDATE_OR_GOTO("iobuf", iobuf_pool, out);
+
+    pthread_mutex_lock(&iobuf_pool->mutex);
+    {
+        if (iobuf_pool->fixed_cnt > 0)
+            goto unlock;
+
+        for (i = 0; i < IOBUF_ARENA_MAX_INDEX; i++) {
+            trav = NULL;
+            if (!list_empty(&iobuf_pool->arenas[i]))
+                trav = list_first_entry(&iobuf_pool->arenas[i],
+                                        struct iobuf_arena, list);
+            else if (!list_empty(&iobuf_pool->filled[i]))
+                trav = list_first_entry(&iobuf_pool->filled[i],
+                                        struct iobuf_arena, list);
+            if (!trav)
+                continue;
+
+            iov[count].iov_base = trav->mem_base;
+            iov[count].iov_len = trav->arena_size;
+            arenas[count] = trav;
+            count++;
+        }
+
+        if (count == 0)
+            goto unlock;
+
+        ret = gf_io_register_buffers(iov, count);
+        if (ret < 0)
+            goto unlock;
+
+        for (i = 0; i < count; i++)
+            arenas[i]->fixed = i;
+        iobuf_pool->fixed_cnt = count;
+    }
+unlock:
+    pthread_mutex_unlock(&iobuf_pool->mutex);
+
+out:
+    return ret;
+}
+
+/* Returns the index of the registered buffer that contains the region
+ * [ptr, ptr + size) of the iobuf, or -1 if there's none. */
+int
+iobuf_fixed_index(struct iobuf *iobuf, void *ptr, size_t size)
+{
+    struct iobuf_arena *iobuf_arena = NULL;
+
+    GF_VALIDATE_OR_GOTO("iobuf", iobuf, out);
+
+    iobuf_arena = iobuf->iobuf_arena;
+    if (!iobuf_arena || (iobuf_arena->fixed < 0))
+        goto out;
+
+    if ((ptr < iobuf_arena->mem_base) ||
+        (ptr + size > iobuf_arena->mem_base + iobuf_arena->arena_size))
+        goto out;
+
+    return iobuf_arena->fixed;
+
+out:
+    return -1;
+}
+
+int
+iobref_fixed_index(struct iobref *iobref, void *ptr, size_t size)
+{
+    int ret = -1;
+    int i = 0;
+
+    GF_VALIDATE_OR_GOTO("iobuf", iobref, out);
+
+    LOCK(&iobref->lock);
+    {
+        for (i = 0; i < iobref->allocated; i++) {
+            if (!iobref->iobrefs[i])
+                break;
+
+            ret = iobuf_fixed_index(iobref->iobrefs[i], ptr, size);
+            if (ret >= 0)
+                break;
+        }
+    }
+    UNLOCK(&iobref->lock);
+
+out:
+    return ret;
+}
+
+/* An iobuf wrapping memory owned by someone else. It gets its own arena so
+ * that code using iobuf_pagesize() or iobuf_fixed_index() keeps working, but
+ * none of them is ever linked into the pool. */
+struct iobuf_wrap {
+    struct iobuf iobuf;
+    struct iobuf_arena arena;
+};
+
+/* Returns a referenced iobuf pointing to the caller's memory region
+ * [ptr, ptr + size) without copying it. @release is called with @data once
+ * the last reference to the iobuf is dropped, which may happen from any
+ * thread and long after the request using it has completed. Until then, the
+ * memory must not be modified nor released. */
+struct iobuf *
+iobuf_wrap(struct iobuf_pool *iobuf_pool, void *ptr, size_t size,
+           void (*release)(void *data), void *data)
+{
+    struct iobuf_wrap *wrap = NULL;
+
+    GF_VALIDATE_OR_GOTO("iobuf", iobuf_pool, out);
+    GF_VALIDATE_OR_GOTO("iobuf", ptr, out);
+    GF_VALIDATE_OR_GOTO("iobuf", release, out);
+
+    wrap = GF_CALLOC(1, sizeof(*wrap), gf_common_mt_iobuf);
+    if (!wrap)
+        goto out;
+
+    INIT_LIST_HEAD(&wrap->arena.list);
+    INIT_LIST_HEAD(&wrap->arena.all_list);
+    INIT_LIST_HEAD(&wrap->arena.passive_list);
+    INIT_LIST_HEAD(&wrap->arena.active_list);
+    wrap->arena.page_size = size;
+    wrap->arena.arena_size = size;
+    wrap->arena.page_count = 1;
+    wrap->arena.iobuf_pool = iobuf_pool;
+    wrap->arena.mem_base = ptr;
+    wrap->arena.iobufs = &wrap->iobuf;
+    wrap->arena.active_cnt = 1;
+    wrap->arena.max_active = 1;
+    wrap->arena.alloc_cnt = 1;
+    wrap->arena.fixed = -1;
+    wrap->arena.release = release;
+    wrap->arena.release_data = data;
+
+    INIT_LIST_HEAD(&wrap->iobuf.list);
+    LOCK_INIT(&wrap->iobuf.lock);
+    GF_ATOMIC_INIT(wrap->iobuf.ref, 0);
+    wrap->iobuf.iobuf_arena = &wrap->arena;
+    wrap->iobuf.ptr = ptr;
+
+    return iobuf_ref(&wrap->iobuf);
+
+out:
+    return NULL;
+}
+
+static void
+iobuf_unwrap(struct iobuf *iobuf)
+{
+    struct iobuf_wrap *wrap = NULL;
+
+    wrap = list_entry(iobuf, struct iobuf_wrap, iobuf);
+
+    LOCK_DESTROY(&iobuf->lock);
+    wrap->arena.release(wrap->arena.release_data);
+    GF_FREE(wrap);
+}
+
 struct iobuf *
 iobuf_get_page_aligned(struct iobuf_pool *iobuf_pool, size_t page_size,
                        size_t align_size)
@@ -684,6 +863,11 @@ iobuf_put(struct iobuf *iobuf)
         return;
     }
 
+    if (iobuf_arena->release) {
+        iobuf_unwrap(iobuf);
+        return;
+    }
+
     iobuf_pool = iobuf_arena->iobuf_pool;
     if (!iobuf_pool) {
         gf_smsg(THIS->name, GF_LOG_WARNING, 0, LG_MSG_POOL_NOT_FOUND, "iobuf",
@@ -1007,6 +1191,10 @@ iobuf_arena_info_dump(struct iobuf_arena *iobuf_arena, const char *key_prefix)
     gf_proc_dump_write(key, "%d", iobuf_arena->max_active);
     gf_proc_dump_build_key(key, key_prefix, "page_size");
     gf_proc_dump_write(key, "%" GF_PRI_SIZET, iobuf_arena->page_size);
+    if (iobuf_arena->fixed >= 0) {
+        gf_proc_dump_build_key(key, key_prefix, "fixed");
+        gf_proc_dump_write(key, "%d", iobuf_arena->fixed);
+    }
     list_for_each_entry(trav, &iobuf_arena->active_list, list)
     {
         gf_proc_dump_build_key(key, key_prefix, "active_iobuf.%d", i++);
@@ -1041,6 +1229,7 @@ iobuf_stats_dump(struct iobuf_pool *iobuf_pool)
     gf_proc_dump_write("iobuf_pool.arena_size", "%" GF_PRI_SIZET,
                        iobuf_pool->arena_size);
     gf_proc_dump_write("iobuf_pool.arena_cnt", "%d", iobuf_pool->arena_cnt);
+    gf_proc_dump_write("iobuf_pool.fixed_cnt", "%d", iobuf_pool->fixed_cnt);
     gf_proc_dump_write("iobuf_pool.request_misses", "%" PRId64,
                        iobuf_pool->request_misses);
 
@@ -16,13 +16,26 @@
 #include "glusterfs/glusterfs.h"
 #include "glusterfs/statedump.h"
 
+#include <urcu/uatomic.h>
+
+const char *gf_latency_percentile_names[GF_LATENCY_PERCENTILES] = {
+    "p50", "p90", "p99", "p999"};
+
+/* Percentiles in tenths of percent. */
+static const uint32_t gf_latency_percentile_ranks[GF_LATENCY_PERCENTILES] = {
+    500, 900, 990, 999};
+
+/* Copy of the histogram buckets updated by the current thread. */
+static __thread int32_t gf_latency_hist_shard = -1;
+static uint32_t gf_latency_hist_shard_next;
+
 gf_latency_t *
 gf_latency_new(size_t n)
 {
     int i = 0;
     gf_latency_t *lat = NULL;
 
-    lat = GF_MALLOC(n * sizeof(*lat), gf_common_mt_latency_t);
+    lat = GF_CALLOC(n, sizeof(*lat), gf_common_mt_latency_t);
     if (!lat)
         return NULL;
 
@@ -32,6 +45,147 @@ gf_latency_new(size_t n)
     return lat;
 }
 
+void
+gf_latency_free(gf_latency_t *lat, size_t n)
+{
+    int i = 0;
+
+    if (!lat)
+        return;
+
+    for (i = 0; i < n; i++) {
+        GF_FREE(lat[i].hist);
+    }
+    GF_FREE(lat);
+}
+
+static uint32_t
+gf_latency_hist_bucket(uint64_t elapsed)
+{
+    uint64_t value = elapsed >> GF_LATENCY_HIST_SHIFT;
+    uint32_t msb;
+
+    if (value < (1 << GF_LATENCY_HIST_SUB_BITS))
+        return value;
+
+    msb = 63 - __builtin_clzll(value);
+    if (msb >= GF_LATENCY_HIST_MAX_BITS)
+        return GF_LATENCY_HIST_BUCKETS - 1;
+
+    return ((msb - GF_LATENCY_HIST_SUB_BITS + 1) << GF_LATENCY_HIST_SUB_BITS) +
+           ((value >> (msb - GF_LATENCY_HIST_SUB_BITS)) &
+            ((1 << GF_LATENCY_HIST_SUB_BITS) - 1));
+}
+
+/* Returns the middle of a bucket in nanoseconds. */
+static uint64_t
+gf_latency_hist_value(uint32_t bucket)
+{
+    uint64_t base, width;
+    uint32_t exp;
+
+    exp = bucket >> GF_LATENCY_HIST_SUB_BITS;
+    if (exp == 0) {
+        base = bucket;
+        width = 1;
+    } else {
+        width = 1ULL << (exp - 1);
+        base = ((1ULL << GF_LATENCY_HIST_SUB_BITS) +
+                (bucket & ((1 << GF_LATENCY_HIST_SUB_BITS) - 1))) *
+               width;
+    }
+
+    return ((2 * base + width) << GF_LATENCY_HIST_SHIFT) / 2;
+}
+
+/* Doesn't take any lock. The histogram is allocated the first time it's
+ * needed. */
+void
+gf_latency_hist_update(gf_latency_hist_t **hist, uint64_t elapsed)
+{
+    gf_latency_hist_t *new = NULL;
+    gf_latency_hist_t *old = NULL;
+
+    new = uatomic_read(hist);
+    if (caa_unlikely(new == NULL)) {
+        new = GF_CALLOC(1, sizeof(*new), gf_common_mt_latency_t);
+        if (new == NULL)
+            return;
+        old = uatomic_cmpxchg(hist, NULL, new);
+        if (old != NULL) {
+            GF_FREE(new);
+            new = old;
+        }
+    }
+
+    if (caa_unlikely(gf_latency_hist_shard < 0)) {
+        gf_latency_hist_shard = uatomic_add_return(&gf_latency_hist_shard_next,
+                                                   1) %
+                                GF_LATENCY_HIST_SHARDS;
+    }
+
+    uatomic_inc(&new->shards[gf_latency_hist_shard]
+                     .buckets[gf_latency_hist_bucket(elapsed)]);
+}
+
+void
+gf_latency_hist_reset(gf_latency_hist_t *hist)
+{
+    int i, j;
+
+    if (!hist)
+        return;
+
+    for (i = 0; i < GF_LATENCY_HIST_SHARDS; i++) {
+        for (j = 0; j < GF_LATENCY_HIST_BUCKETS; j++) {
+            uatomic_set(&hist->shards[i].buckets[j], 0);
+        }
+    }
+}
+
+/* Merges all the copies of the buckets and computes the percentiles, in
+ * nanoseconds. Returns the number of samples. */
+uint64_t
+gf_latency_hist_percentiles(gf_latency_hist_t *hist,
+                            uint64_t values[GF_LATENCY_PERCENTILES])
+{
+    uint64_t buckets[GF_LATENCY_HIST_BUCKETS] = {
+        0,
+    };
+    uint64_t total = 0;
+    uint64_t sum = 0;
+    uint64_t rank;
+    int i, j;
+
+    for (i = 0; i < GF_LATENCY_PERCENTILES; i++) {
+        values[i] = 0;
+    }
+
+    if (!hist)
+        return 0;
+
+    for (i = 0; i < GF_LATENCY_HIST_SHARDS; i++) {
+        for (j = 0; j < GF_LATENCY_HIST_BUCKETS; j++) {
+            buckets[j] += uatomic_read(&hist->shards[i].buckets[j]);
+        }
+    }
+    for (j = 0; j < GF_LATENCY_HIST_BUCKETS; j++) {
+        total += buckets[j];
+    }
+    if (total == 0)
+        return 0;
+
+    for (i = 0, j = 0; i < GF_LATENCY_PERCENTILES; i++) {
+        rank = (total * gf_latency_percentile_ranks[i] + 999) / 1000;
+        while (sum + buckets[j] < rank) {
+            sum += buckets[j++];
+        }
+        values[i] = gf_latency_hist_value(j);
+    }
+
+    return total;
+}
+
 void
 gf_latency_update(gf_latency_t *lat, struct timespec *begin,
                   struct timespec *end)
@@ -51,6 +205,8 @@ gf_latency_update(gf_latency_t *lat, struct timespec *begin,
 
     lat->total += elapsed;
     lat->count++;
+
+    gf_latency_hist_update(&lat->hist, elapsed);
 }
 
 void
@@ -58,10 +214,13 @@ gf_latency_reset(gf_latency_t *lat)
 {
     if (!lat)
         return;
-    memset(lat, 0, sizeof(*lat));
+    lat->max = 0;
+    lat->total = 0;
+    lat->count = 0;
     lat->min = ULLONG_MAX;
     /* make sure 'min' is set to high value, so it would be
        properly set later */
+    gf_latency_hist_reset(lat->hist);
 }
 
 void
@@ -81,6 +81,8 @@ dump_latency_and_count(xlator_t *xl, int fd)
     uint64_t cbk = 0;
     uint64_t total_fop_count = 0;
     uint64_t interval_fop_count = 0;
+    uint64_t pct[GF_LATENCY_PERCENTILES];
+    int i;
 
     if (xl->winds) {
         dprintf(fd, "%s.total.pending-winds.count %" PRIu64 "\n", xl->name,
@@ -118,9 +120,14 @@ dump_latency_and_count(xlator_t *xl, int fd)
                     gf_fop_list[index], xl->stats[index].latencies.max);
             dprintf(fd, "%s.interval.%s.min %" PRIu64 "\n", xl->name,
                     gf_fop_list[index], xl->stats[index].latencies.min);
+            gf_latency_hist_percentiles(xl->stats[index].latencies.hist, pct);
+            for (i = 0; i < GF_LATENCY_PERCENTILES; i++) {
+                dprintf(fd, "%s.interval.%s.%s %" PRIu64 "\n", xl->name,
+                        gf_fop_list[index], gf_latency_percentile_names[i],
+                        pct[i]);
+            }
         }
-        memset(&xl->stats[index].latencies, 0,
-               sizeof(xl->stats[index].latencies));
+        gf_latency_reset(&xl->stats[index].latencies);
     }
 
     dprintf(fd, "%s.total.fop-count %" PRIu64 "\n", xl->name, total_fop_count);
@@ -133,7 +140,8 @@ dump_call_stack_details(glusterfs_ctx_t *ctx, int fd)
 {
     dprintf(fd, "total.stack.count %" PRIu64 "\n",
             GF_ATOMIC_GET(ctx->pool->total_count));
-    dprintf(fd, "total.stack.in-flight %" PRIu64 "\n", ctx->pool->cnt);
+    dprintf(fd, "total.stack.in-flight %" PRId64 "\n",
+            call_pool_count(ctx->pool));
 }
 
 static inline void
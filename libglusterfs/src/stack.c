@@ -12,6 +12,81 @@
 #include "glusterfs/stack.h"
 #include "glusterfs/libglusterfs-messages.h"
 
+#include <urcu/uatomic.h>
+
+/* List of the call pools used by the current thread. */
+static __thread int32_t call_pool_shard_index = -1;
+static uint32_t call_pool_shard_next;
+
+void
+call_pool_init(call_pool_t *pool)
+{
+    int i;
+
+    for (i = 0; i < GF_CALL_POOL_SHARDS; i++) {
+        LOCK_INIT(&pool->shards[i].lock);
+        INIT_LIST_HEAD(&pool->shards[i].all_frames);
+        pool->shards[i].cnt = 0;
+    }
+}
+
+void
+call_pool_fini(call_pool_t *pool)
+{
+    int i;
+
+    for (i = 0; i < GF_CALL_POOL_SHARDS; i++) {
+        LOCK_DESTROY(&pool->shards[i].lock);
+    }
+}
+
+/* The result is only approximate if stacks are being created or destroyed. */
+int64_t
+call_pool_count(call_pool_t *pool)
+{
+    int64_t cnt = 0;
+    int i;
+
+    for (i = 0; i < GF_CALL_POOL_SHARDS; i++) {
+        cnt += uatomic_read(&pool->shards[i].cnt);
+    }
+
+    return cnt;
+}
+
+void
+call_pool_link(call_pool_t *pool, call_stack_t *stack)
+{
+    struct call_pool_shard *shard;
+
+    if (caa_unlikely(call_pool_shard_index < 0)) {
+        call_pool_shard_index = uatomic_add_return(&call_pool_shard_next, 1) %
+                                GF_CALL_POOL_SHARDS;
+    }
+    shard = &pool->shards[call_pool_shard_index];
+    stack->shard = shard;
+
+    LOCK(&shard->lock);
+    {
+        list_add(&stack->all_frames, &shard->all_frames);
+        shard->cnt++;
+    }
+    UNLOCK(&shard->lock);
+}
+
+void
+call_pool_unlink(call_stack_t *stack)
+{
+    struct call_pool_shard *shard = stack->shard;
+
+    LOCK(&shard->lock);
+    {
+        list_del_init(&stack->all_frames);
+        shard->cnt--;
+    }
+    UNLOCK(&shard->lock);
+}
+
 call_frame_t *
 create_frame(xlator_t *xl, call_pool_t *pool)
 {
@@ -49,13 +124,8 @@ create_frame(xlator_t *xl, call_pool_t *pool)
         memcpy(&frame->begin, &stack->tv, sizeof(stack->tv));
     }
 
-    LOCK(&pool->lock);
-    {
-        list_add(&stack->all_frames, &pool->all_frames);
-        pool->cnt++;
-        stack->unique = unique++;
-    }
-    UNLOCK(&pool->lock);
+    stack->unique = uatomic_add_return(&unique, 1) - 1;
+    call_pool_link(pool, stack);
     GF_ATOMIC_INC(pool->total_count);
 
     LOCK_INIT(&stack->stack_lock);
@@ -210,40 +280,37 @@ gf_proc_dump_call_stack(call_stack_t *call_stack, const char *key_buf, ...)
 void
 gf_proc_dump_pending_frames(call_pool_t *call_pool)
 {
+    struct call_pool_shard *shard = NULL;
     call_stack_t *trav = NULL;
     int i = 1;
-    int ret = -1;
-    gf_boolean_t section_added = _gf_false;
+    int j;
 
     if (!call_pool)
         return;
 
-    ret = TRY_LOCK(&(call_pool->lock));
-    if (ret)
-        goto out;
-
     gf_proc_dump_add_section("global.callpool");
-    section_added = _gf_true;
     gf_proc_dump_write("callpool_address", "%p", call_pool);
-    gf_proc_dump_write("callpool.cnt", "%" PRId64, call_pool->cnt);
-
-    list_for_each_entry(trav, &call_pool->all_frames, all_frames)
-    {
-        gf_proc_dump_add_section("global.callpool.stack.%d", i);
-        gf_proc_dump_call_stack(trav, "global.callpool.stack.%d", i);
-        i++;
-    }
-    UNLOCK(&(call_pool->lock));
-
-    ret = 0;
-out:
-    if (ret) {
-        if (_gf_false == section_added)
-            gf_proc_dump_add_section("global.callpool");
-        gf_proc_dump_write("Unable to dump the callpool",
-                           "(Lock acquisition failed) %p", call_pool);
+    gf_proc_dump_write("callpool.cnt", "%" PRId64, call_pool_count(call_pool));
+
+    /* Lists are dumped one at a time, so creation and destruction of stacks
+     * is only blocked for the list being dumped. */
+    for (j = 0; j < GF_CALL_POOL_SHARDS; j++) {
+        shard = &call_pool->shards[j];
+        if (TRY_LOCK(&shard->lock)) {
+            gf_proc_dump_write("Unable to dump the callpool",
+                               "(Lock acquisition failed) %p list %d",
+                               call_pool, j);
+            continue;
+        }
+
+        list_for_each_entry(trav, &shard->all_frames, all_frames)
+        {
+            gf_proc_dump_add_section("global.callpool.stack.%d", i);
+            gf_proc_dump_call_stack(trav, "global.callpool.stack.%d", i);
+            i++;
+        }
+        UNLOCK(&shard->lock);
     }
-    return;
 }
 
 void
@@ -399,37 +466,40 @@ void
 gf_proc_dump_pending_frames_to_dict(call_pool_t *call_pool, dict_t *dict)
 {
     int ret = -1;
+    struct call_pool_shard *shard = NULL;
     call_stack_t *trav = NULL;
     char key[GF_DUMP_MAX_BUF_LEN] = {
         0,
     };
     int i = 0;
+    int j;
 
     if (!call_pool || !dict)
         return;
 
-    ret = TRY_LOCK(&call_pool->lock);
-    if (ret) {
-        gf_msg(THIS->name, GF_LOG_WARNING, errno, LG_MSG_LOCK_FAILURE,
-               "Unable to dump call "
-               "pool to dict.");
-        return;
-    }
-
-    ret = dict_set_int32(dict, "callpool.count", call_pool->cnt);
+    ret = dict_set_int32(dict, "callpool.count", call_pool_count(call_pool));
     if (ret)
-        goto out;
+        return;
 
-    list_for_each_entry(trav, &call_pool->all_frames, all_frames)
-    {
-        snprintf(key, sizeof(key), "callpool.stack%d", i);
-        gf_proc_dump_call_stack_to_dict(trav, key, dict);
-        i++;
+    for (j = 0; j < GF_CALL_POOL_SHARDS; j++) {
+        shard = &call_pool->shards[j];
+        ret = TRY_LOCK(&shard->lock);
+        if (ret) {
+            gf_msg(THIS->name, GF_LOG_WARNING, errno, LG_MSG_LOCK_FAILURE,
+                   "Unable to dump call "
+                   "pool to dict.");
+            continue;
+        }
+
+        list_for_each_entry(trav, &shard->all_frames, all_frames)
+        {
+            snprintf(key, sizeof(key), "callpool.stack%d", i);
+            gf_proc_dump_call_stack_to_dict(trav, key, dict);
+            i++;
+        }
+        UNLOCK(&shard->lock);
     }
 
-out:
-    UNLOCK(&call_pool->lock);
-
     return;
 }
 
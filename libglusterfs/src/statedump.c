@@ -202,15 +202,20 @@ gf_proc_dump_write(char *key, char *value, ...)
 void
 gf_latency_statedump_and_reset(char *key, gf_latency_t *lat)
 {
+    uint64_t pct[GF_LATENCY_PERCENTILES];
+
     /* Doesn't make sense to continue if there are no fops
        came in the given interval */
     if (!lat || !lat->count)
         return;
+    gf_latency_hist_percentiles(lat->hist, pct);
     gf_proc_dump_write(key,
                        "AVG:%lf CNT:%" PRIu64 " TOTAL:%" PRIu64 " MIN:%" PRIu64
-                       " MAX:%" PRIu64,
+                       " MAX:%" PRIu64 " P50:%" PRIu64 " P90:%" PRIu64
+                       " P99:%" PRIu64 " P99.9:%" PRIu64,
                        (((double)lat->total) / lat->count), lat->count,
-                       lat->total, lat->min, lat->max);
+                       lat->total, lat->min, lat->max, pct[0], pct[1], pct[2],
+                       pct[3]);
     gf_latency_reset(lat);
 }
 
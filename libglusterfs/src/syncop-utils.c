@@ -25,6 +25,36 @@ struct syncop_dir_scan_data {
     uint32_t *jobs_running;
     uint32_t *qlen;
     int32_t *retval;
+    syncop_dir_scan_stats_t *stats;
+};
+
+/* State shared by the readers of a syncop_mt_dir_scan_readers() and the jobs
+ * they feed */
+struct syncop_mt_dir_scan {
+    call_frame_t *frame;
+    xlator_t *this;
+    xlator_t *subvol;
+    loc_t *loc;
+    void *data;
+    syncop_dir_scan_fn_t fn;
+    int pid;
+    uint32_t max_jobs;
+    uint32_t max_qlen;
+    gf_dirent_t q;
+    pthread_cond_t cond;
+    pthread_mutex_t mut;
+    uint32_t jobs_running;
+    uint32_t qlen;
+    int32_t retval;
+    syncop_dir_scan_stats_t *stats;
+};
+
+struct syncop_mt_dir_scan_reader {
+    struct syncop_mt_dir_scan *scan;
+    dict_t *xdata;
+    pthread_t thread;
+    gf_boolean_t started;
+    int ret;
 };
 
 int
@@ -256,19 +286,29 @@ _dir_scan_job_fn(void *data)
 {
     struct syncop_dir_scan_data *scan_data = data;
     gf_dirent_t *entry = NULL;
+    struct timespec start;
+    struct timespec end;
     int ret = 0;
 
     entry = scan_data->entry;
     scan_data->entry = NULL;
     do {
+        if (scan_data->stats)
+            timespec_now(&start);
         ret = scan_data->fn(scan_data->subvol, entry, scan_data->parent,
                             scan_data->data);
+        if (scan_data->stats)
+            timespec_now(&end);
         gf_dirent_entry_free(entry);
         entry = NULL;
         pthread_mutex_lock(scan_data->mut);
         {
             if (ret)
                 *scan_data->retval |= ret;
+            if (scan_data->stats) {
+                scan_data->stats->processed_count++;
+                scan_data->stats->process_time += gf_tsdiff(&start, &end);
+            }
             if (list_empty(&scan_data->q->list)) {
                 (*scan_data->jobs_running)--;
                 pthread_cond_broadcast(scan_data->cond);
@@ -290,7 +330,8 @@ _run_dir_scan_task(call_frame_t *frame, xlator_t *subvol, loc_t *parent,
                    gf_dirent_t *q, gf_dirent_t *entry, int *retval,
                    pthread_mutex_t *mut, pthread_cond_t *cond,
                    uint32_t *jobs_running, uint32_t *qlen,
-                   syncop_dir_scan_fn_t fn, void *data)
+                   syncop_dir_scan_fn_t fn, void *data,
+                   syncop_dir_scan_stats_t *stats)
 {
     int ret = 0;
     struct syncop_dir_scan_data *scan_data = NULL;
@@ -313,6 +354,7 @@ _run_dir_scan_task(call_frame_t *frame, xlator_t *subvol, loc_t *parent,
     scan_data->q = q;
     scan_data->qlen = qlen;
     scan_data->retval = retval;
+    scan_data->stats = stats;
 
     ret = synctask_new(subvol->ctx->env, _dir_scan_job_fn, _dir_scan_job_fn_cbk,
                        frame, scan_data);
@@ -330,63 +372,47 @@ out:
     return ret;
 }
 
-int
-syncop_mt_dir_scan(call_frame_t *frame, xlator_t *subvol, loc_t *loc, int pid,
-                   void *data, syncop_dir_scan_fn_t fn, dict_t *xdata,
-                   uint32_t max_jobs, uint32_t max_qlen)
+/* Reads the directory through its own fd, and hands the entries to the jobs
+ * shared by all the readers, but for the directories which it processes
+ * itself. */
+static int
+_dir_scan_read(struct syncop_mt_dir_scan *scan, dict_t *xdata)
 {
+    syncop_dir_scan_stats_t stats = {
+        0,
+    };
+    struct timespec start;
+    struct timespec end;
     fd_t *fd = NULL;
     uint64_t offset = 0;
     gf_dirent_t *last = NULL;
     int ret = 0;
-    int retval = 0;
-    gf_dirent_t q;
     gf_dirent_t *entry = NULL;
     gf_dirent_t *tmp = NULL;
-    uint32_t jobs_running = 0;
-    uint32_t qlen = 0;
-    pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
-    pthread_mutex_t mut = PTHREAD_MUTEX_INITIALIZER;
     gf_dirent_t entries;
-    xlator_t *this = NULL;
+    xlator_t *this = scan->this;
 
-    if (frame) {
-        this = frame->this;
-    } else {
-        this = THIS;
-    }
-
-    /*For this functionality to be implemented in general, we need
-     * synccond_t infra which doesn't block the executing thread. Until then
-     * return failures inside synctask if they use this.*/
-    if (synctask_get())
-        return -ENOTSUP;
-
-    if (max_jobs == 0)
-        return -EINVAL;
-
-    /*Code becomes simpler this way. cond_wait just on qlength.
-     * Little bit of cheating*/
-    if (max_qlen == 0)
-        max_qlen = 1;
+    INIT_LIST_HEAD(&entries.list);
 
-    ret = syncop_dirfd(subvol, loc, &fd, pid);
+    ret = syncop_dirfd(scan->subvol, scan->loc, &fd, scan->pid);
     if (ret)
         goto out;
 
-    INIT_LIST_HEAD(&entries.list);
-    INIT_LIST_HEAD(&q.list);
-
-    while ((ret = syncop_readdir(subvol, fd, 131072, offset, &entries, xdata,
-                                 NULL))) {
-        if (ret < 0)
+    for (;;) {
+        if (scan->stats)
+            timespec_now(&start);
+        ret = syncop_readdir(scan->subvol, fd, 131072, offset, &entries, xdata,
+                             NULL);
+        if (scan->stats) {
+            timespec_now(&end);
+            stats.read_time += gf_tsdiff(&start, &end);
+        }
+        if (ret <= 0)
             break;
 
-        if (ret > 0) {
-            /* If the entries are only '.', and '..' then ret
-             * value will be non-zero. so set it to zero here. */
-            ret = 0;
-        }
+        /* If the entries are only '.', and '..' then ret
+         * value will be non-zero. so set it to zero here. */
+        ret = 0;
 
         last = list_last_entry(&entries.list, typeof(*last), list);
         offset = last->d_off;
@@ -401,38 +427,48 @@ syncop_mt_dir_scan(call_frame_t *frame, xlator_t *subvol, loc_t *loc, int pid,
                 gf_dirent_entry_free(entry);
                 continue;
             }
+            stats.read_count++;
 
             if (entry->d_stat.ia_type == IA_IFDIR) {
-                ret = fn(subvol, entry, loc, data);
+                if (scan->stats)
+                    timespec_now(&start);
+                ret = scan->fn(scan->subvol, entry, scan->loc, scan->data);
                 gf_dirent_entry_free(entry);
+                if (scan->stats) {
+                    timespec_now(&end);
+                    stats.processed_count++;
+                    stats.process_time += gf_tsdiff(&start, &end);
+                }
                 if (ret)
                     goto out;
                 continue;
             }
 
-            if (retval) /*Any jobs failed?*/
+            if (scan->retval) /*Any jobs failed?*/
                 goto out;
 
-            pthread_mutex_lock(&mut);
+            pthread_mutex_lock(&scan->mut);
             {
-                while (qlen == max_qlen)
-                    pthread_cond_wait(&cond, &mut);
-                if (max_jobs == jobs_running) {
-                    list_add_tail(&entry->list, &q.list);
-                    qlen++;
+                while (scan->qlen == scan->max_qlen)
+                    pthread_cond_wait(&scan->cond, &scan->mut);
+                if (scan->max_jobs == scan->jobs_running) {
+                    list_add_tail(&entry->list, &scan->q.list);
+                    scan->qlen++;
                     entry = NULL;
                 } else {
-                    jobs_running++;
+                    scan->jobs_running++;
                 }
             }
-            pthread_mutex_unlock(&mut);
+            pthread_mutex_unlock(&scan->mut);
 
             if (!entry)
                 continue;
 
-            ret = _run_dir_scan_task(frame, subvol, loc, &q, entry, &retval,
-                                     &mut, &cond, &jobs_running, &qlen, fn,
-                                     data);
+            ret = _run_dir_scan_task(scan->frame, scan->subvol, scan->loc,
+                                     &scan->q, entry, &scan->retval, &scan->mut,
+                                     &scan->cond, &scan->jobs_running,
+                                     &scan->qlen, scan->fn, scan->data,
+                                     scan->stats);
             if (ret)
                 goto out;
         }
@@ -441,18 +477,118 @@ syncop_mt_dir_scan(call_frame_t *frame, xlator_t *subvol, loc_t *loc, int pid,
 out:
     if (fd)
         fd_unref(fd);
+    gf_dirent_free(&entries);
 
-    pthread_mutex_lock(&mut);
+    pthread_mutex_lock(&scan->mut);
     {
-        while (jobs_running)
-            pthread_cond_wait(&cond, &mut);
+        /* Let the other readers stop too */
+        if (ret)
+            scan->retval |= ret;
+        if (scan->stats) {
+            scan->stats->read_count += stats.read_count;
+            scan->stats->read_time += stats.read_time;
+            scan->stats->processed_count += stats.processed_count;
+            scan->stats->process_time += stats.process_time;
+        }
     }
-    pthread_mutex_unlock(&mut);
+    pthread_mutex_unlock(&scan->mut);
 
-    gf_dirent_free(&q);
-    gf_dirent_free(&entries);
+    return ret;
+}
+
+static void *
+_dir_scan_reader(void *data)
+{
+    struct syncop_mt_dir_scan_reader *reader = data;
+
+    THIS = reader->scan->this;
+    reader->ret = _dir_scan_read(reader->scan, reader->xdata);
+
+    return NULL;
+}
+
+int
+syncop_mt_dir_scan_readers(call_frame_t *frame, xlator_t *subvol, loc_t *loc,
+                           int pid, void *data, syncop_dir_scan_fn_t fn,
+                           dict_t **xdata, uint32_t readers, uint32_t max_jobs,
+                           uint32_t max_qlen, syncop_dir_scan_stats_t *stats)
+{
+    struct syncop_mt_dir_scan scan = {
+        0,
+    };
+    struct syncop_mt_dir_scan_reader *reader = NULL;
+    uint32_t i;
+    int ret = 0;
+
+    /*For this functionality to be implemented in general, we need
+     * synccond_t infra which doesn't block the executing thread. Until then
+     * return failures inside synctask if they use this.*/
+    if (synctask_get())
+        return -ENOTSUP;
 
-    return ret | retval;
+    if ((max_jobs == 0) || (readers == 0))
+        return -EINVAL;
+
+    reader = GF_CALLOC(readers, sizeof(*reader), gf_common_mt_scan_data);
+    if (!reader)
+        return -ENOMEM;
+
+    scan.frame = frame;
+    scan.this = frame ? frame->this : THIS;
+    scan.subvol = subvol;
+    scan.loc = loc;
+    scan.data = data;
+    scan.fn = fn;
+    scan.pid = pid;
+    scan.max_jobs = max_jobs;
+    /*Code becomes simpler this way. cond_wait just on qlength.
+     * Little bit of cheating*/
+    scan.max_qlen = max_qlen ? max_qlen : 1;
+    scan.stats = stats;
+    INIT_LIST_HEAD(&scan.q.list);
+    pthread_mutex_init(&scan.mut, NULL);
+    pthread_cond_init(&scan.cond, NULL);
+
+    /* This thread is the first reader, and runs the ones which couldn't
+     * be started once done. */
+    for (i = 1; i < readers; i++) {
+        reader[i].scan = &scan;
+        reader[i].xdata = xdata[i];
+        if (!gf_thread_create(&reader[i].thread, NULL, _dir_scan_reader,
+                              &reader[i], "dirscan"))
+            reader[i].started = _gf_true;
+    }
+    ret = _dir_scan_read(&scan, xdata[0]);
+    for (i = 1; i < readers; i++) {
+        if (reader[i].started)
+            pthread_join(reader[i].thread, NULL);
+        else
+            reader[i].ret = _dir_scan_read(&scan, xdata[i]);
+        ret |= reader[i].ret;
+    }
+
+    pthread_mutex_lock(&scan.mut);
+    {
+        while (scan.jobs_running)
+            pthread_cond_wait(&scan.cond, &scan.mut);
+    }
+    pthread_mutex_unlock(&scan.mut);
+
+    gf_dirent_free(&scan.q);
+    pthread_cond_destroy(&scan.cond);
+    pthread_mutex_destroy(&scan.mut);
+    GF_FREE(reader);
+
+    return ret | scan.retval;
+}
+
+int
+syncop_mt_dir_scan(call_frame_t *frame, xlator_t *subvol, loc_t *loc, int pid,
+                   void *data, syncop_dir_scan_fn_t fn, dict_t *xdata,
+                   uint32_t max_jobs, uint32_t max_qlen)
+{
+    return syncop_mt_dir_scan_readers(frame, subvol, loc, pid, data, fn,
+                                      &xdata, 1, max_jobs, max_qlen, NULL);
 }
 
 int
@@ -15,18 +15,183 @@
 #include "glusterfs/timespec.h"
 #include "glusterfs/libglusterfs-messages.h"
 
+#include <urcu/uatomic.h>
+
 /* fwd decl */
 static gf_timer_registry_t *
 gf_timer_registry_init(glusterfs_ctx_t *);
 
+/* Wheel where the current thread arms its timers. */
+static __thread int32_t gf_timer_wheel_index = -1;
+static uint32_t gf_timer_wheel_next;
+
+static struct _gf_timer_wheel *
+gf_timer_wheel_get(gf_timer_registry_t *reg)
+{
+    if (caa_unlikely(gf_timer_wheel_index < 0)) {
+        gf_timer_wheel_index = uatomic_add_return(&gf_timer_wheel_next, 1) %
+                               GF_TIMER_WHEELS;
+    }
+
+    return &reg->wheels[gf_timer_wheel_index];
+}
+
+/* Converts a time into a tick of the registry. */
+static uint64_t
+gf_timer_tick(gf_timer_registry_t *reg, struct timespec *ts, bool round_up)
+{
+    int64_t delta;
+
+    delta = TS((*ts)) - TS(reg->base);
+    if (delta <= 0) {
+        return 0;
+    }
+    if (round_up) {
+        delta += 999999;
+    }
+
+    return delta / 1000000;
+}
+
+static void
+__gf_timer_wheel_add(struct _gf_timer_wheel *wheel, gf_timer_t *event)
+{
+    struct list_head *slot;
+    uint64_t expires, idx;
+    uint32_t level, shift;
+
+    expires = event->expires;
+    idx = expires - wheel->clk;
+    if ((int64_t)idx < GF_TIMER_WHEEL_SIZE0) {
+        /* Already expired timers will be run on the next tick. */
+        if ((int64_t)idx < 0) {
+            expires = wheel->clk;
+        }
+        slot = &wheel->slots0[expires & (GF_TIMER_WHEEL_SIZE0 - 1)];
+    } else {
+        shift = GF_TIMER_WHEEL_BITS0;
+        for (level = 0; level < GF_TIMER_WHEEL_LEVELS - 1; level++) {
+            if (idx < (1ULL << (shift + GF_TIMER_WHEEL_BITSN))) {
+                break;
+            }
+            shift += GF_TIMER_WHEEL_BITSN;
+        }
+        /* Timers beyond the last level are kept in its farthest slot. They
+         * will be placed again when cascaded. */
+        if (idx >= (1ULL << (shift + GF_TIMER_WHEEL_BITSN))) {
+            expires = wheel->clk + (1ULL << (shift + GF_TIMER_WHEEL_BITSN)) -
+                      1;
+        }
+        slot = &wheel->slotsn[level][(expires >> shift) &
+                                     (GF_TIMER_WHEEL_SIZEN - 1)];
+    }
+
+    list_add_tail(&event->list, slot);
+}
+
+static uint32_t
+__gf_timer_wheel_cascade(struct _gf_timer_wheel *wheel, uint32_t level,
+                         uint32_t index)
+{
+    struct list_head list;
+    gf_timer_t *event;
+    gf_timer_t *tmp;
+
+    INIT_LIST_HEAD(&list);
+    list_splice_init(&wheel->slotsn[level][index], &list);
+
+    list_for_each_entry_safe(event, tmp, &list, list)
+    {
+        __gf_timer_wheel_add(wheel, event);
+    }
+
+    return index;
+}
+
+/* Advances the wheel up to the tick 'now' (included), moving the expired
+ * timers to 'expired'. */
+static void
+__gf_timer_wheel_run(struct _gf_timer_wheel *wheel, uint64_t now,
+                     struct list_head *expired)
+{
+    gf_timer_t *event;
+    gf_timer_t *tmp;
+    uint32_t index, level, shift;
+
+    while (wheel->clk <= now) {
+        if (wheel->count == 0) {
+            wheel->clk = now + 1;
+            break;
+        }
+
+        index = wheel->clk & (GF_TIMER_WHEEL_SIZE0 - 1);
+        if (index == 0) {
+            shift = GF_TIMER_WHEEL_BITS0;
+            for (level = 0; level < GF_TIMER_WHEEL_LEVELS; level++) {
+                if (__gf_timer_wheel_cascade(
+                        wheel, level,
+                        (wheel->clk >> shift) & (GF_TIMER_WHEEL_SIZEN - 1)) !=
+                    0) {
+                    break;
+                }
+                shift += GF_TIMER_WHEEL_BITSN;
+            }
+        }
+        wheel->clk++;
+
+        list_for_each_entry_safe(event, tmp, &wheel->slots0[index], list)
+        {
+            event->fired = _gf_true;
+            list_move_tail(&event->list, expired);
+            wheel->count--;
+        }
+    }
+}
+
+/* Returns the first tick at which the wheel will have some work to do. */
+static uint64_t
+__gf_timer_wheel_next(struct _gf_timer_wheel *wheel)
+{
+    uint64_t next, tick;
+    uint32_t i, index;
+
+    if (wheel->count == 0) {
+        return UINT64_MAX;
+    }
+
+    /* Timers in the first level expire within a turn of it. */
+    next = UINT64_MAX;
+    for (i = 0; i < GF_TIMER_WHEEL_SIZE0; i++) {
+        tick = wheel->clk + i;
+        if (!list_empty(&wheel->slots0[tick & (GF_TIMER_WHEEL_SIZE0 - 1)])) {
+            next = tick;
+            break;
+        }
+    }
+
+    /* Look for the first cascade that will move some timer down. Cascades
+     * of upper levels happen when the second level wraps. */
+    tick = (wheel->clk + GF_TIMER_WHEEL_SIZE0 - 1) &
+           ~(uint64_t)(GF_TIMER_WHEEL_SIZE0 - 1);
+    for (i = 0; (i < GF_TIMER_WHEEL_SIZEN) && (tick < next); i++) {
+        index = (tick >> GF_TIMER_WHEEL_BITS0) & (GF_TIMER_WHEEL_SIZEN - 1);
+        if ((index == 0) || !list_empty(&wheel->slotsn[0][index])) {
+            next = tick;
+            break;
+        }
+        tick += GF_TIMER_WHEEL_SIZE0;
+    }
+
+    return next;
+}
+
 gf_timer_t *
 gf_timer_call_after(glusterfs_ctx_t *ctx, struct timespec delta,
                     gf_timer_cbk_t callbk, void *data)
 {
     gf_timer_registry_t *reg = NULL;
     gf_timer_t *event = NULL;
-    gf_timer_t *trav = NULL;
-    uint64_t at = 0;
+    struct _gf_timer_wheel *wheel = NULL;
 
     if ((ctx == NULL) || (ctx->cleanup_started)) {
         gf_msg_callingfn("timer", GF_LOG_ERROR, EINVAL, LG_MSG_INVALID_ARG,
@@ -43,29 +208,39 @@ gf_timer_call_after(glusterfs_ctx_t *ctx, struct timespec delta,
         return NULL;
     }
 
-    event = GF_CALLOC(1, sizeof(*event), gf_common_mt_gf_timer_t);
+    event = mem_get(reg->pool);
     if (!event) {
         return NULL;
     }
     timespec_now(&event->at);
     timespec_adjust_delta(&event->at, delta);
-    at = TS(event->at);
+    event->expires = gf_timer_tick(reg, &event->at, true);
     event->callbk = callbk;
     event->data = data;
     event->xl = THIS;
-    pthread_mutex_lock(&reg->lock);
+    event->fired = _gf_false;
+
+    wheel = gf_timer_wheel_get(reg);
+    event->wheel = wheel;
+
+    pthread_mutex_lock(&wheel->lock);
     {
-        list_for_each_entry_reverse(trav, &reg->active, list)
+        __gf_timer_wheel_add(wheel, event);
+        wheel->count++;
+    }
+    pthread_mutex_unlock(&wheel->lock);
+
+    /* The timer thread sets 'wakeup' to UINT64_MAX before looking for the
+     * next expiration, and keeps 'reg->lock' until it sleeps, so the signal
+     * can't be lost. */
+    if (event->expires < uatomic_read(&reg->wakeup)) {
+        pthread_mutex_lock(&reg->lock);
         {
-            if (TS(trav->at) < at)
-                break;
-        }
-        list_add(&event->list, &trav->list);
-        if (&trav->list == &reg->active) {
             pthread_cond_signal(&reg->cond);
         }
+        pthread_mutex_unlock(&reg->lock);
     }
-    pthread_mutex_unlock(&reg->lock);
+
     return event;
 }
 
@@ -73,6 +248,7 @@ int32_t
 gf_timer_call_cancel(glusterfs_ctx_t *ctx, gf_timer_t *event)
 {
     gf_timer_registry_t *reg = NULL;
+    struct _gf_timer_wheel *wheel = NULL;
     gf_boolean_t fired = _gf_false;
 
     if (ctx == NULL || event == NULL) {
@@ -101,70 +277,137 @@ gf_timer_call_cancel(glusterfs_ctx_t *ctx, gf_timer_t *event)
         return -1;
     }
 
-    pthread_mutex_lock(&reg->lock);
+    wheel = event->wheel;
+
+    pthread_mutex_lock(&wheel->lock);
     {
         fired = event->fired;
         if (fired)
             goto unlock;
         list_del(&event->list);
+        wheel->count--;
     }
 unlock:
-    pthread_mutex_unlock(&reg->lock);
+    pthread_mutex_unlock(&wheel->lock);
 
     if (!fired) {
-        GF_FREE(event);
+        mem_put(event);
         return 0;
     }
     return -1;
 }
 
+static void
+gf_timer_run(struct list_head *expired)
+{
+    gf_timer_t *event = NULL;
+    xlator_t *old_THIS = NULL;
+
+    while (!list_empty(expired)) {
+        event = list_first_entry(expired, gf_timer_t, list);
+        list_del_init(&event->list);
+
+        old_THIS = NULL;
+        if (event->xl) {
+            old_THIS = THIS;
+            THIS = event->xl;
+        }
+        event->callbk(event->data);
+        mem_put(event);
+        if (old_THIS) {
+            THIS = old_THIS;
+        }
+    }
+}
+
 static void *
 gf_timer_proc(void *data)
 {
     gf_timer_registry_t *reg = data;
+    struct _gf_timer_wheel *wheel = NULL;
     gf_timer_t *event = NULL;
     gf_timer_t *tmp = NULL;
-    xlator_t *old_THIS = NULL;
+    struct list_head expired;
+    struct timespec now;
+    uint64_t tick, next, n;
+    uint32_t i, j, k;
 
-    pthread_mutex_lock(&reg->lock);
+    INIT_LIST_HEAD(&expired);
 
-    while (!reg->fin) {
-        if (list_empty(&reg->active)) {
-            pthread_cond_wait(&reg->cond, &reg->lock);
-        } else {
-            struct timespec now;
+    while (!uatomic_read(&reg->fin)) {
+        /* Any new timer will wake us up until we know when to sleep. */
+        uatomic_set(&reg->wakeup, UINT64_MAX);
 
-            timespec_now(&now);
-            event = list_first_entry(&reg->active, gf_timer_t, list);
-            if (TS(now) < TS(event->at)) {
-                now = event->at;
-                pthread_cond_timedwait(&reg->cond, &reg->lock, &now);
-            } else {
-                event->fired = _gf_true;
-                list_del_init(&event->list);
+        timespec_now(&now);
+        tick = gf_timer_tick(reg, &now, false);
 
-                pthread_mutex_unlock(&reg->lock);
+        for (i = 0; i < GF_TIMER_WHEELS; i++) {
+            wheel = &reg->wheels[i];
 
-                old_THIS = NULL;
-                if (event->xl) {
-                    old_THIS = THIS;
-                    THIS = event->xl;
-                }
-                event->callbk(event->data);
-                GF_FREE(event);
-                if (old_THIS) {
-                    THIS = old_THIS;
-                }
+            pthread_mutex_lock(&wheel->lock);
+            {
+                __gf_timer_wheel_run(wheel, tick, &expired);
+            }
+            pthread_mutex_unlock(&wheel->lock);
+
+            gf_timer_run(&expired);
+        }
 
-                pthread_mutex_lock(&reg->lock);
+        pthread_mutex_lock(&reg->lock);
+
+        next = UINT64_MAX;
+        for (i = 0; i < GF_TIMER_WHEELS; i++) {
+            wheel = &reg->wheels[i];
+
+            pthread_mutex_lock(&wheel->lock);
+            {
+                n = __gf_timer_wheel_next(wheel);
+            }
+            pthread_mutex_unlock(&wheel->lock);
+
+            if (n < next) {
+                next = n;
             }
         }
+
+        timespec_now(&now);
+        if (!reg->fin && (next > gf_timer_tick(reg, &now, false))) {
+            uatomic_set(&reg->wakeup, next);
+            if (next == UINT64_MAX) {
+                pthread_cond_wait(&reg->cond, &reg->lock);
+            } else {
+                n = TS(reg->base) + next * 1000000;
+                now.tv_sec = n / 1000000000;
+                now.tv_nsec = n % 1000000000;
+                pthread_cond_timedwait(&reg->cond, &reg->lock, &now);
+            }
+        }
+
+        pthread_mutex_unlock(&reg->lock);
     }
 
     /* Do not call gf_timer_call_cancel(),
      * it will lead to deadlock
      */
-    list_for_each_entry_safe(event, tmp, &reg->active, list)
+    for (i = 0; i < GF_TIMER_WHEELS; i++) {
+        wheel = &reg->wheels[i];
+
+        pthread_mutex_lock(&wheel->lock);
+
+        for (j = 0; j < GF_TIMER_WHEEL_SIZE0; j++) {
+            list_append_init(&wheel->slots0[j], &expired);
+        }
+        for (j = 0; j < GF_TIMER_WHEEL_LEVELS; j++) {
+            for (k = 0; k < GF_TIMER_WHEEL_SIZEN; k++) {
+                list_append_init(&wheel->slotsn[j][k], &expired);
+            }
+        }
+        wheel->count = 0;
+
+        pthread_mutex_unlock(&wheel->lock);
+    }
+
+    list_for_each_entry_safe(event, tmp, &expired, list)
     {
         list_del(&event->list);
         /* TODO Possible resource leak
@@ -174,11 +417,9 @@ gf_timer_proc(void *data)
          * unref rpc object which was taken when added to timer
          * wheel.
          */
-        GF_FREE(event);
+        mem_put(event);
     }
 
-    pthread_mutex_unlock(&reg->lock);
-
     return NULL;
 }
 
@@ -186,19 +427,39 @@ static gf_timer_registry_t *
 gf_timer_registry_init(glusterfs_ctx_t *ctx)
 {
     gf_timer_registry_t *reg = NULL;
+    struct _gf_timer_wheel *wheel = NULL;
     int ret = -1;
+    uint32_t i, j, k;
     pthread_condattr_t attr;
 
     LOCK(&ctx->lock);
     {
         reg = ctx->timer;
-        if (reg) {
-            UNLOCK(&ctx->lock);
-            goto out;
-        }
-        reg = GF_CALLOC(1, sizeof(*reg), gf_common_mt_gf_timer_registry_t);
-        if (!reg) {
+    }
+    UNLOCK(&ctx->lock);
+    if (reg) {
+        goto out;
+    }
+
+    reg = GF_CALLOC(1, sizeof(*reg), gf_common_mt_gf_timer_registry_t);
+    if (!reg) {
+        goto out;
+    }
+    reg->pool = mem_pool_new_ctx(ctx, gf_timer_t, 4096);
+    if (!reg->pool) {
+        GF_FREE(reg);
+        reg = NULL;
+        goto out;
+    }
+
+    LOCK(&ctx->lock);
+    {
+        if (ctx->timer) {
+            /* Somebody else has been faster. */
             UNLOCK(&ctx->lock);
+            mem_pool_destroy(reg->pool);
+            GF_FREE(reg);
+            reg = ctx->timer;
             goto out;
         }
         ctx->timer = reg;
@@ -206,7 +467,20 @@ gf_timer_registry_init(glusterfs_ctx_t *ctx)
         pthread_condattr_init(&attr);
         pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
         pthread_cond_init(&reg->cond, &attr);
-        INIT_LIST_HEAD(&reg->active);
+        timespec_now(&reg->base);
+        reg->wakeup = UINT64_MAX;
+        for (i = 0; i < GF_TIMER_WHEELS; i++) {
+            wheel = &reg->wheels[i];
+            pthread_mutex_init(&wheel->lock, NULL);
+            for (j = 0; j < GF_TIMER_WHEEL_SIZE0; j++) {
+                INIT_LIST_HEAD(&wheel->slots0[j]);
+            }
+            for (j = 0; j < GF_TIMER_WHEEL_LEVELS; j++) {
+                for (k = 0; k < GF_TIMER_WHEEL_SIZEN; k++) {
+                    INIT_LIST_HEAD(&wheel->slotsn[j][k]);
+                }
+            }
+        }
     }
     UNLOCK(&ctx->lock);
     ret = gf_thread_create(&reg->th, NULL, gf_timer_proc, reg, "timer");
@@ -224,6 +498,7 @@ gf_timer_registry_destroy(glusterfs_ctx_t *ctx)
 {
     pthread_t thr_id;
     gf_timer_registry_t *reg = NULL;
+    uint32_t i;
 
     if (ctx == NULL)
         return;
@@ -249,6 +524,11 @@ gf_timer_registry_destroy(glusterfs_ctx_t *ctx)
 
     pthread_join(thr_id, NULL);
 
+    for (i = 0; i < GF_TIMER_WHEELS; i++) {
+        pthread_mutex_destroy(&reg->wheels[i].lock);
+    }
+    mem_pool_destroy(reg->pool);
+
     pthread_cond_destroy(&reg->cond);
     pthread_mutex_destroy(&reg->lock);
 
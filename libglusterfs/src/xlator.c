@@ -818,10 +818,16 @@ xlator_members_free(xlator_t *xl)
 {
     volume_opt_list_t *vol_opt = NULL;
     volume_opt_list_t *tmp = NULL;
+    int i;
 
     if (!xl)
         return 0;
 
+    for (i = 0; i < GF_FOP_MAXVALUE; i++) {
+        GF_FREE(xl->stats[i].latencies.hist);
+        xl->stats[i].latencies.hist = NULL;
+    }
+
     GF_FREE(xl->name);
     GF_FREE(xl->type);
     if (!(xl->ctx && xl->ctx->cmd_args.vgtool != _gf_none) && xl->dlhandle)
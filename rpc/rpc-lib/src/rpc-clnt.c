@@ -34,6 +34,7 @@ __saved_frames_get_timedout(struct saved_frames *frames, uint32_t timeout,
         if ((tmp->saved_at.tv_sec + timeout) <= current->tv_sec) {
             bailout_frame = tmp;
             list_del_init(&bailout_frame->list);
+            list_del_init(&bailout_frame->hash);
             frames->count--;
         }
     }
@@ -55,6 +56,27 @@ _is_lock_fop(struct saved_frame *sframe)
             (fop == GFS3_OP_FENTRYLK));
 }
 
+static struct list_head *
+__saved_frames_bucket(struct saved_frames *frames, int64_t callid)
+{
+    return &frames->hash[callid & (RPC_CLNT_SAVED_FRAMES_HASH - 1)];
+}
+
+static struct saved_frame *
+__saved_frames_find(struct saved_frames *frames, int64_t callid)
+{
+    struct saved_frame *tmp = NULL;
+
+    list_for_each_entry(tmp, __saved_frames_bucket(frames, callid), hash)
+    {
+        if (tmp->rpcreq->xid == callid) {
+            return tmp;
+        }
+    }
+
+    return NULL;
+}
+
 static struct saved_frame *
 __saved_frames_put(struct saved_frames *frames, void *frame,
                    struct rpc_req *rpcreq)
@@ -68,6 +90,7 @@ __saved_frames_put(struct saved_frames *frames, void *frame,
     /* THIS should be saved and set back */
 
     INIT_LIST_HEAD(&saved_frame->list);
+    INIT_LIST_HEAD(&saved_frame->hash);
 
     saved_frame->capital_this = THIS;
     saved_frame->frame = frame;
@@ -79,6 +102,7 @@ __saved_frames_put(struct saved_frames *frames, void *frame,
         list_add_tail(&saved_frame->list, &frames->lk_sf.list);
     else
         list_add_tail(&saved_frame->list, &frames->sf.list);
+    list_add(&saved_frame->hash, __saved_frames_bucket(frames, rpcreq->xid));
 
     frames->count++;
 
@@ -227,6 +251,7 @@ struct saved_frames *
 saved_frames_new(void)
 {
     struct saved_frames *saved_frames = NULL;
+    int i;
 
     saved_frames = GF_CALLOC(1, sizeof(*saved_frames),
                              gf_common_mt_rpcclnt_savedframe_t);
@@ -236,6 +261,9 @@ saved_frames_new(void)
 
     INIT_LIST_HEAD(&saved_frames->sf.list);
     INIT_LIST_HEAD(&saved_frames->lk_sf.list);
+    for (i = 0; i < RPC_CLNT_SAVED_FRAMES_HASH; i++) {
+        INIT_LIST_HEAD(&saved_frames->hash[i]);
+    }
 
     return saved_frames;
 }
@@ -252,22 +280,10 @@ __saved_frame_copy(struct saved_frames *frames, int64_t callid,
         goto out;
     }
 
-    list_for_each_entry(tmp, &frames->sf.list, list)
-    {
-        if (tmp->rpcreq->xid == callid) {
-            *saved_frame = *tmp;
-            ret = 0;
-            goto out;
-        }
-    }
-
-    list_for_each_entry(tmp, &frames->lk_sf.list, list)
-    {
-        if (tmp->rpcreq->xid == callid) {
-            *saved_frame = *tmp;
-            ret = 0;
-            goto out;
-        }
+    tmp = __saved_frames_find(frames, callid);
+    if (tmp) {
+        *saved_frame = *tmp;
+        ret = 0;
     }
 
 out:
@@ -278,30 +294,12 @@ struct saved_frame *
 __saved_frame_get(struct saved_frames *frames, int64_t callid)
 {
     struct saved_frame *saved_frame = NULL;
-    struct saved_frame *tmp = NULL;
-
-    list_for_each_entry(tmp, &frames->sf.list, list)
-    {
-        if (tmp->rpcreq->xid == callid) {
-            list_del_init(&tmp->list);
-            frames->count--;
-            saved_frame = tmp;
-            goto out;
-        }
-    }
 
-    list_for_each_entry(tmp, &frames->lk_sf.list, list)
-    {
-        if (tmp->rpcreq->xid == callid) {
-            list_del_init(&tmp->list);
-            frames->count--;
-            saved_frame = tmp;
-            goto out;
-        }
-    }
-
-out:
+    saved_frame = __saved_frames_find(frames, callid);
     if (saved_frame) {
+        list_del_init(&saved_frame->list);
+        list_del_init(&saved_frame->hash);
+        frames->count--;
         THIS = saved_frame->capital_this;
     }
 
@@ -344,6 +342,7 @@ saved_frames_unwind(struct saved_frames *saved_frames)
                               trav->rpcreq->conn->rpc_clnt->reqpool);
 
         list_del_init(&trav->list);
+        list_del_init(&trav->hash);
         mem_put(trav);
     }
 }
@@ -42,6 +42,11 @@ typedef int (*fop_cbk_fn_t)(struct rpc_req *req, struct iovec *iov, int count,
 
 typedef int (*clnt_fn_t)(call_frame_t *fr, xlator_t *xl, void *args);
 
+/* Saved frames are also hashed by xid, so that a reply can be matched to its
+ * request without walking all the outstanding requests. xids are allocated
+ * sequentially, so outstanding requests spread evenly over the buckets. */
+#define RPC_CLNT_SAVED_FRAMES_HASH 1024
+
 struct saved_frame {
     union {
         struct list_head list;
@@ -50,6 +55,7 @@ struct saved_frame {
             struct saved_frame *frame_prev;
         };
     };
+    struct list_head hash; /* bucket of saved_frames->hash */
     void *capital_this;
     void *frame;
     struct rpc_req *rpcreq;
@@ -61,6 +67,7 @@ struct saved_frames {
     int64_t count;
     struct saved_frame sf;
     struct saved_frame lk_sf;
+    struct list_head hash[RPC_CLNT_SAVED_FRAMES_HASH];
 };
 
 /* Initialized by procnum */
@@ -1844,7 +1844,7 @@ void
 rpcsvc_program_destroy(rpcsvc_program_t *program)
 {
     if (program) {
-        GF_FREE(program->latencies);
+        gf_latency_free(program->latencies, program->numactors);
         GF_FREE(program);
     }
 }
@@ -428,6 +428,164 @@ out:
     return ret;
 }
 
+/* The entries of @gf_c_req and their xdata are allocated here, and released
+ * by gf_proto_cache_invalidation_batch_free() */
+static inline int
+gf_proto_cache_invalidation_batch_from_upcall(
+    xlator_t *this, gfs4_cbk_cache_invalidation_batch_req *gf_c_req,
+    struct gf_upcall *gf_up_data)
+{
+    struct gf_upcall_cache_invalidation_batch *batch = NULL;
+    struct gf_upcall_cache_invalidation *gf_c_data = NULL;
+    gfs4_cache_invalidation *entry = NULL;
+    uint32_t i = 0;
+    int op_errno = EINVAL;
+    int ret = -1;
+
+    GF_VALIDATE_OR_GOTO(this->name, gf_c_req, out);
+    GF_VALIDATE_OR_GOTO(this->name, gf_up_data, out);
+    GF_VALIDATE_OR_GOTO(
+        this->name,
+        (gf_up_data->event_type == GF_UPCALL_CACHE_INVALIDATION_BATCH), out);
+
+    batch = (struct gf_upcall_cache_invalidation_batch *)gf_up_data->data;
+    GF_VALIDATE_OR_GOTO(this->name, batch, out);
+
+    gf_c_req->entries.entries_val = GF_CALLOC(batch->count, sizeof(*entry),
+                                              gf_common_mt_char);
+    if (!gf_c_req->entries.entries_val)
+        goto out;
+    gf_c_req->entries.entries_len = batch->count;
+
+    for (i = 0; i < batch->count; i++) {
+        entry = &gf_c_req->entries.entries_val[i];
+        gf_c_data = (struct gf_upcall_cache_invalidation *)batch->entries[i]
+                        .data;
+
+        memcpy(entry->gfid, batch->entries[i].gfid, 16);
+        entry->flags = gf_c_data->flags;
+        entry->expire_time_attr = gf_c_data->expire_time_attr;
+        gf_stat_from_iatt(&entry->stat, &gf_c_data->stat);
+        gf_stat_from_iatt(&entry->parent_stat, &gf_c_data->p_stat);
+        gf_stat_from_iatt(&entry->oldparent_stat, &gf_c_data->oldp_stat);
+
+        GF_PROTOCOL_DICT_SERIALIZE(this, gf_c_data->dict,
+                                   &(entry->xdata).xdata_val,
+                                   (entry->xdata).xdata_len, op_errno, out);
+    }
+
+    ret = 0;
+out:
+    if (ret < 0)
+        ret = -op_errno;
+
+    return ret;
+}
+
+static inline void
+gf_proto_cache_invalidation_batch_free(
+    gfs4_cbk_cache_invalidation_batch_req *gf_c_req)
+{
+    uint32_t i = 0;
+
+    if (!gf_c_req->entries.entries_val)
+        return;
+
+    for (i = 0; i < gf_c_req->entries.entries_len; i++)
+        GF_FREE(gf_c_req->entries.entries_val[i].xdata.xdata_val);
+
+    GF_FREE(gf_c_req->entries.entries_val);
+    gf_c_req->entries.entries_val = NULL;
+    gf_c_req->entries.entries_len = 0;
+}
+
+/* @gf_up_data->data must point to a batch, whose entries are allocated here
+ * and released by gf_upcall_cache_invalidation_batch_cleanup() */
+static inline int
+gf_proto_cache_invalidation_batch_to_upcall(
+    xlator_t *this, gfs4_cbk_cache_invalidation_batch_req *gf_c_req,
+    struct gf_upcall *gf_up_data)
+{
+    struct gf_upcall_cache_invalidation_batch *batch = NULL;
+    struct gf_upcall_cache_invalidation *gf_c_data = NULL;
+    gfs4_cache_invalidation *entry = NULL;
+    uint32_t count = 0;
+    uint32_t i = 0;
+    int op_errno = EINVAL;
+    int ret = -1;
+
+    GF_VALIDATE_OR_GOTO(this->name, gf_c_req, out);
+    GF_VALIDATE_OR_GOTO(this->name, gf_up_data, out);
+
+    batch = (struct gf_upcall_cache_invalidation_batch *)gf_up_data->data;
+    GF_VALIDATE_OR_GOTO(this->name, batch, out);
+
+    count = gf_c_req->entries.entries_len;
+
+    /* The invalidations go right after the entries pointing to them. */
+    batch->entries = GF_CALLOC(count,
+                               sizeof(struct gf_upcall) +
+                                   sizeof(struct gf_upcall_cache_invalidation),
+                               gf_common_mt_char);
+    if (!batch->entries)
+        goto out;
+    gf_c_data = (struct gf_upcall_cache_invalidation *)(batch->entries +
+                                                         count);
+
+    gf_up_data->event_type = GF_UPCALL_CACHE_INVALIDATION_BATCH;
+
+    for (i = 0; i < count; i++) {
+        entry = &gf_c_req->entries.entries_val[i];
+
+        batch->entries[i].client_uid = gf_up_data->client_uid;
+        memcpy(batch->entries[i].gfid, entry->gfid, 16);
+        batch->entries[i].event_type = GF_UPCALL_CACHE_INVALIDATION;
+        batch->entries[i].data = &gf_c_data[i];
+        batch->count++;
+
+        gf_c_data[i].flags = entry->flags;
+        gf_c_data[i].expire_time_attr = entry->expire_time_attr;
+        gf_stat_to_iatt(&entry->stat, &gf_c_data[i].stat);
+        gf_stat_to_iatt(&entry->parent_stat, &gf_c_data[i].p_stat);
+        gf_stat_to_iatt(&entry->oldparent_stat, &gf_c_data[i].oldp_stat);
+
+        GF_PROTOCOL_DICT_UNSERIALIZE(this, gf_c_data[i].dict,
+                                     (entry->xdata).xdata_val,
+                                     (entry->xdata).xdata_len, ret, op_errno,
+                                     out);
+
+        /* Same as for single invalidations */
+        if (!gf_c_data[i].dict)
+            gf_c_data[i].dict = dict_new();
+    }
+
+    ret = 0;
+out:
+    if (ret < 0)
+        ret = -op_errno;
+
+    return ret;
+}
+
+static inline void
+gf_upcall_cache_invalidation_batch_cleanup(
+    struct gf_upcall_cache_invalidation_batch *batch)
+{
+    struct gf_upcall_cache_invalidation *gf_c_data = NULL;
+    uint32_t i = 0;
+
+    for (i = 0; i < batch->count; i++) {
+        gf_c_data = (struct gf_upcall_cache_invalidation *)batch->entries[i]
+                        .data;
+        if (gf_c_data->dict)
+            dict_unref(gf_c_data->dict);
+    }
+
+    GF_FREE(batch->entries);
+    batch->entries = NULL;
+    batch->count = 0;
+}
+
 static inline int
 gf_proto_inodelk_contention_to_upcall(struct gfs4_inodelk_contention_req *lc,
                                       struct gf_upcall *gf_up_data)
@@ -795,3 +795,19 @@ struct gfs4_entrylk_contention_req {
         string                domain<>;
         opaque                xdata<>;
 };
+
+struct gfs4_cache_invalidation {
+        opaque         gfid[16];
+        unsigned int   flags;
+        unsigned int   expire_time_attr;
+        gf_iatt        stat;
+        gf_iatt        parent_stat;
+        gf_iatt        oldparent_stat;
+        opaque         xdata<>;
+};
+
+/* Several cache invalidations for the same client, in the order they
+ * happened */
+struct gfs4_cbk_cache_invalidation_batch_req {
+        gfs4_cache_invalidation entries<>;
+};
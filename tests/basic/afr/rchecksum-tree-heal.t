@@ -0,0 +1,53 @@
+#!/bin/bash
+
+#This file tests that the diff data self-heal of a big file, done by comparing
+#the checksums of its ranges kept by the bricks, heals the blocks written while
+#a brick was down, both the first time and once the checksums are kept.
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+cleanup;
+
+function write_blocks {
+        for offset in 3 37 60
+        do
+                dd if=/dev/urandom of=$M0/file bs=4k count=1 \
+                   seek=$((offset * 256 + $1)) conv=notrunc || return 1
+        done
+}
+
+function heal_and_compare {
+        TEST $CLI volume start $V0 force
+        EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" glustershd_up_status
+        EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status_in_shd $V0 0
+        EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status_in_shd $V0 1
+        TEST $CLI volume heal $V0
+        EXPECT_WITHIN $HEAL_TIMEOUT "0" get_pending_heal_count $V0
+        TEST cmp $B0/${V0}0/file $B0/${V0}1/file
+}
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 replica 2 $H0:$B0/${V0}{0,1}
+TEST $CLI volume set $V0 cluster.data-self-heal-algorithm diff
+TEST $CLI volume set $V0 storage.rchecksum-tree on
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 $M0;
+TEST dd if=/dev/urandom of=$M0/file bs=1M count=64
+
+TEST kill_brick $V0 $H0 $B0/${V0}0
+TEST write_blocks 1
+heal_and_compare
+gfid=$(gf_get_gfid_backend_file_path $B0/${V0}1 file | xargs basename)
+TEST [ -f $B0/${V0}1/.glusterfs/checksums/$gfid ]
+
+TEST kill_brick $V0 $H0 $B0/${V0}0
+TEST write_blocks 100
+heal_and_compare
+
+TEST $CLI volume set $V0 storage.rchecksum-tree off
+TEST ! [ -d $B0/${V0}1/.glusterfs/checksums ]
+
+cleanup
@@ -0,0 +1,43 @@
+#!/bin/bash
+
+#This file tests that SHD heals everything when it reads the index of a brick
+#with several threads, each one reading its own part of it.
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 replica 2 $H0:$B0/${V0}{0,1}
+TEST $CLI volume set $V0 cluster.self-heal-daemon off
+TEST $CLI volume set $V0 cluster.shd-index-readers 4
+TEST $CLI volume set $V0 cluster.shd-max-threads 4
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 $M0;
+TEST kill_brick $V0 $H0 $B0/${V0}0
+TEST mkdir $M0/dir
+for i in {1..100}
+do
+        echo $i > $M0/dir/file$i
+        echo $i > $M0/file$i
+done
+EXPECT_NOT "^0$" get_pending_heal_count $V0
+
+TEST $CLI volume start $V0 force
+TEST $CLI volume set $V0 cluster.self-heal-daemon on
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" glustershd_up_status
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status_in_shd $V0 0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status_in_shd $V0 1
+
+TEST $CLI volume heal $V0
+EXPECT_WITHIN $HEAL_TIMEOUT "0" get_pending_heal_count $V0
+for i in {1..100}
+do
+        TEST cmp $B0/${V0}0/dir/file$i $B0/${V0}1/dir/file$i
+        TEST cmp $B0/${V0}0/file$i $B0/${V0}1/file$i
+done
+
+cleanup
@@ -0,0 +1,45 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+# Large writes and reads encoded and decoded by the compute threads must give
+# the same data as the ones done by a single thread.
+
+cleanup
+
+tmp=`mktemp -p ${LOGDIR} -d -t ${0##*/}.XXXXXX`
+if [ ! -d $tmp ]; then
+    exit 1
+fi
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 disperse 6 redundancy 2 $H0:$B0/${V0}{0..5}
+TEST $CLI volume set $V0 disperse.compute-threads 4
+TEST $CLI volume set $V0 disperse.compute-threshold 64KB
+TEST $CLI volume heal $V0 disable
+TEST $CLI volume start $V0
+
+TEST $GFS --direct-io-mode=yes --volfile-id=/$V0 --volfile-server=$H0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "6" ec_child_up_count $V0 0
+EXPECT "4" mount_get_option_value $M0 $V0-disperse-0 compute-threads
+
+TEST dd if=/dev/urandom of=$tmp/data bs=1M count=16
+cs=$(sha1sum $tmp/data | awk '{ print $1 }')
+
+TEST dd if=$tmp/data of=$M0/file bs=4M
+EXPECT "$cs" echo $(sha1sum $M0/file | awk '{ print $1 }')
+
+TEST kill_brick $V0 $H0 $B0/${V0}0
+TEST kill_brick $V0 $H0 $B0/${V0}3
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "4" ec_child_up_count $V0 0
+EXPECT "$cs" echo $(dd if=$M0/file bs=4M 2>/dev/null | sha1sum | awk '{ print $1 }')
+
+# Without the threads the same data must be read back
+TEST $CLI volume set $V0 disperse.compute-threads 0
+EXPECT_WITHIN $CONFIG_UPDATE_TIMEOUT "0" mount_get_option_value $M0 $V0-disperse-0 compute-threads
+EXPECT "$cs" echo $(dd if=$M0/file bs=4M 2>/dev/null | sha1sum | awk '{ print $1 }')
+
+TEST rm -rf $tmp
+cleanup;
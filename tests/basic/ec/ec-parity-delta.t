@@ -0,0 +1,104 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+# Small writes inside a systematic file only update the data bricks they
+# modify and the redundancy bricks, and the file stays readable from any
+# disperse-data-count bricks.
+
+function overwrite
+{
+    local offset=$1
+    local size=$2
+
+    dd if=/dev/urandom of=$tmp/chunk bs=$size count=1 2>/dev/null
+    dd if=$tmp/chunk of=$tmp/data bs=$size seek=$offset oflag=seek_bytes \
+       conv=notrunc 2>/dev/null
+    dd if=$tmp/chunk of=$M0/file bs=$size seek=$offset oflag=seek_bytes \
+       conv=notrunc 2>/dev/null
+}
+
+function file_checksum
+{
+    sha1sum $1 | awk '{ print $1 }'
+}
+
+cleanup
+
+tmp=`mktemp -p ${LOGDIR} -d -t ${0##*/}.XXXXXX`
+if [ ! -d $tmp ]; then
+    exit 1
+fi
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 disperse 6 redundancy 2 $H0:$B0/${V0}{0..5}
+TEST $CLI volume set $V0 disperse.systematic on
+TEST $CLI volume set $V0 disperse.parity-delta on
+TEST $CLI volume set $V0 disperse.stripe-cache 0
+TEST $CLI volume heal $V0 disable
+TEST $CLI volume start $V0
+
+TEST $GFS --direct-io-mode=yes --volfile-id=/$V0 --volfile-server=$H0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "6" ec_child_up_count $V0 0
+EXPECT "1" mount_get_option_value $M0 $V0-disperse-0 parity-delta
+
+TEST dd if=/dev/urandom of=$tmp/data bs=2048 count=512
+TEST cp $tmp/data $M0/file
+
+# A write inside the first chunk doesn't touch the other data bricks
+mtime=$(stat -c %Y $B0/${V0}1/file)
+sleep 2
+TEST overwrite 100 200
+EXPECT "$mtime" stat -c %Y $B0/${V0}1/file
+EXPECT "$(file_checksum $tmp/data)" file_checksum $M0/file
+
+# Writes across chunks and stripes
+TEST overwrite 1000 100
+TEST overwrite 2000 1000
+TEST overwrite 4000 200
+TEST overwrite 100000 3
+TEST overwrite 1048000 500
+EXPECT "$(file_checksum $tmp/data)" file_checksum $M0/file
+
+# The parity must match the data for any bricks to be read
+TEST kill_brick $V0 $H0 $B0/${V0}0
+TEST kill_brick $V0 $H0 $B0/${V0}1
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "4" ec_child_up_count $V0 0
+EXPECT "$(file_checksum $tmp/data)" file_checksum $M0/file
+
+# With bricks down whole stripes are written again
+TEST overwrite 5000 100
+EXPECT "$(file_checksum $tmp/data)" file_checksum $M0/file
+
+TEST $CLI volume heal $V0 enable
+TEST $CLI volume start $V0 force
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "6" ec_child_up_count $V0 0
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" glustershd_up_status
+TEST $CLI volume heal $V0
+EXPECT_WITHIN $HEAL_TIMEOUT "^0$" get_pending_heal_count $V0
+TEST kill_brick $V0 $H0 $B0/${V0}2
+TEST kill_brick $V0 $H0 $B0/${V0}3
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "4" ec_child_up_count $V0 0
+EXPECT "$(file_checksum $tmp/data)" file_checksum $M0/file
+
+TEST $CLI volume start $V0 force
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "6" ec_child_up_count $V0 0
+TEST $CLI volume heal $V0
+EXPECT_WITHIN $HEAL_TIMEOUT "^0$" get_pending_heal_count $V0
+
+# A data brick not modified by the write being down also needs whole stripes
+# to be written, since its fragment can't be counted as good.
+TEST kill_brick $V0 $H0 $B0/${V0}3
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "5" ec_child_up_count $V0 0
+mtime=$(stat -c %Y $B0/${V0}2/file)
+sleep 2
+TEST overwrite 300 200
+TEST [ "$(stat -c %Y $B0/${V0}2/file)" != "$mtime" ]
+TEST kill_brick $V0 $H0 $B0/${V0}1
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "4" ec_child_up_count $V0 0
+EXPECT "$(file_checksum $tmp/data)" file_checksum $M0/file
+
+TEST rm -rf $tmp
+cleanup;
@@ -0,0 +1,77 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+# With disperse.systematic the first disperse-data-count bricks keep each
+# 512 bytes chunk of a stripe unmodified, and the file is still readable
+# from any disperse-data-count bricks.
+
+function chunk_matches
+{
+    local src=$1
+    local idx=$2
+
+    cmp -s <(dd if=$src bs=512 skip=$idx count=1 2>/dev/null) \
+           <(dd if=$B0/${V0}$idx/$3 bs=512 count=1 2>/dev/null) && echo "Y"
+}
+
+cleanup
+
+tmp=`mktemp -p ${LOGDIR} -d -t ${0##*/}.XXXXXX`
+if [ ! -d $tmp ]; then
+    exit 1
+fi
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 disperse 6 redundancy 2 $H0:$B0/${V0}{0..5}
+TEST $CLI volume heal $V0 disable
+TEST $CLI volume start $V0
+
+TEST $GFS --direct-io-mode=yes --volfile-id=/$V0 --volfile-server=$H0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "6" ec_child_up_count $V0 0
+
+TEST dd if=/dev/urandom of=$tmp/data bs=2048 count=64
+cs=$(sha1sum $tmp/data | awk '{ print $1 }')
+
+TEST cp $tmp/data $M0/legacy
+EXPECT "0000080602000200" get_hex_xattr trusted.ec.config $B0/${V0}0/legacy
+
+EXPECT "0" mount_get_option_value $M0 $V0-disperse-0 systematic
+TEST $CLI volume set $V0 disperse.systematic on
+EXPECT_WITHIN $CONFIG_UPDATE_TIMEOUT "1" mount_get_option_value $M0 $V0-disperse-0 systematic
+
+TEST cp $tmp/data $M0/file
+EXPECT "0001080602000200" get_hex_xattr trusted.ec.config $B0/${V0}0/file
+for i in {0..3}; do
+    EXPECT "Y" chunk_matches $tmp/data $i file
+done
+EXPECT "$cs" echo $(sha1sum $M0/file | awk '{ print $1 }')
+EXPECT "$cs" echo $(sha1sum $M0/legacy | awk '{ print $1 }')
+
+# Reading without data bricks needs the parity ones
+TEST kill_brick $V0 $H0 $B0/${V0}0
+TEST kill_brick $V0 $H0 $B0/${V0}2
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "4" ec_child_up_count $V0 0
+EXPECT "$cs" echo $(sha1sum $M0/file | awk '{ print $1 }')
+EXPECT "$cs" echo $(sha1sum $M0/legacy | awk '{ print $1 }')
+TEST cp $tmp/data $M0/new
+
+# Existing files keep their layout when the option is changed, and heal
+# creates missing files with the config of the others
+TEST $CLI volume set $V0 disperse.systematic off
+EXPECT_WITHIN $CONFIG_UPDATE_TIMEOUT "0" mount_get_option_value $M0 $V0-disperse-0 systematic
+EXPECT "$cs" echo $(sha1sum $M0/new | awk '{ print $1 }')
+
+TEST $CLI volume start $V0 force
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "6" ec_child_up_count $V0 0
+TEST $CLI volume heal $V0 enable
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" glustershd_up_status
+TEST $CLI volume heal $V0 full
+EXPECT_WITHIN $HEAL_TIMEOUT "0001080602000200" get_hex_xattr trusted.ec.config $B0/${V0}0/new
+EXPECT_WITHIN $HEAL_TIMEOUT "Y" chunk_matches $tmp/data 0 new
+EXPECT_WITHIN $HEAL_TIMEOUT "Y" chunk_matches $tmp/data 2 new
+
+TEST rm -rf $tmp
+cleanup;
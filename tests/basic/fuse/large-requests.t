@@ -0,0 +1,33 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume start $V0
+
+# 1MB requests spread over per-thread /dev/fuse channels. Older kernels
+# silently fall back to 128KB requests and a shared channel, so only data
+# integrity is checked here.
+TEST $GFS --max-write=1MB --clone-fd=yes --reader-thread-count=4 \
+          --volfile-id=/$V0 --volfile-server=$H0 $M0
+
+TEST dd if=/dev/urandom of=$B0/src bs=1M count=16
+TEST dd if=$B0/src of=$M0/file bs=1M conv=fsync
+TEST cmp $B0/src $M0/file
+for i in {1..8}; do
+    dd if=$M0/file of=/dev/null bs=1M iflag=direct 2>/dev/null &
+done
+wait
+TEST cmp $B0/src $M0/file
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+TEST ! $GFS --max-write=2MB --volfile-id=/$V0 --volfile-server=$H0 $M0
+
+rm -f $B0/src
+cleanup;
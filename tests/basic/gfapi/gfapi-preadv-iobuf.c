@@ -0,0 +1,146 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <glusterfs/api/glfs.h>
+#include <glusterfs/api/glfs-handles.h>
+
+#define VALIDATE_AND_GOTO_LABEL_ON_ERROR(func, ret, label)                     \
+    do {                                                                       \
+        if (ret < 0) {                                                         \
+            fprintf(stderr, "%s : returned error %d (%s)\n", func, ret,        \
+                    strerror(errno));                                          \
+            goto label;                                                        \
+        }                                                                      \
+    } while (0)
+
+#define WRITE_SIZE (128 * 1024)
+#define READ_OFFSET 1000
+
+/* Compare the data returned in a set of buffers with the expected data. */
+static int
+check_data(const char *func, const struct iovec *iov, int iovcnt,
+           const char *expected, size_t size)
+{
+    size_t done = 0;
+    int i;
+
+    for (i = 0; i < iovcnt; i++) {
+        if ((done + iov[i].iov_len > size) ||
+            (memcmp(iov[i].iov_base, expected + done, iov[i].iov_len) != 0)) {
+            fprintf(stderr, "%s : data mismatch\n", func);
+            return -1;
+        }
+        done += iov[i].iov_len;
+    }
+
+    if (done != size) {
+        fprintf(stderr, "%s : got %zu bytes, expected %zu\n", func, done,
+                size);
+        return -1;
+    }
+
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int ret = -1;
+    int flags = O_RDWR | O_SYNC;
+    glfs_t *fs = NULL;
+    glfs_fd_t *fd1 = NULL;
+    glfs_object_t *object = NULL;
+    glfs_iobuf_t *iobuf = NULL;
+    const struct iovec *iov = NULL;
+    int iovcnt = 0;
+    char *volname = NULL;
+    char *logfile = NULL;
+    const char *filename = "file_tmp";
+    static char buff[WRITE_SIZE];
+    struct stat sb;
+    int i;
+
+    if (argc != 3) {
+        fprintf(stderr, "Invalid argument\n");
+        return 1;
+    }
+
+    volname = argv[1];
+    logfile = argv[2];
+
+    for (i = 0; i < WRITE_SIZE; i++)
+        buff[i] = (char)(i * 7);
+
+    fs = glfs_new(volname);
+    if (!fs)
+        VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_new", ret, out);
+
+    ret = glfs_set_volfile_server(fs, "tcp", "localhost", 24007);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_set_volfile_server", ret, out);
+
+    ret = glfs_set_logging(fs, logfile, 7);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_set_logging", ret, out);
+
+    ret = glfs_init(fs);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_init", ret, out);
+
+    fd1 = glfs_creat(fs, filename, flags, 0644);
+    if (fd1 == NULL) {
+        ret = -1;
+        VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_creat", ret, out);
+    }
+
+    ret = glfs_write(fd1, buff, WRITE_SIZE, flags);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_write", ret, out);
+
+    ret = glfs_preadv_iobuf(fd1, WRITE_SIZE, READ_OFFSET, 0, &iobuf, &iov,
+                            &iovcnt, NULL);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_preadv_iobuf", ret, out);
+
+    ret = check_data("glfs_preadv_iobuf", iov, iovcnt, buff + READ_OFFSET,
+                     WRITE_SIZE - READ_OFFSET);
+    glfs_free(iobuf);
+    iobuf = NULL;
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_preadv_iobuf", ret, out);
+
+    /* Reading at EOF returns no buffers. */
+    ret = glfs_preadv_iobuf(fd1, WRITE_SIZE, WRITE_SIZE, 0, &iobuf, &iov,
+                            &iovcnt, NULL);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_preadv_iobuf", ret, out);
+    if ((ret != 0) || (iobuf != NULL) || (iovcnt != 0)) {
+        fprintf(stderr, "glfs_preadv_iobuf : unexpected data at EOF\n");
+        ret = -1;
+        goto out;
+    }
+
+    object = glfs_h_lookupat(fs, NULL, filename, &sb, 0);
+    if (object == NULL) {
+        ret = -1;
+        VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_h_lookupat", ret, out);
+    }
+
+    ret = glfs_h_anonymous_read_iobuf(fs, object, WRITE_SIZE, 0, &iobuf, &iov,
+                                      &iovcnt);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_h_anonymous_read_iobuf", ret, out);
+
+    ret = check_data("glfs_h_anonymous_read_iobuf", iov, iovcnt, buff,
+                     WRITE_SIZE);
+    glfs_free(iobuf);
+    iobuf = NULL;
+
+out:
+    if (object != NULL)
+        glfs_h_close(object);
+    if (fd1 != NULL)
+        glfs_close(fd1);
+    if (fs) {
+        /*
+         * If this fails (as it does on Special Snowflake NetBSD for no
+         * good reason), it shouldn't affect the result of the test.
+         */
+        (void)glfs_fini(fs);
+    }
+
+    return ret;
+}
@@ -0,0 +1,170 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <glusterfs/api/glfs.h>
+
+#define VALIDATE_AND_GOTO_LABEL_ON_ERROR(func, ret, label)                     \
+    do {                                                                       \
+        if (ret < 0) {                                                         \
+            fprintf(stderr, "%s : returned error %d (%s)\n", func, ret,        \
+                    strerror(errno));                                          \
+            goto label;                                                        \
+        }                                                                      \
+    } while (0)
+
+#define WRITE_SIZE (128 * 1024)
+#define WAIT_LOOPS 1000
+
+static volatile int released;
+static volatile int completed;
+
+static void
+release_cbk(void *data)
+{
+    __sync_fetch_and_add(&released, 1);
+}
+
+static void
+write_cbk(glfs_fd_t *fd, ssize_t ret, struct glfs_stat *prestat,
+          struct glfs_stat *poststat, void *data)
+{
+    *(ssize_t *)data = ret;
+    __sync_fetch_and_add(&completed, 1);
+}
+
+/* Release callbacks may be delayed until cached writes are flushed. */
+static int
+wait_for(volatile int *counter, int value)
+{
+    int i;
+
+    for (i = 0; (*counter < value) && (i < WAIT_LOOPS); i++)
+        usleep(10000);
+
+    return (*counter == value) ? 0 : -1;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int ret = -1;
+    int flags = O_RDWR | O_SYNC;
+    glfs_t *fs = NULL;
+    glfs_fd_t *fd1 = NULL;
+    char *volname = NULL;
+    char *logfile = NULL;
+    const char *filename = "file_tmp";
+    static char buff[2 * WRITE_SIZE];
+    static char other[WRITE_SIZE];
+    static char check[2 * WRITE_SIZE];
+    struct iovec iov[2];
+    ssize_t async_ret = 0;
+    int i;
+
+    if (argc != 3) {
+        fprintf(stderr, "Invalid argument\n");
+        return 1;
+    }
+
+    volname = argv[1];
+    logfile = argv[2];
+
+    for (i = 0; i < 2 * WRITE_SIZE; i++)
+        buff[i] = (char)(i * 7);
+
+    fs = glfs_new(volname);
+    if (!fs)
+        VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_new", ret, out);
+
+    ret = glfs_set_volfile_server(fs, "tcp", "localhost", 24007);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_set_volfile_server", ret, out);
+
+    ret = glfs_set_logging(fs, logfile, 7);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_set_logging", ret, out);
+
+    ret = glfs_init(fs);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_init", ret, out);
+
+    ret = glfs_buffer_register(fs, buff, sizeof(buff));
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_buffer_register", ret, out);
+
+    /* Overlapping regions are rejected. */
+    ret = glfs_buffer_register(fs, buff + 1, 1);
+    if ((ret != -1) || (errno != EEXIST)) {
+        fprintf(stderr, "glfs_buffer_register : overlap accepted\n");
+        ret = -1;
+        goto out;
+    }
+
+    fd1 = glfs_creat(fs, filename, flags, 0644);
+    if (fd1 == NULL) {
+        ret = -1;
+        VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_creat", ret, out);
+    }
+
+    iov[0].iov_base = buff;
+    iov[0].iov_len = WRITE_SIZE / 2;
+    iov[1].iov_base = buff + WRITE_SIZE / 2;
+    iov[1].iov_len = WRITE_SIZE / 2;
+
+    ret = glfs_pwritev_registered(fd1, iov, 2, 0, 0, NULL, NULL, release_cbk,
+                                  NULL);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_pwritev_registered", ret, out);
+
+    iov[0].iov_base = buff + WRITE_SIZE;
+    iov[0].iov_len = WRITE_SIZE;
+
+    ret = glfs_pwritev_registered_async(fd1, iov, 1, WRITE_SIZE, 0, write_cbk,
+                                        &async_ret, release_cbk, NULL);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_pwritev_registered_async", ret, out);
+
+    ret = wait_for(&completed, 1);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_pwritev_registered_async", ret, out);
+    ret = async_ret;
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_pwritev_registered_async", ret, out);
+
+    ret = glfs_fsync(fd1, NULL, NULL);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_fsync", ret, out);
+
+    ret = wait_for(&released, 2);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("release_cbk", ret, out);
+
+    /* Memory outside registered regions is refused, but still released. */
+    iov[0].iov_base = other;
+    iov[0].iov_len = sizeof(other);
+
+    ret = glfs_pwritev_registered(fd1, iov, 1, 0, 0, NULL, NULL, release_cbk,
+                                  NULL);
+    if ((ret != -1) || (errno != EINVAL) || (released != 3)) {
+        fprintf(stderr, "glfs_pwritev_registered : unregistered buffer\n");
+        ret = -1;
+        goto out;
+    }
+
+    ret = glfs_pread(fd1, check, sizeof(check), 0, 0, NULL);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_pread", ret, out);
+
+    if ((ret != sizeof(check)) || (memcmp(check, buff, sizeof(check)) != 0)) {
+        fprintf(stderr, "glfs_pread : data mismatch\n");
+        ret = -1;
+        goto out;
+    }
+
+    ret = glfs_buffer_unregister(fs, buff);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_buffer_unregister", ret, out);
+
+out:
+    if (fd1 != NULL)
+        glfs_close(fd1);
+    if (fs) {
+        /*
+         * If this fails (as it does on Special Snowflake NetBSD for no
+         * good reason), it shouldn't affect the result of the test.
+         */
+        (void)glfs_fini(fs);
+    }
+
+    return ret;
+}
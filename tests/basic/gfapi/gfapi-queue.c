@@ -0,0 +1,221 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <glusterfs/api/glfs.h>
+
+#define VALIDATE_AND_GOTO_LABEL_ON_ERROR(func, ret, label)                     \
+    do {                                                                       \
+        if (ret < 0) {                                                         \
+            fprintf(stderr, "%s : returned error %d (%s)\n", func, ret,        \
+                    strerror(errno));                                          \
+            goto label;                                                        \
+        }                                                                      \
+    } while (0)
+
+#define WRITE_SIZE 4096
+#define FILE_COUNT 16
+#define QUEUE_SIZE (2 * FILE_COUNT)
+
+/* Submits the queued requests and waits for all of them, checking that each
+ * one succeeded. */
+static int
+run_queue(const char *func, glfs_queue_t *queue, int count,
+          struct glfs_completion *completions)
+{
+    struct pollfd pfd;
+    int ret;
+    int i;
+
+    ret = glfs_queue_submit(queue);
+    if (ret != count) {
+        fprintf(stderr, "%s : submitted %d of %d\n", func, ret, count);
+        return -1;
+    }
+
+    pfd.fd = glfs_queue_fd(queue);
+    pfd.events = POLLIN;
+    if (poll(&pfd, 1, 60000) != 1) {
+        fprintf(stderr, "%s : no completion notified\n", func);
+        return -1;
+    }
+
+    ret = glfs_queue_reap(queue, completions, count, count);
+    if (ret != count) {
+        fprintf(stderr, "%s : reaped %d of %d\n", func, ret, count);
+        return -1;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (completions[i].ret < 0) {
+            fprintf(stderr, "%s : request %ld failed (%s)\n", func,
+                    (long)(intptr_t)completions[i].data,
+                    strerror(completions[i].op_errno));
+            return -1;
+        }
+    }
+
+    /* Everything has been reaped, so nothing should be pending. */
+    if (poll(&pfd, 1, 0) != 0) {
+        fprintf(stderr, "%s : notification not cleared\n", func);
+        return -1;
+    }
+
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int ret = -1;
+    glfs_t *fs = NULL;
+    glfs_queue_t *queue = NULL;
+    glfs_fd_t *fds[FILE_COUNT] = {};
+    struct glfs_completion completions[QUEUE_SIZE];
+    struct stat st[FILE_COUNT];
+    char *volname = NULL;
+    char *logfile = NULL;
+    char path[64];
+    static char wbuf[WRITE_SIZE];
+    static char rbuf[FILE_COUNT][WRITE_SIZE];
+    char value[16];
+    struct iovec iov;
+    long idx;
+    int i;
+
+    if (argc != 3) {
+        fprintf(stderr, "Invalid argument\n");
+        return 1;
+    }
+
+    volname = argv[1];
+    logfile = argv[2];
+
+    for (i = 0; i < WRITE_SIZE; i++)
+        wbuf[i] = (char)(i * 7);
+
+    fs = glfs_new(volname);
+    if (!fs)
+        VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_new", ret, out);
+
+    ret = glfs_set_volfile_server(fs, "tcp", "localhost", 24007);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_set_volfile_server", ret, out);
+
+    ret = glfs_set_logging(fs, logfile, 7);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_set_logging", ret, out);
+
+    ret = glfs_init(fs);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_init", ret, out);
+
+    queue = glfs_queue_new(fs, QUEUE_SIZE);
+    if (!queue) {
+        ret = -1;
+        VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_queue_new", ret, out);
+    }
+
+    for (i = 0; i < FILE_COUNT; i++) {
+        snprintf(path, sizeof(path), "file%d", i);
+        ret = glfs_queue_creat(queue, path, O_RDWR, 0644,
+                               (void *)(intptr_t)i);
+        VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_queue_creat", ret, out);
+    }
+
+    ret = run_queue("glfs_queue_creat", queue, FILE_COUNT, completions);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_queue_creat", ret, out);
+    for (i = 0; i < FILE_COUNT; i++) {
+        idx = (intptr_t)completions[i].data;
+        fds[idx] = completions[i].fd;
+    }
+
+    iov.iov_base = wbuf;
+    iov.iov_len = WRITE_SIZE;
+    for (i = 0; i < FILE_COUNT; i++) {
+        ret = glfs_queue_pwritev(queue, fds[i], &iov, 1, 0, 0,
+                                 (void *)(intptr_t)i);
+        VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_queue_pwritev", ret, out);
+        ret = glfs_queue_fsync(queue, fds[i], (void *)(intptr_t)i);
+        VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_queue_fsync", ret, out);
+    }
+
+    /* The queue is full now. */
+    ret = glfs_queue_fsync(queue, fds[0], NULL);
+    if ((ret != -1) || (errno != EAGAIN)) {
+        fprintf(stderr, "glfs_queue_fsync : queue overflow accepted\n");
+        ret = -1;
+        goto out;
+    }
+
+    ret = run_queue("glfs_queue_pwritev", queue, QUEUE_SIZE, completions);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_queue_pwritev", ret, out);
+
+    for (i = 0; i < FILE_COUNT; i++) {
+        snprintf(path, sizeof(path), "file%d", i);
+        ret = glfs_queue_stat(queue, path, &st[i], (void *)(intptr_t)i);
+        VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_queue_stat", ret, out);
+
+        iov.iov_base = rbuf[i];
+        iov.iov_len = WRITE_SIZE;
+        ret = glfs_queue_preadv(queue, fds[i], &iov, 1, 0, 0,
+                                (void *)(intptr_t)i);
+        VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_queue_preadv", ret, out);
+    }
+
+    ret = run_queue("glfs_queue_preadv", queue, QUEUE_SIZE, completions);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_queue_preadv", ret, out);
+
+    for (i = 0; i < FILE_COUNT; i++) {
+        if ((st[i].st_size != WRITE_SIZE) ||
+            (memcmp(rbuf[i], wbuf, WRITE_SIZE) != 0)) {
+            fprintf(stderr, "glfs_queue_preadv : data mismatch\n");
+            ret = -1;
+            goto out;
+        }
+    }
+
+    /* Failures are reported in the completion. */
+    ret = glfs_queue_getxattr(queue, "file0", "user.missing", value,
+                              sizeof(value), NULL);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_queue_getxattr", ret, out);
+    glfs_queue_submit(queue);
+    ret = glfs_queue_reap(queue, completions, 1, 1);
+    if ((ret != 1) || (completions[0].ret != -1) ||
+        (completions[0].op_errno != ENODATA)) {
+        fprintf(stderr, "glfs_queue_getxattr : unexpected result\n");
+        ret = -1;
+        goto out;
+    }
+
+    for (i = 0; i < FILE_COUNT; i++) {
+        glfs_close(fds[i]);
+        fds[i] = NULL;
+
+        snprintf(path, sizeof(path), "file%d", i);
+        ret = glfs_queue_unlink(queue, path, (void *)(intptr_t)i);
+        VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_queue_unlink", ret, out);
+    }
+
+    ret = run_queue("glfs_queue_unlink", queue, FILE_COUNT, completions);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_queue_unlink", ret, out);
+
+    ret = glfs_queue_destroy(queue);
+    queue = NULL;
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_queue_destroy", ret, out);
+
+out:
+    if (queue)
+        glfs_queue_destroy(queue);
+    for (i = 0; i < FILE_COUNT; i++) {
+        if (fds[i])
+            glfs_close(fds[i]);
+    }
+    if (fs) {
+        /*
+         * If this fails (as it does on Special Snowflake NetBSD for no
+         * good reason), it shouldn't affect the result of the test.
+         */
+        (void)glfs_fini(fs);
+    }
+
+    return ret;
+}
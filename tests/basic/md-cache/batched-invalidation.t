@@ -0,0 +1,57 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+function xattr_value {
+        getfattr --only-values -n user.attr $1 2>/dev/null
+}
+
+cleanup;
+
+TEST glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}{1,2}
+TEST $CLI volume set $V0 performance.md-cache-timeout 600
+TEST $CLI volume set $V0 performance.xattr-cache-list "user.*"
+TEST $CLI volume set $V0 performance.cache-invalidation on
+TEST $CLI volume set $V0 features.cache-invalidation on
+TEST $CLI volume set $V0 features.cache-invalidation-timeout 600
+TEST $CLI volume set $V0 features.cache-invalidation-batch-window 100
+EXPECT '100' volinfo_field $V0 'features.cache-invalidation-batch-window'
+TEST $CLI volume start $V0
+
+TEST glusterfs --volfile-id=/$V0 --volfile-server=$H0 $M0
+TEST glusterfs --volfile-id=/$V0 --volfile-server=$H0 $M1
+
+# Cache the attributes of lots of files in M1, so that the invalidations
+# caused by M0 are queued and sent in batches.
+TEST mkdir $M0/dir
+for i in {1..300}; do
+        echo -n "$i" > $M0/dir/file$i
+        setfattr -n user.attr -v "old" $M0/dir/file$i
+done
+for i in {1..300}; do
+        xattr_value $M1/dir/file$i >/dev/null
+        stat $M1/dir/file$i >/dev/null
+done
+EXPECT "old" xattr_value $M1/dir/file1
+
+# Several changes of the same file in a window are merged: M1 sees the last
+# ones only.
+for i in {1..300}; do
+        setfattr -n user.attr -v "new" $M0/dir/file$i
+        truncate -s 10 $M0/dir/file$i
+        setfattr -n user.attr -v "last" $M0/dir/file$i
+done
+EXPECT_WITHIN $MDC_TIMEOUT "last" xattr_value $M1/dir/file1
+EXPECT_WITHIN $MDC_TIMEOUT "last" xattr_value $M1/dir/file150
+EXPECT_WITHIN $MDC_TIMEOUT "last" xattr_value $M1/dir/file300
+EXPECT_WITHIN $MDC_TIMEOUT "10" stat -c %s $M1/dir/file300
+
+# Without a window each invalidation is sent right away again.
+TEST $CLI volume set $V0 features.cache-invalidation-batch-window 0
+TEST setfattr -n user.attr -v "unbatched" $M0/dir/file1
+EXPECT_WITHIN $MDC_TIMEOUT "unbatched" xattr_value $M1/dir/file1
+
+cleanup;
@@ -0,0 +1,111 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+# With storage.linux-io_uring, reads, writes, fsyncs, fallocates, opens,
+# stats and plain xattrs of the brick are sent through the io_uring engine
+# of the process, when the kernel supports them. Reads into the iobuf arenas
+# registered with the kernel use fixed buffers.
+
+function uring_count
+{
+    local dump=$1
+    local fop=$2
+
+    grep "^io_uring.$fop=" $dump | sed 's/^.*CNT:\([0-9]*\).*$/\1/'
+}
+
+function uring_fixed_count
+{
+    local dump=$1
+    local fop=$2
+
+    grep "^io_uring.$fop=" $dump | sed 's/^.*FIXED:\([0-9]*\).*$/\1/'
+}
+
+# Registering the arenas needs enough locked memory. If it's not possible,
+# no request uses fixed buffers.
+function uring_fixed_check
+{
+    local dump=$1
+    local arenas=$(grep "^iobuf_pool.fixed_cnt=" $dump | cut -d= -f2)
+
+    if [ "$arenas" -gt 0 ]; then
+        [ $(uring_fixed_count $dump READ) -ge 1 ] && echo "Y"
+    else
+        [ "$(uring_fixed_count $dump READ)" == "0" ] &&
+            [ "$(uring_fixed_count $dump WRITE)" == "0" ] && echo "Y"
+    fi
+}
+
+cleanup
+
+tmp=`mktemp -p ${LOGDIR} -d -t ${0##*/}.XXXXXX`
+if [ ! -d $tmp ]; then
+    exit 1
+fi
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 storage.linux-io_uring on
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.open-behind off
+TEST $CLI volume set $V0 performance.stat-prefetch off
+TEST $CLI volume start $V0
+
+# The brick only uses io_uring when the kernel supports it
+dump=$(generate_brick_statedump $V0 $H0 $B0/${V0}0)
+if ! grep -q "^io_uring_capable=1" $dump; then
+    cleanup
+    SKIP_TESTS
+    exit 0
+fi
+
+TEST $GFS --direct-io-mode=yes --attribute-timeout=0 --volfile-id=/$V0 --volfile-server=$H0 $M0
+
+TEST dd if=/dev/urandom of=$tmp/data bs=128k count=32
+cs=$(sha1sum $tmp/data | awk '{ print $1 }')
+
+TEST dd if=$tmp/data of=$M0/file bs=128k conv=fsync
+EXPECT "$cs" echo $(sha1sum $B0/${V0}0/file | awk '{ print $1 }')
+EXPECT "$cs" echo $(sha1sum $M0/file | awk '{ print $1 }')
+
+# Partial and unaligned writes past the end of the file
+TEST dd if=$tmp/data of=$M0/file bs=1000 count=7 seek=4500 conv=notrunc,fsync
+TEST dd if=$tmp/data of=$tmp/data bs=1000 count=7 seek=4500 conv=notrunc
+cs=$(sha1sum $tmp/data | awk '{ print $1 }')
+EXPECT "$cs" echo $(sha1sum $M0/file | awk '{ print $1 }')
+
+dump=$(generate_brick_statedump $V0 $H0 $B0/${V0}0)
+TEST [ $(uring_count $dump WRITE) -ge 32 ]
+TEST [ $(uring_count $dump READ) -ge 1 ]
+TEST [ $(uring_count $dump FSYNC) -ge 2 ]
+TEST [ $(uring_count $dump OPEN) -ge 1 ]
+
+# Metadata fops give the same answers as the synchronous ones
+TEST stat $M0/file
+EXPECT "$(stat -c %s $B0/${V0}0/file)" stat -c %s $M0/file
+TEST fallocate -l 8M $M0/file3
+EXPECT "8388608" stat -c %s $B0/${V0}0/file3
+TEST setfattr -n user.io-uring -v value $M0/file
+EXPECT "value" echo $(getfattr --only-values -n user.io-uring $M0/file)
+EXPECT "value" echo $(getfattr --only-values -n user.io-uring $B0/${V0}0/file)
+
+dump=$(generate_brick_statedump $V0 $H0 $B0/${V0}0)
+TEST [ $(uring_count $dump STAT) -ge 1 ]
+TEST [ $(uring_count $dump FALLOCATE) -ge 1 ]
+
+EXPECT "Y" uring_fixed_check $dump
+
+# Turning the option off goes back to the synchronous fops
+TEST $CLI volume set $V0 storage.linux-io_uring off
+TEST dd if=$tmp/data of=$M0/file2 bs=128k conv=fsync
+EXPECT "$cs" echo $(sha1sum $M0/file2 | awk '{ print $1 }')
+
+TEST rm -rf $tmp
+cleanup;
@@ -0,0 +1,177 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <glusterfs/api/glfs.h>
+
+#define VALIDATE_AND_GOTO_LABEL_ON_ERROR(func, ret, label)                     \
+    do {                                                                       \
+        if (ret < 0) {                                                         \
+            fprintf(stderr, "%s : returned error %d (%s)\n", func, ret,        \
+                    strerror(errno));                                          \
+            goto label;                                                        \
+        }                                                                      \
+    } while (0)
+
+#define FILE_SIZE (256 * 1024)
+#define MAX_IO_SIZE (16 * 1024)
+#define ROUNDS 20000
+
+static char model[FILE_SIZE + MAX_IO_SIZE];
+static char buff[FILE_SIZE + MAX_IO_SIZE];
+static size_t model_size;
+
+/* Read back a range and compare it with what has been written to it, while
+ * the writes may still be held by write-behind. */
+static int
+check_range(glfs_fd_t *fd, off_t offset, size_t size)
+{
+    size_t expected = 0;
+    ssize_t ret;
+
+    if (offset < model_size)
+        expected = model_size - offset;
+    if (expected > size)
+        expected = size;
+
+    ret = glfs_pread(fd, buff, size, offset, 0, NULL);
+    if (ret < 0) {
+        fprintf(stderr, "glfs_pread : returned error (%s)\n", strerror(errno));
+        return -1;
+    }
+
+    if ((ret != expected) || (memcmp(buff, model + offset, ret) != 0)) {
+        fprintf(stderr,
+                "read of %zu bytes at %lld: got %zd bytes, expected %zu, "
+                "data %s\n",
+                size, (long long)offset, ret, expected,
+                memcmp(buff, model + offset, ret) ? "differs" : "matches");
+        return -1;
+    }
+
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int ret = -1;
+    glfs_t *fs = NULL;
+    glfs_fd_t *fd = NULL;
+    char *volname = NULL;
+    char *logfile = NULL;
+    const char *filename = "file_tmp";
+    off_t offset;
+    size_t size;
+    int i, j;
+
+    if (argc != 3) {
+        fprintf(stderr, "Invalid argument\n");
+        return 1;
+    }
+
+    volname = argv[1];
+    logfile = argv[2];
+
+    srandom(884);
+
+    fs = glfs_new(volname);
+    if (!fs)
+        VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_new", ret, out);
+
+    ret = glfs_set_volfile_server(fs, "tcp", "localhost", 24007);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_set_volfile_server", ret, out);
+
+    ret = glfs_set_logging(fs, logfile, 7);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_set_logging", ret, out);
+
+    ret = glfs_init(fs);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_init", ret, out);
+
+    fd = glfs_creat(fs, filename, O_RDWR | O_TRUNC, 0644);
+    if (!fd) {
+        ret = -1;
+        VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_creat", ret, out);
+    }
+
+    /* A write held past a read makes the file longer than the server knows
+     * it: the read mustn't stop at the end of the writes it overlaps. */
+    for (j = 0; j < 100; j++) {
+        model[j] = random();
+        model[8192 + j] = random();
+    }
+    ret = glfs_pwrite(fd, model, 100, 0, 0, NULL, NULL);
+    if (ret != 100) {
+        ret = -1;
+        VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_pwrite", ret, out);
+    }
+    ret = glfs_pwrite(fd, model + 8192, 100, 8192, 0, NULL, NULL);
+    if (ret != 100) {
+        ret = -1;
+        VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_pwrite", ret, out);
+    }
+    model_size = 8192 + 100;
+
+    ret = check_range(fd, 0, 4096);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("check_range", ret, out);
+
+    for (i = 0; i < ROUNDS; i++) {
+        offset = random() % FILE_SIZE;
+        size = 1 + random() % MAX_IO_SIZE;
+
+        switch (random() % 4) {
+            case 0:
+            case 1:
+                /* Write a range and read it back right away. */
+                for (j = 0; j < size; j++)
+                    model[offset + j] = random();
+                ret = glfs_pwrite(fd, model + offset, size, offset, 0, NULL,
+                                  NULL);
+                if (ret != size) {
+                    ret = -1;
+                    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_pwrite", ret, out);
+                }
+                if (model_size < offset + size)
+                    model_size = offset + size;
+
+                ret = check_range(fd, offset, size);
+                break;
+            case 2:
+                /* A read partially covered by the pending writes. */
+                ret = check_range(fd, offset, size);
+                break;
+            default:
+                if (random() % 8 == 0) {
+                    ret = glfs_fsync(fd, NULL, NULL);
+                    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_fsync", ret, out);
+                }
+                ret = 0;
+                break;
+        }
+        if (ret < 0)
+            goto out;
+    }
+
+    ret = glfs_close(fd);
+    fd = NULL;
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_close", ret, out);
+
+    /* Everything has to have made it to the bricks. */
+    fd = glfs_open(fs, filename, O_RDONLY);
+    if (!fd) {
+        ret = -1;
+        VALIDATE_AND_GOTO_LABEL_ON_ERROR("glfs_open", ret, out);
+    }
+
+    ret = check_range(fd, 0, FILE_SIZE + MAX_IO_SIZE);
+    VALIDATE_AND_GOTO_LABEL_ON_ERROR("check_range", ret, out);
+
+out:
+    if (fd)
+        glfs_close(fd);
+
+    if (fs)
+        glfs_fini(fs);
+
+    return ret ? 1 : 0;
+}
@@ -0,0 +1,33 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+cleanup;
+
+TEST glusterd
+
+TEST $CLI volume create $V0 ${H0}:$B0/brick1;
+EXPECT 'Created' volinfo_field $V0 'Status';
+
+# Let the reads reach write-behind.
+TEST $CLI volume set $V0 performance.write-behind on
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.read-ahead off
+
+TEST $CLI volume start $V0;
+EXPECT 'Started' volinfo_field $V0 'Status';
+
+logdir=`gluster --print-logdir`
+
+TEST build_tester $(dirname $0)/read-pending-writes.c -lgfapi
+
+TEST ./$(dirname $0)/read-pending-writes $V0 $logdir/read-pending-writes.log
+
+cleanup_tester $(dirname $0)/read-pending-writes
+
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
@@ -0,0 +1,42 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+
+cleanup;
+
+# Every code generator of cluster/disperse the cpu supports has to encode the
+# same fragments as the C code, for both layouts, and the data has to be
+# decoded back from any set of fragments enough to rebuild it, also when
+# several threads share the work.
+bm=$(dirname $0)/../../extras/benchmarking/ec-method-bm
+ec=$(dirname $0)/../../xlators/cluster/ec/src
+
+# Only the generators configure enabled are built, as for cluster/disperse
+gens=""
+for gen in X64 SSE AVX AVX512; do
+    if grep -q "^#define USE_EC_DYNAMIC_$gen 1" \
+       $(dirname $0)/../../config.h; then
+        gens="$gens $ec/ec-code-${gen,,}.c"
+    fi
+done
+if [ -z "$gens" ]; then
+    SKIP_TESTS
+    exit 0
+fi
+
+TEST build_tester $bm.c $ec/ec-method.c $ec/ec-galois.c $ec/ec-code.c \
+     $ec/ec-code-c.c $ec/ec-gf8.c $ec/ec-code-intel.c $gens -O2 \
+     -lglusterfs -luuid -lpthread -D_GNU_SOURCE -DGF_LINUX_HOST_OS \
+     -D_FILE_OFFSET_BITS=64 -DGLUSTERFS_LIBEXECDIR=\'\"$B0\"\' \
+     -I$ec -I$(dirname $0)/../../libglusterfs/src \
+     -I$(dirname $0)/../../xlators/lib/src \
+     -I$(dirname $0)/../../rpc/rpc-lib/src -I$(dirname $0)/../../rpc/xdr/src \
+     -include $(dirname $0)/../../config.h
+
+TEST mkdir -p $B0
+TEST $bm -s 4
+TEST $bm -s 4 -t 4 4+2 8+3 16+4
+
+cleanup_tester $bm
+
+cleanup;
@@ -0,0 +1,504 @@
+/*
+  Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+  This file is part of GlusterFS.
+
+  This file is licensed to you under your choice of the GNU Lesser
+  General Public License, version 3 or any later version (LGPLv3 or
+  later), or the GNU General Public License, version 2 (GPLv2), in all
+  cases as published by the Free Software Foundation.
+*/
+
+/* Pending-heal store of features/index. Given a number of entries, the harness
+ * marks that many files and directories as pending heal, some of them needing
+ * a data heal, through xattrops, and then marks half of them as healed. It
+ * checks that the count, the readdir by priority and the readdirs of each part
+ * of the xattrop index match the directory. Without a number of entries, it
+ * only checks the index it finds, as loaded again from the log. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <semaphore.h>
+
+#include <glusterfs/glusterfs.h>
+#include <glusterfs/globals.h>
+#include <glusterfs/mem-pool.h>
+#include <glusterfs/iobuf.h>
+#include <glusterfs/stack.h>
+#include <glusterfs/call-stub.h>
+#include <glusterfs/xlator.h>
+#include <glusterfs/inode.h>
+#include <glusterfs/fd.h>
+#include <glusterfs/gf-dirent.h>
+
+#include "xlator-harness.h"
+
+#define PENDING_KEY "trusted.afr.test-client-1"
+#define READDIR_SIZE (128 * 1024)
+#define WAIT_SECS 30
+#define PARTS 4
+
+/* The kind of an entry is in the first byte of its gfid, so that it's known
+ * again after a restart. */
+#define KIND_FILE 0x80
+#define KIND_DATA 0x40
+
+static const char volfile[] =
+    "volume sink\n"
+    "    type debug/sink\n"
+    "    option volume-id sink\n"
+    "end-volume\n"
+    "volume index\n"
+    "    type features/index\n"
+    "    option index-base %s\n"
+    "    option xattrop-pending-watchlist trusted.afr.test-\n"
+    "    subvolumes sink\n"
+    "end-volume\n";
+
+static glusterfs_ctx_t *ctx;
+static struct xlator_fops sink_fops;
+static xlator_t *index_xl;
+static inode_table_t *table;
+static sem_t done;
+
+static int32_t reply_ret;
+static int32_t reply_errno;
+static dict_t *reply_dict;
+static gf_dirent_t reply_entries;
+static long reply_count;
+static off_t reply_off;
+static uint32_t reply_parts;
+
+/* AFR pending counters: data, metadata and entry */
+static char data_pending[12] = {0, 0, 0, 1, 0, 0, 0, 1};
+static char metadata_pending[12] = {0, 0, 0, 0, 0, 0, 0, 1};
+static char no_pending[12];
+
+static int32_t
+sink_xattrop(call_frame_t *frame, xlator_t *this, loc_t *loc,
+             gf_xattrop_flags_t flags, dict_t *dict, dict_t *xdata)
+{
+    STACK_UNWIND_STRICT(xattrop, frame, 0, 0, dict, NULL);
+
+    return 0;
+}
+
+static int32_t
+xattrop_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+            int32_t op_errno, dict_t *dict, dict_t *xdata)
+{
+    reply_ret = op_ret;
+    reply_errno = op_errno;
+    STACK_DESTROY(frame->root);
+    sem_post(&done);
+
+    return 0;
+}
+
+static int32_t
+getxattr_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+             int32_t op_errno, dict_t *dict, dict_t *xdata)
+{
+    reply_ret = op_ret;
+    reply_errno = op_errno;
+    reply_dict = dict ? dict_ref(dict) : NULL;
+    STACK_DESTROY(frame->root);
+    sem_post(&done);
+
+    return 0;
+}
+
+static int32_t
+opendir_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+            int32_t op_errno, fd_t *fd, dict_t *xdata)
+{
+    reply_ret = op_ret;
+    reply_errno = op_errno;
+    STACK_DESTROY(frame->root);
+    sem_post(&done);
+
+    return 0;
+}
+
+static int32_t
+readdir_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+            int32_t op_errno, gf_dirent_t *entries, dict_t *xdata)
+{
+    gf_dirent_t *entry;
+    gf_dirent_t *tmp;
+
+    reply_ret = op_ret;
+    reply_errno = op_errno;
+    reply_count = 0;
+    if (!xdata || dict_get_uint32(xdata, GF_INDEX_PARTITIONS, &reply_parts))
+        reply_parts = 0;
+    if (op_ret > 0) {
+        list_for_each_entry_safe(entry, tmp, &entries->list, list)
+        {
+            reply_off = entry->d_off;
+            if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+                continue;
+            list_del_init(&entry->list);
+            list_add_tail(&entry->list, &reply_entries.list);
+            reply_count++;
+        }
+    }
+    STACK_DESTROY(frame->root);
+    sem_post(&done);
+
+    return 0;
+}
+
+static call_frame_t *
+new_frame(void)
+{
+    call_frame_t *frame;
+
+    frame = create_frame(THIS, ctx->pool);
+    if (frame == NULL) {
+        fprintf(stderr, "create_frame() failed\n");
+        exit(1);
+    }
+
+    return frame;
+}
+
+static void
+check(const char *fop)
+{
+    sem_wait(&done);
+    if (reply_ret < 0) {
+        fprintf(stderr, "%s failed: %s\n", fop, strerror(reply_errno));
+        exit(1);
+    }
+}
+
+static void
+xattrop(inode_t *inode, char *value)
+{
+    loc_t loc = {
+        .inode = inode,
+    };
+    dict_t *dict;
+
+    gf_uuid_copy(loc.gfid, inode->gfid);
+    dict = dict_new();
+    if ((dict == NULL) || dict_set_static_bin(dict, PENDING_KEY, value, 12)) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+
+    STACK_WIND(new_frame(), xattrop_cbk, index_xl, index_xl->fops->xattrop,
+               &loc, GF_XATTROP_ADD_ARRAY, dict, NULL);
+    check("xattrop");
+    dict_unref(dict);
+}
+
+static dict_t *
+index_getxattr(inode_t *inode, const char *name)
+{
+    loc_t loc = {
+        .inode = inode,
+    };
+
+    gf_uuid_copy(loc.gfid, inode->gfid);
+    STACK_WIND(new_frame(), getxattr_cbk, index_xl, index_xl->fops->getxattr,
+               &loc, name, NULL);
+    check("getxattr");
+
+    return reply_dict;
+}
+
+static uint64_t
+index_count(inode_t *root)
+{
+    dict_t *dict;
+    uint64_t count = 0;
+
+    dict = index_getxattr(root, GF_XATTROP_INDEX_COUNT);
+    if ((dict == NULL) ||
+        dict_get_uint64(dict, GF_XATTROP_INDEX_COUNT, &count)) {
+        fprintf(stderr, "no index count\n");
+        exit(1);
+    }
+    dict_unref(dict);
+
+    return count;
+}
+
+static fd_t *
+index_open(inode_t *root)
+{
+    loc_t loc = {
+        0,
+    };
+    inode_t *inode;
+    dict_t *dict;
+    void *vgfid;
+    fd_t *fd;
+
+    dict = index_getxattr(root, GF_XATTROP_INDEX_GFID);
+    if ((dict == NULL) || dict_get_bin(dict, GF_XATTROP_INDEX_GFID, &vgfid)) {
+        fprintf(stderr, "no index gfid\n");
+        exit(1);
+    }
+    inode = inode_new(table);
+    if (inode == NULL)
+        exit(1);
+    gf_uuid_copy(inode->gfid, vgfid);
+    inode->ia_type = IA_IFDIR;
+    dict_unref(dict);
+
+    fd = fd_create(inode, getpid());
+    if (fd == NULL)
+        exit(1);
+    loc.inode = inode;
+    gf_uuid_copy(loc.gfid, inode->gfid);
+    STACK_WIND(new_frame(), opendir_cbk, index_xl, index_xl->fops->opendir,
+               &loc, fd, NULL);
+    check("opendir");
+
+    return fd;
+}
+
+/* Reads the whole index into reply_entries, by priority or not, or only the
+ * part of it given when the index is split in parts. */
+static long
+index_read(fd_t *fd, gf_boolean_t by_priority, uint32_t part, uint32_t parts)
+{
+    dict_t *xdata = NULL;
+    off_t off = 0;
+    long count = 0;
+
+    if (by_priority || parts) {
+        xdata = dict_new();
+        if (xdata == NULL)
+            exit(1);
+    }
+    if (by_priority && dict_set_int32(xdata, GF_INDEX_BY_PRIORITY, 1))
+        exit(1);
+    if (parts && (dict_set_uint32(xdata, GF_INDEX_PARTITION, part) ||
+                  dict_set_uint32(xdata, GF_INDEX_PARTITIONS, parts)))
+        exit(1);
+
+    INIT_LIST_HEAD(&reply_entries.list);
+    for (;;) {
+        STACK_WIND(new_frame(), readdir_cbk, index_xl, index_xl->fops->readdir,
+                   fd, READDIR_SIZE, off, xdata);
+        check("readdir");
+        if (reply_parts != parts) {
+            fprintf(stderr, "index split in %u parts, expected %u\n",
+                    reply_parts, parts);
+            exit(1);
+        }
+        if (reply_ret == 0)
+            break;
+        count += reply_count;
+        off = reply_off;
+    }
+
+    if (xdata)
+        dict_unref(xdata);
+
+    return count;
+}
+
+static int
+entry_rank(gf_dirent_t *entry)
+{
+    uuid_t gfid;
+
+    if (gf_uuid_parse(entry->d_name, gfid)) {
+        fprintf(stderr, "unexpected entry %s\n", entry->d_name);
+        exit(1);
+    }
+
+    return ((gfid[0] & KIND_FILE) ? 2 : 0) + ((gfid[0] & KIND_DATA) ? 1 : 0);
+}
+
+/* Both readdirs must return the same entries, as must the parts of the index
+ * read one by one, and the one by priority the directories first and the
+ * entries needing a data heal last. */
+static int
+verify(inode_t *root, long expected, gf_boolean_t quiet)
+{
+    gf_dirent_t *entry;
+    fd_t *fd;
+    uint64_t count;
+    long plain;
+    long sorted;
+    long split = 0;
+    uint32_t part;
+    int rank = 0;
+    int ret = -1;
+
+    fd = index_open(root);
+
+    plain = index_read(fd, _gf_false, 0, 0);
+    if ((expected >= 0) && (plain != expected)) {
+        if (!quiet)
+            fprintf(stderr, "%ld entries in the index, expected %ld\n",
+                    plain, expected);
+        goto out;
+    }
+    count = index_count(root);
+    if (count != plain) {
+        if (!quiet)
+            fprintf(stderr,
+                    "index count is %" PRIu64 ", %ld entries in it\n", count,
+                    plain);
+        goto out;
+    }
+    gf_dirent_free(&reply_entries);
+
+    sorted = index_read(fd, _gf_true, 0, 0);
+    list_for_each_entry(entry, &reply_entries.list, list)
+    {
+        if (entry_rank(entry) < rank) {
+            if (!quiet)
+                fprintf(stderr, "%s out of order\n", entry->d_name);
+            goto out;
+        }
+        rank = entry_rank(entry);
+    }
+    if (sorted != plain) {
+        if (!quiet)
+            fprintf(stderr, "%ld entries by priority, %ld in the index\n",
+                    sorted, plain);
+        goto out;
+    }
+    gf_dirent_free(&reply_entries);
+
+    for (part = 0; part < PARTS; part++) {
+        split += index_read(fd, part % 2, part, PARTS);
+        gf_dirent_free(&reply_entries);
+    }
+    if (split != plain) {
+        if (!quiet)
+            fprintf(stderr, "%ld entries in %d parts, %ld in the index\n",
+                    split, PARTS, plain);
+        goto out;
+    }
+
+    ret = 0;
+out:
+    gf_dirent_free(&reply_entries);
+    fd_unref(fd);
+
+    return ret;
+}
+
+static void
+graph_prepare(xlator_t *top)
+{
+    xlator_t *sink = FIRST_CHILD(top);
+
+    sink_fops = *sink->fops;
+    sink_fops.xattrop = sink_xattrop;
+    sink->fops = &sink_fops;
+}
+
+static inode_t *
+new_inode(long i)
+{
+    inode_t *inode;
+
+    inode = inode_new(table);
+    if (inode == NULL)
+        exit(1);
+    gf_uuid_generate(inode->gfid);
+    inode->gfid[0] = (i % 2) ? KIND_DATA : 0;
+    if (i % 10) {
+        inode->gfid[0] |= KIND_FILE;
+        inode->ia_type = IA_IFREG;
+    } else {
+        inode->ia_type = IA_IFDIR;
+    }
+
+    return inode;
+}
+
+int
+main(int argc, char *argv[])
+{
+    inode_t **inodes;
+    inode_t *root;
+    uint64_t existing;
+    char *volume;
+    long count = -1;
+    long healed = 0;
+    long i;
+    int retries;
+
+    if ((argc != 2) && (argc != 3)) {
+        fprintf(stderr, "usage: %s <index-base> [<entries>]\n", argv[0]);
+        return 1;
+    }
+    if (argc == 3) {
+        count = atol(argv[2]);
+        if (count <= 0) {
+            fprintf(stderr, "invalid number of entries: %s\n", argv[2]);
+            return 1;
+        }
+    }
+
+    ctx = harness_ctx_new();
+    if ((ctx == NULL) || (asprintf(&volume, volfile, argv[1]) < 0)) {
+        fprintf(stderr, "failed to initialize the context\n");
+        return 1;
+    }
+    index_xl = harness_graph_new(ctx, volume, "index", graph_prepare);
+    free(volume);
+    if (index_xl == NULL) {
+        fprintf(stderr, "failed to initialize the graph\n");
+        return 1;
+    }
+
+    sem_init(&done, 0, 0);
+    table = inode_table_new(0, index_xl, 0, 0);
+    if (table == NULL)
+        return 1;
+    root = inode_new(table);
+    if (root == NULL)
+        return 1;
+    root->gfid[15] = 1;
+    root->ia_type = IA_IFDIR;
+
+    /* The pending store is used once it has been checked against the
+     * directory, the readdir by priority being in directory order until
+     * then. */
+    for (retries = WAIT_SECS * 10; verify(root, -1, retries > 0); retries--) {
+        if (!retries)
+            return 1;
+        usleep(100000);
+    }
+    if (count < 0)
+        return 0;
+    existing = index_count(root);
+
+    inodes = calloc(count, sizeof(*inodes));
+    if (inodes == NULL)
+        return 1;
+    for (i = 0; i < count; i++) {
+        inodes[i] = new_inode(i);
+        /* Entries needing a data heal often had a metadata one first */
+        xattrop(inodes[i], metadata_pending);
+        if (i % 2)
+            xattrop(inodes[i], data_pending);
+    }
+    if (verify(root, existing + count, _gf_false))
+        return 1;
+
+    /* Some directories and files with and without data to heal remain */
+    for (i = 0; i < count; i++) {
+        if (i % 4 < 2) {
+            xattrop(inodes[i], no_pending);
+            healed++;
+        }
+    }
+    if (verify(root, existing + count - healed, _gf_false))
+        return 1;
+
+    return 0;
+}
@@ -0,0 +1,18 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+
+cleanup;
+
+# The xattrop index has to be counted and read by priority from its pending
+# store, after 100k entries were marked as pending heal and half of them as
+# healed, and again once loaded back from the log by another process.
+TEST build_harness $(dirname $0)/index-pending.c
+
+TEST mkdir -p $B0/indices-parent
+TEST $(dirname $0)/index-pending $B0/indices-parent/indices 100000
+TEST $(dirname $0)/index-pending $B0/indices-parent/indices
+
+cleanup_tester $(dirname $0)/index-pending
+
+cleanup;
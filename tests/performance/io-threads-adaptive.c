@@ -0,0 +1,250 @@
+/*
+  Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+  This file is part of GlusterFS.
+
+  This file is licensed to you under your choice of the GNU Lesser
+  General Public License, version 3 or any later version (LGPLv3 or
+  later), or the GNU General Public License, version 2 (GPLv2), in all
+  cases as published by the Free Software Foundation.
+*/
+
+/* Threads of io-threads with adaptive-threads on. Stat fops, each one taking
+ * the sink a millisecond to answer, are sent with lots of them in flight,
+ * while the high priority starts with a single thread. The harness prints the
+ * average latency of each second along with the threads the high priority is
+ * allowed and the ones running, and fails if io-threads didn't allow it more
+ * threads than it started with, and start them, to drain its queue. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <semaphore.h>
+
+#include <glusterfs/glusterfs.h>
+#include <glusterfs/globals.h>
+#include <glusterfs/mem-pool.h>
+#include <glusterfs/iobuf.h>
+#include <glusterfs/stack.h>
+#include <glusterfs/call-stub.h>
+#include <glusterfs/xlator.h>
+#include <glusterfs/inode.h>
+
+#include "xlator-harness.h"
+#include "io-threads.h"
+
+#define INFLIGHT 32
+#define SERVICE_USECS 1000
+
+static const char volfile[] =
+    "volume sink\n"
+    "    type debug/sink\n"
+    "    option volume-id sink\n"
+    "end-volume\n"
+    "volume iot\n"
+    "    type performance/io-threads\n"
+    "    option thread-count 32\n"
+    "    option high-prio-threads 1\n"
+    "    option adaptive-threads on\n"
+    "    option adaptive-target-wait 5\n"
+    "    subvolumes sink\n"
+    "end-volume\n";
+
+static glusterfs_ctx_t *ctx;
+static struct xlator_fops sink_fops;
+static xlator_t *iot;
+static inode_t *inode;
+static sem_t inflight;
+
+static long replies;
+static long latency; /* in usecs */
+
+/* Threads the high priority is allowed, as shown in the statedump */
+static int32_t
+high_limit(void)
+{
+    iot_conf_t *conf = iot->private;
+    iot_queue_t *queue = &conf->queues[GF_FOP_PRI_HI];
+    int32_t limit;
+
+    pthread_mutex_lock(&queue->lock);
+    limit = conf->ac_iot_limit[GF_FOP_PRI_HI];
+    pthread_mutex_unlock(&queue->lock);
+
+    return limit;
+}
+
+/* Threads running, as shown in the statedump */
+static int32_t
+threads(void)
+{
+    iot_conf_t *conf = iot->private;
+    int32_t count;
+
+    pthread_mutex_lock(&conf->mutex);
+    count = conf->curr_count;
+    pthread_mutex_unlock(&conf->mutex);
+
+    return count;
+}
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int32_t
+sink_stat(call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xdata)
+{
+    struct iatt buf = {
+        0,
+    };
+
+    usleep(SERVICE_USECS);
+    STACK_UNWIND_STRICT(stat, frame, 0, 0, &buf, NULL);
+
+    return 0;
+}
+
+static int32_t
+stat_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+         int32_t op_errno, struct iatt *buf, dict_t *xdata)
+{
+    double *start = frame->local;
+
+    if (op_ret != 0) {
+        fprintf(stderr, "stat failed: %s\n", strerror(op_errno));
+        exit(1);
+    }
+
+    frame->local = NULL;
+    __atomic_add_fetch(&replies, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&latency, (now() - *start) * 1e6, __ATOMIC_RELAXED);
+    free(start);
+    STACK_DESTROY(frame->root);
+    sem_post(&inflight);
+
+    return 0;
+}
+
+static void
+stat_one(void)
+{
+    loc_t loc = {
+        .inode = inode,
+    };
+    call_frame_t *frame;
+    double *start;
+
+    gf_uuid_copy(loc.gfid, inode->gfid);
+
+    frame = create_frame(THIS, ctx->pool);
+    start = malloc(sizeof(*start));
+    if ((frame == NULL) || (start == NULL)) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    *start = now();
+    frame->local = start;
+
+    STACK_WIND(frame, stat_cbk, iot, iot->fops->stat, &loc, NULL);
+}
+
+static void
+graph_prepare(xlator_t *top)
+{
+    xlator_t *sink = FIRST_CHILD(top);
+
+    sink_fops = *sink->fops;
+    sink_fops.stat = sink_stat;
+    sink->fops = &sink_fops;
+}
+
+int
+main(int argc, char *argv[])
+{
+    inode_table_t *table;
+    int32_t first_limit;
+    int32_t limit = 0;
+    int32_t running = 0;
+    double avg = 0;
+    double end;
+    long seconds;
+    long second;
+    long count;
+    int i;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <seconds>\n", argv[0]);
+        return 1;
+    }
+    seconds = atol(argv[1]);
+    if (seconds < 2) {
+        fprintf(stderr, "invalid number of seconds: %s\n", argv[1]);
+        return 1;
+    }
+
+    ctx = harness_ctx_new();
+    if (ctx == NULL) {
+        fprintf(stderr, "failed to initialize the context\n");
+        return 1;
+    }
+    iot = harness_graph_new(ctx, volfile, "iot", graph_prepare);
+    if (iot == NULL) {
+        fprintf(stderr, "failed to initialize the graph\n");
+        return 1;
+    }
+
+    table = inode_table_new(0, iot, 0, 0);
+    if (table == NULL)
+        return 1;
+    inode = inode_new(table);
+    if (inode == NULL)
+        return 1;
+    gf_uuid_generate(inode->gfid);
+    inode->ia_type = IA_IFREG;
+
+    sem_init(&inflight, 0, INFLIGHT);
+    first_limit = high_limit();
+
+    for (second = 1; second <= seconds; second++) {
+        end = now() + 1;
+        while (now() < end) {
+            sem_wait(&inflight);
+            stat_one();
+        }
+
+        count = __atomic_exchange_n(&replies, 0, __ATOMIC_RELAXED);
+        avg = __atomic_exchange_n(&latency, 0, __ATOMIC_RELAXED);
+        if (count == 0) {
+            fprintf(stderr, "no reply in second %ld\n", second);
+            return 1;
+        }
+        avg = avg / 1000 / count;
+        limit = high_limit();
+        running = threads();
+
+        printf("second %ld: %ld requests, %.3f ms average latency, %d high "
+               "priority threads allowed, %d running\n",
+               second, count, avg, limit, running);
+    }
+
+    for (i = 0; i < INFLIGHT; i++)
+        sem_wait(&inflight);
+
+    if ((limit <= first_limit) || (running <= first_limit)) {
+        fprintf(stderr,
+                "high priority threads went from %d to %d allowed, with %d "
+                "running\n",
+                first_limit, limit, running);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,17 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+
+cleanup;
+
+# With adaptive-threads on, io-threads has to allow and start more threads for
+# the high priority, which starts with one, while requests taking a millisecond
+# each wait longer than adaptive-target-wait in the queue.
+TEST build_harness $(dirname $0)/io-threads-adaptive.c \
+     -I$(dirname $0)/../../xlators/performance/io-threads/src
+
+TEST $(dirname $0)/io-threads-adaptive 10
+
+cleanup_tester $(dirname $0)/io-threads-adaptive
+
+cleanup;
@@ -0,0 +1,17 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+
+cleanup;
+
+# Every request sent through io-threads by 1 to 16 threads, each one being a
+# different client and sending requests of two priorities, has to be answered
+# exactly once.
+bm=$(dirname $0)/../../extras/benchmarking/io-threads-bm
+TEST build_harness $bm.c
+
+TEST $bm -r 20000 1 4 16
+
+cleanup_tester $bm
+
+cleanup;
@@ -0,0 +1,17 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+
+cleanup;
+
+# Inodelks and fcntl locks on the same file have to be granted right away
+# next to a thousand granted byte-range locks, and all at once when the lock
+# blocking them is released.
+bm=$(dirname $0)/../../extras/benchmarking/locks-bm
+TEST build_harness $bm.c
+
+TEST $bm 1000
+
+cleanup_tester $bm
+
+cleanup;
@@ -0,0 +1,392 @@
+/*
+  Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+  This file is part of GlusterFS.
+
+  This file is licensed to you under your choice of the GNU Lesser
+  General Public License, version 3 or any later version (LGPLv3 or
+  later), or the GNU General Public License, version 2 (GPLv2), in all
+  cases as published by the Free Software Foundation.
+*/
+
+/* Checksums of ranges computed by storage/posix from the ones it keeps of the
+ * leaves of a file. Given a size in MB, the harness creates a file of that
+ * size in the brick and checks the checksum of the whole file, and of some of
+ * its ranges, against the one computed from the file, the first time and once
+ * the checksums of the leaves are known, after writes, a truncation and a
+ * write past the end. Without a size, it only checks the file it finds, with
+ * the checksums of its leaves as loaded again by another process. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <semaphore.h>
+#include <sys/stat.h>
+#include <sys/xattr.h>
+#include <openssl/md5.h>
+
+#include <glusterfs/glusterfs.h>
+#include <glusterfs/globals.h>
+#include <glusterfs/mem-pool.h>
+#include <glusterfs/iobuf.h>
+#include <glusterfs/stack.h>
+#include <glusterfs/call-stub.h>
+#include <glusterfs/xlator.h>
+#include <glusterfs/inode.h>
+#include <glusterfs/fd.h>
+#include <glusterfs/checksum.h>
+
+#include "xlator-harness.h"
+
+#define FILE_NAME "file"
+#define LEAF GF_RCHECKSUM_TREE_LEAF_SIZE
+
+static const char volfile[] =
+    "volume posix\n"
+    "    type storage/posix\n"
+    "    option directory %s\n"
+    "    option rchecksum-tree on\n"
+    "end-volume\n";
+
+static glusterfs_ctx_t *ctx;
+static xlator_t *posix_xl;
+static inode_table_t *table;
+static sem_t done;
+static const char *brick;
+
+static int32_t reply_ret;
+static int32_t reply_errno;
+static unsigned char reply_checksum[MD5_DIGEST_LENGTH];
+static gf_boolean_t reply_tree;
+
+static int32_t
+create_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+           int32_t op_errno, fd_t *fd, inode_t *inode, struct iatt *buf,
+           struct iatt *preparent, struct iatt *postparent, dict_t *xdata)
+{
+    reply_ret = op_ret;
+    reply_errno = op_errno;
+    STACK_DESTROY(frame->root);
+    sem_post(&done);
+
+    return 0;
+}
+
+static int32_t
+open_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+         int32_t op_errno, fd_t *fd, dict_t *xdata)
+{
+    reply_ret = op_ret;
+    reply_errno = op_errno;
+    STACK_DESTROY(frame->root);
+    sem_post(&done);
+
+    return 0;
+}
+
+static int32_t
+write_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+          int32_t op_errno, struct iatt *prebuf, struct iatt *postbuf,
+          dict_t *xdata)
+{
+    reply_ret = op_ret;
+    reply_errno = op_errno;
+    STACK_DESTROY(frame->root);
+    sem_post(&done);
+
+    return 0;
+}
+
+static int32_t
+rchecksum_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+              int32_t op_errno, uint32_t weak, uint8_t *strong, dict_t *xdata)
+{
+    reply_ret = op_ret;
+    reply_errno = op_errno;
+    if (op_ret == 0)
+        memcpy(reply_checksum, strong, sizeof(reply_checksum));
+    reply_tree = xdata && dict_get_sizen(xdata, GF_RCHECKSUM_TREE);
+    STACK_DESTROY(frame->root);
+    sem_post(&done);
+
+    return 0;
+}
+
+static call_frame_t *
+new_frame(void)
+{
+    call_frame_t *frame;
+
+    frame = create_frame(THIS, ctx->pool);
+    if (frame == NULL) {
+        fprintf(stderr, "create_frame() failed\n");
+        exit(1);
+    }
+
+    return frame;
+}
+
+static void
+check(const char *fop)
+{
+    sem_wait(&done);
+    if (reply_ret < 0) {
+        fprintf(stderr, "%s failed: %s\n", fop, strerror(reply_errno));
+        exit(1);
+    }
+}
+
+static fd_t *
+file_create(inode_t *root)
+{
+    loc_t loc = {
+        .path = "/" FILE_NAME,
+        .name = FILE_NAME,
+        .parent = root,
+    };
+    uuid_t gfid;
+    dict_t *xdata;
+    fd_t *fd;
+
+    gf_uuid_copy(loc.pargfid, root->gfid);
+    loc.inode = inode_new(table);
+    if (loc.inode == NULL)
+        exit(1);
+    gf_uuid_generate(gfid);
+    xdata = dict_new();
+    if ((xdata == NULL) || dict_set_gfuuid(xdata, "gfid-req", gfid, true))
+        exit(1);
+    fd = fd_create(loc.inode, getpid());
+    if (fd == NULL)
+        exit(1);
+
+    STACK_WIND(new_frame(), create_cbk, posix_xl, posix_xl->fops->create,
+               &loc, O_RDWR, 0644, 0, fd, xdata);
+    check("create");
+    dict_unref(xdata);
+    gf_uuid_copy(loc.inode->gfid, gfid);
+    loc.inode->ia_type = IA_IFREG;
+
+    return fd;
+}
+
+static fd_t *
+file_open(void)
+{
+    loc_t loc = {
+        0,
+    };
+    char path[PATH_MAX];
+    fd_t *fd;
+
+    snprintf(path, sizeof(path), "%s/%s", brick, FILE_NAME);
+    loc.inode = inode_new(table);
+    if (loc.inode == NULL)
+        exit(1);
+    if (getxattr(path, "trusted.gfid", loc.inode->gfid, 16) != 16) {
+        fprintf(stderr, "no gfid on %s\n", path);
+        exit(1);
+    }
+    loc.inode->ia_type = IA_IFREG;
+    gf_uuid_copy(loc.gfid, loc.inode->gfid);
+    fd = fd_create(loc.inode, getpid());
+    if (fd == NULL)
+        exit(1);
+
+    STACK_WIND(new_frame(), open_cbk, posix_xl, posix_xl->fops->open, &loc,
+               O_RDWR, fd, NULL);
+    check("open");
+
+    return fd;
+}
+
+static void
+file_write(fd_t *fd, off_t offset, size_t size)
+{
+    struct iovec iov;
+    struct iobref *iobref;
+    char *buf;
+    size_t i;
+
+    buf = malloc(size);
+    iobref = iobref_new();
+    if ((buf == NULL) || (iobref == NULL))
+        exit(1);
+    for (i = 0; i < size; i++)
+        buf[i] = random();
+    iov.iov_base = buf;
+    iov.iov_len = size;
+
+    STACK_WIND(new_frame(), write_cbk, posix_xl, posix_xl->fops->writev, fd,
+               &iov, 1, offset, 0, iobref, NULL);
+    check("writev");
+    iobref_unref(iobref);
+    free(buf);
+}
+
+static void
+file_truncate(fd_t *fd, off_t offset)
+{
+    STACK_WIND(new_frame(), write_cbk, posix_xl, posix_xl->fops->ftruncate, fd,
+               offset, NULL);
+    check("ftruncate");
+}
+
+/* The checksum of the checksums of the zero-padded leaves of the range, as
+ * read from the brick */
+static void
+expected_checksum(off_t offset, uint64_t len, unsigned char *checksum)
+{
+    unsigned char *digests;
+    char path[PATH_MAX];
+    struct stat stbuf;
+    uint64_t first = offset / LEAF;
+    uint64_t end;
+    uint64_t leaf;
+    char *buf;
+    ssize_t bytes;
+    int fd;
+
+    snprintf(path, sizeof(path), "%s/%s", brick, FILE_NAME);
+    fd = open(path, O_RDONLY);
+    if ((fd < 0) || fstat(fd, &stbuf))
+        exit(1);
+    end = min((offset + len + LEAF - 1) / LEAF,
+              (stbuf.st_size + LEAF - 1) / LEAF);
+    if (end < first)
+        end = first;
+
+    buf = malloc(LEAF);
+    digests = malloc((end - first) * MD5_DIGEST_LENGTH + 1);
+    if ((buf == NULL) || (digests == NULL))
+        exit(1);
+    for (leaf = first; leaf < end; leaf++) {
+        bytes = pread(fd, buf, LEAF, leaf * LEAF);
+        if (bytes < 0)
+            exit(1);
+        memset(buf + bytes, 0, LEAF - bytes);
+        gf_rsync_md5_checksum((unsigned char *)buf, LEAF,
+                              digests + (leaf - first) * MD5_DIGEST_LENGTH);
+    }
+    gf_rsync_md5_checksum(digests, (end - first) * MD5_DIGEST_LENGTH,
+                          checksum);
+
+    free(digests);
+    free(buf);
+    close(fd);
+}
+
+static void
+verify(fd_t *fd, off_t offset, uint64_t len)
+{
+    unsigned char expected[MD5_DIGEST_LENGTH];
+    dict_t *xdata;
+
+    xdata = dict_new();
+    if ((xdata == NULL) || dict_set_uint64(xdata, GF_RCHECKSUM_TREE, len))
+        exit(1);
+
+    STACK_WIND(new_frame(), rchecksum_cbk, posix_xl, posix_xl->fops->rchecksum,
+               fd, offset, LEAF, xdata);
+    check("rchecksum");
+    dict_unref(xdata);
+
+    if (!reply_tree) {
+        fprintf(stderr, "checksum of %" PRIu64 " bytes at %" PRId64
+                        " not computed from the leaves\n",
+                len, offset);
+        exit(1);
+    }
+    expected_checksum(offset, len, expected);
+    if (memcmp(expected, reply_checksum, sizeof(expected))) {
+        fprintf(stderr,
+                "wrong checksum of %" PRIu64 " bytes at %" PRId64 "\n", len,
+                offset);
+        exit(1);
+    }
+}
+
+static void
+verify_ranges(fd_t *fd, uint64_t size)
+{
+    verify(fd, 0, size);
+    verify(fd, LEAF, 3 * LEAF);
+    verify(fd, (size / LEAF / 2) * LEAF, size);
+    verify(fd, (size / LEAF + 2) * LEAF, LEAF);
+}
+
+int
+main(int argc, char *argv[])
+{
+    inode_t *root;
+    uint64_t size;
+    char *volume;
+    fd_t *fd;
+
+    if ((argc != 2) && (argc != 3)) {
+        fprintf(stderr, "usage: %s <brick> [<size in MB>]\n", argv[0]);
+        return 1;
+    }
+    brick = argv[1];
+
+    ctx = harness_ctx_new();
+    if ((ctx == NULL) || (asprintf(&volume, volfile, brick) < 0)) {
+        fprintf(stderr, "failed to initialize the context\n");
+        return 1;
+    }
+    posix_xl = harness_graph_new(ctx, volume, "posix", NULL);
+    free(volume);
+    if (posix_xl == NULL) {
+        fprintf(stderr, "failed to initialize the graph\n");
+        return 1;
+    }
+
+    sem_init(&done, 0, 0);
+    table = inode_table_new(0, posix_xl, 0, 0);
+    if (table == NULL)
+        return 1;
+    root = inode_new(table);
+    if (root == NULL)
+        return 1;
+    root->gfid[15] = 1;
+    root->ia_type = IA_IFDIR;
+
+    if (argc == 2) {
+        fd = file_open();
+        verify_ranges(fd, (uint64_t)GF_RCHECKSUM_TREE_MAX_LEAVES * LEAF);
+        fd_unref(fd);
+        return 0;
+    }
+
+    size = strtoull(argv[2], NULL, 10) * 1024 * 1024;
+    if (size < 4 * LEAF) {
+        fprintf(stderr, "invalid size: %s\n", argv[2]);
+        return 1;
+    }
+
+    fd = file_create(root);
+    for (off_t off = 0; off < size; off += LEAF)
+        file_write(fd, off, LEAF);
+
+    /* Once computed from the file and once from the leaves */
+    verify(fd, 0, size);
+    verify(fd, 0, size);
+    verify_ranges(fd, size);
+
+    /* Writes within a leaf and across two */
+    file_write(fd, 3 * LEAF + 100, 10);
+    file_write(fd, size / 2 - 5, 10);
+    verify_ranges(fd, size);
+
+    /* Truncation in the middle of a leaf, then a write past the end */
+    file_truncate(fd, size - LEAF - LEAF / 2);
+    verify_ranges(fd, size);
+    file_write(fd, size + LEAF / 3, 100);
+    verify_ranges(fd, size + 2 * LEAF);
+
+    /* Marks the checksums kept as matching the file again */
+    fd_unref(fd);
+
+    return 0;
+}
@@ -0,0 +1,21 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+
+cleanup;
+
+# The checksums of the ranges of a 16MB file have to match the ones computed
+# from the file, the first time and once the ones of its leaves are kept, after
+# writes and truncations, and again once loaded back by another process, also
+# after the file was changed behind its back.
+TEST build_harness $(dirname $0)/rchecksum-tree.c -lcrypto
+
+TEST mkdir -p $B0/brick
+TEST $(dirname $0)/rchecksum-tree $B0/brick 16
+TEST $(dirname $0)/rchecksum-tree $B0/brick
+TEST dd if=/dev/urandom of=$B0/brick/file bs=1k count=1 seek=5000 conv=notrunc
+TEST $(dirname $0)/rchecksum-tree $B0/brick
+
+cleanup_tester $(dirname $0)/rchecksum-tree
+
+cleanup;
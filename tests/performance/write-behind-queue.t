@@ -0,0 +1,16 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+
+cleanup;
+
+# Write-behind has to acknowledge every write while thousands of previous
+# ones are still held by the translator below it.
+bm=$(dirname $0)/../../extras/benchmarking/write-behind-bm
+TEST build_harness $bm.c
+
+TEST $bm 100 5000
+
+cleanup_tester $bm
+
+cleanup;
@@ -0,0 +1,97 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <glusterfs/glusterfs.h>
+#include <glusterfs/globals.h>
+#include <glusterfs/mem-pool.h>
+#include <glusterfs/iobuf.h>
+#include <glusterfs/stack.h>
+#include <glusterfs/call-stub.h>
+#include <glusterfs/client_t.h>
+#include <glusterfs/xlator.h>
+
+#include "xlator-harness.h"
+
+glusterfs_ctx_t *
+harness_ctx_new(void)
+{
+    glusterfs_ctx_t *ctx;
+
+    ctx = glusterfs_ctx_new();
+    if ((ctx == NULL) || (glusterfs_globals_init(ctx) != 0))
+        return NULL;
+    THIS->ctx = ctx;
+    INIT_LIST_HEAD(&ctx->cmd_args.xlator_options);
+    pthread_mutex_init(&ctx->fd_lock, NULL);
+    pthread_cond_init(&ctx->fd_cond, NULL);
+    INIT_LIST_HEAD(&ctx->janitor_fds);
+    pthread_mutex_init(&ctx->xl_lock, NULL);
+    pthread_cond_init(&ctx->xl_cond, NULL);
+    INIT_LIST_HEAD(&ctx->diskth_xl);
+    if (xlator_mem_acct_init(THIS, gf_common_mt_end + 1) != 0)
+        return NULL;
+    mem_pools_init();
+
+    ctx->process_uuid = generate_glusterfs_ctx_id();
+    ctx->page_size = 128 * GF_UNIT_KB;
+    ctx->iobuf_pool = iobuf_pool_new();
+    ctx->clienttable = gf_clienttable_alloc();
+    ctx->pool = calloc(1, sizeof(call_pool_t));
+    if ((ctx->process_uuid == NULL) || (ctx->iobuf_pool == NULL) ||
+        (ctx->clienttable == NULL) || (ctx->pool == NULL))
+        return NULL;
+    call_pool_init(ctx->pool);
+    ctx->pool->frame_mem_pool = mem_pool_new(call_frame_t, 4096);
+    ctx->pool->stack_mem_pool = mem_pool_new(call_stack_t, 1024);
+    ctx->stub_mem_pool = mem_pool_new(call_stub_t, 1024);
+    ctx->dict_pool = mem_pool_new(dict_t, 1024);
+    ctx->dict_pair_pool = mem_pool_new(data_pair_t, 1024);
+    ctx->dict_data_pool = mem_pool_new(data_t, 1024);
+    ctx->logbuf_pool = mem_pool_new(log_buf_t, 256);
+    if ((ctx->pool->frame_mem_pool == NULL) ||
+        (ctx->pool->stack_mem_pool == NULL) || (ctx->stub_mem_pool == NULL) ||
+        (ctx->dict_pool == NULL) || (ctx->dict_pair_pool == NULL) ||
+        (ctx->dict_data_pool == NULL) || (ctx->logbuf_pool == NULL))
+        return NULL;
+
+    return ctx;
+}
+
+xlator_t *
+harness_graph_new(glusterfs_ctx_t *ctx, const char *volfile, const char *name,
+                  void (*prepare)(xlator_t *top))
+{
+    glusterfs_graph_t *graph;
+    FILE *fp;
+
+    fp = fmemopen((void *)volfile, strlen(volfile), "r");
+    if (fp == NULL)
+        return NULL;
+    graph = glusterfs_graph_construct(fp);
+    fclose(fp);
+    if (graph == NULL)
+        return NULL;
+
+    if (glusterfs_graph_prepare(graph, ctx, (char *)name) != 0)
+        return NULL;
+
+    if (prepare != NULL)
+        prepare(graph->top);
+
+    if (glusterfs_graph_activate(graph, ctx) != 0)
+        return NULL;
+
+    return graph->top;
+}
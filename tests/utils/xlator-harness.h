@@ -0,0 +1,34 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+#ifndef _XLATOR_HARNESS_H
+#define _XLATOR_HARNESS_H
+
+/* Helpers for programs that load a graph of translators and send fops to it
+ * directly, without any glusterfs process or volume. */
+
+#include <glusterfs/glusterfs.h>
+#include <glusterfs/xlator.h>
+
+/* Creates the global context with what glusterfsd sets up for the
+ * translators: memory pools, the call pool, the iobuf pool, the client table
+ * and the janitor lists. Returns NULL on failure. */
+glusterfs_ctx_t *
+harness_ctx_new(void);
+
+/* Builds the graph described by 'volfile', with 'name' as its top volume,
+ * and activates it. If 'prepare' is not NULL, it's called with the top
+ * translator before the graph is initialized, so that the fops of the
+ * translators below can be replaced. Returns the top translator or NULL. */
+xlator_t *
+harness_graph_new(glusterfs_ctx_t *ctx, const char *volfile, const char *name,
+                  void (*prepare)(xlator_t *top));
+
+#endif /* _XLATOR_HARNESS_H */
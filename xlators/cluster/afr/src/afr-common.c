@@ -6196,9 +6196,11 @@ static void
 afr_handle_upcall_event(xlator_t *this, struct gf_upcall *upcall)
 {
     struct gf_upcall_cache_invalidation *up_ci = NULL;
+    struct gf_upcall_cache_invalidation_batch *batch = NULL;
     afr_private_t *priv = this->private;
     inode_t *inode = NULL;
     inode_table_t *itable = NULL;
+    uint32_t n = 0;
     int i = 0;
 
     switch (upcall->event_type) {
@@ -6229,6 +6231,11 @@ afr_handle_upcall_event(xlator_t *this, struct gf_upcall *upcall)
                 break;
             }
             break;
+        case GF_UPCALL_CACHE_INVALIDATION_BATCH:
+            batch = upcall->data;
+            for (n = 0; n < batch->count; n++)
+                afr_handle_upcall_event(this, &batch->entries[n]);
+            break;
         default:
             break;
     }
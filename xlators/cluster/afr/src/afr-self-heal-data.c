@@ -16,6 +16,14 @@
 #include <glusterfs/events.h>
 
 #define HAS_HOLES(i) ((i->ia_blocks * 512) < (i->ia_size))
+
+/* From this size on, the diff heal compares the checksums of whole ranges
+ * first, and only looks into the parts of the ones which differ. */
+#define AFR_DATA_TREE_MIN_SIZE (16 * GF_RCHECKSUM_TREE_LEAF_SIZE)
+#define AFR_DATA_TREE_FANOUT 16
+#define AFR_DATA_TREE_MAX_SIZE                                                 \
+    ((uint64_t)GF_RCHECKSUM_TREE_LEAF_SIZE * GF_RCHECKSUM_TREE_MAX_LEAVES)
+
 static int
 __checksum_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
                int op_errno, uint32_t weak, uint8_t *strong, dict_t *xdata)
@@ -30,11 +38,14 @@ __checksum_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
     replies[i].valid = 1;
     replies[i].op_ret = op_ret;
     replies[i].op_errno = op_errno;
+    replies[i].rchecksum_tree = _gf_false;
     if (xdata) {
         replies[i].buf_has_zeroes = dict_get_str_boolean(
             xdata, "buf-has-zeroes", _gf_false);
         replies[i].fips_mode_rchecksum = dict_get_str_boolean(
             xdata, "fips-mode-rchecksum", _gf_false);
+        replies[i].rchecksum_tree = dict_get_str_boolean(
+            xdata, GF_RCHECKSUM_TREE, _gf_false);
     }
     if (strong) {
         if (replies[i].fips_mode_rchecksum) {
@@ -283,6 +294,155 @@ unlock:
     return ret;
 }
 
+static int
+afr_selfheal_data_range(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                        int source, unsigned char *healed_sinks, off_t offset,
+                        off_t end, size_t block, int type,
+                        struct afr_reply *replies)
+{
+    afr_private_t *priv = this->private;
+    size_t size = 0;
+    off_t off = 0;
+    int ret = 0;
+
+    for (off = offset; off < end; off += block) {
+        if (AFR_COUNT(healed_sinks, priv->child_count) == 0)
+            return -ENOTCONN;
+
+        /* Only the last block of the file goes past the end of the range */
+        size = block;
+        if ((end < replies[source].poststat.ia_size) && (off + block > end))
+            size = end - off;
+
+        ret = afr_selfheal_data_block(frame, this, fd, source, healed_sinks,
+                                      off, size, type, replies);
+        if (ret < 0)
+            return ret;
+
+        AFR_STACK_RESET(frame);
+        if (frame->local == NULL)
+            return -ENOTCONN;
+    }
+
+    return 0;
+}
+
+/* Compares the checksums of a range of the source and of the sinks, computed
+ * by the bricks from the checksums they keep of its leaves. Returns 1 if they
+ * match, 0 if they don't and -1 if a brick didn't compute them that way.
+ *
+ * The range isn't locked, a match only being a hint that it doesn't need to
+ * be healed. */
+static int
+afr_selfheal_data_tree_match(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                             int source, unsigned char *healed_sinks,
+                             off_t offset, uint64_t size)
+{
+    afr_private_t *priv = this->private;
+    afr_local_t *local = frame->local;
+    struct afr_reply *replies = local->replies;
+    unsigned char *wind_subvols = NULL;
+    dict_t *xdata = NULL;
+    int ret = 1;
+    int i = 0;
+
+    xdata = dict_new();
+    if (!xdata)
+        return -1;
+    if (dict_set_uint64(xdata, GF_RCHECKSUM_TREE, size)) {
+        dict_unref(xdata);
+        return -1;
+    }
+
+    wind_subvols = alloca0(priv->child_count);
+    for (i = 0; i < priv->child_count; i++) {
+        if (i == source || healed_sinks[i])
+            wind_subvols[i] = 1;
+    }
+
+    /* A brick not knowing the key only reads that much */
+    AFR_ONLIST(wind_subvols, frame, __checksum_cbk, rchecksum, fd, offset,
+               min(size, GF_RCHECKSUM_TREE_LEAF_SIZE), xdata);
+    dict_unref(xdata);
+
+    for (i = 0; i < priv->child_count; i++) {
+        if (wind_subvols[i] && (!replies[i].valid || replies[i].op_ret != 0 ||
+                                !replies[i].rchecksum_tree))
+            return -1;
+    }
+
+    for (i = 0; i < priv->child_count; i++) {
+        if (!wind_subvols[i] || i == source)
+            continue;
+        if ((replies[i].fips_mode_rchecksum !=
+             replies[source].fips_mode_rchecksum) ||
+            memcmp(replies[source].checksum, replies[i].checksum,
+                   replies[source].fips_mode_rchecksum ? SHA256_DIGEST_LENGTH
+                                                       : MD5_DIGEST_LENGTH)) {
+            ret = 0;
+            break;
+        }
+    }
+
+    return ret;
+}
+
+/* Heals a range by going down to the ones of AFR_DATA_TREE_FANOUT times its
+ * size whose checksums differ, healing only the leaves that differ block by
+ * block. Once a brick can't compare them, the rest of the file is healed
+ * block by block. */
+static int
+afr_selfheal_data_tree(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                       int source, unsigned char *healed_sinks, off_t offset,
+                       uint64_t size, size_t block, int type,
+                       struct afr_reply *replies, gf_boolean_t *tree)
+{
+    off_t end = min(offset + size, replies[source].poststat.ia_size);
+    uint64_t child = 0;
+    off_t off = 0;
+    int ret = 0;
+
+    size = end - offset;
+    if (!*tree)
+        return afr_selfheal_data_range(frame, this, fd, source, healed_sinks,
+                                       offset, end, block, type, replies);
+
+    ret = afr_selfheal_data_tree_match(frame, this, fd, source, healed_sinks,
+                                       offset, size);
+    AFR_STACK_RESET(frame);
+    if (frame->local == NULL)
+        return -ENOTCONN;
+
+    if (ret == 1)
+        return 0;
+
+    if (ret < 0) {
+        gf_msg_debug(this->name, 0,
+                     "gfid:%s, checksums of ranges not available, healing "
+                     "from offset %jd block by block",
+                     uuid_utoa(fd->inode->gfid), offset);
+        *tree = _gf_false;
+        return afr_selfheal_data_range(frame, this, fd, source, healed_sinks,
+                                       offset, end, block, type, replies);
+    }
+
+    if (size <= GF_RCHECKSUM_TREE_LEAF_SIZE)
+        return afr_selfheal_data_range(frame, this, fd, source, healed_sinks,
+                                       offset, end, block, type, replies);
+
+    child = size / AFR_DATA_TREE_FANOUT + GF_RCHECKSUM_TREE_LEAF_SIZE - 1;
+    child -= child % GF_RCHECKSUM_TREE_LEAF_SIZE;
+    for (off = offset; off < end; off += child) {
+        ret = afr_selfheal_data_tree(frame, this, fd, source, healed_sinks,
+                                     off, min(child, end - off), block, type,
+                                     replies, tree);
+        if (ret < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
 static int
 afr_selfheal_data_fsync(call_frame_t *frame, xlator_t *this, fd_t *fd,
                         unsigned char *healed_sinks)
@@ -342,6 +502,7 @@ afr_selfheal_data_do(call_frame_t *frame, xlator_t *this, fd_t *fd, int source,
     int ret = -1;
     call_frame_t *iter_frame = NULL;
     unsigned char arbiter_sink_status = 0;
+    gf_boolean_t tree = _gf_false;
 
     gf_msg(this->name, GF_LOG_INFO, 0, AFR_MSG_SELF_HEAL_INFO,
            "performing data selfheal on %s", uuid_utoa(fd->inode->gfid));
@@ -368,22 +529,19 @@ afr_selfheal_data_do(call_frame_t *frame, xlator_t *this, fd_t *fd, int source,
         goto out;
     }
 
-    for (off = 0; off < replies[source].poststat.ia_size; off += block) {
-        if (AFR_COUNT(healed_sinks, priv->child_count) == 0) {
-            ret = -ENOTCONN;
-            goto out;
-        }
-
-        ret = afr_selfheal_data_block(iter_frame, this, fd, source,
-                                      healed_sinks, off, block, type, replies);
+    /* Bricks keeping the checksums of the leaves of the files compare big
+     * ones without reading them whole */
+    if (type == AFR_SELFHEAL_DATA_DIFF &&
+        replies[source].poststat.ia_size >= AFR_DATA_TREE_MIN_SIZE)
+        tree = _gf_true;
+
+    for (off = 0; off < replies[source].poststat.ia_size;
+         off += AFR_DATA_TREE_MAX_SIZE) {
+        ret = afr_selfheal_data_tree(iter_frame, this, fd, source, healed_sinks,
+                                     off, AFR_DATA_TREE_MAX_SIZE, block, type,
+                                     replies, &tree);
         if (ret < 0)
             goto out;
-
-        AFR_STACK_RESET(iter_frame);
-        if (iter_frame->local == NULL) {
-            ret = -ENOTCONN;
-            goto out;
-        }
     }
 
     ret = afr_selfheal_data_fsync(frame, this, fd, healed_sinks);
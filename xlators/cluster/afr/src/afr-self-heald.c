@@ -370,6 +370,10 @@ afr_shd_sweep_prepare(struct subvol_healer *healer)
     event->healed_count = 0;
     event->split_brain_count = 0;
     event->heal_failed_count = 0;
+    event->read_count = 0;
+    event->processed_count = 0;
+    event->read_time = 0;
+    event->heal_time = 0;
 
     event->start_time = gf_time();
     event->end_time = 0;
@@ -387,6 +391,20 @@ afr_shd_sweep_done(struct subvol_healer *healer)
     shd = &(((afr_private_t *)healer->this->private)->shd);
 
     event->end_time = gf_time();
+    /* Both times are summed over the threads, giving rates per thread */
+    if (event->read_count)
+        gf_msg(healer->this->name, GF_LOG_INFO, 0, AFR_MSG_SELF_HEAL_INFO,
+               "%s sweep on %s: %" PRIu64 " entries, read at %.0f/s per "
+               "reader and %" PRIu64 " processed at %.0f/s per heal thread",
+               event->crawl_type,
+               afr_subvol_name(healer->this, healer->subvol),
+               event->read_count,
+               event->read_time ? event->read_count * 1e9 / event->read_time
+                                : 0,
+               event->processed_count,
+               event->heal_time
+                   ? event->processed_count * 1e9 / event->heal_time
+                   : 0);
     history = gf_memdup(event, sizeof(*event));
     event->start_time = 0;
 
@@ -437,6 +455,51 @@ afr_shd_index_heal(xlator_t *subvol, gf_dirent_t *entry, loc_t *parent,
     return 0;
 }
 
+/* Whether the brick gives each reader of a parallel sweep its own part of the
+ * index: older ones give all of it to each of them. The entries aren't asked
+ * by priority, which would make the brick sort the whole index for nothing. */
+static gf_boolean_t
+afr_shd_index_partitioned(xlator_t *this, xlator_t *subvol, loc_t *loc,
+                          uint32_t readers)
+{
+    gf_dirent_t entries;
+    dict_t *xdata = NULL;
+    dict_t *rsp_xdata = NULL;
+    fd_t *fd = NULL;
+    gf_boolean_t partitioned = _gf_false;
+    int ret;
+
+    INIT_LIST_HEAD(&entries.list);
+
+    xdata = dict_new();
+    if (!xdata || dict_set_uint32(xdata, GF_INDEX_PARTITION, 0) ||
+        dict_set_uint32(xdata, GF_INDEX_PARTITIONS, readers))
+        goto out;
+
+    ret = syncop_dirfd(subvol, loc, &fd, GF_CLIENT_PID_SELF_HEALD);
+    if (ret)
+        goto out;
+
+    ret = syncop_readdir(subvol, fd, 0, 0, &entries, xdata, &rsp_xdata);
+    if ((ret >= 0) && rsp_xdata && dict_get(rsp_xdata, GF_INDEX_PARTITIONS))
+        partitioned = _gf_true;
+    else
+        gf_msg_debug(this->name, 0,
+                     "%s doesn't split its index, sweeping it with a "
+                     "single reader",
+                     subvol->name);
+out:
+    gf_dirent_free(&entries);
+    if (xdata)
+        dict_unref(xdata);
+    if (rsp_xdata)
+        dict_unref(rsp_xdata);
+    if (fd)
+        fd_unref(fd);
+
+    return partitioned;
+}
+
 int
 afr_shd_index_sweep(struct subvol_healer *healer, char *vgfid)
 {
@@ -444,11 +507,18 @@ afr_shd_index_sweep(struct subvol_healer *healer, char *vgfid)
     afr_private_t *priv = NULL;
     int ret = 0;
     xlator_t *subvol = NULL;
-    dict_t *xdata = NULL;
+    dict_t **xdata = NULL;
     call_frame_t *frame = NULL;
+    syncop_dir_scan_stats_t stats = {
+        0,
+    };
+    uint32_t count = 0;
+    uint32_t readers = 0;
+    uint32_t i;
 
     priv = healer->this->private;
     subvol = priv->children[healer->subvol];
+    count = readers = priv->shd.index_readers;
 
     frame = afr_frame_create(healer->this, &ret);
     if (!frame) {
@@ -465,15 +535,55 @@ afr_shd_index_sweep(struct subvol_healer *healer, char *vgfid)
         goto out;
     }
 
-    xdata = dict_new();
-    if (!xdata || dict_set_int32_sizen(xdata, "get-gfid-type", 1)) {
+    xdata = GF_CALLOC(count, sizeof(*xdata), gf_common_mt_pointer);
+    if (!xdata) {
         ret = -ENOMEM;
         goto out;
     }
+    for (i = 0; i < readers; i++) {
+        xdata[i] = dict_new();
+        if (!xdata[i] || dict_set_int32_sizen(xdata[i], "get-gfid-type", 1)) {
+            ret = -ENOMEM;
+            goto out;
+        }
+        /* Heal directories first and then the oldest entries, if the brick
+         * knows their priority. */
+        if (!strcmp(vgfid, GF_XATTROP_INDEX_GFID) &&
+            dict_set_int32_sizen(xdata[i], GF_INDEX_BY_PRIORITY, 1)) {
+            ret = -ENOMEM;
+            goto out;
+        }
+        /* Each reader gets the entries whose gfid hashes to it */
+        if ((readers > 1) &&
+            (dict_set_uint32(xdata[i], GF_INDEX_PARTITION, i) ||
+             dict_set_uint32(xdata[i], GF_INDEX_PARTITIONS, readers))) {
+            ret = -ENOMEM;
+            goto out;
+        }
+    }
 
-    ret = syncop_mt_dir_scan(frame, subvol, &loc, GF_CLIENT_PID_SELF_HEALD,
-                             healer, afr_shd_index_heal, xdata,
-                             priv->shd.max_threads, priv->shd.wait_qlength);
+    if ((readers > 1) &&
+        !afr_shd_index_partitioned(healer->this, subvol, &loc, readers))
+        readers = 1;
+    if (readers == 1) {
+        dict_del(xdata[0], GF_INDEX_PARTITION);
+        dict_del(xdata[0], GF_INDEX_PARTITIONS);
+    }
+
+    ret = syncop_mt_dir_scan_readers(frame, subvol, &loc,
+                                     GF_CLIENT_PID_SELF_HEALD, healer,
+                                     afr_shd_index_heal, xdata, readers,
+                                     priv->shd.max_threads,
+                                     priv->shd.wait_qlength, &stats);
+
+    LOCK(&priv->lock);
+    {
+        healer->crawl_event.read_count += stats.read_count;
+        healer->crawl_event.processed_count += stats.processed_count;
+        healer->crawl_event.read_time += stats.read_time;
+        healer->crawl_event.heal_time += stats.process_time;
+    }
+    UNLOCK(&priv->lock);
 
     if (ret == 0)
         ret = healer->crawl_event.healed_count;
@@ -481,8 +591,13 @@ afr_shd_index_sweep(struct subvol_healer *healer, char *vgfid)
 out:
     loc_wipe(&loc);
 
-    if (xdata)
-        dict_unref(xdata);
+    if (xdata) {
+        for (i = 0; i < count; i++) {
+            if (xdata[i])
+                dict_unref(xdata[i]);
+        }
+        GF_FREE(xdata);
+    }
     if (frame)
         AFR_STACK_DESTROY(frame);
     return ret;
@@ -23,6 +23,14 @@ typedef struct {
     uint64_t split_brain_count;
     uint64_t heal_failed_count;
 
+    /* Entries read from the index and healed, the time spent reading them
+     * and the one spent healing them, in ns and summed over the readers or
+     * the heals */
+    uint64_t read_count;
+    uint64_t processed_count;
+    uint64_t read_time;
+    uint64_t heal_time;
+
     /* If start_time is 0, it means crawler is not in progress
        and stats are not valid */
     time_t start_time;
@@ -54,6 +62,7 @@ typedef struct {
     int timeout;
     uint32_t max_threads;
     uint32_t wait_qlength;
+    uint32_t index_readers;
     uint32_t halo_max_latency_msec;
     gf_boolean_t iamshd;
     gf_boolean_t enabled;
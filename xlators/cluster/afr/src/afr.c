@@ -297,6 +297,9 @@ reconfigure(xlator_t *this, dict_t *options)
     GF_OPTION_RECONF("shd-wait-qlength", priv->shd.wait_qlength, options,
                      uint32, out);
 
+    GF_OPTION_RECONF("shd-index-readers", priv->shd.index_readers, options,
+                     uint32, out);
+
     GF_OPTION_RECONF("favorite-child-policy", fav_child_policy, options, str,
                      out);
     if (afr_set_favorite_child_policy(priv, fav_child_policy) == -1)
@@ -503,6 +506,8 @@ init(xlator_t *this)
 
     GF_OPTION_INIT("shd-wait-qlength", priv->shd.wait_qlength, uint32, out);
 
+    GF_OPTION_INIT("shd-index-readers", priv->shd.index_readers, uint32, out);
+
     GF_OPTION_INIT("background-self-heal-count",
                    priv->background_self_heal_count, uint32, out);
 
@@ -1260,6 +1265,21 @@ struct volume_options options[] = {
         .description = "This option can be used to control number of heals"
                        " that can wait in SHD per subvolume",
     },
+    {
+        .key = {"shd-index-readers"},
+        .type = GF_OPTION_TYPE_INT,
+        .min = 1,
+        .max = 64,
+        .default_value = "1",
+        .op_version = {GD_OP_VERSION_11_0},
+        .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+        .tags = {"replicate"},
+        .description = "Number of threads SHD reads the index of a local "
+                       "brick with, each one going through its own part of "
+                       "it and feeding the heals to the same "
+                       "shd-max-threads. Bricks not able to split their "
+                       "index are read by a single thread.",
+    },
     {
         .key = {"locking-scheme"},
         .type = GF_OPTION_TYPE_STR,
@@ -385,6 +385,7 @@ struct afr_reply {
     uint8_t checksum[SHA256_DIGEST_LENGTH];
     gf_boolean_t buf_has_zeroes;
     gf_boolean_t fips_mode_rchecksum;
+    gf_boolean_t rchecksum_tree;
     /* For lookup */
     int8_t need_heal;
 };
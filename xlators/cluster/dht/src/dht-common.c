@@ -10943,6 +10943,24 @@ dht_forget(xlator_t *this, inode_t *inode)
     return 0;
 }
 
+static void
+dht_upcall_cache_invalidation(dht_conf_t *conf,
+                              struct gf_upcall_cache_invalidation *up_ci)
+{
+    /* Since md-cache will be aggressively filtering lookups,
+     * the stale layout issue will be more pronounced. Hence
+     * when a layout xattr is changed by the rebalance process
+     * notify all the md-cache clients to invalidate the existing
+     * stat cache and send the lookup next time*/
+    if (up_ci->dict && dict_get(up_ci->dict, conf->xattr_name))
+        up_ci->flags |= UP_EXPLICIT_LOOKUP;
+
+    /* TODO: Instead of invalidating iatt, update the new
+     * hashed/cached subvolume in dht inode_ctx */
+    if (IS_DHT_LINKFILE_MODE(&up_ci->stat))
+        up_ci->flags |= UP_EXPLICIT_LOOKUP;
+}
+
 int
 dht_notify(xlator_t *this, int event, void *data, ...)
 {
@@ -10961,7 +10979,8 @@ dht_notify(xlator_t *this, int event, void *data, ...)
     dict_t *output = NULL;
     va_list ap;
     struct gf_upcall *up_data = NULL;
-    struct gf_upcall_cache_invalidation *up_ci = NULL;
+    struct gf_upcall_cache_invalidation_batch *batch = NULL;
+    uint32_t n = 0;
 
     conf = this->private;
     GF_VALIDATE_OR_GOTO(this->name, conf, out);
@@ -11123,22 +11142,17 @@ dht_notify(xlator_t *this, int event, void *data, ...)
         }
         case GF_EVENT_UPCALL:
             up_data = (struct gf_upcall *)data;
-            if (up_data->event_type != GF_UPCALL_CACHE_INVALIDATION)
+            if (up_data->event_type == GF_UPCALL_CACHE_INVALIDATION) {
+                dht_upcall_cache_invalidation(conf, up_data->data);
+            } else if (up_data->event_type ==
+                       GF_UPCALL_CACHE_INVALIDATION_BATCH) {
+                batch = up_data->data;
+                for (n = 0; n < batch->count; n++)
+                    dht_upcall_cache_invalidation(conf,
+                                                  batch->entries[n].data);
+            } else {
                 break;
-            up_ci = (struct gf_upcall_cache_invalidation *)up_data->data;
-
-            /* Since md-cache will be aggressively filtering lookups,
-             * the stale layout issue will be more pronounced. Hence
-             * when a layout xattr is changed by the rebalance process
-             * notify all the md-cache clients to invalidate the existing
-             * stat cache and send the lookup next time*/
-            if (up_ci->dict && dict_get(up_ci->dict, conf->xattr_name))
-                up_ci->flags |= UP_EXPLICIT_LOOKUP;
-
-            /* TODO: Instead of invalidating iatt, update the new
-             * hashed/cached subvolume in dht inode_ctx */
-            if (IS_DHT_LINKFILE_MODE(&up_ci->stat))
-                up_ci->flags |= UP_EXPLICIT_LOOKUP;
+            }
 
             propagate = 1;
             break;
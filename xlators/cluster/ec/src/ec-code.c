@@ -34,6 +34,10 @@
 #include "ec-code-avx.h"
 #endif
 
+#ifdef USE_EC_DYNAMIC_AVX512
+#include "ec-code-avx512.h"
+#endif
+
 #define EC_CODE_SIZE (1024 * 64)
 #define EC_CODE_ALIGN 4096
 
@@ -57,6 +61,9 @@ struct _ec_code_proc {
 };
 
 static ec_code_gen_t *ec_code_gen_table[] = {
+#ifdef USE_EC_DYNAMIC_AVX512
+    &ec_code_gen_avx512,
+#endif
 #ifdef USE_EC_DYNAMIC_AVX
     &ec_code_gen_avx,
 #endif
@@ -149,11 +156,90 @@ ec_code_copy(ec_code_builder_t *builder, uint32_t dst, uint32_t src)
     ec_code_arg_set(&op->arg3, 0);
 }
 
+static gf_boolean_t
+ec_code_op_touches(ec_code_op_t *op, uint32_t reg)
+{
+    switch (op->op) {
+        case EC_GF_OP_LOAD:
+        case EC_GF_OP_STORE:
+        case EC_GF_OP_XORM:
+            return op->arg1.value == reg;
+        case EC_GF_OP_COPY:
+        case EC_GF_OP_XOR2:
+            return (op->arg1.value == reg) || (op->arg2.value == reg);
+        case EC_GF_OP_XOR3:
+        case EC_GF_OP_XORX:
+            return (op->arg1.value == reg) || (op->arg2.value == reg) ||
+                   (op->arg3.value == reg);
+        case EC_GF_OP_XORXM:
+            return (op->arg1.value == reg) || (op->arg4.value == reg);
+        default:
+            return _gf_true;
+    }
+}
+
+static gf_boolean_t
+ec_code_op_writes(ec_code_op_t *op, uint32_t reg)
+{
+    if (op->op == EC_GF_OP_STORE) {
+        return _gf_false;
+    }
+
+    return op->arg1.value == reg;
+}
+
+/* Looks for a previous xor into dst that the xor of src (or of memory if src
+ * is -1) can be merged with. The xor moves back to that point, so nothing in
+ * between can use dst or change src. */
+static ec_code_op_t *
+ec_code_xor_find(ec_code_builder_t *builder, uint32_t dst, uint32_t src)
+{
+    ec_code_op_t *op;
+    uint32_t i;
+
+    if (builder->code->gen->xorx == NULL) {
+        return NULL;
+    }
+
+    for (i = builder->count; i > 0; i--) {
+        op = &builder->ops[i - 1];
+        if (ec_code_op_touches(op, dst)) {
+            if ((op->arg1.value == dst) &&
+                ((op->op == EC_GF_OP_XOR2) ||
+                 ((op->op == EC_GF_OP_XORM) && (src != -1)))) {
+                return op;
+            }
+            break;
+        }
+        if ((src != -1) && ec_code_op_writes(op, src)) {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
 static void
 ec_code_xor2(ec_code_builder_t *builder, uint32_t dst, uint32_t src)
 {
     ec_code_op_t *op;
 
+    if (builder->map[dst] != builder->map[src]) {
+        op = ec_code_xor_find(builder, builder->map[dst], builder->map[src]);
+        if ((op != NULL) && (op->op == EC_GF_OP_XOR2)) {
+            op->op = EC_GF_OP_XORX;
+            ec_code_arg_use(builder, op, &op->arg3, builder->map[src]);
+
+            return;
+        }
+        if (op != NULL) {
+            op->op = EC_GF_OP_XORXM;
+            ec_code_arg_use(builder, op, &op->arg4, builder->map[src]);
+
+            return;
+        }
+    }
+
     op = ec_code_op_next(builder);
 
     op->op = EC_GF_OP_XOR2;
@@ -188,6 +274,16 @@ ec_code_xorm(ec_code_builder_t *builder, uint32_t bit, uint32_t offset)
 {
     ec_code_op_t *op;
 
+    op = ec_code_xor_find(builder, builder->map[bit], -1);
+    if (op != NULL) {
+        op->op = EC_GF_OP_XORXM;
+        ec_code_arg_use(builder, op, &op->arg4, op->arg2.value);
+        ec_code_arg_set(&op->arg2, offset);
+        ec_code_arg_set(&op->arg3, bit);
+
+        return;
+    }
+
     op = ec_code_op_next(builder);
 
     op->op = EC_GF_OP_XORM;
@@ -632,6 +728,14 @@ ec_code_write(ec_code_builder_t *builder)
                 gen->xorm(builder, op->arg1.value, op->arg2.value,
                           op->arg3.value);
                 break;
+            case EC_GF_OP_XORX:
+                gen->xorx(builder, op->arg1.value, op->arg2.value,
+                          op->arg3.value);
+                break;
+            case EC_GF_OP_XORXM:
+                gen->xorxm(builder, op->arg1.value, op->arg4.value,
+                           op->arg2.value, op->arg3.value);
+                break;
             default:
                 break;
         }
@@ -874,6 +874,25 @@ ec_dispatch_all(ec_fop_data_t *fop)
     }
 }
 
+/* Only the bricks in mask are used, the others being left untouched but
+ * still good. The fop succeeds when minimum of them do. */
+void
+ec_dispatch_delta(ec_fop_data_t *fop, uintptr_t mask, uint32_t minimum)
+{
+    ec_dispatch_start(fop);
+
+    if (ec_child_select(fop)) {
+        ec_sleep(fop);
+
+        mask &= fop->remaining;
+        fop->expected = gf_bits_count(mask);
+        fop->minimum = minimum;
+        fop->first = 0;
+
+        ec_dispatch_mask(fop, mask);
+    }
+}
+
 void
 ec_dispatch_min(ec_fop_data_t *fop)
 {
@@ -888,7 +907,15 @@ ec_dispatch_min(ec_fop_data_t *fop)
         ec_sleep(fop);
 
         fop->expected = count = ec->fragments;
-        fop->first = ec_select_first_by_read_policy(fop->xl->private, fop);
+        /* Files with a systematic layout are read from the bricks which have
+         * the data as is whenever possible. */
+        if (fop->use_fd &&
+            ec_inode_matrix(fop->xl, fop->fd->inode)->systematic) {
+            fop->first = 0;
+        } else {
+            fop->first = ec_select_first_by_read_policy(fop->xl->private,
+                                                        fop);
+        }
         idx = fop->first - 1;
         mask = 0;
         while (count-- > 0) {
@@ -1151,7 +1178,8 @@ ec_config_check(xlator_t *xl, ec_config_t *config)
 
     ec = xl->private;
     if ((config->version != EC_CONFIG_VERSION) ||
-        (config->algorithm != EC_CONFIG_ALGORITHM) ||
+        ((config->algorithm != EC_CONFIG_ALGORITHM) &&
+         (config->algorithm != EC_CONFIG_ALGORITHM_SYSTEMATIC)) ||
         (config->gf_word_size != EC_GF_BITS) || (config->bricks != ec->nodes) ||
         (config->redundancy != ec->redundancy) ||
         (config->chunk_size != EC_METHOD_CHUNK_SIZE)) {
@@ -1190,6 +1218,41 @@ ec_config_check(xlator_t *xl, ec_config_t *config)
     return _gf_true;
 }
 
+/* The config of the regular files created from now on. */
+void
+ec_config_init(ec_t *ec, ec_config_t *config)
+{
+    config->version = EC_CONFIG_VERSION;
+    config->algorithm = ec->systematic ? EC_CONFIG_ALGORITHM_SYSTEMATIC
+                                       : EC_CONFIG_ALGORITHM;
+    config->gf_word_size = EC_GF_BITS;
+    config->bricks = ec->nodes;
+    config->redundancy = ec->redundancy;
+    config->chunk_size = EC_METHOD_CHUNK_SIZE;
+}
+
+/* The matrices to encode and decode the data of inode with. Its config is
+ * always known once its data can be read or written. */
+ec_matrix_list_t *
+ec_inode_matrix(xlator_t *xl, inode_t *inode)
+{
+    ec_t *ec = xl->private;
+    ec_inode_t *ctx;
+    gf_boolean_t systematic = _gf_false;
+
+    LOCK(&inode->lock);
+
+    ctx = __ec_inode_get(inode, xl);
+    if ((ctx != NULL) && ctx->have_config &&
+        (ctx->config.algorithm == EC_CONFIG_ALGORITHM_SYSTEMATIC)) {
+        systematic = _gf_true;
+    }
+
+    UNLOCK(&inode->lock);
+
+    return systematic ? &ec->systematic_matrix : &ec->matrix;
+}
+
 gf_boolean_t
 ec_set_dirty_flag(ec_lock_link_t *link, ec_inode_t *ctx, uint64_t *dirty)
 {
@@ -2853,9 +2916,10 @@ ec_update_stripe(ec_t *ec, ec_stripe_list_t *stripe_cache, ec_stripe_t *stripe,
     off_t base;
 
     /* On write fops, we only update existing fragments if the write has
-     * succeeded. Otherwise, we remove them from the cache. */
+     * succeeded. Otherwise, we remove them from the cache. Parity delta
+     * writes don't have the contents of whole stripes. */
     if ((fop->id == GF_FOP_WRITE) && (fop->answer != NULL) &&
-        (fop->answer->op_ret >= 0)) {
+        (fop->answer->op_ret >= 0) && (fop->delta == 0)) {
         base = stripe->frag_offset - fop->frag_range.first;
         base *= ec->fragments;
 
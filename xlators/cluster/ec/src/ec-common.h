@@ -22,8 +22,11 @@ typedef enum { EC_DATA_TXN, EC_METADATA_TXN } ec_txn_t;
 #define EC_CONFIG_VERSION 0
 
 #define EC_CONFIG_ALGORITHM 0
+/* The data is kept as is in the first fragments */
+#define EC_CONFIG_ALGORITHM_SYSTEMATIC 1
 
 #define EC_FLAG_LOCK_SHARED 0x0001
+#define EC_FLAG_DELTA_FAILED 0x0002
 
 #define QUORUM_CBK(fn, fop, frame, cookie, this, op_ret, op_errno, params...)  \
     do {                                                                       \
@@ -175,6 +178,12 @@ gf_boolean_t
 __ec_set_inode_size(ec_fop_data_t *fop, inode_t *inode, uint64_t size);
 void
 ec_clear_inode_info(ec_fop_data_t *fop, inode_t *inode);
+ec_matrix_list_t *
+ec_inode_matrix(xlator_t *xl, inode_t *inode);
+gf_boolean_t
+ec_config_check(xlator_t *xl, ec_config_t *config);
+void
+ec_config_init(ec_t *ec, ec_config_t *config);
 
 void
 ec_flush_size_version(ec_fop_data_t *fop);
@@ -186,6 +195,8 @@ ec_dispatch_inc(ec_fop_data_t *fop);
 void
 ec_dispatch_min(ec_fop_data_t *fop);
 void
+ec_dispatch_delta(ec_fop_data_t *fop, uintptr_t mask, uint32_t minimum);
+void
 ec_dispatch_one(ec_fop_data_t *fop);
 
 void
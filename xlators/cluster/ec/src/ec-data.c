@@ -261,6 +261,9 @@ ec_fop_data_release(ec_fop_data_t *fop)
         if (fop->fd != NULL) {
             fd_unref(fop->fd);
         }
+        if (fop->delta_fd != NULL) {
+            fd_unref(fop->delta_fd);
+        }
         if (fop->buffers != NULL) {
             iobref_unref(fop->buffers);
         }
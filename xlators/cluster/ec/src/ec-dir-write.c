@@ -141,12 +141,7 @@ ec_manager_create(ec_fop_data_t *fop, int32_t state)
 
             ec = fop->xl->private;
 
-            config.version = EC_CONFIG_VERSION;
-            config.algorithm = EC_CONFIG_ALGORITHM;
-            config.gf_word_size = EC_GF_BITS;
-            config.bricks = ec->nodes;
-            config.redundancy = ec->redundancy;
-            config.chunk_size = EC_METHOD_CHUNK_SIZE;
+            ec_config_init(ec, &config);
 
             err = ec_dict_set_config(fop->xdata, EC_XATTR_CONFIG, &config);
             if (err != 0) {
@@ -710,12 +705,7 @@ ec_manager_mknod(ec_fop_data_t *fop, int32_t state)
 
                 ec = fop->xl->private;
 
-                config.version = EC_CONFIG_VERSION;
-                config.algorithm = EC_CONFIG_ALGORITHM;
-                config.gf_word_size = EC_GF_BITS;
-                config.bricks = ec->nodes;
-                config.redundancy = ec->redundancy;
-                config.chunk_size = EC_METHOD_CHUNK_SIZE;
+                ec_config_init(ec, &config);
 
                 err = ec_dict_set_config(fop->xdata, EC_XATTR_CONFIG, &config);
                 if (err != 0) {
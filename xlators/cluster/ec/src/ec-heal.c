@@ -1271,12 +1271,17 @@ ec_create_name(call_frame_t *frame, ec_t *ec, inode_t *parent, char *name,
             break;
         case IA_IFREG:
             ec_set_new_entry_dirty(ec, &loc, ia, frame, ec->xl, on);
-            config.version = EC_CONFIG_VERSION;
-            config.algorithm = EC_CONFIG_ALGORITHM;
-            config.gf_word_size = EC_GF_BITS;
-            config.bricks = ec->nodes;
-            config.redundancy = ec->redundancy;
-            config.chunk_size = EC_METHOD_CHUNK_SIZE;
+            for (i = 0; i < ec->nodes; i++) {
+                if (name_data.same[i] &&
+                    (ec_dict_del_config(lookup_replies[i].xdata,
+                                        EC_XATTR_CONFIG, &config) == 0) &&
+                    ec_config_check(ec->xl, &config)) {
+                    break;
+                }
+            }
+            if (i == ec->nodes) {
+                ec_config_init(ec, &config);
+            }
 
             ret = ec_dict_set_config(xdata, EC_XATTR_CONFIG, &config);
             if (ret != 0) {
@@ -1323,6 +1328,7 @@ __ec_heal_name(call_frame_t *frame, ec_t *ec, inode_t *parent, char *name,
     unsigned char *enoent = NULL;
     default_args_cbk_t *replies = NULL;
     dict_t *xdata = NULL;
+    dict_t *xattr_req = NULL;
     dict_t *gfid_db = NULL;
     int ret = 0;
     loc_t loc = {0};
@@ -1350,11 +1356,18 @@ __ec_heal_name(call_frame_t *frame, ec_t *ec, inode_t *parent, char *name,
         goto out;
     }
 
+    /* A missing file is created with the config of the existing ones. */
+    xattr_req = dict_new();
+    if (!xattr_req || ec_dict_set_number(xattr_req, EC_XATTR_CONFIG, 0)) {
+        ret = -ENOMEM;
+        goto out;
+    }
+
     output = alloca0(ec->nodes);
     gfidless = alloca0(ec->nodes);
     enoent = alloca0(ec->nodes);
     ret = cluster_lookup(ec->xl_list, participants, ec->nodes, replies, output,
-                         frame, ec->xl, &loc, NULL);
+                         frame, ec->xl, &loc, xattr_req);
     for (i = 0; i < ec->nodes; i++) {
         if (!replies[i].valid)
             continue;
@@ -1424,6 +1437,8 @@ out:
     loc_wipe(&loc);
     if (xdata)
         dict_unref(xdata);
+    if (xattr_req)
+        dict_unref(xattr_req);
     if (gfid_db)
         dict_unref(gfid_db);
     return ret;
@@ -299,7 +299,10 @@ ec_shd_index_sweep(struct subvol_healer *healer)
     }
 
     xdata = dict_new();
-    if (!xdata || dict_set_int32(xdata, "get-gfid-type", 1)) {
+    /* Heal directories first and then the oldest entries, if the brick
+     * knows their priority. */
+    if (!xdata || dict_set_int32(xdata, "get-gfid-type", 1) ||
+        dict_set_int32(xdata, GF_INDEX_BY_PRIORITY, 1)) {
         ret = -ENOMEM;
         goto out;
     }
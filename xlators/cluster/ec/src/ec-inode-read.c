@@ -1193,8 +1193,8 @@ ec_readv_rebuild(ec_t *ec, ec_fop_data_t *fop, ec_cbk_data_t *cbk)
             goto out;
         }
 
-        err = ec_method_decode(&ec->matrix, fsize, cbk->mask, values, blocks,
-                               ptr);
+        err = ec_method_decode(ec_inode_matrix(ec->xl, fop->fd->inode), fsize,
+                               cbk->mask, values, blocks, ptr);
         if (err != 0) {
             goto out;
         }
@@ -1989,55 +1989,134 @@ ec_get_lock_good_mask(inode_t *inode, xlator_t *xl)
     return 0;
 }
 
-void
-ec_writev_start(ec_fop_data_t *fop)
+/* Returns the bricks to update with a parity delta, or 0 if the write must
+ * rewrite whole stripes. Only the data bricks whose chunks are modified and
+ * the parity bricks are read and written, which is worth it when they are
+ * fewer than the stripe read plus all the bricks written otherwise. */
+static uintptr_t
+ec_writev_delta_mask(ec_t *ec, ec_fop_data_t *fop, uint64_t current)
 {
-    ec_t *ec = fop->xl->private;
-    ec_fd_t *ctx;
-    fd_t *fd;
-    dict_t *xdata = NULL;
-    uint64_t tail, current;
-    int32_t err = -ENOMEM;
-    gf_boolean_t found_stripe = _gf_false;
+    uintptr_t mask = 0;
+    uint64_t chunk, last;
+    uint32_t count;
 
-    /* This shouldn't fail because we have the inode locked. */
-    GF_ASSERT(ec_get_inode_size(fop, fop->fd->inode, &current));
-
-    fd = fd_anonymous(fop->fd->inode);
-    if (fd == NULL) {
-        goto failed;
+    if (!ec->parity_delta || (fop->parent != NULL) || (fop->healing != 0) ||
+        (fop->user_size == 0) || (fop->size == fop->user_size)) {
+        return 0;
     }
 
-    fop->frame->root->uid = 0;
-    fop->frame->root->gid = 0;
+    /* The data is only found as is in the fragments of systematic files, and
+     * only up to the current end of the file. */
+    if (!ec_inode_matrix(fop->xl, fop->fd->inode)->systematic ||
+        (fop->offset + fop->head + fop->user_size > current)) {
+        return 0;
+    }
 
-    ctx = ec_fd_get(fop->fd, fop->xl);
-    if (ctx != NULL) {
-        if ((ctx->flags & O_APPEND) != 0) {
-            /* Appending writes take full locks so size won't change because
-             * of any parallel operations
-             */
-            fop->offset = current;
+    last = (fop->head + fop->user_size - 1) / EC_METHOD_CHUNK_SIZE;
+    for (chunk = fop->head / EC_METHOD_CHUNK_SIZE; chunk <= last; chunk++) {
+        mask |= 1ULL << (chunk % ec->fragments);
+        if (gf_bits_count(mask) == ec->fragments) {
+            return 0;
         }
     }
 
-    err = ec_writev_prepare_buffers(ec, fop);
-    if (err != 0) {
-        goto failed_fd;
+    count = gf_bits_count(mask) + ec->redundancy;
+    if (2 * count >= ec->fragments + ec->nodes) {
+        return 0;
+    }
+
+    /* The data bricks not written must keep valid fragments, so all bricks
+     * need to be good and up. */
+    if ((ec_get_lock_good_mask(fop->fd->inode, fop->xl) & ec->xl_up &
+         ec->node_mask) != ec->node_mask) {
+        return 0;
     }
+
+    return mask | (ec->node_mask & ~((1ULL << ec->fragments) - 1));
+}
+
+/* Returns how many of the bricks updated with a parity delta must succeed
+ * so that, with the data bricks not written, the file still has enough
+ * good fragments. */
+static uint32_t
+ec_writev_delta_minimum(ec_t *ec, ec_fop_data_t *fop)
+{
+    uintptr_t untouched;
+
+    untouched = ec_get_lock_good_mask(fop->fd->inode, fop->xl) & ec->xl_up &
+                ((1ULL << ec->fragments) - 1) & ~fop->delta;
+
+    return ec->fragments - gf_bits_count(untouched);
+}
+
+static int32_t
+ec_writev_delta_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                    int32_t op_ret, int32_t op_errno, struct iovec *vector,
+                    int32_t count, struct iatt *stbuf, struct iobref *iobref,
+                    dict_t *xdata)
+{
+    ec_fop_data_t *fop = frame->local;
+    uint32_t idx = (uint32_t)(uintptr_t)cookie;
+    uint64_t size = fop->vector[1].iov_len;
+
+    if (op_ret == size) {
+        ec_iov_copy_to(fop->vector[1].iov_base + idx * size, vector, count, 0,
+                       size);
+    } else {
+        /* The whole stripes will be read and written instead. */
+        LOCK(&fop->lock);
+        fop->flags |= EC_FLAG_DELTA_FAILED;
+        UNLOCK(&fop->lock);
+    }
+
+    ec_resume(fop, 0);
+
+    return 0;
+}
+
+/* Reads the current fragments of the bricks that a parity delta write will
+ * update into the buffers they will be written from. */
+static void
+ec_writev_delta_read(ec_t *ec, ec_fop_data_t *fop, fd_t *fd, dict_t *xdata)
+{
+    uintptr_t mask = fop->delta;
+    uint32_t idx;
+
+    fop->delta_fd = fd_ref(fd);
+    for (idx = 0; mask != 0; idx++, mask >>= 1) {
+        if ((mask & 1) == 0) {
+            continue;
+        }
+        ec_sleep(fop);
+        STACK_WIND_COOKIE(fop->frame, ec_writev_delta_cbk,
+                          (void *)(uintptr_t)idx, ec->xl_list[idx],
+                          ec->xl_list[idx]->fops->readv, fd,
+                          fop->vector[1].iov_len, fop->frag_range.first, 0,
+                          xdata);
+    }
+}
+
+/* Reads the parts of the first and last stripes that the write doesn't
+ * cover, unless they are beyond the end of the file or cached. */
+static int32_t
+ec_writev_merge(ec_t *ec, ec_fop_data_t *fop, fd_t *fd, uint64_t current,
+                dict_t **xdata)
+{
+    uint64_t tail;
+    gf_boolean_t found_stripe = _gf_false;
+
     tail = fop->size - fop->user_size - fop->head;
     if (fop->head > 0) {
         if (current > fop->offset) {
             found_stripe = ec_get_and_merge_stripe(ec, fop, EC_STRIPE_HEAD);
             if (!found_stripe) {
-                if (ec_make_internal_fop_xdata(&xdata)) {
-                    err = -ENOMEM;
-                    goto failed_xdata;
+                if (ec_make_internal_fop_xdata(xdata)) {
+                    return -ENOMEM;
                 }
                 ec_readv(fop->frame, fop->xl,
                          ec_get_lock_good_mask(fop->fd->inode, fop->xl),
                          EC_MINIMUM_MIN, ec_writev_merge_head, NULL, fd,
-                         ec->stripe_size, fop->offset, 0, xdata);
+                         ec->stripe_size, fop->offset, 0, *xdata);
             }
         } else {
             memset(fop->vector[0].iov_base, 0, fop->head);
@@ -2056,15 +2135,14 @@ ec_writev_start(ec_fop_data_t *fop)
         if (current > fop->offset + fop->head + fop->user_size) {
             found_stripe = ec_get_and_merge_stripe(ec, fop, EC_STRIPE_TAIL);
             if (!found_stripe) {
-                if (ec_make_internal_fop_xdata(&xdata)) {
-                    err = -ENOMEM;
-                    goto failed_xdata;
+                if (ec_make_internal_fop_xdata(xdata)) {
+                    return -ENOMEM;
                 }
                 ec_readv(fop->frame, fop->xl,
                          ec_get_lock_good_mask(fop->fd->inode, fop->xl),
                          EC_MINIMUM_MIN, ec_writev_merge_tail, NULL, fd,
                          ec->stripe_size,
-                         fop->offset + fop->size - ec->stripe_size, 0, xdata);
+                         fop->offset + fop->size - ec->stripe_size, 0, *xdata);
             }
         } else {
             memset(fop->vector[0].iov_base + fop->size - tail, 0, tail);
@@ -2074,9 +2152,58 @@ ec_writev_start(ec_fop_data_t *fop)
         }
     }
 
-    err = 0;
+    return 0;
+}
+
+static void
+ec_writev_merge_start(ec_fop_data_t *fop, gf_boolean_t retry)
+{
+    ec_t *ec = fop->xl->private;
+    ec_fd_t *ctx;
+    fd_t *fd;
+    dict_t *xdata = NULL;
+    uint64_t current;
+    int32_t err = -ENOMEM;
+
+    /* This shouldn't fail because we have the inode locked. */
+    GF_ASSERT(ec_get_inode_size(fop, fop->fd->inode, &current));
+
+    fd = fd_anonymous(fop->fd->inode);
+    if (fd == NULL) {
+        goto failed;
+    }
+
+    fop->frame->root->uid = 0;
+    fop->frame->root->gid = 0;
+
+    if (!retry) {
+        ctx = ec_fd_get(fop->fd, fop->xl);
+        if (ctx != NULL) {
+            if ((ctx->flags & O_APPEND) != 0) {
+                /* Appending writes take full locks so size won't change
+                 * because of any parallel operations
+                 */
+                fop->offset = current;
+            }
+        }
+
+        err = ec_writev_prepare_buffers(ec, fop);
+        if (err != 0) {
+            goto failed_fd;
+        }
+
+        fop->delta = ec_writev_delta_mask(ec, fop, current);
+    }
+
+    if (fop->delta != 0) {
+        err = ec_make_internal_fop_xdata(&xdata);
+        if (err == 0) {
+            ec_writev_delta_read(ec, fop, fd, xdata);
+        }
+    } else {
+        err = ec_writev_merge(ec, fop, fd, current, &xdata);
+    }
 
-failed_xdata:
     if (xdata) {
         dict_unref(xdata);
     }
@@ -2086,6 +2213,12 @@ failed:
     ec_fop_set_error(fop, -err);
 }
 
+void
+ec_writev_start(ec_fop_data_t *fop)
+{
+    ec_writev_merge_start(fop, _gf_false);
+}
+
 int32_t
 ec_writev_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
               int32_t op_errno, struct iatt *prestat, struct iatt *poststat,
@@ -2122,6 +2255,61 @@ ec_wind_writev(ec_t *ec, ec_fop_data_t *fop, int32_t idx)
                       fop->buffers, fop->xdata);
 }
 
+/* The encoding is linear, so the changes of the modified data encoded alone
+ * are the changes of every fragment. */
+static int32_t
+ec_writev_delta_encode(ec_fop_data_t *fop)
+{
+    ec_t *ec = fop->xl->private;
+    struct iobref *iobref = NULL;
+    void *blocks[ec->nodes];
+    void *data, *old, *delta;
+    uint64_t size, pos, end, len, chunk;
+    uint32_t i;
+
+    size = fop->vector[1].iov_len;
+    if (ec_buffer_alloc(ec->xl, size * ec->nodes, &iobref, &delta) != 0) {
+        return -ENOMEM;
+    }
+
+    /* Only the written bytes differ from the current data. */
+    data = fop->vector[0].iov_base;
+    end = fop->head + fop->user_size;
+    memset(data, 0, fop->head);
+    memset(data + end, 0, fop->size - end);
+    for (pos = fop->head; pos < end; pos += len) {
+        chunk = pos / EC_METHOD_CHUNK_SIZE;
+        len = min(EC_METHOD_CHUNK_SIZE - pos % EC_METHOD_CHUNK_SIZE, end - pos);
+        old = fop->vector[1].iov_base + (chunk % ec->fragments) * size +
+              (chunk / ec->fragments) * EC_METHOD_CHUNK_SIZE +
+              pos % EC_METHOD_CHUNK_SIZE;
+        for (i = 0; i < len; i++) {
+            ((uint8_t *)data)[pos + i] ^= ((uint8_t *)old)[i];
+        }
+    }
+
+    for (i = 0; i < ec->nodes; i++) {
+        blocks[i] = delta + i * size;
+    }
+    ec_method_encode(ec_inode_matrix(fop->xl, fop->fd->inode), fop->size, data,
+                     blocks);
+
+    for (i = 0; i < ec->nodes; i++) {
+        if ((fop->delta & (1ULL << i)) == 0) {
+            continue;
+        }
+        old = fop->vector[1].iov_base + i * size;
+        delta = blocks[i] - size;
+        for (pos = 0; pos < size; pos += sizeof(uint64_t)) {
+            *(uint64_t *)(old + pos) ^= *(uint64_t *)(delta + pos);
+        }
+    }
+
+    iobref_unref(iobref);
+
+    return 0;
+}
+
 static void
 ec_writev_encode(ec_fop_data_t *fop)
 {
@@ -2133,8 +2321,8 @@ ec_writev_encode(ec_fop_data_t *fop)
     for (i = 1; i < ec->nodes; i++) {
         blocks[i] = blocks[i - 1] + fop->vector[1].iov_len;
     }
-    ec_method_encode(&ec->matrix, fop->vector[0].iov_len,
-                     fop->vector[0].iov_base, blocks);
+    ec_method_encode(ec_inode_matrix(fop->xl, fop->fd->inode),
+                     fop->vector[0].iov_len, fop->vector[0].iov_base, blocks);
 }
 
 int32_t
@@ -2145,6 +2333,8 @@ ec_manager_writev(ec_fop_data_t *fop, int32_t state)
     ec_t *ec = fop->xl->private;
     off_t fl_start = 0;
     uint64_t fl_size = LONG_MAX;
+    uint32_t minimum;
+    int32_t err;
 
     switch (state) {
         case EC_STATE_INIT:
@@ -2180,9 +2370,35 @@ ec_manager_writev(ec_fop_data_t *fop, int32_t state)
             fop->frame->root->uid = fop->uid;
             fop->frame->root->gid = fop->gid;
 
-            ec_writev_encode(fop);
+            if ((fop->flags & EC_FLAG_DELTA_FAILED) != 0) {
+                fop->flags &= ~EC_FLAG_DELTA_FAILED;
+                fop->delta = 0;
+                ec_writev_merge_start(fop, _gf_true);
 
-            ec_dispatch_all(fop);
+                return EC_STATE_DELAYED_START;
+            }
+
+            if (fop->delta != 0) {
+                /* Bricks may have gone down while the fragments were read. */
+                minimum = ec_writev_delta_minimum(ec, fop);
+                if (minimum > gf_bits_count(fop->delta & ec->xl_up)) {
+                    fop->delta = 0;
+                    ec_writev_merge_start(fop, _gf_true);
+
+                    return EC_STATE_DELAYED_START;
+                }
+
+                err = ec_writev_delta_encode(fop);
+                if (err != 0) {
+                    ec_fop_set_error(fop, -err);
+
+                    return EC_STATE_PREPARE_ANSWER;
+                }
+                ec_dispatch_delta(fop, fop->delta, minimum);
+            } else {
+                ec_writev_encode(fop);
+                ec_dispatch_all(fop);
+            }
 
             return EC_STATE_PREPARE_ANSWER;
 
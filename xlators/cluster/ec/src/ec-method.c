@@ -10,6 +10,7 @@
 
 #include <string.h>
 #include <inttypes.h>
+#include <pthread.h>
 
 #include "ec-types.h"
 #include "ec-mem-types.h"
@@ -17,6 +18,7 @@
 #include "ec-code.h"
 #include "ec-method.h"
 #include "ec-helpers.h"
+#include "ec-messages.h"
 
 static void
 ec_method_matrix_normal(ec_gf_t *gf, uint32_t *matrix, uint32_t columns,
@@ -34,6 +36,96 @@ ec_method_matrix_normal(ec_gf_t *gf, uint32_t *matrix, uint32_t columns,
     }
 }
 
+/* The first columns rows give the data as is. The others are rows of a Cauchy
+ * matrix, so that any columns rows can be inverted, scaled to end in 1 as
+ * ec_code_c_linear() expects. */
+static void
+ec_method_matrix_systematic(ec_gf_t *gf, uint32_t *matrix, uint32_t columns,
+                            uint32_t *values, uint32_t count)
+{
+    uint32_t i, j, row;
+
+    for (i = 0; i < count; i++) {
+        row = *values++ - 1;
+        for (j = 0; j < columns; j++) {
+            if (row < columns) {
+                *matrix++ = (row == j);
+            } else {
+                *matrix++ = ec_gf_div(gf, row ^ (columns - 1), row ^ j);
+            }
+        }
+    }
+}
+
+/* Gauss-Jordan elimination. The contents of matrix are lost. */
+static void
+ec_method_matrix_solve(ec_gf_t *gf, uint32_t *matrix, uint32_t *inverse,
+                       uint32_t count)
+{
+    uint32_t i, j, k, p, tmp;
+
+    for (i = 0; i < count; i++) {
+        for (j = 0; j < count; j++) {
+            inverse[i * count + j] = (i == j);
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        for (p = i; matrix[p * count + i] == 0; p++) {
+            GF_ASSERT(p + 1 < count);
+        }
+        if (p != i) {
+            for (k = 0; k < count; k++) {
+                tmp = matrix[p * count + k];
+                matrix[p * count + k] = matrix[i * count + k];
+                matrix[i * count + k] = tmp;
+                tmp = inverse[p * count + k];
+                inverse[p * count + k] = inverse[i * count + k];
+                inverse[i * count + k] = tmp;
+            }
+        }
+
+        tmp = matrix[i * count + i];
+        for (k = 0; k < count; k++) {
+            matrix[i * count + k] = ec_gf_div(gf, matrix[i * count + k], tmp);
+            inverse[i * count + k] = ec_gf_div(gf, inverse[i * count + k], tmp);
+        }
+
+        for (j = 0; j < count; j++) {
+            tmp = matrix[j * count + i];
+            if ((j == i) || (tmp == 0)) {
+                continue;
+            }
+            for (k = 0; k < count; k++) {
+                matrix[j * count + k] ^= ec_gf_mul(gf, tmp,
+                                                   matrix[i * count + k]);
+                inverse[j * count + k] ^= ec_gf_mul(gf, tmp,
+                                                    inverse[i * count + k]);
+            }
+        }
+    }
+}
+
+/* Returns the only column used by a row if it's taken as is, or -1. */
+static int32_t
+ec_method_matrix_copy(uint32_t *values, uint32_t columns)
+{
+    int32_t copy = -1;
+    uint32_t i;
+
+    for (i = 0; i < columns; i++) {
+        if (values[i] == 0) {
+            continue;
+        }
+        if ((values[i] != 1) || (copy >= 0)) {
+            return -1;
+        }
+        copy = i;
+    }
+
+    return copy;
+}
+
 static void
 ec_method_matrix_inverse(ec_gf_t *gf, uint32_t *matrix, uint32_t *values,
                          uint32_t count)
@@ -84,23 +176,47 @@ ec_method_matrix_init(ec_matrix_list_t *list, ec_matrix_t *matrix,
 
     if (inverse) {
         matrix->rows = list->columns;
-        ec_method_matrix_inverse(matrix->code->gf, matrix->values, rows,
-                                 matrix->rows);
+        if (list->systematic) {
+            uint32_t tmp[matrix->rows * matrix->columns];
+
+            ec_method_matrix_systematic(matrix->code->gf, tmp,
+                                        matrix->columns, rows, matrix->rows);
+            ec_method_matrix_solve(matrix->code->gf, tmp, matrix->values,
+                                   matrix->rows);
+        } else {
+            ec_method_matrix_inverse(matrix->code->gf, matrix->values, rows,
+                                     matrix->rows);
+        }
         for (i = 0; i < matrix->rows; i++) {
             matrix->row_data[i].values = matrix->values + i * matrix->columns;
-            matrix->row_data[i].func.interleaved = ec_code_build_interleaved(
-                matrix->code, EC_METHOD_WORD_SIZE, matrix->row_data[i].values,
-                matrix->columns);
+            matrix->row_data[i].copy = ec_method_matrix_copy(
+                matrix->row_data[i].values, matrix->columns);
+            if (matrix->row_data[i].copy < 0) {
+                matrix->row_data[i].func.interleaved =
+                    ec_code_build_interleaved(matrix->code,
+                                              EC_METHOD_WORD_SIZE,
+                                              matrix->row_data[i].values,
+                                              matrix->columns);
+            }
         }
     } else {
         matrix->rows = list->rows;
-        ec_method_matrix_normal(matrix->code->gf, matrix->values,
-                                matrix->columns, rows, matrix->rows);
+        if (list->systematic) {
+            ec_method_matrix_systematic(matrix->code->gf, matrix->values,
+                                        matrix->columns, rows, matrix->rows);
+        } else {
+            ec_method_matrix_normal(matrix->code->gf, matrix->values,
+                                    matrix->columns, rows, matrix->rows);
+        }
         for (i = 0; i < matrix->rows; i++) {
             matrix->row_data[i].values = matrix->values + i * matrix->columns;
-            matrix->row_data[i].func.linear = ec_code_build_linear(
-                matrix->code, EC_METHOD_WORD_SIZE, matrix->row_data[i].values,
-                matrix->columns);
+            matrix->row_data[i].copy = ec_method_matrix_copy(
+                matrix->row_data[i].values, matrix->columns);
+            if (matrix->row_data[i].copy < 0) {
+                matrix->row_data[i].func.linear = ec_code_build_linear(
+                    matrix->code, EC_METHOD_WORD_SIZE,
+                    matrix->row_data[i].values, matrix->columns);
+            }
         }
     }
 }
@@ -298,11 +414,13 @@ failed:
 
 int32_t
 ec_method_init(xlator_t *xl, ec_matrix_list_t *list, uint32_t columns,
-               uint32_t rows, uint32_t max, const char *gen)
+               uint32_t rows, uint32_t max, const char *gen,
+               gf_boolean_t systematic)
 {
     list->columns = columns;
     list->rows = rows;
     list->max = max;
+    list->systematic = systematic;
     list->stripe = EC_METHOD_CHUNK_SIZE * list->columns;
     INIT_LIST_HEAD(&list->lru);
     int32_t err;
@@ -357,6 +475,8 @@ ec_method_fini(ec_matrix_list_t *list)
 {
     ec_matrix_t *matrix;
 
+    ec_method_parallel(THIS, list, 0, 0);
+
     if (list->encode == NULL) {
         return;
     }
@@ -390,44 +510,285 @@ ec_method_update(xlator_t *xl, ec_matrix_list_t *list, const char *gen)
     return 0;
 }
 
+/* A buffer being encoded or decoded by several threads. Pieces of it are
+ * taken in order by the caller and by the workers that join it until none
+ * is left. */
+typedef struct _ec_method_job ec_method_job_t;
+
+struct _ec_method_job {
+    struct list_head queue;
+    void (*func)(ec_method_job_t *, uint64_t, uint64_t);
+    ec_matrix_list_t *list;
+    ec_matrix_t *matrix;
+    void *data;
+    void **blocks;
+    uint64_t size;
+    uint64_t piece;
+    gf_atomic_t next;
+    uint32_t active;
+};
+
+/* Worker threads shared by all the matrix lists of the process. */
+static struct {
+    pthread_mutex_t mutex;
+    pthread_mutex_t resize;
+    pthread_cond_t cond;
+    pthread_cond_t done;
+    struct list_head jobs;
+    uint32_t refs;
+    uint32_t threads;
+    uint32_t running;
+    pthread_t thread[EC_METHOD_MAX_THREADS];
+} ec_method_pool = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .resize = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+    .jobs = {&ec_method_pool.jobs, &ec_method_pool.jobs},
+};
+
+static void
+ec_method_job_run(ec_method_job_t *job)
+{
+    uint64_t start, end;
+
+    while ((start = GF_ATOMIC_FETCH_ADD(job->next, job->piece)) < job->size) {
+        end = start + job->piece;
+        if (end > job->size) {
+            end = job->size;
+        }
+        job->func(job, start, end);
+    }
+}
+
+static void *
+ec_method_pool_worker(void *data)
+{
+    ec_method_job_t *job;
+    uint32_t index = (uintptr_t)data;
+
+    pthread_mutex_lock(&ec_method_pool.mutex);
+
+    while (index < ec_method_pool.threads) {
+        if (list_empty(&ec_method_pool.jobs)) {
+            pthread_cond_wait(&ec_method_pool.cond, &ec_method_pool.mutex);
+            continue;
+        }
+
+        job = list_first_entry(&ec_method_pool.jobs, ec_method_job_t, queue);
+        /* Once a job is being processed by enough threads, the next one can
+         * be started. */
+        if (++job->active >= ec_method_pool.threads) {
+            list_del_init(&job->queue);
+        }
+
+        pthread_mutex_unlock(&ec_method_pool.mutex);
+
+        ec_method_job_run(job);
+
+        pthread_mutex_lock(&ec_method_pool.mutex);
+
+        list_del_init(&job->queue);
+        if (--job->active == 0) {
+            pthread_cond_broadcast(&ec_method_pool.done);
+        }
+    }
+
+    pthread_mutex_unlock(&ec_method_pool.mutex);
+
+    return NULL;
+}
+
+static void
+__ec_method_pool_resize(xlator_t *xl, uint32_t threads)
+{
+    uint32_t i;
+
+    pthread_mutex_lock(&ec_method_pool.mutex);
+    ec_method_pool.threads = threads;
+    pthread_cond_broadcast(&ec_method_pool.cond);
+    pthread_mutex_unlock(&ec_method_pool.mutex);
+
+    while (ec_method_pool.running > threads) {
+        pthread_join(ec_method_pool.thread[--ec_method_pool.running], NULL);
+    }
+    while (ec_method_pool.running < threads) {
+        i = ec_method_pool.running;
+        if (gf_thread_create(&ec_method_pool.thread[i], NULL,
+                             ec_method_pool_worker, (void *)(uintptr_t)i,
+                             "ecpool%u", i) != 0) {
+            gf_msg(xl->name, GF_LOG_WARNING, errno,
+                   EC_MSG_COMPUTE_THREAD_FAILED,
+                   "Failed to start an encoding thread. Only %u will be "
+                   "used.",
+                   i);
+
+            pthread_mutex_lock(&ec_method_pool.mutex);
+            ec_method_pool.threads = i;
+            pthread_mutex_unlock(&ec_method_pool.mutex);
+
+            break;
+        }
+        ec_method_pool.running++;
+    }
+}
+
+/* The threads are shared by the whole process, so the last number set by any
+ * list is used. They are stopped once no list uses them. */
 void
-ec_method_encode(ec_matrix_list_t *list, uint64_t size, void *in, void **out)
+ec_method_parallel(xlator_t *xl, ec_matrix_list_t *list, uint32_t threads,
+                   uint64_t threshold)
 {
-    ec_matrix_t *matrix;
-    uint64_t pos;
+    gf_boolean_t pooled = (threads > 0);
+
+    list->threshold = threshold;
+
+    pthread_mutex_lock(&ec_method_pool.resize);
+
+    if (pooled != list->pooled) {
+        if (pooled) {
+            ec_method_pool.refs++;
+        } else {
+            ec_method_pool.refs--;
+        }
+        list->pooled = pooled;
+    }
+    if (pooled || (ec_method_pool.refs == 0)) {
+        __ec_method_pool_resize(xl, threads);
+    }
+
+    pthread_mutex_unlock(&ec_method_pool.resize);
+}
+
+/* Processes the whole job if it's small or there are no workers. Otherwise
+ * it's split into pieces of at least a stripe, several for each thread so
+ * that they all finish at about the same time. */
+static void
+ec_method_job_execute(ec_method_job_t *job, uint64_t size, uint64_t unit,
+                      uint64_t total)
+{
+    uint32_t threads = ec_method_pool.threads;
+    uint64_t piece;
+
+    job->size = size;
+    if (!job->list->pooled || (threads == 0) ||
+        (total < job->list->threshold)) {
+        job->func(job, 0, size);
+        return;
+    }
+
+    piece = size / ((threads + 1) * EC_METHOD_PIECES);
+    if (piece < EC_METHOD_MIN_PIECE / (total / size)) {
+        piece = EC_METHOD_MIN_PIECE / (total / size);
+    }
+    job->piece = (piece + unit - 1) / unit * unit;
+    GF_ATOMIC_INIT(job->next, 0);
+    job->active = 0;
+
+    pthread_mutex_lock(&ec_method_pool.mutex);
+    list_add_tail(&job->queue, &ec_method_pool.jobs);
+    pthread_cond_broadcast(&ec_method_pool.cond);
+    pthread_mutex_unlock(&ec_method_pool.mutex);
+
+    ec_method_job_run(job);
+
+    pthread_mutex_lock(&ec_method_pool.mutex);
+    list_del_init(&job->queue);
+    while (job->active > 0) {
+        pthread_cond_wait(&ec_method_pool.done, &ec_method_pool.mutex);
+    }
+    pthread_mutex_unlock(&ec_method_pool.mutex);
+}
+
+static void
+ec_method_encode_range(ec_method_job_t *job, uint64_t start, uint64_t end)
+{
+    ec_matrix_list_t *list = job->list;
+    ec_matrix_t *matrix = job->matrix;
+    ec_matrix_row_t *row;
+    uint64_t pos, offset;
     uint32_t i;
 
-    matrix = list->encode;
-    for (pos = 0; pos < size; pos += list->stripe) {
+    offset = start / list->columns;
+    for (pos = start; pos < end; pos += list->stripe) {
         for (i = 0; i < matrix->rows; i++) {
-            matrix->row_data[i].func.linear(
-                out[i], in, pos, matrix->row_data[i].values, list->columns);
-            out[i] += EC_METHOD_CHUNK_SIZE;
+            row = &matrix->row_data[i];
+            if (row->copy >= 0) {
+                memcpy(job->blocks[i] + offset,
+                       job->data + pos + row->copy * EC_METHOD_CHUNK_SIZE,
+                       EC_METHOD_CHUNK_SIZE);
+            } else {
+                row->func.linear(job->blocks[i] + offset, job->data, pos,
+                                 row->values, list->columns);
+            }
         }
+        offset += EC_METHOD_CHUNK_SIZE;
     }
 }
 
-int32_t
-ec_method_decode(ec_matrix_list_t *list, uint64_t size, uintptr_t mask,
-                 uint32_t *rows, void **in, void *out)
+static void
+ec_method_decode_range(ec_method_job_t *job, uint64_t start, uint64_t end)
 {
-    ec_matrix_t *matrix;
+    ec_matrix_list_t *list = job->list;
+    ec_matrix_t *matrix = job->matrix;
+    ec_matrix_row_t *row;
     uint64_t pos;
     uint32_t i;
+    void *out;
 
-    matrix = ec_method_matrix_get(list, mask, rows);
-    if (EC_IS_ERR(matrix)) {
-        return EC_GET_ERR(matrix);
-    }
-    for (pos = 0; pos < size; pos += EC_METHOD_CHUNK_SIZE) {
+    out = job->data + start * matrix->rows;
+    for (pos = start; pos < end; pos += EC_METHOD_CHUNK_SIZE) {
         for (i = 0; i < matrix->rows; i++) {
-            matrix->row_data[i].func.interleaved(
-                out, in, pos, matrix->row_data[i].values, list->columns);
+            row = &matrix->row_data[i];
+            if (row->copy >= 0) {
+                memcpy(out, job->blocks[row->copy] + pos,
+                       EC_METHOD_CHUNK_SIZE);
+            } else {
+                row->func.interleaved(out, job->blocks, pos, row->values,
+                                      list->columns);
+            }
             out += EC_METHOD_CHUNK_SIZE;
         }
     }
+}
+
+void
+ec_method_encode(ec_matrix_list_t *list, uint64_t size, void *in, void **out)
+{
+    ec_method_job_t job;
+    uint32_t i;
+
+    job.func = ec_method_encode_range;
+    job.list = list;
+    job.matrix = list->encode;
+    job.data = in;
+    job.blocks = out;
+    ec_method_job_execute(&job, size, list->stripe, size);
+
+    for (i = 0; i < list->encode->rows; i++) {
+        out[i] += size / list->columns;
+    }
+}
+
+int32_t
+ec_method_decode(ec_matrix_list_t *list, uint64_t size, uintptr_t mask,
+                 uint32_t *rows, void **in, void *out)
+{
+    ec_method_job_t job;
+
+    job.matrix = ec_method_matrix_get(list, mask, rows);
+    if (EC_IS_ERR(job.matrix)) {
+        return EC_GET_ERR(job.matrix);
+    }
+
+    job.func = ec_method_decode_range;
+    job.list = list;
+    job.data = out;
+    job.blocks = in;
+    ec_method_job_execute(&job, size, EC_METHOD_CHUNK_SIZE,
+                          size * list->columns);
 
-    ec_method_matrix_put(list, matrix);
+    ec_method_matrix_put(list, job.matrix);
 
     return 0;
 }
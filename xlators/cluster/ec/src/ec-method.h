@@ -28,9 +28,16 @@
 
 #define EC_METHOD_CHUNK_SIZE (EC_METHOD_WORD_SIZE * EC_GF_BITS)
 
+/* Limits how data is split between the encoding threads */
+#define EC_METHOD_MAX_THREADS 64
+#define EC_METHOD_PIECES 4
+#define EC_METHOD_MIN_PIECE (64 * 1024)
+
+/* A systematic list keeps the data unmodified in the first columns rows. */
 int32_t
 ec_method_init(xlator_t *xl, ec_matrix_list_t *list, uint32_t columns,
-               uint32_t rows, uint32_t max, const char *gen);
+               uint32_t rows, uint32_t max, const char *gen,
+               gf_boolean_t systematic);
 
 void
 ec_method_fini(ec_matrix_list_t *list);
@@ -38,6 +45,12 @@ ec_method_fini(ec_matrix_list_t *list);
 int32_t
 ec_method_update(xlator_t *xl, ec_matrix_list_t *list, const char *gen);
 
+/* Encoding and decoding of buffers of at least threshold bytes are split
+ * between threads when threads is not 0. */
+void
+ec_method_parallel(xlator_t *xl, ec_matrix_list_t *list, uint32_t threads,
+                   uint64_t threshold);
+
 void
 ec_method_encode(ec_matrix_list_t *list, uint64_t size, void *in, void **out);
 
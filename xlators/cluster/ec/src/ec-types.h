@@ -389,6 +389,8 @@ struct _ec_fop_data {
     gf_seek_what_t seek;
     ec_fragment_range_t frag_range; /* This will hold the range of stripes
                                         affected by the fop. */
+    uintptr_t delta; /* Bricks updated by a parity delta write */
+    fd_t *delta_fd;  /* Anonymous fd used to read their fragments */
     char *errstr;                   /*String of fop name, path and gfid
                                      to be used in gf_msg. */
 };
@@ -430,6 +432,8 @@ enum _ec_gf_opcode {
     EC_GF_OP_XOR2,
     EC_GF_OP_XOR3,
     EC_GF_OP_XORM,
+    EC_GF_OP_XORX,
+    EC_GF_OP_XORXM,
     EC_GF_OP_END
 };
 
@@ -474,6 +478,11 @@ struct _ec_code_gen {
                  uint32_t src2);
     void (*xorm)(ec_code_builder_t *builder, uint32_t dst, uint32_t offset,
                  uint32_t bit);
+    /* Optional. They xor two values into dst at once. */
+    void (*xorx)(ec_code_builder_t *builder, uint32_t dst, uint32_t src1,
+                 uint32_t src2);
+    void (*xorxm)(ec_code_builder_t *builder, uint32_t dst, uint32_t src,
+                  uint32_t offset, uint32_t bit);
 };
 
 struct _ec_code {
@@ -492,6 +501,7 @@ struct _ec_code_op {
     ec_code_arg_t arg1;
     ec_code_arg_t arg2;
     ec_code_arg_t arg3;
+    ec_code_arg_t arg4;
 };
 
 struct _ec_code_builder {
@@ -533,6 +543,7 @@ union _ec_code_func {
 struct _ec_matrix_row {
     ec_code_func_t func;
     uint32_t *values;
+    int32_t copy; /* Column copied as is instead of calling func, or -1 */
 };
 
 struct _ec_matrix {
@@ -559,6 +570,9 @@ struct _ec_matrix_list {
     ec_code_t *code;
     ec_matrix_t *encode;
     ec_matrix_t **objects;
+    gf_boolean_t systematic;
+    gf_boolean_t pooled;
+    uint64_t threshold;
 };
 
 struct _ec_heal {
@@ -666,6 +680,8 @@ struct _ec {
     gf_boolean_t other_eager_lock;
     gf_boolean_t optimistic_changelog;
     gf_boolean_t parallel_writes;
+    gf_boolean_t systematic; /* New files use the systematic layout */
+    gf_boolean_t parity_delta;
     uint32_t stripe_cache;
     uint32_t quorum_count;
     uint32_t background_heals;
@@ -673,6 +689,8 @@ struct _ec {
     uint32_t self_heal_window_size; /* max size of read/writes */
     uint32_t eager_lock_timeout;
     uint32_t other_eager_lock_timeout;
+    uint32_t compute_threads;   /* Threads to encode and decode with */
+    uint64_t compute_threshold; /* Smaller buffers use a single thread */
     struct list_head pending_fops;
     struct list_head heal_waiting;
     struct list_head healing;
@@ -684,6 +702,7 @@ struct _ec {
     dict_t *leaf_to_subvolid;
     ec_read_policy_t read_policy;
     ec_matrix_list_t matrix;
+    ec_matrix_list_t systematic_matrix;
     ec_statistics_t stats;
 };
 
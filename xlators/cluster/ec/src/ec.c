@@ -197,6 +197,7 @@ __ec_destroy_private(xlator_t *this)
             dict_unref(ec->leaf_to_subvolid);
 
         ec_method_fini(&ec->matrix);
+        ec_method_fini(&ec->systematic_matrix);
 
         GF_FREE(ec);
     }
@@ -284,8 +285,14 @@ reconfigure(xlator_t *this, dict_t *options)
                      bool, failed);
     GF_OPTION_RECONF("parallel-writes", ec->parallel_writes, options, bool,
                      failed);
+    GF_OPTION_RECONF("systematic", ec->systematic, options, bool, failed);
+    GF_OPTION_RECONF("parity-delta", ec->parity_delta, options, bool, failed);
     GF_OPTION_RECONF("stripe-cache", ec->stripe_cache, options, uint32, failed);
     GF_OPTION_RECONF("quorum-count", ec->quorum_count, options, uint32, failed);
+    GF_OPTION_RECONF("compute-threads", ec->compute_threads, options, uint32,
+                     failed);
+    GF_OPTION_RECONF("compute-threshold", ec->compute_threshold, options,
+                     size_uint64, failed);
     ret = 0;
     if (ec_assign_read_policy(ec, read_policy)) {
         ret = -1;
@@ -295,6 +302,15 @@ reconfigure(xlator_t *this, dict_t *options)
     if (err != 0) {
         ret = -1;
     }
+    err = ec_method_update(this, &ec->systematic_matrix, extensions);
+    if (err != 0) {
+        ret = -1;
+    }
+
+    ec_method_parallel(this, &ec->matrix, ec->compute_threads,
+                       ec->compute_threshold);
+    ec_method_parallel(this, &ec->systematic_matrix, ec->compute_threads,
+                       ec->compute_threshold);
 
 failed:
     return ret;
@@ -524,9 +540,11 @@ static gf_boolean_t
 ec_upcall(ec_t *ec, struct gf_upcall *upcall)
 {
     struct gf_upcall_cache_invalidation *ci = NULL;
+    struct gf_upcall_cache_invalidation_batch *batch = NULL;
     struct gf_upcall_inodelk_contention *lc = NULL;
     inode_t *inode;
     inode_table_t *table;
+    uint32_t i;
 
     switch (upcall->event_type) {
         case GF_UPCALL_CACHE_INVALIDATION:
@@ -534,6 +552,14 @@ ec_upcall(ec_t *ec, struct gf_upcall *upcall)
             ci->flags |= UP_INVAL_ATTR;
             return _gf_true;
 
+        case GF_UPCALL_CACHE_INVALIDATION_BATCH:
+            batch = upcall->data;
+            for (i = 0; i < batch->count; i++) {
+                ci = batch->entries[i].data;
+                ci->flags |= UP_INVAL_ATTR;
+            }
+            return _gf_true;
+
         case GF_UPCALL_INODELK_CONTENTION:
             lc = upcall->data;
             if (strcmp(lc->domain, ec->xl->name) != 0) {
@@ -836,7 +862,11 @@ init(xlator_t *this)
     GF_OPTION_INIT("cpu-extensions", extensions, str, failed);
 
     err = ec_method_init(this, &ec->matrix, ec->fragments, ec->nodes,
-                         ec->nodes * 2, extensions);
+                         ec->nodes * 2, extensions, _gf_false);
+    if (err == 0) {
+        err = ec_method_init(this, &ec->systematic_matrix, ec->fragments,
+                             ec->nodes, ec->nodes * 2, extensions, _gf_true);
+    }
     if (err != 0) {
         gf_msg(this->name, GF_LOG_ERROR, -err, EC_MSG_MATRIX_FAILED,
                "Failed to initialize matrix management");
@@ -868,8 +898,17 @@ init(xlator_t *this)
     GF_OPTION_INIT("optimistic-change-log", ec->optimistic_changelog, bool,
                    failed);
     GF_OPTION_INIT("parallel-writes", ec->parallel_writes, bool, failed);
+    GF_OPTION_INIT("systematic", ec->systematic, bool, failed);
+    GF_OPTION_INIT("parity-delta", ec->parity_delta, bool, failed);
     GF_OPTION_INIT("stripe-cache", ec->stripe_cache, uint32, failed);
     GF_OPTION_INIT("quorum-count", ec->quorum_count, uint32, failed);
+    GF_OPTION_INIT("compute-threads", ec->compute_threads, uint32, failed);
+    GF_OPTION_INIT("compute-threshold", ec->compute_threshold, size_uint64,
+                   failed);
+    ec_method_parallel(this, &ec->matrix, ec->compute_threads,
+                       ec->compute_threshold);
+    ec_method_parallel(this, &ec->systematic_matrix, ec->compute_threads,
+                       ec->compute_threshold);
     GF_OPTION_INIT("ec-read-mask", read_mask_str, str, failed);
 
     if (ec_assign_read_mask(ec, read_mask_str))
@@ -1561,7 +1600,11 @@ ec_dump_private(xlator_t *this)
     gf_proc_dump_write("heal-waiters", "%d", ec->heal_waiters);
     gf_proc_dump_write("read-policy", "%s", ec_read_policies[ec->read_policy]);
     gf_proc_dump_write("parallel-writes", "%d", ec->parallel_writes);
+    gf_proc_dump_write("systematic", "%d", ec->systematic);
+    gf_proc_dump_write("parity-delta", "%d", ec->parity_delta);
     gf_proc_dump_write("quorum-count", "%u", ec->quorum_count);
+    gf_proc_dump_write("compute-threads", "%u", ec->compute_threads);
+    gf_proc_dump_write("compute-threshold", "%" PRIu64, ec->compute_threshold);
 
     snprintf(key_prefix, GF_DUMP_MAX_BUF_LEN, "%s.%s.stats.stripe_cache",
              this->type, this->name);
@@ -1783,7 +1826,7 @@ struct volume_options options[] = {
                     " that can wait in SHD per subvolume"},
     {.key = {"cpu-extensions"},
      .type = GF_OPTION_TYPE_STR,
-     .value = {"none", "auto", "x64", "sse", "avx"},
+     .value = {"none", "auto", "x64", "sse", "avx", "avx512"},
      .default_value = "auto",
      .op_version = {GD_OP_VERSION_3_9_0},
      .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
@@ -1852,6 +1895,59 @@ struct volume_options options[] = {
         .description = "This option can be used to choose which bricks can be"
                        " used for reading data/metadata of a file/directory",
     },
+    {
+        .key = {"systematic"},
+        .type = GF_OPTION_TYPE_BOOL,
+        .default_value = "off",
+        .op_version = {GD_OP_VERSION_11_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .tags = {"disperse"},
+        .description = "Files created while this option is enabled keep their "
+                       "data unmodified on the first disperse-data-count "
+                       "bricks, so that reads don't need to decode anything "
+                       "while those bricks are healthy. Existing files keep "
+                       "the layout they were created with.",
+    },
+    {
+        .key = {"parity-delta"},
+        .type = GF_OPTION_TYPE_BOOL,
+        .default_value = "off",
+        .op_version = {GD_OP_VERSION_11_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .tags = {"disperse"},
+        .description = "Small writes inside files with the systematic layout "
+                       "only read and write the data bricks they modify and "
+                       "the redundancy bricks, instead of rewriting whole "
+                       "stripes. It's only used while all those bricks are "
+                       "healthy.",
+    },
+    {
+        .key = {"compute-threads"},
+        .type = GF_OPTION_TYPE_INT,
+        .min = 0,
+        .max = EC_METHOD_MAX_THREADS,
+        .default_value = "0",
+        .op_version = {GD_OP_VERSION_11_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .tags = {"disperse"},
+        .description = "Number of threads, shared by all the disperse "
+                       "subvolumes of the process, that help to encode and "
+                       "decode large writes and reads. With 0 all the work "
+                       "is done by the thread handling the request.",
+    },
+    {
+        .key = {"compute-threshold"},
+        .type = GF_OPTION_TYPE_SIZET,
+        .min = 64 * GF_UNIT_KB,
+        .max = 128 * GF_UNIT_MB,
+        .default_value = "1MB",
+        .op_version = {GD_OP_VERSION_11_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .tags = {"disperse"},
+        .description = "Writes and reads of at least this size are encoded "
+                       "and decoded by several threads when compute-threads "
+                       "is not 0.",
+    },
     {
         .key = {NULL},
     },
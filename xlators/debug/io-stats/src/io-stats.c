@@ -126,6 +126,9 @@ struct ios_lat {
     double max;
     double avg;
     uint64_t total;
+    gf_latency_hist_t *hist;
+    /* Filled from 'hist' when the stats are dumped. */
+    uint64_t pct[GF_LATENCY_PERCENTILES];
 };
 
 struct ios_global_stats {
@@ -521,6 +524,21 @@ ios_bump_upcall(xlator_t *this, gf_upcall_flags_t event)
     }
 }
 
+static void
+ios_bump_upcall_ci(xlator_t *this, struct gf_upcall_cache_invalidation *up_ci)
+{
+    if (up_ci->flags & (UP_XATTR | UP_XATTR_RM))
+        ios_bump_upcall(this, GF_UPCALL_CI_XATTR);
+    if (up_ci->flags & IATT_UPDATE_FLAGS)
+        ios_bump_upcall(this, GF_UPCALL_CI_STAT);
+    if (up_ci->flags & UP_RENAME_FLAGS)
+        ios_bump_upcall(this, GF_UPCALL_CI_RENAME);
+    if (up_ci->flags & UP_FORGET)
+        ios_bump_upcall(this, GF_UPCALL_CI_FORGET);
+    if (up_ci->flags & UP_NLINK)
+        ios_bump_upcall(this, GF_UPCALL_CI_NLINK);
+}
+
 static void
 ios_bump_stats(xlator_t *this, struct ios_stat *iosstat, ios_stats_type_t type)
 {
@@ -876,6 +894,13 @@ io_stats_dump_global_to_json_logfp(xlator_t *this,
                 key_prefix, str_prefix, lc_fop_name, fop_lat_min);
         ios_log(this, logfp, "\"%s.%s.fop.%s.latency_max_usec\": %0.2lf,",
                 key_prefix, str_prefix, lc_fop_name, fop_lat_max);
+        for (j = 0; j < GF_LATENCY_PERCENTILES; j++) {
+            ios_log(this, logfp,
+                    "\"%s.%s.fop.%s.latency_%s_usec\": %" PRIu64 ",",
+                    key_prefix, str_prefix, lc_fop_name,
+                    gf_latency_percentile_names[j],
+                    fop_hits ? stats->latency[i].pct[j] : 0);
+        }
 
         fop_ave_usec_sum += fop_lat_ave;
         weighted_fop_ave_usec_sum += fop_hits * fop_lat_ave;
@@ -1290,6 +1315,22 @@ io_stats_dump_global_to_logfp(xlator_t *this, struct ios_global_stats *stats,
                     stats->latency[i].min, stats->latency[i].max);
     }
 
+    ios_log(this, logfp, "\n%-13s %14s %14s %14s %14s", "Fop", "P50-Latency",
+            "P90-Latency", "P99-Latency", "P99.9-Latency");
+    ios_log(this, logfp, "%-13s %14s %14s %14s %14s", "---", "-----------",
+            "-----------", "-----------", "-------------");
+
+    for (i = 0; i < GF_FOP_MAXVALUE; i++) {
+        if (!GF_ATOMIC_GET(stats->fop_hits[i]) || !stats->latency[i].avg)
+            continue;
+        ios_log(this, logfp,
+                "%-13s %11" PRIu64 " us %11" PRIu64 " us %11" PRIu64
+                " us %11" PRIu64 " us",
+                gf_fop_list[i], stats->latency[i].pct[0],
+                stats->latency[i].pct[1], stats->latency[i].pct[2],
+                stats->latency[i].pct[3]);
+    }
+
     for (i = 0; i < GF_UPCALL_FLAGS_MAXVALUE; i++) {
         fop_hits = GF_ATOMIC_GET(stats->upcall_hits[i]);
         if (fop_hits)
@@ -1366,6 +1407,7 @@ io_stats_dump_global_to_dict(xlator_t *this, struct ios_global_stats *stats,
     char key[64] = {0};
     uint64_t sec = 0;
     int i = 0;
+    int j = 0;
     uint64_t count = 0;
     uint64_t fop_hits = 0;
 
@@ -1488,6 +1530,19 @@ io_stats_dump_global_to_dict(xlator_t *this, struct ios_global_stats *stats,
                    gf_fop_list[i], interval, stats->latency[i].max);
             goto out;
         }
+        for (j = 0; j < GF_LATENCY_PERCENTILES; j++) {
+            snprintf(key, sizeof(key), "%d-%d-%slatency", interval, i,
+                     gf_latency_percentile_names[j]);
+            ret = dict_set_uint64(dict, key, stats->latency[i].pct[j]);
+            if (ret) {
+                gf_log(this->name, GF_LOG_ERROR,
+                       "failed to set %s "
+                       "%slatency(%d) with %" PRIu64,
+                       gf_fop_list[i], gf_latency_percentile_names[j],
+                       interval, stats->latency[i].pct[j]);
+                goto out;
+            }
+        }
     }
     for (i = 0; i < GF_UPCALL_FLAGS_MAXVALUE; i++) {
         fop_hits = GF_ATOMIC_GET(stats->upcall_hits[i]);
@@ -1570,13 +1625,35 @@ ios_dump_args_init(struct ios_dump_args *args, ios_dump_type_t type,
 static void
 ios_global_stats_clear(struct ios_global_stats *stats, time_t now)
 {
+    gf_latency_hist_t *hist[GF_FOP_MAXVALUE];
+    int i;
+
     GF_ASSERT(stats);
     GF_ASSERT(now);
 
+    /* Histograms are kept, only their counters are cleared. */
+    for (i = 0; i < GF_FOP_MAXVALUE; i++) {
+        hist[i] = stats->latency[i].hist;
+        gf_latency_hist_reset(hist[i]);
+    }
     memset(stats, 0, sizeof(*stats));
+    for (i = 0; i < GF_FOP_MAXVALUE; i++) {
+        stats->latency[i].hist = hist[i];
+    }
     stats->started_at = now;
 }
 
+static void
+ios_global_stats_percentiles(struct ios_global_stats *stats)
+{
+    int i;
+
+    for (i = 0; i < GF_FOP_MAXVALUE; i++) {
+        gf_latency_hist_percentiles(stats->latency[i].hist,
+                                    stats->latency[i].pct);
+    }
+}
+
 int
 io_stats_dump(xlator_t *this, struct ios_dump_args *args, ios_info_op_t op,
               gf_boolean_t is_peek)
@@ -1597,11 +1674,14 @@ io_stats_dump(xlator_t *this, struct ios_dump_args *args, ios_info_op_t op,
 
     LOCK(&conf->lock);
     {
-        if (op == GF_IOS_INFO_ALL || op == GF_IOS_INFO_CUMULATIVE)
+        if (op == GF_IOS_INFO_ALL || op == GF_IOS_INFO_CUMULATIVE) {
             cumulative = conf->cumulative;
+            ios_global_stats_percentiles(&cumulative);
+        }
 
         if (op == GF_IOS_INFO_ALL || op == GF_IOS_INFO_INCREMENTAL) {
             incremental = conf->incremental;
+            ios_global_stats_percentiles(&incremental);
             increment = conf->increment;
 
             if (!is_peek) {
@@ -1742,6 +1822,8 @@ update_ios_latency_stats(struct ios_global_stats *stats, int64_t elapsed,
 
     stats->latency[op].avg = avg + (elapsed - avg) /
                                        GF_ATOMIC_GET(stats->fop_hits[op]);
+
+    gf_latency_hist_update(&stats->latency[op].hist, elapsed);
 }
 
 int
@@ -3594,6 +3676,7 @@ io_priv(xlator_t *this)
     char key_prefix_incremental[GF_DUMP_MAX_BUF_LEN];
     double min, max, avg;
     uint64_t count, total;
+    uint64_t pct[GF_LATENCY_PERCENTILES];
     struct ios_conf *conf = NULL;
 
     conf = this->private;
@@ -3624,24 +3707,32 @@ io_priv(xlator_t *this)
         min = conf->cumulative.latency[i].min;
         max = conf->cumulative.latency[i].max;
         avg = conf->cumulative.latency[i].avg;
+        gf_latency_hist_percentiles(conf->cumulative.latency[i].hist, pct);
 
         gf_proc_dump_build_key(key, key_prefix_cumulative, "%s",
                                (char *)gf_fop_list[i]);
 
-        gf_proc_dump_write(key, "%" PRId64 ",%" PRId64 ",%.03f,%.03f,%.03f",
-                           count, total, min, max, avg);
+        gf_proc_dump_write(key,
+                           "%" PRId64 ",%" PRId64 ",%.03f,%.03f,%.03f,%" PRIu64
+                           ",%" PRIu64 ",%" PRIu64 ",%" PRIu64,
+                           count, total, min, max, avg, pct[0], pct[1], pct[2],
+                           pct[3]);
 
         count = GF_ATOMIC_GET(conf->incremental.fop_hits[i]);
         total = conf->incremental.latency[i].total;
         min = conf->incremental.latency[i].min;
         max = conf->incremental.latency[i].max;
         avg = conf->incremental.latency[i].avg;
+        gf_latency_hist_percentiles(conf->incremental.latency[i].hist, pct);
 
         gf_proc_dump_build_key(key, key_prefix_incremental, "%s",
                                (char *)gf_fop_list[i]);
 
-        gf_proc_dump_write(key, "%" PRId64 ",%" PRId64 ",%.03f,%.03f,%.03f",
-                           count, total, min, max, avg);
+        gf_proc_dump_write(key,
+                           "%" PRId64 ",%" PRId64 ",%.03f,%.03f,%.03f,%" PRIu64
+                           ",%" PRIu64 ",%" PRIu64 ",%" PRIu64,
+                           count, total, min, max, avg, pct[0], pct[1], pct[2],
+                           pct[3]);
     }
 
     return 0;
@@ -3830,9 +3921,16 @@ mem_acct_init(xlator_t *this)
 void
 ios_conf_destroy(struct ios_conf *conf)
 {
+    int i;
+
     if (!conf)
         return;
 
+    for (i = 0; i < GF_FOP_MAXVALUE; i++) {
+        GF_FREE(conf->cumulative.latency[i].hist);
+        GF_FREE(conf->incremental.latency[i].hist);
+    }
+
     ios_destroy_top_stats(conf);
     _ios_destroy_dump_thread(conf);
     ios_destroy_sample_buf(conf->ios_sample_buf);
@@ -4047,7 +4145,8 @@ notify(xlator_t *this, int32_t event, void *data, ...)
     gf_boolean_t is_peek = _gf_false;
     va_list ap;
     struct gf_upcall *up_data = NULL;
-    struct gf_upcall_cache_invalidation *up_ci = NULL;
+    struct gf_upcall_cache_invalidation_batch *batch = NULL;
+    uint32_t n = 0;
 
     dict = data;
     va_start(ap, data);
@@ -4137,18 +4236,13 @@ notify(xlator_t *this, int32_t event, void *data, ...)
                     ios_bump_upcall(this, GF_UPCALL_LEASE_RECALL);
                     break;
                 case GF_UPCALL_CACHE_INVALIDATION:
-                    up_ci = (struct gf_upcall_cache_invalidation *)
+                    ios_bump_upcall_ci(this, up_data->data);
+                    break;
+                case GF_UPCALL_CACHE_INVALIDATION_BATCH:
+                    batch = (struct gf_upcall_cache_invalidation_batch *)
                                 up_data->data;
-                    if (up_ci->flags & (UP_XATTR | UP_XATTR_RM))
-                        ios_bump_upcall(this, GF_UPCALL_CI_XATTR);
-                    if (up_ci->flags & IATT_UPDATE_FLAGS)
-                        ios_bump_upcall(this, GF_UPCALL_CI_STAT);
-                    if (up_ci->flags & UP_RENAME_FLAGS)
-                        ios_bump_upcall(this, GF_UPCALL_CI_RENAME);
-                    if (up_ci->flags & UP_FORGET)
-                        ios_bump_upcall(this, GF_UPCALL_CI_FORGET);
-                    if (up_ci->flags & UP_NLINK)
-                        ios_bump_upcall(this, GF_UPCALL_CI_NLINK);
+                    for (n = 0; n < batch->count; n++)
+                        ios_bump_upcall_ci(this, batch->entries[n].data);
                     break;
                 default:
                     gf_msg_debug(this->name, 0,
@@ -18,6 +18,9 @@ enum gf_index_mem_types_ {
     gf_index_inode_ctx_t,
     gf_index_fd_ctx_t,
     gf_index_mt_local_t,
+    gf_index_mt_pending_entry_t,
+    gf_index_mt_pending_buckets_t,
+    gf_index_mt_pending_sorted_t,
     gf_index_mt_end
 };
 #endif
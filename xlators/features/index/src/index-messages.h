@@ -28,6 +28,7 @@ GLFS_MSGID(INDEX, INDEX_MSG_INDEX_DIR_CREATE_FAILED,
            INDEX_MSG_INDEX_DEL_FAILED, INDEX_MSG_DICT_SET_FAILED,
            INDEX_MSG_INODE_CTX_GET_SET_FAILED, INDEX_MSG_INVALID_ARGS,
            INDEX_MSG_FD_OP_FAILED, INDEX_MSG_WORKER_THREAD_CREATE_FAILED,
-           INDEX_MSG_INVALID_GRAPH);
+           INDEX_MSG_INVALID_GRAPH, INDEX_MSG_PENDING_STORE_FAILED,
+           INDEX_MSG_PENDING_STORE_LOADED);
 
 #endif /* !_INDEX_MESSAGES_H_ */
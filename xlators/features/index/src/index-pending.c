@@ -0,0 +1,852 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+#include "index.h"
+#include <glusterfs/syscall.h>
+#include "index-messages.h"
+
+#define INDEX_PENDING_MAGIC 0x47504c00 /* "GPL" followed by the op */
+#define INDEX_PENDING_ADD 1
+#define INDEX_PENDING_DEL 2
+
+#define INDEX_PENDING_BUCKETS 1024
+#define INDEX_PENDING_CHUNK 1024 /* records written at once when compacting */
+/* Compact the log when it has that many more records than entries */
+#define INDEX_PENDING_SLACK 4096
+
+/* Record of the log, in network byte order. */
+typedef struct index_pending_record {
+    uint32_t magic;
+    uint32_t info; /* type << 8 | flags */
+    uuid_t gfid;
+    uint64_t since;
+} index_pending_record_t;
+
+typedef struct index_pending_sort {
+    uuid_t gfid;
+    time_t since;
+    int rank;
+} index_pending_sort_t;
+
+static uint32_t
+index_pending_hash(index_pending_t *pending, uuid_t gfid)
+{
+    uint32_t hash;
+
+    /* The last bytes of a gfid are random. */
+    memcpy(&hash, gfid + sizeof(uuid_t) - sizeof(hash), sizeof(hash));
+
+    return hash & (pending->bucket_count - 1);
+}
+
+static index_pending_entry_t *
+__index_pending_find(index_pending_t *pending, uuid_t gfid)
+{
+    index_pending_entry_t *entry = NULL;
+    struct list_head *bucket;
+
+    bucket = &pending->buckets[index_pending_hash(pending, gfid)];
+    list_for_each_entry(entry, bucket, hash)
+    {
+        if (gf_uuid_compare(entry->gfid, gfid) == 0)
+            return entry;
+    }
+
+    return NULL;
+}
+
+static int
+__index_pending_rehash(index_pending_t *pending, uint32_t bucket_count)
+{
+    struct list_head *old = pending->buckets;
+    uint32_t old_count = pending->bucket_count;
+    index_pending_entry_t *entry = NULL;
+    index_pending_entry_t *tmp = NULL;
+    uint32_t i;
+
+    pending->buckets = GF_MALLOC(bucket_count * sizeof(*pending->buckets),
+                                 gf_index_mt_pending_buckets_t);
+    if (!pending->buckets) {
+        pending->buckets = old;
+        return -ENOMEM;
+    }
+    pending->bucket_count = bucket_count;
+    for (i = 0; i < bucket_count; i++)
+        INIT_LIST_HEAD(&pending->buckets[i]);
+
+    for (i = 0; i < old_count; i++) {
+        list_for_each_entry_safe(entry, tmp, &old[i], hash)
+        {
+            list_move(&entry->hash,
+                      &pending->buckets[index_pending_hash(pending,
+                                                           entry->gfid)]);
+        }
+    }
+    GF_FREE(old);
+
+    return 0;
+}
+
+static index_pending_entry_t *
+__index_pending_insert(index_pending_t *pending, uuid_t gfid, time_t since,
+                       ia_type_t type, uint32_t flags)
+{
+    index_pending_entry_t *entry = NULL;
+
+    /* Failing to grow the table only makes the buckets longer. */
+    if (pending->count >= 2 * (uint64_t)pending->bucket_count)
+        (void)__index_pending_rehash(pending, 2 * pending->bucket_count);
+
+    entry = GF_MALLOC(sizeof(*entry), gf_index_mt_pending_entry_t);
+    if (!entry)
+        return NULL;
+
+    gf_uuid_copy(entry->gfid, gfid);
+    entry->since = since;
+    entry->type = type;
+    entry->flags = flags;
+    list_add(&entry->hash,
+             &pending->buckets[index_pending_hash(pending, gfid)]);
+    pending->count++;
+
+    return entry;
+}
+
+static void
+__index_pending_remove(index_pending_t *pending, index_pending_entry_t *entry)
+{
+    list_del(&entry->hash);
+    GF_FREE(entry);
+    pending->count--;
+}
+
+static void
+__index_pending_clear(index_pending_t *pending)
+{
+    index_pending_entry_t *entry = NULL;
+    index_pending_entry_t *tmp = NULL;
+    uint32_t i;
+
+    for (i = 0; i < pending->bucket_count; i++) {
+        list_for_each_entry_safe(entry, tmp, &pending->buckets[i], hash)
+        {
+            __index_pending_remove(pending, entry);
+        }
+    }
+}
+
+/* Once an entry can't be tracked, the store can't tell anymore what's in the
+ * index. Everything falls back to the directory until the next start. */
+static void
+__index_pending_break(xlator_t *this, index_pending_t *pending)
+{
+    gf_msg(this->name, GF_LOG_ERROR, ENOMEM, INDEX_MSG_PENDING_STORE_FAILED,
+           "failed to track an entry pending heal, using the index directory "
+           "only");
+    pending->ready = _gf_false;
+    pending->broken = _gf_true;
+}
+
+static void
+index_pending_record_fill(index_pending_record_t *record, uint32_t op,
+                          uuid_t gfid, ia_type_t type, uint32_t flags,
+                          time_t since)
+{
+    record->magic = hton32(INDEX_PENDING_MAGIC | op);
+    record->info = hton32((type << 8) | (flags & INDEX_PENDING_DATA));
+    gf_uuid_copy(record->gfid, gfid);
+    record->since = hton64(since);
+}
+
+static void
+__index_pending_append(xlator_t *this, index_pending_t *pending, uint32_t op,
+                       index_pending_entry_t *entry, uuid_t gfid)
+{
+    index_pending_record_t record;
+    ssize_t ret;
+
+    if (pending->fd < 0)
+        return;
+
+    if (entry)
+        index_pending_record_fill(&record, op, entry->gfid, entry->type,
+                                  entry->flags, entry->since);
+    else
+        index_pending_record_fill(&record, op, gfid, IA_INVAL, 0, 0);
+
+    ret = sys_write(pending->fd, &record, sizeof(record));
+    if (ret != sizeof(record)) {
+        /* Only the priorities are lost: the entries are checked against
+         * the directory at each start anyway. */
+        gf_msg(this->name, GF_LOG_ERROR, (ret < 0) ? errno : EIO,
+               INDEX_MSG_PENDING_STORE_FAILED,
+               "failed to write the pending-heal log %s", pending->log);
+        sys_close(pending->fd);
+        pending->fd = -1;
+        return;
+    }
+    pending->records++;
+}
+
+static int
+index_pending_write(int fd, index_pending_record_t *records, uint64_t count)
+{
+    size_t size = count * sizeof(*records);
+
+    if (sys_write(fd, records, size) != size)
+        return -1;
+
+    return 0;
+}
+
+/*
+ * Rewrites the log with one record per entry, and reopens it for appending.
+ * It's done by the thread of the store, and the lock is only taken to copy a
+ * few buckets at a time: the records the fops append meanwhile are copied
+ * from the end of the old log just before the new one replaces it, and they
+ * supersede what was copied from the table. A rehash moves the entries to
+ * other buckets, so it makes the compaction start again later.
+ */
+static int
+index_pending_compact(xlator_t *this, index_pending_t *pending)
+{
+    char tmp_log[PATH_MAX] = {
+        0,
+    };
+    index_pending_record_t *records = NULL;
+    index_pending_entry_t *entry = NULL;
+    struct stat st = {
+        0,
+    };
+    gf_boolean_t failed = _gf_false;
+    uint64_t filled = 0;
+    uint64_t n = 0;
+    uint32_t buckets = 0;
+    uint32_t i = 0;
+    off_t offset = 0;
+    ssize_t size;
+    int log = -1;
+    int fd = -1;
+    int ret = -1;
+
+    snprintf(tmp_log, sizeof(tmp_log), "%s.tmp", pending->log);
+
+    /* Room for a whole bucket after a chunk is filled, so that the lock is
+     * released between chunks. */
+    records = GF_MALLOC(2 * INDEX_PENDING_CHUNK * sizeof(*records),
+                        gf_index_mt_pending_sorted_t);
+    if (!records) {
+        errno = ENOMEM;
+        goto out;
+    }
+
+    fd = sys_open(tmp_log, O_CREAT | O_TRUNC | O_WRONLY, 0600);
+    if (fd < 0)
+        goto out;
+
+    pthread_mutex_lock(&pending->lock);
+    {
+        if ((pending->fd < 0) || sys_fstat(pending->fd, &st))
+            failed = _gf_true;
+        offset = st.st_size;
+        buckets = pending->bucket_count;
+    }
+    pthread_mutex_unlock(&pending->lock);
+    if (failed)
+        goto out;
+
+    while (i < buckets) {
+        pthread_mutex_lock(&pending->lock);
+        {
+            if (pending->bucket_count != buckets) {
+                errno = EAGAIN;
+                failed = _gf_true;
+                goto unlock;
+            }
+            for (; (i < buckets) && (filled < INDEX_PENDING_CHUNK); i++) {
+                list_for_each_entry(entry, &pending->buckets[i], hash)
+                {
+                    if (filled == 2 * INDEX_PENDING_CHUNK) {
+                        if (index_pending_write(fd, records, filled)) {
+                            failed = _gf_true;
+                            goto unlock;
+                        }
+                        n += filled;
+                        filled = 0;
+                    }
+                    index_pending_record_fill(&records[filled++],
+                                              INDEX_PENDING_ADD, entry->gfid,
+                                              entry->type, entry->flags,
+                                              entry->since);
+                }
+            }
+        }
+    unlock:
+        pthread_mutex_unlock(&pending->lock);
+        if (failed)
+            goto out;
+
+        if (filled && index_pending_write(fd, records, filled))
+            goto out;
+        n += filled;
+        filled = 0;
+    }
+
+    if (sys_fsync(fd))
+        goto out;
+
+    pthread_mutex_lock(&pending->lock);
+    {
+        failed = _gf_true;
+        if (pending->fd < 0)
+            goto done;
+
+        log = sys_open(pending->log, O_RDONLY, 0);
+        if (log < 0)
+            goto done;
+        while ((size = sys_pread(log, records,
+                                 2 * INDEX_PENDING_CHUNK * sizeof(*records),
+                                 offset)) > 0) {
+            if (sys_write(fd, records, size) != size)
+                goto done;
+            offset += size;
+            n += size / sizeof(*records);
+        }
+        if (size < 0)
+            goto done;
+
+        if (sys_fsync(fd) || sys_rename(tmp_log, pending->log))
+            goto done;
+
+        sys_close(pending->fd);
+        pending->fd = sys_open(pending->log, O_WRONLY | O_APPEND, 0600);
+        if (pending->fd < 0)
+            goto done;
+        pending->records = n;
+
+        failed = _gf_false;
+    }
+done:
+    pthread_mutex_unlock(&pending->lock);
+    if (!failed)
+        ret = 0;
+
+out:
+    if (ret) {
+        if (errno != EAGAIN)
+            gf_msg(this->name, GF_LOG_ERROR, errno,
+                   INDEX_MSG_PENDING_STORE_FAILED,
+                   "failed to write the pending-heal log %s", pending->log);
+        sys_unlink(tmp_log);
+    }
+    if (log >= 0)
+        sys_close(log);
+    if (fd >= 0)
+        sys_close(fd);
+    GF_FREE(records);
+
+    return ret;
+}
+
+/* Asks the thread of the store to compact the log if it has grown too big */
+static void
+__index_pending_compact_check(index_pending_t *pending)
+{
+    if ((pending->fd >= 0) && !pending->reconciling && !pending->compact &&
+        (pending->records > 2 * pending->count + INDEX_PENDING_SLACK)) {
+        pending->compact = _gf_true;
+        pthread_cond_signal(&pending->cond);
+    }
+}
+
+/* Loads what the log knows about the entries. A torn record or garbage at its
+ * end only means that the brick didn't stop cleanly. */
+static void
+__index_pending_replay(xlator_t *this, index_pending_t *pending)
+{
+    index_pending_record_t record;
+    index_pending_entry_t *entry = NULL;
+    uint32_t magic;
+    uint32_t info;
+    int fd;
+
+    fd = sys_open(pending->log, O_RDONLY, 0);
+    if (fd < 0)
+        return;
+
+    while (sys_read(fd, &record, sizeof(record)) == sizeof(record)) {
+        magic = ntoh32(record.magic);
+        info = ntoh32(record.info);
+        if ((magic & ~0xff) != INDEX_PENDING_MAGIC)
+            break;
+
+        entry = __index_pending_find(pending, record.gfid);
+        if ((magic & 0xff) == INDEX_PENDING_DEL) {
+            if (entry)
+                __index_pending_remove(pending, entry);
+        } else if (entry) {
+            entry->flags = info & INDEX_PENDING_DATA;
+        } else if (!__index_pending_insert(pending, record.gfid,
+                                           ntoh64(record.since), info >> 8,
+                                           info & INDEX_PENDING_DATA)) {
+            break;
+        }
+    }
+
+    sys_close(fd);
+}
+
+/*
+ * Makes the table match the index directory: entries the log doesn't know are
+ * added as of now, and the ones which are gone are dropped. Fops keep updating
+ * the table meanwhile. An entry added by them is marked as seen, so that it's
+ * kept. One being deleted is removed from the table, but the scan may still
+ * have read its name before: the scan inserts first and then checks that the
+ * entry still exists, as a deletion after the insertion removes it anyway.
+ */
+static void *
+index_pending_reconcile(void *data)
+{
+    xlator_t *this = data;
+    index_priv_t *priv = this->private;
+    index_pending_t *pending = &priv->pending;
+    index_pending_entry_t *entry = NULL;
+    index_pending_entry_t *tmp = NULL;
+    struct dirent *dirent = NULL;
+    struct dirent scratch[2] = {
+        {
+            0,
+        },
+    };
+    char path[PATH_MAX] = {
+        0,
+    };
+    struct stat st = {
+        0,
+    };
+    gf_boolean_t inserted;
+    size_t len = strlen(pending->subdir);
+    time_t now = gf_time();
+    uuid_t gfid;
+    DIR *dirp = NULL;
+    uint64_t added = 0;
+    uint32_t i;
+    int ret = -1;
+
+    THIS = this;
+
+    dirp = sys_opendir(pending->dir);
+    if (!dirp)
+        goto out;
+
+    while (!pending->stop) {
+        errno = 0;
+        dirent = sys_readdir(dirp, scratch);
+        if (!dirent || errno != 0)
+            break;
+
+        /* The base files all the entries are linked to */
+        if (!strncmp(dirent->d_name, pending->subdir, len))
+            continue;
+        if (gf_uuid_parse(dirent->d_name, gfid))
+            continue;
+
+        inserted = _gf_false;
+        pthread_mutex_lock(&pending->lock);
+        {
+            entry = __index_pending_find(pending, gfid);
+            if (!entry) {
+                entry = __index_pending_insert(pending, gfid, now, IA_INVAL,
+                                               INDEX_PENDING_DATA);
+                if (!entry)
+                    __index_pending_break(this, pending);
+                inserted = _gf_true;
+            }
+            if (entry)
+                entry->flags |= INDEX_PENDING_SEEN;
+        }
+        pthread_mutex_unlock(&pending->lock);
+        if (!entry)
+            break;
+
+        if (!inserted)
+            continue;
+        added++;
+
+        snprintf(path, sizeof(path), "%s/%s", pending->dir, dirent->d_name);
+        if ((sys_lstat(path, &st) == 0) || (errno != ENOENT))
+            continue;
+
+        pthread_mutex_lock(&pending->lock);
+        {
+            entry = __index_pending_find(pending, gfid);
+            if (entry)
+                __index_pending_remove(pending, entry);
+        }
+        pthread_mutex_unlock(&pending->lock);
+    }
+    if (dirent || pending->stop)
+        goto out;
+
+    pthread_mutex_lock(&pending->lock);
+    {
+        for (i = 0; i < pending->bucket_count; i++) {
+            list_for_each_entry_safe(entry, tmp, &pending->buckets[i], hash)
+            {
+                if (entry->flags & INDEX_PENDING_SEEN)
+                    entry->flags &= ~INDEX_PENDING_SEEN;
+                else
+                    __index_pending_remove(pending, entry);
+            }
+        }
+        pending->reconciling = _gf_false;
+        if (!pending->broken) {
+            pending->compact = _gf_true;
+            pending->ready = _gf_true;
+        }
+
+        gf_msg(this->name, GF_LOG_INFO, 0, INDEX_MSG_PENDING_STORE_LOADED,
+               "%" PRIu64 " entries pending heal in %s, %" PRIu64
+               " of them unknown to the log",
+               pending->count, pending->dir, added);
+    }
+    pthread_mutex_unlock(&pending->lock);
+
+    ret = 0;
+out:
+    if (dirp)
+        (void)sys_closedir(dirp);
+    if (ret && !pending->stop)
+        gf_msg(this->name, GF_LOG_ERROR, errno, INDEX_MSG_PENDING_STORE_FAILED,
+               "failed to read %s, using the index directory only",
+               pending->dir);
+
+    /* From now on the thread compacts the log when the fops ask for it. */
+    pthread_mutex_lock(&pending->lock);
+    while (!ret && !pending->stop) {
+        if (!pending->compact) {
+            pthread_cond_wait(&pending->cond, &pending->lock);
+            continue;
+        }
+        pending->compact = _gf_false;
+        pthread_mutex_unlock(&pending->lock);
+
+        (void)index_pending_compact(this, pending);
+
+        pthread_mutex_lock(&pending->lock);
+    }
+    pthread_mutex_unlock(&pending->lock);
+
+    return NULL;
+}
+
+int
+index_pending_init(xlator_t *this, const char *subdir)
+{
+    index_priv_t *priv = this->private;
+    index_pending_t *pending = &priv->pending;
+    int ret;
+
+    pending->fd = -1;
+    ret = pthread_mutex_init(&pending->lock, NULL);
+    if (ret)
+        return -ret;
+    ret = pthread_cond_init(&pending->cond, NULL);
+    if (ret) {
+        pthread_mutex_destroy(&pending->lock);
+        return -ret;
+    }
+    ret = __index_pending_rehash(pending, INDEX_PENDING_BUCKETS);
+    if (ret)
+        goto out;
+
+    pending->subdir = gf_strdup(subdir);
+    if (!pending->subdir ||
+        (gf_asprintf(&pending->dir, "%s/%s", priv->index_basepath, subdir) <
+         0) ||
+        (gf_asprintf(&pending->log, "%s/%s.log", priv->index_basepath,
+                     subdir) < 0)) {
+        ret = -ENOMEM;
+        goto out;
+    }
+
+    __index_pending_replay(this, pending);
+
+    pending->fd = sys_open(pending->log, O_CREAT | O_WRONLY | O_APPEND, 0600);
+    if (pending->fd < 0)
+        gf_msg(this->name, GF_LOG_WARNING, errno,
+               INDEX_MSG_PENDING_STORE_FAILED,
+               "failed to open the pending-heal log %s", pending->log);
+
+    /* Fops update the table from now on, but it's only used once it has
+     * been checked against the directory. */
+    pending->reconciling = _gf_true;
+    pending->loaded = _gf_true;
+    ret = gf_thread_create(&pending->thread, NULL, index_pending_reconcile,
+                           this, "idxpend");
+    if (ret) {
+        ret = -ret;
+        pending->loaded = _gf_false;
+        goto out;
+    }
+    pending->thread_running = _gf_true;
+out:
+    if (ret) {
+        gf_msg(this->name, GF_LOG_WARNING, -ret, INDEX_MSG_PENDING_STORE_FAILED,
+               "failed to load the pending-heal log, using the index "
+               "directory only");
+        index_pending_fini(this);
+    }
+
+    return ret;
+}
+
+void
+index_pending_fini(xlator_t *this)
+{
+    index_priv_t *priv = this->private;
+    index_pending_t *pending = &priv->pending;
+
+    if (!pending->buckets)
+        return;
+
+    if (pending->thread_running) {
+        pthread_mutex_lock(&pending->lock);
+        {
+            pending->stop = _gf_true;
+            pthread_cond_signal(&pending->cond);
+        }
+        pthread_mutex_unlock(&pending->lock);
+        pthread_join(pending->thread, NULL);
+        pending->thread_running = _gf_false;
+    }
+
+    if (pending->fd >= 0)
+        sys_close(pending->fd);
+    pending->fd = -1;
+    __index_pending_clear(pending);
+    GF_FREE(pending->buckets);
+    pending->buckets = NULL;
+    GF_FREE(pending->subdir);
+    GF_FREE(pending->dir);
+    GF_FREE(pending->log);
+    pending->loaded = _gf_false;
+    pending->ready = _gf_false;
+    pthread_cond_destroy(&pending->cond);
+    pthread_mutex_destroy(&pending->lock);
+}
+
+/* Called before linking the entry in the index, so that the table never
+ * misses one which is there, even if the brick dies in between. */
+void
+index_pending_add(xlator_t *this, uuid_t gfid, ia_type_t type,
+                  gf_boolean_t data)
+{
+    index_priv_t *priv = this->private;
+    index_pending_t *pending = &priv->pending;
+    index_pending_entry_t *entry = NULL;
+    uint32_t flags = data ? INDEX_PENDING_DATA : 0;
+
+    if (!pending->loaded)
+        return;
+
+    pthread_mutex_lock(&pending->lock);
+    {
+        if (pending->broken)
+            goto unlock;
+
+        entry = __index_pending_find(pending, gfid);
+        if (entry) {
+            if (pending->reconciling)
+                entry->flags |= INDEX_PENDING_SEEN;
+            /* The entry keeps its age, and a data heal is needed until
+             * it's healed: only a new type or data heal is recorded. */
+            if (((entry->flags | flags) == entry->flags) &&
+                ((entry->type != IA_INVAL) || (type == IA_INVAL)))
+                goto unlock;
+            entry->flags |= flags;
+            if (entry->type == IA_INVAL)
+                entry->type = type;
+        } else {
+            if (pending->reconciling)
+                flags |= INDEX_PENDING_SEEN;
+            entry = __index_pending_insert(pending, gfid, gf_time(), type,
+                                           flags);
+            if (!entry) {
+                __index_pending_break(this, pending);
+                goto unlock;
+            }
+        }
+
+        __index_pending_append(this, pending, INDEX_PENDING_ADD, entry, NULL);
+        __index_pending_compact_check(pending);
+    }
+unlock:
+    pthread_mutex_unlock(&pending->lock);
+}
+
+/* Called once the entry is unlinked from the index. */
+void
+index_pending_del(xlator_t *this, uuid_t gfid)
+{
+    index_priv_t *priv = this->private;
+    index_pending_t *pending = &priv->pending;
+    index_pending_entry_t *entry = NULL;
+
+    if (!pending->loaded)
+        return;
+
+    pthread_mutex_lock(&pending->lock);
+    {
+        entry = __index_pending_find(pending, gfid);
+        if (!entry)
+            goto unlock;
+        __index_pending_remove(pending, entry);
+
+        __index_pending_append(this, pending, INDEX_PENDING_DEL, NULL, gfid);
+        __index_pending_compact_check(pending);
+    }
+unlock:
+    pthread_mutex_unlock(&pending->lock);
+}
+
+gf_boolean_t
+index_pending_has(xlator_t *this, uuid_t gfid)
+{
+    index_priv_t *priv = this->private;
+    index_pending_t *pending = &priv->pending;
+    gf_boolean_t found = _gf_true;
+
+    if (!pending->ready)
+        return found;
+
+    pthread_mutex_lock(&pending->lock);
+    {
+        found = (__index_pending_find(pending, gfid) != NULL);
+    }
+    pthread_mutex_unlock(&pending->lock);
+
+    return found;
+}
+
+int
+index_pending_count(xlator_t *this, uint64_t *count)
+{
+    index_priv_t *priv = this->private;
+    index_pending_t *pending = &priv->pending;
+    int ret = -1;
+
+    if (!pending->ready)
+        return ret;
+
+    pthread_mutex_lock(&pending->lock);
+    {
+        if (pending->ready) {
+            *count = pending->count;
+            ret = 0;
+        }
+    }
+    pthread_mutex_unlock(&pending->lock);
+
+    return ret;
+}
+
+/*
+ * Order in which the self-heal daemon should heal the entries: directories
+ * first, as healing them creates what is missing below them; then the entries
+ * needing no data heal, which are cheap; and in each group the oldest first.
+ */
+static int
+index_pending_rank(index_pending_entry_t *entry)
+{
+    int rank = 0;
+
+    if (entry->type != IA_IFDIR)
+        rank += 2;
+    if (entry->flags & INDEX_PENDING_DATA)
+        rank += 1;
+
+    return rank;
+}
+
+static int
+index_pending_sort_cmp(const void *a, const void *b)
+{
+    const index_pending_sort_t *x = a;
+    const index_pending_sort_t *y = b;
+
+    if (x->rank != y->rank)
+        return x->rank - y->rank;
+    if (x->since != y->since)
+        return (x->since < y->since) ? -1 : 1;
+
+    return memcmp(x->gfid, y->gfid, sizeof(uuid_t));
+}
+
+int
+index_pending_sorted(xlator_t *this, uuid_t **gfids, uint64_t *count)
+{
+    index_priv_t *priv = this->private;
+    index_pending_t *pending = &priv->pending;
+    index_pending_entry_t *entry = NULL;
+    index_pending_sort_t *sort = NULL;
+    uuid_t *sorted = NULL;
+    uint64_t n = 0;
+    uint64_t i;
+    uint32_t b;
+    int ret = -ENOTSUP;
+
+    if (!pending->ready)
+        return ret;
+
+    pthread_mutex_lock(&pending->lock);
+    {
+        if (!pending->ready)
+            goto unlock;
+
+        ret = -ENOMEM;
+        sort = GF_MALLOC((pending->count + 1) * sizeof(*sort),
+                         gf_index_mt_pending_sorted_t);
+        if (!sort)
+            goto unlock;
+
+        for (b = 0; b < pending->bucket_count; b++) {
+            list_for_each_entry(entry, &pending->buckets[b], hash)
+            {
+                gf_uuid_copy(sort[n].gfid, entry->gfid);
+                sort[n].since = entry->since;
+                sort[n].rank = index_pending_rank(entry);
+                n++;
+            }
+        }
+        ret = 0;
+    }
+unlock:
+    pthread_mutex_unlock(&pending->lock);
+
+    if (ret)
+        return ret;
+
+    qsort(sort, n, sizeof(*sort), index_pending_sort_cmp);
+
+    sorted = GF_MALLOC((n + 1) * sizeof(*sorted), gf_index_mt_pending_sorted_t);
+    if (!sorted) {
+        GF_FREE(sort);
+        return -ENOMEM;
+    }
+    for (i = 0; i < n; i++)
+        gf_uuid_copy(sorted[i], sort[i].gfid);
+    GF_FREE(sort);
+
+    *gfids = sorted;
+    *count = n;
+
+    return 0;
+}
@@ -463,9 +463,39 @@ index_get_subdir_from_vgfid(index_priv_t *priv, uuid_t vgfid)
     return index_get_subdir_from_type(index_get_type_from_vgfid(priv, vgfid));
 }
 
+/* Which of @parts readers of an index directory gets the entry: the last bytes
+ * of a gfid are random. */
+static gf_boolean_t
+index_gfid_in_partition(uuid_t gfid, uint32_t part, uint32_t parts)
+{
+    uint32_t hash;
+
+    if (parts <= 1)
+        return _gf_true;
+
+    memcpy(&hash, gfid + sizeof(uuid_t) - sizeof(hash), sizeof(hash));
+
+    return (hash % parts) == part;
+}
+
+static gf_boolean_t
+index_name_in_partition(const char *name, uint32_t part, uint32_t parts)
+{
+    uuid_t gfid;
+
+    if (parts <= 1)
+        return _gf_true;
+
+    if (gf_uuid_parse(name, gfid))
+        return (part == 0);
+
+    return index_gfid_in_partition(gfid, part, parts);
+}
+
 static int
 index_fill_readdir(fd_t *fd, index_fd_ctx_t *fctx, DIR *dir, off_t off,
-                   size_t size, gf_dirent_t *entries)
+                   size_t size, gf_dirent_t *entries, uint32_t part,
+                   uint32_t parts)
 {
     off_t in_case = -1;
     off_t last_off = 0;
@@ -533,6 +563,9 @@ index_fill_readdir(fd_t *fd, index_fd_ctx_t *fctx, DIR *dir, off_t off,
             continue;
         }
 
+        if (!index_name_in_partition(entry->d_name, part, parts))
+            continue;
+
         this_size = max(sizeof(gf_dirent_t), sizeof(gfs3_dirplist)) +
                     strlen(entry->d_name) + 1;
 
@@ -590,6 +623,70 @@ out:
     return count;
 }
 
+/* Readdir of the xattrop index in the order the entries should be healed, from
+ * a snapshot of the pending store taken when the crawl starts. The offset of an
+ * entry is its position in the snapshot, plus one. */
+static int
+index_fill_readdir_by_priority(fd_t *fd, index_fd_ctx_t *fctx, off_t off,
+                               size_t size, gf_dirent_t *entries,
+                               uint32_t part, uint32_t parts)
+{
+    char name[GF_UUID_BUF_SIZE] = {
+        0,
+    };
+    xlator_t *this = THIS;
+    gf_dirent_t *this_entry = NULL;
+    size_t filled = 0;
+    int32_t this_size = -1;
+    uint64_t i;
+    int count = 0;
+    int ret;
+
+    if (!off) {
+        ret = index_pending_sorted(this, &fctx->sorted, &fctx->sorted_count);
+        if (ret) {
+            gf_msg(this->name, GF_LOG_ERROR, -ret,
+                   INDEX_MSG_INDEX_READDIR_FAILED,
+                   "failed to sort the entries pending heal");
+            errno = -ret;
+            return -1;
+        }
+    }
+
+    for (i = off; i < fctx->sorted_count; i++) {
+        if (!index_gfid_in_partition(fctx->sorted[i], part, parts))
+            continue;
+        /* Healed since the snapshot */
+        if (!index_pending_has(this, fctx->sorted[i]))
+            continue;
+
+        gf_uuid_unparse(fctx->sorted[i], name);
+        this_size = max(sizeof(gf_dirent_t), sizeof(gfs3_dirplist)) +
+                    strlen(name) + 1;
+        if (this_size + filled > size)
+            break;
+
+        this_entry = gf_dirent_for_name(name);
+        if (!this_entry) {
+            gf_msg(this->name, GF_LOG_ERROR, errno,
+                   INDEX_MSG_INDEX_READDIR_FAILED,
+                   "could not create gf_dirent for entry %s", name);
+            return count;
+        }
+        this_entry->d_off = i + 1;
+        list_add_tail(&this_entry->list, &entries->list);
+
+        filled += this_size;
+        count++;
+    }
+
+    errno = 0;
+    if (i >= fctx->sorted_count)
+        errno = ENOENT; /* Indicate EOF */
+
+    return count;
+}
+
 int
 index_link_to_base(xlator_t *this, char *fpath, const char *subdir)
 {
@@ -734,6 +831,8 @@ index_del(xlator_t *this, uuid_t gfid, const char *subdir, int type)
     if (ret == 0) {
         index_update_link_count_cache(priv, type, -1);
     }
+    if (type == XATTROP)
+        index_pending_del(this, gfid);
     ret = 0;
 out:
     return ret;
@@ -960,9 +1059,39 @@ out:
     return ret;
 }
 
+static int
+_check_data_pending(dict_t *d, char *k, data_t *v, void *tmp)
+{
+    gf_boolean_t *data = tmp;
+    int len;
+
+    /* The data counter comes first: AFR has 3 of them (data, metadata and
+     * entry), EC 2 (data and metadata). */
+    len = (v->len % 3 == 0) ? v->len / 3 : v->len / 2;
+    if (!memeqzero((const char *)v->data, len))
+        *data = _gf_true;
+
+    return 0;
+}
+
+static gf_boolean_t
+index_is_data_pending(xlator_t *this, dict_t *xattr)
+{
+    index_priv_t *priv = this->private;
+    gf_boolean_t data = _gf_false;
+
+    if (xattr && priv->pending_watchlist)
+        dict_foreach_match(xattr, is_xattr_in_watchlist,
+                           priv->pending_watchlist, _check_data_pending,
+                           &data);
+
+    return data;
+}
+
 void
-_index_action(xlator_t *this, inode_t *inode, int *zfilled)
+_index_action(xlator_t *this, inode_t *inode, dict_t *xattr, int *zfilled)
 {
+    index_priv_t *priv = this->private;
     int ret = 0;
     int i = 0;
     index_inode_ctx_t *ctx = NULL;
@@ -987,6 +1116,11 @@ _index_action(xlator_t *this, inode_t *inode, int *zfilled)
             if (!ret)
                 ctx->state[i] = NOTIN;
         } else if (zfilled[i] == 0) {
+            /* Before linking it, and even if it's there already, as what
+             * needs to be healed may have changed. */
+            if ((i == XATTROP) && priv->pending.loaded)
+                index_pending_add(this, inode->gfid, inode->ia_type,
+                                  index_is_data_pending(this, xattr));
             if (ctx->state[i] == IN)
                 continue;
             ret = index_add(this, inode->gfid, subdir, i);
@@ -1041,7 +1175,7 @@ xattrop_index_action(xlator_t *this, index_local_t *local, dict_t *xattr,
     memset(zfilled, -1, sizeof(zfilled));
     ret = dict_foreach_match(xattr, match, match_data,
                              _check_key_is_zero_filled, zfilled);
-    _index_action(this, inode, zfilled);
+    _index_action(this, inode, xattr, zfilled);
 
     if (req_xdata) {
         ret = index_entry_action(this, inode, req_xdata,
@@ -1324,7 +1458,7 @@ index_xattrop_do(call_frame_t *frame, xlator_t *this, loc_t *loc, fd_t *fd,
      */
     ret = dict_foreach(xattr, index_fill_zero_array, zfilled);
 
-    _index_action(this, local->inode, zfilled);
+    _index_action(this, local->inode, xattr, zfilled);
     if (xdata)
         ret = index_entry_action(this, local->inode, xdata,
                                  GF_XATTROP_ENTRY_IN_KEY);
@@ -1507,7 +1641,8 @@ index_getxattr_wrapper(call_frame_t *frame, xlator_t *this, loc_t *loc,
     /* TODO: Need to check what kind of link-counts are needed for
      * ENTRY-CHANGES before refactor of this block with array*/
     if (strcmp(name, GF_XATTROP_INDEX_COUNT) == 0) {
-        count = index_entry_count(this, XATTROP_SUBDIR);
+        if (index_pending_count(this, &count))
+            count = index_entry_count(this, XATTROP_SUBDIR);
 
         ret = dict_set_uint64(xattr, (char *)name, count);
         if (ret) {
@@ -1744,6 +1879,10 @@ index_readdir_wrapper(call_frame_t *frame, xlator_t *this, fd_t *fd,
     int count = 0;
     gf_dirent_t entries;
     struct index_syncop_args args = {0};
+    dict_t *rsp_xdata = NULL;
+    uint32_t part = 0;
+    uint32_t parts = 1;
+    gf_boolean_t by_priority = _gf_false;
 
     priv = this->private;
     INIT_LIST_HEAD(&entries.list);
@@ -1764,7 +1903,41 @@ index_readdir_wrapper(call_frame_t *frame, xlator_t *this, fd_t *fd,
         goto done;
     }
 
-    count = index_fill_readdir(fd, fctx, dir, off, size, &entries);
+    /* Each reader of a parallel crawl gets its own part of the index, and
+     * the reply tells it that it's been taken into account. */
+    if (xdata && !dict_get_uint32(xdata, GF_INDEX_PARTITIONS, &parts) &&
+        !dict_get_uint32(xdata, GF_INDEX_PARTITION, &part) && (part < parts)) {
+        rsp_xdata = dict_new();
+        if (!rsp_xdata || dict_set_uint32(rsp_xdata, GF_INDEX_PARTITIONS,
+                                          parts)) {
+            op_errno = ENOMEM;
+            goto done;
+        }
+    } else {
+        part = 0;
+        parts = 1;
+    }
+
+    /* A crawl keeps the mode it started with, since the offsets of one mode
+     * mean nothing in the other. */
+    if (!off) {
+        GF_FREE(fctx->sorted);
+        fctx->sorted = NULL;
+        fctx->sorted_count = 0;
+        by_priority = xdata && dict_get(xdata, GF_INDEX_BY_PRIORITY) &&
+                      (index_get_type_from_vgfid(priv, fd->inode->gfid) ==
+                       XATTROP) &&
+                      priv->pending.ready;
+    } else {
+        by_priority = (fctx->sorted != NULL);
+    }
+
+    if (by_priority)
+        count = index_fill_readdir_by_priority(fd, fctx, off, size, &entries,
+                                               part, parts);
+    else
+        count = index_fill_readdir(fd, fctx, dir, off, size, &entries, part,
+                                   parts);
 
     /* pick ENOENT to indicate EOF */
     op_errno = errno;
@@ -1777,8 +1950,10 @@ index_readdir_wrapper(call_frame_t *frame, xlator_t *this, fd_t *fd,
                            &args);
     }
 done:
-    STACK_UNWIND_STRICT(readdir, frame, op_ret, op_errno, &entries, NULL);
+    STACK_UNWIND_STRICT(readdir, frame, op_ret, op_errno, &entries, rsp_xdata);
     gf_dirent_free(&entries);
+    if (rsp_xdata)
+        dict_unref(rsp_xdata);
     return 0;
 }
 
@@ -2054,6 +2229,7 @@ index_fill_link_count(xlator_t *this, dict_t *xdata)
     int ret = -1;
     index_priv_t *priv = NULL;
     int64_t count = -1;
+    uint64_t pending = 0;
 
     priv = this->private;
     xdata = (xdata) ? dict_ref(xdata) : dict_new();
@@ -2061,7 +2237,10 @@ index_fill_link_count(xlator_t *this, dict_t *xdata)
         goto out;
 
     index_get_link_count(priv, &count, XATTROP);
-    if (count < 0) {
+    if ((count < 0) && !index_pending_count(this, &pending)) {
+        count = pending;
+        index_set_link_count(priv, count, XATTROP);
+    } else if (count < 0) {
         count = index_fetch_link_count(this, XATTROP);
         index_set_link_count(priv, count, XATTROP);
     }
@@ -2344,6 +2523,13 @@ index_priv_dump(xlator_t *this)
     snprintf(key_prefix, GF_DUMP_MAX_BUF_LEN, "%s.%s", this->type, this->name);
     gf_proc_dump_add_section("%s", key_prefix);
     gf_proc_dump_write("xattrop-pending-count", "%"PRId64, priv->pending_count);
+    if (priv->pending.loaded) {
+        gf_proc_dump_write("pending-store-ready", "%d", priv->pending.ready);
+        gf_proc_dump_write("pending-store-count", "%" PRIu64,
+                           priv->pending.count);
+        gf_proc_dump_write("pending-store-log-records", "%" PRIu64,
+                           priv->pending.records);
+    }
 
     return 0;
 }
@@ -2445,6 +2631,8 @@ init(xlator_t *this)
     if (ret)
         goto out;
 
+    GF_OPTION_INIT("pending-store", priv->pending_store, bool, out);
+
     if (priv->dirty_watchlist)
         priv->complete_watchlist = dict_copy_with_ref(priv->dirty_watchlist,
                                                       priv->complete_watchlist);
@@ -2471,6 +2659,10 @@ init(xlator_t *this)
     if (ret < 0)
         goto out;
 
+    /* The index directory is used instead if it can't be loaded */
+    if (priv->pending_store)
+        (void)index_pending_init(this, XATTROP_SUBDIR);
+
     if (priv->dirty_watchlist) {
         ret = index_dir_create(this, DIRTY_SUBDIR);
         if (ret < 0)
@@ -2501,6 +2693,8 @@ out:
     GF_FREE(tmp);
 
     if (ret) {
+        if (priv && this->private)
+            index_pending_fini(this);
         if (cond_inited)
             pthread_cond_destroy(&priv->cond);
         if (mutex_inited)
@@ -2538,6 +2732,7 @@ fini(xlator_t *this)
         gf_thread_cleanup_xint(priv->thread);
         priv->thread = 0;
     }
+    index_pending_fini(this);
     this->private = NULL;
     LOCK_DESTROY(&priv->lock);
     pthread_cond_destroy(&priv->cond);
@@ -2587,6 +2782,7 @@ index_releasedir(xlator_t *this, fd_t *fd)
                    "closedir error");
     }
 
+    GF_FREE(fctx->sorted);
     GF_FREE(fctx);
 out:
     return 0;
@@ -2703,6 +2899,13 @@ struct volume_options options[] = {
      .type = GF_OPTION_TYPE_STR,
      .description = "Comma separated list of xattrs that are watched",
      .default_value = "trusted.afr.{{ volume.name }}"},
+    {.key = {"pending-store"},
+     .type = GF_OPTION_TYPE_BOOL,
+     .default_value = "on",
+     .description = "Keep the list of entries pending heal in memory, "
+                    "persisted in a log next to the index, to count them and "
+                    "to give them to the self-heal daemon by priority without "
+                    "reading the index directory"},
     {.key = {NULL}},
 };
 
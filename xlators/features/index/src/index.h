@@ -41,8 +41,53 @@ typedef struct index_inode_ctx {
 typedef struct index_fd_ctx {
     DIR *dir;
     off_t dir_eof;
+    /* Snapshot of the pending store, for readdirs by priority */
+    uuid_t *sorted;
+    uint64_t sorted_count;
 } index_fd_ctx_t;
 
+/* An entry of the xattrop index, as known to the pending store. */
+typedef struct index_pending_entry {
+    struct list_head hash;
+    uuid_t gfid;
+    time_t since; /* when it was added to the index */
+    ia_type_t type;
+    uint32_t flags;
+} index_pending_entry_t;
+
+#define INDEX_PENDING_DATA 0x1 /* data needs to be healed */
+#define INDEX_PENDING_SEEN 0x2 /* found in the directory, while checking */
+
+/*
+ * In-memory copy of the xattrop index, giving its size and the priority of
+ * each entry without going through the directory. It's persisted in an
+ * append-only log next to the index directories, which is compacted when it
+ * grows too big. The directory remains the reference: an entry is added to the
+ * table before being linked there and removed after being unlinked, and at
+ * each start the table is checked against the directory in the background.
+ * It's only used once that's done.
+ */
+typedef struct index_pending {
+    pthread_mutex_t lock;
+    struct list_head *buckets;
+    uint32_t bucket_count;
+    uint64_t count;
+    uint64_t records; /* in the log */
+    int fd;           /* of the log, -1 if it can't be written */
+    char *subdir;
+    char *dir; /* the index directory */
+    char *log;
+    pthread_cond_t cond; /* wakes up the thread to compact the log */
+    pthread_t thread; /* checks the table, then compacts the log */
+    gf_boolean_t thread_running;
+    gf_boolean_t stop;
+    gf_boolean_t loaded;      /* kept up to date by the fops */
+    gf_boolean_t reconciling; /* being checked against the directory */
+    gf_boolean_t ready;       /* matching the directory */
+    gf_boolean_t broken;      /* failed to track an entry */
+    gf_boolean_t compact;     /* the log needs to be compacted */
+} index_pending_t;
+
 typedef struct index_priv {
     char *index_basepath;
     char *dirty_basepath;
@@ -60,6 +105,8 @@ typedef struct index_priv {
     gf_boolean_t down;
     gf_atomic_t stub_cnt;
     int32_t curr_count;
+    gf_boolean_t pending_store;
+    index_pending_t pending;
 } index_priv_t;
 
 typedef struct index_local {
@@ -83,4 +130,26 @@ typedef struct index_local {
         }                                                                      \
     } while (0)
 
+int
+index_pending_init(xlator_t *this, const char *subdir);
+
+void
+index_pending_fini(xlator_t *this);
+
+void
+index_pending_add(xlator_t *this, uuid_t gfid, ia_type_t type,
+                  gf_boolean_t data);
+
+void
+index_pending_del(xlator_t *this, uuid_t gfid);
+
+gf_boolean_t
+index_pending_has(xlator_t *this, uuid_t gfid);
+
+int
+index_pending_count(xlator_t *this, uint64_t *count);
+
+int
+index_pending_sorted(xlator_t *this, uuid_t **gfids, uint64_t *count);
+
 #endif
@@ -32,6 +32,7 @@ static pl_dom_list_t *
 __allocate_domain(const char *volume)
 {
     pl_dom_list_t *dom = NULL;
+    int i;
 
     dom = GF_CALLOC(1, sizeof(*dom), gf_locks_mt_pl_dom_list_t);
     if (!dom)
@@ -49,6 +50,10 @@ __allocate_domain(const char *volume)
     INIT_LIST_HEAD(&dom->blocked_entrylks);
     INIT_LIST_HEAD(&dom->inodelk_list);
     INIT_LIST_HEAD(&dom->blocked_inodelks);
+    gf_interval_tree_init(&dom->inodelk_tree);
+    gf_interval_tree_init(&dom->blocked_inodelk_tree);
+    for (i = 0; i < PL_INODELK_OWNER_BUCKETS; i++)
+        INIT_LIST_HEAD(&dom->inodelk_owners[i]);
 
 out:
     if (dom && (NULL == dom->domain)) {
@@ -454,6 +459,8 @@ pl_inode_get(xlator_t *this, inode_t *inode, pl_local_t *local)
 
         INIT_LIST_HEAD(&pl_inode->dom_list);
         INIT_LIST_HEAD(&pl_inode->ext_list);
+        gf_interval_tree_init(&pl_inode->ext_tree);
+        gf_interval_tree_init(&pl_inode->ext_blocked_tree);
         INIT_LIST_HEAD(&pl_inode->rw_list);
         INIT_LIST_HEAD(&pl_inode->reservelk_list);
         INIT_LIST_HEAD(&pl_inode->blocked_reservelks);
@@ -544,6 +551,7 @@ new_posix_lock(struct gf_flock *flock, client_t *client, pid_t client_pid,
     memcpy(&lock->user_flock, flock, sizeof(lock->user_flock));
 
     INIT_LIST_HEAD(&lock->list);
+    gf_interval_node_init(&lock->node);
 
 out:
     return lock;
@@ -551,8 +559,13 @@ out:
 
 /* Delete a lock from the inode's lock list */
 void
-__delete_lock(posix_lock_t *lock)
+__delete_lock(pl_inode_t *pl_inode, posix_lock_t *lock)
 {
+    if (gf_interval_node_linked(&lock->node))
+        gf_interval_tree_remove(lock->blocked ? &pl_inode->ext_blocked_tree
+                                              : &pl_inode->ext_tree,
+                                &lock->node);
+
     list_del_init(&lock->list);
 }
 
@@ -578,8 +591,10 @@ __copy_lock(posix_lock_t *src)
             dst = NULL;
         }
 
-        if (dst != NULL)
+        if (dst != NULL) {
             INIT_LIST_HEAD(&dst->list);
+            gf_interval_node_init(&dst->node);
+        }
     }
 
     return dst;
@@ -610,6 +625,11 @@ __insert_lock(pl_inode_t *pl_inode, posix_lock_t *lock)
         lock->granted_time = gf_time();
 
     list_add_tail(&lock->list, &pl_inode->ext_list);
+
+    gf_interval_tree_insert(lock->blocked ? &pl_inode->ext_blocked_tree
+                                          : &pl_inode->ext_tree,
+                            &lock->node, pl_range_key(lock->fl_start),
+                            pl_range_key(lock->fl_end));
 }
 
 /* Return true if the locks overlap, false otherwise */
@@ -633,17 +653,23 @@ same_owner(posix_lock_t *l1, posix_lock_t *l2)
             (l1->client == l2->client));
 }
 
-/* Delete all F_UNLCK locks */
+/* Delete all F_UNLCK locks within [start, end] */
 void
-__delete_unlck_locks(pl_inode_t *pl_inode)
+__delete_unlck_locks(pl_inode_t *pl_inode, off_t start, off_t end)
 {
     posix_lock_t *l = NULL;
-    posix_lock_t *tmp = NULL;
+    gf_interval_node_t *node = NULL;
+    gf_interval_node_t *next = NULL;
 
-    list_for_each_entry_safe(l, tmp, &pl_inode->ext_list, list)
-    {
+    for (node = gf_interval_tree_first(&pl_inode->ext_tree, pl_range_key(start),
+                                       pl_range_key(end));
+         node; node = next) {
+        next = gf_interval_tree_next(node, pl_range_key(start),
+                                     pl_range_key(end));
+
+        l = gf_interval_tree_entry(node, posix_lock_t, node);
         if (l->fl_type == F_UNLCK) {
-            __delete_lock(l);
+            __delete_lock(pl_inode, l);
             __destroy_lock(l);
         }
     }
@@ -758,22 +784,22 @@ first_conflicting_overlap(pl_inode_t *pl_inode, posix_lock_t *lock)
 {
     posix_lock_t *l = NULL;
     posix_lock_t *conf = NULL;
+    gf_interval_node_t *node = NULL;
 
     pthread_mutex_lock(&pl_inode->mutex);
     {
-        list_for_each_entry(l, &pl_inode->ext_list, list)
+        gf_interval_tree_for_each(node, &pl_inode->ext_tree,
+                                  pl_range_key(lock->fl_start),
+                                  pl_range_key(lock->fl_end))
         {
-            if (l->blocked)
-                continue;
+            l = gf_interval_tree_entry(node, posix_lock_t, node);
 
-            if (locks_overlap(l, lock)) {
-                if (same_owner(l, lock))
-                    continue;
+            if (same_owner(l, lock))
+                continue;
 
-                if ((l->fl_type == F_WRLCK) || (lock->fl_type == F_WRLCK)) {
-                    conf = l;
-                    goto unlock;
-                }
+            if ((l->fl_type == F_WRLCK) || (lock->fl_type == F_WRLCK)) {
+                conf = l;
+                goto unlock;
             }
         }
     }
@@ -791,18 +817,15 @@ unlock:
 static posix_lock_t *
 first_overlap(pl_inode_t *pl_inode, posix_lock_t *lock)
 {
-    posix_lock_t *l = NULL;
-
-    list_for_each_entry(l, &pl_inode->ext_list, list)
-    {
-        if (l->blocked)
-            continue;
+    gf_interval_node_t *node = NULL;
 
-        if (locks_overlap(l, lock))
-            return l;
-    }
+    node = gf_interval_tree_first(&pl_inode->ext_tree,
+                                  pl_range_key(lock->fl_start),
+                                  pl_range_key(lock->fl_end));
+    if (node == NULL)
+        return NULL;
 
-    return NULL;
+    return gf_interval_tree_entry(node, posix_lock_t, node);
 }
 
 /* Return true if lock is grantable */
@@ -810,16 +833,22 @@ static int
 __is_lock_grantable(pl_inode_t *pl_inode, posix_lock_t *lock)
 {
     posix_lock_t *l = NULL;
+    gf_interval_node_t *node = NULL;
     int ret = 1;
 
-    list_for_each_entry(l, &pl_inode->ext_list, list)
+    if (lock->fl_type == F_UNLCK)
+        return ret;
+
+    gf_interval_tree_for_each(node, &pl_inode->ext_tree,
+                              pl_range_key(lock->fl_start),
+                              pl_range_key(lock->fl_end))
     {
-        if (!l->blocked && locks_overlap(lock, l)) {
-            if (((l->fl_type == F_WRLCK) || (lock->fl_type == F_WRLCK)) &&
-                (lock->fl_type != F_UNLCK) && !same_owner(l, lock)) {
-                ret = 0;
-                break;
-            }
+        l = gf_interval_tree_entry(node, posix_lock_t, node);
+
+        if (((l->fl_type == F_WRLCK) || (lock->fl_type == F_WRLCK)) &&
+            !same_owner(l, lock)) {
+            ret = 0;
+            break;
         }
     }
     return ret;
@@ -832,24 +861,26 @@ static void
 __insert_and_merge(pl_inode_t *pl_inode, posix_lock_t *lock)
 {
     posix_lock_t *conf = NULL;
-    posix_lock_t *t = NULL;
     posix_lock_t *sum = NULL;
+    gf_interval_node_t *node = NULL;
+    off_t start = 0;
+    off_t end = 0;
     int i = 0;
     struct _values v = {.locks = {0, 0, 0}};
 
-    list_for_each_entry_safe(conf, t, &pl_inode->ext_list, list)
+    /* Every branch which changes the tree returns right after. */
+    gf_interval_tree_for_each(node, &pl_inode->ext_tree,
+                              pl_range_key(lock->fl_start),
+                              pl_range_key(lock->fl_end))
     {
-        if (conf->blocked)
-            continue;
-        if (!locks_overlap(conf, lock))
-            continue;
+        conf = gf_interval_tree_entry(node, posix_lock_t, node);
 
         if (same_owner(conf, lock)) {
             if (conf->fl_type == lock->fl_type &&
                 conf->lk_flags == lock->lk_flags) {
                 sum = add_locks(lock, conf, lock);
 
-                __delete_lock(conf);
+                __delete_lock(pl_inode, conf);
                 __destroy_lock(conf);
 
                 __destroy_lock(lock);
@@ -862,11 +893,13 @@ __insert_and_merge(pl_inode_t *pl_inode, posix_lock_t *lock)
                 sum = add_locks(lock, conf, conf);
 
                 v = subtract_locks(sum, lock);
+                start = sum->fl_start;
+                end = sum->fl_end;
 
-                __delete_lock(conf);
+                __delete_lock(pl_inode, conf);
                 __destroy_lock(conf);
 
-                __delete_lock(lock);
+                __delete_lock(pl_inode, lock);
                 __destroy_lock(lock);
 
                 __destroy_lock(sum);
@@ -878,7 +911,7 @@ __insert_and_merge(pl_inode_t *pl_inode, posix_lock_t *lock)
                     __insert_and_merge(pl_inode, v.locks[i]);
                 }
 
-                __delete_unlck_locks(pl_inode);
+                __delete_unlck_locks(pl_inode, start, end);
                 return;
             }
         }
@@ -909,19 +942,25 @@ __grant_blocked_locks(xlator_t *this, pl_inode_t *pl_inode,
     posix_lock_t *l = NULL;
     posix_lock_t *tmp = NULL;
     posix_lock_t *conf = NULL;
+    gf_interval_node_t *node = NULL;
+    gf_interval_node_t *next = NULL;
 
     INIT_LIST_HEAD(&tmp_list);
 
-    list_for_each_entry_safe(l, tmp, &pl_inode->ext_list, list)
-    {
-        if (l->blocked) {
-            conf = first_overlap(pl_inode, l);
-            if (conf)
-                continue;
+    /* Only the blocked locks are visited, not the granted ones. */
+    for (node = gf_interval_tree_first(&pl_inode->ext_blocked_tree, 0,
+                                       UINT64_MAX);
+         node; node = next) {
+        next = gf_interval_tree_next(node, 0, UINT64_MAX);
 
-            l->blocked = 0;
-            list_move_tail(&l->list, &tmp_list);
-        }
+        l = gf_interval_tree_entry(node, posix_lock_t, node);
+        conf = first_overlap(pl_inode, l);
+        if (conf)
+            continue;
+
+        __delete_lock(pl_inode, l);
+        l->blocked = 0;
+        list_add_tail(&l->list, &tmp_list);
     }
 
     list_for_each_entry_safe(l, tmp, &tmp_list, list)
@@ -1174,7 +1213,7 @@ pl_lock_preempt(pl_inode_t *pl_inode, posix_lock_t *reqlock)
         list_for_each_entry_safe(lock, i, &pl_inode->ext_list, list)
         {
             if (lock->blocked) {
-                list_del_init(&lock->list);
+                __delete_lock(pl_inode, lock);
                 list_add(&lock->list, &unwind_blist);
                 continue;
             }
@@ -1184,8 +1223,7 @@ pl_lock_preempt(pl_inode_t *pl_inode, posix_lock_t *reqlock)
                     continue;
 
                 /* remove conflicting locks */
-                list_del_init(&lock->list);
-                __delete_lock(lock);
+                __delete_lock(pl_inode, lock);
                 __destroy_lock(lock);
             }
         }
@@ -52,6 +52,13 @@
         }                                                                      \
     } while (0)
 
+/* Offsets as interval tree keys, which keep their order even if negative */
+static inline uint64_t
+pl_range_key(off_t offset)
+{
+    return (uint64_t)offset ^ (1ULL << 63);
+}
+
 posix_lock_t *
 new_posix_lock(struct gf_flock *flock, client_t *client, pid_t client_pid,
                gf_lkowner_t *owner, fd_t *fd, uint32_t lk_flags, int blocking,
@@ -82,7 +89,7 @@ int
 same_owner(posix_lock_t *l1, posix_lock_t *l2);
 
 void
-__delete_lock(posix_lock_t *);
+__delete_lock(pl_inode_t *, posix_lock_t *);
 
 void
 __destroy_lock(posix_lock_t *);
@@ -101,6 +108,9 @@ inodelk_contention_notify(xlator_t *this, struct list_head *contend);
 void
 __delete_inode_lock(pl_inode_lock_t *lock);
 
+void
+__unblock_inode_lock(pl_inode_lock_t *lock);
+
 void
 __pl_inodelk_unref(pl_inode_lock_t *lock);
 
@@ -13,17 +13,68 @@
 #include <glusterfs/logging.h>
 #include <glusterfs/list.h>
 #include <glusterfs/upcall-utils.h>
+#include <glusterfs/hashfn.h>
 
 #include "locks.h"
 #include "clear.h"
 #include "common.h"
 
+static struct list_head *
+__inodelk_owner_bucket(pl_dom_list_t *dom, pl_inode_lock_t *lock)
+{
+    uint32_t hash;
+
+    hash = SuperFastHash(lock->owner.data, lock->owner.len);
+    hash ^= (uint32_t)((uintptr_t)lock->client >> 4);
+
+    return &dom->inodelk_owners[hash % PL_INODELK_OWNER_BUCKETS];
+}
+
+/* Adds a lock to the granted locks of the domain */
+static void
+__grant_inode_lock(pl_dom_list_t *dom, pl_inode_lock_t *lock)
+{
+    list_add(&lock->list, &dom->inodelk_list);
+    gf_interval_tree_insert(&dom->inodelk_tree, &lock->node,
+                            pl_range_key(lock->fl_start),
+                            pl_range_key(lock->fl_end));
+    list_add_tail(&lock->owner_list, __inodelk_owner_bucket(dom, lock));
+    lock->dom = dom;
+}
+
+/* Adds a lock to the blocked locks of the domain */
+static void
+__block_inode_lock(pl_dom_list_t *dom, pl_inode_lock_t *lock)
+{
+    list_add_tail(&lock->blocked_locks, &dom->blocked_inodelks);
+    gf_interval_tree_insert(&dom->blocked_inodelk_tree, &lock->node,
+                            pl_range_key(lock->fl_start),
+                            pl_range_key(lock->fl_end));
+    list_add_tail(&lock->owner_list, __inodelk_owner_bucket(dom, lock));
+    lock->dom = dom;
+}
+
+/* Takes a lock off the granted locks of its domain */
 void
 __delete_inode_lock(pl_inode_lock_t *lock)
 {
+    if (gf_interval_node_linked(&lock->node))
+        gf_interval_tree_remove(&lock->dom->inodelk_tree, &lock->node);
+    list_del_init(&lock->owner_list);
     list_del_init(&lock->list);
 }
 
+/* Takes a lock off the blocked locks of its domain */
+void
+__unblock_inode_lock(pl_inode_lock_t *lock)
+{
+    if (gf_interval_node_linked(&lock->node))
+        gf_interval_tree_remove(&lock->dom->blocked_inodelk_tree,
+                                &lock->node);
+    list_del_init(&lock->owner_list);
+    list_del_init(&lock->blocked_locks);
+}
+
 static void
 __pl_inodelk_ref(pl_inode_lock_t *lock)
 {
@@ -168,6 +219,7 @@ __inodelk_prune_stale(xlator_t *this, pl_inode_t *pinode, pl_dom_list_t *dom,
     posix_locks_private_t *priv = NULL;
     pl_inode_lock_t *tmp = NULL;
     pl_inode_lock_t *lk = NULL;
+    gf_interval_node_t *node = NULL;
     gf_boolean_t revoke_lock = _gf_false;
     int bcount = 0;
     int gcount = 0;
@@ -190,8 +242,11 @@ __inodelk_prune_stale(xlator_t *this, pl_inode_t *pinode, pl_dom_list_t *dom,
         goto out;
 
     pthread_mutex_lock(&pinode->mutex);
-    list_for_each_entry_safe(lk, tmp, &dom->inodelk_list, list)
+    gf_interval_tree_for_each(node, &dom->inodelk_tree,
+                              pl_range_key(lock->fl_start),
+                              pl_range_key(lock->fl_end))
     {
+        lk = gf_interval_tree_entry(node, pl_inode_lock_t, node);
         if (__stale_inodelk(this, lk, lock, &lk_age_sec) == _gf_true) {
             revoke_lock = _gf_true;
             reason_str = "age";
@@ -339,10 +394,14 @@ __inodelk_grantable(xlator_t *this, pl_dom_list_t *dom, pl_inode_lock_t *lock,
 {
     pl_inode_lock_t *l = NULL;
     pl_inode_lock_t *ret = NULL;
+    gf_interval_node_t *node = NULL;
 
-    list_for_each_entry(l, &dom->inodelk_list, list)
+    gf_interval_tree_for_each(node, &dom->inodelk_tree,
+                              pl_range_key(lock->fl_start),
+                              pl_range_key(lock->fl_end))
     {
-        if (inodelk_conflict(lock, l) && !same_inodelk_owner(lock, l)) {
+        l = gf_interval_tree_entry(node, pl_inode_lock_t, node);
+        if (inodelk_type_conflict(lock, l) && !same_inodelk_owner(lock, l)) {
             if (ret == NULL) {
                 ret = l;
                 if (contend == NULL) {
@@ -360,10 +419,14 @@ static pl_inode_lock_t *
 __blocked_lock_conflict(pl_dom_list_t *dom, pl_inode_lock_t *lock)
 {
     pl_inode_lock_t *l = NULL;
+    gf_interval_node_t *node = NULL;
 
-    list_for_each_entry(l, &dom->blocked_inodelks, blocked_locks)
+    gf_interval_tree_for_each(node, &dom->blocked_inodelk_tree,
+                              pl_range_key(lock->fl_start),
+                              pl_range_key(lock->fl_end))
     {
-        if (inodelk_conflict(lock, l)) {
+        l = gf_interval_tree_entry(node, pl_inode_lock_t, node);
+        if (inodelk_type_conflict(lock, l)) {
             return l;
         }
     }
@@ -371,18 +434,14 @@ __blocked_lock_conflict(pl_dom_list_t *dom, pl_inode_lock_t *lock)
     return NULL;
 }
 
+/* Looks for a granted or blocked lock of the same owner */
 static int
 __owner_has_lock(pl_dom_list_t *dom, pl_inode_lock_t *newlock)
 {
     pl_inode_lock_t *lock = NULL;
 
-    list_for_each_entry(lock, &dom->inodelk_list, list)
-    {
-        if (same_inodelk_owner(lock, newlock))
-            return 1;
-    }
-
-    list_for_each_entry(lock, &dom->blocked_inodelks, blocked_locks)
+    list_for_each_entry(lock, __inodelk_owner_bucket(dom, newlock),
+                        owner_list)
     {
         if (same_inodelk_owner(lock, newlock))
             return 1;
@@ -400,7 +459,7 @@ __lock_blocked_add(xlator_t *this, pl_dom_list_t *dom, pl_inode_lock_t *lock,
     }
 
     lock->blkd_time = gf_time();
-    list_add_tail(&lock->blocked_locks, &dom->blocked_inodelks);
+    __block_inode_lock(dom, lock);
 
     gf_msg_trace(this->name, 0,
                  "%s (pid=%d) (lk-owner=%s) %" PRId64
@@ -461,7 +520,7 @@ __lock_inodelk(xlator_t *this, pl_inode_t *pl_inode, pl_inode_lock_t *lock,
     }
     __pl_inodelk_ref(lock);
     lock->granted_time = gf_time();
-    list_add(&lock->list, &dom->inodelk_list);
+    __grant_inode_lock(dom, lock);
 
     return 0;
 }
@@ -480,8 +539,13 @@ static pl_inode_lock_t *
 find_matching_inodelk(pl_inode_lock_t *lock, pl_dom_list_t *dom)
 {
     pl_inode_lock_t *l = NULL;
-    list_for_each_entry(l, &dom->inodelk_list, list)
+    gf_interval_node_t *node = NULL;
+
+    gf_interval_tree_for_each(node, &dom->inodelk_tree,
+                              pl_range_key(lock->fl_start),
+                              pl_range_key(lock->fl_end))
     {
+        l = gf_interval_tree_entry(node, pl_inode_lock_t, node);
         if (inodelks_equal(l, lock) && same_inodelk_owner(l, lock))
             return l;
     }
@@ -533,6 +597,15 @@ __grant_blocked_inode_locks(xlator_t *this, pl_inode_t *pl_inode,
     INIT_LIST_HEAD(&blocked_list);
     list_splice_init(&dom->blocked_inodelks, &blocked_list);
 
+    /* The locks are queued again one by one, only the ones already gone
+     * through must be seen by the ones coming next. */
+    gf_interval_tree_init(&dom->blocked_inodelk_tree);
+    list_for_each_entry(bl, &blocked_list, blocked_locks)
+    {
+        gf_interval_node_init(&bl->node);
+        list_del_init(&bl->owner_list);
+    }
+
     list_for_each_entry_safe(bl, tmp, &blocked_list, blocked_locks)
     {
         list_del_init(&bl->blocked_locks);
@@ -694,7 +767,7 @@ pl_inodelk_client_cleanup(xlator_t *this, pl_ctx_t *ctx)
                     __delete_inode_lock(l);
                     list_add_tail(&l->client_list, &released);
                 } else {
-                    list_del_init(&l->blocked_locks);
+                    __unblock_inode_lock(l);
                     list_add_tail(&l->client_list, &unwind);
                 }
             }
@@ -931,6 +1004,8 @@ new_inode_lock(struct gf_flock *flock, client_t *client, pid_t client_pid,
 
     INIT_LIST_HEAD(&lock->list);
     INIT_LIST_HEAD(&lock->blocked_locks);
+    INIT_LIST_HEAD(&lock->owner_list);
+    gf_interval_node_init(&lock->node);
     INIT_LIST_HEAD(&lock->client_list);
     INIT_LIST_HEAD(&lock->contend);
     __pl_inodelk_ref(lock);
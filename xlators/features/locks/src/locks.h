@@ -17,6 +17,7 @@
 #include <glusterfs/client_t.h>
 
 #include <glusterfs/lkowner.h>
+#include <glusterfs/interval-tree.h>
 
 typedef enum {
     MLK_NONE,
@@ -29,6 +30,7 @@ struct __pl_fd;
 
 struct __posix_lock {
     struct list_head list;
+    gf_interval_node_t node; /* in ext_tree or ext_blocked_tree */
 
     off_t fl_start;
     off_t fl_end;
@@ -71,6 +73,10 @@ struct __pl_inode_lock {
     struct list_head list;
     struct list_head blocked_locks; /* list_head pointing to blocked_inodelks */
     struct list_head contend;       /* list of contending locks */
+    struct list_head owner_list;    /* in the owner hash of the domain */
+    gf_interval_node_t node;        /* in inodelk_tree or blocked_inodelk_tree,
+                                       as per the list it is in */
+    struct _pl_dom_list *dom;       /* domain of the lists it is in */
     int ref;
 
     off_t fl_start;
@@ -114,6 +120,8 @@ struct _pl_rw_req {
 };
 typedef struct _pl_rw_req pl_rw_req_t;
 
+#define PL_INODELK_OWNER_BUCKETS 16
+
 struct _pl_dom_list {
     struct list_head inode_list; /* list_head back to pl_inode_t */
     const char *domain;
@@ -121,6 +129,10 @@ struct _pl_dom_list {
     struct list_head blocked_entrylks; /* List of all blocked entrylks */
     struct list_head inodelk_list;     /* List of inode locks */
     struct list_head blocked_inodelks; /* List of all blocked inodelks */
+    gf_interval_tree_t inodelk_tree;   /* inodelk_list by range */
+    gf_interval_tree_t blocked_inodelk_tree; /* blocked_inodelks by range */
+    /* granted and blocked inodelks hashed by owner */
+    struct list_head inodelk_owners[PL_INODELK_OWNER_BUCKETS];
 };
 typedef struct _pl_dom_list pl_dom_list_t;
 
@@ -163,6 +175,8 @@ struct __pl_inode {
 
     struct list_head dom_list;           /* list of domains */
     struct list_head ext_list;           /* list of fcntl locks */
+    gf_interval_tree_t ext_tree;         /* granted fcntl locks by range */
+    gf_interval_tree_t ext_blocked_tree; /* blocked fcntl locks by range */
     struct list_head rw_list;            /* list of waiting r/w requests */
     struct list_head reservelk_list;     /* list of reservelks */
     struct list_head blocked_reservelks; /* list of blocked reservelks */
@@ -1168,10 +1168,11 @@ delete_locks_of_fd(xlator_t *this, pl_inode_t *pl_inode, fd_t *fd)
         {
             if (l->fd_num == fd_to_fdnum(fd)) {
                 if (l->blocked) {
-                    list_move_tail(&l->list, &blocked_list);
+                    __delete_lock(pl_inode, l);
+                    list_add_tail(&l->list, &blocked_list);
                     continue;
                 }
-                __delete_lock(l);
+                __delete_lock(pl_inode, l);
                 __destroy_lock(l);
             }
         }
@@ -1212,7 +1213,7 @@ __delete_locks_of_owner(pl_inode_t *pl_inode, client_t *client,
                    lkowner_utoa(&l->owner), l->user_flock.l_start,
                    l->user_flock.l_len, l->blocked == 1 ? "Blocked" : "Active");
 
-            __delete_lock(l);
+            __delete_lock(pl_inode, l);
             __destroy_lock(l);
         }
     }
@@ -2080,6 +2081,7 @@ static int
 __rw_allowable(pl_inode_t *pl_inode, posix_lock_t *region, glusterfs_fop_t op)
 {
     posix_lock_t *l = NULL;
+    gf_interval_node_t *node = NULL;
     posix_locks_private_t *priv = THIS->private;
     int ret = 1;
 
@@ -2124,19 +2126,23 @@ __rw_allowable(pl_inode_t *pl_inode, posix_lock_t *region, glusterfs_fop_t op)
         return 0;
     }
 
-    list_for_each_entry(l, &pl_inode->ext_list, list)
+    gf_interval_tree_for_each(node, &pl_inode->ext_tree,
+                              pl_range_key(region->fl_start),
+                              pl_range_key(region->fl_end))
     {
-        if (!l->blocked && locks_overlap(l, region) && !same_owner(l, region)) {
-            if ((op == GF_FOP_READ) && (l->fl_type != F_WRLCK))
-                continue;
-            /* Check for mandatory lock under optimal
-             * mandatory-locking mode */
-            if (priv->mandatory_mode == MLK_OPTIMAL &&
-                !(l->lk_flags & GF_LK_MANDATORY))
-                continue;
-            ret = 0;
-            break;
-        }
+        l = gf_interval_tree_entry(node, posix_lock_t, node);
+
+        if (same_owner(l, region))
+            continue;
+        if ((op == GF_FOP_READ) && (l->fl_type != F_WRLCK))
+            continue;
+        /* Check for mandatory lock under optimal
+         * mandatory-locking mode */
+        if (priv->mandatory_mode == MLK_OPTIMAL &&
+            !(l->lk_flags & GF_LK_MANDATORY))
+            continue;
+        ret = 0;
+        break;
     }
 
     return ret;
@@ -2835,7 +2841,7 @@ pl_forget(xlator_t *this, inode_t *inode)
 
             list_for_each_entry_safe(ext_l, ext_tmp, &pl_inode->ext_list, list)
             {
-                __delete_lock(ext_l);
+                __delete_lock(pl_inode, ext_l);
                 if (ext_l->blocked) {
                     list_add_tail(&ext_l->list, &posixlks_released);
                     continue;
@@ -2857,7 +2863,12 @@ pl_forget(xlator_t *this, inode_t *inode)
                     __pl_inodelk_unref(ino_l);
                 }
 
-                list_splice_init(&dom->blocked_inodelks, &inodelks_released);
+                list_for_each_entry_safe(ino_l, ino_tmp,
+                                         &dom->blocked_inodelks, blocked_locks)
+                {
+                    __unblock_inode_lock(ino_l);
+                    list_add_tail(&ino_l->blocked_locks, &inodelks_released);
+                }
             }
             if (!list_empty(&dom->entrylk_list)) {
                 gf_log(this->name, GF_LOG_WARNING,
@@ -3423,7 +3434,7 @@ __unwind_blocked_locks(pl_inode_t *pl_inode, struct list_head *tmp_list)
         if (!lock->blocking)
             continue;
 
-        list_del_init(&lock->list);
+        __delete_lock(pl_inode, lock);
         list_add_tail(&lock->list, tmp_list);
     }
 }
@@ -4300,6 +4311,7 @@ gf_lkmig_info_to_posix_lock(call_frame_t *frame, lock_migration_info_t *lmi)
     lock->owner = lmi->flock.l_owner;
 
     INIT_LIST_HEAD(&lock->list);
+    gf_interval_node_init(&lock->node);
 
 out:
     return lock;
@@ -4349,6 +4361,9 @@ pl_write_active_locks(call_frame_t *frame, pl_inode_t *pl_inode,
                 goto out;
             }
             list_add_tail(&newlock->list, &pl_inode->ext_list);
+            gf_interval_tree_insert(&pl_inode->ext_tree, &newlock->node,
+                                    pl_range_key(newlock->fl_start),
+                                    pl_range_key(newlock->fl_end));
         }
     }
     /*TODO: What if few lock add failed with ENOMEM. Should the already
@@ -183,7 +183,7 @@ __reserve_unlock_lock(xlator_t *this, posix_lock_t *lock, pl_inode_t *pl_inode)
         gf_log(this->name, GF_LOG_DEBUG, " Matching lock not found for unlock");
         goto out;
     }
-    __delete_lock(conf);
+    __delete_lock(pl_inode, conf);
     gf_log(this->name, GF_LOG_DEBUG, " Matching lock found for unlock");
 
 out:
@@ -20,6 +20,7 @@
 
 #include <glusterfs/statedump.h>
 #include <glusterfs/syncop.h>
+#include <glusterfs/timespec.h>
 
 #include "upcall.h"
 #include "upcall-mem-types.h"
@@ -581,6 +582,381 @@ out:
     return;
 }
 
+static uint32_t
+upcall_inval_bucket(uuid_t gfid)
+{
+    return ((gfid[14] << 8) | gfid[15]) % UPCALL_INVAL_BUCKETS;
+}
+
+static void
+upcall_inval_entry_free(upcall_inval_entry_t *entry)
+{
+    if (entry->ca.dict)
+        dict_unref(entry->ca.dict);
+    GF_FREE(entry);
+}
+
+static void
+upcall_inval_queue_free(upcall_inval_queue_t *queue)
+{
+    upcall_inval_entry_t *entry = NULL;
+    upcall_inval_entry_t *tmp = NULL;
+
+    list_for_each_entry_safe(entry, tmp, &queue->entries, list)
+    {
+        list_del_init(&entry->list);
+        upcall_inval_entry_free(entry);
+    }
+
+    GF_FREE(queue->client_uid);
+    GF_FREE(queue);
+}
+
+static upcall_inval_queue_t *
+__upcall_inval_queue_get(upcall_private_t *priv, char *client_uid)
+{
+    upcall_inval_queue_t *queue = NULL;
+    int i = 0;
+
+    list_for_each_entry(queue, &priv->inval_queues, queue_list)
+    {
+        if (!strcmp(queue->client_uid, client_uid))
+            return queue;
+    }
+
+    queue = GF_CALLOC(1, sizeof(*queue), gf_upcall_mt_inval_queue_t);
+    if (!queue)
+        return NULL;
+
+    queue->client_uid = gf_strdup(client_uid);
+    if (!queue->client_uid) {
+        GF_FREE(queue);
+        return NULL;
+    }
+
+    INIT_LIST_HEAD(&queue->entries);
+    for (i = 0; i < UPCALL_INVAL_BUCKETS; i++)
+        INIT_LIST_HEAD(&queue->buckets[i]);
+    list_add_tail(&queue->queue_list, &priv->inval_queues);
+
+    return queue;
+}
+
+/*
+ * A later invalidation of the same gfid can be folded into an earlier one
+ * unless they carry different things in the same field: xattrs being set and
+ * xattrs being removed share the dict, and there is room for a single parent
+ * and old parent.
+ */
+static gf_boolean_t
+upcall_inval_mergeable(struct gf_upcall_cache_invalidation *ca, uint32_t flags,
+                       struct iatt *p_stbuf, struct iatt *oldp_stbuf)
+{
+    if ((ca->flags & (UP_XATTR | UP_XATTR_RM)) !=
+        (flags & (UP_XATTR | UP_XATTR_RM)))
+        return _gf_false;
+
+    if ((ca->flags & UP_PARENT_DENTRY_FLAGS) &&
+        (flags & UP_PARENT_DENTRY_FLAGS) && p_stbuf &&
+        gf_uuid_compare(ca->p_stat.ia_gfid, p_stbuf->ia_gfid))
+        return _gf_false;
+
+    if ((ca->flags & UP_RENAME_FLAGS) && (flags & UP_RENAME_FLAGS) &&
+        oldp_stbuf && gf_uuid_compare(ca->oldp_stat.ia_gfid, oldp_stbuf->ia_gfid))
+        return _gf_false;
+
+    return _gf_true;
+}
+
+static int
+upcall_inval_merge(struct gf_upcall_cache_invalidation *ca, uint32_t flags,
+                   struct iatt *stbuf, struct iatt *p_stbuf,
+                   struct iatt *oldp_stbuf, dict_t *xattr)
+{
+    dict_t *dict = NULL;
+
+    /* The dict may be queued for other clients as well, so a merged one is
+     * a new dict. */
+    if (xattr && ca->dict) {
+        dict = dict_copy_with_ref(ca->dict, NULL);
+        if (!dict)
+            return -1;
+        dict_copy(xattr, dict);
+        dict_unref(ca->dict);
+        ca->dict = dict;
+    } else if (xattr) {
+        ca->dict = dict_ref(xattr);
+    }
+
+    ca->flags |= flags;
+    if (stbuf)
+        ca->stat = *stbuf;
+    if (p_stbuf && (flags & UP_PARENT_DENTRY_FLAGS))
+        ca->p_stat = *p_stbuf;
+    if (oldp_stbuf && (flags & UP_RENAME_FLAGS))
+        ca->oldp_stat = *oldp_stbuf;
+
+    return 0;
+}
+
+/* Sends the invalidations taken from the queue of a client, and frees them */
+static void
+upcall_inval_send(xlator_t *this, char *client_uid, struct list_head *entries,
+                  uint32_t count)
+{
+    struct gf_upcall up_req = {
+        0,
+    };
+    struct gf_upcall_cache_invalidation_batch batch = {
+        0,
+    };
+    upcall_inval_entry_t *entry = NULL;
+    upcall_inval_entry_t *tmp = NULL;
+
+    up_req.client_uid = client_uid;
+
+    if (count > 1)
+        batch.entries = GF_CALLOC(count, sizeof(*batch.entries),
+                                  gf_upcall_mt_inval_batch_t);
+
+    if (batch.entries) {
+        list_for_each_entry(entry, entries, list)
+        {
+            batch.entries[batch.count].client_uid = client_uid;
+            gf_uuid_copy(batch.entries[batch.count].gfid, entry->gfid);
+            batch.entries[batch.count].event_type =
+                GF_UPCALL_CACHE_INVALIDATION;
+            batch.entries[batch.count].data = &entry->ca;
+            batch.count++;
+        }
+
+        up_req.event_type = GF_UPCALL_CACHE_INVALIDATION_BATCH;
+        up_req.data = &batch;
+
+        gf_log(THIS->name, GF_LOG_TRACE,
+               "%u cache invalidation notifications sent to %s", batch.count,
+               client_uid);
+
+        (void)this->notify(this, GF_EVENT_UPCALL, &up_req);
+
+        GF_FREE(batch.entries);
+    } else {
+        /* A single invalidation, or no memory for a batch */
+        list_for_each_entry(entry, entries, list)
+        {
+            gf_uuid_copy(up_req.gfid, entry->gfid);
+            up_req.event_type = GF_UPCALL_CACHE_INVALIDATION;
+            up_req.data = &entry->ca;
+
+            (void)this->notify(this, GF_EVENT_UPCALL, &up_req);
+        }
+    }
+
+    list_for_each_entry_safe(entry, tmp, entries, list)
+    {
+        list_del_init(&entry->list);
+        upcall_inval_entry_free(entry);
+    }
+}
+
+/*
+ * Queues an invalidation for the client, or folds it into the last one queued
+ * for the same gfid. A full queue is handed to the flusher thread right away,
+ * the others at the end of the batch window. Only the flusher sends them, so
+ * the batches of a client can't overtake each other.
+ */
+static void
+upcall_inval_queue_add(xlator_t *this, upcall_client_t *up_client_entry,
+                       uuid_t gfid, uint32_t flags, struct iatt *stbuf,
+                       struct iatt *p_stbuf, struct iatt *oldp_stbuf,
+                       dict_t *xattr)
+{
+    upcall_private_t *priv = this->private;
+    upcall_inval_queue_t *queue = NULL;
+    upcall_inval_entry_t *entry = NULL;
+    upcall_inval_entry_t *last = NULL;
+    struct list_head *bucket = NULL;
+    int ret = -1;
+
+    pthread_mutex_lock(&priv->inval_lock);
+    {
+        queue = __upcall_inval_queue_get(priv, up_client_entry->client_uid);
+        if (!queue)
+            goto unlock;
+
+        /* Entries are added at the head of their bucket, so the first one
+         * found is the last one queued for the gfid. */
+        bucket = &queue->buckets[upcall_inval_bucket(gfid)];
+        list_for_each_entry(entry, bucket, bucket)
+        {
+            if (!gf_uuid_compare(entry->gfid, gfid)) {
+                last = entry;
+                break;
+            }
+        }
+
+        if (last &&
+            upcall_inval_mergeable(&last->ca, flags, p_stbuf, oldp_stbuf) &&
+            !upcall_inval_merge(&last->ca, flags, stbuf, p_stbuf, oldp_stbuf,
+                                xattr)) {
+            last->ca.expire_time_attr = up_client_entry->expire_time_attr;
+            ret = 0;
+            goto unlock;
+        }
+
+        entry = GF_CALLOC(1, sizeof(*entry), gf_upcall_mt_inval_entry_t);
+        if (!entry)
+            goto unlock;
+
+        gf_uuid_copy(entry->gfid, gfid);
+        entry->ca.flags = flags;
+        entry->ca.expire_time_attr = up_client_entry->expire_time_attr;
+        if (stbuf)
+            entry->ca.stat = *stbuf;
+        if (p_stbuf)
+            entry->ca.p_stat = *p_stbuf;
+        if (oldp_stbuf)
+            entry->ca.oldp_stat = *oldp_stbuf;
+        if (xattr)
+            entry->ca.dict = dict_ref(xattr);
+
+        list_add(&entry->bucket, bucket);
+        list_add_tail(&entry->list, &queue->entries);
+        queue->count++;
+        ret = 0;
+
+        /* Later invalidations for the client go to a new queue. */
+        if (queue->count >= UPCALL_INVAL_BATCH_MAX) {
+            list_move_tail(&queue->queue_list, &priv->inval_full);
+            pthread_cond_signal(&priv->inval_cond);
+        }
+    }
+unlock:
+    pthread_mutex_unlock(&priv->inval_lock);
+
+    if (ret < 0)
+        gf_msg("upcall", GF_LOG_WARNING, 0, UPCALL_MSG_NO_MEMORY,
+               "Memory allocation failed");
+}
+
+/*
+ * Sends the queues that got full as soon as they do, what has been queued
+ * for each client at the end of every batch window, and what is left once
+ * batching gets disabled or the window changes. Full queues are older than
+ * the ones still being filled for the same client, so they go first.
+ */
+static void *
+upcall_flusher_thread(void *data)
+{
+    xlator_t *this = data;
+    upcall_private_t *priv = this->private;
+    upcall_inval_queue_t *queue = NULL;
+    upcall_inval_queue_t *tmp = NULL;
+    struct list_head queues;
+    struct timespec deadline;
+    struct timespec now;
+    uint32_t window = 0;
+    uint32_t armed = 0;
+    gf_boolean_t expired = _gf_false;
+
+    INIT_LIST_HEAD(&queues);
+
+    pthread_mutex_lock(&priv->inval_lock);
+    while (!priv->flusher_fini) {
+        window = priv->cache_invalidation_batch_window;
+        if (window != armed) {
+            /* Everything queued with the old window is sent now. */
+            expired = _gf_true;
+            armed = 0;
+        } else if (window) {
+            if (list_empty(&priv->inval_full))
+                (void)pthread_cond_timedwait(&priv->inval_cond,
+                                             &priv->inval_lock, &deadline);
+            timespec_now_realtime(&now);
+            expired = (timespec_cmp(&now, &deadline) >= 0);
+        } else {
+            if (list_empty(&priv->inval_queues) &&
+                list_empty(&priv->inval_full))
+                (void)pthread_cond_wait(&priv->inval_cond, &priv->inval_lock);
+            expired = _gf_true;
+        }
+
+        if (expired || priv->flusher_fini) {
+            list_splice_init(&priv->inval_queues, &queues);
+            if (window) {
+                timespec_now_realtime(&deadline);
+                timespec_adjust_delta(
+                    &deadline, (struct timespec){
+                                   .tv_sec = window / 1000,
+                                   .tv_nsec = (window % 1000) * 1000000,
+                               });
+                armed = window;
+            }
+        }
+        /* Spliced at the head, before the queues still being filled */
+        list_splice_init(&priv->inval_full, &queues);
+        pthread_mutex_unlock(&priv->inval_lock);
+
+        list_for_each_entry_safe(queue, tmp, &queues, queue_list)
+        {
+            list_del_init(&queue->queue_list);
+            upcall_inval_send(this, queue->client_uid, &queue->entries,
+                              queue->count);
+            upcall_inval_queue_free(queue);
+        }
+
+        pthread_mutex_lock(&priv->inval_lock);
+    }
+    pthread_mutex_unlock(&priv->inval_lock);
+
+    return NULL;
+}
+
+int
+upcall_flusher_thread_init(xlator_t *this)
+{
+    upcall_private_t *priv = this->private;
+    int ret = 0;
+
+    if (priv->flusher_init_done)
+        return 0;
+
+    ret = gf_thread_create(&priv->flusher_thr, NULL, upcall_flusher_thread,
+                           this, "upflush");
+    if (ret == 0)
+        priv->flusher_init_done = _gf_true;
+
+    return ret;
+}
+
+/* Stops the flusher thread once it has sent everything queued */
+void
+upcall_flusher_thread_fini(xlator_t *this)
+{
+    upcall_private_t *priv = this->private;
+    upcall_inval_queue_t *queue = NULL;
+    upcall_inval_queue_t *tmp = NULL;
+
+    if (priv->flusher_init_done) {
+        pthread_mutex_lock(&priv->inval_lock);
+        {
+            priv->flusher_fini = _gf_true;
+            pthread_cond_signal(&priv->inval_cond);
+        }
+        pthread_mutex_unlock(&priv->inval_lock);
+
+        pthread_join(priv->flusher_thr, NULL);
+        priv->flusher_init_done = _gf_false;
+    }
+
+    list_splice_init(&priv->inval_queues, &priv->inval_full);
+    list_for_each_entry_safe(queue, tmp, &priv->inval_full, queue_list)
+    {
+        list_del_init(&queue->queue_list);
+        upcall_inval_queue_free(queue);
+    }
+}
+
 /*
  * If the upcall_client_t has recently accessed the file (i.e, within
  * priv->cache_invalidation_timeout), send a upcall notification.
@@ -598,6 +974,7 @@ upcall_client_cache_invalidate(xlator_t *this, uuid_t gfid,
     struct gf_upcall_cache_invalidation ca_req = {
         0,
     };
+    upcall_private_t *priv = this->private;
     time_t timeout = 0;
     int ret = -1;
     time_t t_expired = now - up_client_entry->access_time;
@@ -607,6 +984,12 @@ upcall_client_cache_invalidate(xlator_t *this, uuid_t gfid,
     timeout = get_cache_invalidation_timeout(this);
 
     if (t_expired < timeout) {
+        if (priv->cache_invalidation_batch_window) {
+            upcall_inval_queue_add(this, up_client_entry, gfid, flags, stbuf,
+                                   p_stbuf, oldp_stbuf, xattr);
+            goto out;
+        }
+
         /* Send notify call */
         up_req.client_uid = up_client_entry->client_uid;
         gf_uuid_copy(up_req.gfid, gfid);
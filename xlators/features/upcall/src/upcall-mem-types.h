@@ -18,6 +18,9 @@ enum gf_upcall_mem_types_ {
     gf_upcall_mt_private_t,
     gf_upcall_mt_upcall_inode_ctx_t,
     gf_upcall_mt_upcall_client_entry_t,
+    gf_upcall_mt_inval_queue_t,
+    gf_upcall_mt_inval_entry_t,
+    gf_upcall_mt_inval_batch_t,
     gf_upcall_mt_end
 };
 #endif
@@ -2218,6 +2218,7 @@ int
 reconfigure(xlator_t *this, dict_t *options)
 {
     upcall_private_t *priv = NULL;
+    uint32_t batch_window = 0;
     int ret = -1;
 
     priv = this->private;
@@ -2227,9 +2228,32 @@ reconfigure(xlator_t *this, dict_t *options)
                      options, bool, out);
     GF_OPTION_RECONF("cache-invalidation-timeout",
                      priv->cache_invalidation_timeout, options, int32, out);
+    GF_OPTION_RECONF("cache-invalidation-batch-window", batch_window, options,
+                     uint32, out);
+
+    /* Wake the flusher up so that it sends what has been queued so far
+     * with the old window. */
+    pthread_mutex_lock(&priv->inval_lock);
+    {
+        priv->cache_invalidation_batch_window = batch_window;
+        pthread_cond_signal(&priv->inval_cond);
+    }
+    pthread_mutex_unlock(&priv->inval_lock);
 
     ret = 0;
 
+    if (priv->cache_invalidation_enabled && batch_window &&
+        !priv->flusher_init_done) {
+        ret = upcall_flusher_thread_init(this);
+        if (ret) {
+            gf_msg("upcall", GF_LOG_WARNING, 0, UPCALL_MSG_INTERNAL_ERROR,
+                   "flusher_thread creation failed (%s)."
+                   " Disabling cache invalidation batching",
+                   strerror(errno));
+            priv->cache_invalidation_batch_window = 0;
+        }
+    }
+
     if (priv->cache_invalidation_enabled && !priv->reaper_init_done) {
         ret = upcall_reaper_thread_init(this);
 
@@ -2264,10 +2288,17 @@ init(xlator_t *this)
                    out);
     GF_OPTION_INIT("cache-invalidation-timeout",
                    priv->cache_invalidation_timeout, int32, out);
+    GF_OPTION_INIT("cache-invalidation-batch-window",
+                   priv->cache_invalidation_batch_window, uint32, out);
 
     LOCK_INIT(&priv->inode_ctx_lk);
     INIT_LIST_HEAD(&priv->inode_ctx_list);
 
+    pthread_mutex_init(&priv->inval_lock, NULL);
+    pthread_cond_init(&priv->inval_cond, NULL);
+    INIT_LIST_HEAD(&priv->inval_queues);
+    INIT_LIST_HEAD(&priv->inval_full);
+
     priv->fini = 0;
     priv->reaper_init_done = _gf_false;
 
@@ -2286,6 +2317,19 @@ init(xlator_t *this)
         }
         priv->reaper_init_done = _gf_true;
     }
+
+    if (!ret && priv->cache_invalidation_enabled &&
+        priv->cache_invalidation_batch_window) {
+        ret = upcall_flusher_thread_init(this);
+        if (ret) {
+            gf_msg("upcall", GF_LOG_WARNING, 0, UPCALL_MSG_INTERNAL_ERROR,
+                   "flusher_thread creation failed (%s)."
+                   " Disabling cache invalidation batching",
+                   strerror(errno));
+            priv->cache_invalidation_batch_window = 0;
+            ret = 0;
+        }
+    }
 out:
     if (ret && priv) {
         if (priv->xattrs)
@@ -2316,6 +2360,10 @@ fini(xlator_t *this)
         priv->reaper_init_done = _gf_false;
     }
 
+    upcall_flusher_thread_fini(this);
+    pthread_cond_destroy(&priv->inval_cond);
+    pthread_mutex_destroy(&priv->inval_lock);
+
     dict_unref(priv->xattrs);
     LOCK_DESTROY(&priv->inode_ctx_lk);
 
@@ -2487,6 +2535,18 @@ struct volume_options options[] = {
      .op_version = {GD_OP_VERSION_3_7_0},
      .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
      .tags = {"cache", "cachetimeout", "upcall"}},
+    {.key = {"cache-invalidation-batch-window"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 0,
+     .max = 1000,
+     .default_value = "0",
+     .description = "Milliseconds for which cache-invalidation"
+                    " notifications are held back, so that the ones for the"
+                    " same file are merged and the others sent to each client"
+                    " in a single message. 0 sends each of them right away.",
+     .op_version = {GD_OP_VERSION_11_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .tags = {"cache", "upcall"}},
     {.key = {NULL}},
 };
 
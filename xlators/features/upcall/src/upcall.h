@@ -57,9 +57,42 @@ struct _upcall_private {
     int32_t fini;
     dict_t *xattrs; /* list of xattrs registered by clients
                        for receiving invalidation */
+
+    /* Cache invalidations are queued per client for that many msecs, and
+     * sent in batches. 0 sends each of them right away. */
+    uint32_t cache_invalidation_batch_window;
+    struct list_head inval_queues; /* upcall_inval_queue_t */
+    struct list_head inval_full;   /* full queues, oldest first */
+    pthread_mutex_t inval_lock;    /* protects the queues and the flusher */
+    pthread_cond_t inval_cond;
+    gf_boolean_t flusher_init_done;
+    gf_boolean_t flusher_fini;
+    pthread_t flusher_thr;
 };
 typedef struct _upcall_private upcall_private_t;
 
+#define UPCALL_INVAL_BUCKETS 64
+/* Largest batch, to keep the RPC well below the size of an iobuf */
+#define UPCALL_INVAL_BATCH_MAX 256
+
+/* Cache invalidations not sent yet to a client, oldest first */
+struct _upcall_inval_queue {
+    struct list_head queue_list; /* in inval_queues */
+    char *client_uid;
+    struct list_head entries;
+    struct list_head buckets[UPCALL_INVAL_BUCKETS]; /* entries by gfid */
+    uint32_t count;
+};
+typedef struct _upcall_inval_queue upcall_inval_queue_t;
+
+struct _upcall_inval_entry {
+    struct list_head list;   /* in the queue */
+    struct list_head bucket; /* newest first in its gfid bucket */
+    uuid_t gfid;
+    struct gf_upcall_cache_invalidation ca; /* holds a ref on ca.dict */
+};
+typedef struct _upcall_inval_entry upcall_inval_entry_t;
+
 struct _upcall_client {
     struct list_head client_list;
     /* strdup to store client_uid, strdup. Free it explicitly */
@@ -110,6 +143,11 @@ upcall_reaper_thread(void *data);
 int
 upcall_reaper_thread_init(xlator_t *this);
 
+int
+upcall_flusher_thread_init(xlator_t *this);
+void
+upcall_flusher_thread_fini(xlator_t *this);
+
 /* Xlator options */
 gf_boolean_t
 is_upcall_enabled(xlator_t *this);
@@ -1258,6 +1258,14 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .voltype = "performance/io-threads",
      .option = "pass-through",
      .op_version = GD_OP_VERSION_4_1_0},
+    {.key = "performance.iot-adaptive-threads",
+     .voltype = "performance/io-threads",
+     .option = "adaptive-threads",
+     .op_version = GD_OP_VERSION_11_0},
+    {.key = "performance.iot-adaptive-target-wait",
+     .voltype = "performance/io-threads",
+     .option = "adaptive-target-wait",
+     .op_version = GD_OP_VERSION_11_0},
 
     /* Other perf xlators' options */
     {.key = "performance.io-cache-pass-through",
@@ -2401,6 +2409,12 @@ struct volopt_map_entry glusterd_volopt_map[] = {
         .voltype = "storage/posix",
         .op_version = GD_OP_VERSION_4_0_0,
     },
+    {
+        .option = "rchecksum-tree",
+        .key = "storage.rchecksum-tree",
+        .voltype = "storage/posix",
+        .op_version = GD_OP_VERSION_11_0,
+    },
     {
         .option = "force-create-mode",
         .key = "storage.force-create-mode",
@@ -2674,6 +2688,11 @@ struct volopt_map_entry glusterd_volopt_map[] = {
         .voltype = "features/upcall",
         .op_version = GD_OP_VERSION_3_7_0,
     },
+    {
+        .key = "features.cache-invalidation-batch-window",
+        .voltype = "features/upcall",
+        .op_version = GD_OP_VERSION_11_0,
+    },
     {
         .key = "ganesha.enable",
         .voltype = "mgmt/ganesha",
@@ -2726,6 +2745,11 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .voltype = "cluster/replicate",
      .op_version = GD_OP_VERSION_3_7_12,
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "cluster.shd-index-readers",
+     .voltype = "cluster/replicate",
+     .op_version = GD_OP_VERSION_11_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT,
+     .validate_fn = validate_replica},
     {.key = "cluster.locking-scheme",
      .voltype = "cluster/replicate",
      .type = DOC,
@@ -3002,6 +3026,22 @@ struct volopt_map_entry glusterd_volopt_map[] = {
                     " count should be in the range"
                     "[disperse-data-count,  disperse-count] (inclusive)",
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "disperse.systematic",
+     .voltype = "cluster/disperse",
+     .op_version = GD_OP_VERSION_11_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "disperse.parity-delta",
+     .voltype = "cluster/disperse",
+     .op_version = GD_OP_VERSION_11_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "disperse.compute-threads",
+     .voltype = "cluster/disperse",
+     .op_version = GD_OP_VERSION_11_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "disperse.compute-threshold",
+     .voltype = "cluster/disperse",
+     .op_version = GD_OP_VERSION_11_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
     {
         .key = "features.sdfs",
         .voltype = "features/sdfs",
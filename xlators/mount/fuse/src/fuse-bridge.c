@@ -11,6 +11,8 @@
 #include <config.h>
 
 #include <sys/wait.h>
+#include <sys/ioctl.h>
+#include <urcu/uatomic.h>
 #include "fuse-bridge.h"
 #include <glusterfs/glusterfs.h>
 #include <glusterfs/byte-order.h>
@@ -345,6 +347,25 @@ check_and_dump_fuse_W(fuse_private_t *priv, struct iovec *iov_out, int count,
     return 0;
 }
 
+/*
+ * The kernel only accepts the reply to a request on the channel the request
+ * was read from. Reader threads stash the index of that channel in the
+ * (otherwise unused) padding of the request header, 0 standing for 'fd'.
+ * A slot is set once by its reader thread, and read by the threads sending
+ * replies, hence the atomic accesses.
+ */
+static int
+fuse_chan_fd(fuse_private_t *priv, uint32_t chan)
+{
+    int fd = -1;
+
+    if ((chan > 0) && (chan < priv->reader_thread_count) &&
+        (priv->chan_fd != NULL))
+        fd = uatomic_read(&priv->chan_fd[chan]);
+
+    return (fd != -1) ? fd : priv->fd;
+}
+
 /*
  * iov_out should contain a fuse_out_header at zeroth position.
  * The error value of this header is sent to kernel.
@@ -370,7 +391,7 @@ send_fuse_iov(xlator_t *this, fuse_in_header_t *finh, struct iovec *iov_out,
         fouh->len += iov_out[i].iov_len;
     fouh->unique = finh->unique;
 
-    res = sys_writev(priv->fd, iov_out, count);
+    res = sys_writev(fuse_chan_fd(priv, finh->padding), iov_out, count);
     gf_log("glusterfs-fuse", GF_LOG_TRACE, "writev() result %d/%d %s", res,
            fouh->len, res == -1 ? strerror(errno) : "");
 
@@ -587,6 +608,7 @@ fuse_timed_message_new(void)
 
     /* should be NULL if not set */
     dmsg->fuse_message_body = NULL;
+    dmsg->chan = 0;
     INIT_LIST_HEAD(&dmsg->next);
     memset(dmsg->errnomask, 0, sizeof(dmsg->errnomask));
 
@@ -787,6 +809,7 @@ fuse_interrupt(xlator_t *this, fuse_in_header_t *finh, void *msg,
         dmsg->fuse_out_header.unique = finh->unique;
         dmsg->fuse_out_header.len = sizeof(dmsg->fuse_out_header);
         dmsg->fuse_out_header.error = -EAGAIN;
+        dmsg->chan = finh->padding;
         if (ENOENT < ERRNOMASK_MAX)
             MASK_ERRNO(dmsg->errnomask, ENOENT);
         timespec_now(&dmsg->scheduled_ts);
@@ -5071,7 +5094,7 @@ timed_response_loop(void *data)
                                  sizeof(struct fuse_out_header)};
         iovs[1] = (struct iovec){dmsg->fuse_message_body,
                                  len - sizeof(struct fuse_out_header)};
-        rv = sys_writev(priv->fd, iovs, 2);
+        rv = sys_writev(fuse_chan_fd(priv, dmsg->chan), iovs, 2);
         check_and_dump_fuse_W(priv, iovs, 2, rv, dmsg->errnomask);
 
         fuse_timed_message_free(dmsg);
@@ -5142,7 +5165,7 @@ fuse_init(xlator_t *this, fuse_in_header_t *finh, void *msg,
     fino.major = FUSE_KERNEL_VERSION;
     fino.minor = FUSE_KERNEL_MINOR_VERSION;
     fino.max_readahead = 1 << 17;
-    fino.max_write = 1 << 17;
+    fino.max_write = min(priv->max_write, 1 << 17);
     fino.flags = FUSE_ASYNC_READ | FUSE_POSIX_LOCKS;
 #if FUSE_KERNEL_MINOR_VERSION >= 17
     if (fini->minor >= 17)
@@ -5289,6 +5312,27 @@ fuse_init(xlator_t *this, fuse_in_header_t *finh, void *msg,
     }
 #endif
 
+#if FUSE_KERNEL_MINOR_VERSION >= 28
+    /* Without FUSE_MAX_PAGES the kernel caps requests at 32 pages. The
+     * reader threads already allocate buffers of 'max-write' bytes, so
+     * larger requests can be accepted as soon as the kernel offers it. */
+    if (priv->max_write > (1 << 17)) {
+        if (fini->minor >= 28 && (fini->flags & FUSE_MAX_PAGES)) {
+            long pagesize = sysconf(_SC_PAGESIZE);
+
+            fino.flags |= FUSE_MAX_PAGES;
+            fino.max_pages = (priv->max_write + pagesize - 1) / pagesize;
+            fino.max_write = priv->max_write;
+            fino.max_readahead = priv->max_write;
+        } else {
+            gf_log("glusterfs-fuse", GF_LOG_INFO,
+                   "max-write of %" PRIu64 " bytes is not supported by "
+                   "kernel, limiting requests to %u bytes",
+                   priv->max_write, fino.max_write);
+        }
+    }
+#endif
+
     ret = send_fuse_data(this, finh, &fino, size);
     if (ret == 0)
         gf_log("glusterfs-fuse", GF_LOG_INFO,
@@ -6055,6 +6099,57 @@ fuse_dispatch(xlator_t *xl, gf_async_t *async)
  * found to be reduces 'REALLOC()' in the loop */
 #define FUSE_EXTRA_ALLOC 512
 
+/* Open a new /dev/fuse channel attached to the connection of 'priv->fd'.
+ * Requests are then spread by the kernel among all channels, each one with
+ * its own processing queue, instead of having all reader threads wake up
+ * on the same file. Returns -1 if the kernel doesn't support it. */
+static int
+fuse_chan_clone(xlator_t *this, fuse_private_t *priv)
+{
+#if defined(GF_LINUX_HOST_OS) && defined(FUSE_DEV_IOC_CLONE)
+    uint32_t master = priv->fd;
+    int fd;
+
+    fd = sys_open("/dev/fuse", O_RDWR | O_CLOEXEC, 0);
+    if (fd < 0) {
+        gf_log(this->name, GF_LOG_INFO, "failed to open /dev/fuse (%s)",
+               strerror(errno));
+        return -1;
+    }
+
+    if (ioctl(fd, FUSE_DEV_IOC_CLONE, &master) < 0) {
+        gf_log(this->name, GF_LOG_INFO,
+               "failed to clone /dev/fuse channel (%s), using shared one",
+               strerror(errno));
+        sys_close(fd);
+        return -1;
+    }
+
+    return fd;
+#else
+    return -1;
+#endif
+}
+
+/* Close the channels cloned by the reader threads, when the connection is
+ * torn down. */
+static void
+fuse_chan_fini(fuse_private_t *priv)
+{
+    int *chan_fd = priv->chan_fd;
+    uint32_t i;
+
+    if (chan_fd == NULL)
+        return;
+
+    priv->chan_fd = NULL;
+    for (i = 0; i < priv->reader_thread_count; i++) {
+        if (chan_fd[i] != -1)
+            sys_close(chan_fd[i]);
+    }
+    GF_FREE(chan_fd);
+}
+
 static void *
 fuse_thread_proc(void *data)
 {
@@ -6077,15 +6172,30 @@ fuse_thread_proc(void *data)
         0,
     }};
     uint32_t psize;
+    uint32_t chan;
+    uint32_t read_chan = 0; /* channel of 'chan_fd', 0 until it's cloned */
+    int chan_fd;
+    gf_boolean_t chan_cloned = _gf_false;
 
     this = data;
     priv = this->private;
 
     THIS = this;
 
+    /* The kernel refuses to read into a buffer smaller than the largest
+     * request it may send, so size it for 'max-write' from the start. */
     psize = ((struct iobuf_pool *)this->ctx->iobuf_pool)->default_page_size;
+    if (psize < priv->max_write)
+        psize = priv->max_write;
     priv->msg0_len_p = &msg0_size;
 
+    pthread_mutex_lock(&priv->sync_mutex);
+    {
+        chan = priv->chan_count++;
+    }
+    pthread_mutex_unlock(&priv->sync_mutex);
+    chan_fd = priv->fd;
+
     for (;;) {
         /* THIS has to be reset here */
         THIS = this;
@@ -6124,6 +6234,23 @@ fuse_thread_proc(void *data)
         }
         pthread_mutex_unlock(&priv->sync_mutex);
 
+        /* Cloning needs a mounted connection, so it can only be done once
+         * the mount has completed. The first thread keeps the original fd,
+         * as do the others until then: their requests, INIT included, are
+         * answered on it. */
+        if (!chan_cloned && priv->mount_finished) {
+            chan_cloned = _gf_true;
+            if ((chan > 0) && priv->clone_fd && (priv->chan_fd != NULL)) {
+                chan_fd = fuse_chan_clone(this, priv);
+                if (chan_fd != -1) {
+                    uatomic_set(&priv->chan_fd[chan], chan_fd);
+                    read_chan = chan;
+                } else {
+                    chan_fd = priv->fd;
+                }
+            }
+        }
+
         /*
          * We don't want to block on readv while we're still waiting
          * for mount status.  That means we only want to get here if
@@ -6135,11 +6262,7 @@ fuse_thread_proc(void *data)
         if (priv->init_recvd)
             fuse_graph_sync(this);
 
-        /* TODO: This place should always get maximum supported buffer
-           size from 'fuse', which is as of today 128KB. If we bring in
-           support for higher block sizes support, then we should be
-           changing this one too */
-        iobuf = iobuf_get(this->ctx->iobuf_pool);
+        iobuf = iobuf_get2(this->ctx->iobuf_pool, psize);
 
         /* Add extra 512 byte to the first iov so that it can
          * accommodate "ordinary" non-write requests. It's not
@@ -6165,7 +6288,7 @@ fuse_thread_proc(void *data)
         iov_in[0].iov_len = msg0_size;
         iov_in[1].iov_len = psize;
 
-        res = sys_readv(priv->fd, iov_in, 2);
+        res = sys_readv(chan_fd, iov_in, 2);
 
         if (res == -1) {
             if (errno == ENODEV || errno == EBADF) {
@@ -6268,6 +6391,9 @@ fuse_thread_proc(void *data)
         if (priv->uid_map_root && finh->uid == priv->uid_map_root)
             finh->uid = 0;
 
+        /* Route the reply back to the channel this request was read from. */
+        finh->padding = read_chan;
+
         if (finh->opcode >= FUSE_OP_HIGH) {
             /* turn down MacFUSE specific messages */
             fuse_enosys(this, finh, msg, NULL);
@@ -6535,6 +6661,14 @@ notify(xlator_t *this, int32_t event, void *data, ...)
                 ->fuse_thread = GF_CALLOC(private->reader_thread_count,
                                           sizeof(pthread_t),
                                           gf_fuse_mt_pthread_t);
+               private
+                ->chan_fd = GF_MALLOC(
+                    private->reader_thread_count * sizeof(int),
+                    gf_fuse_mt_chan_fd_t);
+                if (private->chan_fd != NULL) {
+                    for (i = 0; i < private->reader_thread_count; i++)
+                        private->chan_fd[i] = -1;
+                }
                 for (i = 0; i < private->reader_thread_count; i++) {
                     ret = gf_thread_create(&private->fuse_thread[i], NULL,
                                            fuse_thread_proc, this, "fuseproc");
@@ -6761,6 +6895,10 @@ init(xlator_t *this_xl)
     GF_OPTION_INIT("reader-thread-count", priv->reader_thread_count, uint32,
                    cleanup_exit);
 
+    GF_OPTION_INIT("clone-fd", priv->clone_fd, bool, cleanup_exit);
+
+    GF_OPTION_INIT("max-write", priv->max_write, size_uint64, cleanup_exit);
+
     GF_OPTION_INIT("auto-invalidation", priv->fuse_auto_inval, bool,
                    cleanup_exit);
     GF_OPTION_INIT(ZR_ENTRY_TIMEOUT_OPT, priv->entry_timeout, double,
@@ -7061,6 +7199,8 @@ fini(xlator_t *this_xl)
         gf_log(this_xl->name, GF_LOG_INFO, "Closing fuse connection to '%s'.",
                mount_point);
 
+        fuse_chan_fini(priv);
+
         sys_close(priv->fuse_dump_fd);
         dict_del(this_xl->options, ZR_MOUNTPOINT_OPT);
     }
@@ -7177,6 +7317,24 @@ struct volume_options options[] = {
         .default_value = "false",
         .description = "Enables fuse in-kernel writeback cache.",
     },
+    {
+        .key = {"max-write"},
+        .type = GF_OPTION_TYPE_SIZET,
+        .default_value = "131072",
+        .min = 4096,
+        .max = 1048576,
+        .description = "Largest READ/WRITE request exchanged with the fuse "
+                       "kernel module. Values above 128KB are only honoured "
+                       "by kernels supporting FUSE_MAX_PAGES.",
+    },
+    {
+        .key = {"clone-fd"},
+        .type = GF_OPTION_TYPE_BOOL,
+        .default_value = "true",
+        .description = "Gives each reader thread its own /dev/fuse channel "
+                       "(FUSE_DEV_IOC_CLONE), so that they don't contend on "
+                       "a single device queue.",
+    },
     {
         .key = {"attr-times-granularity"},
         .type = GF_OPTION_TYPE_INT,
@@ -74,6 +74,16 @@ struct fuse_private {
     uint32_t reader_thread_count;
     char fuse_thread_started;
 
+    /* Per reader thread /dev/fuse channels. Slot 0 is always 'fd', the
+     * others are clones of it, or -1 if cloning is disabled or failed.
+     * 'chan_count' hands out the slots to the reader threads. */
+    int *chan_fd;
+    uint32_t chan_count;
+    gf_boolean_t clone_fd;
+
+    /* Largest READ/WRITE payload negotiated with the kernel */
+    uint64_t max_write;
+
     uint32_t direct_io_mode;
     size_t *msg0_len_p;
 
@@ -203,6 +213,7 @@ typedef struct fuse_invalidate_node fuse_invalidate_node_t;
 
 struct fuse_timed_message {
     struct fuse_out_header fuse_out_header;
+    uint32_t chan;
     void *fuse_message_body;
     struct timespec scheduled_ts;
     errnomask_t errnomask;
@@ -79,65 +79,79 @@ iot_get_ctx(xlator_t *this, client_t *client)
 }
 
 call_stub_t *
-__iot_dequeue(iot_conf_t *conf, int *pri)
+iot_dequeue(iot_conf_t *conf, int *pri)
 {
     call_stub_t *stub = NULL;
     int i = 0;
+    iot_queue_t *queue;
     iot_client_ctx_t *ctx;
 
     *pri = -1;
     for (i = 0; i < GF_FOP_PRI_MAX; i++) {
-        if (conf->ac_iot_count[i] >= conf->ac_iot_limit[i]) {
-            continue;
-        }
+        queue = &conf->queues[i];
 
-        if (list_empty(&conf->clients[i])) {
+        if (GF_ATOMIC_GET(queue->size) == 0) {
             continue;
         }
 
-        /* Get the first per-client queue for this priority. */
-        ctx = list_first_entry(&conf->clients[i], iot_client_ctx_t, clients);
-        if (!ctx) {
-            continue;
-        }
+        pthread_mutex_lock(&queue->lock);
+        {
+            /* Only this function increases @active, and always with the
+             * lock held, so it can't go above the limit. */
+            if (GF_ATOMIC_GET(queue->active) >= conf->ac_iot_limit[i]) {
+                goto unlock;
+            }
 
-        if (list_empty(&ctx->reqs)) {
-            continue;
-        }
+            if (list_empty(&queue->clients)) {
+                goto unlock;
+            }
 
-        /* Get the first request on that queue. */
-        stub = list_first_entry(&ctx->reqs, call_stub_t, list);
-        list_del_init(&stub->list);
-        if (list_empty(&ctx->reqs)) {
-            list_del_init(&ctx->clients);
-        } else {
-            list_rotate_left(&conf->clients[i]);
-        }
+            /* Get the first per-client queue for this priority. */
+            ctx = list_first_entry(&queue->clients, iot_client_ctx_t, clients);
+            if (list_empty(&ctx->reqs)) {
+                goto unlock;
+            }
 
-        conf->ac_iot_count[i]++;
-        conf->queue_marked[i] = _gf_false;
-        *pri = i;
-        break;
-    }
+            /* Get the first request on that queue. */
+            stub = list_first_entry(&ctx->reqs, call_stub_t, list);
+            list_del_init(&stub->list);
+            if (list_empty(&ctx->reqs)) {
+                list_del_init(&ctx->clients);
+            } else {
+                list_rotate_left(&queue->clients);
+            }
 
-    if (!stub)
-        return NULL;
+            GF_ATOMIC_INC(queue->active);
+            GF_ATOMIC_DEC(queue->size);
+            queue->marked = _gf_false;
+            if (GF_ATOMIC_GET(queue->active) > queue->peak_active) {
+                queue->peak_active = GF_ATOMIC_GET(queue->active);
+            }
+        }
+    unlock:
+        pthread_mutex_unlock(&queue->lock);
 
-    conf->queue_size--;
-    conf->queue_sizes[*pri]--;
+        if (stub) {
+            *pri = i;
+            break;
+        }
+    }
 
     return stub;
 }
 
 void
-__iot_enqueue(iot_conf_t *conf, call_stub_t *stub, int pri)
+iot_enqueue(iot_conf_t *conf, call_stub_t *stub, int pri)
 {
     client_t *client = stub->frame->root->client;
+    iot_queue_t *queue;
     iot_client_ctx_t *ctx;
 
     if (pri < 0 || pri >= GF_FOP_PRI_MAX)
         pri = GF_FOP_PRI_MAX - 1;
 
+    queue = &conf->queues[pri];
+
     if (client) {
         ctx = iot_get_ctx(THIS, client);
         if (ctx) {
@@ -147,17 +161,102 @@ __iot_enqueue(iot_conf_t *conf, call_stub_t *stub, int pri)
         ctx = NULL;
     }
     if (!ctx) {
-        ctx = &conf->no_client[pri];
+        ctx = &queue->no_client;
     }
 
-    if (list_empty(&ctx->reqs)) {
-        list_add_tail(&ctx->clients, &conf->clients[pri]);
+    GF_ATOMIC_INC(conf->stub_cnt);
+
+    if (conf->adaptive) {
+        timespec_now(&stub->queued);
     }
-    list_add_tail(&stub->list, &ctx->reqs);
 
-    conf->queue_size++;
-    GF_ATOMIC_INC(conf->stub_cnt);
-    conf->queue_sizes[pri]++;
+    pthread_mutex_lock(&queue->lock);
+    {
+        if (list_empty(&ctx->reqs)) {
+            list_add_tail(&ctx->clients, &queue->clients);
+        }
+        list_add_tail(&stub->list, &ctx->reqs);
+
+        GF_ATOMIC_INC(queue->size);
+    }
+    pthread_mutex_unlock(&queue->lock);
+}
+
+/*
+ * Tells whether a request could be dequeued now. Checking each queue with its
+ * lock held is what guarantees that a worker going to sleep either sees a
+ * request being queued, or is seen sleeping by the thread which queued it.
+ * Requests of a priority already having as many workers as its limit are left
+ * to those workers, which look for more once done with their current one.
+ */
+static gf_boolean_t
+iot_dequeuable(iot_conf_t *conf)
+{
+    gf_boolean_t found = _gf_false;
+    iot_queue_t *queue;
+    int i;
+
+    for (i = 0; !found && (i < GF_FOP_PRI_MAX); i++) {
+        queue = &conf->queues[i];
+        pthread_mutex_lock(&queue->lock);
+        found = (GF_ATOMIC_GET(queue->size) > 0) &&
+                (GF_ATOMIC_GET(queue->active) < conf->ac_iot_limit[i]);
+        pthread_mutex_unlock(&queue->lock);
+    }
+
+    return found;
+}
+
+/* Waits for requests to be queued. Returns _gf_true if the worker has to
+ * exit instead. */
+static gf_boolean_t
+iot_worker_wait(iot_conf_t *conf)
+{
+    struct timespec sleep_till = {
+        0,
+    };
+    gf_boolean_t bye = _gf_false;
+    int ret = 0;
+
+    pthread_mutex_lock(&conf->mutex);
+    {
+        GF_ATOMIC_INC(conf->sleep_count);
+        while (!iot_dequeuable(conf)) {
+            if (conf->down) {
+                bye = _gf_true; /*Avoid sleep*/
+                break;
+            }
+
+            clock_gettime(CLOCK_REALTIME_COARSE, &sleep_till);
+            sleep_till.tv_sec += conf->idle_time;
+
+            ret = pthread_cond_timedwait(&conf->cond, &conf->mutex,
+                                         &sleep_till);
+
+            if (conf->down || ret == ETIMEDOUT) {
+                bye = _gf_true;
+                break;
+            }
+        }
+        GF_ATOMIC_DEC(conf->sleep_count);
+
+        if (bye) {
+            if (conf->down || conf->curr_count > IOT_MIN_THREADS) {
+                conf->curr_count--;
+                if (conf->curr_count == 0)
+                    pthread_cond_broadcast(&conf->cond);
+                gf_msg_debug(conf->this->name, 0,
+                             "terminated. "
+                             "conf->curr_count=%d",
+                             conf->curr_count);
+            } else {
+                bye = _gf_false;
+            }
+        }
+    }
+    pthread_mutex_unlock(&conf->mutex);
+
+    return bye;
 }
 
 void *
@@ -166,80 +265,72 @@ iot_worker(void *data)
     iot_conf_t *conf = NULL;
     xlator_t *this = NULL;
     call_stub_t *stub = NULL;
-    struct timespec sleep_till = {
-        0,
-    };
-    int ret = 0;
     int pri = -1;
-    gf_boolean_t bye = _gf_false;
+    iot_queue_t *queue;
+    struct timespec queued;
+    struct timespec start;
+    struct timespec end;
 
     conf = data;
     this = conf->this;
     THIS = this;
 
     for (;;) {
-        pthread_mutex_lock(&conf->mutex);
-        {
-            if (pri != -1) {
-                conf->ac_iot_count[pri]--;
-                pri = -1;
-            }
-            while (conf->queue_size == 0) {
-                if (conf->down) {
-                    bye = _gf_true; /*Avoid sleep*/
-                    break;
-                }
+        stub = iot_dequeue(conf, &pri);
+        if (!stub) {
+            if (iot_worker_wait(conf))
+                break;
+            continue;
+        }
+        queue = &conf->queues[pri];
+
+        /* Requests queued before the controller was enabled have no
+         * timestamp and are not accounted. The stub may be gone once
+         * resumed, so its timestamp is copied first. */
+        queued = stub->queued;
+        if (queued.tv_sec || queued.tv_nsec) {
+            timespec_now(&start);
+        }
 
-                clock_gettime(CLOCK_REALTIME_COARSE, &sleep_till);
-                sleep_till.tv_sec += conf->idle_time;
+        if (stub->poison) {
+            gf_log(this->name, GF_LOG_INFO, "Dropping poisoned request %p.",
+                   stub);
+            call_stub_destroy(stub);
+        } else {
+            call_resume(stub);
+        }
 
-                conf->sleep_count++;
-                ret = pthread_cond_timedwait(&conf->cond, &conf->mutex,
-                                             &sleep_till);
-                conf->sleep_count--;
+        if (queued.tv_sec || queued.tv_nsec) {
+            timespec_now(&end);
+            GF_ATOMIC_ADD(queue->wait_ns, gf_tsdiff(&queued, &start));
+            GF_ATOMIC_ADD(queue->service_ns, gf_tsdiff(&start, &end));
+            GF_ATOMIC_INC(queue->served);
+        }
+        GF_ATOMIC_DEC(queue->active);
+        GF_ATOMIC_DEC(conf->stub_cnt);
+    }
 
-                if (conf->down || ret == ETIMEDOUT) {
-                    bye = _gf_true;
-                    break;
-                }
-            }
+    return NULL;
+}
 
-            if (bye) {
-                if (conf->down || conf->curr_count > IOT_MIN_THREADS) {
-                    conf->curr_count--;
-                    if (conf->curr_count == 0)
-                        pthread_cond_broadcast(&conf->cond);
-                    gf_msg_debug(conf->this->name, 0,
-                                 "terminated. "
-                                 "conf->curr_count=%d",
-                                 conf->curr_count);
-                } else {
-                    bye = _gf_false;
-                }
-            }
+/* Number of workers the queued requests could keep busy */
+static int
+iot_workers_wanted(iot_conf_t *conf)
+{
+    int wanted = 0;
+    int i = 0;
 
-            if (!bye)
-                stub = __iot_dequeue(conf, &pri);
-        }
-        pthread_mutex_unlock(&conf->mutex);
+    for (i = 0; i < GF_FOP_PRI_MAX; i++)
+        wanted += min(GF_ATOMIC_GET(conf->queues[i].size),
+                      conf->ac_iot_limit[i]);
 
-        if (stub) { /* guard against spurious wakeups */
-            if (stub->poison) {
-                gf_log(this->name, GF_LOG_INFO, "Dropping poisoned request %p.",
-                       stub);
-                call_stub_destroy(stub);
-            } else {
-                call_resume(stub);
-            }
-            GF_ATOMIC_DEC(conf->stub_cnt);
-        }
-        stub = NULL;
+    if (wanted < IOT_MIN_THREADS)
+        wanted = IOT_MIN_THREADS;
 
-        if (bye)
-            break;
-    }
+    if (wanted > conf->max_count)
+        wanted = conf->max_count;
 
-    return NULL;
+    return wanted;
 }
 
 int
@@ -247,10 +338,19 @@ do_iot_schedule(iot_conf_t *conf, call_stub_t *stub, int pri)
 {
     int ret = 0;
 
+    iot_enqueue(conf, stub, pri);
+
+    /* When no worker is sleeping and there are enough of them, the request
+     * will be picked up by one of them once it's done with its current one.
+     * The number of workers is read without the lock: if it's off, the next
+     * request will start the missing ones. */
+    if ((GF_ATOMIC_GET(conf->sleep_count) == 0) &&
+        (conf->curr_count >= iot_workers_wanted(conf))) {
+        return 0;
+    }
+
     pthread_mutex_lock(&conf->mutex);
     {
-        __iot_enqueue(conf, stub, pri);
-
         pthread_cond_signal(&conf->cond);
 
         ret = __iot_workers_scale(conf);
@@ -628,7 +728,7 @@ iot_getxattr(call_frame_t *frame, xlator_t *this, loc_t *loc, const char *name,
 
         for (i = 0; i < GF_FOP_PRI_MAX; i++) {
             if (dict_set_int32(depths, (char *)fop_pri_to_string(i),
-                               conf->queue_sizes[i]) != 0) {
+                               GF_ATOMIC_GET(conf->queues[i].size)) != 0) {
                 dict_unref(depths);
                 depths = NULL;
                 goto unwind_special_getxattr;
@@ -814,16 +914,8 @@ __iot_workers_scale(iot_conf_t *conf)
     int diff = 0;
     pthread_t thread;
     int ret = 0;
-    int i = 0;
-
-    for (i = 0; i < GF_FOP_PRI_MAX; i++)
-        scale += min(conf->queue_sizes[i], conf->ac_iot_limit[i]);
-
-    if (scale < IOT_MIN_THREADS)
-        scale = IOT_MIN_THREADS;
 
-    if (scale > conf->max_count)
-        scale = conf->max_count;
+    scale = iot_workers_wanted(conf);
 
     if (conf->curr_count < scale) {
         diff = scale - conf->curr_count;
@@ -837,9 +929,8 @@ __iot_workers_scale(iot_conf_t *conf)
         if (ret == 0) {
             pthread_detach(thread);
             conf->curr_count++;
-            gf_msg_debug(conf->this->name, 0,
-                         "scaled threads to %d (queue_size=%d/%d)",
-                         conf->curr_count, conf->queue_size, scale);
+            gf_msg_debug(conf->this->name, 0, "scaled threads to %d/%d",
+                         conf->curr_count, scale);
         } else {
             break;
         }
@@ -926,6 +1017,8 @@ iot_priv_dump(xlator_t *this)
     iot_conf_t *conf = NULL;
     char key_prefix[GF_DUMP_MAX_BUF_LEN];
     char key[GF_DUMP_MAX_BUF_LEN];
+    iot_queue_t *queue;
+    int32_t size = 0;
     int i = 0;
 
     if (!this)
@@ -941,7 +1034,7 @@ iot_priv_dump(xlator_t *this)
 
     gf_proc_dump_write("maximum_threads_count", "%d", conf->max_count);
     gf_proc_dump_write("current_threads_count", "%d", conf->curr_count);
-    gf_proc_dump_write("sleep_count", "%d", conf->sleep_count);
+    gf_proc_dump_write("sleep_count", "%d", GF_ATOMIC_GET(conf->sleep_count));
     gf_proc_dump_write("idle_time", "%d", conf->idle_time);
     gf_proc_dump_write("stack_size", "%zd", conf->stack_size);
     gf_proc_dump_write("max_high_priority_threads", "%d",
@@ -953,19 +1046,37 @@ iot_priv_dump(xlator_t *this)
     gf_proc_dump_write("max_least_priority_threads", "%d",
                        conf->ac_iot_limit[GF_FOP_PRI_LEAST]);
     gf_proc_dump_write("current_high_priority_threads", "%d",
-                       conf->ac_iot_count[GF_FOP_PRI_HI]);
+                       GF_ATOMIC_GET(conf->queues[GF_FOP_PRI_HI].active));
     gf_proc_dump_write("current_normal_priority_threads", "%d",
-                       conf->ac_iot_count[GF_FOP_PRI_NORMAL]);
+                       GF_ATOMIC_GET(conf->queues[GF_FOP_PRI_NORMAL].active));
     gf_proc_dump_write("current_low_priority_threads", "%d",
-                       conf->ac_iot_count[GF_FOP_PRI_LO]);
+                       GF_ATOMIC_GET(conf->queues[GF_FOP_PRI_LO].active));
     gf_proc_dump_write("current_least_priority_threads", "%d",
-                       conf->ac_iot_count[GF_FOP_PRI_LEAST]);
+                       GF_ATOMIC_GET(conf->queues[GF_FOP_PRI_LEAST].active));
     for (i = 0; i < GF_FOP_PRI_MAX; i++) {
-        if (!conf->queue_sizes[i])
+        size = GF_ATOMIC_GET(conf->queues[i].size);
+        if (!size)
             continue;
         snprintf(key, sizeof(key), "%s_priority_queue_length",
                  iot_get_pri_meaning(i));
-        gf_proc_dump_write(key, "%d", conf->queue_sizes[i]);
+        gf_proc_dump_write(key, "%d", size);
+    }
+
+    if (!conf->adaptive)
+        return 0;
+
+    gf_proc_dump_write("adaptive_target_wait_msecs", "%d", conf->target_wait);
+    for (i = 0; i < GF_FOP_PRI_LEAST; i++) {
+        queue = &conf->queues[i];
+        snprintf(key, sizeof(key), "%s_priority_avg_wait_usecs",
+                 iot_get_pri_meaning(i));
+        gf_proc_dump_write(key, "%" PRIu64, queue->avg_wait_us);
+        snprintf(key, sizeof(key), "%s_priority_avg_service_usecs",
+                 iot_get_pri_meaning(i));
+        gf_proc_dump_write(key, "%" PRIu64, queue->avg_service_us);
+        snprintf(key, sizeof(key), "%s_priority_adaptive_decision",
+                 iot_get_pri_meaning(i));
+        gf_proc_dump_write(key, "%s", queue->decision);
     }
 
     return 0;
@@ -1051,6 +1162,7 @@ iot_watchdog(void *arg)
 {
     xlator_t *this = arg;
     iot_conf_t *priv = this->private;
+    iot_queue_t *queue;
     int i;
     int bad_times[GF_FOP_PRI_MAX] = {
         0,
@@ -1062,9 +1174,10 @@ iot_watchdog(void *arg)
     for (;;) {
         sleep(max(priv->watchdog_secs / 5, 1));
         pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
-        pthread_mutex_lock(&priv->mutex);
         for (i = 0; i < GF_FOP_PRI_MAX; ++i) {
-            if (priv->queue_marked[i]) {
+            queue = &priv->queues[i];
+            pthread_mutex_lock(&queue->lock);
+            if (queue->marked) {
                 if (++bad_times[i] >= 5) {
                     gf_log(this->name, GF_LOG_WARNING, "queue %d stalled", i);
                     iot_apply_event(this, &thresholds[i]);
@@ -1078,9 +1191,9 @@ iot_watchdog(void *arg)
             } else {
                 bad_times[i] = 0;
             }
-            priv->queue_marked[i] = (priv->queue_sizes[i] > 0);
+            queue->marked = (GF_ATOMIC_GET(queue->size) > 0);
+            pthread_mutex_unlock(&queue->lock);
         }
-        pthread_mutex_unlock(&priv->mutex);
         pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
     }
 
@@ -1129,6 +1242,156 @@ stop_iot_watchdog(xlator_t *this)
     priv->watchdog_running = _gf_false;
 }
 
+/*
+ * Adaptive sizing of the pool. Every IOT_ADAPT_INTERVAL seconds, the average
+ * time the requests of each priority spent queued is compared with the
+ * target. Above it, the priority is allowed a quarter more workers, up to the
+ * thread count. Below half of it, it's allowed one less, as long as it didn't
+ * use all of them and one more than it kept busy on average remains. The
+ * number of threads follows the limits, idle ones exiting as usual. The least
+ * priority is throttled on purpose, so it's left alone.
+ */
+static void
+iot_adapt_queue(xlator_t *this, int pri)
+{
+    iot_conf_t *conf = this->private;
+    iot_queue_t *queue = &conf->queues[pri];
+    uint64_t target_ns = (uint64_t)conf->target_wait * 1000000;
+    uint64_t interval_ns = (uint64_t)IOT_ADAPT_INTERVAL * 1000000000;
+    uint64_t served;
+    uint64_t wait_ns;
+    uint64_t service_ns;
+    int32_t busy;
+    int32_t old_limit;
+    int32_t limit;
+    int32_t peak;
+    int32_t backlog;
+    const char *decision = "keep";
+
+    served = GF_ATOMIC_SWAP(queue->served, 0);
+    wait_ns = GF_ATOMIC_SWAP(queue->wait_ns, 0);
+    service_ns = GF_ATOMIC_SWAP(queue->service_ns, 0);
+    if (served) {
+        wait_ns /= served;
+    }
+    /* Workers kept busy on average, rounded up */
+    busy = (service_ns + interval_ns - 1) / interval_ns;
+
+    pthread_mutex_lock(&queue->lock);
+    {
+        old_limit = limit = conf->ac_iot_limit[pri];
+        peak = queue->peak_active;
+        queue->peak_active = GF_ATOMIC_GET(queue->active);
+        backlog = GF_ATOMIC_GET(queue->size);
+
+        /* Nothing served while requests are waiting means they've been
+         * waiting for the whole interval. */
+        if ((wait_ns > target_ns) || (!served && backlog)) {
+            if (limit < conf->max_count) {
+                limit = min(limit + max(limit / 4, 1), conf->max_count);
+                decision = "grow";
+            }
+        } else if ((wait_ns < target_ns / 2) && (peak < limit) &&
+                   (busy < limit - 1)) {
+            limit--;
+            decision = "shrink";
+        }
+        conf->ac_iot_limit[pri] = limit;
+
+        queue->avg_wait_us = wait_ns / 1000;
+        queue->avg_service_us = served ? service_ns / served / 1000 : 0;
+        queue->decision = decision;
+    }
+    pthread_mutex_unlock(&queue->lock);
+
+    if (limit == old_limit) {
+        return;
+    }
+
+    gf_msg_debug(this->name, 0,
+                 "%s priority: %s to %d threads (wait %" PRIu64
+                 "us, service %" PRIu64 "us)",
+                 iot_get_pri_meaning(pri), decision, limit, queue->avg_wait_us,
+                 queue->avg_service_us);
+
+    /* New workers are started right away, instead of waiting for the next
+     * request to be scheduled. */
+    if (limit > old_limit) {
+        pthread_mutex_lock(&conf->mutex);
+        {
+            if (!conf->down) {
+                pthread_cond_broadcast(&conf->cond);
+                __iot_workers_scale(conf);
+            }
+        }
+        pthread_mutex_unlock(&conf->mutex);
+    }
+}
+
+static void *
+iot_adapt(void *arg)
+{
+    xlator_t *this = arg;
+    int i;
+
+    for (;;) {
+        sleep(IOT_ADAPT_INTERVAL);
+        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+        for (i = 0; i < GF_FOP_PRI_LEAST; i++) {
+            iot_adapt_queue(this, i);
+        }
+        pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
+    }
+
+    /* NOTREACHED */
+    return NULL;
+}
+
+static void
+start_iot_adapt(xlator_t *this)
+{
+    iot_conf_t *priv = this->private;
+    int i;
+
+    if (priv->adapt_running) {
+        return;
+    }
+
+    /* Drop what was accounted while the controller was stopped. */
+    for (i = 0; i < GF_FOP_PRI_MAX; i++) {
+        GF_ATOMIC_INIT(priv->queues[i].served, 0);
+        GF_ATOMIC_INIT(priv->queues[i].wait_ns, 0);
+        GF_ATOMIC_INIT(priv->queues[i].service_ns, 0);
+    }
+
+    if (gf_thread_create(&priv->adapt_thread, NULL, iot_adapt, this,
+                         "iotadapt") == 0) {
+        priv->adapt_running = _gf_true;
+    } else {
+        gf_log(this->name, GF_LOG_WARNING, "pthread_create(iot_adapt) failed");
+    }
+}
+
+static void
+stop_iot_adapt(xlator_t *this)
+{
+    iot_conf_t *priv = this->private;
+
+    if (!priv->adapt_running) {
+        return;
+    }
+
+    if (pthread_cancel(priv->adapt_thread) != 0) {
+        gf_log(this->name, GF_LOG_WARNING, "pthread_cancel(iot_adapt) failed");
+    }
+
+    if (pthread_join(priv->adapt_thread, NULL) != 0) {
+        gf_log(this->name, GF_LOG_WARNING, "pthread_join(iot_adapt) failed");
+    }
+
+    priv->adapt_running = _gf_false;
+}
+
 int
 reconfigure(xlator_t *this, dict_t *options)
 {
@@ -1164,12 +1427,23 @@ reconfigure(xlator_t *this, dict_t *options)
 
     GF_OPTION_RECONF("pass-through", this->pass_through, options, bool, out);
 
+    GF_OPTION_RECONF("adaptive-threads", conf->adaptive, options, bool, out);
+
+    GF_OPTION_RECONF("adaptive-target-wait", conf->target_wait, options, int32,
+                     out);
+
     if (conf->watchdog_secs > 0) {
         start_iot_watchdog(this);
     } else {
         stop_iot_watchdog(this);
     }
 
+    if (conf->adaptive) {
+        start_iot_adapt(this);
+    } else {
+        stop_iot_adapt(this);
+    }
+
     ret = 0;
 out:
     return ret;
@@ -1244,13 +1518,22 @@ init(xlator_t *this)
 
     GF_OPTION_INIT("pass-through", this->pass_through, bool, out);
 
+    GF_OPTION_INIT("adaptive-threads", conf->adaptive, bool, out);
+
+    GF_OPTION_INIT("adaptive-target-wait", conf->target_wait, int32, out);
+
     conf->this = this;
     GF_ATOMIC_INIT(conf->stub_cnt, 0);
+    GF_ATOMIC_INIT(conf->sleep_count, 0);
 
     for (i = 0; i < GF_FOP_PRI_MAX; i++) {
-        INIT_LIST_HEAD(&conf->clients[i]);
-        INIT_LIST_HEAD(&conf->no_client[i].clients);
-        INIT_LIST_HEAD(&conf->no_client[i].reqs);
+        pthread_mutex_init(&conf->queues[i].lock, NULL);
+        INIT_LIST_HEAD(&conf->queues[i].clients);
+        INIT_LIST_HEAD(&conf->queues[i].no_client.clients);
+        INIT_LIST_HEAD(&conf->queues[i].no_client.reqs);
+        GF_ATOMIC_INIT(conf->queues[i].size, 0);
+        GF_ATOMIC_INIT(conf->queues[i].active, 0);
+        conf->queues[i].decision = "none";
     }
 
     if (!this->pass_through) {
@@ -1271,6 +1554,10 @@ init(xlator_t *this)
         start_iot_watchdog(this);
     }
 
+    if (conf->adaptive) {
+        start_iot_adapt(this);
+    }
+
     ret = 0;
 out:
     if (ret)
@@ -1345,10 +1632,13 @@ void
 fini(xlator_t *this)
 {
     iot_conf_t *conf = this->private;
+    int i;
 
     if (!conf)
         return;
 
+    stop_iot_adapt(this);
+
     if (conf->mutex_inited && conf->cond_inited)
         iot_exit_threads(conf);
 
@@ -1360,6 +1650,9 @@ fini(xlator_t *this)
 
     stop_iot_watchdog(this);
 
+    for (i = 0; i < GF_FOP_PRI_MAX; i++)
+        pthread_mutex_destroy(&conf->queues[i].lock);
+
     GF_FREE(conf);
 
     this->private = NULL;
@@ -1391,9 +1684,9 @@ iot_disconnect_cbk(xlator_t *this, client_t *client)
         goto out;
     }
 
-    pthread_mutex_lock(&conf->mutex);
     for (i = 0; i < GF_FOP_PRI_MAX; i++) {
-        ctx = &conf->no_client[i];
+        pthread_mutex_lock(&conf->queues[i].lock);
+        ctx = &conf->queues[i].no_client;
         list_for_each_entry_safe(curr, next, &ctx->reqs, list)
         {
             if (curr->frame->root->client != client) {
@@ -1404,8 +1697,8 @@ iot_disconnect_cbk(xlator_t *this, client_t *client)
                    gf_fop_list[curr->fop], curr, client->client_uid);
             curr->poison = _gf_true;
         }
+        pthread_mutex_unlock(&conf->queues[i].lock);
     }
-    pthread_mutex_unlock(&conf->mutex);
 
 out:
     return 0;
@@ -1569,6 +1862,25 @@ struct volume_options options[] = {
      .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC | OPT_FLAG_CLIENT_OPT,
      .tags = {"io-threads"},
      .description = "Enable/Disable io threads translator"},
+    {.key = {"adaptive-threads"},
+     .type = GF_OPTION_TYPE_BOOL,
+     .default_value = "off",
+     .op_version = {GD_OP_VERSION_11_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .tags = {"io-threads"},
+     .description = "Adjust the number of threads of each priority, within "
+                    "thread-count, from the time requests wait in the queues. "
+                    "The prio-threads options give the initial values."},
+    {.key = {"adaptive-target-wait"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 1,
+     .max = 60000,
+     .default_value = "5",
+     .op_version = {GD_OP_VERSION_11_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .tags = {"io-threads"},
+     .description = "Average time, in milliseconds, requests may wait in the "
+                    "queue before adaptive-threads allows more threads."},
     {
         .key = {NULL},
     },
@@ -23,6 +23,7 @@
 #include "iot-mem-types.h"
 #include <semaphore.h>
 #include <glusterfs/statedump.h>
+#include <urcu/arch.h> // CAA_CACHE_LINE_SIZE
 
 struct iot_conf;
 
@@ -36,34 +37,64 @@ struct iot_conf;
 
 #define IOT_THREAD_STACK_SIZE ((size_t)(256 * 1024))
 
+#define IOT_ADAPT_INTERVAL 1 /* In secs */
+
 typedef struct {
     struct list_head clients;
     struct list_head reqs;
 } iot_client_ctx_t;
 
+/*
+ * Requests of one priority, served round-robin across the clients which have
+ * some queued. Each priority has its own lock, so that neither the fops being
+ * scheduled nor the workers picking them up have to go through a lock shared
+ * by all of them.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    struct list_head clients;
+    /*
+     * It turns out that there are several ways a frame can get to us
+     * without having an associated client (server_first_lookup was the
+     * first one I hit).  Instead of trying to update all such callers,
+     * we use this to queue them.
+     */
+    iot_client_ctx_t no_client;
+    gf_atomic_int32_t size;
+    gf_atomic_int32_t active; /* workers running requests of this priority */
+    gf_boolean_t marked;      /* for the watchdog */
+
+    /* Accumulated since the last run of the adaptive controller */
+    gf_atomic_uint64_t wait_ns;    /* time requests spent queued */
+    gf_atomic_uint64_t service_ns; /* time workers spent running them */
+    gf_atomic_uint64_t served;
+    int32_t peak_active; /* most workers running requests at once */
+
+    /* Outcome of the last run of the adaptive controller, for statedumps */
+    uint64_t avg_wait_us;
+    uint64_t avg_service_us;
+    const char *decision;
+
+    /* The conf comes from GF_CALLOC(), so the queues can't be aligned to
+     * cache lines. A whole one between them keeps them apart anyway. */
+    char _pad[CAA_CACHE_LINE_SIZE];
+} iot_queue_t;
+
 struct iot_conf {
+    iot_queue_t queues[GF_FOP_PRI_MAX];
+
+    /* Only used by workers with nothing to do, by the ones waking them up
+     * and to start new ones. */
     pthread_mutex_t mutex;
     pthread_cond_t cond;
 
     int32_t max_count;  /* configured maximum */
     int32_t curr_count; /* actual number of threads running */
-    int32_t sleep_count;
+    gf_atomic_int32_t sleep_count;
 
     int32_t idle_time; /* in seconds */
 
-    struct list_head clients[GF_FOP_PRI_MAX];
-    /*
-     * It turns out that there are several ways a frame can get to us
-     * without having an associated client (server_first_lookup was the
-     * first one I hit).  Instead of trying to update all such callers,
-     * we use this to queue them.
-     */
-    iot_client_ctx_t no_client[GF_FOP_PRI_MAX];
-
     int32_t ac_iot_limit[GF_FOP_PRI_MAX];
-    int32_t ac_iot_count[GF_FOP_PRI_MAX];
-    int queue_sizes[GF_FOP_PRI_MAX];
-    int32_t queue_size;
     gf_atomic_t stub_cnt;
     pthread_attr_t w_attr;
     gf_boolean_t least_priority; /*Enable/Disable least-priority */
@@ -77,8 +108,12 @@ struct iot_conf {
     int32_t watchdog_secs;
     gf_boolean_t watchdog_running;
     pthread_t watchdog_thread;
-    gf_boolean_t queue_marked[GF_FOP_PRI_MAX];
     gf_boolean_t cleanup_disconnected_reqs;
+
+    gf_boolean_t adaptive;   /* size the pool from the measured latency */
+    int32_t target_wait;     /* in msecs */
+    gf_boolean_t adapt_running;
+    pthread_t adapt_thread;
 };
 
 typedef struct iot_conf iot_conf_t;
@@ -3404,28 +3404,18 @@ mdc_inval_xatt(dict_t *d, char *k, data_t *v, void *tmp)
 }
 
 static int
-mdc_invalidate(xlator_t *this, void *data)
+mdc_invalidate_one(xlator_t *this, inode_table_t *itable, uuid_t gfid,
+                   struct gf_upcall_cache_invalidation *up_ci)
 {
-    struct gf_upcall *up_data = NULL;
-    struct gf_upcall_cache_invalidation *up_ci = NULL;
     inode_t *inode = NULL;
     int ret = 0;
     struct set tmp = {
         0,
     };
-    inode_table_t *itable = NULL;
     struct mdc_conf *conf = this->private;
     uint64_t gen = 0;
 
-    up_data = (struct gf_upcall *)data;
-
-    if (up_data->event_type != GF_UPCALL_CACHE_INVALIDATION)
-        goto out;
-
-    up_ci = (struct gf_upcall_cache_invalidation *)up_data->data;
-
-    itable = ((xlator_t *)this->graph->top)->itable;
-    inode = inode_find(itable, up_data->gfid);
+    inode = inode_find(itable, gfid);
     if (!inode) {
         ret = -1;
         goto out;
@@ -3485,6 +3475,38 @@ out:
     return ret;
 }
 
+static int
+mdc_invalidate(xlator_t *this, void *data)
+{
+    struct gf_upcall *up_data = NULL;
+    struct gf_upcall_cache_invalidation_batch *batch = NULL;
+    inode_table_t *itable = NULL;
+    uint32_t i = 0;
+    int ret = 0;
+
+    up_data = (struct gf_upcall *)data;
+    itable = ((xlator_t *)this->graph->top)->itable;
+
+    switch (up_data->event_type) {
+        case GF_UPCALL_CACHE_INVALIDATION:
+            ret = mdc_invalidate_one(this, itable, up_data->gfid,
+                                     up_data->data);
+            break;
+        case GF_UPCALL_CACHE_INVALIDATION_BATCH:
+            batch = up_data->data;
+            for (i = 0; i < batch->count; i++) {
+                if (mdc_invalidate_one(this, itable, batch->entries[i].gfid,
+                                       batch->entries[i].data) < 0)
+                    ret = -1;
+            }
+            break;
+        default:
+            break;
+    }
+
+    return ret;
+}
+
 struct mdc_ipc {
     xlator_t *this;
     dict_t *xattr;
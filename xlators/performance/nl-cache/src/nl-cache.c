@@ -441,10 +441,9 @@ do_fop:
 }
 
 static int32_t
-nlc_invalidate(xlator_t *this, void *data)
+nlc_invalidate_one(xlator_t *this, uuid_t gfid,
+                   struct gf_upcall_cache_invalidation *up_ci)
 {
-    struct gf_upcall *up_data = NULL;
-    struct gf_upcall_cache_invalidation *up_ci = NULL;
     inode_t *inode = NULL;
     inode_t *parent1 = NULL;
     inode_t *parent2 = NULL;
@@ -452,22 +451,13 @@ nlc_invalidate(xlator_t *this, void *data)
     inode_table_t *itable = NULL;
     nlc_conf_t *conf = NULL;
 
-    up_data = (struct gf_upcall *)data;
-
-    if (up_data->event_type != GF_UPCALL_CACHE_INVALIDATION)
-        goto out;
-
     conf = this->private;
-    if (!conf)
-        goto out;
-
-    up_ci = (struct gf_upcall_cache_invalidation *)up_data->data;
 
     /*TODO: Add he inodes found as a member in gf_upcall_cache_invalidation
      * so that it prevents subsequent xlators from doing inode_find again
      */
     itable = ((xlator_t *)this->graph->top)->itable;
-    inode = inode_find(itable, up_data->gfid);
+    inode = inode_find(itable, gfid);
     if (!inode) {
         ret = -1;
         goto out;
@@ -516,6 +506,39 @@ out:
     return ret;
 }
 
+static int32_t
+nlc_invalidate(xlator_t *this, void *data)
+{
+    struct gf_upcall *up_data = NULL;
+    struct gf_upcall_cache_invalidation_batch *batch = NULL;
+    uint32_t i = 0;
+    int ret = 0;
+
+    up_data = (struct gf_upcall *)data;
+
+    if (!this->private)
+        goto out;
+
+    switch (up_data->event_type) {
+        case GF_UPCALL_CACHE_INVALIDATION:
+            ret = nlc_invalidate_one(this, up_data->gfid, up_data->data);
+            break;
+        case GF_UPCALL_CACHE_INVALIDATION_BATCH:
+            batch = up_data->data;
+            for (i = 0; i < batch->count; i++) {
+                if (nlc_invalidate_one(this, batch->entries[i].gfid,
+                                       batch->entries[i].data) < 0)
+                    ret = -1;
+            }
+            break;
+        default:
+            break;
+    }
+
+out:
+    return ret;
+}
+
 int
 nlc_notify(xlator_t *this, int event, void *data, ...)
 {
@@ -1454,27 +1454,20 @@ qr_update_child_down_time(xlator_t *this, time_t now)
 }
 
 static int
-qr_invalidate(xlator_t *this, void *data)
+qr_invalidate_one(xlator_t *this, uuid_t gfid,
+                  struct gf_upcall_cache_invalidation *up_ci)
 {
-    struct gf_upcall *up_data = NULL;
-    struct gf_upcall_cache_invalidation *up_ci = NULL;
     inode_t *inode = NULL;
     int ret = 0;
     inode_table_t *itable = NULL;
     qr_private_t *priv = NULL;
 
-    up_data = (struct gf_upcall *)data;
-
-    if (up_data->event_type != GF_UPCALL_CACHE_INVALIDATION)
-        goto out;
-
     priv = this->private;
-    up_ci = (struct gf_upcall_cache_invalidation *)up_data->data;
 
     if (up_ci && (up_ci->flags & UP_WRITE_FLAGS)) {
         GF_ATOMIC_INC(priv->qr_counter.file_data_invals);
         itable = ((xlator_t *)this->graph->top)->itable;
-        inode = inode_find(itable, up_data->gfid);
+        inode = inode_find(itable, gfid);
         if (!inode) {
             ret = -1;
             goto out;
@@ -1489,6 +1482,35 @@ out:
     return ret;
 }
 
+static int
+qr_invalidate(xlator_t *this, void *data)
+{
+    struct gf_upcall *up_data = NULL;
+    struct gf_upcall_cache_invalidation_batch *batch = NULL;
+    uint32_t i = 0;
+    int ret = 0;
+
+    up_data = (struct gf_upcall *)data;
+
+    switch (up_data->event_type) {
+        case GF_UPCALL_CACHE_INVALIDATION:
+            ret = qr_invalidate_one(this, up_data->gfid, up_data->data);
+            break;
+        case GF_UPCALL_CACHE_INVALIDATION_BATCH:
+            batch = up_data->data;
+            for (i = 0; i < batch->count; i++) {
+                if (qr_invalidate_one(this, batch->entries[i].gfid,
+                                      batch->entries[i].data) < 0)
+                    ret = -1;
+            }
+            break;
+        default:
+            break;
+    }
+
+    return ret;
+}
+
 int
 qr_notify(xlator_t *this, int event, void *data, ...)
 {
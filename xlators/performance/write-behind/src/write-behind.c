@@ -19,6 +19,7 @@
 #include <glusterfs/call-stub.h>
 #include <glusterfs/statedump.h>
 #include <glusterfs/defaults.h>
+#include <glusterfs/interval-tree.h>
 #include "write-behind-mem-types.h"
 #include "write-behind-messages.h"
 
@@ -83,6 +84,12 @@ typedef struct wb_inode {
                                writes are in progress at the same time. Modules
                                like eager-lock in AFR depend on this behavior.
                             */
+    gf_interval_tree_t liability_tree; /* @liability and @wip indexed by */
+    gf_interval_tree_t wip_tree;       /* the range of each request, so
+                                          that conflicts are found without
+                                          walking the lists. */
+    int liability_appends;             /* appends in @liability, which
+                                          conflict with everything */
     list_head_t invalidate_list; /* list of wb_inodes that were marked for
                                   * iatt invalidation due to requests in
                                   * liability queue fulfilled while there
@@ -111,6 +118,11 @@ typedef struct wb_inode {
                                     liability generation higher than itself)
                                  */
     size_t size; /* Size of the file to catch write after EOF. */
+    struct iatt postbuf;        /* Last iatt returned by a write or a
+                                   truncate, given to the reads served
+                                   from the pending writes. */
+    gf_boolean_t postbuf_valid; /* Cleared when any other fop that can
+                                   change the iatt is queued. */
     gf_lock_t lock;
     xlator_t *this;
     inode_t *inode;
@@ -134,6 +146,11 @@ typedef struct wb_request {
     list_head_t unwinds;
     list_head_t wip;
 
+    gf_interval_node_t lie_node; /* in @liability_tree */
+    gf_interval_node_t wip_node; /* in @wip_tree */
+    uint64_t lie_gen;            /* inode generation when it was added
+                                    to @liability, i.e. its position there */
+
     call_stub_t *stub;
 
     ssize_t write_size; /* currently held size
@@ -192,6 +209,25 @@ typedef struct wb_conf {
     gf_boolean_t resync_after_fsync;
 } wb_conf_t;
 
+typedef struct wb_read_extent {
+    size_t start; /* relative to the offset of the read */
+    size_t end;
+    size_t tail; /* where the data collapsed from later writes starts,
+                    @end if there is none */
+} wb_read_extent_t;
+
+typedef struct wb_read_local {
+    struct iobuf *iobuf; /* data of the pending writes, at the same
+                            place as in the read */
+    off_t offset;
+    size_t size; /* end of the data held in the read, or of the read if a
+                    write held past it makes the file that long */
+    struct iatt postbuf;
+    gf_boolean_t postbuf_valid;
+    int count;
+    wb_read_extent_t extents[]; /* in the order the writes arrived */
+} wb_read_local_t;
+
 wb_inode_t *
 __wb_inode_ctx_get(xlator_t *this, inode_t *inode)
 {
@@ -342,42 +378,139 @@ wb_requests_conflict(wb_request_t *lie, wb_request_t *req)
     return wb_requests_overlap(lie, req);
 }
 
+static void
+wb_request_range(wb_request_t *req, uint64_t *start, uint64_t *last)
+{
+    *start = req->ordering.off;
+    if (req->ordering.size)
+        *last = *start + req->ordering.size - 1;
+    else
+        *last = ULLONG_MAX;
+}
+
+static void
+__wb_liability_add(wb_inode_t *wb_inode, wb_request_t *req)
+{
+    uint64_t start = 0;
+    uint64_t last = 0;
+
+    list_add_tail(&req->lie, &wb_inode->liability);
+    req->lie_gen = wb_inode->gen;
+
+    if (req->ordering.append)
+        wb_inode->liability_appends++;
+
+    wb_request_range(req, &start, &last);
+    gf_interval_tree_insert(&wb_inode->liability_tree, &req->lie_node, start,
+                            last);
+}
+
+/* takes @req off @liability or @temptation */
+static void
+__wb_lie_del(wb_request_t *req)
+{
+    wb_inode_t *wb_inode = req->wb_inode;
+
+    if (gf_interval_node_linked(&req->lie_node)) {
+        gf_interval_tree_remove(&wb_inode->liability_tree, &req->lie_node);
+
+        if (req->ordering.append)
+            wb_inode->liability_appends--;
+    }
+
+    list_del_init(&req->lie);
+}
+
+static void
+__wb_wip_add(wb_inode_t *wb_inode, wb_request_t *req)
+{
+    uint64_t start = 0;
+    uint64_t last = 0;
+
+    list_add_tail(&req->wip, &wb_inode->wip);
+
+    wb_request_range(req, &start, &last);
+    gf_interval_tree_insert(&wb_inode->wip_tree, &req->wip_node, start, last);
+}
+
+static void
+__wb_wip_del(wb_request_t *req)
+{
+    if (gf_interval_node_linked(&req->wip_node))
+        gf_interval_tree_remove(&req->wb_inode->wip_tree, &req->wip_node);
+
+    list_del_init(&req->wip);
+}
+
 wb_request_t *
 wb_liability_has_conflict(wb_inode_t *wb_inode, wb_request_t *req)
 {
     wb_request_t *each = NULL;
+    wb_request_t *conflict = NULL;
+    gf_interval_node_t *node = NULL;
+    wb_conf_t *conf = NULL;
+    uint64_t start = 0;
+    uint64_t last = 0;
+
+    conf = wb_inode->this->private;
+
+    if (conf->strict_write_ordering || wb_inode->liability_appends) {
+        /* every older liability conflicts, not just the overlapping
+           ones */
+        list_for_each_entry(each, &wb_inode->liability, lie)
+        {
+            if (wb_requests_conflict(each, req) &&
+                (!each->ordering.fulfilled))
+                /* A fulfilled request shouldn't block another
+                 * request (even a dependent one) from winding.
+                 */
+                return each;
+        }
 
-    list_for_each_entry(each, &wb_inode->liability, lie)
+        return NULL;
+    }
+
+    /* The first conflict in @liability is the one which matters, see
+       __wb_handle_failed_conflict(). */
+    wb_request_range(req, &start, &last);
+    gf_interval_tree_for_each(node, &wb_inode->liability_tree, start, last)
     {
-        if (wb_requests_conflict(each, req) && (!each->ordering.fulfilled))
-            /* A fulfilled request shouldn't block another
-             * request (even a dependent one) from winding.
-             */
-            return each;
+        each = gf_interval_tree_entry(node, wb_request_t, lie_node);
+
+        if (!wb_requests_conflict(each, req) || each->ordering.fulfilled)
+            continue;
+
+        if (!conflict || (each->lie_gen < conflict->lie_gen))
+            conflict = each;
     }
 
-    return NULL;
+    return conflict;
 }
 
 wb_request_t *
 wb_wip_has_conflict(wb_inode_t *wb_inode, wb_request_t *req)
 {
     wb_request_t *each = NULL;
+    gf_interval_node_t *node = NULL;
+    uint64_t start = 0;
+    uint64_t last = 0;
 
     if (req->stub->fop != GF_FOP_WRITE)
         /* non-writes fundamentally never conflict with WIP requests */
         return NULL;
 
-    list_for_each_entry(each, &wb_inode->wip, wip)
+    wb_request_range(req, &start, &last);
+    gf_interval_tree_for_each(node, &wb_inode->wip_tree, start, last)
     {
+        each = gf_interval_tree_entry(node, wb_request_t, wip_node);
+
         if (each == req)
             /* request never conflicts with itself,
                though this condition should never occur.
             */
             continue;
 
-        if (wb_requests_overlap(each, req))
-            return each;
+        return each;
     }
 
     return NULL;
@@ -419,8 +552,8 @@ __wb_request_unref(wb_request_t *req)
                          req->unique, gf_fop_list[req->fop], gfid, req->gen);
 
         list_del_init(&req->todo);
-        list_del_init(&req->lie);
-        list_del_init(&req->wip);
+        __wb_lie_del(req);
+        __wb_wip_del(req);
 
         list_del_init(&req->all);
         if (list_empty(&wb_inode->all)) {
@@ -525,6 +658,8 @@ wb_enqueue_common(wb_inode_t *wb_inode, call_stub_t *stub, int tempted)
     INIT_LIST_HEAD(&req->winds);
     INIT_LIST_HEAD(&req->unwinds);
     INIT_LIST_HEAD(&req->wip);
+    gf_interval_node_init(&req->lie_node);
+    gf_interval_node_init(&req->wip_node);
 
     req->stub = stub;
     req->wb_inode = wb_inode;
@@ -620,6 +755,19 @@ wb_enqueue_common(wb_inode_t *wb_inode, call_stub_t *stub, int tempted)
 
     LOCK(&wb_inode->lock);
     {
+        switch (stub->fop) {
+            case GF_FOP_WRITE:
+            case GF_FOP_READ:
+            case GF_FOP_STAT:
+            case GF_FOP_FSTAT:
+            case GF_FOP_FLUSH:
+            case GF_FOP_FSYNC:
+                break;
+            default:
+                wb_inode->postbuf_valid = _gf_false;
+                break;
+        }
+
         list_add_tail(&req->all, &wb_inode->all);
 
         req->gen = wb_inode->gen;
@@ -674,6 +822,8 @@ __wb_inode_create(xlator_t *this, inode_t *inode)
     INIT_LIST_HEAD(&wb_inode->temptation);
     INIT_LIST_HEAD(&wb_inode->wip);
     INIT_LIST_HEAD(&wb_inode->invalidate_list);
+    gf_interval_tree_init(&wb_inode->liability_tree);
+    gf_interval_tree_init(&wb_inode->wip_tree);
 
     wb_inode->this = this;
 
@@ -759,14 +909,14 @@ __wb_fulfill_request(wb_request_t *req)
            2. If no, request is in temptation queue and hence should be
               left in the queue so that wb_pick_unwinds picks it up
         */
-        list_del_init(&req->lie);
+        __wb_lie_del(req);
     } else {
         /* TODO: fail the req->frame with error if
            necessary
         */
     }
 
-    list_del_init(&req->wip);
+    __wb_wip_del(req);
     __wb_request_unref(req);
 }
 
@@ -809,7 +959,7 @@ __wb_add_request_for_retry(wb_request_t *req)
 
     list_del_init(&req->winds);
     list_del_init(&req->todo);
-    list_del_init(&req->wip);
+    __wb_wip_del(req);
 
     /* sanitize ordering flags to retry */
     req->ordering.go = 0;
@@ -1060,6 +1210,20 @@ out:
     return;
 }
 
+static void
+wb_set_postbuf(wb_inode_t *wb_inode, struct iatt *postbuf)
+{
+    if (!postbuf)
+        return;
+
+    LOCK(&wb_inode->lock);
+    {
+        wb_inode->postbuf = *postbuf;
+        wb_inode->postbuf_valid = _gf_true;
+    }
+    UNLOCK(&wb_inode->lock);
+}
+
 int
 wb_fulfill_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
                int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
@@ -1097,6 +1261,9 @@ wb_fulfill_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
      * </comment> */
     wb_set_invalidate(wb_inode);
 
+    if (op_ret >= 0)
+        wb_set_postbuf(wb_inode, postbuf);
+
     if (op_ret == -1) {
         wb_fulfill_err(head, op_errno);
     } else if (op_ret < head->total_size) {
@@ -1287,7 +1454,7 @@ __wb_pick_unwinds(wb_inode_t *wb_inode, list_head_t *lies)
 
         if (!req->ordering.fulfilled) {
             /* burden increased */
-            list_add_tail(&req->lie, &wb_inode->liability);
+            __wb_liability_add(wb_inode, req);
 
             req->ordering.lied = 1;
 
@@ -1317,6 +1484,8 @@ __wb_collapse_small_writes(wb_conf_t *conf, wb_request_t *holder,
     ssize_t required_size = 0;
     size_t holder_len = 0;
     size_t req_len = 0;
+    uint64_t start = 0;
+    uint64_t last = 0;
 
     if (!holder->iobref) {
         holder_len = iov_length(holder->stub->args.vector,
@@ -1366,6 +1535,15 @@ __wb_collapse_small_writes(wb_conf_t *conf, wb_request_t *holder,
     holder->write_size += req->write_size;
     holder->ordering.size += req->write_size;
 
+    if (gf_interval_node_linked(&holder->lie_node)) {
+        /* lied already, its range in @liability grows */
+        gf_interval_tree_remove(&holder->wb_inode->liability_tree,
+                                &holder->lie_node);
+        wb_request_range(holder, &start, &last);
+        gf_interval_tree_insert(&holder->wb_inode->liability_tree,
+                                &holder->lie_node, start, last);
+    }
+
     ret = 0;
 out:
     return ret;
@@ -1700,7 +1878,7 @@ __wb_pick_winds(wb_inode_t *wb_inode, list_head_t *tasks,
                 continue;
             }
 
-            list_add_tail(&req->wip, &wb_inode->wip);
+            __wb_wip_add(wb_inode, req);
             req->wind_count++;
 
             if (!req->ordering.tempted)
@@ -1800,6 +1978,8 @@ wb_set_inode_size(wb_inode_t *wb_inode, struct iatt *postbuf)
     LOCK(&wb_inode->lock);
     {
         wb_inode->size = postbuf->ia_size;
+        wb_inode->postbuf = *postbuf;
+        wb_inode->postbuf_valid = _gf_true;
     }
     UNLOCK(&wb_inode->lock);
 }
@@ -1818,12 +1998,15 @@ wb_writev_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
 
     LOCK(&req->wb_inode->lock);
     {
-        list_del_init(&req->wip);
+        __wb_wip_del(req);
     }
     UNLOCK(&req->wb_inode->lock);
 
     wb_request_unref(req);
 
+    if (op_ret >= 0)
+        wb_set_postbuf(wb_inode, postbuf);
+
     /* requests could be pending while this was in progress */
     wb_process_queue(wb_inode);
 
@@ -1907,6 +2090,310 @@ unwind:
     return 0;
 }
 
+/*
+  Read-your-writes: a read overlapping writes which are still held here
+  doesn't have to wait for them to be synced. If the held data covers the
+  whole read, the read is answered from it. Otherwise the read is wound
+  right away and the held data is merged over what the server returns.
+*/
+
+static gf_boolean_t
+__wb_request_is_pending_write(wb_request_t *req)
+{
+    if (req->fop != GF_FOP_WRITE)
+        return _gf_false;
+
+    if (req->ordering.tempted)
+        /* lied or not, the data is ours until the server acks it */
+        return !req->ordering.fulfilled;
+
+    return !list_empty(&req->todo) || !list_empty(&req->wip);
+}
+
+static void
+wb_read_local_free(wb_read_local_t *local)
+{
+    if (local->iobuf)
+        iobuf_unref(local->iobuf);
+
+    GF_FREE(local);
+}
+
+static wb_read_local_t *
+wb_read_pending(xlator_t *this, wb_inode_t *wb_inode, size_t size,
+                off_t offset)
+{
+    wb_read_local_t *local = NULL;
+    wb_read_extent_t *extent = NULL;
+    wb_request_t *req = NULL;
+    struct iovec iov = {
+        0,
+    };
+    uint64_t start = offset;
+    uint64_t end = offset + size;
+    uint64_t req_start = 0;
+    uint64_t req_end = 0;
+    uint64_t eof = 0;
+    gf_boolean_t ordered = _gf_false;
+    int count = 0;
+    int i = 0;
+    int j = 0;
+
+    if (size == 0)
+        return NULL;
+
+    LOCK(&wb_inode->lock);
+    {
+        list_for_each_entry(req, &wb_inode->all, all)
+        {
+            if (req->fop == GF_FOP_READ)
+                continue;
+
+            if (req->fop != GF_FOP_WRITE) {
+                /* a truncate and the like still queued, the read has
+                   to be ordered against it */
+                if (!list_empty(&req->todo))
+                    goto unlock;
+                continue;
+            }
+
+            if (!__wb_request_is_pending_write(req))
+                continue;
+
+            /* sync writes are not ordered against the collapsing of
+               the non-sync ones, appends don't know their offset yet
+               and failed writes must fail the read as well */
+            if (!req->ordering.tempted || req->ordering.append ||
+                req->op_ret == -1)
+                goto unlock;
+
+            req_start = req->stub->args.offset;
+            req_end = req_start + req->write_size;
+            if ((req_start < end) && (start < req_end))
+                count++;
+            if (eof < req_end)
+                eof = req_end;
+        }
+
+        if (count == 0)
+            goto unlock;
+
+        local = GF_CALLOC(1, sizeof(*local) + count * sizeof(*extent),
+                          gf_wb_mt_wb_read_local_t);
+        if (!local)
+            goto unlock;
+
+        local->iobuf = iobuf_get2(this->ctx->iobuf_pool, size);
+        if (!local->iobuf)
+            goto unlock;
+
+        local->offset = offset;
+        local->postbuf = wb_inode->postbuf;
+        local->postbuf_valid = wb_inode->postbuf_valid;
+        iov.iov_base = local->iobuf->ptr;
+        iov.iov_len = size;
+
+        list_for_each_entry(req, &wb_inode->all, all)
+        {
+            if (!__wb_request_is_pending_write(req))
+                continue;
+
+            req_start = req->stub->args.offset;
+            req_end = req_start + req->write_size;
+            if ((req_start >= end) || (start >= req_end))
+                continue;
+
+            extent = &local->extents[local->count++];
+            extent->start = max(req_start, start) - start;
+            extent->end = min(req_end, end) - start;
+            extent->tail = extent->end;
+            if (req->write_size != req->orig_size)
+                extent->tail = min(max(req_start + req->orig_size, start),
+                                   end) -
+                               start;
+
+            iov_range_copy(&iov, 1, extent->start, req->stub->args.vector,
+                           req->stub->args.count,
+                           start + extent->start - req_start,
+                           extent->end - extent->start);
+
+            if (local->size < extent->end)
+                local->size = extent->end;
+        }
+
+        /* the file is at least as long as the last write held, even if
+           the server doesn't know yet */
+        if (local->size < min(eof, end) - start)
+            local->size = min(eof, end) - start;
+
+        ordered = _gf_true;
+    }
+unlock:
+    UNLOCK(&wb_inode->lock);
+
+    if (!ordered)
+        goto out;
+
+    /* The data collapsed into a write is newer than the writes which
+       arrived after it, so applying the writes in order of arrival is
+       only right if none of those overlaps it. */
+    for (i = 0; i < local->count; i++) {
+        extent = &local->extents[i];
+        for (j = i + 1; j < local->count; j++) {
+            if ((extent->tail < local->extents[j].end) &&
+                (local->extents[j].start < extent->end)) {
+                ordered = _gf_false;
+                goto out;
+            }
+        }
+    }
+
+out:
+    if (!ordered && local) {
+        wb_read_local_free(local);
+        local = NULL;
+    }
+
+    return local;
+}
+
+static gf_boolean_t
+wb_read_is_covered(wb_read_local_t *local, size_t size)
+{
+    size_t covered = 0;
+    size_t next = 0;
+    int i = 0;
+
+    while (covered < size) {
+        next = covered;
+        for (i = 0; i < local->count; i++) {
+            if ((local->extents[i].start <= covered) &&
+                (local->extents[i].end > next))
+                next = local->extents[i].end;
+        }
+
+        if (next == covered)
+            return _gf_false;
+
+        covered = next;
+    }
+
+    return _gf_true;
+}
+
+static void
+wb_readv_pending(call_frame_t *frame, wb_read_local_t *local, size_t size)
+{
+    struct iobref *iobref = NULL;
+    struct iovec iov = {
+        0,
+    };
+    struct iatt buf = {
+        0,
+    };
+
+    iobref = iobref_new();
+    if (!iobref || iobref_add(iobref, local->iobuf)) {
+        STACK_UNWIND_STRICT(readv, frame, -1, ENOMEM, NULL, 0, NULL, NULL,
+                            NULL);
+        goto out;
+    }
+
+    iov.iov_base = local->iobuf->ptr;
+    iov.iov_len = size;
+
+    /* the times are the ones of the last write that reached the server,
+       so that caches above don't take the read for a change of the file */
+    buf = local->postbuf;
+    if (buf.ia_size < local->offset + size)
+        buf.ia_size = local->offset + size;
+
+    STACK_UNWIND_STRICT(readv, frame, size, 0, &iov, 1, &buf, iobref, NULL);
+
+out:
+    if (iobref)
+        iobref_unref(iobref);
+
+    wb_read_local_free(local);
+}
+
+int
+wb_readv_merge_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                   int32_t op_ret, int32_t op_errno, struct iovec *vector,
+                   int32_t count, struct iatt *stbuf, struct iobref *iobref,
+                   dict_t *xdata)
+{
+    wb_read_local_t *local = NULL;
+    wb_read_extent_t *extent = NULL;
+    struct iobuf *iobuf = NULL;
+    struct iobref *merged = NULL;
+    struct iovec iov = {
+        0,
+    };
+    struct iatt buf = {
+        0,
+    };
+    size_t size = 0;
+    int i = 0;
+
+    local = frame->local;
+    frame->local = NULL;
+
+    if (op_ret < 0)
+        goto unwind;
+
+    /* the held data, or a write held past the read, may well be beyond
+       the end of the file on the server, with a hole up to it */
+    size = max((size_t)op_ret, local->size);
+
+    iobuf = iobuf_get2(this->ctx->iobuf_pool, size);
+    merged = iobref_new();
+    if (!iobuf || !merged || iobref_add(merged, iobuf)) {
+        op_ret = -1;
+        op_errno = ENOMEM;
+        goto unwind;
+    }
+
+    iov.iov_base = iobuf->ptr;
+    iov.iov_len = size;
+
+    iov_range_copy(&iov, 1, 0, vector, count, 0, op_ret);
+    if (size > (size_t)op_ret)
+        memset(iobuf->ptr + op_ret, 0, size - op_ret);
+
+    for (i = 0; i < local->count; i++) {
+        extent = &local->extents[i];
+        memcpy(iobuf->ptr + extent->start, local->iobuf->ptr + extent->start,
+               extent->end - extent->start);
+    }
+
+    if (stbuf) {
+        buf = *stbuf;
+        if (buf.ia_size < local->offset + size)
+            buf.ia_size = local->offset + size;
+        stbuf = &buf;
+    }
+
+    op_ret = size;
+    vector = &iov;
+    count = 1;
+    iobref = merged;
+
+unwind:
+    STACK_UNWIND_STRICT(readv, frame, op_ret, op_errno, vector, count, stbuf,
+                        iobref, xdata);
+
+    if (iobuf)
+        iobuf_unref(iobuf);
+
+    if (merged)
+        iobref_unref(merged);
+
+    wb_read_local_free(local);
+
+    return 0;
+}
+
 int
 wb_readv_helper(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
                 off_t offset, uint32_t flags, dict_t *xdata)
@@ -1921,12 +2408,35 @@ wb_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
          off_t offset, uint32_t flags, dict_t *xdata)
 {
     wb_inode_t *wb_inode = NULL;
+    wb_read_local_t *local = NULL;
     call_stub_t *stub = NULL;
 
     wb_inode = wb_inode_ctx_get(this, fd->inode);
     if (!wb_inode)
         goto noqueue;
 
+    local = wb_read_pending(this, wb_inode, size, offset);
+    if (local) {
+        if (local->postbuf_valid && wb_read_is_covered(local, size)) {
+            gf_msg_debug(this->name, 0,
+                         "read of %zu bytes at %" PRId64
+                         " served from pending writes",
+                         size, offset);
+            wb_readv_pending(frame, local, size);
+            return 0;
+        }
+
+        gf_msg_debug(this->name, 0,
+                     "read of %zu bytes at %" PRId64
+                     " merged with pending writes",
+                     size, offset);
+        frame->local = local;
+        STACK_WIND(frame, wb_readv_merge_cbk, FIRST_CHILD(this),
+                   FIRST_CHILD(this)->fops->readv, fd, size, offset, flags,
+                   xdata);
+        return 0;
+    }
+
     stub = fop_readv_stub(frame, wb_readv_helper, fd, size, offset, flags,
                           xdata);
     if (!stub)
@@ -140,6 +140,59 @@ out:
     return 0;
 }
 
+static int
+client_cbk_cache_invalidation_batch(struct rpc_clnt *rpc, void *mydata,
+                                    void *data)
+{
+    int ret = -1;
+    uint32_t i = 0;
+    struct iovec *iov = NULL;
+    struct gf_upcall upcall_data = {
+        0,
+    };
+    struct gf_upcall_cache_invalidation_batch batch = {
+        0,
+    };
+    gfs4_cbk_cache_invalidation_batch_req batch_req = {
+        {0},
+    };
+
+    if (!data)
+        goto out;
+
+    iov = (struct iovec *)data;
+    ret = xdr_to_generic(*iov, &batch_req,
+                         (xdrproc_t)xdr_gfs4_cbk_cache_invalidation_batch_req);
+
+    if (ret < 0) {
+        gf_smsg(THIS->name, GF_LOG_WARNING, -ret,
+                PC_MSG_CACHE_INVALIDATION_FAIL, NULL);
+        goto out;
+    }
+
+    upcall_data.data = &batch;
+    ret = gf_proto_cache_invalidation_batch_to_upcall(THIS, &batch_req,
+                                                      &upcall_data);
+    if (ret < 0)
+        goto out;
+
+    gf_msg_trace(THIS->name, 0, "%u cache invalidations received",
+                 batch.count);
+
+    default_notify(THIS, GF_EVENT_UPCALL, &upcall_data);
+
+out:
+    if (batch_req.entries.entries_val) {
+        for (i = 0; i < batch_req.entries.entries_len; i++)
+            free(batch_req.entries.entries_val[i].xdata.xdata_val);
+        free(batch_req.entries.entries_val);
+    }
+
+    gf_upcall_cache_invalidation_batch_cleanup(&batch);
+
+    return 0;
+}
+
 static int
 client_cbk_child_up(struct rpc_clnt *rpc, void *mydata, void *data)
 {
@@ -301,6 +354,9 @@ static rpcclnt_cb_actor_t gluster_cbk_actors[GF_CBK_MAXVALUE] = {
     [GF_CBK_ENTRYLK_CONTENTION] = {"ENTRYLK_CONTENTION",
                                    client_cbk_entrylk_contention,
                                    GF_CBK_ENTRYLK_CONTENTION},
+    [GF_CBK_CACHE_INVALIDATION_BATCH] = {"CACHE_INVALIDATION_BATCH",
+                                         client_cbk_cache_invalidation_batch,
+                                         GF_CBK_CACHE_INVALIDATION_BATCH},
 };
 
 struct rpcclnt_cb_program gluster_cbk_prog = {
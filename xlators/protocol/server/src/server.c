@@ -599,7 +599,7 @@ glusterfs_ctx_pool_destroy(glusterfs_ctx_t *ctx)
             mem_pool_destroy(pool->frame_mem_pool);
         if (pool->stack_mem_pool)
             mem_pool_destroy(pool->stack_mem_pool);
-        LOCK_DESTROY(&pool->lock);
+        call_pool_fini(pool);
         GF_FREE(pool);
     }
 
@@ -1382,6 +1382,41 @@ server_fini(xlator_t *this)
     return;
 }
 
+/* Clients older than 11.0 don't know about batches, each invalidation is sent
+ * to them on its own. */
+static int
+server_submit_cache_invalidations(xlator_t *this, server_conf_t *conf,
+                                  rpc_transport_t *xprt,
+                                  struct gf_upcall *upcall_data)
+{
+    struct gf_upcall_cache_invalidation_batch *batch = NULL;
+    gfs3_cbk_cache_invalidation_req gf_c_req = {
+        0,
+    };
+    uint32_t i = 0;
+    int ret = 0;
+
+    batch = upcall_data->data;
+
+    for (i = 0; i < batch->count; i++) {
+        ret = gf_proto_cache_invalidation_from_upcall(this, &gf_c_req,
+                                                      &batch->entries[i]);
+        if (ret == 0)
+            ret = rpcsvc_request_submit(
+                conf->rpc, xprt, &server_cbk_prog, GF_CBK_CACHE_INVALIDATION,
+                &gf_c_req, this->ctx,
+                (xdrproc_t)xdr_gfs3_cbk_cache_invalidation_req);
+
+        GF_FREE((gf_c_req.xdata).xdata_val);
+        memset(&gf_c_req, 0, sizeof(gf_c_req));
+
+        if (ret < 0)
+            break;
+    }
+
+    return ret;
+}
+
 int
 server_process_event_upcall(xlator_t *this, void *data)
 {
@@ -1396,6 +1431,9 @@ server_process_event_upcall(xlator_t *this, void *data)
     gfs3_cbk_cache_invalidation_req gf_c_req = {
         0,
     };
+    gfs4_cbk_cache_invalidation_batch_req gf_c_batch = {
+        {0},
+    };
     gfs3_recall_lease_req gf_recall_lease = {
         {
             0,
@@ -1467,6 +1505,16 @@ server_process_event_upcall(xlator_t *this, void *data)
             cbk_procnum = GF_CBK_ENTRYLK_CONTENTION;
             xdrproc = (xdrproc_t)xdr_gfs4_entrylk_contention_req;
             break;
+        case GF_UPCALL_CACHE_INVALIDATION_BATCH:
+            ret = gf_proto_cache_invalidation_batch_from_upcall(
+                this, &gf_c_batch, upcall_data);
+            if (ret < 0)
+                goto out;
+
+            up_req = &gf_c_batch;
+            cbk_procnum = GF_CBK_CACHE_INVALIDATION_BATCH;
+            xdrproc = (xdrproc_t)xdr_gfs4_cbk_cache_invalidation_batch_req;
+            break;
         default:
             gf_smsg(this->name, GF_LOG_WARNING, EINVAL,
                     PS_MSG_INVLAID_UPCALL_EVENT, "event-type=%d",
@@ -1485,6 +1533,18 @@ server_process_event_upcall(xlator_t *this, void *data)
             if (!client || strcmp(client->client_uid, client_uid))
                 continue;
 
+            if ((cbk_procnum == GF_CBK_CACHE_INVALIDATION_BATCH) &&
+                (client->opversion < GD_OP_VERSION_11_0)) {
+                ret = server_submit_cache_invalidations(this, conf, xprt,
+                                                        upcall_data);
+                if (ret < 0)
+                    gf_msg_debug(this->name, 0,
+                                 "Failed to send cache invalidations to "
+                                 "client:%s",
+                                 client_uid);
+                break;
+            }
+
             ret = rpcsvc_request_submit(conf->rpc, xprt, &server_cbk_prog,
                                         cbk_procnum, up_req, this->ctx,
                                         xdrproc);
@@ -1505,6 +1565,7 @@ out:
     GF_FREE((gf_recall_lease.xdata).xdata_val);
     GF_FREE((gf_inodelk_contention.xdata).xdata_val);
     GF_FREE((gf_entrylk_contention.xdata).xdata_val);
+    gf_proto_cache_invalidation_batch_free(&gf_c_batch);
 
     return ret;
 }
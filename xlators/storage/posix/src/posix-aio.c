@@ -64,6 +64,7 @@ struct posix_aio_cb {
     fd_t *fd;
     int op;
     off_t offset;
+    gf_boolean_t tracked;
 };
 
 static struct posix_aio_cb *
@@ -283,6 +284,9 @@ posix_aio_writev_complete(struct posix_aio_cb *paiocb, int res)
     fd = paiocb->fd;
     _fd = paiocb->_fd;
 
+    if (paiocb->tracked)
+        posix_ctree_end(this, fd->inode);
+
     if (res < 0) {
         op_ret = -1;
         op_errno = -res;
@@ -368,6 +372,15 @@ posix_aio_writev(call_frame_t *frame, xlator_t *this, fd_t *fd,
         goto err;
     }
 
+    /* An append lands anywhere past the size seen */
+    if (pfd->flags & O_APPEND)
+        paiocb->tracked = posix_ctree_begin(this, fd->inode, _fd, NULL,
+                                            paiocb->prebuf.ia_size,
+                                            UINT64_MAX);
+    else
+        paiocb->tracked = posix_ctree_begin(this, fd->inode, _fd, NULL,
+                                            offset, iov_length(iov, count));
+
     LOCK(&fd->lock);
     {
         __posix_fd_set_odirect(fd, pfd, flags, offset, iov_length(iov, count));
@@ -386,6 +399,9 @@ posix_aio_writev(call_frame_t *frame, xlator_t *this, fd_t *fd,
 
     return 0;
 err:
+    if (paiocb && paiocb->tracked)
+        posix_ctree_end(this, fd->inode);
+
     STACK_UNWIND_STRICT(writev, frame, -1, op_errno, 0, 0, 0);
 
     posix_aio_cb_fini(paiocb);
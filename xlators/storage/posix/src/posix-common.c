@@ -120,6 +120,9 @@ posix_priv(xlator_t *this)
     gf_proc_dump_write("max_write", "%" PRId64,
                        GF_ATOMIC_GET(priv->write_value));
 
+    if (priv->io_uring_configured)
+        posix_io_uring_dump(this);
+
     return 0;
 }
 
@@ -342,6 +345,7 @@ posix_reconfigure(xlator_t *this, dict_t *options)
     int32_t create_mask = -1;
     int32_t create_directory_mask = -1;
     double old_disk_reserve = 0.0;
+    gf_boolean_t rchecksum_tree = _gf_false;
 
     priv = this->private;
 
@@ -487,6 +491,9 @@ posix_reconfigure(xlator_t *this, dict_t *options)
     GF_OPTION_RECONF("fips-mode-rchecksum", priv->fips_mode_rchecksum, options,
                      bool, out);
 
+    GF_OPTION_RECONF("rchecksum-tree", rchecksum_tree, options, bool, out);
+    posix_ctree_reconfigure(this, rchecksum_tree);
+
     GF_OPTION_RECONF("ctime", priv->ctime, options, bool, out);
 
     ret = 0;
@@ -1230,6 +1237,10 @@ posix_init(xlator_t *this)
     GF_OPTION_INIT("fips-mode-rchecksum", _private->fips_mode_rchecksum, bool,
                    out);
 
+    GF_OPTION_INIT("rchecksum-tree", _private->rchecksum_tree, bool, out);
+    if (posix_ctree_init(this))
+        _private->rchecksum_tree = _gf_false;
+
     GF_OPTION_INIT("ctime", _private->ctime, bool, out);
 
 out:
@@ -1395,7 +1406,13 @@ struct volume_options posix_options[] = {
     {.key = {"linux-io_uring"},
      .type = GF_OPTION_TYPE_BOOL,
      .default_value = "off",
-     .description = "Support for Linux io_uring",
+     .description = "Send reads, writes, fsyncs, fallocates, discards, "
+                    "opens, stats and plain xattr requests through the "
+                    "io_uring based I/O framework shared by all bricks of "
+                    "the process. Requests not supported by the kernel, "
+                    "and opens, stats and xattr requests of users other "
+                    "than root, whose permissions have to be checked, are "
+                    "processed synchronously",
      .op_version = {GD_OP_VERSION_9_0},
      .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
     {.key = {"brick-uid"},
@@ -1582,6 +1599,17 @@ struct volume_options posix_options[] = {
      .tags = {"posix"},
      .description = "If enabled, posix_rchecksum uses the FIPS compliant"
                     "SHA256 checksum. MD5 otherwise."},
+    {.key = {"rchecksum-tree"},
+     .type = GF_OPTION_TYPE_BOOL,
+     .default_value = "off",
+     .op_version = {GD_OP_VERSION_11_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .tags = {"posix"},
+     .description = "If enabled, the checksums of the 1MB blocks of the "
+                    "files are kept under .glusterfs/checksums, so that the "
+                    "data self-heal of a big file only reads the blocks "
+                    "changed since they were last asked for. Turning it off "
+                    "removes them."},
     {.key = {"ctime"},
      .type = GF_OPTION_TYPE_BOOL,
      .default_value = "on",
@@ -2350,6 +2350,9 @@ posix_create(call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
         entry_created = _gf_true;
     }
 
+    if (was_present && (_flags & O_TRUNC))
+        posix_ctree_invalidate(this, loc->inode->table, stbuf.ia_gfid);
+
     if (was_present)
         goto fill_stat;
 
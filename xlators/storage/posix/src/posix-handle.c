@@ -870,6 +870,8 @@ posix_handle_unset_gfid(xlator_t *this, uuid_t gfid)
                "unlink %s failed", newstr);
     }
 
+    posix_ctree_remove(this, gfid);
+
     return ret;
 }
 
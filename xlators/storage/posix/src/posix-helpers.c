@@ -2814,6 +2814,7 @@ __posix_inode_ctx_get(inode_t *inode, xlator_t *this)
     pthread_mutex_init(&ctx_p->xattrop_lock, NULL);
     pthread_mutex_init(&ctx_p->write_atomic_lock, NULL);
     pthread_mutex_init(&ctx_p->pgfid_lock, NULL);
+    pthread_mutex_init(&ctx_p->ctree_lock, NULL);
 
     ctx_uint = (uint64_t)(uintptr_t)ctx_p;
     ret = __inode_ctx_set(inode, this, &ctx_uint);
@@ -2821,6 +2822,7 @@ __posix_inode_ctx_get(inode_t *inode, xlator_t *this)
         pthread_mutex_destroy(&ctx_p->xattrop_lock);
         pthread_mutex_destroy(&ctx_p->write_atomic_lock);
         pthread_mutex_destroy(&ctx_p->pgfid_lock);
+        pthread_mutex_destroy(&ctx_p->ctree_lock);
         GF_FREE(ctx_p);
         return NULL;
     }
@@ -3098,6 +3100,7 @@ posix_cs_heal_state(xlator_t *this, const char *realpath, int *fd,
                 state = GF_CS_ERROR;
                 goto out;
             }
+            posix_ctree_invalidate(this, this->itable, buf->ia_gfid);
         }
 
         state = GF_CS_REMOTE;
@@ -3117,6 +3120,7 @@ posix_cs_heal_state(xlator_t *this, const char *realpath, int *fd,
                 state = GF_CS_ERROR;
                 goto out;
             }
+            posix_ctree_invalidate(this, this->itable, buf->ia_gfid);
         }
 
         state = GF_CS_REMOTE;
@@ -714,6 +714,7 @@ posix_do_fallocate(call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t flags,
     int32_t op_errno = 0;
     struct posix_fd *pfd = NULL;
     gf_boolean_t locked = _gf_false;
+    gf_boolean_t tracked = _gf_false;
     posix_inode_ctx_t *ctx = NULL;
     struct posix_private *priv = NULL;
     gf_boolean_t check_space_error = _gf_false;
@@ -780,7 +781,10 @@ overwrite:
         }
     }
 
+    tracked = posix_ctree_begin(this, fd->inode, pfd->fd, NULL, offset, len);
     ret = sys_fallocate(pfd->fd, flags, offset, len);
+    if (tracked)
+        posix_ctree_end(this, fd->inode);
     if (ret == -1) {
         ret = -errno;
         gf_msg(this->name, GF_LOG_ERROR, -ret, P_MSG_FALLOCATE_FAILED,
@@ -964,6 +968,7 @@ posix_do_zerofill(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
     int32_t flags = 0;
     struct posix_fd *pfd = NULL;
     gf_boolean_t locked = _gf_false;
+    gf_boolean_t tracked = _gf_false;
     posix_inode_ctx_t *ctx = NULL;
 
     DECLARE_OLD_FS_ID_VAR;
@@ -1017,6 +1022,7 @@ posix_do_zerofill(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
      * If it fails, fall back to _posix_do_zerofill() and an optional fsync.
      */
     flags = FALLOC_FL_ZERO_RANGE;
+    tracked = posix_ctree_begin(this, fd->inode, pfd->fd, NULL, offset, len);
     ret = sys_fallocate(pfd->fd, flags, offset, len);
     if (ret == 0) {
         goto fsync;
@@ -1059,6 +1065,8 @@ fsync:
     posix_set_ctime(frame, this, NULL, pfd->fd, fd->inode, statpost);
 
 out:
+    if (tracked)
+        posix_ctree_end(this, fd->inode);
     if (locked) {
         pthread_mutex_unlock(&ctx->write_atomic_lock);
         locked = _gf_false;
@@ -1488,6 +1496,7 @@ posix_truncate(call_frame_t *frame, xlator_t *this, loc_t *loc, off_t offset,
         0,
     };
     dict_t *rsp_xdata = NULL;
+    gf_boolean_t tracked = _gf_false;
 
     DECLARE_OLD_FS_ID_VAR;
 
@@ -1522,7 +1531,11 @@ posix_truncate(call_frame_t *frame, xlator_t *this, loc_t *loc, off_t offset,
     }
 
     posix_update_iatt_buf(&prebuf, -1, real_path, xdata);
+    tracked = posix_ctree_begin(this, loc->inode, -1, real_path, offset,
+                                UINT64_MAX);
     op_ret = sys_truncate(real_path, offset);
+    if (tracked)
+        posix_ctree_end(this, loc->inode);
     if (op_ret == -1) {
         op_errno = errno;
         gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_TRUNCATE_FAILED,
@@ -1570,6 +1583,7 @@ posix_open(call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
     struct iatt stbuf = {
         0,
     };
+    gf_boolean_t tracked = _gf_false;
 
     DECLARE_OLD_FS_ID_VAR;
 
@@ -1613,7 +1627,12 @@ posix_open(call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
     if (priv->o_direct)
         flags |= O_DIRECT;
 
+    if (flags & O_TRUNC)
+        tracked = posix_ctree_begin(this, loc->inode, -1, real_path, 0,
+                                    UINT64_MAX);
     _fd = sys_open(real_path, flags, priv->force_create_mode);
+    if (tracked)
+        posix_ctree_end(this, loc->inode);
     if (_fd == -1) {
         op_ret = -1;
         op_errno = errno;
@@ -1965,6 +1984,7 @@ posix_writev(call_frame_t *frame, xlator_t *this, fd_t *fd,
     gf_boolean_t locked = _gf_false;
     gf_boolean_t write_append = _gf_false;
     gf_boolean_t update_atomic = _gf_false;
+    gf_boolean_t tracked = _gf_false;
     posix_inode_ctx_t *ctx = NULL;
     gf_boolean_t check_space_error = _gf_false;
     struct stat statbuf = {
@@ -2072,8 +2092,17 @@ overwrite:
             is_append = 1;
     }
 
+    /* An append lands anywhere past the size seen */
+    if (pfd->flags & O_APPEND)
+        tracked = posix_ctree_begin(this, fd->inode, _fd, NULL, preop.ia_size,
+                                    UINT64_MAX);
+    else
+        tracked = posix_ctree_begin(this, fd->inode, _fd, NULL, offset,
+                                    iov_length(vector, count));
     op_ret = __posix_writev(_fd, vector, count, offset,
                             (pfd->flags & O_DIRECT));
+    if (tracked)
+        posix_ctree_end(this, fd->inode);
 
     if (locked && (!update_atomic)) {
         pthread_mutex_unlock(&ctx->write_atomic_lock);
@@ -2193,6 +2222,7 @@ posix_copy_file_range(call_frame_t *frame, xlator_t *this, fd_t *fd_in,
     int is_append = 0;
     gf_boolean_t locked = _gf_false;
     gf_boolean_t update_atomic = _gf_false;
+    gf_boolean_t tracked = _gf_false;
     posix_inode_ctx_t *ctx = NULL;
     char in_uuid_str[64] = {0}, out_uuid_str[64] = {0};
 
@@ -2326,8 +2356,12 @@ posix_copy_file_range(call_frame_t *frame, xlator_t *this, fd_t *fd_in,
      *       value returned by sys_copy_file_range and then use that as
      *       off_in and off_out for next instance of copy_file_range execution.
      */
+    tracked = posix_ctree_begin(this, fd_out->inode, _fd_out, NULL, off_out,
+                                len);
     op_ret = sys_copy_file_range(_fd_in, &off_in, _fd_out, &off_out, len,
                                  flags);
+    if (tracked)
+        posix_ctree_end(this, fd_out->inode);
 
     if (op_ret < 0) {
         op_errno = errno;
@@ -2601,6 +2635,7 @@ posix_release(xlator_t *this, fd_t *fd)
                "pfd->dir is %p (not NULL) for file fd=%p", pfd->dir, fd);
     }
 
+    posix_ctree_release(this, fd->inode, pfd->fd);
     posix_add_fd_to_cleanup(this, pfd);
 
 out:
@@ -2788,6 +2823,7 @@ posix_setxattr(call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *dict,
         0,
     };
     int8_t sync_backend_xattrs = _gf_false;
+    gf_boolean_t tracked = _gf_false;
     data_pair_t *custom_xattrs;
     data_t *keyval = NULL;
     char **xattrs_to_heal = get_xattrs_to_heal();
@@ -2837,6 +2873,10 @@ posix_setxattr(call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *dict,
     tdata = dict_get(dict, GF_CS_OBJECT_UPLOAD_COMPLETE);
     if (tdata) {
         /*TODO: move the following to a different function */
+        /* The file may get truncated below. This can't be done under the
+         * inode lock. */
+        tracked = posix_ctree_begin(this, loc->inode, -1, real_path, 0,
+                                    UINT64_MAX);
         LOCK(&loc->inode->lock);
         {
             state = posix_cs_check_status(this, real_path, NULL, &preop);
@@ -2952,6 +2992,8 @@ posix_setxattr(call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *dict,
         }
     unlock:
         UNLOCK(&loc->inode->lock);
+        if (tracked)
+            posix_ctree_end(this, loc->inode);
         op_ret = ret;
         goto out;
     }
@@ -5272,6 +5314,7 @@ posix_ftruncate(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
     int ret = -1;
     struct posix_private *priv = NULL;
     dict_t *rsp_xdata = NULL;
+    gf_boolean_t tracked = _gf_false;
 
     DECLARE_OLD_FS_ID_VAR;
     SET_FS_ID(frame->root->uid, frame->root->gid);
@@ -5312,7 +5355,11 @@ posix_ftruncate(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
     }
 
     posix_update_iatt_buf(&preop, _fd, NULL, xdata);
+    tracked = posix_ctree_begin(this, fd->inode, _fd, NULL, offset,
+                                UINT64_MAX);
     op_ret = sys_ftruncate(_fd, offset);
+    if (tracked)
+        posix_ctree_end(this, fd->inode);
 
     if (op_ret == -1) {
         op_errno = errno;
@@ -5892,6 +5939,7 @@ posix_rchecksum(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
     ssize_t bytes_read = 0;
     int32_t weak_checksum = 0;
     int32_t zerofillcheck = 0;
+    uint64_t tree_len = 0;
     /* Protocol version 4 uses 32 bytes i.e SHA256_DIGEST_LENGTH,
        so this is used. */
     unsigned char md5_checksum[SHA256_DIGEST_LENGTH] = {0};
@@ -5910,12 +5958,6 @@ posix_rchecksum(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
 
     priv = this->private;
 
-    alloc_buf = _page_aligned_alloc(len, &buf, _gf_false);
-    if (!alloc_buf) {
-        op_errno = ENOMEM;
-        goto out;
-    }
-
     rsp_xdata = dict_new();
     if (!rsp_xdata) {
         op_errno = ENOMEM;
@@ -5951,6 +5993,41 @@ posix_rchecksum(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
         }
     }
 
+    if (xdata && priv->rchecksum_tree &&
+        !dict_get_uint64(xdata, GF_RCHECKSUM_TREE, &tree_len)) {
+        checksum = priv->fips_mode_rchecksum ? strong_checksum : md5_checksum;
+        ret = posix_ctree_checksum(this, fd, _fd, offset, tree_len, checksum);
+        if (ret) {
+            gf_msg(this->name, GF_LOG_WARNING, -ret,
+                   P_MSG_RCHECKSUM_TREE_FAILED,
+                   "%s: failed to get the checksum of %" PRIu64
+                   " bytes at %" PRId64,
+                   uuid_utoa(fd->inode->gfid), tree_len, offset);
+            op_errno = -ret;
+            goto out;
+        }
+        ret = dict_set_int32_sizen(rsp_xdata, GF_RCHECKSUM_TREE, 1);
+        if (!ret && priv->fips_mode_rchecksum)
+            ret = dict_set_int32(rsp_xdata, "fips-mode-rchecksum", 1);
+        if (ret) {
+            gf_msg(this->name, GF_LOG_WARNING, -ret, P_MSG_DICT_SET_FAILED,
+                   "%s: Failed to set the keys of the tree checksum",
+                   uuid_utoa(fd->inode->gfid));
+            op_errno = -ret;
+            goto out;
+        }
+        op_ret = 0;
+
+        posix_set_ctime(frame, this, NULL, _fd, fd->inode, NULL);
+        goto out;
+    }
+
+    alloc_buf = _page_aligned_alloc(len, &buf, _gf_false);
+    if (!alloc_buf) {
+        op_errno = ENOMEM;
+        goto out;
+    }
+
     LOCK(&fd->lock);
     {
         if (priv->aio_capable && priv->aio_init_done)
@@ -6050,6 +6127,8 @@ posix_forget(xlator_t *this, inode_t *inode)
     pthread_mutex_destroy(&ctx->xattrop_lock);
     pthread_mutex_destroy(&ctx->write_atomic_lock);
     pthread_mutex_destroy(&ctx->pgfid_lock);
+    pthread_mutex_destroy(&ctx->ctree_lock);
+    posix_ctree_free(ctx->ctree);
     GF_FREE(ctx);
 
     return ret;
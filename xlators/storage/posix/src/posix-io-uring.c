@@ -12,27 +12,52 @@
 #include "posix-messages.h"
 #include "posix-io-uring.h"
 #include "posix-handle.h"
-
-#ifdef HAVE_LIBURING
-#include <liburing.h>
+#include "posix-gfid-path.h"
+#include "posix-metadata.h"
+
+#ifdef HAVE_IO_URING
+#include <sys/sysmacros.h>
+#include <glusterfs/gf-io.h>
+#include <glusterfs/statedump.h>
+#include <glusterfs/syscall.h>
+
+/* readv, writev, fsync, fallocate, discard, open, stat, fstat and the common
+ * cases of the xattr fops are submitted as native requests to the
+ * process-wide I/O framework. Only the system call that does the real work
+ * is sent. Resolving the handle path and building the reply is still done
+ * by the caller and by the completion callback.
+ *
+ * Requests that need any of the special processing of the regular fops
+ * (virtual xattrs, cloudsync, reserved space, durable or atomic updates)
+ * are passed to the synchronous implementation, as well as fops whose
+ * opcode is not supported by the running kernel.
+ *
+ * Reads and writes whose buffer belongs to an iobuf arena registered with
+ * the kernel are sent as fixed requests, which avoids mapping the user
+ * pages on each request. */
 
 struct posix_uring_ctx;
 typedef void(fop_unwind_f)(struct posix_uring_ctx *, int32_t);
-typedef void(fop_prep_f)(struct io_uring_sqe *sqe, struct posix_uring_ctx *);
-static int
-posix_io_uring_submit(xlator_t *this, struct posix_uring_ctx *ctx);
 
 struct posix_uring_ctx {
     call_frame_t *frame;
+    xlator_t *this;
     struct iatt prebuf;
     dict_t *xdata;
     fd_t *fd;
+    loc_t loc;
+    char *path;
+    struct timespec begin;
+    struct timespec submitted;
     int _fd;
     int op;
+    gf_boolean_t fixed;
+    gf_boolean_t tracked;
 
     union {
         struct {
             struct iovec *iov;
+            struct iobref *iobref;
             int count;
             off_t offset;
         } write;
@@ -44,11 +69,32 @@ struct posix_uring_ctx {
         } read;
 
         struct {
-            int32_t datasync;
+            uint32_t flags;
         } fsync;
+
+        struct {
+            struct statx buf;
+        } stat;
+
+        struct {
+            struct iatt stbuf;
+            int32_t flags;
+        } open;
+
+        struct {
+            char *name;
+            char *value;
+            uint32_t size;
+            int32_t flags;
+        } xattr;
+
+        struct {
+            int32_t mode;
+            off_t offset;
+            size_t len;
+        } fallocate;
     } fop;
 
-    fop_prep_f *prepare;
     fop_unwind_f *unwind;
 };
 
@@ -61,38 +107,66 @@ posix_io_uring_ctx_free(struct posix_uring_ctx *ctx)
         fd_unref(ctx->fd);
     if (ctx->xdata)
         dict_unref(ctx->xdata);
+    loc_wipe(&ctx->loc);
+    GF_FREE(ctx->path);
     switch (ctx->op) {
         case GF_FOP_READ:
             if (ctx->fop.read.iobuf)
                 iobuf_unref(ctx->fop.read.iobuf);
             break;
+        case GF_FOP_WRITE:
+            GF_FREE(ctx->fop.write.iov);
+            if (ctx->fop.write.iobref)
+                iobref_unref(ctx->fop.write.iobref);
+            break;
+        case GF_FOP_GETXATTR:
+        case GF_FOP_FGETXATTR:
+        case GF_FOP_SETXATTR:
+        case GF_FOP_FSETXATTR:
+            GF_FREE(ctx->fop.xattr.name);
+            GF_FREE(ctx->fop.xattr.value);
+            break;
         default:
             break;
     }
     GF_FREE(ctx);
 }
 
-struct posix_uring_ctx *
+static struct posix_uring_ctx *
+posix_io_uring_ctx_new(call_frame_t *frame, xlator_t *this, int op)
+{
+    struct posix_uring_ctx *ctx = NULL;
+
+    ctx = GF_CALLOC(1, sizeof(*ctx), gf_posix_mt_uring_ctx);
+    if (!ctx) {
+        return NULL;
+    }
+
+    timespec_now(&ctx->begin);
+    ctx->frame = frame;
+    ctx->this = this;
+    ctx->op = op;
+
+    return ctx;
+}
+
+static struct posix_uring_ctx *
 posix_io_uring_ctx_init(call_frame_t *frame, xlator_t *this, fd_t *fd, int op,
-                        fop_prep_f prepare, fop_unwind_f unwind,
-                        int32_t *op_errno, dict_t *xdata)
+                        fop_unwind_f unwind, int32_t *op_errno, dict_t *xdata)
 {
     struct posix_uring_ctx *ctx = NULL;
     struct posix_fd *pfd = NULL;
     int ret = 0;
 
-    ctx = GF_CALLOC(1, sizeof(*ctx), gf_posix_mt_uring_ctx);
+    ctx = posix_io_uring_ctx_new(frame, this, op);
     if (!ctx) {
         return NULL;
     }
 
-    ctx->frame = frame;
     ctx->fd = fd_ref(fd);
-    ctx->prepare = prepare;
     ctx->unwind = unwind;
     if (xdata)
         ctx->xdata = dict_ref(xdata);
-    ctx->op = op;
 
     ret = posix_fd_ctx_get(fd, this, &pfd, op_errno);
     if (ret < 0) {
@@ -102,8 +176,10 @@ posix_io_uring_ctx_init(call_frame_t *frame, xlator_t *this, fd_t *fd, int op,
     }
     ctx->_fd = pfd->fd;
 
-    /* TODO: Explore filling up pre and post bufs using IOSQE_IO_LINK*/
-    if ((op == GF_FOP_WRITE) || (op == GF_FOP_FSYNC)) {
+    /* The attributes before the request are needed in the answer. */
+    if ((op == GF_FOP_WRITE) || (op == GF_FOP_FSYNC) ||
+        (op == GF_FOP_FSETXATTR) || (op == GF_FOP_FALLOCATE) ||
+        (op == GF_FOP_DISCARD)) {
         if (posix_fdstat(this, fd->inode, pfd->fd, &ctx->prebuf) != 0) {
             *op_errno = errno;
             gf_msg(this->name, GF_LOG_ERROR, *op_errno, P_MSG_FSTAT_FAILED,
@@ -119,6 +195,43 @@ err:
     return NULL;
 }
 
+/* Update the latency counters of the fop once the request completes. The
+ * submission time covers everything done before handing the request to the
+ * I/O framework, and the completion time covers the time spent there. */
+static void
+posix_io_uring_account(struct posix_uring_ctx *ctx)
+{
+    struct posix_private *priv = ctx->this->private;
+    struct posix_uring_stats *stats = &priv->uring_stats[ctx->op];
+    struct timespec now;
+
+    timespec_now(&now);
+
+    GF_ATOMIC_INC(stats->count);
+    GF_ATOMIC_ADD(stats->submit_ns, gf_tsdiff(&ctx->begin, &ctx->submitted));
+    GF_ATOMIC_ADD(stats->complete_ns, gf_tsdiff(&ctx->submitted, &now));
+    if (ctx->fixed)
+        GF_ATOMIC_INC(stats->fixed);
+}
+
+GF_IO_CBK(posix_io_uring_cbk, op, res, static)
+{
+    struct posix_uring_ctx *ctx = op->data;
+
+    THIS = ctx->this;
+
+    posix_io_uring_account(ctx);
+    ctx->unwind(ctx, res);
+}
+
+static void
+posix_io_uring_flush(void)
+{
+    /* Requests are only queued by the gf_io_*() functions. Make sure they
+     * are sent to the kernel without waiting for other requests. */
+    gf_io.engine.flush();
+}
+
 static void
 posix_io_uring_readv_complete(struct posix_uring_ctx *ctx, int32_t res)
 {
@@ -194,14 +307,6 @@ out:
     posix_io_uring_ctx_free(ctx);
 }
 
-static void
-posix_prep_readv(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
-{
-    sqe->flags |= IOSQE_ASYNC;
-    io_uring_prep_readv(sqe, ctx->_fd, &ctx->fop.read.iovec, 1,
-                        ctx->fop.read.offset);
-}
-
 int
 posix_io_uring_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
                      off_t offset, uint32_t flags, dict_t *xdata)
@@ -209,11 +314,11 @@ posix_io_uring_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
     struct posix_uring_ctx *ctx = NULL;
     int32_t op_errno = ENOMEM;
     struct iobuf *iobuf = NULL;
-    int ret = 0;
+    int index = -1;
 
-    ctx = posix_io_uring_ctx_init(
-        frame, this, fd, GF_FOP_READ, posix_prep_readv,
-        posix_io_uring_readv_complete, &op_errno, xdata);
+    ctx = posix_io_uring_ctx_init(frame, this, fd, GF_FOP_READ,
+                                  posix_io_uring_readv_complete, &op_errno,
+                                  xdata);
     if (!ctx) {
         goto err;
     }
@@ -228,17 +333,19 @@ posix_io_uring_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
     ctx->fop.read.iovec.iov_len = size;
     ctx->fop.read.offset = offset;
 
-    ret = posix_io_uring_submit(this, ctx);
-    if (ret < 0) {
-        gf_msg(this->name, GF_LOG_ERROR, -ret, P_MSG_POSIX_IO_URING,
-               "Failed to submit sqe");
-        op_errno = -ret;
-        goto err;
-    }
-    if (ret == 0) {
-        gf_msg(this->name, GF_LOG_WARNING, -ret, P_MSG_POSIX_IO_URING,
-               "submit sqe got zero");
+    index = iobuf_fixed_index(iobuf, iobuf_ptr(iobuf), size);
+
+    timespec_now(&ctx->submitted);
+    if (index >= 0) {
+        ctx->fixed = _gf_true;
+        gf_io_read_fixed(posix_io_uring_cbk, ctx->_fd, iobuf_ptr(iobuf), size,
+                         offset, index, ctx);
+    } else {
+        gf_io_readv(posix_io_uring_cbk, ctx->_fd, &ctx->fop.read.iovec, 1,
+                    offset, ctx);
     }
+    posix_io_uring_flush();
+
     return 0;
 err:
     STACK_UNWIND_STRICT(readv, frame, -1, op_errno, NULL, 1, NULL, NULL, NULL);
@@ -281,6 +388,9 @@ posix_io_uring_writev_complete(struct posix_uring_ctx *ctx, int32_t res)
     fd = ctx->fd;
     _fd = ctx->_fd;
 
+    if (ctx->tracked)
+        posix_ctree_end(this, fd->inode);
+
     if (res < 0) {
         op_ret = -1;
         op_errno = -res;
@@ -310,13 +420,6 @@ out:
     posix_io_uring_ctx_free(ctx);
 }
 
-static void
-posix_prep_writev(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
-{
-    io_uring_prep_writev(sqe, ctx->_fd, ctx->fop.write.iov,
-                         ctx->fop.write.count, ctx->fop.write.offset);
-}
-
 int
 posix_io_uring_writev(call_frame_t *frame, xlator_t *this, fd_t *fd,
                       struct iovec *iov, int count, off_t offset,
@@ -324,30 +427,51 @@ posix_io_uring_writev(call_frame_t *frame, xlator_t *this, fd_t *fd,
 {
     struct posix_uring_ctx *ctx = NULL;
     int32_t op_errno = ENOMEM;
-    int ret = 0;
+    int index = -1;
 
-    ctx = posix_io_uring_ctx_init(
-        frame, this, fd, GF_FOP_WRITE, posix_prep_writev,
-        posix_io_uring_writev_complete, &op_errno, xdata);
+    ctx = posix_io_uring_ctx_init(frame, this, fd, GF_FOP_WRITE,
+                                  posix_io_uring_writev_complete, &op_errno,
+                                  xdata);
     if (!ctx) {
         goto err;
     }
 
-    ctx->fop.write.iov = iov;
+    /* The request may be sent to the kernel after this function returns,
+     * so both the vector and the buffers it points to must be kept alive
+     * until completion. */
+    ctx->fop.write.iov = iov_dup(iov, count);
+    if (!ctx->fop.write.iov) {
+        op_errno = ENOMEM;
+        goto err;
+    }
+    if (iobref)
+        ctx->fop.write.iobref = iobref_ref(iobref);
     ctx->fop.write.count = count;
     ctx->fop.write.offset = offset;
 
-    ret = posix_io_uring_submit(this, ctx);
-    if (ret < 0) {
-        gf_msg(this->name, GF_LOG_ERROR, -ret, P_MSG_POSIX_IO_URING,
-               "Failed to submit sqe");
-        op_errno = -ret;
-        goto err;
-    }
-    if (ret == 0) {
-        gf_msg(this->name, GF_LOG_WARNING, -ret, P_MSG_POSIX_IO_URING,
-               "submit sqe got zero");
+    /* Fixed writes only take a single buffer. */
+    if (iobref && (count == 1))
+        index = iobref_fixed_index(iobref, iov[0].iov_base, iov[0].iov_len);
+
+    /* An append lands anywhere past the size seen */
+    if (fd->flags & O_APPEND)
+        ctx->tracked = posix_ctree_begin(this, fd->inode, ctx->_fd, NULL,
+                                         ctx->prebuf.ia_size, UINT64_MAX);
+    else
+        ctx->tracked = posix_ctree_begin(this, fd->inode, ctx->_fd, NULL,
+                                         offset, iov_length(iov, count));
+
+    timespec_now(&ctx->submitted);
+    if (index >= 0) {
+        ctx->fixed = _gf_true;
+        gf_io_write_fixed(posix_io_uring_cbk, ctx->_fd, iov[0].iov_base,
+                          iov[0].iov_len, offset, index, ctx);
+    } else {
+        gf_io_writev(posix_io_uring_cbk, ctx->_fd, ctx->fop.write.iov, count,
+                     offset, ctx);
     }
+    posix_io_uring_flush();
+
     return 0;
 err:
     STACK_UNWIND_STRICT(writev, frame, -1, op_errno, 0, 0, 0);
@@ -360,7 +484,6 @@ posix_io_uring_fsync_complete(struct posix_uring_ctx *ctx, int32_t res)
 {
     call_frame_t *frame = NULL;
     xlator_t *this = NULL;
-    struct posix_private *priv = NULL;
     struct iatt postbuf = {
         0,
     };
@@ -372,7 +495,6 @@ posix_io_uring_fsync_complete(struct posix_uring_ctx *ctx, int32_t res)
 
     frame = ctx->frame;
     this = frame->this;
-    priv = this->private;
     fd = ctx->fd;
     _fd = ctx->_fd;
 
@@ -380,7 +502,7 @@ posix_io_uring_fsync_complete(struct posix_uring_ctx *ctx, int32_t res)
         op_ret = -1;
         op_errno = -res;
         gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_FSYNC_FAILED,
-               "writev(async) failed fd=%d.", _fd);
+               "fsync(async) failed fd=%d.", _fd);
         goto out;
     }
 
@@ -395,48 +517,33 @@ posix_io_uring_fsync_complete(struct posix_uring_ctx *ctx, int32_t res)
 
     op_ret = res;
     op_errno = 0;
-    GF_ATOMIC_ADD(priv->write_value, op_ret);
 out:
     STACK_UNWIND_STRICT(fsync, frame, op_ret, op_errno, &ctx->prebuf, &postbuf,
                         NULL);
     posix_io_uring_ctx_free(ctx);
 }
 
-static void
-posix_prep_fsync(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
-{
-    io_uring_prep_fsync(sqe, ctx->_fd, ctx->fop.fsync.datasync);
-}
-
 int
 posix_io_uring_fsync(call_frame_t *frame, xlator_t *this, fd_t *fd,
                      int32_t datasync, dict_t *xdata)
 {
     struct posix_uring_ctx *ctx = NULL;
     int32_t op_errno = ENOMEM;
-    int ret = 0;
 
-    ctx = posix_io_uring_ctx_init(
-        frame, this, fd, GF_FOP_FSYNC, posix_prep_fsync,
-        posix_io_uring_fsync_complete, &op_errno, xdata);
+    ctx = posix_io_uring_ctx_init(frame, this, fd, GF_FOP_FSYNC,
+                                  posix_io_uring_fsync_complete, &op_errno,
+                                  xdata);
     if (!ctx) {
         goto err;
     }
 
     if (datasync)
-        ctx->fop.fsync.datasync |= IORING_FSYNC_DATASYNC;
+        ctx->fop.fsync.flags |= GF_IO_FSYNC_DATASYNC;
+
+    timespec_now(&ctx->submitted);
+    gf_io_fsync(posix_io_uring_cbk, ctx->_fd, ctx->fop.fsync.flags, ctx);
+    posix_io_uring_flush();
 
-    ret = posix_io_uring_submit(this, ctx);
-    if (ret < 0) {
-        gf_msg(this->name, GF_LOG_ERROR, -ret, P_MSG_POSIX_IO_URING,
-               "Failed to submit sqe");
-        op_errno = -ret;
-        goto err;
-    }
-    if (ret == 0) {
-        gf_msg(this->name, GF_LOG_ERROR, -ret, P_MSG_POSIX_IO_URING,
-               "submit sqe got zero");
-    }
     return 0;
 err:
     posix_io_uring_ctx_free(ctx);
@@ -444,131 +551,950 @@ err:
     return 0;
 }
 
+/* Create a context for a fop that works on a loc. The handle path is
+ * resolved here, so that only the final system call is sent. */
+static struct posix_uring_ctx *
+posix_io_uring_ctx_init_loc(call_frame_t *frame, xlator_t *this, loc_t *loc,
+                            int op, int32_t *op_errno, dict_t *xdata)
+{
+    struct posix_uring_ctx *ctx = NULL;
+    char *real_path = NULL;
+
+    ctx = posix_io_uring_ctx_new(frame, this, op);
+    if (!ctx) {
+        *op_errno = ENOMEM;
+        return NULL;
+    }
+
+    if (xdata)
+        ctx->xdata = dict_ref(xdata);
+
+    if (loc_copy(&ctx->loc, loc) != 0) {
+        *op_errno = ENOMEM;
+        goto err;
+    }
+
+    if (LOC_IS_DIR(loc) && LOC_HAS_ABSPATH(loc)) {
+        MAKE_REAL_PATH(real_path, this, loc->path);
+    } else {
+        MAKE_HANDLE_PATH(real_path, this, loc->gfid, NULL);
+    }
+    if (!real_path) {
+        *op_errno = ESTALE;
+        gf_msg(this->name, GF_LOG_ERROR, ESTALE, P_MSG_INODE_HANDLE_CREATE,
+               "Failed to create inode handle for path %s", loc->path);
+        goto err;
+    }
+
+    ctx->path = gf_strdup(real_path);
+    if (!ctx->path) {
+        *op_errno = ENOMEM;
+        goto err;
+    }
+
+    return ctx;
+
+err:
+    posix_io_uring_ctx_free(ctx);
+    return NULL;
+}
+
+/* Requests that need special processing in the regular fops. */
+static gf_boolean_t
+posix_io_uring_xdata_sync(dict_t *xdata)
+{
+    if (!xdata)
+        return _gf_false;
+
+    return dict_get_sizen(xdata, GF_CS_OBJECT_STATUS) ||
+           dict_get_sizen(xdata, GF_CS_OBJECT_REPAIR) ||
+           dict_get_sizen(xdata, GLUSTERFS_WRITE_UPDATE_ATOMIC) ||
+           dict_get_sizen(xdata, GLUSTERFS_DURABLE_OP) ||
+           dict_get_sizen(xdata, "sync_backend_xattrs");
+}
+
+/* Requests are run by io_uring with the credentials of the brick, while the
+ * regular fops switch to the ones of the caller (SET_FS_ID) for the kernel to
+ * check its permissions. Only the requests of root, which aren't checked
+ * anyway, can skip that. */
+static gf_boolean_t
+posix_io_uring_creds_root(call_frame_t *frame)
+{
+    return frame->root->uid == 0;
+}
+
+/* Extended attributes that are stored as they are, without any special
+ * handling by posix. All the virtual and internal xattrs of gluster have
+ * 'glusterfs' in their name. */
+static gf_boolean_t
+posix_io_uring_xattr_plain(const char *name)
+{
+    if (!name)
+        return _gf_false;
+
+    if ((strncmp(name, "trusted.", SLEN("trusted.")) != 0) &&
+        (strncmp(name, XATTR_USER_PREFIX, XATTR_USER_PREFIX_LEN) != 0))
+        return _gf_false;
+
+    if (strstr(name, "glusterfs") || XATTR_IS_PATHINFO(name) ||
+        posix_is_gfid2path_xattr(name) || !strcmp(name, GFID_XATTR_KEY) ||
+        !strcmp(name, GF_XATTR_IOSTATS_DUMP_KEY))
+        return _gf_false;
+
+    return _gf_true;
+}
+
+/* Path based xattr requests follow symbolic links when sent to io_uring,
+ * while posix must not follow them. Only the handles of regular files,
+ * which are hard links, can be used. */
+static gf_boolean_t
+posix_io_uring_loc_plain(loc_t *loc)
+{
+    return loc->inode && IA_ISREG(loc->inode->ia_type) &&
+           !gf_uuid_is_null(loc->gfid);
+}
+
+static void
+posix_io_uring_statx_to_stat(struct statx *stx, struct stat *st)
+{
+    memset(st, 0, sizeof(*st));
+
+    st->st_dev = makedev(stx->stx_dev_major, stx->stx_dev_minor);
+    st->st_ino = stx->stx_ino;
+    st->st_mode = stx->stx_mode;
+    st->st_nlink = stx->stx_nlink;
+    st->st_uid = stx->stx_uid;
+    st->st_gid = stx->stx_gid;
+    st->st_rdev = makedev(stx->stx_rdev_major, stx->stx_rdev_minor);
+    st->st_size = stx->stx_size;
+    st->st_blksize = stx->stx_blksize;
+    st->st_blocks = stx->stx_blocks;
+    st->st_atim.tv_sec = stx->stx_atime.tv_sec;
+    st->st_atim.tv_nsec = stx->stx_atime.tv_nsec;
+    st->st_mtim.tv_sec = stx->stx_mtime.tv_sec;
+    st->st_mtim.tv_nsec = stx->stx_mtime.tv_nsec;
+    st->st_ctim.tv_sec = stx->stx_ctime.tv_sec;
+    st->st_ctim.tv_nsec = stx->stx_ctime.tv_nsec;
+}
+
+/* Build the iatt of a file from the result of a statx request, like
+ * posix_istat() does for a path and posix_fdstat() for a fd. */
 static int
-posix_io_uring_submit(xlator_t *this, struct posix_uring_ctx *ctx)
+posix_io_uring_iatt(struct posix_uring_ctx *ctx, const char *path, int fd,
+                    inode_t *inode, struct iatt *buf)
 {
+    xlator_t *this = ctx->this;
     struct posix_private *priv = this->private;
-    struct io_uring_sqe *sqe = NULL;
+    struct stat st;
     int ret = 0;
 
-    pthread_mutex_lock(&priv->sq_mutex);
-    {
-        sqe = io_uring_get_sqe(&priv->ring);
-        if (!sqe) {
-            /*TODO: Retry until we get an sqe instead of failing. */
-            pthread_mutex_unlock(&priv->sq_mutex);
-            ret = -EAGAIN;
-            gf_msg(this->name, GF_LOG_ERROR, -ret, P_MSG_POSIX_IO_URING,
-                   "Failed to get sqe");
-            goto out;
+    posix_io_uring_statx_to_stat(&ctx->fop.stat.buf, &st);
+
+    if (path && (st.st_ino == priv->handledir.st_ino) &&
+        (st.st_dev == priv->handledir.st_dev)) {
+        errno = ENOENT;
+        return -1;
+    }
+
+    if (st.st_nlink && !S_ISDIR(st.st_mode))
+        st.st_nlink--;
+
+    iatt_from_stat(buf, &st);
+
+    if (inode && priv->ctime) {
+        ret = posix_get_mdata_xattr(this, path, fd, inode, buf);
+        if (ret) {
+            gf_msg(this->name, GF_LOG_WARNING, errno, P_MSG_GETMDATA_FAILED,
+                   "posix get mdata failed on gfid: %s",
+                   uuid_utoa(inode->gfid));
+            return ret;
+        }
+    }
+
+    if (path)
+        gf_uuid_copy(buf->ia_gfid, ctx->loc.gfid);
+    else
+        posix_fill_gfid_fd(this, fd, buf);
+    buf->ia_flags |= IATT_GFID;
+
+    posix_fill_ino_from_gfid(this, buf);
+
+    return 0;
+}
+
+static void
+posix_io_uring_stat_complete(struct posix_uring_ctx *ctx, int32_t res)
+{
+    xlator_t *this = ctx->this;
+    struct iatt buf = {
+        0,
+    };
+    dict_t *xattr_rsp = NULL;
+    int32_t op_ret = -1;
+    int32_t op_errno = 0;
+
+    if (res < 0) {
+        op_errno = -res;
+        if (op_errno == ENOENT) {
+            gf_msg_debug(this->name, op_errno,
+                         "lstat on gfid-handle %s (path: %s) failed",
+                         ctx->path, ctx->loc.path);
+        } else {
+            gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_LSTAT_FAILED,
+                   "lstat on gfid-handle %s (path: %s) failed", ctx->path,
+                   ctx->loc.path);
         }
-        ctx->prepare(sqe, ctx);
-        io_uring_sqe_set_data(sqe, ctx);
-        ret = io_uring_submit(&priv->ring);
+        goto out;
+    }
+
+    if (posix_io_uring_iatt(ctx, ctx->path, -1, ctx->loc.inode, &buf) != 0) {
+        op_errno = errno;
+        goto out;
     }
-    pthread_mutex_unlock(&priv->sq_mutex);
+
+    if (ctx->xdata)
+        xattr_rsp = posix_xattr_fill(this, ctx->path, &ctx->loc, NULL, -1,
+                                     ctx->xdata, &buf);
+
+    op_ret = 0;
 
 out:
-    return ret;
+    STACK_UNWIND_STRICT(stat, ctx->frame, op_ret, op_errno, &buf, xattr_rsp);
+    if (xattr_rsp)
+        dict_unref(xattr_rsp);
+    posix_io_uring_ctx_free(ctx);
 }
 
-static void *
-posix_io_uring_thread(void *data)
+int
+posix_io_uring_stat(call_frame_t *frame, xlator_t *this, loc_t *loc,
+                    dict_t *xdata)
 {
-    xlator_t *this = NULL;
-    struct posix_private *priv = NULL;
+    struct posix_uring_ctx *ctx = NULL;
+    int32_t op_errno = 0;
+
+    if (!posix_io_uring_creds_root(frame) || gf_uuid_is_null(loc->gfid) ||
+        posix_io_uring_xdata_sync(xdata))
+        return posix_stat(frame, this, loc, xdata);
+
+    ctx = posix_io_uring_ctx_init_loc(frame, this, loc, GF_FOP_STAT,
+                                      &op_errno, xdata);
+    if (!ctx) {
+        STACK_UNWIND_STRICT(stat, frame, -1, op_errno, NULL, NULL);
+        return 0;
+    }
+    ctx->unwind = posix_io_uring_stat_complete;
+
+    timespec_now(&ctx->submitted);
+    gf_io_statx(posix_io_uring_cbk, AT_FDCWD, ctx->path, AT_SYMLINK_NOFOLLOW,
+                STATX_BASIC_STATS, &ctx->fop.stat.buf, ctx);
+    posix_io_uring_flush();
+
+    return 0;
+}
+
+static void
+posix_io_uring_fstat_complete(struct posix_uring_ctx *ctx, int32_t res)
+{
+    xlator_t *this = ctx->this;
+    struct iatt buf = {
+        0,
+    };
+    dict_t *xattr_rsp = NULL;
+    int32_t op_ret = -1;
+    int32_t op_errno = 0;
+
+    if (res < 0) {
+        op_errno = -res;
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_FSTAT_FAILED,
+               "fstat failed on fd=%p", ctx->fd);
+        goto out;
+    }
+
+    if (posix_io_uring_iatt(ctx, NULL, ctx->_fd, ctx->fd->inode, &buf) != 0) {
+        op_errno = errno;
+        goto out;
+    }
+
+    if (ctx->xdata)
+        xattr_rsp = posix_xattr_fill(this, NULL, NULL, ctx->fd, ctx->_fd,
+                                     ctx->xdata, &buf);
+
+    op_ret = 0;
+
+out:
+    STACK_UNWIND_STRICT(fstat, ctx->frame, op_ret, op_errno, &buf, xattr_rsp);
+    if (xattr_rsp)
+        dict_unref(xattr_rsp);
+    posix_io_uring_ctx_free(ctx);
+}
+
+int
+posix_io_uring_fstat(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                     dict_t *xdata)
+{
+    struct posix_uring_ctx *ctx = NULL;
+    int32_t op_errno = ENOMEM;
+
+    if (posix_io_uring_xdata_sync(xdata))
+        return posix_fstat(frame, this, fd, xdata);
+
+    ctx = posix_io_uring_ctx_init(frame, this, fd, GF_FOP_FSTAT,
+                                  posix_io_uring_fstat_complete, &op_errno,
+                                  xdata);
+    if (!ctx) {
+        STACK_UNWIND_STRICT(fstat, frame, -1, op_errno, NULL, NULL);
+        return 0;
+    }
+
+    timespec_now(&ctx->submitted);
+    gf_io_statx(posix_io_uring_cbk, ctx->_fd, "", AT_EMPTY_PATH,
+                STATX_BASIC_STATS, &ctx->fop.stat.buf, ctx);
+    posix_io_uring_flush();
+
+    return 0;
+}
+
+static void
+posix_io_uring_open_complete(struct posix_uring_ctx *ctx, int32_t res)
+{
+    xlator_t *this = ctx->this;
+    struct posix_fd *pfd = NULL;
+    int32_t op_ret = -1;
+    int32_t op_errno = 0;
+
+    if (ctx->tracked)
+        posix_ctree_end(this, ctx->loc.inode);
+
+    if (res < 0) {
+        op_errno = -res;
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_FILE_OP_FAILED,
+               "open on gfid-handle %s (path: %s), flags: %d", ctx->path,
+               ctx->loc.path, ctx->fop.open.flags);
+        goto out;
+    }
+
+    posix_set_ctime(ctx->frame, this, ctx->path, -1, ctx->loc.inode,
+                    &ctx->fop.open.stbuf);
+
+    pfd = GF_CALLOC(1, sizeof(*pfd), gf_posix_mt_posix_fd);
+    if (!pfd) {
+        op_errno = ENOMEM;
+        sys_close(res);
+        goto out;
+    }
+
+    pfd->flags = ctx->fop.open.flags;
+    pfd->fd = res;
+
+    if (fd_ctx_set(ctx->fd, this, (uint64_t)(long)pfd))
+        gf_msg(this->name, GF_LOG_WARNING, 0, P_MSG_FD_PATH_SETTING_FAILED,
+               "failed to set the fd context gfid-handle=%s path=%s fd=%p",
+               ctx->path, ctx->loc.path, ctx->fd);
+
+    op_ret = 0;
+
+out:
+    STACK_UNWIND_STRICT(open, ctx->frame, op_ret, op_errno, ctx->fd, NULL);
+    posix_io_uring_ctx_free(ctx);
+}
+
+int
+posix_io_uring_open(call_frame_t *frame, xlator_t *this, loc_t *loc,
+                    int32_t flags, fd_t *fd, dict_t *xdata)
+{
+    struct posix_private *priv = this->private;
+    struct posix_uring_ctx *ctx = NULL;
+    int32_t op_errno = 0;
+
+    /* Block and char devices are rejected by posix_open(), and creating the
+     * file has to check the reserved space. */
+    if (!posix_io_uring_creds_root(frame) || !loc->inode ||
+        !IA_ISREG(loc->inode->ia_type) || gf_uuid_is_null(loc->gfid) ||
+        (flags & O_CREAT) || posix_io_uring_xdata_sync(xdata))
+        return posix_open(frame, this, loc, flags, fd, xdata);
+
+    ctx = posix_io_uring_ctx_init_loc(frame, this, loc, GF_FOP_OPEN,
+                                      &op_errno, xdata);
+    if (!ctx) {
+        STACK_UNWIND_STRICT(open, frame, -1, op_errno, NULL, NULL);
+        return 0;
+    }
+    ctx->unwind = posix_io_uring_open_complete;
+    ctx->fd = fd_ref(fd);
+
+    /* The attributes are needed to update the ctime. */
+    if (posix_istat(this, loc->inode, loc->gfid, NULL,
+                    &ctx->fop.open.stbuf) != 0) {
+        op_errno = errno;
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_LSTAT_FAILED,
+               "lstat on gfid-handle %s (path: %s) failed", ctx->path,
+               loc->path);
+        STACK_UNWIND_STRICT(open, frame, -1, op_errno, NULL, NULL);
+        posix_io_uring_ctx_free(ctx);
+        return 0;
+    }
+
+    if (priv->o_direct)
+        flags |= O_DIRECT;
+    ctx->fop.open.flags = flags;
+
+    if (flags & O_TRUNC)
+        ctx->tracked = posix_ctree_begin(this, loc->inode, -1, ctx->path, 0,
+                                         UINT64_MAX);
+
+    timespec_now(&ctx->submitted);
+    gf_io_openat(posix_io_uring_cbk, AT_FDCWD, ctx->path, flags,
+                 priv->force_create_mode, ctx);
+    posix_io_uring_flush();
+
+    return 0;
+}
+
+/* Values of plain xattrs are read into a buffer of this size. Bigger ones
+ * are read again by the synchronous fop. */
+#define POSIX_IO_URING_XATTR_SIZE XATTR_VAL_BUF_SIZE
+
+static int
+posix_io_uring_xattr_init(struct posix_uring_ctx *ctx, const char *name,
+                          const void *value, uint32_t size, int32_t flags)
+{
+    ctx->fop.xattr.name = gf_strdup(name);
+    if (!ctx->fop.xattr.name)
+        return -1;
+
+    ctx->fop.xattr.value = GF_MALLOC(size + 1, gf_posix_mt_char);
+    if (!ctx->fop.xattr.value)
+        return -1;
+    if (value)
+        memcpy(ctx->fop.xattr.value, value, size);
+
+    ctx->fop.xattr.size = size;
+    ctx->fop.xattr.flags = flags;
+
+    return 0;
+}
+
+/* Build the dictionary returned by getxattr and fgetxattr. The value buffer
+ * is handed over to the dictionary. */
+static dict_t *
+posix_io_uring_xattr_dict(struct posix_uring_ctx *ctx, int32_t size,
+                          int32_t *op_errno)
+{
+    dict_t *dict = NULL;
     int ret = 0;
-    int32_t res = 0;
-    struct io_uring_cqe *cqe = NULL;
+
+    dict = dict_new();
+    if (!dict) {
+        *op_errno = ENOMEM;
+        return NULL;
+    }
+
+    ctx->fop.xattr.value[size] = '\0';
+    ret = dict_set_dynptr(dict, ctx->fop.xattr.name, ctx->fop.xattr.value,
+                          size);
+    if (ret < 0) {
+        *op_errno = -ret;
+        gf_msg(ctx->this->name, GF_LOG_ERROR, *op_errno, P_MSG_DICT_SET_FAILED,
+               "dict set operation for the key %s failed", ctx->fop.xattr.name);
+        dict_unref(dict);
+        return NULL;
+    }
+    ctx->fop.xattr.value = NULL;
+
+    return dict;
+}
+
+static void
+posix_io_uring_getxattr_log(struct posix_uring_ctx *ctx, int32_t op_errno)
+{
+    xlator_t *this = ctx->this;
+
+    if ((op_errno == ENOATTR) || (op_errno == ENODATA)) {
+        gf_msg_debug(this->name, 0, "No such attribute:%s for file %s",
+                     ctx->fop.xattr.name, ctx->path ?: "<fd>");
+    } else {
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_XATTR_FAILED,
+               "getxattr failed on %s: %s", ctx->path ?: "<fd>",
+               ctx->fop.xattr.name);
+    }
+}
+
+static void
+posix_io_uring_getxattr_complete(struct posix_uring_ctx *ctx, int32_t res)
+{
+    xlator_t *this = ctx->this;
+    dict_t *dict = NULL;
+    dict_t *xattr_rsp = NULL;
+    struct iatt buf = {
+        0,
+    };
+    int32_t op_ret = -1;
+    int32_t op_errno = 0;
+
+    if (res == -ERANGE) {
+        posix_getxattr(ctx->frame, this, &ctx->loc, ctx->fop.xattr.name,
+                       ctx->xdata);
+        posix_io_uring_ctx_free(ctx);
+        return;
+    }
+
+    if (res < 0) {
+        op_errno = -res;
+        posix_io_uring_getxattr_log(ctx, op_errno);
+        goto out;
+    }
+
+    dict = posix_io_uring_xattr_dict(ctx, res, &op_errno);
+    if (!dict)
+        goto out;
+
+    if (ctx->xdata)
+        xattr_rsp = posix_xattr_fill(this, ctx->path, &ctx->loc, NULL, -1,
+                                     ctx->xdata, &buf);
+
+    op_ret = res;
+
+out:
+    STACK_UNWIND_STRICT(getxattr, ctx->frame, op_ret, op_errno, dict,
+                        xattr_rsp);
+    if (xattr_rsp)
+        dict_unref(xattr_rsp);
+    if (dict)
+        dict_unref(dict);
+    posix_io_uring_ctx_free(ctx);
+}
+
+int
+posix_io_uring_getxattr(call_frame_t *frame, xlator_t *this, loc_t *loc,
+                        const char *name, dict_t *xdata)
+{
     struct posix_uring_ctx *ctx = NULL;
+    int32_t op_errno = ENOMEM;
 
-    this = data;
-    THIS = this;
-    priv = this->private;
-    while (1) {
-        pthread_mutex_lock(&priv->cq_mutex);
-        {
-            ret = io_uring_wait_cqe(&priv->ring, &cqe);
-        }
-        pthread_mutex_unlock(&priv->cq_mutex);
-        if (ret != 0) {
-            if (ret == -EINTR)
-                continue;
-            gf_msg(this->name, GF_LOG_WARNING, -ret, P_MSG_POSIX_IO_URING,
-                   "Unable to get cqe. Exiting.");
-            abort();
-        }
+    if (!posix_io_uring_creds_root(frame) ||
+        !posix_io_uring_xattr_plain(name) || !posix_io_uring_loc_plain(loc))
+        return posix_getxattr(frame, this, loc, name, xdata);
+
+    ctx = posix_io_uring_ctx_init_loc(frame, this, loc, GF_FOP_GETXATTR,
+                                      &op_errno, xdata);
+    if (!ctx || (posix_io_uring_xattr_init(ctx, name, NULL,
+                                           POSIX_IO_URING_XATTR_SIZE - 1,
+                                           0) != 0)) {
+        STACK_UNWIND_STRICT(getxattr, frame, -1, op_errno, NULL, NULL);
+        posix_io_uring_ctx_free(ctx);
+        return 0;
+    }
+    ctx->unwind = posix_io_uring_getxattr_complete;
+
+    timespec_now(&ctx->submitted);
+    gf_io_getxattr(posix_io_uring_cbk, -1, ctx->path, ctx->fop.xattr.name,
+                   ctx->fop.xattr.value, ctx->fop.xattr.size, ctx);
+    posix_io_uring_flush();
+
+    return 0;
+}
+
+static void
+posix_io_uring_fgetxattr_complete(struct posix_uring_ctx *ctx, int32_t res)
+{
+    xlator_t *this = ctx->this;
+    dict_t *dict = NULL;
+    dict_t *xattr_rsp = NULL;
+    struct iatt buf = {
+        0,
+    };
+    int32_t op_ret = -1;
+    int32_t op_errno = 0;
+
+    if (res == -ERANGE) {
+        posix_fgetxattr(ctx->frame, this, ctx->fd, ctx->fop.xattr.name,
+                        ctx->xdata);
+        posix_io_uring_ctx_free(ctx);
+        return;
+    }
 
-        ctx = (struct posix_uring_ctx *)io_uring_cqe_get_data(cqe);
-        if (priv->uring_thread_exit == _gf_true && ctx == NULL)
-            pthread_exit(NULL);
-        res = cqe->res;
-        io_uring_cqe_seen(&priv->ring, cqe);
-        ctx->unwind(ctx, res);
+    if (res < 0) {
+        op_errno = -res;
+        posix_io_uring_getxattr_log(ctx, op_errno);
+        goto out;
     }
 
-    return NULL;
+    dict = posix_io_uring_xattr_dict(ctx, res, &op_errno);
+    if (!dict)
+        goto out;
+
+    if (ctx->xdata)
+        xattr_rsp = posix_xattr_fill(this, NULL, NULL, ctx->fd, ctx->_fd,
+                                     ctx->xdata, &buf);
+
+    op_ret = res;
+
+out:
+    STACK_UNWIND_STRICT(fgetxattr, ctx->frame, op_ret, op_errno, dict,
+                        xattr_rsp);
+    if (xattr_rsp)
+        dict_unref(xattr_rsp);
+    if (dict)
+        dict_unref(dict);
+    posix_io_uring_ctx_free(ctx);
 }
 
 int
-posix_io_uring_init(xlator_t *this)
+posix_io_uring_fgetxattr(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                         const char *name, dict_t *xdata)
+{
+    struct posix_uring_ctx *ctx = NULL;
+    int32_t op_errno = ENOMEM;
+
+    if (!posix_io_uring_creds_root(frame) || !posix_io_uring_xattr_plain(name))
+        return posix_fgetxattr(frame, this, fd, name, xdata);
+
+    ctx = posix_io_uring_ctx_init(frame, this, fd, GF_FOP_FGETXATTR,
+                                  posix_io_uring_fgetxattr_complete, &op_errno,
+                                  xdata);
+    if (!ctx || (posix_io_uring_xattr_init(ctx, name, NULL,
+                                           POSIX_IO_URING_XATTR_SIZE - 1,
+                                           0) != 0)) {
+        STACK_UNWIND_STRICT(fgetxattr, frame, -1, op_errno, NULL, NULL);
+        posix_io_uring_ctx_free(ctx);
+        return 0;
+    }
+
+    timespec_now(&ctx->submitted);
+    gf_io_getxattr(posix_io_uring_cbk, ctx->_fd, NULL, ctx->fop.xattr.name,
+                   ctx->fop.xattr.value, ctx->fop.xattr.size, ctx);
+    posix_io_uring_flush();
+
+    return 0;
+}
+
+/* Only a single plain xattr is sent to io_uring. Anything else goes through
+ * the regular fop, which knows how to handle each special key. */
+static data_pair_t *
+posix_io_uring_setxattr_pair(call_frame_t *frame, xlator_t *this, dict_t *dict,
+                             dict_t *xdata)
 {
-    int ret = -1;
-    unsigned flags = 0;
     struct posix_private *priv = this->private;
+    data_pair_t *pair = NULL;
+
+    if (!posix_io_uring_creds_root(frame) || !dict || (dict->count != 1) ||
+        priv->disk_space_full || posix_io_uring_xdata_sync(xdata))
+        return NULL;
 
-    // TODO:Try-out flags |= IORING_SETUP_IOPOLL;
-    ret = io_uring_queue_init(POSIX_URING_MAX_ENTRIES, &priv->ring, flags);
-    if (ret == -1) {
-        gf_msg(this->name, GF_LOG_ERROR, 0, P_MSG_POSIX_IO_URING,
-               "io_uring init failed.");
+    pair = dict->members_list;
+    if (!pair || !posix_io_uring_xattr_plain(pair->key))
+        return NULL;
+
+    return pair;
+}
+
+static void
+posix_io_uring_setxattr_log(struct posix_uring_ctx *ctx, int32_t op_errno)
+{
+    gf_msg(ctx->this->name,
+           (op_errno == EEXIST) ? GF_LOG_DEBUG : GF_LOG_ERROR, op_errno,
+           P_MSG_XATTR_FAILED, "%s: key:%s flags: %u length:%u",
+           ctx->path ?: "<fd>", ctx->fop.xattr.name, ctx->fop.xattr.flags,
+           ctx->fop.xattr.size);
+}
+
+static void
+posix_io_uring_setxattr_complete(struct posix_uring_ctx *ctx, int32_t res)
+{
+    xlator_t *this = ctx->this;
+    struct iatt postop = {
+        0,
+    };
+    dict_t *xattr = NULL;
+    int32_t op_ret = -1;
+    int32_t op_errno = 0;
+
+    if (res < 0) {
+        op_errno = -res;
+        posix_io_uring_setxattr_log(ctx, op_errno);
         goto out;
     }
 
-    pthread_mutex_init(&priv->sq_mutex, NULL);
-    pthread_mutex_init(&priv->cq_mutex, NULL);
-    ret = gf_thread_create(&priv->uring_thread, NULL, posix_io_uring_thread,
-                           this, "posix-iouring");
-    if (ret != 0) {
-        io_uring_queue_exit(&priv->ring);
-        pthread_mutex_destroy(&priv->sq_mutex);
-        pthread_mutex_destroy(&priv->cq_mutex);
+    op_ret = 0;
+
+    posix_set_ctime(ctx->frame, this, ctx->path, -1, ctx->loc.inode, NULL);
+
+    /* Like in posix_setxattr(), failing to return the attributes is not an
+     * error. */
+    if (posix_pstat(this, ctx->loc.inode, ctx->loc.gfid, ctx->path, &postop,
+                    _gf_false) != 0)
+        goto out;
+
+    xattr = dict_new();
+    if (xattr)
+        posix_set_iatt_in_dict(xattr, &ctx->prebuf, &postop);
+
+out:
+    STACK_UNWIND_STRICT(setxattr, ctx->frame, op_ret, op_errno, xattr);
+    if (xattr)
+        dict_unref(xattr);
+    posix_io_uring_ctx_free(ctx);
+}
+
+int
+posix_io_uring_setxattr(call_frame_t *frame, xlator_t *this, loc_t *loc,
+                        dict_t *dict, int flags, dict_t *xdata)
+{
+    struct posix_uring_ctx *ctx = NULL;
+    data_pair_t *pair = NULL;
+    int32_t op_errno = ENOMEM;
+
+    pair = posix_io_uring_setxattr_pair(frame, this, dict, xdata);
+    if (!pair || !posix_io_uring_loc_plain(loc))
+        return posix_setxattr(frame, this, loc, dict, flags, xdata);
+
+    ctx = posix_io_uring_ctx_init_loc(frame, this, loc, GF_FOP_SETXATTR,
+                                      &op_errno, xdata);
+    if (!ctx || (posix_io_uring_xattr_init(ctx, pair->key, pair->value->data,
+                                           pair->value->len, flags) != 0)) {
+        STACK_UNWIND_STRICT(setxattr, frame, -1, op_errno, NULL);
+        posix_io_uring_ctx_free(ctx);
+        return 0;
+    }
+    ctx->unwind = posix_io_uring_setxattr_complete;
+
+    posix_pstat(this, loc->inode, loc->gfid, ctx->path, &ctx->prebuf,
+                _gf_false);
+
+    timespec_now(&ctx->submitted);
+    gf_io_setxattr(posix_io_uring_cbk, -1, ctx->path, ctx->fop.xattr.name,
+                   ctx->fop.xattr.value, ctx->fop.xattr.size,
+                   ctx->fop.xattr.flags, ctx);
+    posix_io_uring_flush();
+
+    return 0;
+}
+
+static void
+posix_io_uring_fsetxattr_complete(struct posix_uring_ctx *ctx, int32_t res)
+{
+    xlator_t *this = ctx->this;
+    struct iatt postop = {
+        0,
+    };
+    dict_t *xattr = NULL;
+    int32_t op_ret = -1;
+    int32_t op_errno = 0;
+
+    if (res < 0) {
+        op_errno = -res;
+        posix_io_uring_setxattr_log(ctx, op_errno);
+        goto out;
+    }
+
+    posix_set_ctime(ctx->frame, this, NULL, ctx->_fd, ctx->fd->inode, NULL);
+
+    if (posix_fdstat(this, ctx->fd->inode, ctx->_fd, &postop) != 0) {
+        op_errno = errno;
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_XATTR_FAILED,
+               "fsetxattr (fstat) failed on fd=%p", ctx->fd);
         goto out;
     }
 
+    op_ret = 0;
+
+    xattr = dict_new();
+    if (xattr)
+        posix_set_iatt_in_dict(xattr, &ctx->prebuf, &postop);
+
 out:
-    return ret;
+    STACK_UNWIND_STRICT(fsetxattr, ctx->frame, op_ret, op_errno, xattr);
+    if (xattr)
+        dict_unref(xattr);
+    posix_io_uring_ctx_free(ctx);
+}
+
+int
+posix_io_uring_fsetxattr(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                         dict_t *dict, int flags, dict_t *xdata)
+{
+    struct posix_uring_ctx *ctx = NULL;
+    data_pair_t *pair = NULL;
+    int32_t op_errno = ENOMEM;
+
+    pair = posix_io_uring_setxattr_pair(frame, this, dict, xdata);
+    if (!pair)
+        return posix_fsetxattr(frame, this, fd, dict, flags, xdata);
+
+    ctx = posix_io_uring_ctx_init(frame, this, fd, GF_FOP_FSETXATTR,
+                                  posix_io_uring_fsetxattr_complete, &op_errno,
+                                  xdata);
+    if (!ctx || (posix_io_uring_xattr_init(ctx, pair->key, pair->value->data,
+                                           pair->value->len, flags) != 0)) {
+        STACK_UNWIND_STRICT(fsetxattr, frame, -1, op_errno, NULL);
+        posix_io_uring_ctx_free(ctx);
+        return 0;
+    }
+
+    timespec_now(&ctx->submitted);
+    gf_io_setxattr(posix_io_uring_cbk, ctx->_fd, NULL, ctx->fop.xattr.name,
+                   ctx->fop.xattr.value, ctx->fop.xattr.size,
+                   ctx->fop.xattr.flags, ctx);
+    posix_io_uring_flush();
+
+    return 0;
+}
+
+static void
+posix_io_uring_fallocate_complete(struct posix_uring_ctx *ctx, int32_t res)
+{
+    xlator_t *this = ctx->this;
+    struct iatt postbuf = {
+        0,
+    };
+    int32_t op_ret = -1;
+    int32_t op_errno = 0;
+
+    if (ctx->tracked)
+        posix_ctree_end(this, ctx->fd->inode);
+
+    if (res < 0) {
+        op_errno = -res;
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_FALLOCATE_FAILED,
+               "fallocate failed on %s offset: %" PRId64 ", len:%zu, "
+               "flags: %d",
+               uuid_utoa(ctx->fd->inode->gfid),
+               (int64_t)ctx->fop.fallocate.offset, ctx->fop.fallocate.len,
+               ctx->fop.fallocate.mode);
+        goto out;
+    }
+
+    if (posix_fdstat(this, ctx->fd->inode, ctx->_fd, &postbuf) != 0) {
+        op_errno = errno;
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_FSTAT_FAILED,
+               "fallocate (fstat) failed on fd=%p", ctx->fd);
+        goto out;
+    }
+
+    posix_set_ctime(ctx->frame, this, NULL, ctx->_fd, ctx->fd->inode,
+                    &postbuf);
+
+    op_ret = 0;
+
+out:
+    if (ctx->op == GF_FOP_DISCARD) {
+        STACK_UNWIND_STRICT(discard, ctx->frame, op_ret, op_errno,
+                            op_ret ? NULL : &ctx->prebuf,
+                            op_ret ? NULL : &postbuf, NULL);
+    } else {
+        STACK_UNWIND_STRICT(fallocate, ctx->frame, op_ret, op_errno,
+                            op_ret ? NULL : &ctx->prebuf,
+                            op_ret ? NULL : &postbuf, NULL);
+    }
+    posix_io_uring_ctx_free(ctx);
+}
+
+/* When the reserved space is exhausted, posix_do_fallocate() decides if
+ * the request can still be done, so it's used in that case. */
+static gf_boolean_t
+posix_io_uring_fallocate_sync(xlator_t *this, dict_t *xdata)
+{
+    struct posix_private *priv = this->private;
+
+    if (priv->disk_reserve)
+        posix_disk_space_check(priv);
+
+    return priv->disk_space_full || posix_io_uring_xdata_sync(xdata);
 }
 
 static int
-posix_io_uring_drain(struct posix_private *priv)
+posix_io_uring_do_fallocate(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                            int op, int32_t mode, off_t offset, size_t len,
+                            dict_t *xdata)
 {
-    struct io_uring_sqe *sqe = NULL;
-    int ret = -1;
+    struct posix_uring_ctx *ctx = NULL;
+    int32_t op_errno = ENOMEM;
+
+    ctx = posix_io_uring_ctx_init(frame, this, fd, op,
+                                  posix_io_uring_fallocate_complete, &op_errno,
+                                  xdata);
+    if (!ctx)
+        return -op_errno;
 
-    priv->uring_thread_exit = _gf_true;
-    sqe = io_uring_get_sqe(&priv->ring);
-    if (!sqe)
-        return ret;
+    ctx->fop.fallocate.mode = mode;
+    ctx->fop.fallocate.offset = offset;
+    ctx->fop.fallocate.len = len;
 
-    io_uring_sqe_set_flags(sqe, IOSQE_IO_DRAIN);
-    io_uring_sqe_set_data(sqe, NULL);
-    io_uring_prep_nop(sqe);
-    ret = io_uring_submit(&priv->ring);
+    ctx->tracked = posix_ctree_begin(this, fd->inode, ctx->_fd, NULL, offset,
+                                     len);
 
-    return ret;
+    timespec_now(&ctx->submitted);
+    gf_io_fallocate(posix_io_uring_cbk, ctx->_fd, mode, offset, len, ctx);
+    posix_io_uring_flush();
+
+    return 0;
+}
+
+int
+posix_io_uring_fallocate(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                         int32_t keep_size, off_t offset, size_t len,
+                         dict_t *xdata)
+{
+    int ret = 0;
+
+    if (posix_io_uring_fallocate_sync(this, xdata))
+        return posix_glfallocate(frame, this, fd, keep_size, offset, len,
+                                 xdata);
+
+    ret = posix_io_uring_do_fallocate(frame, this, fd, GF_FOP_FALLOCATE,
+                                      keep_size ? FALLOC_FL_KEEP_SIZE : 0,
+                                      offset, len, xdata);
+    if (ret < 0)
+        STACK_UNWIND_STRICT(fallocate, frame, -1, -ret, NULL, NULL, NULL);
+
+    return 0;
+}
+
+int
+posix_io_uring_discard(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                       off_t offset, size_t len, dict_t *xdata)
+{
+    int ret = 0;
+
+    if (posix_io_uring_fallocate_sync(this, xdata))
+        return posix_discard(frame, this, fd, offset, len, xdata);
+
+    ret = posix_io_uring_do_fallocate(
+        frame, this, fd, GF_FOP_DISCARD,
+        FALLOC_FL_KEEP_SIZE | FALLOC_FL_PUNCH_HOLE, offset, len, xdata);
+    if (ret < 0)
+        STACK_UNWIND_STRICT(discard, frame, -1, -ret, NULL, NULL, NULL);
+
+    return 0;
 }
 
 void
-posix_io_uring_fini(xlator_t *this)
+posix_io_uring_dump(xlator_t *this)
 {
     struct posix_private *priv = this->private;
+    struct posix_uring_stats *stats = NULL;
+    char key[GF_DUMP_MAX_BUF_LEN];
+    int64_t count = 0;
+    int i = 0;
+
+    gf_proc_dump_write("io_uring_capable", "%d", priv->io_uring_capable);
+    if (!priv->io_uring_capable)
+        return;
 
-    posix_io_uring_drain(priv);
-    (void)pthread_join(priv->uring_thread, NULL);
-    io_uring_queue_exit(&priv->ring);
-    pthread_mutex_destroy(&priv->sq_mutex);
-    pthread_mutex_destroy(&priv->cq_mutex);
+    for (i = 0; i < GF_FOP_MAXVALUE; i++) {
+        stats = &priv->uring_stats[i];
+        count = GF_ATOMIC_GET(stats->count);
+        if (count == 0)
+            continue;
+
+        gf_proc_dump_build_key(key, "io_uring", "%s", gf_fop_list[i]);
+        gf_proc_dump_write(key,
+                           "CNT:%" PRId64 " FIXED:%" PRId64
+                           " SUBMIT_AVG:%lf COMPLETE_AVG:%lf",
+                           count, GF_ATOMIC_GET(stats->fixed),
+                           (double)GF_ATOMIC_GET(stats->submit_ns) / count,
+                           (double)GF_ATOMIC_GET(stats->complete_ns) / count);
+    }
 }
 
 int
@@ -576,15 +1502,31 @@ posix_io_uring_on(xlator_t *this)
 {
     struct posix_private *priv = NULL;
     int ret = -1;
+    int i = 0;
 
     priv = this->private;
 
     if (!priv->io_uring_init_done) {
-        ret = posix_io_uring_init(this);
-        if (ret == 0)
-            priv->io_uring_capable = _gf_true;
-        else
-            priv->io_uring_capable = _gf_false;
+        /* Requests are sent through the I/O framework of the process. It
+         * only makes sense to use it if it's backed by io_uring. Otherwise
+         * they would be processed synchronously anyway. */
+        priv->io_uring_capable = (gf_io_mode() == GF_IO_MODE_IO_URING);
+        for (i = 0; i < GF_FOP_MAXVALUE; i++) {
+            GF_ATOMIC_INIT(priv->uring_stats[i].count, 0);
+            GF_ATOMIC_INIT(priv->uring_stats[i].submit_ns, 0);
+            GF_ATOMIC_INIT(priv->uring_stats[i].complete_ns, 0);
+            GF_ATOMIC_INIT(priv->uring_stats[i].fixed, 0);
+        }
+        /* Failing to register the iobuf arenas is not fatal. Reads and
+         * writes will just use regular requests. */
+        if (priv->io_uring_capable) {
+            ret = iobuf_pool_register(this->ctx->iobuf_pool);
+            if (ret < 0)
+                gf_msg(this->name, GF_LOG_INFO, -ret, P_MSG_POSIX_IO_URING,
+                       "iobuf arenas could not be registered, fixed "
+                       "buffers won't be used.");
+            ret = -1;
+        }
         priv->io_uring_init_done = _gf_true;
     }
 
@@ -592,13 +1534,34 @@ posix_io_uring_on(xlator_t *this)
         this->fops->readv = posix_io_uring_readv;
         this->fops->writev = posix_io_uring_writev;
         this->fops->fsync = posix_io_uring_fsync;
+
+        /* Each of the other fops is only sent to io_uring if the kernel
+         * supports its opcode. Otherwise the regular fop is kept. */
+        if (gf_io_supported(gf_io.engine.statx)) {
+            this->fops->stat = posix_io_uring_stat;
+            this->fops->fstat = posix_io_uring_fstat;
+        }
+        if (gf_io_supported(gf_io.engine.openat))
+            this->fops->open = posix_io_uring_open;
+        if (gf_io_supported(gf_io.engine.getxattr)) {
+            this->fops->getxattr = posix_io_uring_getxattr;
+            this->fops->fgetxattr = posix_io_uring_fgetxattr;
+        }
+        if (gf_io_supported(gf_io.engine.setxattr)) {
+            this->fops->setxattr = posix_io_uring_setxattr;
+            this->fops->fsetxattr = posix_io_uring_fsetxattr;
+        }
+        if (gf_io_supported(gf_io.engine.fallocate)) {
+            this->fops->fallocate = posix_io_uring_fallocate;
+            this->fops->discard = posix_io_uring_discard;
+        }
         ret = 0;
     }
 
     if (ret != 0) {
         gf_msg(this->name, GF_LOG_WARNING, 0, P_MSG_POSIX_IO_URING,
-               "Posix io_uring init failed, falling back to the previous "
-               "IO mechanism.");
+               "I/O framework is not using io_uring, falling back to the "
+               "previous IO mechanism.");
     }
     return ret;
 }
@@ -606,13 +1569,18 @@ posix_io_uring_on(xlator_t *this)
 int
 posix_io_uring_off(xlator_t *this)
 {
-    struct posix_private *priv = this->private;
-
     this->fops->readv = posix_readv;
     this->fops->writev = posix_writev;
     this->fops->fsync = posix_fsync;
-    if (priv->io_uring_capable)
-        posix_io_uring_fini(this);
+    this->fops->stat = posix_stat;
+    this->fops->fstat = posix_fstat;
+    this->fops->open = posix_open;
+    this->fops->getxattr = posix_getxattr;
+    this->fops->fgetxattr = posix_fgetxattr;
+    this->fops->setxattr = posix_setxattr;
+    this->fops->fsetxattr = posix_fsetxattr;
+    this->fops->fallocate = posix_glfallocate;
+    this->fops->discard = posix_discard;
 
     return 0;
 }
@@ -633,4 +1601,9 @@ posix_io_uring_off(xlator_t *this)
     return 0;
 }
 
+void
+posix_io_uring_dump(xlator_t *this)
+{
+}
+
 #endif
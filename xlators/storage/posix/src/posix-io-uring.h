@@ -10,22 +10,13 @@
 #ifndef _POSIX_IO_URING_H
 #define _POSIX_IO_URING_H
 
-#define POSIX_URING_MAX_ENTRIES 512
 int
 posix_io_uring_on(xlator_t *this);
 
 int
 posix_io_uring_off(xlator_t *this);
 
-#ifdef HAVE_LIBURING
-int
-posix_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
-            off_t offset, uint32_t flags, dict_t *xdata);
-
-int
-posix_writev(call_frame_t *frame, xlator_t *this, fd_t *fd,
-             struct iovec *vector, int32_t count, off_t offset, uint32_t flags,
-             struct iobref *iobref, dict_t *xdata);
-#endif
+void
+posix_io_uring_dump(xlator_t *this);
 
 #endif /* _POSIX_IO_URING_H */
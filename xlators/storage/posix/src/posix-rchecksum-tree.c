@@ -0,0 +1,825 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/* Checksums of the leaves of the files, kept so that the rchecksum of a range
+ * of a big file, as asked for by the diff data self-heal, only reads the
+ * leaves which changed since it was last asked for.
+ *
+ * The leaves are the GF_RCHECKSUM_TREE_LEAF_SIZE blocks of a file, padded with
+ * zeroes past its end, so that growing a file doesn't change any of them. The
+ * checksum of each one is computed the first time it's asked for and kept in
+ * POSIX_CTREE_PATH/<gfid>, after a header, a zeroed one standing for a leaf
+ * whose checksum has to be computed again. Every change to the data of a file
+ * zeroes the checksums of the leaves it changes before being done, and an
+ * rchecksum only keeps the checksum of a leaf if no change was in progress or
+ * done while reading it.
+ *
+ * The header tells whether the checksums can be trusted when loaded again. If
+ * the file isn't being changed, they are as long as its size and mtime are the
+ * ones in the header. If it is, they are until the node reboots, the zeroes
+ * written in the page cache being lost then. */
+
+#include <openssl/md5.h>
+#include <openssl/sha.h>
+#include <ftw.h>
+#include <fcntl.h>
+
+#include <glusterfs/checksum.h>
+#include <glusterfs/common-utils.h>
+#include <glusterfs/iobuf.h>
+#include <glusterfs/syscall.h>
+
+#include "posix.h"
+#include "posix-messages.h"
+#include "posix-mem-types.h"
+
+#define POSIX_CTREE_MAGIC 0x47464354 /* GFCT */
+#define POSIX_CTREE_VERSION 1
+#define POSIX_CTREE_DIRTY 0x1
+#define POSIX_CTREE_HEADER_SIZE 64
+
+/* Number of checksums read at once from the file */
+#define POSIX_CTREE_CHUNK 4096
+
+#define POSIX_CTREE_ALIGN 4096
+
+struct posix_ctree_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t digest_len;
+    uint32_t leaf_size;
+    uint32_t flags;
+    uint64_t size;
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+    unsigned char boot_id[16];
+};
+
+struct posix_ctree {
+    int fd;
+    uint32_t digest_len;
+    gf_boolean_t dirty;
+    /* Checksums in the file, the zeroed ones included */
+    uint64_t leaves;
+    /* Leaves whose checksum is known to be zeroed in the file */
+    uint64_t *stale;
+    uint64_t stale_size;
+};
+
+static const char posix_ctree_zeroes[4096];
+
+static uint32_t
+posix_ctree_digest_len(struct posix_private *priv)
+{
+    return priv->fips_mode_rchecksum ? SHA256_DIGEST_LENGTH
+                                     : MD5_DIGEST_LENGTH;
+}
+
+static void
+posix_ctree_hash(uint32_t digest_len, unsigned char *data, size_t len,
+                 unsigned char *digest)
+{
+    if (digest_len == SHA256_DIGEST_LENGTH)
+        gf_rsync_strong_checksum(data, len, digest);
+    else
+        gf_rsync_md5_checksum(data, len, digest);
+}
+
+static void
+posix_ctree_path(xlator_t *this, uuid_t gfid, char *path, size_t size)
+{
+    char gfid_str[64] = {0};
+
+    snprintf(path, size, "%s/%s/%s", POSIX_BASE_PATH(this), POSIX_CTREE_PATH,
+             uuid_utoa_r(gfid, gfid_str));
+}
+
+static gf_boolean_t
+__posix_ctree_is_stale(struct posix_ctree *tree, uint64_t leaf)
+{
+    if (leaf >= tree->stale_size)
+        return _gf_false;
+
+    return (tree->stale[leaf / 64] >> (leaf % 64)) & 1;
+}
+
+/* Only an optimization, a leaf not known to be stale being checked in the
+ * file, so failing to grow the bitmap isn't an error. */
+static void
+__posix_ctree_set_stale(struct posix_ctree *tree, uint64_t leaf,
+                        gf_boolean_t stale)
+{
+    uint64_t *bitmap = NULL;
+    uint64_t size = 0;
+
+    if (leaf >= tree->stale_size) {
+        if (!stale)
+            return;
+        size = max(tree->stale_size * 2, (leaf / 64 + 1) * 64);
+        if (tree->stale)
+            bitmap = GF_REALLOC(tree->stale, size / 8);
+        else
+            bitmap = GF_MALLOC(size / 8, gf_posix_mt_ctree);
+        if (!bitmap)
+            return;
+        memset(bitmap + tree->stale_size / 64, 0,
+               (size - tree->stale_size) / 8);
+        tree->stale = bitmap;
+        tree->stale_size = size;
+    }
+
+    if (stale)
+        tree->stale[leaf / 64] |= 1ULL << (leaf % 64);
+    else
+        tree->stale[leaf / 64] &= ~(1ULL << (leaf % 64));
+}
+
+void
+posix_ctree_free(struct posix_ctree *tree)
+{
+    if (!tree)
+        return;
+
+    sys_close(tree->fd);
+    GF_FREE(tree->stale);
+    GF_FREE(tree);
+}
+
+static void
+__posix_ctree_reset(posix_inode_ctx_t *ctx)
+{
+    posix_ctree_free(ctx->ctree);
+    ctx->ctree = NULL;
+    ctx->ctree_state = POSIX_CTREE_UNKNOWN;
+    ctx->ctree_gen++;
+}
+
+/* Called when the checksums can't be kept in sync with the data anymore */
+static void
+__posix_ctree_drop(xlator_t *this, posix_inode_ctx_t *ctx, uuid_t gfid)
+{
+    char path[PATH_MAX];
+
+    /* Not trusted anymore even if it can't be removed */
+    if (ctx->ctree)
+        sys_pwrite(ctx->ctree->fd, posix_ctree_zeroes,
+                   POSIX_CTREE_HEADER_SIZE, 0);
+    __posix_ctree_reset(ctx);
+    ctx->ctree_state = POSIX_CTREE_NONE;
+
+    posix_ctree_path(this, gfid, path, sizeof(path));
+    if (sys_unlink(path) && (errno != ENOENT))
+        gf_msg(this->name, GF_LOG_WARNING, errno, P_MSG_RCHECKSUM_TREE_FAILED,
+               "failed to remove %s", path);
+}
+
+static int
+posix_ctree_write_header(xlator_t *this, struct posix_ctree *tree,
+                         uint32_t flags, struct stat *stbuf)
+{
+    struct posix_private *priv = this->private;
+    struct posix_ctree_header header = {
+        0,
+    };
+    char buf[POSIX_CTREE_HEADER_SIZE] = {
+        0,
+    };
+
+    header.magic = POSIX_CTREE_MAGIC;
+    header.version = POSIX_CTREE_VERSION;
+    header.digest_len = tree->digest_len;
+    header.leaf_size = GF_RCHECKSUM_TREE_LEAF_SIZE;
+    header.flags = flags;
+    if (flags & POSIX_CTREE_DIRTY) {
+        memcpy(header.boot_id, priv->boot_id, sizeof(header.boot_id));
+    } else {
+        header.size = stbuf->st_size;
+        header.mtime_sec = stbuf->st_mtime;
+        header.mtime_nsec = ST_MTIM_NSEC(stbuf);
+    }
+    memcpy(buf, &header, sizeof(header));
+
+    if (sys_pwrite(tree->fd, buf, sizeof(buf), 0) != sizeof(buf))
+        return -1;
+
+    return 0;
+}
+
+static gf_boolean_t
+posix_ctree_header_valid(xlator_t *this, struct posix_ctree_header *header,
+                         int fd, const char *path)
+{
+    struct posix_private *priv = this->private;
+    struct stat stbuf;
+    int ret;
+
+    if ((header->magic != POSIX_CTREE_MAGIC) ||
+        (header->version != POSIX_CTREE_VERSION) ||
+        (header->digest_len != posix_ctree_digest_len(priv)) ||
+        (header->leaf_size != GF_RCHECKSUM_TREE_LEAF_SIZE))
+        return _gf_false;
+
+    if (header->flags & POSIX_CTREE_DIRTY)
+        return !gf_uuid_is_null(priv->boot_id) &&
+               !memcmp(header->boot_id, priv->boot_id,
+                       sizeof(header->boot_id));
+
+    if (fd >= 0)
+        ret = sys_fstat(fd, &stbuf);
+    else
+        ret = sys_stat(path, &stbuf);
+
+    return !ret && (stbuf.st_size == header->size) &&
+           (stbuf.st_mtime == header->mtime_sec) &&
+           (ST_MTIM_NSEC(&stbuf) == header->mtime_nsec);
+}
+
+static void
+__posix_ctree_load(xlator_t *this, posix_inode_ctx_t *ctx, uuid_t gfid, int fd,
+                   const char *path)
+{
+    struct posix_ctree_header header;
+    struct posix_ctree *tree = NULL;
+    char buf[POSIX_CTREE_HEADER_SIZE];
+    char tree_path[PATH_MAX];
+    struct stat stbuf;
+    int tree_fd;
+
+    ctx->ctree_state = POSIX_CTREE_NONE;
+
+    posix_ctree_path(this, gfid, tree_path, sizeof(tree_path));
+    tree_fd = sys_open(tree_path, O_RDWR, 0);
+    if (tree_fd < 0) {
+        if (errno != ENOENT)
+            gf_msg(this->name, GF_LOG_WARNING, errno,
+                   P_MSG_RCHECKSUM_TREE_FAILED, "failed to open %s",
+                   tree_path);
+        return;
+    }
+
+    if (sys_pread(tree_fd, buf, sizeof(buf), 0) != sizeof(buf))
+        goto drop;
+    memcpy(&header, buf, sizeof(header));
+    if (!posix_ctree_header_valid(this, &header, fd, path)) {
+        gf_msg_debug(this->name, 0, "%s is out of date", tree_path);
+        goto drop;
+    }
+    if (sys_fstat(tree_fd, &stbuf))
+        goto drop;
+
+    tree = GF_CALLOC(1, sizeof(*tree), gf_posix_mt_ctree);
+    if (!tree)
+        goto drop;
+    tree->fd = tree_fd;
+    tree->digest_len = header.digest_len;
+    tree->dirty = !!(header.flags & POSIX_CTREE_DIRTY);
+    if (stbuf.st_size > POSIX_CTREE_HEADER_SIZE)
+        tree->leaves = (stbuf.st_size - POSIX_CTREE_HEADER_SIZE) /
+                       tree->digest_len;
+
+    ctx->ctree = tree;
+    ctx->ctree_state = POSIX_CTREE_LOADED;
+    return;
+
+drop:
+    /* The data is about to change, the checksums can't stay */
+    sys_close(tree_fd);
+    if (sys_unlink(tree_path) && (errno != ENOENT))
+        gf_msg(this->name, GF_LOG_WARNING, errno, P_MSG_RCHECKSUM_TREE_FAILED,
+               "failed to remove %s", tree_path);
+}
+
+static void
+__posix_ctree_get(xlator_t *this, posix_inode_ctx_t *ctx, uuid_t gfid, int fd,
+                  const char *path)
+{
+    struct posix_private *priv = this->private;
+
+    if (ctx->ctree_epoch != priv->rchecksum_tree_epoch) {
+        __posix_ctree_reset(ctx);
+        ctx->ctree_epoch = priv->rchecksum_tree_epoch;
+    }
+
+    if (ctx->ctree_state == POSIX_CTREE_UNKNOWN)
+        __posix_ctree_load(this, ctx, gfid, fd, path);
+}
+
+static void
+__posix_ctree_create(xlator_t *this, posix_inode_ctx_t *ctx, uuid_t gfid,
+                     int fd)
+{
+    struct posix_ctree *tree = NULL;
+    char tree_path[PATH_MAX];
+    struct stat stbuf;
+
+    posix_ctree_path(this, gfid, tree_path, sizeof(tree_path));
+
+    tree = GF_CALLOC(1, sizeof(*tree), gf_posix_mt_ctree);
+    if (!tree)
+        return;
+    tree->digest_len = posix_ctree_digest_len(this->private);
+    tree->fd = sys_open(tree_path, O_CREAT | O_TRUNC | O_RDWR, 0600);
+    if (tree->fd < 0) {
+        gf_msg(this->name, GF_LOG_WARNING, errno, P_MSG_RCHECKSUM_TREE_FAILED,
+               "failed to create %s", tree_path);
+        GF_FREE(tree);
+        return;
+    }
+
+    if (sys_fstat(fd, &stbuf) ||
+        posix_ctree_write_header(this, tree, 0, &stbuf)) {
+        gf_msg(this->name, GF_LOG_WARNING, errno, P_MSG_RCHECKSUM_TREE_FAILED,
+               "failed to initialize %s", tree_path);
+        posix_ctree_free(tree);
+        sys_unlink(tree_path);
+        return;
+    }
+
+    ctx->ctree = tree;
+    ctx->ctree_state = POSIX_CTREE_LOADED;
+}
+
+/* Zeroes the checksums of the leaves from first to end, end excluded */
+static int
+__posix_ctree_mark_stale(struct posix_ctree *tree, uint64_t first,
+                         uint64_t end)
+{
+    uint32_t digest_len = tree->digest_len;
+    uint64_t leaf;
+    uint64_t run;
+
+    if (end >= tree->leaves) {
+        if (first < tree->leaves) {
+            if (sys_ftruncate(tree->fd,
+                              POSIX_CTREE_HEADER_SIZE + first * digest_len))
+                return -1;
+            tree->leaves = first;
+        }
+        end = tree->leaves;
+    }
+
+    leaf = first;
+    while (leaf < end) {
+        if (__posix_ctree_is_stale(tree, leaf)) {
+            leaf++;
+            continue;
+        }
+        run = leaf + 1;
+        while ((run < end) && !__posix_ctree_is_stale(tree, run) &&
+               ((run - leaf + 1) * digest_len <= sizeof(posix_ctree_zeroes)))
+            run++;
+        if (sys_pwrite(tree->fd, posix_ctree_zeroes, (run - leaf) * digest_len,
+                       POSIX_CTREE_HEADER_SIZE + leaf * digest_len) !=
+            (run - leaf) * digest_len)
+            return -1;
+        for (; leaf < run; leaf++)
+            __posix_ctree_set_stale(tree, leaf, _gf_true);
+    }
+
+    return 0;
+}
+
+/* The zeroes written from now on have to be known to be lost if the node
+ * reboots before they get to the disk. */
+static int
+posix_ctree_set_dirty(xlator_t *this, struct posix_ctree *tree)
+{
+    if (posix_ctree_write_header(this, tree, POSIX_CTREE_DIRTY, NULL) ||
+        sys_fdatasync(tree->fd))
+        return -1;
+
+    tree->dirty = _gf_true;
+
+    return 0;
+}
+
+gf_boolean_t
+posix_ctree_begin(xlator_t *this, inode_t *inode, int fd, const char *path,
+                  off_t offset, uint64_t len)
+{
+    struct posix_private *priv = this->private;
+    posix_inode_ctx_t *ctx = NULL;
+    struct posix_ctree *tree = NULL;
+    char tree_path[PATH_MAX];
+    uint64_t first;
+    uint64_t end;
+
+    if (!priv->rchecksum_tree)
+        return _gf_false;
+
+    if (posix_inode_ctx_get_all(inode, this, &ctx)) {
+        /* Can't be tracked, the checksums can't stay */
+        posix_ctree_path(this, inode->gfid, tree_path, sizeof(tree_path));
+        sys_unlink(tree_path);
+        return _gf_false;
+    }
+
+    pthread_mutex_lock(&ctx->ctree_lock);
+    {
+        __posix_ctree_get(this, ctx, inode->gfid, fd, path);
+        ctx->ctree_writers++;
+        ctx->ctree_gen++;
+
+        tree = ctx->ctree;
+        if (tree && len) {
+            first = offset / GF_RCHECKSUM_TREE_LEAF_SIZE;
+            if (len > UINT64_MAX - offset)
+                end = UINT64_MAX;
+            else
+                end = (offset + len - 1) / GF_RCHECKSUM_TREE_LEAF_SIZE + 1;
+
+            if ((!tree->dirty && posix_ctree_set_dirty(this, tree)) ||
+                __posix_ctree_mark_stale(tree, first, end)) {
+                gf_msg(this->name, GF_LOG_WARNING, errno,
+                       P_MSG_RCHECKSUM_TREE_FAILED,
+                       "failed to update the checksums of %s, dropping them",
+                       uuid_utoa(inode->gfid));
+                __posix_ctree_drop(this, ctx, inode->gfid);
+            }
+        }
+    }
+    pthread_mutex_unlock(&ctx->ctree_lock);
+
+    return _gf_true;
+}
+
+void
+posix_ctree_end(xlator_t *this, inode_t *inode)
+{
+    posix_inode_ctx_t *ctx = NULL;
+
+    /* Already there since posix_ctree_begin() */
+    if (posix_inode_ctx_get_all(inode, this, &ctx))
+        return;
+
+    pthread_mutex_lock(&ctx->ctree_lock);
+    {
+        ctx->ctree_writers--;
+        ctx->ctree_gen++;
+    }
+    pthread_mutex_unlock(&ctx->ctree_lock);
+}
+
+void
+posix_ctree_invalidate(xlator_t *this, inode_table_t *table, uuid_t gfid)
+{
+    struct posix_private *priv = this->private;
+    posix_inode_ctx_t *ctx = NULL;
+    inode_t *inode = NULL;
+    char tree_path[PATH_MAX];
+
+    if (!priv->rchecksum_tree)
+        return;
+
+    inode = table ? inode_find(table, gfid) : NULL;
+    if (inode && !posix_inode_ctx_get_all(inode, this, &ctx)) {
+        pthread_mutex_lock(&ctx->ctree_lock);
+        {
+            __posix_ctree_drop(this, ctx, gfid);
+        }
+        pthread_mutex_unlock(&ctx->ctree_lock);
+    } else {
+        posix_ctree_path(this, gfid, tree_path, sizeof(tree_path));
+        sys_unlink(tree_path);
+    }
+
+    if (inode)
+        inode_unref(inode);
+}
+
+void
+posix_ctree_remove(xlator_t *this, uuid_t gfid)
+{
+    struct posix_private *priv = this->private;
+    char tree_path[PATH_MAX];
+
+    if (!priv->rchecksum_tree)
+        return;
+
+    posix_ctree_path(this, gfid, tree_path, sizeof(tree_path));
+    if (sys_unlink(tree_path) && (errno != ENOENT))
+        gf_msg(this->name, GF_LOG_WARNING, errno, P_MSG_RCHECKSUM_TREE_FAILED,
+               "failed to remove %s", tree_path);
+}
+
+/* Marks the checksums as in sync with the data again when a file gets closed
+ * while nothing changes it, once both are on the disk. The lock isn't held
+ * while syncing: any change meanwhile bumps the generation, and the file is
+ * then left dirty. Checksums written meanwhile don't need to be synced, as a
+ * lost one only needs to be computed again. */
+void
+posix_ctree_release(xlator_t *this, inode_t *inode, int fd)
+{
+    struct posix_private *priv = this->private;
+    posix_inode_ctx_t *ctx = NULL;
+    struct posix_ctree *tree = NULL;
+    struct stat stbuf;
+    uint64_t gen = 0;
+    int tree_fd = -1;
+
+    if (!priv->rchecksum_tree || posix_inode_ctx_get_all(inode, this, &ctx))
+        return;
+
+    pthread_mutex_lock(&ctx->ctree_lock);
+    {
+        tree = ctx->ctree;
+        if (tree && tree->dirty && !ctx->ctree_writers &&
+            (ctx->ctree_epoch == priv->rchecksum_tree_epoch)) {
+            gen = ctx->ctree_gen;
+            tree_fd = dup(tree->fd);
+        }
+    }
+    pthread_mutex_unlock(&ctx->ctree_lock);
+
+    if (tree_fd < 0)
+        return;
+
+    if (sys_fdatasync(fd) || sys_fdatasync(tree_fd))
+        goto out;
+
+    pthread_mutex_lock(&ctx->ctree_lock);
+    {
+        tree = ctx->ctree;
+        if (tree && tree->dirty && (gen == ctx->ctree_gen) &&
+            (ctx->ctree_epoch == priv->rchecksum_tree_epoch) &&
+            !sys_fstat(fd, &stbuf) &&
+            !posix_ctree_write_header(this, tree, 0, &stbuf))
+            tree->dirty = _gf_false;
+    }
+    pthread_mutex_unlock(&ctx->ctree_lock);
+
+out:
+    sys_close(tree_fd);
+}
+
+static int
+posix_ctree_read_leaf(int fd, uint64_t leaf, char *buf)
+{
+    ssize_t bytes;
+
+    bytes = sys_pread(fd, buf, GF_RCHECKSUM_TREE_LEAF_SIZE,
+                      leaf * GF_RCHECKSUM_TREE_LEAF_SIZE);
+    if (bytes < 0)
+        return -errno;
+    memset(buf + bytes, 0, GF_RCHECKSUM_TREE_LEAF_SIZE - bytes);
+
+    return 0;
+}
+
+/* Fills the checksums of the leaves from first to end, end excluded, which
+ * are known and zeroes the ones of the others. */
+static void
+posix_ctree_read_known(posix_inode_ctx_t *ctx, uint32_t digest_len,
+                       uint64_t first, uint64_t end, unsigned char *digests)
+{
+    struct posix_ctree *tree = NULL;
+    uint64_t known = 0;
+    uint64_t leaf;
+
+    pthread_mutex_lock(&ctx->ctree_lock);
+    {
+        tree = ctx->ctree;
+        if (tree && (tree->digest_len == digest_len) &&
+            (first < tree->leaves)) {
+            known = min(end, tree->leaves) - first;
+            if (sys_pread(tree->fd, digests, known * digest_len,
+                          POSIX_CTREE_HEADER_SIZE + first * digest_len) !=
+                known * digest_len)
+                known = 0;
+            for (leaf = first; leaf < first + known; leaf++) {
+                if (__posix_ctree_is_stale(tree, leaf))
+                    memset(digests + (leaf - first) * digest_len, 0,
+                           digest_len);
+            }
+        }
+    }
+    pthread_mutex_unlock(&ctx->ctree_lock);
+
+    if (known < end - first)
+        memset(digests + known * digest_len, 0,
+               (end - first - known) * digest_len);
+}
+
+int
+posix_ctree_checksum(xlator_t *this, fd_t *fd, int _fd, off_t offset,
+                     uint64_t len, unsigned char *checksum)
+{
+    struct posix_private *priv = this->private;
+    posix_inode_ctx_t *ctx = NULL;
+    struct posix_ctree *tree = NULL;
+    unsigned char *digests = NULL;
+    unsigned char *digest = NULL;
+    char *alloc_buf = NULL;
+    char *buf = NULL;
+    uint32_t digest_len = posix_ctree_digest_len(priv);
+    uint32_t writers;
+    uint64_t first;
+    uint64_t end;
+    uint64_t leaf;
+    uint64_t chunk;
+    uint64_t gen;
+    struct stat stbuf;
+    int ret = 0;
+
+    if ((offset % GF_RCHECKSUM_TREE_LEAF_SIZE) ||
+        (len > (uint64_t)GF_RCHECKSUM_TREE_LEAF_SIZE *
+                   GF_RCHECKSUM_TREE_MAX_LEAVES))
+        return -EINVAL;
+
+    if (sys_fstat(_fd, &stbuf))
+        return -errno;
+
+    first = offset / GF_RCHECKSUM_TREE_LEAF_SIZE;
+    end = min((offset + len + GF_RCHECKSUM_TREE_LEAF_SIZE - 1) /
+                  GF_RCHECKSUM_TREE_LEAF_SIZE,
+              (stbuf.st_size + GF_RCHECKSUM_TREE_LEAF_SIZE - 1) /
+                  GF_RCHECKSUM_TREE_LEAF_SIZE);
+    if (end <= first) {
+        posix_ctree_hash(digest_len, (unsigned char *)posix_ctree_zeroes, 0,
+                         checksum);
+        return 0;
+    }
+
+    digests = GF_MALLOC((end - first) * digest_len, gf_posix_mt_char);
+    if (!digests)
+        return -ENOMEM;
+
+    if (posix_inode_ctx_get_all(fd->inode, this, &ctx)) {
+        ret = -ENOMEM;
+        goto out;
+    }
+
+    pthread_mutex_lock(&ctx->ctree_lock);
+    {
+        __posix_ctree_get(this, ctx, fd->inode->gfid, _fd, NULL);
+        if (ctx->ctree && (ctx->ctree->digest_len != digest_len))
+            __posix_ctree_drop(this, ctx, fd->inode->gfid);
+        if ((ctx->ctree_state == POSIX_CTREE_NONE) && !ctx->ctree_writers)
+            __posix_ctree_create(this, ctx, fd->inode->gfid, _fd);
+    }
+    pthread_mutex_unlock(&ctx->ctree_lock);
+
+    for (chunk = first; chunk < end; chunk += POSIX_CTREE_CHUNK) {
+        posix_ctree_read_known(ctx, digest_len, chunk,
+                               min(chunk + POSIX_CTREE_CHUNK, end),
+                               digests + (chunk - first) * digest_len);
+
+        for (leaf = chunk; leaf < min(chunk + POSIX_CTREE_CHUNK, end);
+             leaf++) {
+            digest = digests + (leaf - first) * digest_len;
+            if (mem_0filled((char *)digest, digest_len))
+                continue;
+
+            if (!alloc_buf) {
+                alloc_buf = GF_MALLOC(GF_RCHECKSUM_TREE_LEAF_SIZE +
+                                          POSIX_CTREE_ALIGN,
+                                      gf_posix_mt_char);
+                if (!alloc_buf) {
+                    ret = -ENOMEM;
+                    goto out;
+                }
+                buf = GF_ALIGN_BUF(alloc_buf, POSIX_CTREE_ALIGN);
+            }
+
+            pthread_mutex_lock(&ctx->ctree_lock);
+            {
+                gen = ctx->ctree_gen;
+                writers = ctx->ctree_writers;
+            }
+            pthread_mutex_unlock(&ctx->ctree_lock);
+
+            ret = posix_ctree_read_leaf(_fd, leaf, buf);
+            if (ret)
+                goto out;
+            posix_ctree_hash(digest_len, (unsigned char *)buf,
+                             GF_RCHECKSUM_TREE_LEAF_SIZE, digest);
+
+            /* Kept only if the data didn't change while being read */
+            pthread_mutex_lock(&ctx->ctree_lock);
+            {
+                tree = ctx->ctree;
+                if (tree && (tree->digest_len == digest_len) && !writers &&
+                    (gen == ctx->ctree_gen)) {
+                    if (sys_pwrite(tree->fd, digest, digest_len,
+                                   POSIX_CTREE_HEADER_SIZE +
+                                       leaf * digest_len) != digest_len) {
+                        gf_msg(this->name, GF_LOG_WARNING, errno,
+                               P_MSG_RCHECKSUM_TREE_FAILED,
+                               "failed to update the checksums of %s, "
+                               "dropping them",
+                               uuid_utoa(fd->inode->gfid));
+                        __posix_ctree_drop(this, ctx, fd->inode->gfid);
+                    } else {
+                        __posix_ctree_set_stale(tree, leaf, _gf_false);
+                        if (leaf >= tree->leaves)
+                            tree->leaves = leaf + 1;
+                    }
+                }
+            }
+            pthread_mutex_unlock(&ctx->ctree_lock);
+        }
+    }
+
+    posix_ctree_hash(digest_len, digests, (end - first) * digest_len,
+                     checksum);
+
+out:
+    GF_FREE(alloc_buf);
+    GF_FREE(digests);
+
+    return ret;
+}
+
+static int
+posix_ctree_remove_entry(const char *path, const struct stat *stbuf,
+                         int typeflag, struct FTW *ftw)
+{
+    if (remove(path))
+        gf_msg("posix", GF_LOG_WARNING, errno, P_MSG_RCHECKSUM_TREE_FAILED,
+               "failed to remove %s", path);
+
+    return 0;
+}
+
+/* The checksums left by a process not keeping them may not match the data
+ * anymore, so they are removed when they stop being kept. */
+static int
+posix_ctree_set(xlator_t *this, gf_boolean_t enable)
+{
+    struct posix_private *priv = this->private;
+    char path[PATH_MAX];
+
+    snprintf(path, sizeof(path), "%s/%s", priv->base_path, POSIX_CTREE_PATH);
+
+    if (!enable) {
+        if (nftw(path, posix_ctree_remove_entry, 16, FTW_DEPTH | FTW_PHYS) &&
+            (errno != ENOENT)) {
+            gf_msg(this->name, GF_LOG_ERROR, errno,
+                   P_MSG_RCHECKSUM_TREE_FAILED, "failed to remove %s", path);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (sys_mkdir(path, 0700) && (errno != EEXIST)) {
+        gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_RCHECKSUM_TREE_FAILED,
+               "failed to create %s", path);
+        return -1;
+    }
+
+    return 0;
+}
+
+int
+posix_ctree_init(xlator_t *this)
+{
+    struct posix_private *priv = this->private;
+    char boot_id[GF_UUID_BUF_SIZE] = {
+        0,
+    };
+    ssize_t bytes;
+    int fd;
+
+    /* Without it, the checksums of files being changed can't be trusted
+     * once loaded again */
+    fd = sys_open("/proc/sys/kernel/random/boot_id", O_RDONLY, 0);
+    if (fd >= 0) {
+        bytes = sys_read(fd, boot_id, sizeof(boot_id) - 1);
+        if ((bytes != sizeof(boot_id) - 1) ||
+            gf_uuid_parse(boot_id, priv->boot_id))
+            gf_uuid_clear(priv->boot_id);
+        sys_close(fd);
+    }
+
+    return posix_ctree_set(this, priv->rchecksum_tree);
+}
+
+int
+posix_ctree_reconfigure(xlator_t *this, gf_boolean_t enable)
+{
+    struct posix_private *priv = this->private;
+    int ret;
+
+    if (enable == priv->rchecksum_tree)
+        return 0;
+
+    /* Stop keeping them before they get removed, or start again on an empty
+     * directory, dropping the ones loaded before anyway. */
+    if (!enable)
+        priv->rchecksum_tree = _gf_false;
+    ret = posix_ctree_set(this, _gf_false);
+    if (!ret && enable)
+        ret = posix_ctree_set(this, _gf_true);
+    __atomic_add_fetch(&priv->rchecksum_tree_epoch, 1, __ATOMIC_SEQ_CST);
+    if (!ret && enable)
+        priv->rchecksum_tree = _gf_true;
+
+    return ret;
+}
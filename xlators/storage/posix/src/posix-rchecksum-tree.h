@@ -0,0 +1,54 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+#ifndef _POSIX_RCHECKSUM_TREE_H
+#define _POSIX_RCHECKSUM_TREE_H
+
+/* Where the checksums of the leaves of the files are kept, see
+ * posix-rchecksum-tree.c */
+#define POSIX_CTREE_PATH GF_HIDDEN_PATH "/checksums"
+
+/* What is known of the checksums of the leaves of a file */
+#define POSIX_CTREE_UNKNOWN 0
+#define POSIX_CTREE_NONE 1
+#define POSIX_CTREE_LOADED 2
+
+struct posix_ctree;
+
+int
+posix_ctree_init(xlator_t *this);
+int
+posix_ctree_reconfigure(xlator_t *this, gf_boolean_t enable);
+
+/* Around any change to the data of a file, with len being UINT64_MAX when it
+ * goes to the end of the file and path being used when fd is -1.
+ * posix_ctree_end() is only called when posix_ctree_begin() returned true. */
+gf_boolean_t
+posix_ctree_begin(xlator_t *this, inode_t *inode, int fd, const char *path,
+                  off_t offset, uint64_t len);
+void
+posix_ctree_end(xlator_t *this, inode_t *inode);
+
+/* After a change to the data of a file which wasn't tracked */
+void
+posix_ctree_invalidate(xlator_t *this, inode_table_t *table, uuid_t gfid);
+
+void
+posix_ctree_remove(xlator_t *this, uuid_t gfid);
+void
+posix_ctree_release(xlator_t *this, inode_t *inode, int fd);
+void
+posix_ctree_free(struct posix_ctree *tree);
+
+int
+posix_ctree_checksum(xlator_t *this, fd_t *fd, int _fd, off_t offset,
+                     uint64_t len, unsigned char *checksum);
+
+#endif /* !_POSIX_RCHECKSUM_TREE_H */
@@ -38,10 +38,8 @@
 #include "posix-aio.h"
 #endif
 
-#ifdef HAVE_LIBURING
-#include <liburing.h>
 #include "posix-io-uring.h"
-#endif
+#include "posix-rchecksum-tree.h"
 
 #define VECTOR_SIZE 64 * 1024 /* vector size 64KB*/
 #define MAX_NO_VECT 1024
@@ -142,6 +140,14 @@ struct posix_diskxl {
     gf_boolean_t is_use;
 };
 
+/* Latency counters of the fops sent through the I/O framework. */
+struct posix_uring_stats {
+    gf_atomic_t count;       /* Completed requests */
+    gf_atomic_t submit_ns;   /* Total time spent before submission */
+    gf_atomic_t complete_ns; /* Total time from submission to completion */
+    gf_atomic_t fixed;       /* Requests using registered buffers */
+};
+
 struct posix_private {
     char *base_path;
     int32_t base_path_length;
@@ -232,6 +238,12 @@ struct posix_private {
     gf_boolean_t disable_landfill_purge;
 
     gf_boolean_t fips_mode_rchecksum;
+    /* Keep the checksums of the leaves of the files, the epoch telling the
+     * ones loaded before it was last enabled from the others, and the boot id
+     * the ones which were being changed when the node rebooted. */
+    gf_boolean_t rchecksum_tree;
+    uint32_t rchecksum_tree_epoch;
+    uuid_t boot_id;
     gf_boolean_t ctime;
     gf_boolean_t janitor_task_stop;
 
@@ -268,14 +280,10 @@ struct posix_private {
 
     /*io_uring related.*/
     gf_boolean_t io_uring_configured;
-#ifdef HAVE_LIBURING
-    struct io_uring ring;
+#ifdef HAVE_IO_URING
     gf_boolean_t io_uring_init_done;
     gf_boolean_t io_uring_capable;
-    gf_boolean_t uring_thread_exit;
-    pthread_t uring_thread;
-    pthread_mutex_t sq_mutex;
-    pthread_mutex_t cq_mutex;
+    struct posix_uring_stats uring_stats[GF_FOP_MAXVALUE];
 #endif
     void *pxl;
 };
@@ -303,6 +311,14 @@ typedef struct {
     pthread_mutex_t xattrop_lock;
     pthread_mutex_t write_atomic_lock;
     pthread_mutex_t pgfid_lock;
+    /* Checksums of the leaves, and the changes to the data in progress and
+     * done, all of them under ctree_lock */
+    pthread_mutex_t ctree_lock;
+    struct posix_ctree *ctree;
+    uint64_t ctree_gen;
+    uint32_t ctree_writers;
+    uint32_t ctree_epoch;
+    int ctree_state;
 } posix_inode_ctx_t;
 
 #define POSIX_BASE_PATH(this)                                                  \
@@ -379,6 +395,8 @@ posix_fd_ctx_get(fd_t *fd, xlator_t *this, struct posix_fd **pfd,
                  int *op_errno);
 void
 posix_fill_ino_from_gfid(xlator_t *this, struct iatt *buf);
+int
+posix_fill_gfid_fd(xlator_t *this, int fd, struct iatt *iatt);
 
 gf_boolean_t
 posix_special_xattr(char **pattern, char *key);